@@ -313,7 +313,9 @@ bt_graph_run() does \em not return until one of:
   bt_graph_run() returns #BT_GRAPH_RUN_STATUS_AGAIN.
 
   In that case, you can call bt_graph_run() again later, usually after
-  waiting for some time.
+  waiting for some time. bt_graph_run_and_wait() does this for you,
+  waiting until a \bt_msg_iter is ready again (see
+  bt_self_message_iterator_set_wake_up_fd()).
 
   This feature exists to allow blocking operations within components
   to be postponed until they don't block. The graph user can perform
@@ -329,7 +331,8 @@ bt_graph_run() does \em not return until one of:
 
 If you want to make a single sink component consume and process a few
 \bt_p_msg before controlling the thread again, use bt_graph_run_once()
-instead of bt_graph_run().
+instead of bt_graph_run(), or bt_graph_run_once_and_wait() instead of
+bt_graph_run_and_wait().
 
 <h1>Standard \bt_name component classes</h1>
 
@@ -562,6 +565,402 @@ extern bt_graph *bt_graph_create(uint64_t mip_version);
 
 /*! @} */
 
+/*!
+@name Message batch size
+@{
+*/
+
+/*!
+@brief
+    Sets the message batch size of the trace processing graph
+    \bt_p{graph} to \bt_p{batch_size}.
+
+The message batch size of a trace processing graph is the capacity of
+the message array which the library passes to the
+\link api-msg-iter-cls-meth-next "next" method\endlink of any
+\bt_msg_iter of the graph: a message iterator can return at most that
+many \bt_p_msg at once.
+
+A greater batch size reduces the number of "next" method calls
+through a chain of filter components for high-rate sources, at the
+cost of more messages in flight.
+
+The default message batch size of a trace processing graph which
+bt_graph_create() returns is 15.
+
+@param[in] graph
+    Trace processing graph of which to set the message batch size to
+    \bt_p{batch_size}.
+@param[in] batch_size
+    New message batch size of \bt_p{graph}.
+
+@bt_pre_not_null{graph}
+@bt_pre_graph_not_configured{graph}
+@pre
+    \bt_p{batch_size} is greater than 0 and less than or equal to
+    <code>UINT_MAX</code>.
+
+@sa bt_graph_get_message_batch_size() &mdash;
+    Returns the message batch size of a trace processing graph.
+*/
+extern void bt_graph_set_message_batch_size(bt_graph *graph,
+		uint64_t batch_size);
+
+/*!
+@brief
+    Returns the message batch size of the trace processing graph
+    \bt_p{graph}.
+
+See bt_graph_set_message_batch_size() to learn more.
+
+@param[in] graph
+    Trace processing graph of which to get the message batch size.
+
+@returns
+    Message batch size of \bt_p{graph}.
+
+@bt_pre_not_null{graph}
+
+@sa bt_graph_set_message_batch_size() &mdash;
+    Sets the message batch size of a trace processing graph.
+*/
+extern uint64_t bt_graph_get_message_batch_size(const bt_graph *graph);
+
+/*! @} */
+
+/*!
+@name Message pools
+@{
+*/
+
+/*!
+@brief
+    Sets the message pool memory budget of the trace processing graph
+    \bt_p{graph} to \bt_p{budget} bytes.
+
+To avoid memory allocations, a trace processing graph keeps the
+\bt_p_ev_msg, \bt_p_pb_msg, and \bt_p_pe_msg which its
+\bt_p_msg_iter create in pools once their reference count falls to
+zero, and reuses them to create new messages.
+
+The message pool memory budget of a trace processing graph is the
+maximum total size, in bytes, of the messages which its pools keep:
+when keeping a message would exceed this budget, the library destroys
+it instead. The memory which the message pools of a graph occupy
+therefore doesn't stay at its peak after a burst of messages in flight.
+
+A budget of 0 disables message reuse altogether.
+
+The default message pool memory budget of a trace processing graph
+which bt_graph_create() returns is <code>UINT64_MAX</code>, that is,
+no budget.
+
+@param[in] graph
+    Trace processing graph of which to set the message pool memory
+    budget to \bt_p{budget}.
+@param[in] budget
+    New message pool memory budget (bytes) of \bt_p{graph}.
+
+@bt_pre_not_null{graph}
+@bt_pre_graph_not_configured{graph}
+
+@sa bt_graph_get_message_pool_memory_budget() &mdash;
+    Returns the message pool memory budget of a trace processing
+    graph.
+@sa bt_graph_get_message_pool_memory_size() &mdash;
+    Returns the current size of the message pools of a trace
+    processing graph.
+*/
+extern void bt_graph_set_message_pool_memory_budget(bt_graph *graph,
+		uint64_t budget);
+
+/*!
+@brief
+    Returns the message pool memory budget, in bytes, of the trace
+    processing graph \bt_p{graph}.
+
+See bt_graph_set_message_pool_memory_budget() to learn more.
+
+@param[in] graph
+    Trace processing graph of which to get the message pool memory
+    budget.
+
+@returns
+    Message pool memory budget (bytes) of \bt_p{graph}.
+
+@bt_pre_not_null{graph}
+
+@sa bt_graph_set_message_pool_memory_budget() &mdash;
+    Sets the message pool memory budget of a trace processing graph.
+*/
+extern uint64_t bt_graph_get_message_pool_memory_budget(
+		const bt_graph *graph);
+
+/*!
+@brief
+    Returns the total size, in bytes, of the messages which the
+    message pools of the trace processing graph \bt_p{graph}
+    currently keep.
+
+This size is always less than or equal to the
+\link bt_graph_set_message_pool_memory_budget() message pool memory
+budget\endlink of \bt_p{graph}.
+
+@param[in] graph
+    Trace processing graph of which to get the current message pool
+    memory size.
+
+@returns
+    Current message pool memory size (bytes) of \bt_p{graph}.
+
+@bt_pre_not_null{graph}
+
+@sa bt_graph_get_message_pool_statistics() &mdash;
+    Returns the message pool statistics of a trace processing graph.
+*/
+extern uint64_t bt_graph_get_message_pool_memory_size(
+		const bt_graph *graph);
+
+/*!
+@brief
+    Returns the message pool statistics of the trace processing graph
+    \bt_p{graph}.
+
+This function sets:
+
+<dl>
+  <dt>\bt_p{*allocation_count}</dt>
+  <dd>
+    Number of messages which the library allocated because the
+    corresponding pool was empty.
+  </dd>
+
+  <dt>\bt_p{*reuse_count}</dt>
+  <dd>
+    Number of messages which the library created by reusing a pooled
+    message.
+  </dd>
+
+  <dt>\bt_p{*discard_count}</dt>
+  <dd>
+    Number of messages which the library destroyed instead of keeping
+    them in a pool because of the
+    \link bt_graph_set_message_pool_memory_budget() message pool
+    memory budget\endlink of \bt_p{graph}.
+  </dd>
+</dl>
+
+Those counts cover the whole lifetime of \bt_p{graph}.
+
+Don't call this function while \bt_p{graph} is running.
+
+@param[in] graph
+    Trace processing graph of which to get the message pool
+    statistics.
+@param[out] allocation_count
+    <strong>On success</strong>, \bt_p{*allocation_count} is the
+    number of messages which the library allocated for \bt_p{graph}.
+@param[out] reuse_count
+    <strong>On success</strong>, \bt_p{*reuse_count} is the number of
+    pooled messages which the library reused for \bt_p{graph}.
+@param[out] discard_count
+    <strong>On success</strong>, \bt_p{*discard_count} is the number of
+    messages which the library destroyed instead of pooling them for
+    \bt_p{graph}.
+
+@bt_pre_not_null{graph}
+@bt_pre_not_null{allocation_count}
+@bt_pre_not_null{reuse_count}
+@bt_pre_not_null{discard_count}
+
+@sa bt_graph_get_message_pool_memory_size() &mdash;
+    Returns the current size of the message pools of a trace
+    processing graph.
+*/
+extern void bt_graph_get_message_pool_statistics(const bt_graph *graph,
+		uint64_t *allocation_count, uint64_t *reuse_count,
+		uint64_t *discard_count);
+
+/*! @} */
+
+/*!
+@name Performance statistics
+@{
+*/
+
+/*!
+@brief
+    Makes the trace processing graph \bt_p{graph} collect the
+    performance statistics of its components.
+
+When the performance statistics of a trace processing graph are
+enabled, the library measures each call to:
+
+- The \link api-msg-iter-cls-meth-next "next" method\endlink of any
+  \bt_msg_iter of the graph. The library accumulates the statistics of
+  all the message iterators of a given \bt_oport.
+
+- The \link api-comp-cls-dev-meth-consume "consume" method\endlink of
+  any \bt_sink_comp of the graph.
+
+Get those statistics with bt_graph_get_performance_statistics().
+
+The performance statistics of a trace processing graph which
+bt_graph_create() returns are disabled because measuring each call
+has a cost.
+
+@param[in] graph
+    Trace processing graph of which to enable the performance
+    statistics.
+
+@bt_pre_not_null{graph}
+@bt_pre_graph_not_configured{graph}
+
+@sa bt_graph_performance_statistics_are_enabled() &mdash;
+    Returns whether or not the performance statistics of a trace
+    processing graph are enabled.
+*/
+extern void bt_graph_enable_performance_statistics(bt_graph *graph);
+
+/*!
+@brief
+    Returns whether or not the performance statistics of the trace
+    processing graph \bt_p{graph} are enabled.
+
+See bt_graph_enable_performance_statistics() to learn more.
+
+@param[in] graph
+    Trace processing graph of which to get whether or not the
+    performance statistics are enabled.
+
+@returns
+    #BT_TRUE if the performance statistics of \bt_p{graph} are enabled.
+
+@bt_pre_not_null{graph}
+
+@sa bt_graph_enable_performance_statistics() &mdash;
+    Enables the performance statistics of a trace processing graph.
+*/
+extern bt_bool bt_graph_performance_statistics_are_enabled(
+		const bt_graph *graph);
+
+/*!
+@brief
+    Status codes for bt_graph_get_performance_statistics().
+*/
+typedef enum bt_graph_get_performance_statistics_status {
+	/*!
+	@brief
+	    Success.
+	*/
+	BT_GRAPH_GET_PERFORMANCE_STATISTICS_STATUS_OK		= __BT_FUNC_STATUS_OK,
+
+	/*!
+	@brief
+	    Out of memory.
+	*/
+	BT_GRAPH_GET_PERFORMANCE_STATISTICS_STATUS_MEMORY_ERROR	= __BT_FUNC_STATUS_MEMORY_ERROR,
+} bt_graph_get_performance_statistics_status;
+
+/*!
+@brief
+    Returns the performance statistics of the trace processing graph
+    \bt_p{graph} as a new \bt_map_val.
+
+The returned map value has a single entry, \c components, which is an
+\bt_array_val containing one map value per \bt_comp of \bt_p{graph},
+in the order in which you added them. Each component map value has
+the following entries:
+
+<dl>
+  <dt>\c name</dt>
+  <dd>Name of the component (\bt_string_val).</dd>
+
+  <dt>\c class-name</dt>
+  <dd>Name of the class of the component (string value).</dd>
+
+  <dt>\c consume (\bt_sink_comp only)</dt>
+  <dd>
+    Statistics of the calls to the "consume" method of the component.
+  </dd>
+
+  <dt>\c output-ports</dt>
+  <dd>
+    Array value containing one map value per \bt_oport of the
+    component. Each port map value has a \c name entry (string value)
+    and a \c next entry which contains the statistics of the calls to
+    the "next" method of the message iterators of this port.
+  </dd>
+</dl>
+
+Each statistics map value has the following entries, all of which are
+\bt_p_uint_val:
+
+<dl>
+  <dt>\c call-count</dt>
+  <dd>Number of calls.</dd>
+
+  <dt>\c again-count</dt>
+  <dd>Number of calls which returned "try again".</dd>
+
+  <dt>\c message-count</dt>
+  <dd>
+    Number of messages which the "next" method calls returned (0 for
+    a "consume" method).
+  </dd>
+
+  <dt>\c capacity</dt>
+  <dd>
+    Sum of the message array capacities of the "next" method calls
+    which returned messages (0 for a "consume" method).
+
+    The batch fill ratio is <code>message-count / capacity</code>.
+  </dd>
+
+  <dt>\c inclusive-time-ns</dt>
+  <dd>Total duration of the calls (nanoseconds).</dd>
+
+  <dt>\c exclusive-time-ns</dt>
+  <dd>
+    Total duration of the calls (nanoseconds), excluding the measured
+    calls which they make themselves, for example the "next" method
+    calls of the upstream message iterators of a \bt_flt_comp.
+  </dd>
+</dl>
+
+If the performance statistics of \bt_p{graph} are not
+\link bt_graph_enable_performance_statistics() enabled\endlink, then
+all the counters are 0.
+
+Don't call this function while \bt_p{graph} is running, except from
+the thread of a \bt_comp of \bt_p{graph} (counters of
+\link bt_graph_make_connection_thread_boundary() thread boundary
+connections\endlink can then be slightly behind).
+
+@param[in] graph
+    Trace processing graph of which to get the performance
+    statistics.
+@param[out] statistics
+    <strong>On success</strong>, \bt_p{*statistics} is a \em new
+    reference of the performance statistics of \bt_p{graph}.
+
+@retval #BT_GRAPH_GET_PERFORMANCE_STATISTICS_STATUS_OK
+    Success.
+@retval #BT_GRAPH_GET_PERFORMANCE_STATISTICS_STATUS_MEMORY_ERROR
+    Out of memory.
+
+@bt_pre_not_null{graph}
+@bt_pre_not_null{statistics}
+
+@sa bt_graph_enable_performance_statistics() &mdash;
+    Enables the performance statistics of a trace processing graph.
+*/
+extern bt_graph_get_performance_statistics_status
+bt_graph_get_performance_statistics(const bt_graph *graph,
+		bt_value **statistics);
+
+/*! @} */
+
 /*!
 @name Component adding
 @{
@@ -1219,6 +1618,84 @@ extern bt_graph_connect_ports_status bt_graph_connect_ports(bt_graph *graph,
 		const bt_port_input *downstream_port,
 		const bt_connection **connection);
 
+/*!
+@brief
+    Makes the \bt_conn \bt_p{connection} of the trace processing graph
+    \bt_p{graph} a thread boundary of which the message queues can
+    contain at least \bt_p{queue_capacity} \bt_p_msg.
+
+By default, a trace processing graph runs all its \bt_p_msg_iter on
+the thread which runs the graph.
+
+For each \bt_msg_iter which a downstream \bt_comp (or message
+iterator) creates on a thread boundary connection, the library starts
+a dedicated producer thread which calls the
+\link api-msg-iter-cls-meth-next "next" method\endlink of this message
+iterator and pushes the resulting messages to a bounded queue. When
+the downstream user calls bt_message_iterator_next(), the library
+pops the messages from this queue instead of calling the "next" method
+on the current thread. This makes the upstream and downstream parts of
+the graph run concurrently:
+
+- The messages which bt_message_iterator_next() returns are in the
+  same order as the "next" method returns them.
+
+- When the queue is full, the producer thread waits until the
+  downstream user pops messages from it.
+
+- When the queue is empty, bt_message_iterator_next() waits until the
+  producer thread pushes messages to it, returning
+  #BT_MESSAGE_ITERATOR_NEXT_STATUS_AGAIN if the graph is interrupted
+  meanwhile (see bt_graph_borrow_default_interrupter() and
+  bt_graph_add_interrupter()).
+
+- The "next" method's status and \ref api-error "error", if any,
+  reach the downstream user after all the messages which precede them.
+
+When the downstream user seeks the message iterator, checks whether or
+not it can seek, or finalizes it, the library stops the producer thread
+first, so that those methods run on the caller's thread. Seeking also
+discards the queued messages. The next bt_message_iterator_next() call
+starts a new producer thread.
+
+Because the message iterators of the components on either side of a
+thread boundary connection run concurrently, those components must not
+share mutable data without synchronizing.
+
+When bt_graph_run() or bt_graph_run_once() fails, the library stops
+the producer threads and discards their queued messages. When the graph
+is interrupted, those functions also stop the producer threads, but
+keep their queued messages for the next bt_graph_run() or
+bt_graph_run_once() call. Destroying the graph stops the producer
+threads before finalizing any message iterator.
+
+When \bt_p{graph} becomes configured (see
+\ref api-graph-lc "Trace processing graph life cycle"), if at least one
+of its connections is a thread boundary, the library makes its
+reference counts and object pools thread-safe for the whole process,
+before any message iterator exists.
+
+@param[in] graph
+    Trace processing graph containing \bt_p{connection}.
+@param[in] connection
+    Connection to make a thread boundary.
+@param[in] queue_capacity
+    Minimum number of messages which the message queue of each
+    message iterator on \bt_p{connection} can contain.
+
+@bt_pre_not_null{graph}
+@bt_pre_graph_not_configured{graph}
+@bt_pre_not_null{connection}
+@pre
+    \bt_p{graph} contains \bt_p{connection}, as returned by
+    bt_graph_connect_ports().
+@pre
+    \bt_p{queue_capacity} is greater than 0 and less than or equal to
+    <code>UINT_MAX</code>.
+*/
+extern void bt_graph_make_connection_thread_boundary(bt_graph *graph,
+		const bt_connection *connection, uint64_t queue_capacity);
+
 /*! @} */
 
 /*!
@@ -1443,6 +1920,102 @@ and what you can and cannot do with a configured graph.
 */
 extern bt_graph_run_once_status bt_graph_run_once(bt_graph *graph);
 
+/*!
+@brief
+    Runs the trace processing graph \bt_p{graph} like bt_graph_run()
+    does and, if it returns #BT_GRAPH_RUN_STATUS_AGAIN, waits until a
+    \bt_msg_iter of \bt_p{graph} is ready again, or for
+    \bt_p{max_wait_us}&nbsp;µs at most.
+
+A message iterator is ready again when the file descriptor which it
+set with bt_self_message_iterator_set_wake_up_fd() becomes readable.
+This function only waits for the message iterators of which the last
+\link api-msg-iter-cls-meth-next "next" method\endlink call returned
+#BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_AGAIN.
+
+If no such message iterator has a wake-up file descriptor, this
+function waits for \bt_p{max_wait_us}&nbsp;µs, which is what you would
+do with bt_graph_run() alone.
+
+A signal also ends the wait. This function doesn't wait if
+\bt_p{graph} is interrupted.
+
+This function returns after waiting: call it again to resume running
+\bt_p{graph}.
+
+@param[in] graph
+    Trace processing graph to run.
+@param[in] max_wait_us
+    Maximum duration (µs) to wait for a message iterator to be ready
+    when \bt_p{graph} needs to try again.
+
+@retval #BT_GRAPH_RUN_STATUS_OK
+    Success.
+@retval #BT_GRAPH_RUN_STATUS_AGAIN
+    Try again.
+@retval #BT_GRAPH_RUN_STATUS_MEMORY_ERROR
+    Out of memory.
+@retval #BT_GRAPH_RUN_STATUS_ERROR
+    Other error.
+
+@bt_pre_not_null{graph}
+@bt_pre_graph_not_faulty{graph}
+@pre
+    The preconditions of bt_graph_run() are satisfied.
+
+@sa bt_graph_run() &mdash;
+    Runs a trace processing graph, making all its sink components
+    consume in a round robin fashion.
+@sa bt_self_message_iterator_set_wake_up_fd() &mdash;
+    Sets the wake-up file descriptor of a message iterator.
+*/
+extern bt_graph_run_status bt_graph_run_and_wait(bt_graph *graph,
+		uint64_t max_wait_us);
+
+/*!
+@brief
+    Calls bt_graph_run_once() with the trace processing graph
+    \bt_p{graph} and, if it returns #BT_GRAPH_RUN_ONCE_STATUS_AGAIN,
+    waits like bt_graph_run_and_wait() does, for
+    \bt_p{max_wait_us}&nbsp;µs at most.
+
+Use this function instead of bt_graph_run_and_wait() when you need to
+control the thread between sink component consumptions, for example to
+report progress periodically, without busy waiting when the graph needs
+to try again.
+
+@param[in] graph
+    Trace processing graph to run once.
+@param[in] max_wait_us
+    Maximum duration (µs) to wait for a message iterator to be ready
+    when \bt_p{graph} needs to try again.
+
+@retval #BT_GRAPH_RUN_ONCE_STATUS_OK
+    Success.
+@retval #BT_GRAPH_RUN_ONCE_STATUS_END
+    All sink components are finished processing.
+@retval #BT_GRAPH_RUN_ONCE_STATUS_AGAIN
+    Try again.
+@retval #BT_GRAPH_RUN_ONCE_STATUS_MEMORY_ERROR
+    Out of memory.
+@retval #BT_GRAPH_RUN_ONCE_STATUS_ERROR
+    Other error.
+
+@bt_pre_not_null{graph}
+@bt_pre_graph_not_faulty{graph}
+@pre
+    The preconditions of bt_graph_run_once() are satisfied.
+
+@sa bt_graph_run_once() &mdash;
+    Calls a single trace processing graph's sink component's consuming
+    method once.
+@sa bt_graph_run_and_wait() &mdash;
+    Runs a trace processing graph and waits until one of its message
+    iterators is ready when it needs to try again.
+*/
+extern bt_graph_run_once_status bt_graph_run_once_and_wait(bt_graph *graph,
+		uint64_t max_wait_us);
+
 /*! @} */
 
 /*!
@@ -40,8 +40,16 @@ bt_self_message_iterator_get_data().
 Check whether or not a message iterator is interrupted with
 bt_self_message_iterator_is_interrupted().
 
+Set the file descriptor which becomes readable when a message iterator
+is ready again after returning "try again" with
+bt_self_message_iterator_set_wake_up_fd().
+
 Set whether or not a message iterator can seek forward with
 bt_self_message_iterator_configuration_set_can_seek_forward().
+
+Declare that a message iterator creates and releases objects from more
+than one thread with
+bt_self_message_iterator_configuration_set_is_multithreaded().
 */
 
 /*! @{ */
@@ -187,6 +195,53 @@ extern bt_bool bt_self_message_iterator_is_interrupted(
 
 /*! @} */
 
+/*!
+@name Wake-up file descriptor
+@{
+*/
+
+/*!
+@brief
+    Sets the wake-up file descriptor of the \bt_msg_iter
+    \bt_p{self_message_iterator} to \bt_p{fd}.
+
+The wake-up file descriptor of a message iterator becomes readable
+when the message iterator is ready to return messages again after its
+\link api-msg-iter-cls-meth-next "next" method\endlink returned
+#BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_AGAIN, for example a
+socket on which a remote server sends new data.
+
+When the "next" method of \bt_p{self_message_iterator} returns
+#BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_AGAIN,
+bt_graph_run_and_wait() waits until \bt_p{fd} is readable instead of
+waiting for a fixed duration.
+
+\bt_p{fd} is a borrowed file descriptor: the message iterator remains
+responsible for closing it. Call this function with -1 before closing
+it.
+
+The default wake-up file descriptor of a message iterator is -1, that
+is, none.
+
+@param[in] self_message_iterator
+    Message iterator instance.
+@param[in] fd
+    New wake-up file descriptor of \bt_p{self_message_iterator},
+    or -1 to unset it.
+
+@bt_pre_not_null{self_message_iterator}
+@pre
+    \bt_p{fd} is greater than or equal to -1.
+
+@sa bt_graph_run_and_wait() &mdash;
+    Runs a trace processing graph and waits for its message iterators
+    to be ready when it needs to try again.
+*/
+extern void bt_self_message_iterator_set_wake_up_fd(
+		bt_self_message_iterator *self_message_iterator, int fd);
+
+/*! @} */
+
 /*!
 @name Configuration
 @{
@@ -221,6 +276,55 @@ extern void bt_self_message_iterator_configuration_set_can_seek_forward(
 		bt_self_message_iterator_configuration *configuration,
 		bt_bool can_seek_forward);
 
+/*!
+@brief
+    Sets whether or not the \bt_msg_iter of which the configuration
+    is \bt_p{configuration} creates, borrows, and releases \bt_p_msg
+    and other libbabeltrace2 objects from threads other than the
+    thread which runs its \bt_graph.
+
+By default, libbabeltrace2 objects are \em not thread-safe: their
+reference counts and the pools from which the library recycles some of
+them are not protected against concurrent accesses.
+
+When you call this function with \bt_p{is_multithreaded} set to
+#BT_TRUE, the library switches, for the rest of the process's
+lifetime, to atomic reference counts and locked object pools. This
+makes it possible for a message iterator to create messages from
+worker threads (to decode its input in parallel, for example) and to
+return them from its
+\link api-msg-iter-cls-meth-next "next" method\endlink.
+
+Call this function before the message iterator starts any thread which
+shares libbabeltrace2 objects with the thread which runs its graph: the
+library only switches safely while no other thread uses those objects.
+
+Even then, the message iterator must not call any function on the
+same object from two threads at the same time, and must only return
+messages from the thread which called its "next" method.
+
+Calling this function with \bt_p{is_multithreaded} set to #BT_FALSE
+has no effect.
+
+@attention
+    You can only call this function during the execution of a
+    message iterator's
+    \ref api-msg-iter-cls-meth-init "initialization method".
+
+@param[in] configuration
+    Configuration of the message iterator of which to set whether or
+    not it uses more than one thread.
+@param[in] is_multithreaded
+    #BT_TRUE to make libbabeltrace2 objects thread-safe for the
+    message iterator of which the configuration is
+    \bt_p{configuration}.
+
+@bt_pre_not_null{configuration}
+*/
+extern void bt_self_message_iterator_configuration_set_is_multithreaded(
+		bt_self_message_iterator_configuration *configuration,
+		bt_bool is_multithreaded);
+
 /*! @} */
 
 /*! @} */
@@ -356,6 +356,132 @@ extern const bt_field *bt_event_borrow_common_context_field_const(
 
 /*! @} */
 
+/*!
+@name Deferred payload field
+@{
+*/
+
+/*!
+@brief
+    Status codes for #bt_event_payload_field_materialize_func.
+*/
+typedef enum bt_event_payload_field_materialize_func_status {
+	/*!
+	@brief
+	    Success.
+	*/
+	BT_EVENT_PAYLOAD_FIELD_MATERIALIZE_FUNC_STATUS_OK		= __BT_FUNC_STATUS_OK,
+
+	/*!
+	@brief
+	    Out of memory.
+	*/
+	BT_EVENT_PAYLOAD_FIELD_MATERIALIZE_FUNC_STATUS_MEMORY_ERROR	= __BT_FUNC_STATUS_MEMORY_ERROR,
+} bt_event_payload_field_materialize_func_status;
+
+/*!
+@brief
+    User function for bt_event_set_payload_field_materialize_func().
+
+This is the user function type which fills the payload \bt_field of an
+event the first time it's borrowed.
+
+@param[in] payload_field
+    Payload field to fill.
+@param[in] user_data
+    User data, as passed as the \bt_p{user_data} parameter of
+    bt_event_set_payload_field_materialize_func().
+
+@retval #BT_EVENT_PAYLOAD_FIELD_MATERIALIZE_FUNC_STATUS_OK
+    Success.
+@retval #BT_EVENT_PAYLOAD_FIELD_MATERIALIZE_FUNC_STATUS_MEMORY_ERROR
+    Out of memory.
+
+@bt_pre_not_null{payload_field}
+
+@post
+    <strong>On success</strong>, all the fields of \bt_p{payload_field}
+    are set.
+
+@note
+    This function cannot fail because of the data it decodes: you must
+    validate this data before you call
+    bt_event_set_payload_field_materialize_func(), so that this
+    function only fails when out of memory. As the payload field
+    borrowing functions cannot fail, the library aborts in this case.
+
+@sa bt_event_set_payload_field_materialize_func() &mdash;
+    Defers the filling of the payload field of an event.
+*/
+typedef bt_event_payload_field_materialize_func_status
+(*bt_event_payload_field_materialize_func)(bt_field *payload_field,
+		void *user_data);
+
+/*!
+@brief
+    User data destruction function for
+    bt_event_set_payload_field_materialize_func().
+
+@param[in] user_data
+    User data, as passed as the \bt_p{user_data} parameter of
+    bt_event_set_payload_field_materialize_func().
+*/
+typedef void (*bt_event_payload_field_materialize_data_destroy_func)(
+		void *user_data);
+
+/*!
+@brief
+    Defers the filling of the payload \bt_field of the event
+    \bt_p{event} to the function \bt_p{user_func}.
+
+Instead of filling the payload field of an event when you create its
+\bt_ev_msg, you can call this function so that the library calls
+\bt_p{user_func} the first time bt_event_borrow_payload_field() or
+bt_event_borrow_payload_field_const() borrows it. This is useful when
+most downstream \bt_p_comp don't need the payload fields of the events,
+for example to count events or to only read their context fields.
+
+The library calls \bt_p{destroy_func}, if not \c NULL, with
+\bt_p{user_data} once it doesn't need it anymore, that is, after
+calling \bt_p{user_func}, or when the event is destroyed or recycled
+without its payload field having been borrowed.
+
+\bt_p{user_func} and \bt_p{user_data} must remain valid as long as the
+event exists: in particular, \bt_p{user_data} cannot refer to the state
+of a \bt_msg_iter which could be finalized before the event is
+destroyed.
+
+@param[in] event
+    Event of which to defer the filling of the payload field.
+@param[in] user_func
+    User function which fills the payload field of \bt_p{event}.
+@param[in] destroy_func
+    @parblock
+    User data destruction function.
+
+    Can be \c NULL.
+    @endparblock
+@param[in] user_data
+    User data to pass as the \bt_p{user_data} parameter of
+    \bt_p{user_func} and \bt_p{destroy_func}.
+
+@bt_pre_not_null{event}
+@bt_pre_hot{event}
+@pre
+    The \ref api-tir-ev-cls "class" of \bt_p{event} has a
+    \ref api-tir-ev-cls-prop-p-fc "payload field class".
+@pre
+    The filling of the payload field of \bt_p{event} is not already
+    deferred.
+@bt_pre_not_null{user_func}
+*/
+extern void bt_event_set_payload_field_materialize_func(bt_event *event,
+		bt_event_payload_field_materialize_func user_func,
+		bt_event_payload_field_materialize_data_destroy_func destroy_func,
+		void *user_data);
+
+/*! @} */
+
 /*! @} */
 
 #ifdef __cplusplus
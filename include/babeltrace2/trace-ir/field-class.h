@@ -2199,6 +2199,8 @@ See the \ref api-tir-fc-enum-prop-mappings "mappings" property.
 @bt_pre_not_null{ranges}
 @pre
     \bt_p{ranges} contains one or more unsigned integer ranges.
+
+@bt_post_success_frozen{ranges}
 */
 extern bt_field_class_enumeration_add_mapping_status
 bt_field_class_enumeration_unsigned_add_mapping(
@@ -2464,6 +2466,8 @@ See the \ref api-tir-fc-enum-prop-mappings "mappings" property.
 @bt_pre_not_null{ranges}
 @pre
     \bt_p{ranges} contains one or more signed integer ranges.
+
+@bt_post_success_frozen{ranges}
 */
 extern bt_field_class_enumeration_add_mapping_status
 bt_field_class_enumeration_signed_add_mapping(
@@ -346,6 +346,34 @@ Borrow a field from an array field at a given index with
 bt_field_array_borrow_element_field_by_index() and
 bt_field_array_borrow_element_field_by_index_const().
 
+When the class of the elements of an array field is an \bt_int_fc or a
+\bt_real_fc, you can also set and get the values of all its elements at
+once, without borrowing each element field, with:
+
+<dl>
+  <dt>Unsigned integer elements</dt>
+  <dd>
+    bt_field_array_set_unsigned_integer_element_values() and
+    bt_field_array_borrow_unsigned_integer_element_values_const().
+  </dd>
+
+  <dt>Signed integer elements</dt>
+  <dd>
+    bt_field_array_set_signed_integer_element_values() and
+    bt_field_array_borrow_signed_integer_element_values_const().
+  </dd>
+
+  <dt>Real elements</dt>
+  <dd>
+    bt_field_array_set_real_element_values() and
+    bt_field_array_borrow_real_element_values_const().
+  </dd>
+</dl>
+
+Such an array field only updates its element fields when you borrow
+one of them, so that those functions are much faster than setting and
+getting the value of each element field when the array field is long.
+
 <h1>\anchor api-tir-field-struct Structure field</h1>
 
 A <strong><em>structure field</em></strong> is a \bt_struct_fc instance.
@@ -1171,6 +1199,199 @@ typedef enum bt_field_array_dynamic_set_length_status {
 extern bt_field_array_dynamic_set_length_status
 bt_field_array_dynamic_set_length(bt_field *field, uint64_t length);
 
+/*!
+@brief
+    Sets the values of all the \bt_uint_field elements of the
+    \bt_array_field \bt_p{field} to the first
+    <code>bt_field_array_get_length(field)</code> values of
+    \bt_p{values}.
+
+@attention
+    If \bt_p{field} is a dynamic array field, it must have a length
+    (call bt_field_array_dynamic_set_length()) before you call this
+    function.
+
+This function invalidates the element fields of \bt_p{field} which you
+borrowed before calling it: borrow them again with
+bt_field_array_borrow_element_field_by_index() to get their new values.
+
+@param[in] field
+    Array field of which to set the values of the elements.
+@param[in] values
+    @parblock
+    New values of the elements of \bt_p{field}.
+
+    Can be \c NULL if the length of \bt_p{field} is 0.
+    @endparblock
+
+@bt_pre_not_null{field}
+@bt_pre_is_array_field{field}
+@bt_pre_hot{field}
+@pre
+    The class of the elements of \bt_p{field} is an \bt_uint_fc.
+@pre
+    Each value of \bt_p{values} is within the
+    \ref api-tir-fc-int-prop-size "field value range" of the
+    class of the elements of \bt_p{field}.
+
+@sa bt_field_array_borrow_unsigned_integer_element_values_const() &mdash;
+    Borrows the values of all the unsigned integer field elements of an
+    array field.
+*/
+extern void bt_field_array_set_unsigned_integer_element_values(
+		bt_field *field, const uint64_t *values);
+
+/*!
+@brief
+    Borrows the values of all the \bt_uint_field elements of the
+    \bt_array_field \bt_p{field}.
+
+@param[in] field
+    Array field of which to borrow the values of the elements.
+
+@returns
+    @parblock
+    Values of the elements of \bt_p{field}, of which the length is
+    <code>bt_field_array_get_length(field)</code>.
+
+    The returned pointer remains valid until \bt_p{field} is modified.
+    @endparblock
+
+@bt_pre_not_null{field}
+@bt_pre_is_array_field{field}
+@pre
+    The class of the elements of \bt_p{field} is an \bt_uint_fc.
+
+@sa bt_field_array_set_unsigned_integer_element_values() &mdash;
+    Sets the values of all the unsigned integer field elements of an
+    array field.
+*/
+extern const uint64_t *
+bt_field_array_borrow_unsigned_integer_element_values_const(
+		const bt_field *field);
+
+/*!
+@brief
+    Sets the values of all the \bt_sint_field elements of the
+    \bt_array_field \bt_p{field} to the first
+    <code>bt_field_array_get_length(field)</code> values of
+    \bt_p{values}.
+
+See bt_field_array_set_unsigned_integer_element_values().
+
+@param[in] field
+    Array field of which to set the values of the elements.
+@param[in] values
+    @parblock
+    New values of the elements of \bt_p{field}.
+
+    Can be \c NULL if the length of \bt_p{field} is 0.
+    @endparblock
+
+@bt_pre_not_null{field}
+@bt_pre_is_array_field{field}
+@bt_pre_hot{field}
+@pre
+    The class of the elements of \bt_p{field} is a \bt_sint_fc.
+@pre
+    Each value of \bt_p{values} is within the
+    \ref api-tir-fc-int-prop-size "field value range" of the
+    class of the elements of \bt_p{field}.
+
+@sa bt_field_array_borrow_signed_integer_element_values_const() &mdash;
+    Borrows the values of all the signed integer field elements of an
+    array field.
+*/
+extern void bt_field_array_set_signed_integer_element_values(
+		bt_field *field, const int64_t *values);
+
+/*!
+@brief
+    Borrows the values of all the \bt_sint_field elements of the
+    \bt_array_field \bt_p{field}.
+
+See bt_field_array_borrow_unsigned_integer_element_values_const().
+
+@param[in] field
+    Array field of which to borrow the values of the elements.
+
+@returns
+    Values of the elements of \bt_p{field}, of which the length is
+    <code>bt_field_array_get_length(field)</code>.
+
+@bt_pre_not_null{field}
+@bt_pre_is_array_field{field}
+@pre
+    The class of the elements of \bt_p{field} is a \bt_sint_fc.
+
+@sa bt_field_array_set_signed_integer_element_values() &mdash;
+    Sets the values of all the signed integer field elements of an
+    array field.
+*/
+extern const int64_t *
+bt_field_array_borrow_signed_integer_element_values_const(
+		const bt_field *field);
+
+/*!
+@brief
+    Sets the values of all the \bt_real_field elements of the
+    \bt_array_field \bt_p{field} to the first
+    <code>bt_field_array_get_length(field)</code> values of
+    \bt_p{values}.
+
+See bt_field_array_set_unsigned_integer_element_values().
+
+If the elements of \bt_p{field} are \bt_p_sreal_field, then this
+function converts each value of \bt_p{values} to a \c float value, like
+bt_field_real_single_precision_set_value() does.
+
+@param[in] field
+    Array field of which to set the values of the elements.
+@param[in] values
+    @parblock
+    New values of the elements of \bt_p{field}.
+
+    Can be \c NULL if the length of \bt_p{field} is 0.
+    @endparblock
+
+@bt_pre_not_null{field}
+@bt_pre_is_array_field{field}
+@bt_pre_hot{field}
+@pre
+    The class of the elements of \bt_p{field} is a \bt_real_fc.
+
+@sa bt_field_array_borrow_real_element_values_const() &mdash;
+    Borrows the values of all the real field elements of an array
+    field.
+*/
+extern void bt_field_array_set_real_element_values(bt_field *field,
+		const double *values);
+
+/*!
+@brief
+    Borrows the values of all the \bt_real_field elements of the
+    \bt_array_field \bt_p{field}.
+
+See bt_field_array_borrow_unsigned_integer_element_values_const().
+
+@param[in] field
+    Array field of which to borrow the values of the elements.
+
+@returns
+    Values of the elements of \bt_p{field}, of which the length is
+    <code>bt_field_array_get_length(field)</code>.
+
+@bt_pre_not_null{field}
+@bt_pre_is_array_field{field}
+@pre
+    The class of the elements of \bt_p{field} is a \bt_real_fc.
+
+@sa bt_field_array_set_real_element_values() &mdash;
+    Sets the values of all the real field elements of an array field.
+*/
+extern const double *bt_field_array_borrow_real_element_values_const(
+		const bt_field *field);
+
 /*! @} */
 
 /*!
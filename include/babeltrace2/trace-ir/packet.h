@@ -224,6 +224,98 @@ const bt_field *bt_packet_borrow_context_field_const(
 
 /*! @} */
 
+/*!
+@name Raw data
+@{
+*/
+
+/*!
+@brief
+    Raw data destruction function for bt_packet_set_raw_data().
+
+@param[in] raw_data
+    Raw data, as passed as the \bt_p{raw_data} parameter of
+    bt_packet_set_raw_data().
+*/
+typedef void (*bt_packet_raw_data_destroy_func)(void *raw_data);
+
+/*!
+@brief
+    Attaches the raw data \bt_p{raw_data}, of which the format is
+    named \bt_p{format}, to the packet \bt_p{packet}.
+
+A \bt_src_comp which decodes packets from some binary format can attach
+to each packet the data which describes where and how it's encoded
+(file location, metadata identity, and so on). A \bt_sink_comp which
+writes the same format can then borrow this data with
+bt_packet_borrow_raw_data_const() to copy the packet verbatim instead
+of encoding its events again.
+
+The library doesn't interpret \bt_p{raw_data}: the components which
+attach and borrow it agree on its layout through the name
+\bt_p{format}.
+
+The library calls \bt_p{destroy_func}, if not \c NULL, with
+\bt_p{raw_data} when the packet is destroyed or recycled.
+
+\bt_p{format}, \bt_p{raw_data}, and \bt_p{destroy_func} must remain
+valid as long as the packet exists: in particular, \bt_p{raw_data}
+cannot refer to the state of a \bt_msg_iter which could be finalized
+before the packet is destroyed.
+
+@param[in] packet
+    Packet to which to attach \bt_p{raw_data}.
+@param[in] format
+    Name of the format of \bt_p{raw_data}.
+@param[in] raw_data
+    Raw data to attach to \bt_p{packet}.
+@param[in] destroy_func
+    @parblock
+    Raw data destruction function.
+
+    Can be \c NULL.
+    @endparblock
+
+@bt_pre_not_null{packet}
+@bt_pre_hot{packet}
+@bt_pre_not_null{format}
+@bt_pre_not_null{raw_data}
+@pre
+    \bt_p{packet} has no raw data.
+
+@sa bt_packet_borrow_raw_data_const() &mdash;
+    Borrows the raw data of a packet.
+*/
+extern void bt_packet_set_raw_data(bt_packet *packet, const char *format,
+		void *raw_data, bt_packet_raw_data_destroy_func destroy_func);
+
+/*!
+@brief
+    Borrows the raw data of the packet \bt_p{packet} if its format
+    is named \bt_p{format}.
+
+See bt_packet_set_raw_data().
+
+@param[in] packet
+    Packet of which to borrow the raw data.
+@param[in] format
+    Name of the expected format of the raw data of \bt_p{packet}.
+
+@returns
+    Raw data of \bt_p{packet}, or \c NULL if \bt_p{packet} has no raw
+    data or if the format of its raw data is not named \bt_p{format}.
+
+@bt_pre_not_null{packet}
+@bt_pre_not_null{format}
+
+@sa bt_packet_set_raw_data() &mdash;
+    Attaches raw data to a packet.
+*/
+extern const void *bt_packet_borrow_raw_data_const(const bt_packet *packet,
+		const char *format);
+
+/*! @} */
+
 /*!
 @name Reference count
 @{
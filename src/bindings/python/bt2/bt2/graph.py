@@ -147,3 +147,16 @@ class Graph(object._SharedObject):
     def default_interrupter(self):
         ptr = native_bt.graph_borrow_default_interrupter(self._ptr)
         return bt2_interrupter.Interrupter._create_from_ptr_and_get_ref(ptr)
+
+    @property
+    def message_batch_size(self):
+        return native_bt.graph_get_message_batch_size(self._ptr)
+
+    @message_batch_size.setter
+    def message_batch_size(self, batch_size):
+        utils._check_uint64(batch_size)
+
+        if batch_size == 0 or batch_size > 0xFFFFFFFF:
+            raise ValueError('invalid message batch size: {}'.format(batch_size))
+
+        native_bt.graph_set_message_batch_size(self._ptr, batch_size)
@@ -434,6 +434,9 @@ void bt_config_destroy(bt_object *obj)
 			g_ptr_array_free(cfg->cmd_data.run.connections,
 				TRUE);
 		}
+
+		BT_VALUE_PUT_REF_AND_RESET(
+			cfg->cmd_data.run.thread_boundary_comp_names);
 		break;
 	case BT_CONFIG_COMMAND_LIST_PLUGINS:
 		break;
@@ -854,6 +857,8 @@ enum {
 	OPT_INPUT_FORMAT,
 	OPT_LIST,
 	OPT_LOG_LEVEL,
+	OPT_MESSAGE_BATCH_SIZE,
+	OPT_MESSAGE_POOL_BUDGET,
 	OPT_NAMES,
 	OPT_NO_DELTA,
 	OPT_OMIT_HOME_PLUGIN_PATH,
@@ -866,7 +871,10 @@ enum {
 	OPT_RETRY_DURATION,
 	OPT_RUN_ARGS,
 	OPT_RUN_ARGS_0,
+	OPT_STATS,
+	OPT_STATS_INTERVAL,
 	OPT_STREAM_INTERSECTION,
+	OPT_THREAD_BOUNDARY,
 	OPT_TIMERANGE,
 	OPT_VERBOSE,
 	OPT_VERSION,
@@ -1085,6 +1093,13 @@ struct bt_config *bt_config_run_create(const bt_value *plugin_paths)
 		goto error;
 	}
 
+	cfg->cmd_data.run.thread_boundary_comp_names = bt_value_array_create();
+	if (!cfg->cmd_data.run.thread_boundary_comp_names) {
+		BT_CLI_LOGE_APPEND_CAUSE_OOM();
+		goto error;
+	}
+
+	cfg->cmd_data.run.msg_pool_budget = UINT64_MAX;
 	goto end;
 
 error:
@@ -1732,14 +1747,29 @@ void print_run_usage(FILE *fp)
 	fprintf(fp, "                                    expected format of CONNECTION below)\n");
 	fprintf(fp, "  -l, --log-level=LVL               Set the log level of the current component to LVL\n");
 	fprintf(fp, "                                    (`N`, `T`, `D`, `I`, `W`, `E`, or `F`)\n");
+	fprintf(fp, "      --message-batch-size=SIZE     Make the message iterators of the graph\n");
+	fprintf(fp, "                                    return at most SIZE messages at once\n");
+	fprintf(fp, "                                    (default: 15)\n");
+	fprintf(fp, "      --message-pool-budget=SIZE    Make the message pools of the graph keep\n");
+	fprintf(fp, "                                    at most SIZE bytes of messages for reuse\n");
+	fprintf(fp, "                                    (default: no budget)\n");
 	fprintf(fp, "  -p, --params=PARAMS               Add initialization parameters PARAMS to the\n");
 	fprintf(fp, "                                    current component (see the expected format\n");
 	fprintf(fp, "                                    of PARAMS below)\n");
 	fprintf(fp, "  -r, --reset-base-params           Reset the current base parameters to an\n");
 	fprintf(fp, "                                    empty map\n");
 	fprintf(fp, "      --retry-duration=DUR          When babeltrace2(1) needs to retry to run\n");
-	fprintf(fp, "                                    the graph later, retry in DUR µs\n");
+	fprintf(fp, "                                    the graph later, retry in DUR µs at most\n");
 	fprintf(fp, "                                    (default: 100000)\n");
+	fprintf(fp, "      --stats                       Print the performance statistics of the\n");
+	fprintf(fp, "                                    components to the standard error at the\n");
+	fprintf(fp, "                                    end of the run\n");
+	fprintf(fp, "      --stats-interval=SEC          Also print the performance statistics\n");
+	fprintf(fp, "                                    every SEC seconds while running (implies\n");
+	fprintf(fp, "                                    --stats)\n");
+	fprintf(fp, "      --thread-boundary=NAME        Run the upstream side of each input\n");
+	fprintf(fp, "                                    connection of the component NAME on\n");
+	fprintf(fp, "                                    its own thread\n");
 	fprintf(fp, "  -h, --help                        Show this help and quit\n");
 	fprintf(fp, "\n");
 	fprintf(fp, "See `babeltrace2 --help` for the list of general options.\n");
@@ -1811,9 +1841,14 @@ struct bt_config *bt_config_run_from_args(int argc, const char *argv[],
 		{ OPT_CONNECT, 'x', "connect", true },
 		{ OPT_HELP, 'h', "help", false },
 		{ OPT_LOG_LEVEL, 'l', "log-level", true },
+		{ OPT_MESSAGE_BATCH_SIZE, '\0', "message-batch-size", true },
+		{ OPT_MESSAGE_POOL_BUDGET, '\0', "message-pool-budget", true },
 		{ OPT_PARAMS, 'p', "params", true },
 		{ OPT_RESET_BASE_PARAMS, 'r', "reset-base-params", false },
 		{ OPT_RETRY_DURATION, '\0', "retry-duration", true },
+		{ OPT_STATS, '\0', "stats", false },
+		{ OPT_STATS_INTERVAL, '\0', "stats-interval", true },
+		{ OPT_THREAD_BOUNDARY, '\0', "thread-boundary", true },
 		ARGPAR_OPT_DESCR_SENTINEL
 	};
 
@@ -2029,6 +2064,92 @@ struct bt_config *bt_config_run_from_args(int argc, const char *argv[],
 				(uint64_t) retry_duration;
 			break;
 		}
+		case OPT_MESSAGE_BATCH_SIZE: {
+			gchar *end;
+			size_t arg_len = strlen(argpar_item_opt->arg);
+			guint64 msg_batch_size;
+
+			msg_batch_size = g_ascii_strtoull(argpar_item_opt->arg,
+				&end, 10);
+
+			if (arg_len == 0 || end != (argpar_item_opt->arg + arg_len) ||
+					argpar_item_opt->arg[0] == '-') {
+				BT_CLI_LOGE_APPEND_CAUSE(
+					"Could not parse --message-batch-size option's argument as an unsigned integer: `%s`",
+					argpar_item_opt->arg);
+				goto error;
+			}
+
+			if (msg_batch_size == 0 || msg_batch_size > G_MAXUINT) {
+				BT_CLI_LOGE_APPEND_CAUSE("--message-batch-size option's argument must be between 1 and %u: %" PRIu64,
+					G_MAXUINT, (uint64_t) msg_batch_size);
+				goto error;
+			}
+
+			cfg->cmd_data.run.msg_batch_size =
+				(uint64_t) msg_batch_size;
+			break;
+		}
+		case OPT_MESSAGE_POOL_BUDGET: {
+			gchar *end;
+			size_t arg_len = strlen(argpar_item_opt->arg);
+			guint64 msg_pool_budget;
+
+			msg_pool_budget = g_ascii_strtoull(argpar_item_opt->arg,
+				&end, 10);
+
+			if (arg_len == 0 || end != (argpar_item_opt->arg + arg_len) ||
+					argpar_item_opt->arg[0] == '-') {
+				BT_CLI_LOGE_APPEND_CAUSE(
+					"Could not parse --message-pool-budget option's argument as an unsigned integer: `%s`",
+					argpar_item_opt->arg);
+				goto error;
+			}
+
+			cfg->cmd_data.run.msg_pool_budget =
+				(uint64_t) msg_pool_budget;
+			break;
+		}
+		case OPT_STATS:
+			cfg->cmd_data.run.print_stats = true;
+			break;
+		case OPT_STATS_INTERVAL: {
+			gchar *end;
+			size_t arg_len = strlen(argpar_item_opt->arg);
+			guint64 stats_interval;
+
+			stats_interval = g_ascii_strtoull(argpar_item_opt->arg,
+				&end, 10);
+
+			if (arg_len == 0 || end != (argpar_item_opt->arg + arg_len) ||
+					argpar_item_opt->arg[0] == '-') {
+				BT_CLI_LOGE_APPEND_CAUSE(
+					"Could not parse --stats-interval option's argument as an unsigned integer: `%s`",
+					argpar_item_opt->arg);
+				goto error;
+			}
+
+			if (stats_interval == 0 ||
+					stats_interval > UINT64_MAX / G_USEC_PER_SEC) {
+				BT_CLI_LOGE_APPEND_CAUSE("--stats-interval option's argument must be between 1 and %" PRIu64 ": %" PRIu64,
+					UINT64_MAX / G_USEC_PER_SEC,
+					(uint64_t) stats_interval);
+				goto error;
+			}
+
+			cfg->cmd_data.run.print_stats = true;
+			cfg->cmd_data.run.stats_interval_us =
+				(uint64_t) stats_interval * G_USEC_PER_SEC;
+			break;
+		}
+		case OPT_THREAD_BOUNDARY:
+			if (bt_value_array_append_string_element(
+					cfg->cmd_data.run.thread_boundary_comp_names,
+					arg)) {
+				BT_CLI_LOGE_APPEND_CAUSE_OOM();
+				goto error;
+			}
+			break;
 		default:
 			BT_CLI_LOGE_APPEND_CAUSE("Unknown command-line option specified (option code %d).",
 				argpar_item_opt->descr->id);
@@ -2048,6 +2169,21 @@ struct bt_config *bt_config_run_from_args(int argc, const char *argv[],
 		goto error;
 	}
 
+	for (i = 0; i < bt_value_array_get_length(
+			cfg->cmd_data.run.thread_boundary_comp_names); i++) {
+		const char *name = bt_value_string_get(
+			bt_value_array_borrow_element_by_index_const(
+				cfg->cmd_data.run.thread_boundary_comp_names,
+				i));
+
+		if (!bt_value_map_has_entry(instance_names, name)) {
+			BT_CLI_LOGE_APPEND_CAUSE(
+				"Unknown component name in --thread-boundary option: `%s`",
+				name);
+			goto error;
+		}
+	}
+
 	ret = bt_config_cli_args_create_connections(cfg,
 		connection_args,
 		error_buf, 256);
@@ -2128,11 +2264,17 @@ void print_convert_usage(FILE *fp)
 	fprintf(fp, "                                    NAME\n");
 	fprintf(fp, "  -l, --log-level=LVL               Set the log level of the current component to LVL\n");
 	fprintf(fp, "                                    (`N`, `T`, `D`, `I`, `W`, `E`, or `F`)\n");
+	fprintf(fp, "      --message-batch-size=SIZE     Make the message iterators of the graph\n");
+	fprintf(fp, "                                    return at most SIZE messages at once\n");
+	fprintf(fp, "                                    (default: 15)\n");
+	fprintf(fp, "      --message-pool-budget=SIZE    Make the message pools of the graph keep\n");
+	fprintf(fp, "                                    at most SIZE bytes of messages for reuse\n");
+	fprintf(fp, "                                    (default: no budget)\n");
 	fprintf(fp, "  -p, --params=PARAMS               Add initialization parameters PARAMS to the\n");
 	fprintf(fp, "                                    current component (see the expected format\n");
 	fprintf(fp, "                                    of PARAMS below)\n");
 	fprintf(fp, "      --retry-duration=DUR          When babeltrace2(1) needs to retry to run\n");
-	fprintf(fp, "                                    the graph later, retry in DUR µs\n");
+	fprintf(fp, "                                    the graph later, retry in DUR µs at most\n");
 	fprintf(fp, "                                    (default: 100000)\n");
 	fprintf(fp, "                                    dynamic plugins can be loaded\n");
 	fprintf(fp, "      --run-args                    Print the equivalent arguments for the\n");
@@ -2141,6 +2283,12 @@ void print_convert_usage(FILE *fp)
 	fprintf(fp, "      --run-args-0                  Print the equivalent arguments for the\n");
 	fprintf(fp, "                                    `run` command to the standard output,\n");
 	fprintf(fp, "                                    formatted for `xargs -0`, and quit\n");
+	fprintf(fp, "      --stats                       Print the performance statistics of the\n");
+	fprintf(fp, "                                    components to the standard error at the\n");
+	fprintf(fp, "                                    end of the run\n");
+	fprintf(fp, "      --stats-interval=SEC          Also print the performance statistics\n");
+	fprintf(fp, "                                    every SEC seconds while running (implies\n");
+	fprintf(fp, "                                    --stats)\n");
 	fprintf(fp, "      --stream-intersection         Only process events when all streams\n");
 	fprintf(fp, "                                    are active\n");
 	fprintf(fp, "  -h, --help                        Show this help and quit\n");
@@ -2255,6 +2403,8 @@ const struct argpar_opt_descr convert_options[] = {
 	{ OPT_HELP, 'h', "help", false },
 	{ OPT_INPUT_FORMAT, 'i', "input-format", true },
 	{ OPT_LOG_LEVEL, 'l', "log-level", true },
+	{ OPT_MESSAGE_BATCH_SIZE, '\0', "message-batch-size", true },
+	{ OPT_MESSAGE_POOL_BUDGET, '\0', "message-pool-budget", true },
 	{ OPT_NAMES, 'n', "names", true },
 	{ OPT_DEBUG_INFO, '\0', "debug-info", false },
 	{ OPT_NO_DELTA, '\0', "no-delta", false },
@@ -2267,6 +2417,8 @@ const struct argpar_opt_descr convert_options[] = {
 	{ OPT_RETRY_DURATION, '\0', "retry-duration", true },
 	{ OPT_RUN_ARGS, '\0', "run-args", false },
 	{ OPT_RUN_ARGS_0, '\0', "run-args-0", false },
+	{ OPT_STATS, '\0', "stats", false },
+	{ OPT_STATS_INTERVAL, '\0', "stats-interval", true },
 	{ OPT_STREAM_INTERSECTION, '\0', "stream-intersection", false },
 	{ OPT_TIMERANGE, '\0', "timerange", true },
 	{ OPT_VERBOSE, 'v', "verbose", false },
@@ -3536,6 +3688,49 @@ struct bt_config *bt_config_convert_from_args(int argc, const char *argv[],
 					goto error;
 				}
 
+				if (bt_value_array_append_string_element(run_args, arg)) {
+					BT_CLI_LOGE_APPEND_CAUSE_OOM();
+					goto error;
+				}
+				break;
+			case OPT_MESSAGE_BATCH_SIZE:
+				if (bt_value_array_append_string_element(run_args,
+						"--message-batch-size")) {
+					BT_CLI_LOGE_APPEND_CAUSE_OOM();
+					goto error;
+				}
+
+				if (bt_value_array_append_string_element(run_args, arg)) {
+					BT_CLI_LOGE_APPEND_CAUSE_OOM();
+					goto error;
+				}
+				break;
+			case OPT_MESSAGE_POOL_BUDGET:
+				if (bt_value_array_append_string_element(run_args,
+						"--message-pool-budget")) {
+					BT_CLI_LOGE_APPEND_CAUSE_OOM();
+					goto error;
+				}
+
+				if (bt_value_array_append_string_element(run_args, arg)) {
+					BT_CLI_LOGE_APPEND_CAUSE_OOM();
+					goto error;
+				}
+				break;
+			case OPT_STATS:
+				if (bt_value_array_append_string_element(run_args,
+						"--stats")) {
+					BT_CLI_LOGE_APPEND_CAUSE_OOM();
+					goto error;
+				}
+				break;
+			case OPT_STATS_INTERVAL:
+				if (bt_value_array_append_string_element(run_args,
+						"--stats-interval")) {
+					BT_CLI_LOGE_APPEND_CAUSE_OOM();
+					goto error;
+				}
+
 				if (bt_value_array_append_string_element(run_args, arg)) {
 					BT_CLI_LOGE_APPEND_CAUSE_OOM();
 					goto error;
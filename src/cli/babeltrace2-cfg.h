@@ -75,6 +75,38 @@ struct bt_config {
 			 */
 			uint64_t retry_duration_us;
 
+			/*
+			 * Message batch size of the graph, or 0 to use
+			 * the library's default.
+			 */
+			uint64_t msg_batch_size;
+
+			/*
+			 * Message pool memory budget (bytes) of the
+			 * graph, or `UINT64_MAX` for no budget.
+			 */
+			uint64_t msg_pool_budget;
+
+			/*
+			 * Array of string values: names of the components
+			 * of which to make the input connections thread
+			 * boundaries.
+			 */
+			bt_value *thread_boundary_comp_names;
+
+			/*
+			 * Whether or not to print the performance
+			 * statistics of the graph.
+			 */
+			bool print_stats;
+
+			/*
+			 * Period (µs) at which to also print the
+			 * performance statistics while running the
+			 * graph, or 0 to only print them at the end.
+			 */
+			uint64_t stats_interval_us;
+
 			/*
 			 * Whether or not to trim the source trace to the
 			 * intersection of its streams.
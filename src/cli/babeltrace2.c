@@ -1198,6 +1198,38 @@ struct cmd_run_ctx {
 	GHashTable *intersections;
 };
 
+/*
+ * Capacity of the message queue of each message iterator on a thread
+ * boundary connection (see the `--thread-boundary` option).
+ */
+#define THREAD_BOUNDARY_QUEUE_CAPACITY	1024
+
+/*
+ * Returns whether or not the input connections of `comp` must be
+ * thread boundaries.
+ */
+static
+bool component_is_thread_boundary(struct cmd_run_ctx *ctx,
+		const bt_component *comp)
+{
+	const bt_value *names = ctx->cfg->cmd_data.run.thread_boundary_comp_names;
+	const char *comp_name = bt_component_get_name(comp);
+	bool is_thread_boundary = false;
+	uint64_t i;
+
+	for (i = 0; i < bt_value_array_get_length(names); i++) {
+		const char *name = bt_value_string_get(
+			bt_value_array_borrow_element_by_index_const(names, i));
+
+		if (strcmp(name, comp_name) == 0) {
+			is_thread_boundary = true;
+			break;
+		}
+	}
+
+	return is_thread_boundary;
+}
+
 /* Returns a timestamp of the form "(-)s.ns" */
 static
 char *s_from_ns(int64_t ns)
@@ -1273,6 +1305,7 @@ int cmd_run_ctx_connect_upstream_port_to_downstream_component(
 	const bt_component_class_filter *trimmer_class = NULL;
 	const bt_port_input *trimmer_input = NULL;
 	const bt_port_output *trimmer_output = NULL;
+	const bt_connection *connection = NULL;
 
 	if (ctx->intersections &&
 		bt_component_get_class_type(upstream_comp) ==
@@ -1459,7 +1492,7 @@ int cmd_run_ctx_connect_upstream_port_to_downstream_component(
 
 		/* We have a winner! */
 		connect_ports_status = bt_graph_connect_ports(ctx->graph,
-			out_upstream_port, in_downstream_port, NULL);
+			out_upstream_port, in_downstream_port, &connection);
 		downstream_port = NULL;
 		switch (connect_ports_status) {
 		case BT_GRAPH_CONNECT_PORTS_STATUS_OK:
@@ -1492,6 +1525,17 @@ int cmd_run_ctx_connect_upstream_port_to_downstream_component(
 			downstream_port, downstream_port_name,
 			cfg_conn->arg->str);
 
+		if (component_is_thread_boundary(ctx,
+				bt_port_borrow_component_const(
+					bt_port_input_as_port_const(
+						in_downstream_port)))) {
+			BT_LOGI("Making connection a thread boundary: "
+				"conn-addr=%p, queue-capacity=%d",
+				connection, THREAD_BOUNDARY_QUEUE_CAPACITY);
+			bt_graph_make_connection_thread_boundary(ctx->graph,
+				connection, THREAD_BOUNDARY_QUEUE_CAPACITY);
+		}
+
 		if (insert_trimmer) {
 			/*
 			 * The first connection, from the source to the trimmer,
@@ -1878,6 +1922,26 @@ int cmd_run_ctx_init(struct cmd_run_ctx *ctx, struct bt_config *cfg)
 		goto error;
 	}
 
+	if (cfg->cmd_data.run.msg_batch_size > 0) {
+		BT_LOGI("Setting graph's message batch size: "
+			"msg-batch-size=%" PRIu64,
+			cfg->cmd_data.run.msg_batch_size);
+		bt_graph_set_message_batch_size(ctx->graph,
+			cfg->cmd_data.run.msg_batch_size);
+	}
+
+	if (cfg->cmd_data.run.msg_pool_budget != UINT64_MAX) {
+		BT_LOGI("Setting graph's message pool memory budget: "
+			"budget=%" PRIu64, cfg->cmd_data.run.msg_pool_budget);
+		bt_graph_set_message_pool_memory_budget(ctx->graph,
+			cfg->cmd_data.run.msg_pool_budget);
+	}
+
+	if (cfg->cmd_data.run.print_stats) {
+		BT_LOGI_STR("Enabling graph's performance statistics.");
+		bt_graph_enable_performance_statistics(ctx->graph);
+	}
+
 	bt_graph_add_interrupter(ctx->graph, the_interrupter);
 	add_listener_status = bt_graph_add_source_component_output_port_added_listener(
 		ctx->graph, graph_source_output_port_added_listener, ctx,
@@ -2436,11 +2500,191 @@ end:
 	return ret;
 }
 
+/*
+ * Returns the value of the unsigned integer value entry `key` of the
+ * map value `map`.
+ */
+static
+uint64_t map_get_unsigned_integer(const bt_value *map, const char *key)
+{
+	const bt_value *value = bt_value_map_borrow_entry_value_const(map,
+		key);
+
+	BT_ASSERT(value);
+	return bt_value_integer_unsigned_get(value);
+}
+
+static
+double percent(uint64_t part, uint64_t whole)
+{
+	return whole == 0 ? 0. : 100. * (double) part / (double) whole;
+}
+
+/*
+ * Prints one line for the user method performance statistics
+ * `stats` (see bt_graph_get_performance_statistics()), starting with
+ * `prefix`.
+ */
+static
+void print_method_stats(FILE *fp, const char *prefix, const bt_value *stats,
+		bool with_msgs)
+{
+	uint64_t call_count = map_get_unsigned_integer(stats, "call-count");
+	uint64_t again_count = map_get_unsigned_integer(stats, "again-count");
+
+	fprintf(fp, "%s%" PRIu64 " calls, %" PRIu64 " \"try again\" (%.1f %%)",
+		prefix, call_count, again_count,
+		percent(again_count, call_count));
+
+	if (with_msgs) {
+		uint64_t msg_count = map_get_unsigned_integer(stats,
+			"message-count");
+
+		fprintf(fp, ", %" PRIu64 " messages (batch fill: %.1f %%)",
+			msg_count, percent(msg_count,
+				map_get_unsigned_integer(stats, "capacity")));
+	}
+
+	fprintf(fp, ", inclusive: %.6f s, exclusive: %.6f s\n",
+		(double) map_get_unsigned_integer(stats,
+			"inclusive-time-ns") / 1e9,
+		(double) map_get_unsigned_integer(stats,
+			"exclusive-time-ns") / 1e9);
+}
+
+/*
+ * Prints the performance statistics of the components of `graph` to
+ * the standard error.
+ */
+static
+void print_graph_stats(const bt_graph *graph)
+{
+	bt_value *stats = NULL;
+	const bt_value *comps;
+	uint64_t i;
+
+	if (bt_graph_get_performance_statistics(graph, &stats) !=
+			BT_GRAPH_GET_PERFORMANCE_STATISTICS_STATUS_OK) {
+		BT_LOGW_STR("Cannot get graph's performance statistics.");
+		bt_current_thread_clear_error();
+		goto end;
+	}
+
+	comps = bt_value_map_borrow_entry_value_const(stats, "components");
+	BT_ASSERT(comps);
+	fprintf(stderr, "Performance statistics:\n");
+
+	for (i = 0; i < bt_value_array_get_length(comps); i++) {
+		const bt_value *comp =
+			bt_value_array_borrow_element_by_index_const(comps, i);
+		const bt_value *consume_stats;
+		const bt_value *ports;
+		uint64_t j;
+
+		fprintf(stderr, "  Component `%s` (class `%s`):\n",
+			bt_value_string_get(
+				bt_value_map_borrow_entry_value_const(comp,
+					"name")),
+			bt_value_string_get(
+				bt_value_map_borrow_entry_value_const(comp,
+					"class-name")));
+		consume_stats = bt_value_map_borrow_entry_value_const(comp,
+			"consume");
+		if (consume_stats) {
+			print_method_stats(stderr, "    \"consume\" method: ",
+				consume_stats, false);
+		}
+
+		ports = bt_value_map_borrow_entry_value_const(comp,
+			"output-ports");
+		BT_ASSERT(ports);
+
+		for (j = 0; j < bt_value_array_get_length(ports); j++) {
+			const bt_value *port =
+				bt_value_array_borrow_element_by_index_const(
+					ports, j);
+
+			fprintf(stderr, "    Output port `%s`:\n",
+				bt_value_string_get(
+					bt_value_map_borrow_entry_value_const(
+						port, "name")));
+			print_method_stats(stderr, "      \"next\" method: ",
+				bt_value_map_borrow_entry_value_const(port,
+					"next"), true);
+		}
+	}
+
+	fflush(stderr);
+
+end:
+	bt_value_put_ref(stats);
+}
+
+/*
+ * Runs `graph` one sink consumption at a time, printing its
+ * performance statistics every `stats_interval_us` µs, starting from
+ * `*last_stats_time` (monotonic time, µs).
+ *
+ * When the graph needs to try again, waits until an upstream message
+ * iterator is ready, for `retry_duration_us` µs at most, but not beyond
+ * the time to print the next statistics, and returns
+ * `BT_GRAPH_RUN_STATUS_AGAIN`.
+ */
+static
+bt_graph_run_status run_graph_with_stats_interval(bt_graph *graph,
+		uint64_t stats_interval_us, uint64_t retry_duration_us,
+		gint64 *last_stats_time)
+{
+	bt_graph_run_status run_status;
+
+	while (true) {
+		bt_graph_run_once_status run_once_status;
+		uint64_t max_wait_us = retry_duration_us;
+		gint64 until_stats_us = *last_stats_time +
+			(gint64) stats_interval_us - g_get_monotonic_time();
+		gint64 now;
+
+		if (until_stats_us <= 0) {
+			max_wait_us = 0;
+		} else if ((uint64_t) until_stats_us < max_wait_us) {
+			max_wait_us = (uint64_t) until_stats_us;
+		}
+
+		run_once_status = bt_graph_run_once_and_wait(graph,
+			max_wait_us);
+		if (run_once_status == BT_GRAPH_RUN_ONCE_STATUS_END) {
+			run_status = BT_GRAPH_RUN_STATUS_OK;
+			goto end;
+		} else if (run_once_status != BT_GRAPH_RUN_ONCE_STATUS_OK &&
+				run_once_status != BT_GRAPH_RUN_ONCE_STATUS_AGAIN) {
+			/* Other status codes have the same values */
+			run_status = (bt_graph_run_status) run_once_status;
+			goto end;
+		}
+
+		/* Also print the statistics while the graph waits */
+		now = g_get_monotonic_time();
+		if (now - *last_stats_time >= (gint64) stats_interval_us) {
+			print_graph_stats(graph);
+			*last_stats_time = now;
+		}
+
+		if (run_once_status == BT_GRAPH_RUN_ONCE_STATUS_AGAIN) {
+			run_status = BT_GRAPH_RUN_STATUS_AGAIN;
+			goto end;
+		}
+	}
+
+end:
+	return run_status;
+}
+
 static
 enum bt_cmd_status cmd_run(struct bt_config *cfg)
 {
 	enum bt_cmd_status cmd_status;
 	struct cmd_run_ctx ctx = { 0 };
+	gint64 last_stats_time;
 
 	/* Initialize the command's context and the graph object */
 	if (cmd_run_ctx_init(&ctx, cfg)) {
@@ -2480,9 +2724,31 @@ enum bt_cmd_status cmd_run(struct bt_config *cfg)
 
 	BT_LOGI_STR("Running the graph.");
 
-	/* Run the graph */
+	/*
+	 * Run the graph.
+	 *
+	 * When the graph needs to try again,
+	 * bt_graph_run_and_wait() waits until an upstream message
+	 * iterator is ready, or for the retry duration at most.
+	 *
+	 * To print the performance statistics periodically, run the
+	 * graph one sink consumption at a time instead, with
+	 * bt_graph_run_once_and_wait().
+	 */
+	last_stats_time = g_get_monotonic_time();
+
 	while (true) {
-		bt_graph_run_status run_status = bt_graph_run(ctx.graph);
+		bt_graph_run_status run_status;
+
+		if (cfg->cmd_data.run.stats_interval_us > 0) {
+			run_status = run_graph_with_stats_interval(ctx.graph,
+				cfg->cmd_data.run.stats_interval_us,
+				cfg->cmd_data.run.retry_duration_us,
+				&last_stats_time);
+		} else {
+			run_status = bt_graph_run_and_wait(ctx.graph,
+				cfg->cmd_data.run.retry_duration_us);
+		}
 
 		/*
 		 * Reset console in case something messed with console
@@ -2491,7 +2757,7 @@ enum bt_cmd_status cmd_run(struct bt_config *cfg)
 		printf("%s", bt_common_color_reset());
 		fflush(stdout);
 		fprintf(stderr, "%s", bt_common_color_reset());
-		BT_LOGT("bt_graph_run() returned: status=%s",
+		BT_LOGT("Ran the graph: status=%s",
 			bt_common_func_status_string(run_status));
 
 		switch (run_status) {
@@ -2507,18 +2773,6 @@ enum bt_cmd_status cmd_run(struct bt_config *cfg)
 				goto end;
 			}
 
-			if (cfg->cmd_data.run.retry_duration_us > 0) {
-				BT_LOGT("Got BT_GRAPH_RUN_STATUS_AGAIN: sleeping: "
-					"time-us=%" PRIu64,
-					cfg->cmd_data.run.retry_duration_us);
-
-				if (usleep(cfg->cmd_data.run.retry_duration_us)) {
-					if (bt_interrupter_is_set(the_interrupter)) {
-						cmd_status = BT_CMD_STATUS_INTERRUPTED;
-						goto end;
-					}
-				}
-			}
 			break;
 		default:
 			if (bt_interrupter_is_set(the_interrupter)) {
@@ -2535,6 +2789,22 @@ error:
 	cmd_status = BT_CMD_STATUS_ERROR;
 
 end:
+	if (ctx.graph) {
+		uint64_t alloc_count, reuse_count, discard_count;
+
+		bt_graph_get_message_pool_statistics(ctx.graph, &alloc_count,
+			&reuse_count, &discard_count);
+		BT_LOGI("Graph's message pool statistics: "
+			"alloc-count=%" PRIu64 ", reuse-count=%" PRIu64 ", "
+			"discard-count=%" PRIu64 ", mem-size=%" PRIu64,
+			alloc_count, reuse_count, discard_count,
+			bt_graph_get_message_pool_memory_size(ctx.graph));
+
+		if (cfg->cmd_data.run.print_stats) {
+			print_graph_stats(ctx.graph);
+		}
+	}
+
 	cmd_run_ctx_destroy(&ctx);
 	return cmd_status;
 }
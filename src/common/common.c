@@ -38,6 +38,14 @@
 #define HOME_ENV_VAR		"HOME"
 #define HOME_PLUGIN_SUBPATH	"/.local/lib/babeltrace2/plugins"
 
+/*
+ * See `lib/object.h`. This lives here, and not in the library, because
+ * the CLI also uses the library's internal object API for its own
+ * configuration objects.
+ */
+BT_HIDDEN
+bool bt_object_multithreaded;
+
 static const char *bt_common_color_code_reset = "";
 static const char *bt_common_color_code_bold = "";
 static const char *bt_common_color_code_fg_default = "";
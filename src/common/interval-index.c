@@ -0,0 +1,236 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (C) 2023 EfficiOS Inc.
+ */
+
+#include <glib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "common/assert.h"
+#include "common/interval-index.h"
+
+/*
+ * Beginning (`lower`) or end (`upper + 1`) of an interval.
+ */
+struct event {
+	uint64_t pos;
+	bool is_end;
+	uint64_t item;
+};
+
+static
+gint compare_events(gconstpointer a, gconstpointer b)
+{
+	const struct event *event_a = a;
+	const struct event *event_b = b;
+
+	if (event_a->pos != event_b->pos) {
+		return event_a->pos < event_b->pos ? -1 : 1;
+	}
+
+	/* Ends first */
+	return (int) event_b->is_end - (int) event_a->is_end;
+}
+
+/*
+ * Returns the index of the first item of the sorted array `items` which
+ * is greater than or equal to `item`.
+ */
+static
+guint lower_bound(const GArray *items, uint64_t item)
+{
+	guint low = 0;
+	guint high = items->len;
+
+	while (low < high) {
+		const guint mid = low + (high - low) / 2;
+
+		if (g_array_index(items, uint64_t, mid) < item) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+
+	return low;
+}
+
+/*
+ * Appends the segment [`lower`, `upper`] of which the items are the
+ * unique items of the sorted multiset `active`, extending the last
+ * segment instead if it's contiguous and has the same items.
+ */
+static
+void append_segment(GArray *segments, GArray *items, const GArray *active,
+		uint64_t lower, uint64_t upper)
+{
+	struct bt_interval_index_segment segment = {
+		.lower = lower,
+		.upper = upper,
+		.items_index = items->len,
+		.item_count = 0,
+	};
+	guint i;
+
+	for (i = 0; i < active->len; i++) {
+		const uint64_t item = g_array_index(active, uint64_t, i);
+
+		if (i > 0 && item == g_array_index(active, uint64_t, i - 1)) {
+			continue;
+		}
+
+		g_array_append_val(items, item);
+		segment.item_count++;
+	}
+
+	if (segments->len > 0) {
+		struct bt_interval_index_segment *prev = &g_array_index(
+			segments, struct bt_interval_index_segment,
+			segments->len - 1);
+
+		if (prev->upper + 1 == lower &&
+				prev->item_count == segment.item_count &&
+				memcmp(&g_array_index(items, uint64_t,
+					prev->items_index),
+					&g_array_index(items, uint64_t,
+					segment.items_index),
+					segment.item_count * sizeof(uint64_t)) == 0) {
+			prev->upper = upper;
+			g_array_set_size(items, segment.items_index);
+			return;
+		}
+	}
+
+	g_array_append_val(segments, segment);
+}
+
+BT_HIDDEN
+struct bt_interval_index *bt_interval_index_create(
+		const struct bt_interval_index_range *ranges, uint64_t count)
+{
+	struct bt_interval_index *index = NULL;
+	GArray *events = NULL;
+	GArray *active = NULL;
+	GArray *segments = NULL;
+	GArray *items = NULL;
+	uint64_t i;
+	guint event_i = 0;
+
+	BT_ASSERT(ranges || count == 0);
+	events = g_array_sized_new(FALSE, FALSE, sizeof(struct event),
+		count * 2);
+	active = g_array_new(FALSE, FALSE, sizeof(uint64_t));
+	segments = g_array_new(FALSE, FALSE,
+		sizeof(struct bt_interval_index_segment));
+	items = g_array_new(FALSE, FALSE, sizeof(uint64_t));
+	index = g_new0(struct bt_interval_index, 1);
+	if (!events || !active || !segments || !items || !index) {
+		goto error;
+	}
+
+	for (i = 0; i < count; i++) {
+		struct event event = {
+			.pos = ranges[i].lower,
+			.is_end = false,
+			.item = ranges[i].item,
+		};
+
+		BT_ASSERT(ranges[i].lower <= ranges[i].upper);
+		g_array_append_val(events, event);
+
+		/* An interval ending at `UINT64_MAX` never ends */
+		if (ranges[i].upper != UINT64_MAX) {
+			event.pos = ranges[i].upper + 1;
+			event.is_end = true;
+			g_array_append_val(events, event);
+		}
+	}
+
+	g_array_sort(events, compare_events);
+
+	/*
+	 * Sweep the interval boundaries, maintaining the sorted multiset
+	 * of the items of the intervals which contain the current
+	 * position.
+	 */
+	while (event_i < events->len) {
+		const uint64_t pos = g_array_index(events, struct event,
+			event_i).pos;
+
+		for (; event_i < events->len; event_i++) {
+			const struct event *event = &g_array_index(events,
+				struct event, event_i);
+			guint item_i;
+
+			if (event->pos != pos) {
+				break;
+			}
+
+			item_i = lower_bound(active, event->item);
+
+			if (event->is_end) {
+				BT_ASSERT(item_i < active->len);
+				BT_ASSERT(g_array_index(active, uint64_t,
+					item_i) == event->item);
+				g_array_remove_index(active, item_i);
+			} else {
+				g_array_insert_val(active, item_i, event->item);
+			}
+		}
+
+		if (active->len == 0) {
+			continue;
+		}
+
+		append_segment(segments, items, active, pos,
+			event_i < events->len ?
+				g_array_index(events, struct event,
+					event_i).pos - 1 :
+				UINT64_MAX);
+	}
+
+	index->segment_count = segments->len;
+	index->segments = (void *) g_array_free(segments, FALSE);
+	segments = NULL;
+	index->items = (void *) g_array_free(items, FALSE);
+	items = NULL;
+	goto end;
+
+error:
+	g_free(index);
+	index = NULL;
+
+end:
+	if (events) {
+		g_array_free(events, TRUE);
+	}
+
+	if (active) {
+		g_array_free(active, TRUE);
+	}
+
+	if (segments) {
+		g_array_free(segments, TRUE);
+	}
+
+	if (items) {
+		g_array_free(items, TRUE);
+	}
+
+	return index;
+}
+
+BT_HIDDEN
+void bt_interval_index_destroy(struct bt_interval_index *index)
+{
+	if (!index) {
+		return;
+	}
+
+	g_free(index->segments);
+	g_free(index->items);
+	g_free(index);
+}
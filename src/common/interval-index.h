@@ -0,0 +1,115 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (C) 2023 EfficiOS Inc.
+ */
+
+#ifndef _BABELTRACE_COMMON_INTERVAL_INDEX_H
+#define _BABELTRACE_COMMON_INTERVAL_INDEX_H
+
+#include <stdint.h>
+
+#include "common/assert.h"
+#include "common/macros.h"
+
+/*
+ * Immutable index of (possibly overlapping) closed integer intervals,
+ * each one associated to an item (for example, the index of an
+ * enumeration field class mapping or of a variant field class option).
+ *
+ * bt_interval_index_create() splits the intervals into sorted,
+ * disjoint segments, each one containing the sorted, unique items of
+ * all the intervals which contain it, so that
+ * bt_interval_index_lookup() only needs a binary search.
+ *
+ * The index only knows unsigned keys: use
+ * bt_interval_index_signed_key() to convert signed interval bounds and
+ * lookup keys.
+ */
+struct bt_interval_index_range {
+	/* Inclusive bounds */
+	uint64_t lower;
+	uint64_t upper;
+
+	uint64_t item;
+};
+
+struct bt_interval_index_segment {
+	/* Inclusive bounds */
+	uint64_t lower;
+	uint64_t upper;
+
+	/* Index of the first item of this segment within `items` */
+	uint64_t items_index;
+
+	/* Number of items (at least one) */
+	uint64_t item_count;
+};
+
+struct bt_interval_index {
+	/* Sorted by lower bound; no two segments overlap */
+	struct bt_interval_index_segment *segments;
+	uint64_t segment_count;
+
+	uint64_t *items;
+};
+
+/*
+ * Creates an index of the `count` intervals `ranges`.
+ *
+ * Returns `NULL` on memory error.
+ */
+BT_HIDDEN
+struct bt_interval_index *bt_interval_index_create(
+		const struct bt_interval_index_range *ranges, uint64_t count);
+
+BT_HIDDEN
+void bt_interval_index_destroy(struct bt_interval_index *index);
+
+/*
+ * Maps a signed value to an unsigned key, preserving the order.
+ */
+static inline
+uint64_t bt_interval_index_signed_key(int64_t value)
+{
+	return ((uint64_t) value) ^ (UINT64_C(1) << 63);
+}
+
+/*
+ * Returns the sorted, unique items of all the intervals of `index`
+ * which contain `key`, setting `*count` to their number, or returns
+ * `NULL` (`*count` is 0) if there's none.
+ */
+static inline
+const uint64_t *bt_interval_index_lookup(const struct bt_interval_index *index,
+		uint64_t key, uint64_t *count)
+{
+	uint64_t low = 0;
+	uint64_t high;
+
+	BT_ASSERT_DBG(index);
+	BT_ASSERT_DBG(count);
+	high = index->segment_count;
+
+	/* Find the first segment of which the upper bound is >= `key` */
+	while (low < high) {
+		const uint64_t mid = low + (high - low) / 2;
+
+		if (index->segments[mid].upper < key) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+
+	if (low == index->segment_count ||
+			index->segments[low].lower > key) {
+		*count = 0;
+		return NULL;
+	}
+
+	*count = index->segments[low].item_count;
+	return &index->items[index->segments[low].items_index];
+}
+
+#endif /* _BABELTRACE_COMMON_INTERVAL_INDEX_H */
@@ -59,4 +59,145 @@ end:
 }
 #endif
 
+/*
+ * GMutex and GCond became embeddable structures, initialized with
+ * g_mutex_init() and g_cond_init(), in glib 2.32, which also deprecated
+ * g_thread_init(). Those wrappers always allocate them so that users
+ * don't have to care.
+ *
+ * g_cond_wait_until() also appeared in glib 2.32, which deprecated
+ * g_cond_timed_wait().
+ */
+#if GLIB_CHECK_VERSION(2,32,0)
+
+static inline void
+bt_g_thread_init(void)
+{
+}
+
+static inline GMutex *
+bt_g_mutex_new(void)
+{
+	GMutex *mutex = g_new0(GMutex, 1);
+
+	if (mutex) {
+		g_mutex_init(mutex);
+	}
+
+	return mutex;
+}
+
+static inline void
+bt_g_mutex_free(GMutex *mutex)
+{
+	if (mutex) {
+		g_mutex_clear(mutex);
+		g_free(mutex);
+	}
+}
+
+static inline GCond *
+bt_g_cond_new(void)
+{
+	GCond *cond = g_new0(GCond, 1);
+
+	if (cond) {
+		g_cond_init(cond);
+	}
+
+	return cond;
+}
+
+static inline void
+bt_g_cond_free(GCond *cond)
+{
+	if (cond) {
+		g_cond_clear(cond);
+		g_free(cond);
+	}
+}
+
+/*
+ * Waits for `cond`, with `mutex` locked, for at most `timeout_us`
+ * microseconds.
+ */
+static inline void
+bt_g_cond_wait_for(GCond *cond, GMutex *mutex, gint64 timeout_us)
+{
+	(void) g_cond_wait_until(cond, mutex,
+		g_get_monotonic_time() + timeout_us);
+}
+
+#else
+
+static inline void
+bt_g_thread_init(void)
+{
+	if (!g_thread_supported()) {
+		g_thread_init(NULL);
+	}
+}
+
+static inline GMutex *
+bt_g_mutex_new(void)
+{
+	return g_mutex_new();
+}
+
+static inline void
+bt_g_mutex_free(GMutex *mutex)
+{
+	if (mutex) {
+		g_mutex_free(mutex);
+	}
+}
+
+static inline GCond *
+bt_g_cond_new(void)
+{
+	return g_cond_new();
+}
+
+static inline void
+bt_g_cond_free(GCond *cond)
+{
+	if (cond) {
+		g_cond_free(cond);
+	}
+}
+
+static inline void
+bt_g_cond_wait_for(GCond *cond, GMutex *mutex, gint64 timeout_us)
+{
+	GTimeVal abs_time;
+
+	g_get_current_time(&abs_time);
+	g_time_val_add(&abs_time, (glong) timeout_us);
+	(void) g_cond_timed_wait(cond, mutex, &abs_time);
+}
+
+#endif
+
+/*
+ * g_thread_try_new() appeared in glib 2.32, which deprecated
+ * g_thread_create().
+ */
+#if GLIB_CHECK_VERSION(2,32,0)
+
+static inline GThread *
+bt_g_thread_new(const gchar *name, GThreadFunc func, gpointer data)
+{
+	return g_thread_try_new(name, func, data, NULL);
+}
+
+#else
+
+static inline GThread *
+bt_g_thread_new(const gchar *name, GThreadFunc func, gpointer data)
+{
+	return g_thread_create(func, data, TRUE, NULL);
+}
+
+#endif
+
 #endif /* _BABELTRACE_COMPAT_GLIB_H */
@@ -40,8 +40,18 @@ int bt_munmap(void *addr, size_t length);
  */
 size_t bt_mmap_get_offset_align_size(int log_level);
 
+/*
+ * Read-ahead hints are not supported on Windows.
+ */
+static inline
+int bt_mmap_read_ahead(int fd, off_t offset, off_t length)
+{
+	return 0;
+}
+
 #else /* __MINGW32__ */
 
+#include <fcntl.h>
 #include <sys/mman.h>
 #include "common/common.h"
 
@@ -67,6 +77,24 @@ size_t bt_mmap_get_offset_align_size(int log_level)
 {
 	return bt_common_get_page_size(log_level);
 }
+
+/*
+ * Asks the kernel to asynchronously read the `length` bytes of the file
+ * `fd` at `offset` into the page cache, so that a future access to a
+ * mapping of this region doesn't block on I/O.
+ *
+ * This is only a hint: returns 0 when the platform doesn't support it,
+ * or an error number otherwise.
+ */
+static inline
+int bt_mmap_read_ahead(int fd, off_t offset, off_t length)
+{
+#ifdef POSIX_FADV_WILLNEED
+	return posix_fadvise(fd, offset, length, POSIX_FADV_WILLNEED);
+#else
+	return 0;
+#endif
+}
 #endif /* __MINGW32__ */
 
 #ifndef MAP_ANONYMOUS
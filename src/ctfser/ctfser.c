@@ -21,6 +21,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <wchar.h>
+#include <zlib.h>
 #include "common/macros.h"
 #include "common/common.h"
 #include "ctfser/ctfser.h"
@@ -33,55 +34,310 @@ uint64_t get_packet_size_increment_bytes(struct bt_ctfser *ctfser)
 	return bt_common_get_page_size(ctfser->log_level) * 8;
 }
 
+/*
+ * Minimum size of the memory map of the stream file.
+ *
+ * This is large enough for many typical packets: the serializer only
+ * remaps the stream file, and only preallocates more space, once per
+ * such chunk instead of once per packet.
+ */
+static inline
+uint64_t get_min_mmap_size_bytes(struct bt_ctfser *ctfser)
+{
+	return bt_common_get_page_size(ctfser->log_level) * 256;
+}
+
 static inline
 void mmap_align_ctfser(struct bt_ctfser *ctfser)
 {
-	ctfser->base_mma = mmap_align(ctfser->cur_packet_size_bytes,
+	ctfser->base_mma = mmap_align(ctfser->mmap_size_bytes,
 		PROT_READ | PROT_WRITE,
 		MAP_SHARED, ctfser->fd, ctfser->mmap_offset, ctfser->log_level);
 }
 
-BT_HIDDEN
-int _bt_ctfser_increase_cur_packet_size(struct bt_ctfser *ctfser)
+/*
+ * Unmaps the stream file, if it's mapped.
+ */
+static
+int unmap_ctfser(struct bt_ctfser *ctfser)
 {
-	int ret;
+	int ret = 0;
+
+	if (!ctfser->base_mma) {
+		goto end;
+	}
 
-	BT_ASSERT(ctfser);
-	BT_LOGD("Increasing stream file's current packet size: "
-		"path=\"%s\", fd=%d, "
-		"offset-in-cur-packet-bits=%" PRIu64 ", "
-		"cur-packet-size-bytes=%" PRIu64,
-		ctfser->path->str, ctfser->fd,
-		ctfser->offset_in_cur_packet_bits,
-		ctfser->cur_packet_size_bytes);
 	ret = munmap_align(ctfser->base_mma);
 	if (ret) {
-		BT_LOGE_ERRNO("Failed to perform an aligned memory unmapping",
-			": ret=%d", ret);
+		BT_LOGE_ERRNO("Failed to unmap stream file",
+			": ret=%d, size-bytes=%" PRIu64,
+			ret, ctfser->stream_size_bytes);
 		goto end;
 	}
 
-	ctfser->cur_packet_size_bytes += get_packet_size_increment_bytes(
-		ctfser);
+	ctfser->base_mma = NULL;
 
-	do {
-		ret = bt_posix_fallocate(ctfser->fd, ctfser->mmap_offset,
-			ctfser->cur_packet_size_bytes);
-	} while (ret == EINTR);
+end:
+	return ret;
+}
 
+/*
+ * Maps the stream file, from the offset `offset` (bytes), making the
+ * memory map at least `min_size_bytes` bytes.
+ *
+ * This function preallocates the stream file's space up to the end of
+ * the new memory map if needed, so that writing to the memory map never
+ * goes beyond the end of the file.
+ */
+static
+int map_ctfser(struct bt_ctfser *ctfser, off_t offset, uint64_t min_size_bytes)
+{
+	int ret;
+	uint64_t mmap_end;
+
+	ret = unmap_ctfser(ctfser);
 	if (ret) {
-		BT_LOGE("Failed to preallocate memory space: ret=%d", ret);
 		goto end;
 	}
 
+	/* Grow geometrically */
+	ctfser->mmap_size_bytes = MAX(ctfser->mmap_size_bytes,
+		get_min_mmap_size_bytes(ctfser));
+
+	while (ctfser->mmap_size_bytes < min_size_bytes) {
+		ctfser->mmap_size_bytes *= 2;
+	}
+
+	ctfser->mmap_offset = offset;
+	ctfser->mmap_base_offset = 0;
+	mmap_end = (uint64_t) offset + ctfser->mmap_size_bytes;
+	if (mmap_end > ctfser->alloc_size_bytes) {
+		do {
+			ret = bt_posix_fallocate(ctfser->fd,
+				(off_t) ctfser->alloc_size_bytes,
+				(off_t) (mmap_end - ctfser->alloc_size_bytes));
+		} while (ret == EINTR);
+
+		if (ret) {
+			BT_LOGE("Failed to preallocate memory space: ret=%d", ret);
+			goto end;
+		}
+
+		ctfser->alloc_size_bytes = mmap_end;
+	}
+
 	mmap_align_ctfser(ctfser);
 	if (ctfser->base_mma == MAP_FAILED) {
 		BT_LOGE_ERRNO("Failed to perform an aligned memory mapping",
 			": ret=%d", ret);
+		ctfser->base_mma = NULL;
+		ret = -1;
+		goto end;
+	}
+
+	BT_LOGD("Mapped stream file: path=\"%s\", fd=%d, "
+		"mmap-offset=%jd, mmap-size-bytes=%" PRIu64,
+		ctfser->path->str, ctfser->fd,
+		(intmax_t) ctfser->mmap_offset, ctfser->mmap_size_bytes);
+
+end:
+	return ret;
+}
+
+/*
+ * Replaces the anonymous memory map of a compressing serializer with a
+ * new one of at least `min_size_bytes` bytes, copying the first
+ * `keep_size_bytes` bytes of the current memory map to it.
+ */
+static
+int map_gz_ctfser(struct bt_ctfser *ctfser, uint64_t min_size_bytes,
+		uint64_t keep_size_bytes)
+{
+	int ret = 0;
+	struct mmap_align *base_mma;
+	uint64_t mmap_size_bytes = MAX(ctfser->mmap_size_bytes,
+		get_min_mmap_size_bytes(ctfser));
+
+	BT_ASSERT(ctfser->gz_stream);
+	BT_ASSERT(keep_size_bytes <= ctfser->mmap_size_bytes);
+
+	/* Grow geometrically */
+	while (mmap_size_bytes < min_size_bytes) {
+		mmap_size_bytes *= 2;
+	}
+
+	/* Anonymous memory is zeroed: padding bytes are 0 */
+	base_mma = mmap_align(mmap_size_bytes, PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS, -1, 0, ctfser->log_level);
+	if (base_mma == MAP_FAILED) {
+		BT_LOGE_ERRNO("Failed to perform an aligned memory mapping",
+			": size-bytes=%" PRIu64, mmap_size_bytes);
 		ret = -1;
 		goto end;
 	}
 
+	if (ctfser->base_mma) {
+		memcpy(mmap_align_addr(base_mma),
+			mmap_align_addr(ctfser->base_mma), keep_size_bytes);
+		ret = unmap_ctfser(ctfser);
+		if (ret) {
+			munmap_align(base_mma);
+			goto end;
+		}
+	}
+
+	ctfser->base_mma = base_mma;
+	ctfser->mmap_size_bytes = mmap_size_bytes;
+	ctfser->mmap_offset = 0;
+	ctfser->mmap_base_offset = 0;
+	BT_LOGD("Mapped packet buffer: path=\"%s\", fd=%d, "
+		"mmap-size-bytes=%" PRIu64,
+		ctfser->path->str, ctfser->fd, ctfser->mmap_size_bytes);
+
+end:
+	return ret;
+}
+
+/*
+ * Writes the `size` bytes of `buf` to the stream file at its current
+ * position.
+ */
+static
+int write_gz_ctfser_bytes(struct bt_ctfser *ctfser, const uint8_t *buf,
+		size_t size)
+{
+	int ret = 0;
+
+	while (size > 0) {
+		ssize_t write_ret = write(ctfser->fd, buf, size);
+
+		if (write_ret < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+
+			BT_LOGE_ERRNO("Failed to write to stream file",
+				": path=\"%s\", fd=%d",
+				ctfser->path->str, ctfser->fd);
+			ret = -1;
+			goto end;
+		}
+
+		buf += write_ret;
+		size -= write_ret;
+	}
+
+end:
+	return ret;
+}
+
+/*
+ * Compresses the `size_bytes` bytes of `buf`, writing the compressed
+ * bytes to the stream file.
+ *
+ * If `finish` is true, this function also ends the current gzip
+ * member: the next compressed byte begins a new member.
+ */
+static
+int deflate_gz_ctfser(struct bt_ctfser *ctfser, const uint8_t *buf,
+		uint64_t size_bytes, bool finish)
+{
+	int ret = 0;
+	z_stream *strm = ctfser->gz_stream;
+	uint8_t out[64 * 1024];
+
+	BT_ASSERT(strm);
+
+	do {
+		int flush = Z_NO_FLUSH;
+		int z_ret;
+
+		if (strm->avail_in == 0 && size_bytes > 0) {
+			/* zlib's input size is an `unsigned int` */
+			strm->next_in = (Bytef *) buf;
+			strm->avail_in = (uInt) MIN(size_bytes,
+				(uint64_t) UINT_MAX);
+			buf += strm->avail_in;
+			size_bytes -= strm->avail_in;
+		}
+
+		if (finish && size_bytes == 0) {
+			flush = Z_FINISH;
+		}
+
+		strm->next_out = out;
+		strm->avail_out = sizeof(out);
+		z_ret = deflate(strm, flush);
+		if (z_ret != Z_OK && z_ret != Z_STREAM_END &&
+				z_ret != Z_BUF_ERROR) {
+			BT_LOGE("Failed to compress packet: path=\"%s\", "
+				"ret=%d", ctfser->path->str, z_ret);
+			ret = -1;
+			goto end;
+		}
+
+		ret = write_gz_ctfser_bytes(ctfser, out,
+			sizeof(out) - strm->avail_out);
+		if (ret) {
+			goto end;
+		}
+
+		if (z_ret == Z_STREAM_END) {
+			/* Next packet: new gzip member */
+			z_ret = deflateReset(strm);
+			BT_ASSERT(z_ret == Z_OK);
+			goto end;
+		}
+	} while (finish || strm->avail_in > 0 || size_bytes > 0 ||
+		strm->avail_out == 0);
+
+end:
+	return ret;
+}
+
+BT_HIDDEN
+int _bt_ctfser_increase_cur_packet_size(struct bt_ctfser *ctfser)
+{
+	int ret;
+	off_t packet_offset;
+	uint64_t new_size_bytes;
+
+	BT_ASSERT(ctfser);
+	BT_LOGD("Increasing stream file's current packet size: "
+		"path=\"%s\", fd=%d, "
+		"offset-in-cur-packet-bits=%" PRIu64 ", "
+		"cur-packet-size-bytes=%" PRIu64,
+		ctfser->path->str, ctfser->fd,
+		ctfser->offset_in_cur_packet_bits,
+		ctfser->cur_packet_size_bytes);
+
+	new_size_bytes = MAX(ctfser->cur_packet_size_bytes * 2,
+		ctfser->cur_packet_size_bytes +
+			get_packet_size_increment_bytes(ctfser));
+
+	if (ctfser->gz_stream) {
+		/*
+		 * The bytes written so far are only in the memory map:
+		 * keep them.
+		 */
+		ret = map_gz_ctfser(ctfser, new_size_bytes,
+			ctfser->cur_packet_size_bytes);
+	} else {
+		/*
+		 * Map the stream file again from the current packet's
+		 * first byte, making room for at least twice the
+		 * current packet's size. The bytes written so far are
+		 * in the file already.
+		 */
+		packet_offset = ctfser->mmap_offset + ctfser->mmap_base_offset;
+		ret = map_ctfser(ctfser, packet_offset, new_size_bytes);
+	}
+
+	if (ret) {
+		goto end;
+	}
+
+	ctfser->cur_packet_size_bytes = ctfser->mmap_size_bytes;
 	BT_LOGD("Increased packet size: "
 		"path=\"%s\", fd=%d, "
 		"offset-in-cur-packet-bits=%" PRIu64 ", "
@@ -94,8 +350,9 @@ end:
 	return ret;
 }
 
-BT_HIDDEN
-int bt_ctfser_init(struct bt_ctfser *ctfser, const char *path, int log_level)
+static
+int init_ctfser(struct bt_ctfser *ctfser, const char *path, bool gzip,
+		int log_level)
 {
 	int ret = 0;
 
@@ -114,10 +371,46 @@ int bt_ctfser_init(struct bt_ctfser *ctfser, const char *path, int log_level)
 
 	ctfser->path = g_string_new(path);
 
+	if (gzip) {
+		int z_ret;
+
+		ctfser->gz_stream = g_new0(z_stream, 1);
+		if (!ctfser->gz_stream) {
+			BT_LOGE_STR("Failed to allocate a zlib stream.");
+			ret = -1;
+			goto end;
+		}
+
+		/* 16: write a gzip header and trailer */
+		z_ret = deflateInit2(ctfser->gz_stream, Z_DEFAULT_COMPRESSION,
+			Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY);
+		if (z_ret != Z_OK) {
+			BT_LOGE("Failed to initialize zlib stream: "
+				"path=\"%s\", ret=%d", path, z_ret);
+			g_free(ctfser->gz_stream);
+			ctfser->gz_stream = NULL;
+			ret = -1;
+			goto end;
+		}
+	}
+
 end:
 	return ret;
 }
 
+BT_HIDDEN
+int bt_ctfser_init(struct bt_ctfser *ctfser, const char *path, int log_level)
+{
+	return init_ctfser(ctfser, path, false, log_level);
+}
+
+BT_HIDDEN
+int bt_ctfser_init_gzip(struct bt_ctfser *ctfser, const char *path,
+		int log_level)
+{
+	return init_ctfser(ctfser, path, true, log_level);
+}
+
 BT_HIDDEN
 int bt_ctfser_fini(struct bt_ctfser *ctfser)
 {
@@ -127,23 +420,19 @@ int bt_ctfser_fini(struct bt_ctfser *ctfser)
 		goto free_path;
 	}
 
-	if (ctfser->base_mma) {
-		/* Unmap old base */
-		ret = munmap_align(ctfser->base_mma);
-		if (ret) {
-			BT_LOGE_ERRNO("Failed to unmap stream file",
-				": ret=%d, size-bytes=%" PRIu64,
-				ret, ctfser->stream_size_bytes);
-			goto end;
-		}
+	ret = unmap_ctfser(ctfser);
+	if (ret) {
+		goto end;
+	}
 
-		ctfser->base_mma = NULL;
+	if (ctfser->gz_stream) {
+		/* A compressed stream file is never preallocated */
+		goto close_file;
 	}
 
 	/*
 	 * Truncate the stream file's size to the minimum required to
-	 * fit the last packet as we might have grown it too much during
-	 * the last memory map.
+	 * fit the last packet as we preallocated space by chunks.
 	 */
 	do {
 		ret = ftruncate(ctfser->fd, ctfser->stream_size_bytes);
@@ -156,7 +445,7 @@ int bt_ctfser_fini(struct bt_ctfser *ctfser)
 		goto end;
 	}
 
-
+close_file:
 	ret = close(ctfser->fd);
 	if (ret) {
 		BT_LOGE_ERRNO("Failed to close stream file",
@@ -167,6 +456,12 @@ int bt_ctfser_fini(struct bt_ctfser *ctfser)
 	ctfser->fd = -1;
 
 free_path:
+	if (ctfser->gz_stream) {
+		(void) deflateEnd(ctfser->gz_stream);
+		g_free(ctfser->gz_stream);
+		ctfser->gz_stream = NULL;
+	}
+
 	if (ctfser->path) {
 		g_string_free(ctfser->path, TRUE);
 		ctfser->path = NULL;
@@ -180,58 +475,52 @@ BT_HIDDEN
 int bt_ctfser_open_packet(struct bt_ctfser *ctfser)
 {
 	int ret = 0;
+	off_t packet_offset;
+	uint64_t min_packet_size_bytes =
+		get_packet_size_increment_bytes(ctfser);
 
 	BT_LOGD("Opening packet: path=\"%s\", fd=%d, "
 		"prev-packet-size-bytes=%" PRIu64,
 		ctfser->path->str, ctfser->fd,
 		ctfser->prev_packet_size_bytes);
 
-	if (ctfser->base_mma) {
-		/* Unmap old base (previous packet) */
-		ret = munmap_align(ctfser->base_mma);
+	/* Start writing immediately after the previous packet */
+	packet_offset = (off_t) ctfser->stream_size_bytes;
+	ctfser->prev_packet_size_bytes = 0;
+
+	if (ctfser->gz_stream) {
+		/*
+		 * The packet always begins at the beginning of the
+		 * anonymous memory map.
+		 */
+		if (!ctfser->base_mma ||
+				ctfser->mmap_size_bytes < min_packet_size_bytes) {
+			ret = map_gz_ctfser(ctfser, min_packet_size_bytes, 0);
+			if (ret) {
+				goto end;
+			}
+		}
+	} else if (ctfser->base_mma &&
+			(uint64_t) packet_offset + min_packet_size_bytes <=
+			(uint64_t) ctfser->mmap_offset +
+				ctfser->mmap_size_bytes) {
+		/* Reuse the current memory map */
+		BT_ASSERT(packet_offset >= ctfser->mmap_offset);
+		ctfser->mmap_base_offset = packet_offset - ctfser->mmap_offset;
+	} else {
+		ret = map_ctfser(ctfser, packet_offset, min_packet_size_bytes);
 		if (ret) {
-			BT_LOGE_ERRNO("Failed to unmap stream file",
-				": ret=%d, size-bytes=%" PRIu64,
-				ret, ctfser->stream_size_bytes);
 			goto end;
 		}
-
-		ctfser->base_mma = NULL;
 	}
 
-	/*
-	 * Add the previous packet's size to the memory map address
-	 * offset to start writing immediately after it.
-	 */
-	ctfser->mmap_offset += ctfser->prev_packet_size_bytes;
-	ctfser->prev_packet_size_bytes = 0;
-
-	/* Make initial space for the current packet */
-	ctfser->cur_packet_size_bytes = get_packet_size_increment_bytes(
-		ctfser);
-
-	do {
-		ret = bt_posix_fallocate(ctfser->fd, ctfser->mmap_offset,
-			ctfser->cur_packet_size_bytes);
-	} while (ret == EINTR);
-
-	if (ret) {
-		BT_LOGE("Failed to preallocate memory space: ret=%d", ret);
-		goto end;
-	}
+	/* The current packet may use the rest of the memory map */
+	ctfser->cur_packet_size_bytes = ctfser->mmap_size_bytes -
+		(uint64_t) ctfser->mmap_base_offset;
 
 	/* Start writing at the beginning of the current packet */
 	ctfser->offset_in_cur_packet_bits = 0;
 
-	/* Get new base address */
-	mmap_align_ctfser(ctfser);
-	if (ctfser->base_mma == MAP_FAILED) {
-		BT_LOGE_ERRNO("Failed to perform an aligned memory mapping",
-			": ret=%d", ret);
-		ret = -1;
-		goto end;
-	}
-
 	BT_LOGD("Opened packet: path=\"%s\", fd=%d, "
 		"cur-packet-size-bytes=%" PRIu64,
 		ctfser->path->str, ctfser->fd,
@@ -242,9 +531,11 @@ end:
 }
 
 BT_HIDDEN
-void bt_ctfser_close_current_packet(struct bt_ctfser *ctfser,
+int bt_ctfser_close_current_packet(struct bt_ctfser *ctfser,
 		uint64_t packet_size_bytes)
 {
+	int ret = 0;
+
 	BT_LOGD("Closing packet: path=\"%s\", fd=%d, "
 		"offset-in-cur-packet-bits=%" PRIu64
 		"cur-packet-size-bytes=%" PRIu64,
@@ -252,11 +543,22 @@ void bt_ctfser_close_current_packet(struct bt_ctfser *ctfser,
 		ctfser->offset_in_cur_packet_bits,
 		ctfser->cur_packet_size_bytes);
 
+	if (ctfser->gz_stream) {
+		uint8_t *addr = mmap_align_addr(ctfser->base_mma);
+
+		BT_ASSERT(packet_size_bytes <= ctfser->cur_packet_size_bytes);
+		ret = deflate_gz_ctfser(ctfser, addr, packet_size_bytes, true);
+		if (ret) {
+			goto end;
+		}
+
+		/* Next packet reuses the memory map: zero its padding */
+		memset(addr, 0, packet_size_bytes);
+	}
+
 	/*
-	 * This will be used during the next call to
-	 * bt_ctfser_open_packet(): we add
-	 * `ctfser->prev_packet_size_bytes` to the current memory map
-	 * address offset (first byte of _this_ packet), effectively
+	 * The next call to bt_ctfser_open_packet() opens a packet
+	 * immediately after the end of the stream file, effectively
 	 * making _this_ packet the required size.
 	 */
 	ctfser->prev_packet_size_bytes = packet_size_bytes;
@@ -265,4 +567,210 @@ void bt_ctfser_close_current_packet(struct bt_ctfser *ctfser,
 		"stream-file-size-bytes=%" PRIu64,
 		ctfser->path->str, ctfser->fd,
 		ctfser->stream_size_bytes);
+
+end:
+	return ret;
+}
+
+/*
+ * Copies at most `len` bytes from the offset `*src_offset` of the file
+ * `src_fd` to the offset `*dst_offset` of the file `dst_fd`, advancing
+ * both offsets.
+ *
+ * Returns the number of copied bytes, 0 at the end of the source file,
+ * or -1 on error (`errno` is set).
+ */
+static
+ssize_t copy_file_bytes(int src_fd, off_t *src_offset, int dst_fd,
+		off_t *dst_offset, size_t len)
+{
+	char buf[64 * 1024];
+	ssize_t ret;
+
+#ifdef BABELTRACE_HAVE_COPY_FILE_RANGE
+	/* Let the kernel (or the file system) copy the bytes */
+	do {
+		ret = copy_file_range(src_fd, src_offset, dst_fd, dst_offset,
+			len, 0);
+	} while (ret == -1 && errno == EINTR);
+
+	if (ret >= 0 || (errno != EXDEV && errno != ENOSYS &&
+			errno != EINVAL && errno != EOPNOTSUPP)) {
+		goto end;
+	}
+
+	/* Not supported for those files: read and write */
+#endif
+
+	do {
+		ret = pread(src_fd, buf, MIN(len, sizeof(buf)), *src_offset);
+	} while (ret == -1 && errno == EINTR);
+
+	if (ret <= 0) {
+		goto end;
+	}
+
+	len = ret;
+
+	while (len > 0) {
+		ssize_t write_ret;
+
+		write_ret = pwrite(dst_fd, &buf[ret - len], len, *dst_offset);
+		if (write_ret < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+
+			ret = -1;
+			goto end;
+		}
+
+		len -= write_ret;
+		*dst_offset += write_ret;
+	}
+
+	*src_offset += ret;
+
+end:
+	return ret;
+}
+
+/*
+ * Compresses the `size_bytes` bytes at the offset `src_offset` of the
+ * file `src_fd` to a new gzip member of the stream file.
+ */
+static
+int write_gz_raw_packet(struct bt_ctfser *ctfser, int src_fd,
+		off_t src_offset, uint64_t size_bytes)
+{
+	int ret = 0;
+	uint8_t buf[64 * 1024];
+	uint64_t left = size_bytes;
+
+	while (left > 0) {
+		ssize_t read_ret;
+
+		do {
+			read_ret = pread(src_fd, buf, MIN(left, sizeof(buf)),
+				src_offset);
+		} while (read_ret == -1 && errno == EINTR);
+
+		if (read_ret < 0) {
+			BT_LOGE_ERRNO("Failed to read raw packet",
+				": path=\"%s\", src-offset=%jd",
+				ctfser->path->str, (intmax_t) src_offset);
+			ret = -1;
+			goto end;
+		} else if (read_ret == 0) {
+			BT_LOGE("Raw packet goes beyond the end of its file: "
+				"path=\"%s\", src-offset=%jd, size-bytes=%" PRIu64,
+				ctfser->path->str, (intmax_t) src_offset,
+				size_bytes);
+			ret = -1;
+			goto end;
+		}
+
+		ret = deflate_gz_ctfser(ctfser, buf, read_ret, false);
+		if (ret) {
+			goto end;
+		}
+
+		src_offset += read_ret;
+		left -= read_ret;
+	}
+
+	ret = deflate_gz_ctfser(ctfser, NULL, 0, true);
+
+end:
+	return ret;
+}
+
+/*
+ * Copies the `size_bytes` bytes at the offset `src_offset` of the file
+ * `src_fd` to the end of the stream file.
+ */
+static
+int copy_raw_packet(struct bt_ctfser *ctfser, int src_fd,
+		off_t src_offset, uint64_t size_bytes)
+{
+	int ret = 0;
+	off_t dst_offset;
+	uint64_t left = size_bytes;
+
+	/*
+	 * Don't write to the file through both a memory map and a file
+	 * descriptor.
+	 */
+	ret = unmap_ctfser(ctfser);
+	if (ret) {
+		goto end;
+	}
+
+	/* Write immediately after the previous packet */
+	dst_offset = (off_t) ctfser->stream_size_bytes;
+
+	while (left > 0) {
+		ssize_t copy_ret = copy_file_bytes(src_fd, &src_offset,
+			ctfser->fd, &dst_offset, MIN(left, (uint64_t) SSIZE_MAX));
+
+		if (copy_ret < 0) {
+			BT_LOGE_ERRNO("Failed to copy raw packet",
+				": path=\"%s\", src-offset=%jd",
+				ctfser->path->str, (intmax_t) src_offset);
+			ret = -1;
+			goto end;
+		} else if (copy_ret == 0) {
+			BT_LOGE("Raw packet goes beyond the end of its file: "
+				"path=\"%s\", src-offset=%jd, size-bytes=%" PRIu64,
+				ctfser->path->str, (intmax_t) src_offset,
+				size_bytes);
+			ret = -1;
+			goto end;
+		}
+
+		left -= copy_ret;
+	}
+
+end:
+	return ret;
+}
+
+BT_HIDDEN
+int bt_ctfser_write_raw_packet(struct bt_ctfser *ctfser, int src_fd,
+		off_t src_offset, uint64_t size_bytes)
+{
+	int ret = 0;
+
+	BT_LOGD("Writing raw packet: path=\"%s\", fd=%d, src-fd=%d, "
+		"src-offset=%jd, size-bytes=%" PRIu64,
+		ctfser->path->str, ctfser->fd, src_fd, (intmax_t) src_offset,
+		size_bytes);
+	ctfser->prev_packet_size_bytes = 0;
+
+	if (ctfser->gz_stream) {
+		ret = write_gz_raw_packet(ctfser, src_fd, src_offset,
+			size_bytes);
+	} else {
+		ret = copy_raw_packet(ctfser, src_fd, src_offset, size_bytes);
+	}
+
+	if (ret) {
+		goto end;
+	}
+
+	/*
+	 * Like bt_ctfser_close_current_packet(): the next packet
+	 * begins after this one.
+	 */
+	ctfser->prev_packet_size_bytes = size_bytes;
+	ctfser->stream_size_bytes += size_bytes;
+	ctfser->alloc_size_bytes = MAX(ctfser->alloc_size_bytes,
+		ctfser->stream_size_bytes);
+	BT_LOGD("Wrote raw packet: path=\"%s\", fd=%d, "
+		"stream-file-size-bytes=%" PRIu64,
+		ctfser->path->str, ctfser->fd,
+		ctfser->stream_size_bytes);
+
+end:
+	return ret;
 }
@@ -16,6 +16,7 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <limits.h>
+#include <string.h>
 #include "compat/mman.h"
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -30,28 +31,67 @@
 #include "compat/bitfield.h"
 #include <glib.h>
 
+struct z_stream_s;
+
 struct bt_ctfser {
 	/* Stream file's descriptor */
 	int fd;
 
-	/* Offset (bytes) of memory map (current packet) in the stream file */
+	/*
+	 * Offset (bytes) of memory map in the stream file.
+	 *
+	 * The memory map outlives packets: the next packet reuses it
+	 * as long as it has enough space left.
+	 *
+	 * When the serializer compresses the stream file, the memory
+	 * map is an anonymous one which only contains the current
+	 * packet: this offset and `mmap_base_offset` are always 0.
+	 */
 	off_t mmap_offset;
 
 	/* Offset (bytes) of packet's first byte in the memory map */
 	off_t mmap_base_offset;
 
+	/*
+	 * Size (bytes) of the memory map.
+	 *
+	 * This size never decreases: it doubles when the current
+	 * packet doesn't fit anymore.
+	 */
+	uint64_t mmap_size_bytes;
+
+	/*
+	 * Size (bytes) of the preallocated part of the stream file,
+	 * from its beginning.
+	 */
+	uint64_t alloc_size_bytes;
+
 	/* Current offset (bits) within current packet */
 	uint64_t offset_in_cur_packet_bits;
 
-	/* Current packet size (bytes) */
+	/*
+	 * Current packet size (bytes), that is, the space between the
+	 * packet's first byte and the end of the memory map.
+	 */
 	uint64_t cur_packet_size_bytes;
 
 	/* Previous packet size (bytes) */
 	uint64_t prev_packet_size_bytes;
 
-	/* Current stream size (bytes) */
+	/*
+	 * Current stream size (bytes).
+	 *
+	 * When the serializer compresses the stream file, this is the
+	 * uncompressed size.
+	 */
 	uint64_t stream_size_bytes;
 
+	/*
+	 * zlib stream which compresses each packet to its own gzip
+	 * member, or `NULL` to write the packets as is.
+	 */
+	struct z_stream_s *gz_stream;
+
 	/* Memory map base address */
 	struct mmap_align *base_mma;
 
@@ -71,11 +111,24 @@ BT_HIDDEN
 int bt_ctfser_init(struct bt_ctfser *ctfser, const char *path,
 		int log_level);
 
+/*
+ * Initializes a CTF serializer which writes a gzip-compressed stream
+ * file.
+ *
+ * This function opens the file `path` for writing. The serializer
+ * compresses each packet to its own gzip member, so that a reader can
+ * start decompressing the stream file at the beginning of any packet.
+ */
+BT_HIDDEN
+int bt_ctfser_init_gzip(struct bt_ctfser *ctfser, const char *path,
+		int log_level);
+
 /*
  * Finalizes a CTF serializer.
  *
  * This function truncates the stream file so that there's no extra
- * padding after the last packet, and then closes the file.
+ * padding after the last packet (unless the serializer compresses the
+ * stream file), and then closes the file.
  */
 BT_HIDDEN
 int bt_ctfser_fini(struct bt_ctfser *ctfser);
@@ -90,11 +143,25 @@ int bt_ctfser_open_packet(struct bt_ctfser *ctfser);
 
 /*
  * Closes the current packet, making its size `packet_size_bytes`.
+ *
+ * When the serializer compresses the stream file, this function
+ * writes the compressed packet.
  */
 BT_HIDDEN
-void bt_ctfser_close_current_packet(struct bt_ctfser *ctfser,
+int bt_ctfser_close_current_packet(struct bt_ctfser *ctfser,
 		uint64_t packet_size_bytes);
 
+/*
+ * Appends the `size_bytes` bytes at the offset `src_offset` of the
+ * file `src_fd` to the stream file as a complete packet, without
+ * decoding or memory mapping them.
+ *
+ * There must be no current packet.
+ */
+BT_HIDDEN
+int bt_ctfser_write_raw_packet(struct bt_ctfser *ctfser, int src_fd,
+		off_t src_offset, uint64_t size_bytes);
+
 BT_HIDDEN
 int _bt_ctfser_increase_cur_packet_size(struct bt_ctfser *ctfser);
 
@@ -501,38 +568,60 @@ int bt_ctfser_write_float64(struct bt_ctfser *ctfser, double value,
 }
 
 /*
- * Writes a C string, including the terminating null character, at the
- * current offset within the current packet.
+ * Aligns the current offset within the current packet to
+ * `alignment_bits` bits (power of two, multiple of 8), and then
+ * reserves the next `size_bytes` bytes of the current packet, setting
+ * `*addr` to the address of the first one.
+ *
+ * The current offset is then after the reserved bytes. Write the
+ * reserved bytes before calling any other serializer function: this
+ * function makes sure the current packet is large enough only once,
+ * but `*addr` could be invalid after another call.
  */
 static inline
-int bt_ctfser_write_string(struct bt_ctfser *ctfser, const char *value)
+int bt_ctfser_reserve_bytes(struct bt_ctfser *ctfser,
+	unsigned int alignment_bits, uint64_t size_bytes, uint8_t **addr)
 {
-	int ret = 0;
-	const char *at = value;
+	int ret;
 
-	ret = bt_ctfser_align_offset_in_current_packet(ctfser, 8);
+	BT_ASSERT_DBG(alignment_bits % 8 == 0);
+	ret = bt_ctfser_align_offset_in_current_packet(ctfser, alignment_bits);
 	if (G_UNLIKELY(ret)) {
 		goto end;
 	}
 
-	while (true) {
-		if (G_UNLIKELY(!_bt_ctfser_has_space_left(ctfser, 8))) {
-			ret = _bt_ctfser_increase_cur_packet_size(ctfser);
-			if (G_UNLIKELY(ret)) {
-				goto end;
-			}
+	while (G_UNLIKELY(!_bt_ctfser_has_space_left(ctfser, size_bytes * 8))) {
+		ret = _bt_ctfser_increase_cur_packet_size(ctfser);
+		if (G_UNLIKELY(ret)) {
+			goto end;
 		}
+	}
 
-		memcpy(_bt_ctfser_get_addr(ctfser), at, sizeof(*at));
-		_bt_ctfser_incr_offset(ctfser, 8);
+	*addr = _bt_ctfser_get_addr(ctfser);
+	_bt_ctfser_incr_offset(ctfser, size_bytes * 8);
 
-		if (G_UNLIKELY(*at == '\0')) {
-			break;
-		}
+end:
+	return ret;
+}
+
+/*
+ * Writes a C string, including the terminating null character, at the
+ * current offset within the current packet.
+ */
+static inline
+int bt_ctfser_write_string(struct bt_ctfser *ctfser, const char *value)
+{
+	int ret;
+	size_t size = strlen(value) + 1;
+	uint8_t *addr;
 
-		at++;
+	ret = bt_ctfser_reserve_bytes(ctfser, 8, size, &addr);
+	if (G_UNLIKELY(ret)) {
+		goto end;
 	}
 
+	memcpy(addr, value, size);
+
 end:
 	return ret;
 }
@@ -557,6 +646,19 @@ void bt_ctfser_set_offset_in_current_packet_bits(struct bt_ctfser *ctfser,
 	ctfser->offset_in_cur_packet_bits = offset_bits;
 }
 
+/*
+ * Returns the offset (bytes) of the current packet within the stream
+ * file.
+ *
+ * When the serializer compresses the stream file, this is the offset
+ * within the uncompressed data.
+ */
+static inline
+uint64_t bt_ctfser_get_current_packet_offset_bytes(struct bt_ctfser *ctfser)
+{
+	return ctfser->stream_size_bytes;
+}
+
 static inline
 const char *bt_ctfser_get_file_path(struct bt_ctfser *ctfser)
 {
@@ -607,6 +607,42 @@
 		((const struct bt_field *) (_field))->class->type == BT_FIELD_CLASS_TYPE_DYNAMIC_ARRAY_WITH_LENGTH_FIELD, \
 		_name " is not a dynamic array field: %![field-]+f", (_field))
 
+#define _BT_ASSERT_PRE_FIELD_ARRAY_ELEMENT_CLASS_TYPE(_field)		\
+	(((const struct bt_field_class_array *)				\
+		((const struct bt_field *) (_field))->class)->element_fc->type)
+
+#define BT_ASSERT_PRE_DEV_FIELD_IS_UNSIGNED_INT_ARRAY(_field_id, _field, _name) \
+	BT_ASSERT_PRE_DEV(						\
+		"is-unsigned-integer-array-field:" _field_id,		\
+		bt_field_class_type_is(					\
+			_BT_ASSERT_PRE_FIELD_ARRAY_ELEMENT_CLASS_TYPE(_field), \
+			BT_FIELD_CLASS_TYPE_UNSIGNED_INTEGER),		\
+		_name " is not an array field of unsigned integer fields: " \
+		"%![field-]+f", (_field))
+
+#define BT_ASSERT_PRE_DEV_FIELD_IS_SIGNED_INT_ARRAY(_field_id, _field, _name) \
+	BT_ASSERT_PRE_DEV(						\
+		"is-signed-integer-array-field:" _field_id,		\
+		bt_field_class_type_is(					\
+			_BT_ASSERT_PRE_FIELD_ARRAY_ELEMENT_CLASS_TYPE(_field), \
+			BT_FIELD_CLASS_TYPE_SIGNED_INTEGER),		\
+		_name " is not an array field of signed integer fields: " \
+		"%![field-]+f", (_field))
+
+#define BT_ASSERT_PRE_DEV_FIELD_IS_REAL_ARRAY(_field_id, _field, _name) \
+	BT_ASSERT_PRE_DEV(						\
+		"is-real-array-field:" _field_id,			\
+		bt_field_class_type_is(					\
+			_BT_ASSERT_PRE_FIELD_ARRAY_ELEMENT_CLASS_TYPE(_field), \
+			BT_FIELD_CLASS_TYPE_REAL),			\
+		_name " is not an array field of real fields: "		\
+		"%![field-]+f", (_field))
+
+#define BT_ASSERT_PRE_DEV_ARRAY_FIELD_ELEMENT_VALUES_NON_NULL(_field, _values) \
+	BT_ASSERT_PRE_DEV("element-values-not-null",			\
+		(_values) || bt_field_array_get_length(_field) == 0,	\
+		"Element values are NULL: %![field-]+f", (_field))
+
 #define BT_ASSERT_PRE_DEV_FIELD_IS_OPTION(_field_id, _field, _name)	\
 	BT_ASSERT_PRE_DEV(						\
 		"is-option-field:" _field_id,				\
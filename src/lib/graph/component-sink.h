@@ -16,10 +16,17 @@
 
 #include "component-class.h"
 #include "component.h"
+#include "statistics.h"
 
 struct bt_component_sink {
 	struct bt_component parent;
 	bool graph_is_configured_method_called;
+
+	/*
+	 * Performance statistics of the "consume" method calls (see
+	 * bt_graph_enable_performance_statistics()).
+	 */
+	struct bt_graph_method_statistics consume_method_stats;
 };
 
 BT_HIDDEN
@@ -13,6 +13,7 @@
 #include "common/assert.h"
 #include "common/macros.h"
 #include <stdbool.h>
+#include <stdint.h>
 
 #include "message/iterator.h"
 
@@ -40,6 +41,13 @@ struct bt_connection {
 	 */
 	GPtrArray *iterators;
 
+	/*
+	 * Capacity of the message queue of each message iterator
+	 * created on this connection if it's a thread boundary, or 0
+	 * (see bt_graph_make_connection_thread_boundary()).
+	 */
+	uint64_t thread_queue_capacity;
+
 	bool notified_upstream_port_connected;
 	bool notified_downstream_port_connected;
 	bool notified_graph_ports_connected;
@@ -13,6 +13,7 @@
 #include <babeltrace2/graph/graph.h>
 #include <babeltrace2/graph/component.h>
 #include <babeltrace2/graph/port.h>
+#include "lib/graph/message/iterator.h"
 #include "lib/graph/message/message.h"
 #include "compat/compiler.h"
 #include "common/common.h"
@@ -29,8 +30,11 @@
 #include "connection.h"
 #include "graph.h"
 #include "interrupter.h"
+#include "iterator-thread.h"
 #include "message/event.h"
 #include "message/packet.h"
+#include "port.h"
+#include "statistics.h"
 
 typedef enum bt_graph_listener_func_status
 (*port_added_func_t)(const void *, const void *, void *);
@@ -52,6 +56,79 @@ struct bt_graph_listener_port_added {
 		}							\
 	} while (0)
 
+/*
+ * Stops and joins the producer threads of the thread boundary message
+ * iterators upstream of `comp`, the downstream ones first, so that no
+ * producer thread consumes from a message iterator which this function
+ * already paused (see bt_message_iterator_thread_pause()).
+ */
+static
+void pause_upstream_iterator_threads(struct bt_component *comp, bool discard)
+{
+	uint64_t i;
+
+	for (i = 0; i < comp->input_ports->len; i++) {
+		struct bt_port *port = comp->input_ports->pdata[i];
+		struct bt_connection *conn = port->connection;
+		uint64_t j;
+
+		if (!conn) {
+			continue;
+		}
+
+		if (conn->thread_queue_capacity > 0) {
+			for (j = 0; j < conn->iterators->len; j++) {
+				struct bt_message_iterator *iterator =
+					conn->iterators->pdata[j];
+
+				if (iterator->thread) {
+					bt_message_iterator_thread_pause(
+						iterator->thread, discard);
+				}
+			}
+		}
+
+		if (conn->upstream_port) {
+			pause_upstream_iterator_threads(
+				bt_port_borrow_component_inline(
+					conn->upstream_port), discard);
+		}
+	}
+}
+
+/*
+ * Stops and joins the producer threads of all the thread boundary
+ * message iterators of `graph`.
+ *
+ * If `discard` is true, also discards the messages which they produced
+ * and which their consumers didn't pop yet: do this when the graph
+ * cannot run anymore. Otherwise, the next bt_message_iterator_next()
+ * calls return those messages first and start new producer threads.
+ */
+static
+void pause_iterator_threads(struct bt_graph *graph, bool discard)
+{
+	uint64_t i;
+
+	if (G_LIKELY(!graph->has_thread_boundary) || !graph->components) {
+		goto end;
+	}
+
+	BT_LIB_LOGD("Pausing graph's message iterator threads: "
+		"%![graph-]+g, discard=%d", graph, discard);
+
+	for (i = 0; i < graph->components->len; i++) {
+		struct bt_component *comp = graph->components->pdata[i];
+
+		if (comp->class->type == BT_COMPONENT_CLASS_TYPE_SINK) {
+			pause_upstream_iterator_threads(comp, discard);
+		}
+	}
+
+end:
+	return;
+}
+
 static
 void destroy_graph(struct bt_object *obj)
 {
@@ -87,6 +164,12 @@ void destroy_graph(struct bt_object *obj)
 	obj->ref_count++;
 	graph->config_state = BT_GRAPH_CONFIGURATION_STATE_DESTROYING;
 
+	/*
+	 * Stop all the producer threads before finalizing any message
+	 * iterator or component which they could still be using.
+	 */
+	pause_iterator_threads(graph, true);
+
 	if (graph->messages) {
 		g_ptr_array_free(graph->messages, TRUE);
 		graph->messages = NULL;
@@ -147,6 +230,7 @@ static
 void destroy_message_event(struct bt_message *msg,
 		struct bt_graph *graph)
 {
+	bt_graph_remove_message(graph, msg);
 	bt_message_event_destroy(msg);
 }
 
@@ -154,6 +238,7 @@ static
 void destroy_message_packet_begin(struct bt_message *msg,
 		struct bt_graph *graph)
 {
+	bt_graph_remove_message(graph, msg);
 	bt_message_packet_destroy(msg);
 }
 
@@ -161,6 +246,7 @@ static
 void destroy_message_packet_end(struct bt_message *msg,
 		struct bt_graph *graph)
 {
+	bt_graph_remove_message(graph, msg);
 	bt_message_packet_destroy(msg);
 }
 
@@ -190,6 +276,7 @@ struct bt_graph *bt_graph_create(uint64_t mip_version)
 
 	bt_object_init_shared(&graph->base, destroy_graph);
 	graph->mip_version = mip_version;
+	graph->msg_batch_size = BT_GRAPH_DEFAULT_MESSAGE_BATCH_SIZE;
 	graph->connections = g_ptr_array_new_with_free_func(
 		(GDestroyNotify) bt_object_try_spec_release);
 	if (!graph->connections) {
@@ -285,6 +372,13 @@ struct bt_graph *bt_graph_create(uint64_t mip_version)
 		goto error;
 	}
 
+	graph->msg_pool_budget.max_size = UINT64_MAX;
+	bt_object_pool_set_budget(&graph->event_msg_pool,
+		&graph->msg_pool_budget, sizeof(struct bt_message_event));
+	bt_object_pool_set_budget(&graph->packet_begin_msg_pool,
+		&graph->msg_pool_budget, sizeof(struct bt_message_packet));
+	bt_object_pool_set_budget(&graph->packet_end_msg_pool,
+		&graph->msg_pool_budget, sizeof(struct bt_message_packet));
 	graph->messages = g_ptr_array_new_with_free_func(
 		(GDestroyNotify) notify_message_graph_is_destroyed);
 	BT_LIB_LOGI("Created graph object: %!+g", graph);
@@ -439,12 +533,28 @@ int consume_graph_sink(struct bt_component_sink *comp)
 {
 	enum bt_component_class_sink_consume_method_status consume_status;
 	struct bt_component_class_sink *sink_class = NULL;
+	struct bt_graph_statistics_frame stats_frame;
+	bool collect_stats;
 
 	BT_ASSERT_DBG(comp);
 	sink_class = (void *) comp->parent.class;
 	BT_ASSERT_DBG(sink_class->methods.consume);
+	collect_stats = bt_component_borrow_graph(
+		(void *) comp)->perf_stats_enabled;
 	BT_LIB_LOGD("Calling user's consume method: %!+c", comp);
+
+	if (G_UNLIKELY(collect_stats)) {
+		bt_graph_statistics_frame_begin(&stats_frame);
+	}
+
 	consume_status = sink_class->methods.consume((void *) comp);
+
+	if (G_UNLIKELY(collect_stats)) {
+		bt_graph_statistics_frame_end(&stats_frame,
+			&comp->consume_method_stats, (int) consume_status,
+			0, 0);
+	}
+
 	BT_LOGD("User method returned: status=%s",
 		bt_common_func_status_string(consume_status));
 	BT_ASSERT_POST_DEV(CONSUME_METHOD_NAME, "valid-status",
@@ -591,6 +701,18 @@ int configure_graph(struct bt_graph *graph, const char *api_func)
 		graph->has_sink, "Graph has no sink component: %!+g", graph);
 	graph->config_state = BT_GRAPH_CONFIGURATION_STATE_PARTIALLY_CONFIGURED;
 
+	if (graph->has_thread_boundary && !bt_object_is_multithreaded()) {
+		/*
+		 * Switch now, before the "graph is configured" methods
+		 * below create the first message iterators, and
+		 * therefore before any producer thread shares objects
+		 * with its consumer.
+		 */
+		BT_LOGI_STR("Enabling thread-safe object reference counts "
+			"and object pools.");
+		bt_object_set_multithreaded();
+	}
+
 	for (i = 0; i < graph->components->len; i++) {
 		struct bt_component *comp = graph->components->pdata[i];
 		struct bt_component_sink *comp_sink = (void *) comp;
@@ -648,6 +770,26 @@ end:
 	return status;
 }
 
+/*
+ * Stops the producer threads of `graph` when bt_graph_run() or
+ * bt_graph_run_once() returns `status` because of an error or because
+ * the graph is interrupted, so that they don't keep running while the
+ * user doesn't run the graph.
+ *
+ * An interrupted graph can run again: keep what the producer threads
+ * already produced in this case.
+ */
+static inline
+void pause_iterator_threads_after_run(struct bt_graph *graph, int status)
+{
+	if (G_UNLIKELY(status < 0)) {
+		pause_iterator_threads(graph, true);
+	} else if (G_UNLIKELY(status == BT_FUNC_STATUS_AGAIN &&
+			bt_graph_is_interrupted(graph))) {
+		pause_iterator_threads(graph, false);
+	}
+}
+
 enum bt_graph_run_once_status bt_graph_run_once(struct bt_graph *graph)
 {
 	enum bt_graph_run_once_status status;
@@ -670,6 +812,7 @@ enum bt_graph_run_once_status bt_graph_run_once(struct bt_graph *graph)
 	bt_graph_set_can_consume(graph, true);
 
 end:
+	pause_iterator_threads_after_run(graph, status);
 	return status;
 }
 
@@ -740,10 +883,117 @@ enum bt_graph_run_status bt_graph_run(struct bt_graph *graph)
 end:
 	BT_LIB_LOGI("Graph ran: %![graph-]+g, status=%s", graph,
 		bt_common_func_status_string(status));
+	pause_iterator_threads_after_run(graph, status);
 	bt_graph_set_can_consume(graph, true);
 	return status;
 }
 
+/*
+ * Waits until the wake-up file descriptor of any message iterator of
+ * `graph` of which the last "next" method call returned "try again"
+ * becomes readable, or for `max_wait_us` µs at most.
+ *
+ * A signal also ends the wait.
+ */
+static
+void wait_for_ready_message_iterators(struct bt_graph *graph,
+		uint64_t max_wait_us)
+{
+	GArray *fds;
+	gint timeout_ms;
+	guint i;
+	gint ret;
+
+	fds = g_array_new(FALSE, FALSE, sizeof(GPollFD));
+	if (!fds) {
+		BT_LOGE_STR("Failed to allocate one GArray.");
+		goto end;
+	}
+
+	for (i = 0; i < graph->connections->len; i++) {
+		struct bt_connection *conn = graph->connections->pdata[i];
+		guint j;
+
+		for (j = 0; j < conn->iterators->len; j++) {
+			struct bt_message_iterator *iterator =
+				conn->iterators->pdata[j];
+			GPollFD fd;
+
+			if (iterator->wake_up_fd < 0 ||
+					!__atomic_load_n(
+						&iterator->last_next_returned_again,
+						__ATOMIC_RELAXED)) {
+				continue;
+			}
+
+			fd.fd = iterator->wake_up_fd;
+			fd.events = G_IO_IN | G_IO_HUP | G_IO_ERR;
+			fd.revents = 0;
+			g_array_append_val(fds, fd);
+		}
+	}
+
+	/* Round up to the next millisecond */
+	if (max_wait_us >= (uint64_t) G_MAXINT * 1000) {
+		timeout_ms = G_MAXINT;
+	} else {
+		timeout_ms = (gint) ((max_wait_us + 999) / 1000);
+	}
+
+	BT_LOGD("Waiting for message iterators to be ready: "
+		"graph-addr=%p, fd-count=%u, timeout-ms=%d",
+		graph, fds->len, timeout_ms);
+
+	/*
+	 * Without any file descriptor, this is an interruptible sleep
+	 * of `timeout_ms` ms.
+	 */
+	ret = g_poll((GPollFD *) fds->data, fds->len, timeout_ms);
+	BT_LOGD("Done waiting for message iterators: "
+		"graph-addr=%p, ready-fd-count=%d", graph, ret);
+
+end:
+	if (fds) {
+		g_array_free(fds, TRUE);
+	}
+}
+
+enum bt_graph_run_status bt_graph_run_and_wait(struct bt_graph *graph,
+		uint64_t max_wait_us)
+{
+	enum bt_graph_run_status status;
+
+	/* bt_graph_run() checks the preconditions */
+	status = bt_graph_run(graph);
+	if (status != BT_FUNC_STATUS_AGAIN || max_wait_us == 0 ||
+			bt_graph_is_interrupted(graph)) {
+		goto end;
+	}
+
+	wait_for_ready_message_iterators(graph, max_wait_us);
+
+end:
+	return status;
+}
+
+enum bt_graph_run_once_status bt_graph_run_once_and_wait(
+		struct bt_graph *graph, uint64_t max_wait_us)
+{
+	enum bt_graph_run_once_status status;
+
+	/* bt_graph_run_once() checks the preconditions */
+	status = bt_graph_run_once(graph);
+	if (status != BT_FUNC_STATUS_AGAIN || max_wait_us == 0 ||
+			bt_graph_is_interrupted(graph)) {
+		goto end;
+	}
+
+	wait_for_ready_message_iterators(graph, max_wait_us);
+
+end:
+	return status;
+}
+
 enum bt_graph_add_listener_status
 bt_graph_add_source_component_output_port_added_listener(
 		struct bt_graph *graph,
@@ -1281,6 +1531,8 @@ BT_HIDDEN
 void bt_graph_add_message(struct bt_graph *graph,
 		struct bt_message *msg)
 {
+	bool locked;
+
 	BT_ASSERT(graph);
 	BT_ASSERT(msg);
 
@@ -1292,7 +1544,45 @@ void bt_graph_add_message(struct bt_graph *graph,
 	 * * It is destroyed because it doesn't have any link to any
 	 *   graph, which means the original graph is already destroyed.
 	 */
+	locked = bt_object_spin_lock(&graph->messages_lock);
+	msg->graph_msg_index = graph->messages->len;
 	g_ptr_array_add(graph->messages, msg);
+	bt_object_spin_unlock(&graph->messages_lock, locked);
+}
+
+BT_HIDDEN
+void bt_graph_remove_message(struct bt_graph *graph,
+		struct bt_message *msg)
+{
+	guint index;
+	bool locked;
+
+	BT_ASSERT(graph);
+	BT_ASSERT(msg);
+	locked = bt_object_spin_lock(&graph->messages_lock);
+
+	if (!graph->messages) {
+		/* Graph is being destroyed: message array is gone */
+		goto end;
+	}
+
+	/*
+	 * Swap the last message into the message's slot so that
+	 * removing it is O(1), updating the moved message's index.
+	 */
+	index = msg->graph_msg_index;
+	BT_ASSERT_DBG(index < graph->messages->len);
+	BT_ASSERT_DBG(graph->messages->pdata[index] == msg);
+	g_ptr_array_remove_index_fast(graph->messages, index);
+
+	if (index < graph->messages->len) {
+		struct bt_message *moved_msg = graph->messages->pdata[index];
+
+		moved_msg->graph_msg_index = index;
+	}
+
+end:
+	bt_object_spin_unlock(&graph->messages_lock, locked);
 }
 
 BT_HIDDEN
@@ -1321,6 +1611,283 @@ struct bt_interrupter *bt_graph_borrow_default_interrupter(bt_graph *graph)
 	return graph->default_interrupter;
 }
 
+void bt_graph_set_message_batch_size(struct bt_graph *graph,
+		uint64_t batch_size)
+{
+	BT_ASSERT_PRE_GRAPH_NON_NULL(graph);
+	BT_ASSERT_PRE("graph-is-not-configured",
+		graph->config_state == BT_GRAPH_CONFIGURATION_STATE_CONFIGURING,
+		"Graph is not in the \"configuring\" state: %!+g", graph);
+	BT_ASSERT_PRE("valid-message-batch-size",
+		batch_size >= 1 && batch_size <= G_MAXUINT,
+		"Invalid message batch size: batch-size=%" PRIu64,
+		batch_size);
+	graph->msg_batch_size = batch_size;
+	BT_LIB_LOGD("Set graph's message batch size: %!+g", graph);
+}
+
+uint64_t bt_graph_get_message_batch_size(const struct bt_graph *graph)
+{
+	BT_ASSERT_PRE_GRAPH_NON_NULL(graph);
+	return graph->msg_batch_size;
+}
+
+void bt_graph_set_message_pool_memory_budget(struct bt_graph *graph,
+		uint64_t budget)
+{
+	BT_ASSERT_PRE_GRAPH_NON_NULL(graph);
+	BT_ASSERT_PRE("graph-is-not-configured",
+		graph->config_state == BT_GRAPH_CONFIGURATION_STATE_CONFIGURING,
+		"Graph is not in the \"configuring\" state: %!+g", graph);
+	graph->msg_pool_budget.max_size = budget;
+	BT_LIB_LOGD("Set graph's message pool memory budget: %!+g", graph);
+}
+
+uint64_t bt_graph_get_message_pool_memory_budget(
+		const struct bt_graph *graph)
+{
+	BT_ASSERT_PRE_GRAPH_NON_NULL(graph);
+	return graph->msg_pool_budget.max_size;
+}
+
+uint64_t bt_graph_get_message_pool_memory_size(
+		const struct bt_graph *graph)
+{
+	BT_ASSERT_PRE_GRAPH_NON_NULL(graph);
+	return graph->msg_pool_budget.size;
+}
+
+static
+void add_message_pool_statistics(const struct bt_object_pool *pool,
+		uint64_t *allocation_count, uint64_t *reuse_count,
+		uint64_t *discard_count)
+{
+	*allocation_count += pool->stats.new_count;
+	*reuse_count += pool->stats.reuse_count;
+	*discard_count += pool->stats.discard_count;
+}
+
+void bt_graph_get_message_pool_statistics(const struct bt_graph *graph,
+		uint64_t *allocation_count, uint64_t *reuse_count,
+		uint64_t *discard_count)
+{
+	BT_ASSERT_PRE_GRAPH_NON_NULL(graph);
+	BT_ASSERT_PRE_NON_NULL("allocation-count-output", allocation_count,
+		"Allocation count (output)");
+	BT_ASSERT_PRE_NON_NULL("reuse-count-output", reuse_count,
+		"Reuse count (output)");
+	BT_ASSERT_PRE_NON_NULL("discard-count-output", discard_count,
+		"Discard count (output)");
+	*allocation_count = 0;
+	*reuse_count = 0;
+	*discard_count = 0;
+	add_message_pool_statistics(&graph->event_msg_pool,
+		allocation_count, reuse_count, discard_count);
+	add_message_pool_statistics(&graph->packet_begin_msg_pool,
+		allocation_count, reuse_count, discard_count);
+	add_message_pool_statistics(&graph->packet_end_msg_pool,
+		allocation_count, reuse_count, discard_count);
+}
+
+void bt_graph_enable_performance_statistics(struct bt_graph *graph)
+{
+	BT_ASSERT_PRE_GRAPH_NON_NULL(graph);
+	BT_ASSERT_PRE("graph-is-not-configured",
+		graph->config_state == BT_GRAPH_CONFIGURATION_STATE_CONFIGURING,
+		"Graph is not in the \"configuring\" state: %!+g", graph);
+	graph->perf_stats_enabled = true;
+	BT_LIB_LOGD("Enabled graph's performance statistics: %!+g", graph);
+}
+
+bt_bool bt_graph_performance_statistics_are_enabled(
+		const struct bt_graph *graph)
+{
+	BT_ASSERT_PRE_GRAPH_NON_NULL(graph);
+	return graph->perf_stats_enabled;
+}
+
+/*
+ * Returns a new map value containing the performance statistics of
+ * `comp`, or `NULL` on memory error.
+ */
+static
+bt_value *component_performance_statistics_to_value(
+		struct bt_component *comp)
+{
+	bt_value *comp_map;
+	bt_value *ports_array;
+	bt_value *stats_map = NULL;
+	guint i;
+
+	comp_map = bt_value_map_create();
+	if (!comp_map) {
+		BT_LIB_LOGE_APPEND_CAUSE("Failed to create a map value.");
+		goto error;
+	}
+
+	if (bt_value_map_insert_string_entry(comp_map, "name",
+			comp->name->str) ||
+			bt_value_map_insert_string_entry(comp_map, "class-name",
+				comp->class->name->str)) {
+		BT_LIB_LOGE_APPEND_CAUSE(
+			"Cannot insert string value into map value.");
+		goto error;
+	}
+
+	if (comp->class->type == BT_COMPONENT_CLASS_TYPE_SINK) {
+		stats_map = bt_graph_method_statistics_to_value(
+			&((struct bt_component_sink *) comp)->consume_method_stats);
+		if (!stats_map) {
+			goto error;
+		}
+
+		if (bt_value_map_insert_entry(comp_map, "consume",
+				stats_map)) {
+			BT_LIB_LOGE_APPEND_CAUSE(
+				"Cannot insert value into map value: "
+				"key=\"consume\"");
+			goto error;
+		}
+
+		BT_VALUE_PUT_REF_AND_RESET(stats_map);
+	}
+
+	if (bt_value_map_insert_empty_array_entry(comp_map, "output-ports",
+			&ports_array)) {
+		BT_LIB_LOGE_APPEND_CAUSE(
+			"Cannot insert empty array value into map value: "
+			"key=\"output-ports\"");
+		goto error;
+	}
+
+	for (i = 0; i < comp->output_ports->len; i++) {
+		struct bt_port *port = comp->output_ports->pdata[i];
+		bt_value *port_map;
+
+		if (bt_value_array_append_empty_map_element(ports_array,
+				&port_map)) {
+			BT_LIB_LOGE_APPEND_CAUSE(
+				"Cannot append empty map value to array value.");
+			goto error;
+		}
+
+		if (bt_value_map_insert_string_entry(port_map, "name",
+				port->name->str)) {
+			BT_LIB_LOGE_APPEND_CAUSE(
+				"Cannot insert string value into map value: "
+				"key=\"name\"");
+			goto error;
+		}
+
+		stats_map = bt_graph_method_statistics_to_value(
+			&port->next_method_stats);
+		if (!stats_map) {
+			goto error;
+		}
+
+		if (bt_value_map_insert_entry(port_map, "next", stats_map)) {
+			BT_LIB_LOGE_APPEND_CAUSE(
+				"Cannot insert value into map value: "
+				"key=\"next\"");
+			goto error;
+		}
+
+		BT_VALUE_PUT_REF_AND_RESET(stats_map);
+	}
+
+	goto end;
+
+error:
+	BT_VALUE_PUT_REF_AND_RESET(comp_map);
+	BT_VALUE_PUT_REF_AND_RESET(stats_map);
+
+end:
+	return comp_map;
+}
+
+enum bt_graph_get_performance_statistics_status
+bt_graph_get_performance_statistics(const struct bt_graph *graph,
+		bt_value **statistics)
+{
+	enum bt_graph_get_performance_statistics_status status =
+		BT_FUNC_STATUS_OK;
+	bt_value *comps_array;
+	bt_value *comp_map = NULL;
+	guint i;
+
+	BT_ASSERT_PRE_NO_ERROR();
+	BT_ASSERT_PRE_GRAPH_NON_NULL(graph);
+	BT_ASSERT_PRE_NON_NULL("statistics-output", statistics,
+		"Statistics (output)");
+	*statistics = bt_value_map_create();
+	if (!*statistics) {
+		BT_LIB_LOGE_APPEND_CAUSE("Failed to create a map value.");
+		goto error;
+	}
+
+	if (bt_value_map_insert_empty_array_entry(*statistics, "components",
+			&comps_array)) {
+		BT_LIB_LOGE_APPEND_CAUSE(
+			"Cannot insert empty array value into map value: "
+			"key=\"components\"");
+		goto error;
+	}
+
+	for (i = 0; i < graph->components->len; i++) {
+		comp_map = component_performance_statistics_to_value(
+			graph->components->pdata[i]);
+		if (!comp_map) {
+			goto error;
+		}
+
+		if (bt_value_array_append_element(comps_array, comp_map)) {
+			BT_LIB_LOGE_APPEND_CAUSE(
+				"Cannot append value to array value.");
+			goto error;
+		}
+
+		BT_VALUE_PUT_REF_AND_RESET(comp_map);
+	}
+
+	goto end;
+
+error:
+	status = BT_FUNC_STATUS_MEMORY_ERROR;
+	BT_VALUE_PUT_REF_AND_RESET(*statistics);
+	BT_VALUE_PUT_REF_AND_RESET(comp_map);
+
+end:
+	return status;
+}
+
+void bt_graph_make_connection_thread_boundary(struct bt_graph *graph,
+		const struct bt_connection *connection,
+		uint64_t queue_capacity)
+{
+	struct bt_connection *conn = (void *) connection;
+
+	BT_ASSERT_PRE_GRAPH_NON_NULL(graph);
+	BT_ASSERT_PRE_CONN_NON_NULL(connection);
+	BT_ASSERT_PRE("graph-is-not-configured",
+		graph->config_state == BT_GRAPH_CONFIGURATION_STATE_CONFIGURING,
+		"Graph is not in the \"configuring\" state: %!+g", graph);
+	BT_ASSERT_PRE("connection-is-part-of-graph",
+		bt_connection_borrow_graph(conn) == graph,
+		"Connection is not part of graph: %![graph-]+g, %![conn-]+x",
+		graph, conn);
+	BT_ASSERT_PRE("valid-queue-capacity",
+		queue_capacity >= 1 && queue_capacity <= G_MAXUINT,
+		"Invalid message queue capacity: capacity=%" PRIu64,
+		queue_capacity);
+	conn->thread_queue_capacity = queue_capacity;
+
+	/* configure_graph() makes the objects thread-safe */
+	graph->has_thread_boundary = true;
+
+	BT_LIB_LOGD("Made connection a thread boundary: %![graph-]+g, "
+		"%![conn-]+x", graph, conn);
+}
+
 void bt_graph_get_ref(const struct bt_graph *graph)
 {
 	bt_object_get_ref(graph);
@@ -42,6 +42,14 @@
 # error Please include "lib/assert-cond.h" before including this file.
 #endif
 
+/*
+ * Default message batch size of a graph.
+ *
+ * TODO: Use graph's state (number of active iterators, etc.) and
+ * possibly system specifications to make a better guess than this.
+ */
+#define BT_GRAPH_DEFAULT_MESSAGE_BATCH_SIZE	15
+
 struct bt_component;
 struct bt_port;
 
@@ -75,6 +83,13 @@ struct bt_graph {
 
 	uint64_t mip_version;
 
+	/*
+	 * Capacity of the message array which a message iterator of
+	 * this graph passes to its "next" method (see
+	 * bt_graph_set_message_batch_size()).
+	 */
+	uint64_t msg_batch_size;
+
 	/*
 	 * Array of `struct bt_interrupter *`, each one owned by this.
 	 * If any interrupter is set, then this graph is deemed
@@ -89,6 +104,12 @@ struct bt_graph {
 
 	bool has_sink;
 
+	/*
+	 * True if at least one connection of this graph is a thread
+	 * boundary (see bt_graph_make_connection_thread_boundary()).
+	 */
+	bool has_thread_boundary;
+
 	/*
 	 * If this is false, then the public API's consuming
 	 * functions (bt_graph_consume() and bt_graph_run()) return
@@ -101,6 +122,13 @@ struct bt_graph {
 	 */
 	bool can_consume;
 
+	/*
+	 * True to collect the performance statistics of the user
+	 * "next" and "consume" methods (see
+	 * bt_graph_enable_performance_statistics()).
+	 */
+	bool perf_stats_enabled;
+
 	enum bt_graph_configuration_state config_state;
 
 	struct {
@@ -119,21 +147,34 @@ struct bt_graph {
 	/* Pool of `struct bt_message_packet_end *` */
 	struct bt_object_pool packet_end_msg_pool;
 
+	/*
+	 * Memory budget which the message pools above share (see
+	 * bt_graph_set_message_pool_memory_budget()).
+	 */
+	struct bt_object_pool_budget msg_pool_budget;
+
 	/*
 	 * Array of `struct bt_message *` (weak).
 	 *
-	 * This is an array of all the messages ever created from
+	 * This is an array of all the living messages created from
 	 * this graph. Some of them can be in one of the pools above,
 	 * some of them can be at large. Because each message has a
 	 * weak pointer to the graph containing its pool, we need to
 	 * notify each message that the graph is gone on graph
 	 * destruction.
 	 *
-	 * TODO: When we support a maximum size for object pools,
-	 * add a way for a message to remove itself from this
-	 * array (on destruction).
+	 * When a message pool destroys a message instead of recycling
+	 * it, the message removes itself from this array (see
+	 * bt_graph_remove_message()).
 	 */
 	GPtrArray *messages;
+
+	/*
+	 * Spin lock protecting `messages` when message iterators
+	 * create messages from more than one thread (see
+	 * bt_object_spin_lock()).
+	 */
+	bool messages_lock;
 };
 
 static inline
@@ -159,6 +200,10 @@ BT_HIDDEN
 void bt_graph_add_message(struct bt_graph *graph,
 		struct bt_message *msg);
 
+BT_HIDDEN
+void bt_graph_remove_message(struct bt_graph *graph,
+		struct bt_message *msg);
+
 BT_HIDDEN
 bool bt_graph_is_interrupted(const struct bt_graph *graph);
 
@@ -0,0 +1,495 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (C) 2023 EfficiOS Inc.
+ */
+
+#define BT_LOG_TAG "LIB/MSG-ITER-THREAD"
+#include "lib/logging.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <glib.h>
+#include <babeltrace2/error-reporting.h>
+
+#include "common/assert.h"
+#include "common/common.h"
+#include "compat/glib.h"
+#include "lib/assert-cond.h"
+#include "lib/func-status.h"
+#include "lib/object.h"
+
+#include "graph.h"
+#include "iterator-thread.h"
+#include "message/iterator.h"
+
+/*
+ * Maximum time (µs) during which the consumer waits for the producer
+ * thread before checking whether or not the graph is interrupted.
+ */
+#define CONSUMER_WAIT_TIMEOUT_US	(100 * 1000)
+
+static inline
+uint64_t ring_used(struct bt_message_iterator_thread *thread)
+{
+	return __atomic_load_n(&thread->tail, __ATOMIC_SEQ_CST) -
+		__atomic_load_n(&thread->head, __ATOMIC_SEQ_CST);
+}
+
+static inline
+bool producer_must_stop(struct bt_message_iterator_thread *thread)
+{
+	return __atomic_load_n(&thread->stop, __ATOMIC_SEQ_CST);
+}
+
+/*
+ * Wakes up the side of which `is_waiting` is the waiting flag, if it's
+ * waiting for `cond`.
+ *
+ * The waiting side sets its flag before checking the ring indexes
+ * again and the calling side updates its ring index before checking
+ * the flag (all sequentially consistent): one of them always sees the
+ * other's update.
+ */
+static inline
+void wake_up(struct bt_message_iterator_thread *thread, bool *is_waiting,
+		GCond *cond)
+{
+	if (__atomic_load_n(is_waiting, __ATOMIC_SEQ_CST)) {
+		g_mutex_lock(thread->lock);
+		g_cond_signal(cond);
+		g_mutex_unlock(thread->lock);
+	}
+}
+
+/*
+ * Producer thread: waits until the ring contains at most `max_used`
+ * items.
+ *
+ * Returns false if the producer thread must stop instead.
+ */
+static
+bool wait_for_consumer(struct bt_message_iterator_thread *thread,
+		uint64_t max_used)
+{
+	if (G_LIKELY(ring_used(thread) <= max_used)) {
+		goto end;
+	}
+
+	g_mutex_lock(thread->lock);
+	__atomic_store_n(&thread->producer_is_waiting, true, __ATOMIC_SEQ_CST);
+
+	while (!producer_must_stop(thread) && ring_used(thread) > max_used) {
+		g_cond_wait(thread->can_push_cond, thread->lock);
+	}
+
+	__atomic_store_n(&thread->producer_is_waiting, false,
+		__ATOMIC_SEQ_CST);
+	g_mutex_unlock(thread->lock);
+
+end:
+	return !producer_must_stop(thread);
+}
+
+/*
+ * Producer thread: pushes an item (message `msg` or, if `msg` is
+ * `NULL`, status `status`), waiting for room in the ring if needed.
+ *
+ * Returns false, without pushing anything, if the producer thread must
+ * stop instead.
+ */
+static
+bool push_item(struct bt_message_iterator_thread *thread,
+		const struct bt_message *msg, int status)
+{
+	struct bt_message_iterator_thread_item *item;
+	bool pushed = false;
+
+	if (!wait_for_consumer(thread, thread->capacity - 1)) {
+		goto end;
+	}
+
+	item = &thread->items[thread->tail & (thread->capacity - 1)];
+	item->msg = msg;
+	item->status = status;
+
+	/* Publish the item */
+	__atomic_store_n(&thread->tail, thread->tail + 1, __ATOMIC_SEQ_CST);
+	wake_up(thread, &thread->consumer_is_waiting, thread->can_pop_cond);
+	pushed = true;
+
+end:
+	return pushed;
+}
+
+/*
+ * Producer thread: pushes the pending messages and then the pending
+ * status, if any.
+ *
+ * Returns false, keeping what's left pending, if the producer thread
+ * must stop instead.
+ */
+static
+bool push_pending(struct bt_message_iterator_thread *thread)
+{
+	bool pushed = false;
+
+	while (thread->pending.index < thread->pending.count) {
+		if (!push_item(thread,
+				thread->pending.msgs[thread->pending.index],
+				BT_FUNC_STATUS_OK)) {
+			goto end;
+		}
+
+		thread->pending.index++;
+	}
+
+	if (thread->pending.has_status) {
+		if (!push_item(thread, NULL, thread->pending.status)) {
+			goto end;
+		}
+
+		thread->pending.has_status = false;
+	}
+
+	pushed = true;
+
+end:
+	return pushed;
+}
+
+static
+gpointer produce(gpointer data)
+{
+	struct bt_message_iterator_thread *thread = data;
+	struct bt_message_iterator *iterator = thread->iterator;
+
+	BT_LIB_LOGD("Message iterator's producer thread started: %!+i",
+		iterator);
+
+	/* What the previous producer thread couldn't push */
+	if (!push_pending(thread) || thread->producer_is_done) {
+		goto end;
+	}
+
+	while (!producer_must_stop(thread)) {
+		int status;
+
+		thread->pending.index = 0;
+		thread->pending.count = 0;
+		status = bt_message_iterator_call_next_method(iterator,
+			&thread->pending.msgs, &thread->pending.count);
+		if (status != BT_FUNC_STATUS_OK) {
+			thread->pending.count = 0;
+			thread->pending.status = status;
+			thread->pending.has_status = true;
+
+			if (status < 0) {
+				/* Moved to the consumer's thread with the status */
+				thread->error = bt_current_thread_take_error();
+			}
+
+			if (status != BT_FUNC_STATUS_AGAIN) {
+				/*
+				 * End of iteration or error: don't call
+				 * the "next" method again.
+				 */
+				thread->producer_is_done = true;
+			}
+		}
+
+		if (!push_pending(thread) || thread->producer_is_done) {
+			goto end;
+		}
+
+		/*
+		 * Let the consumer pop the "again" status before calling
+		 * the "next" method again.
+		 */
+		if (status == BT_FUNC_STATUS_AGAIN &&
+				!wait_for_consumer(thread, 0)) {
+			goto end;
+		}
+	}
+
+end:
+	BT_LIB_LOGD("Message iterator's producer thread is quitting: %!+i",
+		iterator);
+	return NULL;
+}
+
+/*
+ * Consumer: waits until the ring contains at least one item.
+ *
+ * Returns false if the graph is interrupted while the ring is still
+ * empty.
+ */
+static
+bool wait_for_producer(struct bt_message_iterator_thread *thread)
+{
+	if (G_LIKELY(ring_used(thread) > 0)) {
+		goto end;
+	}
+
+	g_mutex_lock(thread->lock);
+	__atomic_store_n(&thread->consumer_is_waiting, true, __ATOMIC_SEQ_CST);
+
+	while (ring_used(thread) == 0) {
+		if (bt_graph_is_interrupted(thread->iterator->graph)) {
+			break;
+		}
+
+		bt_g_cond_wait_for(thread->can_pop_cond, thread->lock,
+			CONSUMER_WAIT_TIMEOUT_US);
+	}
+
+	__atomic_store_n(&thread->consumer_is_waiting, false,
+		__ATOMIC_SEQ_CST);
+	g_mutex_unlock(thread->lock);
+
+end:
+	return ring_used(thread) > 0;
+}
+
+static
+void join_producer(struct bt_message_iterator_thread *thread)
+{
+	if (!thread->thread) {
+		goto end;
+	}
+
+	g_thread_join(thread->thread);
+	thread->thread = NULL;
+	__atomic_store_n(&thread->stop, false, __ATOMIC_SEQ_CST);
+
+end:
+	return;
+}
+
+BT_HIDDEN
+void bt_message_iterator_thread_pause(
+		struct bt_message_iterator_thread *thread, bool discard)
+{
+	BT_ASSERT(thread);
+
+	if (thread->thread) {
+		BT_LOGD("Stopping message iterator's producer thread: "
+			"iter-addr=%p, discard=%d", thread->iterator, discard);
+		__atomic_store_n(&thread->stop, true, __ATOMIC_SEQ_CST);
+
+		/* Wake up the producer if it's waiting for room */
+		g_mutex_lock(thread->lock);
+		g_cond_signal(thread->can_push_cond);
+		g_mutex_unlock(thread->lock);
+		join_producer(thread);
+	}
+
+	if (!discard) {
+		goto end;
+	}
+
+	while (thread->head != thread->tail) {
+		struct bt_message_iterator_thread_item *item =
+			&thread->items[thread->head & (thread->capacity - 1)];
+
+		if (item->msg) {
+			bt_object_put_ref_no_null_check(item->msg);
+			item->msg = NULL;
+		}
+
+		thread->head++;
+	}
+
+	while (thread->pending.index < thread->pending.count) {
+		bt_object_put_ref_no_null_check(
+			thread->pending.msgs[thread->pending.index]);
+		thread->pending.index++;
+	}
+
+	thread->pending.has_status = false;
+
+	if (thread->error) {
+		bt_error_release(thread->error);
+		thread->error = NULL;
+	}
+
+	thread->producer_is_done = false;
+
+end:
+	return;
+}
+
+BT_HIDDEN
+int bt_message_iterator_thread_next(struct bt_message_iterator_thread *thread,
+		bt_message_array_const *msgs, uint64_t *count)
+{
+	struct bt_message_iterator *iterator = thread->iterator;
+	uint64_t capacity = iterator->msgs->len;
+	uint64_t head = thread->head;
+	uint64_t tail;
+	int status = BT_FUNC_STATUS_OK;
+
+	*count = 0;
+
+	if (G_UNLIKELY(!thread->thread && (!thread->producer_is_done ||
+			thread->pending.has_status))) {
+		BT_LIB_LOGD("Starting message iterator's producer thread: "
+			"%!+i, ring-capacity=%" PRIu64, iterator,
+			thread->capacity);
+		thread->thread = bt_g_thread_new("bt-msg-iter", produce,
+			thread);
+		if (!thread->thread) {
+			BT_LIB_LOGE_APPEND_CAUSE(
+				"Cannot create message iterator's producer thread: "
+				"%!+i", iterator);
+			status = BT_FUNC_STATUS_ERROR;
+			goto end;
+		}
+	}
+
+	if (!wait_for_producer(thread)) {
+		BT_LOGD_STR("Graph is interrupted while waiting for messages.");
+		status = BT_FUNC_STATUS_AGAIN;
+		goto end;
+	}
+
+	tail = __atomic_load_n(&thread->tail, __ATOMIC_SEQ_CST);
+
+	while (head != tail && *count < capacity) {
+		struct bt_message_iterator_thread_item *item =
+			&thread->items[head & (thread->capacity - 1)];
+
+		if (!item->msg) {
+			if (*count == 0) {
+				status = item->status;
+				head++;
+			}
+
+			/* Otherwise, return the status the next time */
+			break;
+		}
+
+		thread->msgs[*count] = item->msg;
+		item->msg = NULL;
+		(*count)++;
+		head++;
+	}
+
+	/* Release the popped items */
+	__atomic_store_n(&thread->head, head, __ATOMIC_SEQ_CST);
+	wake_up(thread, &thread->producer_is_waiting, thread->can_push_cond);
+
+	switch (status) {
+	case BT_FUNC_STATUS_OK:
+		*msgs = thread->msgs;
+		break;
+	case BT_FUNC_STATUS_AGAIN:
+		break;
+	case BT_FUNC_STATUS_END:
+		/* Producer is quitting: it set the iterator's state */
+		join_producer(thread);
+		thread->producer_is_done = false;
+		break;
+	default:
+		BT_ASSERT(status < 0);
+		join_producer(thread);
+		thread->producer_is_done = false;
+
+		if (thread->error) {
+			BT_CURRENT_THREAD_MOVE_ERROR_AND_RESET(thread->error);
+		}
+
+		BT_LIB_LOGW_APPEND_CAUSE(
+			"Message iterator's producer thread failed: "
+			"%![iter-]+i, status=%s", iterator,
+			bt_common_func_status_string(status));
+		break;
+	}
+
+end:
+	return status;
+}
+
+BT_HIDDEN
+struct bt_message_iterator_thread *bt_message_iterator_thread_create(
+		struct bt_message_iterator *iterator, uint64_t capacity)
+{
+	struct bt_message_iterator_thread *thread;
+
+	BT_ASSERT(iterator);
+	BT_ASSERT(capacity > 0);
+	bt_g_thread_init();
+	thread = g_new0(struct bt_message_iterator_thread, 1);
+	if (!thread) {
+		BT_LIB_LOGE_APPEND_CAUSE(
+			"Failed to allocate one message iterator thread.");
+		goto error;
+	}
+
+	thread->iterator = iterator;
+
+	/* Round up to a power of two to index with a mask */
+	thread->capacity = 1;
+
+	while (thread->capacity < capacity) {
+		thread->capacity <<= 1;
+	}
+
+	thread->items = g_new0(struct bt_message_iterator_thread_item,
+		thread->capacity);
+	if (!thread->items) {
+		BT_LIB_LOGE_APPEND_CAUSE("Failed to allocate a message ring: "
+			"capacity=%" PRIu64, thread->capacity);
+		goto error;
+	}
+
+	thread->msgs = g_new0(const struct bt_message *, iterator->msgs->len);
+	if (!thread->msgs) {
+		BT_LIB_LOGE_APPEND_CAUSE("Failed to allocate a message array: "
+			"batch-size=%u", iterator->msgs->len);
+		goto error;
+	}
+
+	thread->lock = bt_g_mutex_new();
+	thread->can_push_cond = bt_g_cond_new();
+	thread->can_pop_cond = bt_g_cond_new();
+	if (!thread->lock || !thread->can_push_cond || !thread->can_pop_cond) {
+		BT_LIB_LOGE_APPEND_CAUSE(
+			"Failed to allocate a mutex or a condition.");
+		goto error;
+	}
+
+	BT_LIB_LOGD("Created message iterator thread: %!+i, "
+		"ring-capacity=%" PRIu64, iterator, thread->capacity);
+	goto end;
+
+error:
+	bt_message_iterator_thread_destroy(thread);
+	thread = NULL;
+
+end:
+	return thread;
+}
+
+BT_HIDDEN
+void bt_message_iterator_thread_destroy(
+		struct bt_message_iterator_thread *thread)
+{
+	if (!thread) {
+		goto end;
+	}
+
+	if (thread->items) {
+		bt_message_iterator_thread_pause(thread, true);
+		g_free(thread->items);
+	}
+
+	g_free(thread->msgs);
+	bt_g_cond_free(thread->can_pop_cond);
+	bt_g_cond_free(thread->can_push_cond);
+	bt_g_mutex_free(thread->lock);
+	g_free(thread);
+
+end:
+	return;
+}
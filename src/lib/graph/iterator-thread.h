@@ -0,0 +1,150 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (C) 2023 EfficiOS Inc.
+ */
+
+#ifndef BABELTRACE_GRAPH_ITERATOR_THREAD_INTERNAL_H
+#define BABELTRACE_GRAPH_ITERATOR_THREAD_INTERNAL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <glib.h>
+#include <babeltrace2/error-reporting.h>
+#include <babeltrace2/graph/message.h>
+
+#include "common/macros.h"
+
+struct bt_message_iterator;
+
+/*
+ * Item of a message ring.
+ */
+struct bt_message_iterator_thread_item {
+	/*
+	 * Message (owned by this item), or `NULL` if this item carries
+	 * the status of the upstream "next" method instead.
+	 */
+	const struct bt_message *msg;
+
+	/* `BT_FUNC_STATUS_*` value when `msg` is `NULL` */
+	int status;
+};
+
+/*
+ * Producer thread of a message iterator which is on a thread boundary
+ * connection (see bt_graph_make_connection_thread_boundary()).
+ *
+ * The producer thread calls the "next" method of the message iterator
+ * and pushes the resulting messages, and then the terminal status, to
+ * a bounded single-producer/single-consumer ring. The downstream user
+ * (the consumer), calling bt_message_iterator_next() on its own
+ * thread, pops them from this ring.
+ *
+ * The producer thread only exists between a bt_message_iterator_next()
+ * call and the next pause, that is, seeking, checking whether or not
+ * the message iterator can seek, or finalizing it: the message
+ * iterator then only runs on the consumer's thread again.
+ */
+struct bt_message_iterator_thread {
+	/* Weak */
+	struct bt_message_iterator *iterator;
+
+	/* Producer thread, or `NULL` if paused */
+	GThread *thread;
+
+	/* Ring of `capacity` items (power of two) */
+	struct bt_message_iterator_thread_item *items;
+	uint64_t capacity;
+
+	/*
+	 * Index of the next item to pop (only written by the consumer)
+	 * and of the next item to push (only written by the producer).
+	 *
+	 * Those are free-running: use `& (capacity - 1)` to get an
+	 * index within `items`.
+	 */
+	uint64_t head;
+	uint64_t tail;
+
+	/*
+	 * Protects the waiting flags below: a side which finds the ring
+	 * full (producer) or empty (consumer) sets its waiting flag and
+	 * waits for its condition, which the other side only signals
+	 * when the flag is set.
+	 */
+	GMutex *lock;
+	GCond *can_push_cond;
+	GCond *can_pop_cond;
+	bool producer_is_waiting;
+	bool consumer_is_waiting;
+
+	/* True to ask the producer thread to quit */
+	bool stop;
+
+	/*
+	 * Error which the producer thread took from its current thread
+	 * when the "next" method failed, to move to the consumer's
+	 * thread when it pops the corresponding status item.
+	 */
+	const struct bt_error *error;
+
+	/*
+	 * Array of `batch size` messages which
+	 * bt_message_iterator_next() returns to the consumer (the
+	 * producer thread uses the message iterator's own array).
+	 */
+	const struct bt_message **msgs;
+
+	/*
+	 * Messages and status which the producer thread got from the
+	 * "next" method, but didn't push yet because it had to stop.
+	 */
+	struct {
+		/* Message iterator's own array */
+		bt_message_array_const msgs;
+
+		uint64_t count;
+
+		/* Index of the next message to push */
+		uint64_t index;
+
+		int status;
+		bool has_status;
+	} pending;
+
+	/*
+	 * True if the producer thread got a terminal status (end of
+	 * iteration or error) which the consumer didn't pop yet: don't
+	 * call the "next" method again until then.
+	 */
+	bool producer_is_done;
+};
+
+BT_HIDDEN
+struct bt_message_iterator_thread *bt_message_iterator_thread_create(
+		struct bt_message_iterator *iterator, uint64_t capacity);
+
+BT_HIDDEN
+void bt_message_iterator_thread_destroy(
+		struct bt_message_iterator_thread *thread);
+
+/*
+ * Pops the next messages of the producer thread of `thread`, starting
+ * it if needed, like bt_message_iterator_next() does.
+ */
+BT_HIDDEN
+int bt_message_iterator_thread_next(struct bt_message_iterator_thread *thread,
+		bt_message_array_const *msgs, uint64_t *count);
+
+/*
+ * Stops and joins the producer thread of `thread`, if any.
+ *
+ * If `discard` is true, also discards the messages and status which
+ * the consumer didn't pop yet: do this before seeking.
+ */
+BT_HIDDEN
+void bt_message_iterator_thread_pause(
+		struct bt_message_iterator_thread *thread, bool discard);
+
+#endif /* BABELTRACE_GRAPH_ITERATOR_THREAD_INTERNAL_H */
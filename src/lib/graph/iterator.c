@@ -42,6 +42,7 @@
 #include "component-source.h"
 #include "connection.h"
 #include "graph.h"
+#include "iterator-thread.h"
 #include "message-iterator-class.h"
 #include "message/discarded-items.h"
 #include "message/event.h"
@@ -50,14 +51,10 @@
 #include "message/message-iterator-inactivity.h"
 #include "message/stream.h"
 #include "message/packet.h"
+#include "port.h"
+#include "statistics.h"
 #include "lib/func-status.h"
 
-/*
- * TODO: Use graph's state (number of active iterators, etc.) and
- * possibly system specifications to make a better guess than this.
- */
-#define MSG_BATCH_SIZE	15
-
 #define BT_ASSERT_PRE_ITER_HAS_STATE_TO_SEEK(_iter)			\
 	BT_ASSERT_PRE("has-state-to-seek",				\
 		(_iter)->state == BT_MESSAGE_ITERATOR_STATE_ACTIVE ||	\
@@ -99,6 +96,8 @@ void bt_message_iterator_destroy(struct bt_object *obj)
 	BT_LIB_LOGI("Destroying self component input port message iterator object: "
 		"%!+i", iterator);
 	bt_message_iterator_try_finalize(iterator);
+	bt_message_iterator_thread_destroy(iterator->thread);
+	iterator->thread = NULL;
 
 	if (iterator->connection) {
 		/*
@@ -147,6 +146,11 @@ void bt_message_iterator_try_finalize(
 
 	BT_ASSERT(iterator);
 
+	if (iterator->thread) {
+		/* From now on, this iterator only runs on this thread */
+		bt_message_iterator_thread_pause(iterator->thread, true);
+	}
+
 	switch (iterator->state) {
 	case BT_MESSAGE_ITERATOR_STATE_NON_INITIALIZED:
 		/*
@@ -339,8 +343,15 @@ int create_self_component_input_port_message_iterator(
 		goto error;
 	}
 
-	g_ptr_array_set_size(iterator->msgs, MSG_BATCH_SIZE);
+	/*
+	 * The length of this array is the capacity of the message
+	 * array which this iterator passes to its "next" method (see
+	 * bt_graph_set_message_batch_size()).
+	 */
+	g_ptr_array_set_size(iterator->msgs,
+		bt_component_borrow_graph(upstream_comp)->msg_batch_size);
 	iterator->last_ns_from_origin = INT64_MIN;
+	iterator->wake_up_fd = -1;
 	iterator->auto_seek.msgs = g_queue_new();
 	if (!iterator->auto_seek.msgs) {
 		BT_LIB_LOGE_APPEND_CAUSE("Failed to allocate a GQueue.");
@@ -426,6 +437,18 @@ int create_self_component_input_port_message_iterator(
 		iterator->config.frozen = true;
 	}
 
+	if (port->connection->thread_queue_capacity > 0) {
+		iterator->thread = bt_message_iterator_thread_create(iterator,
+			port->connection->thread_queue_capacity);
+		if (!iterator->thread) {
+			BT_LIB_LOGE_APPEND_CAUSE(
+				"Cannot create message iterator thread: "
+				"%![conn-]+x", port->connection);
+			status = BT_FUNC_STATUS_MEMORY_ERROR;
+			goto error;
+		}
+	}
+
 	if (downstream_msg_iter) {
 		/* Set this message iterator's downstream message iterator */
 		iterator->downstream_msg_iter = downstream_msg_iter;
@@ -514,6 +537,29 @@ void bt_self_message_iterator_configuration_set_can_seek_forward(
 	config->can_seek_forward = can_seek_forward;
 }
 
+void bt_self_message_iterator_configuration_set_is_multithreaded(
+		bt_self_message_iterator_configuration *config,
+		bt_bool is_multithreaded)
+{
+	BT_ASSERT_PRE_NON_NULL("message-iterator-configuration", config,
+		"Message iterator configuration");
+	BT_ASSERT_PRE_DEV_HOT("message-iterator-configuration", config,
+		"Message iterator configuration", "");
+
+	config->is_multithreaded = is_multithreaded;
+
+	if (is_multithreaded && !bt_object_is_multithreaded()) {
+		/*
+		 * Switch now, before the message iterator's
+		 * initialization method has a chance to start any
+		 * worker thread (see bt_object_set_multithreaded()).
+		 */
+		BT_LOGI_STR("Enabling thread-safe object reference counts "
+			"and object pools.");
+		bt_object_set_multithreaded();
+	}
+}
+
 /*
  * Validate that the default clock snapshot in `msg` doesn't make us go back in
  * time.
@@ -797,10 +843,24 @@ call_iterator_next_method(
 		bt_message_array_const msgs, uint64_t capacity, uint64_t *user_count)
 {
 	enum bt_message_iterator_class_next_method_status status;
+	struct bt_graph_statistics_frame stats_frame;
+	bool collect_stats = iterator->graph->perf_stats_enabled;
 
 	BT_ASSERT_DBG(iterator->methods.next);
 	BT_LOGD_STR("Calling user's \"next\" method.");
+
+	if (G_UNLIKELY(collect_stats)) {
+		bt_graph_statistics_frame_begin(&stats_frame);
+	}
+
 	status = iterator->methods.next(iterator, msgs, capacity, user_count);
+
+	if (G_UNLIKELY(collect_stats)) {
+		bt_graph_statistics_frame_end(&stats_frame,
+			&iterator->upstream_port->next_method_stats,
+			(int) status, capacity, *user_count);
+	}
+
 	BT_LOGD("User method returned: status=%s, msg-count=%" PRIu64,
 		bt_common_func_status_string(status), *user_count);
 
@@ -823,33 +883,16 @@ call_iterator_next_method(
 	return status;
 }
 
-enum bt_message_iterator_next_status
-bt_message_iterator_next(
+BT_HIDDEN
+int bt_message_iterator_call_next_method(
 		struct bt_message_iterator *iterator,
 		bt_message_array_const *msgs, uint64_t *user_count)
 {
-	enum bt_message_iterator_next_status status = BT_FUNC_STATUS_OK;
+	int status;
 
-	BT_ASSERT_PRE_DEV_NO_ERROR();
-	BT_ASSERT_PRE_DEV_MSG_ITER_NON_NULL(iterator);
-	BT_ASSERT_PRE_DEV_NON_NULL("message-array-output", msgs,
-		"Message array (output)");
-	BT_ASSERT_PRE_DEV_NON_NULL("user-count-output", user_count,
-		"Message count (output)");
-	BT_ASSERT_PRE_DEV("message-iterator-is-active",
-		iterator->state == BT_MESSAGE_ITERATOR_STATE_ACTIVE,
-		"Message iterator's \"next\" called, but "
-		"message iterator is in the wrong state: %!+i", iterator);
-	BT_ASSERT_DBG(iterator->upstream_component);
-	BT_ASSERT_DBG(iterator->upstream_component->class);
-	BT_ASSERT_PRE_DEV("graph-is-configured",
-		bt_component_borrow_graph(iterator->upstream_component)->config_state !=
-			BT_GRAPH_CONFIGURATION_STATE_CONFIGURING,
-		"Graph is not configured: %!+g",
-		bt_component_borrow_graph(iterator->upstream_component));
 	BT_LIB_LOGD("Getting next self component input port "
 		"message iterator's messages: %!+i, batch-size=%u",
-		iterator, MSG_BATCH_SIZE);
+		iterator, iterator->msgs->len);
 
 	/*
 	 * Call the user's "next" method to get the next messages
@@ -857,10 +900,12 @@ bt_message_iterator_next(
 	 */
 	*user_count = 0;
 	status = (int) call_iterator_next_method(iterator,
-		(void *) iterator->msgs->pdata, MSG_BATCH_SIZE,
+		(void *) iterator->msgs->pdata, iterator->msgs->len,
 		user_count);
 	BT_LOGD("User method returned: status=%s, msg-count=%" PRIu64,
 		bt_common_func_status_string(status), *user_count);
+	__atomic_store_n(&iterator->last_next_returned_again,
+		status == BT_FUNC_STATUS_AGAIN, __ATOMIC_RELAXED);
 	if (status < 0) {
 		BT_LIB_LOGW_APPEND_CAUSE(
 			"Component input port message iterator's \"next\" method failed: "
@@ -884,10 +929,10 @@ bt_message_iterator_next(
 	switch (status) {
 	case BT_FUNC_STATUS_OK:
 		BT_ASSERT_POST_DEV(NEXT_METHOD_NAME, "count-lteq-capacity",
-			*user_count <= MSG_BATCH_SIZE,
+			*user_count <= iterator->msgs->len,
 			"Invalid returned message count: greater than "
 			"batch size: count=%" PRIu64 ", batch-size=%u",
-			*user_count, MSG_BATCH_SIZE);
+			*user_count, iterator->msgs->len);
 		*msgs = (void *) iterator->msgs->pdata;
 		break;
 	case BT_FUNC_STATUS_AGAIN:
@@ -905,6 +950,57 @@ end:
 	return status;
 }
 
+BT_ASSERT_COND_DEV_FUNC
+static
+bool message_iterator_is_active(struct bt_message_iterator *iterator)
+{
+	struct bt_message_iterator_thread *thread = iterator->thread;
+
+	/*
+	 * The state of a thread boundary message iterator belongs to
+	 * its producer thread while it runs, and the consumer didn't
+	 * get the end of iteration yet if its ring isn't empty.
+	 */
+	if (thread && (thread->thread || thread->head !=
+			__atomic_load_n(&thread->tail, __ATOMIC_SEQ_CST))) {
+		return true;
+	}
+
+	return iterator->state == BT_MESSAGE_ITERATOR_STATE_ACTIVE;
+}
+
+enum bt_message_iterator_next_status
+bt_message_iterator_next(
+		struct bt_message_iterator *iterator,
+		bt_message_array_const *msgs, uint64_t *user_count)
+{
+	BT_ASSERT_PRE_DEV_NO_ERROR();
+	BT_ASSERT_PRE_DEV_MSG_ITER_NON_NULL(iterator);
+	BT_ASSERT_PRE_DEV_NON_NULL("message-array-output", msgs,
+		"Message array (output)");
+	BT_ASSERT_PRE_DEV_NON_NULL("user-count-output", user_count,
+		"Message count (output)");
+	BT_ASSERT_PRE_DEV("message-iterator-is-active",
+		message_iterator_is_active(iterator),
+		"Message iterator's \"next\" called, but "
+		"message iterator is in the wrong state: %!+i", iterator);
+	BT_ASSERT_DBG(iterator->upstream_component);
+	BT_ASSERT_DBG(iterator->upstream_component->class);
+	BT_ASSERT_PRE_DEV("graph-is-configured",
+		bt_component_borrow_graph(iterator->upstream_component)->config_state !=
+			BT_GRAPH_CONFIGURATION_STATE_CONFIGURING,
+		"Graph is not configured: %!+g",
+		bt_component_borrow_graph(iterator->upstream_component));
+
+	if (G_UNLIKELY(iterator->thread)) {
+		return bt_message_iterator_thread_next(iterator->thread, msgs,
+			user_count);
+	}
+
+	return bt_message_iterator_call_next_method(iterator, msgs,
+		user_count);
+}
+
 struct bt_component *
 bt_message_iterator_borrow_component(
 		struct bt_message_iterator *iterator)
@@ -946,6 +1042,12 @@ bt_message_iterator_can_seek_ns_from_origin(
 	BT_ASSERT_PRE_NO_ERROR();
 	BT_ASSERT_PRE_MSG_ITER_NON_NULL(iterator);
 	BT_ASSERT_PRE_RES_OUT_NON_NULL(can_seek);
+
+	if (iterator->thread) {
+		/* Keep the messages which the consumer didn't get yet */
+		bt_message_iterator_thread_pause(iterator->thread, false);
+	}
+
 	BT_ASSERT_PRE_ITER_HAS_STATE_TO_SEEK(iterator);
 	BT_ASSERT_PRE("graph-is-configured",
 		bt_component_borrow_graph(iterator->upstream_component)->config_state !=
@@ -1023,6 +1125,12 @@ bt_message_iterator_can_seek_beginning(
 	BT_ASSERT_PRE_NO_ERROR();
 	BT_ASSERT_PRE_MSG_ITER_NON_NULL(iterator);
 	BT_ASSERT_PRE_RES_OUT_NON_NULL(can_seek);
+
+	if (iterator->thread) {
+		/* Keep the messages which the consumer didn't get yet */
+		bt_message_iterator_thread_pause(iterator->thread, false);
+	}
+
 	BT_ASSERT_PRE_ITER_HAS_STATE_TO_SEEK(iterator);
 	BT_ASSERT_PRE("graph-is-configured",
 		bt_component_borrow_graph(iterator->upstream_component)->config_state !=
@@ -1119,6 +1227,12 @@ bt_message_iterator_seek_beginning(struct bt_message_iterator *iterator)
 
 	BT_ASSERT_PRE_NO_ERROR();
 	BT_ASSERT_PRE_MSG_ITER_NON_NULL(iterator);
+
+	if (iterator->thread) {
+		/* Seeking: discard what the producer thread got */
+		bt_message_iterator_thread_pause(iterator->thread, true);
+	}
+
 	BT_ASSERT_PRE_ITER_HAS_STATE_TO_SEEK(iterator);
 	BT_ASSERT_PRE("graph-is-configured",
 		bt_component_borrow_graph(iterator->upstream_component)->config_state !=
@@ -1527,13 +1641,24 @@ int find_message_ge_ns_from_origin(
 	int status = BT_FUNC_STATUS_OK;
 	enum bt_message_iterator_state init_state =
 		iterator->state;
-	const struct bt_message *messages[MSG_BATCH_SIZE];
+	const struct bt_message **messages;
 	uint64_t user_count = 0;
 	uint64_t i;
 	bool got_first = false;
 
 	BT_ASSERT_DBG(iterator);
-	memset(&messages[0], 0, sizeof(messages[0]) * MSG_BATCH_SIZE);
+
+	/*
+	 * Don't use the iterator's own message array: the downstream
+	 * user could still hold it.
+	 */
+	messages = g_new0(const struct bt_message *, iterator->msgs->len);
+	if (!messages) {
+		BT_LIB_LOGE_APPEND_CAUSE("Failed to allocate a message array: "
+			"batch-size=%u", iterator->msgs->len);
+		status = BT_FUNC_STATUS_MEMORY_ERROR;
+		goto end;
+	}
 
 	/*
 	 * Make this iterator temporarily active (not seeking) to call
@@ -1550,7 +1675,7 @@ int find_message_ge_ns_from_origin(
 		 * messages and status.
 		 */
 		status = call_iterator_next_method(iterator,
-			&messages[0], MSG_BATCH_SIZE, &user_count);
+			&messages[0], iterator->msgs->len, &user_count);
 		BT_LOGD("User method returned: status=%s",
 			bt_common_func_status_string(status));
 		if (status < 0) {
@@ -1571,10 +1696,10 @@ int find_message_ge_ns_from_origin(
 		case BT_FUNC_STATUS_OK:
 			BT_ASSERT_POST_DEV(NEXT_METHOD_NAME,
 				"count-lteq-capacity",
-				user_count <= MSG_BATCH_SIZE,
+				user_count <= iterator->msgs->len,
 				"Invalid returned message count: greater than "
 				"batch size: count=%" PRIu64 ", batch-size=%u",
-				user_count, MSG_BATCH_SIZE);
+				user_count, iterator->msgs->len);
 			break;
 		case BT_FUNC_STATUS_AGAIN:
 		case BT_FUNC_STATUS_ERROR:
@@ -1612,6 +1737,7 @@ end:
 		}
 	}
 
+	g_free(messages);
 	set_msg_iterator_state(iterator, init_state);
 	return status;
 }
@@ -1699,6 +1825,12 @@ bt_message_iterator_seek_ns_from_origin(
 
 	BT_ASSERT_PRE_NO_ERROR();
 	BT_ASSERT_PRE_MSG_ITER_NON_NULL(iterator);
+
+	if (iterator->thread) {
+		/* Seeking: discard what the producer thread got */
+		bt_message_iterator_thread_pause(iterator->thread, true);
+	}
+
 	BT_ASSERT_PRE_ITER_HAS_STATE_TO_SEEK(iterator);
 	BT_ASSERT_PRE("graph-is-configured",
 		bt_component_borrow_graph(iterator->upstream_component)->config_state !=
@@ -1974,6 +2106,19 @@ bt_bool bt_self_message_iterator_is_interrupted(
 	return (bt_bool) bt_graph_is_interrupted(iterator->graph);
 }
 
+void bt_self_message_iterator_set_wake_up_fd(
+		struct bt_self_message_iterator *self_msg_iter, int fd)
+{
+	struct bt_message_iterator *iterator = (void *) self_msg_iter;
+
+	BT_ASSERT_PRE_MSG_ITER_NON_NULL(iterator);
+	BT_ASSERT_PRE("valid-file-descriptor", fd >= -1,
+		"Invalid file descriptor: fd=%d", fd);
+	iterator->wake_up_fd = fd;
+	BT_LIB_LOGD("Set message iterator's wake-up file descriptor: "
+		"%!+i, fd=%d", iterator, fd);
+}
+
 void bt_message_iterator_get_ref(
 		const struct bt_message_iterator *iterator)
 {
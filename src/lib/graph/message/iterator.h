@@ -19,6 +19,7 @@
 
 struct bt_port;
 struct bt_graph;
+struct bt_message_iterator_thread;
 
 enum bt_message_iterator_state {
 	/* Iterator is not initialized */
@@ -72,6 +73,7 @@ typedef enum bt_message_iterator_class_can_seek_beginning_method_status
 struct bt_self_message_iterator_configuration {
 	bool frozen;
 	bool can_seek_forward;
+	bool is_multithreaded;
 };
 
 struct bt_message_iterator {
@@ -180,6 +182,30 @@ struct bt_message_iterator {
 		void *original_next_callback;
 	} auto_seek;
 
+	/*
+	 * Producer thread and message ring if this message iterator is
+	 * on a thread boundary connection, or `NULL`.
+	 */
+	struct bt_message_iterator_thread *thread;
+
+	/*
+	 * File descriptor which becomes readable when this message
+	 * iterator is ready again after its "next" method returned
+	 * "try again", or -1 (see
+	 * bt_self_message_iterator_set_wake_up_fd()).
+	 */
+	int wake_up_fd;
+
+	/*
+	 * True if the last call to the "next" method returned "try
+	 * again".
+	 *
+	 * Accessed atomically: the producer thread of a thread
+	 * boundary message iterator writes it while the graph's thread
+	 * can read it (see bt_graph_run_and_wait()).
+	 */
+	bool last_next_returned_again;
+
 	void *user_data;
 };
 
@@ -187,6 +213,15 @@ BT_HIDDEN
 void bt_message_iterator_try_finalize(
 		struct bt_message_iterator *iterator);
 
+/*
+ * Calls the "next" method of `iterator` on the current thread, without
+ * checking the preconditions.
+ */
+BT_HIDDEN
+int bt_message_iterator_call_next_method(
+		struct bt_message_iterator *iterator,
+		bt_message_array_const *msgs, uint64_t *user_count);
+
 BT_HIDDEN
 void bt_message_iterator_set_connection(
 		struct bt_message_iterator *iterator,
@@ -37,6 +37,12 @@ struct bt_message {
 
 	/* Owned by this; keeps the graph alive while the msg. is alive */
 	struct bt_graph *graph;
+
+	/*
+	 * Index of this message within the message array of the graph
+	 * which created it (see bt_graph_add_message()).
+	 */
+	guint graph_msg_index;
 };
 
 BT_HIDDEN
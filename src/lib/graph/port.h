@@ -11,12 +11,21 @@
 #include <babeltrace2/graph/port.h>
 #include "common/macros.h"
 
+#include "statistics.h"
+
 struct bt_port {
 	struct bt_object base;
 	enum bt_port_type type;
 	GString *name;
 	struct bt_connection *connection;
 	void *user_data;
+
+	/*
+	 * Performance statistics of the "next" method calls of the
+	 * message iterators of this port (output port only; see
+	 * bt_graph_enable_performance_statistics()).
+	 */
+	struct bt_graph_method_statistics next_method_stats;
 };
 
 struct bt_component;
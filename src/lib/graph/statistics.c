@@ -0,0 +1,126 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (C) 2023 EfficiOS Inc.
+ */
+
+#define BT_LOG_TAG "LIB/GRAPH-STATS"
+#include "lib/logging.h"
+
+#include <stdint.h>
+#include <time.h>
+#include <babeltrace2/babeltrace.h>
+
+#include "common/assert.h"
+#include "lib/func-status.h"
+
+#include "statistics.h"
+
+/* Top of the frame stack of the current thread */
+static __thread struct bt_graph_statistics_frame *cur_frame;
+
+static inline
+uint64_t monotonic_time_ns(void)
+{
+	struct timespec ts;
+	int ret;
+
+	ret = clock_gettime(CLOCK_MONOTONIC, &ts);
+	BT_ASSERT_DBG(ret == 0);
+	return (uint64_t) ts.tv_sec * UINT64_C(1000000000) +
+		(uint64_t) ts.tv_nsec;
+}
+
+BT_HIDDEN
+void bt_graph_statistics_frame_begin(struct bt_graph_statistics_frame *frame)
+{
+	BT_ASSERT_DBG(frame);
+	frame->parent = cur_frame;
+	frame->child_time_ns = 0;
+	cur_frame = frame;
+	frame->begin_ns = monotonic_time_ns();
+}
+
+BT_HIDDEN
+void bt_graph_statistics_frame_end(struct bt_graph_statistics_frame *frame,
+		struct bt_graph_method_statistics *stats, int status,
+		uint64_t capacity, uint64_t msg_count)
+{
+	uint64_t time_ns = monotonic_time_ns() - frame->begin_ns;
+
+	BT_ASSERT_DBG(cur_frame == frame);
+	BT_ASSERT_DBG(stats);
+	cur_frame = frame->parent;
+
+	if (frame->parent) {
+		frame->parent->child_time_ns += time_ns;
+	}
+
+	__atomic_fetch_add(&stats->call_count, 1, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&stats->inclusive_time_ns, time_ns,
+		__ATOMIC_RELAXED);
+	__atomic_fetch_add(&stats->exclusive_time_ns,
+		time_ns - frame->child_time_ns, __ATOMIC_RELAXED);
+
+	switch (status) {
+	case BT_FUNC_STATUS_OK:
+		if (capacity > 0) {
+			__atomic_fetch_add(&stats->msg_count, msg_count,
+				__ATOMIC_RELAXED);
+			__atomic_fetch_add(&stats->capacity, capacity,
+				__ATOMIC_RELAXED);
+		}
+
+		break;
+	case BT_FUNC_STATUS_AGAIN:
+		__atomic_fetch_add(&stats->again_count, 1, __ATOMIC_RELAXED);
+		break;
+	default:
+		break;
+	}
+}
+
+BT_HIDDEN
+bt_value *bt_graph_method_statistics_to_value(
+		const struct bt_graph_method_statistics *stats)
+{
+	const struct {
+		const char *name;
+		const uint64_t *counter;
+	} entries[] = {
+		{ "call-count", &stats->call_count },
+		{ "again-count", &stats->again_count },
+		{ "message-count", &stats->msg_count },
+		{ "capacity", &stats->capacity },
+		{ "inclusive-time-ns", &stats->inclusive_time_ns },
+		{ "exclusive-time-ns", &stats->exclusive_time_ns },
+	};
+	bt_value *map;
+	size_t i;
+
+	map = bt_value_map_create();
+	if (!map) {
+		BT_LIB_LOGE_APPEND_CAUSE("Failed to create a map value.");
+		goto error;
+	}
+
+	for (i = 0; i < sizeof(entries) / sizeof(entries[0]); i++) {
+		if (bt_value_map_insert_unsigned_integer_entry(map,
+				entries[i].name,
+				__atomic_load_n(entries[i].counter,
+					__ATOMIC_RELAXED))) {
+			BT_LIB_LOGE_APPEND_CAUSE(
+				"Cannot insert unsigned integer value into map value: "
+				"key=\"%s\"", entries[i].name);
+			goto error;
+		}
+	}
+
+	goto end;
+
+error:
+	BT_VALUE_PUT_REF_AND_RESET(map);
+
+end:
+	return map;
+}
@@ -0,0 +1,97 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (C) 2023 EfficiOS Inc.
+ */
+
+#ifndef BABELTRACE_GRAPH_STATISTICS_INTERNAL_H
+#define BABELTRACE_GRAPH_STATISTICS_INTERNAL_H
+
+#include <stdint.h>
+#include <babeltrace2/babeltrace.h>
+
+#include "common/macros.h"
+
+/*
+ * Performance statistics of the calls to a given user method (the
+ * "next" method of the message iterators of an output port, or the
+ * "consume" method of a sink component).
+ *
+ * More than one thread can update those counters at the same time
+ * (thread boundary connections): always use atomic operations.
+ */
+struct bt_graph_method_statistics {
+	/* Number of calls */
+	uint64_t call_count;
+
+	/* Number of calls which returned "try again" */
+	uint64_t again_count;
+
+	/* Number of returned messages ("next" method only) */
+	uint64_t msg_count;
+
+	/*
+	 * Sum of the message array capacities of the calls which
+	 * returned messages ("next" method only): `msg_count /
+	 * capacity` is the batch fill ratio.
+	 */
+	uint64_t capacity;
+
+	/* Total duration of the calls (ns) */
+	uint64_t inclusive_time_ns;
+
+	/*
+	 * Total duration of the calls (ns), excluding the nested user
+	 * method calls which the library also measures.
+	 */
+	uint64_t exclusive_time_ns;
+};
+
+/*
+ * Measured user method call.
+ *
+ * The frames of a given thread form a stack so that the duration of a
+ * nested call (for example, the "next" method of an upstream message
+ * iterator which a filter message iterator calls) is part of the
+ * inclusive time of its parent, but not of its exclusive time.
+ */
+struct bt_graph_statistics_frame {
+	/* Parent frame within the current thread, or `NULL` */
+	struct bt_graph_statistics_frame *parent;
+
+	/* Monotonic time at the beginning of the call (ns) */
+	uint64_t begin_ns;
+
+	/* Total duration of the direct nested calls (ns) */
+	uint64_t child_time_ns;
+};
+
+/*
+ * Pushes `frame` onto the frame stack of the current thread and
+ * records the beginning time of its call.
+ */
+BT_HIDDEN
+void bt_graph_statistics_frame_begin(struct bt_graph_statistics_frame *frame);
+
+/*
+ * Pops `frame`, which must be the top of the frame stack of the
+ * current thread, and adds its call to `stats`.
+ *
+ * `status` is the status of the user method call, `capacity` the
+ * capacity of its message array (0 for a "consume" method), and
+ * `msg_count` the number of messages it returned.
+ */
+BT_HIDDEN
+void bt_graph_statistics_frame_end(struct bt_graph_statistics_frame *frame,
+		struct bt_graph_method_statistics *stats, int status,
+		uint64_t capacity, uint64_t msg_count);
+
+/*
+ * Returns a new map value containing the counters of `stats`, or
+ * `NULL` on memory error.
+ */
+BT_HIDDEN
+bt_value *bt_graph_method_statistics_to_value(
+		const struct bt_graph_method_statistics *stats);
+
+#endif /* BABELTRACE_GRAPH_STATISTICS_INTERNAL_H */
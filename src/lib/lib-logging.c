@@ -133,6 +133,21 @@ static inline void format_object_pool(char **buf_ch, bool extended,
 	if (pool->objects) {
 		BUF_APPEND(", %scap=%u", PRFIELD(pool->objects->len));
 	}
+
+	if (pool->max_size != SIZE_MAX) {
+		BUF_APPEND(", %smax-size=%zu", PRFIELD(pool->max_size));
+	}
+
+	if (pool->budget) {
+		BUF_APPEND(", %sbudget-addr=%p, %sobj-size=%zu",
+			PRFIELD(pool->budget), PRFIELD(pool->object_size));
+	}
+
+	BUF_APPEND(", %snew-count=%" PRIu64 ", %sreuse-count=%" PRIu64
+		", %sdiscard-count=%" PRIu64,
+		PRFIELD(pool->stats.new_count),
+		PRFIELD(pool->stats.reuse_count),
+		PRFIELD(pool->stats.discard_count));
 }
 
 static inline void format_integer_field_class(char **buf_ch,
@@ -427,6 +442,11 @@ static inline void format_field(char **buf_ch, bool extended,
 				PRFIELD(array_field->fields->len));
 		}
 
+		if (array_field->values) {
+			BUF_APPEND(", %svalues-are-packed=%d",
+				PRFIELD(array_field->values_are_packed));
+		}
+
 		break;
 	}
 	case BT_FIELD_CLASS_TYPE_VARIANT_WITHOUT_SELECTOR_FIELD:
@@ -702,9 +722,11 @@ static inline void format_packet(char **buf_ch, bool extended,
 		return;
 	}
 
-	BUF_APPEND(", %sis-frozen=%d, %scontext-field-addr=%p",
+	BUF_APPEND(", %sis-frozen=%d, %scontext-field-addr=%p, "
+		"%shas-raw-data=%d",
 		PRFIELD(packet->frozen),
-		PRFIELD(packet->context_field ? packet->context_field->field : NULL));
+		PRFIELD(packet->context_field ? packet->context_field->field : NULL),
+		PRFIELD(packet->raw_data.data != NULL));
 	stream = bt_packet_borrow_stream_const(packet);
 	if (!stream) {
 		return;
@@ -737,11 +759,13 @@ static inline void format_event(char **buf_ch, bool extended,
 	BUF_APPEND(", %sis-frozen=%d, "
 		"%scommon-context-field-addr=%p, "
 		"%sspecific-context-field-addr=%p, "
-		"%spayload-field-addr=%p, ",
+		"%spayload-field-addr=%p, "
+		"%sis-payload-field-deferred=%d, ",
 		PRFIELD(event->frozen),
 		PRFIELD(event->common_context_field),
 		PRFIELD(event->specific_context_field),
-		PRFIELD(event->payload_field));
+		PRFIELD(event->payload_field),
+		PRFIELD(event->payload_materialization.func != NULL));
 	BUF_APPEND(", %sevent-class-addr=%p", PRFIELD(event->class));
 
 	if (!event->class) {
@@ -1136,6 +1160,9 @@ static inline void format_connection(char **buf_ch, bool extended,
 		return;
 	}
 
+	BUF_APPEND(", %sthread-queue-capacity=%" PRIu64,
+		PRFIELD(connection->thread_queue_capacity));
+
 	if (connection->upstream_port) {
 		SET_TMP_PREFIX("upstream-port-");
 		format_port(buf_ch, false, tmp_prefix,
@@ -1172,6 +1199,20 @@ static inline void format_graph(char **buf_ch, bool extended,
 			PRFIELD(graph->connections->len));
 	}
 
+	BUF_APPEND(", %smsg-batch-size=%" PRIu64 ", %sperf-stats-enabled=%d",
+		PRFIELD(graph->msg_batch_size),
+		PRFIELD(graph->perf_stats_enabled));
+
+	if (graph->messages) {
+		BUF_APPEND(", %smsg-count=%u",
+			PRFIELD(graph->messages->len));
+	}
+
+	BUF_APPEND(", %smsg-pool-budget=%" PRIu64
+		", %smsg-pool-mem-size=%" PRIu64,
+		PRFIELD(graph->msg_pool_budget.max_size),
+		PRFIELD(graph->msg_pool_budget.size));
+
 	SET_TMP_PREFIX("en-pool-");
 	format_object_pool(buf_ch, extended, tmp_prefix,
 		&graph->event_msg_pool);
@@ -1220,6 +1261,10 @@ static inline void format_message_iterator(char **buf_ch,
 			port_in_iter->connection);
 	}
 
+	if (port_in_iter->wake_up_fd >= 0) {
+		BUF_APPEND(", %swake-up-fd=%d", PRFIELD(port_in_iter->wake_up_fd));
+	}
+
 end:
 	return;
 }
@@ -34,6 +34,10 @@ int bt_object_pool_initialize(struct bt_object_pool *pool,
 	pool->funcs.destroy_object = destroy_object_func;
 	pool->data = data;
 	pool->size = 0;
+	pool->max_size = SIZE_MAX;
+	pool->budget = NULL;
+	pool->object_size = 0;
+	pool->lock = false;
 	BT_LIB_LOGD("Initialized object pool: %!+o", pool);
 	goto end;
 
@@ -57,6 +61,7 @@ void bt_object_pool_finalize(struct bt_object_pool *pool)
 			void *obj = pool->objects->pdata[i];
 
 			if (obj) {
+				bt_object_pool_budget_give(pool);
 				pool->funcs.destroy_object(obj, pool->data);
 			}
 		}
@@ -65,3 +70,24 @@ void bt_object_pool_finalize(struct bt_object_pool *pool)
 		pool->objects = NULL;
 	}
 }
+
+void bt_object_pool_set_max_size(struct bt_object_pool *pool,
+		size_t max_size)
+{
+	BT_ASSERT(pool);
+	BT_ASSERT(pool->size == 0);
+	pool->max_size = max_size;
+	BT_LIB_LOGD("Set object pool's maximum size: %!+o", pool);
+}
+
+void bt_object_pool_set_budget(struct bt_object_pool *pool,
+		struct bt_object_pool_budget *budget, size_t object_size)
+{
+	BT_ASSERT(pool);
+	BT_ASSERT(budget);
+	BT_ASSERT(pool->size == 0);
+	pool->budget = budget;
+	pool->object_size = object_size;
+	BT_LIB_LOGD("Set object pool's memory budget: %!+o, "
+		"budget-addr=%p, obj-size=%zu", pool, budget, object_size);
+}
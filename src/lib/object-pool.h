@@ -33,6 +33,8 @@
  */
 
 #include <glib.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include "lib/object.h"
 
 /* Protection: this file uses BT_LIB_LOG*() macros directly */
@@ -43,6 +45,24 @@
 typedef void *(*bt_object_pool_new_object_func)(void *data);
 typedef void (*bt_object_pool_destroy_object_func)(void *obj, void *data);
 
+/*
+ * Memory budget which one or more object pools share: the total size
+ * of their recycled objects cannot exceed `max_size` bytes.
+ */
+struct bt_object_pool_budget {
+	/* Maximum total size (bytes); `UINT64_MAX` means no budget */
+	uint64_t max_size;
+
+	/* Current total size (bytes) of the recycled objects */
+	uint64_t size;
+
+	/*
+	 * Spin lock protecting `size` when bt_object_multithreaded is
+	 * true (see bt_object_spin_lock()).
+	 */
+	bool lock;
+};
+
 struct bt_object_pool {
 	/*
 	 * Container of recycled objects, owned by this. The array's size
@@ -56,6 +76,32 @@ struct bt_object_pool {
 	 */
 	size_t size;
 
+	/*
+	 * Maximum pool's size: when the pool is full, recycling an
+	 * object destroys it instead. `SIZE_MAX` means no maximum.
+	 */
+	size_t max_size;
+
+	/*
+	 * Memory budget which this pool shares with other pools, or
+	 * `NULL` if none, and size (bytes) which one recycled object of
+	 * this pool accounts for in it.
+	 */
+	struct bt_object_pool_budget *budget;
+	size_t object_size;
+
+	/* Statistics */
+	struct {
+		/* Number of objects allocated with the "new" user function */
+		uint64_t new_count;
+
+		/* Number of objects created from recycled objects */
+		uint64_t reuse_count;
+
+		/* Number of objects destroyed instead of being recycled */
+		uint64_t discard_count;
+	} stats;
+
 	/* User functions */
 	struct {
 		/* Allocate a new object in memory */
@@ -67,6 +113,12 @@ struct bt_object_pool {
 
 	/* User data passed to user functions */
 	void *data;
+
+	/*
+	 * Spin lock protecting `objects` and `size` when
+	 * bt_object_multithreaded is true (see bt_object_spin_lock()).
+	 */
+	bool lock;
 };
 
 /*
@@ -84,6 +136,76 @@ int bt_object_pool_initialize(struct bt_object_pool *pool,
 BT_HIDDEN
 void bt_object_pool_finalize(struct bt_object_pool *pool);
 
+/*
+ * Sets the maximum size of an object pool, that is, the maximum number
+ * of recycled objects it keeps.
+ */
+BT_HIDDEN
+void bt_object_pool_set_max_size(struct bt_object_pool *pool,
+		size_t max_size);
+
+/*
+ * Makes an object pool account for `object_size` bytes in the memory
+ * budget `budget` for each recycled object it keeps.
+ */
+BT_HIDDEN
+void bt_object_pool_set_budget(struct bt_object_pool *pool,
+		struct bt_object_pool_budget *budget, size_t object_size);
+
+/*
+ * Accounts for one recycled object of `pool` in its memory budget, if
+ * any, returning false if this would exceed the budget.
+ *
+ * `pool->lock` must be held.
+ */
+static inline
+bool bt_object_pool_budget_take(struct bt_object_pool *pool)
+{
+	struct bt_object_pool_budget *budget = pool->budget;
+	bool taken = true;
+	bool locked;
+
+	if (!budget) {
+		goto end;
+	}
+
+	locked = bt_object_spin_lock(&budget->lock);
+
+	if (budget->size > budget->max_size ||
+			pool->object_size > budget->max_size - budget->size) {
+		taken = false;
+	} else {
+		budget->size += pool->object_size;
+	}
+
+	bt_object_spin_unlock(&budget->lock, locked);
+
+end:
+	return taken;
+}
+
+/*
+ * Gives back the size of one recycled object of `pool` to its memory
+ * budget, if any.
+ *
+ * `pool->lock` must be held.
+ */
+static inline
+void bt_object_pool_budget_give(struct bt_object_pool *pool)
+{
+	struct bt_object_pool_budget *budget = pool->budget;
+	bool locked;
+
+	if (!budget) {
+		return;
+	}
+
+	locked = bt_object_spin_lock(&budget->lock);
+	BT_ASSERT_DBG(budget->size >= pool->object_size);
+	budget->size -= pool->object_size;
+	bt_object_spin_unlock(&budget->lock, locked);
+}
+
 /*
  * Creates an object from an object pool. If the pool is empty, this
  * function calls the "new" user function to allocate a new object
@@ -96,8 +218,10 @@ static inline
 void *bt_object_pool_create_object(struct bt_object_pool *pool)
 {
 	struct bt_object *obj;
+	bool locked;
 
 	BT_ASSERT_DBG(pool);
+	locked = bt_object_spin_lock(&pool->lock);
 	BT_LOGT("Creating object from pool: pool-addr=%p, pool-size=%zu, pool-cap=%u",
 		pool, pool->size, pool->objects->len);
 
@@ -106,10 +230,16 @@ void *bt_object_pool_create_object(struct bt_object_pool *pool)
 		pool->size--;
 		obj = pool->objects->pdata[pool->size];
 		pool->objects->pdata[pool->size] = NULL;
+		pool->stats.reuse_count++;
+		bt_object_pool_budget_give(pool);
+		bt_object_spin_unlock(&pool->lock, locked);
 		goto end;
 	}
 
-	/* Pool is empty: create a brand new object */
+	pool->stats.new_count++;
+	bt_object_spin_unlock(&pool->lock, locked);
+
+	/* Pool is empty: create a brand new object (outside the lock) */
 	BT_LOGD("Pool is empty: allocating new object: pool-addr=%p",
 		pool);
 	obj = pool->funcs.new_object(pool->data);
@@ -124,17 +254,39 @@ end:
  * Recycles an object, that is, puts it back into the pool.
  *
  * The pool becomes the sole owner of the object to recycle.
+ *
+ * If the pool is full, or if keeping the object would exceed the
+ * pool's memory budget, this function destroys the object with the
+ * "destroy" user function instead.
  */
 static inline
 void bt_object_pool_recycle_object(struct bt_object_pool *pool, void *obj)
 {
 	struct bt_object *bt_obj = obj;
+	bool locked;
 
 	BT_ASSERT_DBG(pool);
 	BT_ASSERT_DBG(obj);
+
+	/* Reset reference count to 1 since it could be 0 now */
+	bt_obj->ref_count = 1;
+
+	locked = bt_object_spin_lock(&pool->lock);
 	BT_LOGT("Recycling object: pool-addr=%p, pool-size=%zu, pool-cap=%u, obj-addr=%p",
 		pool, pool->size, pool->objects->len, obj);
 
+	if (G_UNLIKELY(pool->size >= pool->max_size ||
+			!bt_object_pool_budget_take(pool))) {
+		/* Don't keep it: destroy it (outside the lock) */
+		pool->stats.discard_count++;
+		bt_object_spin_unlock(&pool->lock, locked);
+		BT_LOGD("Object pool is full or out of budget: destroying object: "
+			"pool-addr=%p, pool-size=%zu, pool-max-size=%zu, obj-addr=%p",
+			pool, pool->size, pool->max_size, obj);
+		pool->funcs.destroy_object(obj, pool->data);
+		return;
+	}
+
 	if (pool->size == pool->objects->len) {
 		/* Backing array is full: make place for recycled object */
 		BT_LOGD("Object pool is full: increasing object pool capacity: "
@@ -143,14 +295,12 @@ void bt_object_pool_recycle_object(struct bt_object_pool *pool, void *obj)
 		g_ptr_array_set_size(pool->objects, pool->size + 1);
 	}
 
-	/* Reset reference count to 1 since it could be 0 now */
-	bt_obj->ref_count = 1;
-
 	/* Back to the pool */
 	pool->objects->pdata[pool->size] = obj;
 	pool->size++;
 	BT_LOGT("Recycled object: pool-addr=%p, pool-size=%zu, pool-cap=%u, obj-addr=%p",
 		pool, pool->size, pool->objects->len, obj);
+	bt_object_spin_unlock(&pool->lock, locked);
 }
 
 #endif /* BABELTRACE_OBJECT_POOL_INTERNAL_H */
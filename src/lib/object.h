@@ -14,6 +14,45 @@
 
 struct bt_object;
 
+/*
+ * True if library objects can be accessed concurrently by more than
+ * one thread, in which case reference counts are updated atomically
+ * and object pools are protected by a spin lock.
+ *
+ * This is false by default so that a single-threaded graph does not
+ * pay for atomic operations. Once set, it is never reset.
+ *
+ * Only read it with bt_object_is_multithreaded() and only set it with
+ * bt_object_set_multithreaded().
+ */
+BT_HIDDEN
+extern bool bt_object_multithreaded;
+
+static inline
+bool bt_object_is_multithreaded(void)
+{
+	return __atomic_load_n(&bt_object_multithreaded, __ATOMIC_RELAXED);
+}
+
+/*
+ * Makes library objects thread-safe for the rest of the process's
+ * lifetime.
+ *
+ * Call this before creating the first thread which shares objects with
+ * the current thread: as long as the flag is false, no object is
+ * accessed concurrently, so that switching cannot break an ongoing
+ * reference count update, and creating a thread orders this store
+ * before anything the new thread does.
+ */
+static inline
+void bt_object_set_multithreaded(void)
+{
+	if (!bt_object_is_multithreaded()) {
+		__atomic_store_n(&bt_object_multithreaded, true,
+			__ATOMIC_SEQ_CST);
+	}
+}
+
 typedef void (*bt_object_release_func)(struct bt_object *);
 typedef void (*bt_object_parent_is_owner_listener_func)(
 		struct bt_object *);
@@ -78,7 +117,42 @@ unsigned long long bt_object_get_ref_count(const struct bt_object *c_obj)
 
 	BT_ASSERT_DBG(obj);
 	BT_ASSERT_DBG(obj->is_shared);
-	return obj->ref_count;
+	return __atomic_load_n(&obj->ref_count, __ATOMIC_RELAXED);
+}
+
+/*
+ * Acquires the spin lock `*lock` if bt_object_multithreaded is true.
+ *
+ * Returns whether or not this function acquired the lock: pass this
+ * value to bt_object_spin_unlock() so that both functions agree even
+ * if bt_object_multithreaded becomes true in between.
+ *
+ * Only use this to protect very short critical sections.
+ */
+static inline
+bool bt_object_spin_lock(bool *lock)
+{
+	if (G_LIKELY(!bt_object_is_multithreaded())) {
+		return false;
+	}
+
+	while (__atomic_test_and_set(lock, __ATOMIC_ACQUIRE)) {
+		while (__atomic_load_n(lock, __ATOMIC_RELAXED)) {
+			/* Busy-wait without hammering the cache line */
+		}
+	}
+
+	return true;
+}
+
+static inline
+void bt_object_spin_unlock(bool *lock, bool locked)
+{
+	if (G_LIKELY(!locked)) {
+		return;
+	}
+
+	__atomic_clear(lock, __ATOMIC_RELEASE);
 }
 
 static inline
@@ -228,15 +302,46 @@ void bt_object_set_parent_is_owner_listener_func(struct bt_object *obj,
 	((struct bt_object *) obj)->parent_is_owner_listener_func = func;
 }
 
+/*
+ * Increments the reference count of `c_obj`, returning its value
+ * _before_ the increment.
+ */
 static inline
-void bt_object_inc_ref_count(const struct bt_object *c_obj)
+unsigned long long bt_object_inc_ref_count(const struct bt_object *c_obj)
 {
 	struct bt_object *obj = (void *) c_obj;
+	unsigned long long old_count;
 
 	BT_ASSERT_DBG(obj);
 	BT_ASSERT_DBG(obj->is_shared);
-	obj->ref_count++;
-	BT_ASSERT_DBG(obj->ref_count != 0);
+
+	if (G_UNLIKELY(bt_object_is_multithreaded())) {
+		old_count = __atomic_fetch_add(&obj->ref_count, 1,
+			__ATOMIC_RELAXED);
+	} else {
+		old_count = obj->ref_count++;
+	}
+
+	BT_ASSERT_DBG(old_count + 1 != 0);
+	return old_count;
+}
+
+/*
+ * Decrements the reference count of `obj`, returning its value
+ * _after_ the decrement.
+ */
+static inline
+unsigned long long bt_object_dec_ref_count(struct bt_object *obj)
+{
+	BT_ASSERT_DBG(obj);
+	BT_ASSERT_DBG(obj->is_shared);
+
+	if (G_UNLIKELY(bt_object_is_multithreaded())) {
+		return __atomic_sub_fetch(&obj->ref_count, 1,
+			__ATOMIC_ACQ_REL);
+	}
+
+	return --obj->ref_count;
 }
 
 static inline
@@ -265,15 +370,6 @@ void bt_object_get_ref_no_null_check(const void *c_obj)
 	BT_ASSERT_DBG(obj);
 	BT_ASSERT_DBG(obj->is_shared);
 
-	if (G_UNLIKELY(obj->parent && bt_object_get_ref_count(obj) == 0)) {
-#ifdef BT_LOGT
-		BT_LOGT("Incrementing object's parent's reference count: "
-			"addr=%p, parent-addr=%p", obj, obj->parent);
-#endif
-
-		bt_object_get_ref_no_null_check(obj->parent);
-	}
-
 #ifdef BT_LOGT
 	BT_LOGT("Incrementing object's reference count: %llu -> %llu: "
 		"addr=%p, cur-count=%llu, new-count=%llu",
@@ -281,7 +377,27 @@ void bt_object_get_ref_no_null_check(const void *c_obj)
 		obj, obj->ref_count, obj->ref_count + 1);
 #endif
 
-	bt_object_inc_ref_count(obj);
+	/*
+	 * Get the parent's reference only if this thread is the one
+	 * which brought the object's reference count from 0 to 1: with
+	 * atomic reference counts, checking the count before
+	 * incrementing it would be racy.
+	 *
+	 * This also covers a thread borrowing the object from its
+	 * parent while another thread puts its last reference: each
+	 * 0 to 1 transition gets exactly one parent reference and each
+	 * 1 to 0 transition puts exactly one, whatever their order, and
+	 * the parent, which the borrowing thread reaches the object
+	 * through, keeps it alive meanwhile.
+	 */
+	if (G_UNLIKELY(bt_object_inc_ref_count(obj) == 0 && obj->parent)) {
+#ifdef BT_LOGT
+		BT_LOGT("Incrementing object's parent's reference count: "
+			"addr=%p, parent-addr=%p", obj, obj->parent);
+#endif
+
+		bt_object_get_ref_no_null_check(obj->parent);
+	}
 }
 
 static inline
@@ -291,7 +407,7 @@ void bt_object_put_ref_no_null_check(const void *c_obj)
 
 	BT_ASSERT_DBG(obj);
 	BT_ASSERT_DBG(obj->is_shared);
-	BT_ASSERT_DBG(obj->ref_count > 0);
+	BT_ASSERT_DBG(bt_object_get_ref_count(obj) > 0);
 
 #ifdef BT_LOGT
 	BT_LOGT("Decrementing object's reference count: %llu -> %llu: "
@@ -300,9 +416,7 @@ void bt_object_put_ref_no_null_check(const void *c_obj)
 		obj, obj->ref_count, obj->ref_count - 1);
 #endif
 
-	obj->ref_count--;
-
-	if (obj->ref_count == 0) {
+	if (bt_object_dec_ref_count(obj) == 0) {
 		BT_ASSERT_DBG(obj->release_func);
 		obj->release_func(obj);
 	}
@@ -41,6 +41,17 @@ static inline void *bt_heap_maximum(const struct ptr_heap *heap)
 	return G_LIKELY(heap->len) ? heap->ptrs[0] : NULL;
 }
 
+/**
+ * bt_heap_clear - remove all the elements from the heap
+ * @heap: the heap to be operated on
+ *
+ * Empties the heap without freeing its elements nor its allocated memory.
+ */
+static inline void bt_heap_clear(struct ptr_heap *heap)
+{
+	heap->len = 0;
+}
+
 /**
  * bt_heap_init - initialize the heap
  * @heap: the heap to initialize
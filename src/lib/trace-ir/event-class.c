@@ -147,6 +147,9 @@ struct bt_event_class *create_event_class_with_id(
 		goto error;
 	}
 
+	bt_object_pool_set_max_size(&event_class->event_pool,
+		BT_EVENT_CLASS_EVENT_POOL_MAX_SIZE);
+
 	bt_object_set_parent(&event_class->base, &stream_class->base);
 	g_ptr_array_add(stream_class->event_classes, event_class);
 	bt_stream_class_freeze(stream_class);
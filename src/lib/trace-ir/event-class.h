@@ -25,6 +25,13 @@
 
 #include "trace.h"
 
+/*
+ * Maximum number of recycled events which the event pool of an event
+ * class keeps: beyond this, recycling an event destroys it so that a
+ * burst of events in flight doesn't keep its memory forever.
+ */
+#define BT_EVENT_CLASS_EVENT_POOL_MAX_SIZE	1024
+
 struct bt_event_class {
 	struct bt_object base;
 	struct bt_field_class *specific_context_fc;
@@ -9,12 +9,15 @@
 #include "lib/logging.h"
 
 #include "lib/assert-cond.h"
+#include "lib/func-status.h"
 #include <babeltrace2/trace-ir/event.h>
 #include <babeltrace2/trace-ir/event-class.h>
 #include <babeltrace2/trace-ir/stream-class.h>
 #include <babeltrace2/trace-ir/packet.h>
 #include <babeltrace2/trace-ir/trace.h>
+#include "common/align.h"
 #include "common/assert.h"
+#include "common/common.h"
 #include "compat/compiler.h"
 #include <inttypes.h>
 #include <stdbool.h>
@@ -63,46 +66,90 @@ void _bt_event_set_is_frozen(const struct bt_event *event, bool is_frozen)
 	}
 }
 
+/*
+ * Returns the size of the event structure within the memory block of
+ * an event, aligned for its field arena.
+ */
+static inline
+size_t event_struct_size(void)
+{
+	return ALIGN(sizeof(struct bt_event), BT_FIELD_ARENA_ALIGNMENT);
+}
+
 BT_HIDDEN
 struct bt_event *bt_event_new(struct bt_event_class *event_class)
 {
 	struct bt_event *event = NULL;
 	struct bt_stream_class *stream_class;
-	struct bt_field_class *fc;
+	struct bt_field_class *common_context_fc;
+	struct bt_field_class *specific_context_fc;
+	struct bt_field_class *payload_fc;
+	struct bt_field_arena arena;
+	size_t size;
 
 	BT_ASSERT(event_class);
-	event = g_new0(struct bt_event, 1);
+	stream_class = bt_event_class_borrow_stream_class(event_class);
+	BT_ASSERT(stream_class);
+	common_context_fc = stream_class->event_common_context_fc;
+	specific_context_fc = event_class->specific_context_fc;
+	payload_fc = event_class->payload_fc;
+
+	/*
+	 * Allocate the event and all its field trees as a single
+	 * memory block: the event structure, followed with the common
+	 * context, specific context, and payload fields.
+	 *
+	 * The event pool of the event class recycles this block as a
+	 * whole.
+	 */
+	size = event_struct_size();
+
+	if (common_context_fc) {
+		size += bt_field_class_get_field_tree_size(common_context_fc);
+	}
+
+	if (specific_context_fc) {
+		size += bt_field_class_get_field_tree_size(specific_context_fc);
+	}
+
+	if (payload_fc) {
+		size += bt_field_class_get_field_tree_size(payload_fc);
+	}
+
+	event = g_malloc0(size);
 	if (!event) {
-		BT_LIB_LOGE_APPEND_CAUSE("Failed to allocate one event.");
+		BT_LIB_LOGE_APPEND_CAUSE("Failed to allocate one event: "
+			"size=%zu", size);
 		goto error;
 	}
 
 	bt_object_init_unique(&event->base);
-	stream_class = bt_event_class_borrow_stream_class(event_class);
-	BT_ASSERT(stream_class);
-	fc = stream_class->event_common_context_fc;
-	if (fc) {
-		event->common_context_field = bt_field_create(fc);
+	arena.addr = (uint8_t *) event + event_struct_size();
+	arena.end = (uint8_t *) event + size;
+
+	if (common_context_fc) {
+		event->common_context_field = bt_field_create_in_arena(
+			common_context_fc, &arena);
 		if (!event->common_context_field) {
-			/* bt_field_create() logs errors */
+			/* bt_field_create_in_arena() logs errors */
 			goto error;
 		}
 	}
 
-	fc = event_class->specific_context_fc;
-	if (fc) {
-		event->specific_context_field = bt_field_create(fc);
+	if (specific_context_fc) {
+		event->specific_context_field = bt_field_create_in_arena(
+			specific_context_fc, &arena);
 		if (!event->specific_context_field) {
-			/* bt_field_create() logs errors */
+			/* bt_field_create_in_arena() logs errors */
 			goto error;
 		}
 	}
 
-	fc = event_class->payload_fc;
-	if (fc) {
-		event->payload_field = bt_field_create(fc);
+	if (payload_fc) {
+		event->payload_field = bt_field_create_in_arena(payload_fc,
+			&arena);
 		if (!event->payload_field) {
-			/* bt_field_create() logs errors */
+			/* bt_field_create_in_arena() logs errors */
 			goto error;
 		}
 	}
@@ -169,17 +216,88 @@ const struct bt_field *bt_event_borrow_specific_context_field_const(
 	return event->specific_context_field;
 }
 
+/*
+ * Fills the payload field of `event` if its filling is deferred (see
+ * bt_event_set_payload_field_materialize_func()).
+ */
+static
+void materialize_payload_field(struct bt_event *event)
+{
+	bt_event_payload_field_materialize_func func =
+		event->payload_materialization.func;
+	bt_event_payload_field_materialize_func_status status;
+
+	BT_ASSERT_DBG(event->payload_field);
+	BT_LIB_LOGD("Materializing event's payload field: %!+e", event);
+
+	/* Call the user function only once */
+	event->payload_materialization.func = NULL;
+
+	/* The event could already be frozen (message sent downstream) */
+	bt_field_set_is_frozen(event->payload_field, false);
+	status = func(event->payload_field,
+		event->payload_materialization.user_data);
+	BT_ASSERT_POST("bt_event_payload_field_materialize_func",
+		"valid-status",
+		status == BT_FUNC_STATUS_OK ||
+		status == BT_FUNC_STATUS_MEMORY_ERROR,
+		"Unexpected returned status: status=%s",
+		bt_common_func_status_string(status));
+	BT_ASSERT_POST_NO_ERROR_IF_NO_ERROR_STATUS(
+		"bt_event_payload_field_materialize_func", status);
+	bt_field_set_is_frozen(event->payload_field, event->frozen);
+	bt_event_reset_payload_materialization(event);
+
+	if (status != BT_FUNC_STATUS_OK) {
+		/*
+		 * The user function only fails when out of memory (it
+		 * validated the payload when it deferred its filling),
+		 * and the payload field borrowing functions cannot fail.
+		 */
+		BT_LIB_LOGF("Cannot materialize event's payload field: "
+			"%![event-]+e, status=%s", event,
+			bt_common_func_status_string(status));
+		bt_common_abort();
+	}
+}
+
 struct bt_field *bt_event_borrow_payload_field(struct bt_event *event)
 {
 	BT_ASSERT_PRE_DEV_EVENT_NON_NULL(event);
+
+	if (G_UNLIKELY(event->payload_materialization.func)) {
+		materialize_payload_field(event);
+	}
+
 	return event->payload_field;
 }
 
 const struct bt_field *bt_event_borrow_payload_field_const(
 		const struct bt_event *event)
 {
-	BT_ASSERT_PRE_DEV_EVENT_NON_NULL(event);
-	return event->payload_field;
+	return bt_event_borrow_payload_field((void *) event);
+}
+
+void bt_event_set_payload_field_materialize_func(struct bt_event *event,
+		bt_event_payload_field_materialize_func user_func,
+		bt_event_payload_field_materialize_data_destroy_func destroy_func,
+		void *user_data)
+{
+	BT_ASSERT_PRE_EVENT_NON_NULL(event);
+	BT_ASSERT_PRE_NON_NULL("user-function", user_func,
+		"User function");
+	BT_ASSERT_PRE_DEV_EVENT_HOT(event);
+	BT_ASSERT_PRE("event-class-has-payload-field-class",
+		event->payload_field,
+		"Event's class has no payload field class: %!+e", event);
+	BT_ASSERT_PRE("payload-field-materialization-not-deferred",
+		!event->payload_materialization.func,
+		"Event's payload field filling is already deferred: %!+e",
+		event);
+	event->payload_materialization.func = user_func;
+	event->payload_materialization.destroy_func = destroy_func;
+	event->payload_materialization.user_data = user_data;
+	BT_LIB_LOGD("Deferred event's payload field filling: %!+e", event);
 }
 
 BT_HIDDEN
@@ -200,6 +318,8 @@ void bt_event_destroy(struct bt_event *event)
 		event->specific_context_field = NULL;
 	}
 
+	bt_event_reset_payload_materialization(event);
+
 	if (event->payload_field) {
 		BT_LOGD_STR("Destroying event's payload field.");
 		bt_field_destroy(event->payload_field);
@@ -212,6 +332,8 @@ void bt_event_destroy(struct bt_event *event)
 	BT_OBJECT_PUT_REF_AND_RESET(event->packet);
 	BT_LOGD_STR("Putting event's stream.");
 	BT_OBJECT_PUT_REF_AND_RESET(event->stream);
+
+	/* Also frees the memory of the field trees (see bt_event_new()) */
 	g_free(event);
 }
 
@@ -20,6 +20,7 @@
 #include <babeltrace2/trace-ir/stream.h>
 #include <babeltrace2/trace-ir/packet.h>
 #include <babeltrace2/trace-ir/field.h>
+#include <babeltrace2/trace-ir/event.h>
 #include "lib/object.h"
 #include "common/assert.h"
 #include <glib.h>
@@ -32,8 +33,9 @@
 #include "stream.h"
 
 #define BT_ASSERT_PRE_DEV_EVENT_HOT(_event)				\
-	BT_ASSERT_PRE_DEV_HOT(((const struct bt_event *) (_event)), 	\
-		"Event", ": %!+e", (_event))
+	BT_ASSERT_PRE_DEV_HOT("event",					\
+		((const struct bt_event *) (_event)), "Event", ": %!+e",	\
+		(_event))
 
 struct bt_event {
 	struct bt_object base;
@@ -50,6 +52,18 @@ struct bt_event {
 	struct bt_field *common_context_field;
 	struct bt_field *specific_context_field;
 	struct bt_field *payload_field;
+
+	/*
+	 * Deferred filling of `payload_field` (see
+	 * bt_event_set_payload_field_materialize_func()): if `func` is
+	 * not `NULL`, then borrowing the payload field calls it first.
+	 */
+	struct {
+		bt_event_payload_field_materialize_func func;
+		bt_event_payload_field_materialize_data_destroy_func destroy_func;
+		void *user_data;
+	} payload_materialization;
+
 	bool frozen;
 };
 
@@ -100,12 +114,32 @@ void _bt_event_reset_dev_mode(struct bt_event *event)
 # define bt_event_reset_dev_mode(_x)
 #endif
 
+/*
+ * Cancels the deferred filling of the payload field of `event`, if
+ * any, destroying its user data.
+ */
+static inline
+void bt_event_reset_payload_materialization(struct bt_event *event)
+{
+	BT_ASSERT_DBG(event);
+
+	if (event->payload_materialization.destroy_func) {
+		event->payload_materialization.destroy_func(
+			event->payload_materialization.user_data);
+	}
+
+	event->payload_materialization.func = NULL;
+	event->payload_materialization.destroy_func = NULL;
+	event->payload_materialization.user_data = NULL;
+}
+
 static inline
 void bt_event_reset(struct bt_event *event)
 {
 	BT_ASSERT_DBG(event);
 	BT_LIB_LOGD("Resetting event: %!+e", event);
 	bt_event_set_is_frozen(event, false);
+	bt_event_reset_payload_materialization(event);
 	bt_object_put_ref_no_null_check(&event->stream->base);
 	event->stream = NULL;
 
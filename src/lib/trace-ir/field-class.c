@@ -16,6 +16,7 @@
 #include "compat/compiler.h"
 #include "compat/endian.h"
 #include "common/assert.h"
+#include "common/interval-index.h"
 #include "compat/glib.h"
 #include <float.h>
 #include <inttypes.h>
@@ -339,6 +340,8 @@ void destroy_enumeration_field_class(struct bt_object *obj)
 		fc->label_buf = NULL;
 	}
 
+	bt_interval_index_destroy(fc->mapping_index);
+	fc->mapping_index = NULL;
 	g_free(fc);
 }
 
@@ -521,78 +524,139 @@ bt_field_class_enumeration_signed_mapping_borrow_ranges_const(
 	return (const void *) mapping->range_set;
 }
 
-enum bt_field_class_enumeration_get_mapping_labels_for_value_status
-bt_field_class_enumeration_unsigned_get_mapping_labels_for_value(
-		const struct bt_field_class *fc, uint64_t value,
-		bt_field_class_enumeration_mapping_label_array *label_array,
-		uint64_t *count)
+/*
+ * Returns the interval index key of the lower (`upper` is false) or
+ * upper bound of `range` of `enum_fc`.
+ *
+ * Signed bounds become order-preserving unsigned keys (see
+ * bt_interval_index_signed_key()).
+ */
+static inline
+uint64_t enumeration_field_class_range_key(
+		const struct bt_field_class_enumeration *enum_fc,
+		const struct bt_integer_range *range, bool upper)
 {
-	const struct bt_field_class_enumeration *enum_fc = (const void *) fc;
+	if (enum_fc->common.common.type ==
+			BT_FIELD_CLASS_TYPE_SIGNED_ENUMERATION) {
+		return bt_interval_index_signed_key(
+			upper ? range->upper.i : range->lower.i);
+	}
+
+	return upper ? range->upper.u : range->lower.u;
+}
+
+/*
+ * Builds the mapping index of `enum_fc`.
+ */
+static
+int build_enumeration_field_class_mapping_index(
+		struct bt_field_class_enumeration *enum_fc)
+{
+	GArray *ranges;
 	uint64_t i;
+	int ret = 0;
 
-	BT_ASSERT_PRE_DEV_NO_ERROR();
-	BT_ASSERT_PRE_DEV_FC_NON_NULL(fc);
-	BT_ASSERT_PRE_DEV_NON_NULL("label-array-output", label_array,
-		"Label array (output)");
-	BT_ASSERT_PRE_DEV_NON_NULL("count-output", count, "Count (output)");
-	BT_ASSERT_PRE_DEV_FC_HAS_TYPE("field-class", fc, "unsigned-enumeration",
-		BT_FIELD_CLASS_TYPE_UNSIGNED_ENUMERATION, "Field class");
-	g_ptr_array_set_size(enum_fc->label_buf, 0);
+	BT_ASSERT(!enum_fc->mapping_index);
+	ranges = g_array_new(FALSE, FALSE,
+		sizeof(struct bt_interval_index_range));
+	if (!ranges) {
+		BT_LOGE_STR("Failed to allocate a GArray.");
+		ret = -1;
+		goto end;
+	}
 
 	for (i = 0; i < enum_fc->mappings->len; i++) {
-		uint64_t j;
 		const struct bt_field_class_enumeration_mapping *mapping =
 			BT_FIELD_CLASS_ENUM_MAPPING_AT_INDEX(enum_fc, i);
+		uint64_t j;
 
 		for (j = 0; j < mapping->range_set->ranges->len; j++) {
 			const struct bt_integer_range *range = (const void *)
 				BT_INTEGER_RANGE_SET_RANGE_AT_INDEX(
 					mapping->range_set, j);
-
-			if (value >= range->lower.u &&
-					value <= range->upper.u) {
-				g_ptr_array_add(enum_fc->label_buf,
-					mapping->label->str);
-				break;
-			}
+			struct bt_interval_index_range index_range = {
+				.lower = enumeration_field_class_range_key(
+					enum_fc, range, false),
+				.upper = enumeration_field_class_range_key(
+					enum_fc, range, true),
+				.item = i,
+			};
+
+			g_array_append_val(ranges, index_range);
 		}
 	}
 
-	*label_array = (void *) enum_fc->label_buf->pdata;
-	*count = (uint64_t) enum_fc->label_buf->len;
-	return BT_FUNC_STATUS_OK;
+	enum_fc->mapping_index = bt_interval_index_create(
+		(const void *) ranges->data, ranges->len);
+	g_array_free(ranges, TRUE);
+	if (!enum_fc->mapping_index) {
+		BT_LIB_LOGE("Failed to create the mapping index of an enumeration field class: "
+			"%!+F", enum_fc);
+		ret = -1;
+		goto end;
+	}
+
+	BT_LIB_LOGD("Built enumeration field class mapping index: "
+		"%![fc-]+F, segment-count=%" PRIu64, enum_fc,
+		enum_fc->mapping_index->segment_count);
+
+end:
+	return ret;
 }
 
+/*
+ * Sets `*label_array` and `*count` to the labels of the mappings of
+ * `enum_fc` of which the ranges contain `key`, in mapping order.
+ */
+static
 enum bt_field_class_enumeration_get_mapping_labels_for_value_status
-bt_field_class_enumeration_signed_get_mapping_labels_for_value(
-		const struct bt_field_class *fc, int64_t value,
+get_enumeration_field_class_mapping_labels_for_key(
+		const struct bt_field_class_enumeration *enum_fc, uint64_t key,
 		bt_field_class_enumeration_mapping_label_array *label_array,
 		uint64_t *count)
 {
-	const struct bt_field_class_enumeration *enum_fc = (const void *) fc;
 	uint64_t i;
 
-	BT_ASSERT_PRE_DEV_NO_ERROR();
-	BT_ASSERT_PRE_DEV_FC_NON_NULL(fc);
-	BT_ASSERT_PRE_DEV_NON_NULL("label-array-output", label_array,
-		"Label array (output)");
-	BT_ASSERT_PRE_DEV_NON_NULL("count-output", count, "Count (output)");
-	BT_ASSERT_PRE_DEV_FC_HAS_TYPE("field-class", fc, "signed-enumeration",
-		BT_FIELD_CLASS_TYPE_SIGNED_ENUMERATION, "Field class");
 	g_ptr_array_set_size(enum_fc->label_buf, 0);
 
+	if (G_LIKELY(enum_fc->mapping_index)) {
+		const uint64_t *mapping_indexes;
+		uint64_t mapping_count;
+
+		/*
+		 * Mapping indexes are sorted: this preserves the mapping
+		 * order.
+		 */
+		mapping_indexes = bt_interval_index_lookup(
+			enum_fc->mapping_index, key, &mapping_count);
+
+		for (i = 0; i < mapping_count; i++) {
+			const struct bt_field_class_enumeration_mapping *mapping =
+				BT_FIELD_CLASS_ENUM_MAPPING_AT_INDEX(enum_fc,
+					mapping_indexes[i]);
+
+			g_ptr_array_add(enum_fc->label_buf,
+				mapping->label->str);
+		}
+
+		goto end;
+	}
+
+	/* Not part of a trace class (no index): scan the mappings */
 	for (i = 0; i < enum_fc->mappings->len; i++) {
-		uint64_t j;
 		const struct bt_field_class_enumeration_mapping *mapping =
 			BT_FIELD_CLASS_ENUM_MAPPING_AT_INDEX(enum_fc, i);
+		uint64_t j;
 
 		for (j = 0; j < mapping->range_set->ranges->len; j++) {
 			const struct bt_integer_range *range = (const void *)
 				BT_INTEGER_RANGE_SET_RANGE_AT_INDEX(
 					mapping->range_set, j);
 
-			if (value >= range->lower.i &&
-					value <= range->upper.i) {
+			if (key >= enumeration_field_class_range_key(enum_fc,
+						range, false) &&
+					key <= enumeration_field_class_range_key(
+						enum_fc, range, true)) {
 				g_ptr_array_add(enum_fc->label_buf,
 					mapping->label->str);
 				break;
@@ -600,11 +664,47 @@ bt_field_class_enumeration_signed_get_mapping_labels_for_value(
 		}
 	}
 
+end:
 	*label_array = (void *) enum_fc->label_buf->pdata;
 	*count = (uint64_t) enum_fc->label_buf->len;
 	return BT_FUNC_STATUS_OK;
 }
 
+enum bt_field_class_enumeration_get_mapping_labels_for_value_status
+bt_field_class_enumeration_unsigned_get_mapping_labels_for_value(
+		const struct bt_field_class *fc, uint64_t value,
+		bt_field_class_enumeration_mapping_label_array *label_array,
+		uint64_t *count)
+{
+	BT_ASSERT_PRE_DEV_NO_ERROR();
+	BT_ASSERT_PRE_DEV_FC_NON_NULL(fc);
+	BT_ASSERT_PRE_DEV_NON_NULL("label-array-output", label_array,
+		"Label array (output)");
+	BT_ASSERT_PRE_DEV_NON_NULL("count-output", count, "Count (output)");
+	BT_ASSERT_PRE_DEV_FC_HAS_TYPE("field-class", fc, "unsigned-enumeration",
+		BT_FIELD_CLASS_TYPE_UNSIGNED_ENUMERATION, "Field class");
+	return get_enumeration_field_class_mapping_labels_for_key(
+		(const void *) fc, value, label_array, count);
+}
+
+enum bt_field_class_enumeration_get_mapping_labels_for_value_status
+bt_field_class_enumeration_signed_get_mapping_labels_for_value(
+		const struct bt_field_class *fc, int64_t value,
+		bt_field_class_enumeration_mapping_label_array *label_array,
+		uint64_t *count)
+{
+	BT_ASSERT_PRE_DEV_NO_ERROR();
+	BT_ASSERT_PRE_DEV_FC_NON_NULL(fc);
+	BT_ASSERT_PRE_DEV_NON_NULL("label-array-output", label_array,
+		"Label array (output)");
+	BT_ASSERT_PRE_DEV_NON_NULL("count-output", count, "Count (output)");
+	BT_ASSERT_PRE_DEV_FC_HAS_TYPE("field-class", fc, "signed-enumeration",
+		BT_FIELD_CLASS_TYPE_SIGNED_ENUMERATION, "Field class");
+	return get_enumeration_field_class_mapping_labels_for_key(
+		(const void *) fc, bt_interval_index_signed_key(value),
+		label_array, count);
+}
+
 static
 bool enumeration_field_class_has_mapping_with_label(
 		const struct bt_field_class_enumeration *enum_fc,
@@ -661,6 +761,7 @@ add_mapping_to_enumeration_field_class(struct bt_field_class *fc,
 	}
 
 	g_array_append_val(enum_fc->mappings, mapping);
+	bt_integer_range_set_freeze(range_set);
 	BT_LIB_LOGD("Added mapping to enumeration field class: "
 		"%![fc-]+F, label=\"%s\"", fc, label);
 
@@ -2228,7 +2329,23 @@ void bt_field_class_make_part_of_trace_class(const struct bt_field_class *c_fc)
 		struct bt_field_class_array *array_fc = (void *) fc;
 
 		bt_field_class_make_part_of_trace_class(array_fc->element_fc);
+	} else if (bt_field_class_type_is(fc->type,
+			BT_FIELD_CLASS_TYPE_ENUMERATION)) {
+		/*
+		 * The mappings cannot change anymore: index them now
+		 * rather than on the first label lookup, which can
+		 * happen on any thread.
+		 */
+		if (build_enumeration_field_class_mapping_index(
+				(void *) fc)) {
+			BT_LIB_LOGW("Cannot index enumeration field class's "
+				"mappings: falling back to linear lookups: "
+				"%!+F", fc);
+		}
 	}
+
+	/* The field tree sizes of the children are known at this point */
+	fc->field_tree_size = bt_field_class_compute_field_tree_size(fc);
 }
 
 const struct bt_value *bt_field_class_borrow_user_attributes_const(
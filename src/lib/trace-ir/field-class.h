@@ -13,6 +13,7 @@
 #include <babeltrace2/trace-ir/field-class.h>
 #include "common/macros.h"
 #include "common/common.h"
+#include "common/interval-index.h"
 #include "lib/object.h"
 #include <babeltrace2/types.h>
 #include <stdbool.h>
@@ -43,6 +44,13 @@ struct bt_field_class {
 	 * of a trace class.
 	 */
 	bool part_of_trace_class;
+
+	/*
+	 * Size of the memory block of a whole field tree of which this
+	 * is the root class, or 0 if this isn't part of a trace class
+	 * (see bt_field_class_get_field_tree_size()).
+	 */
+	size_t field_tree_size;
 };
 
 struct bt_field_class_bool {
@@ -96,6 +104,16 @@ struct bt_field_class_enumeration {
 	 * The actual strings are owned by the mappings above.
 	 */
 	GPtrArray *label_buf;
+
+	/*
+	 * Index of the ranges of the mappings above (items are mapping
+	 * indexes), making any label lookup O(log n), or `NULL`.
+	 *
+	 * bt_field_class_make_part_of_trace_class() builds it, as the
+	 * mappings cannot change anymore. Label lookups scan the
+	 * mappings when it's `NULL`.
+	 */
+	struct bt_interval_index *mapping_index;
 };
 
 struct bt_field_class_real {
@@ -250,6 +268,10 @@ void _bt_named_field_class_freeze(const struct bt_named_field_class *named_fc);
  * being part of a trace. This is used to validate that all field classes
  * are used at a single location within trace objects even if they are
  * shared objects for other purposes.
+ *
+ * This function also computes the field tree sizes of `field_class`
+ * and its children, which are frozen at this point, and indexes the
+ * mappings of enumeration field classes.
  */
 BT_HIDDEN
 void bt_field_class_make_part_of_trace_class(
@@ -135,34 +135,44 @@ struct bt_field_methods variant_field_methods = {
 };
 
 static
-struct bt_field *create_bool_field(struct bt_field_class *);
+struct bt_field *create_bool_field(struct bt_field_class *,
+		struct bt_field_arena *);
 
 static
-struct bt_field *create_bit_array_field(struct bt_field_class *);
+struct bt_field *create_bit_array_field(struct bt_field_class *,
+		struct bt_field_arena *);
 
 static
-struct bt_field *create_integer_field(struct bt_field_class *);
+struct bt_field *create_integer_field(struct bt_field_class *,
+		struct bt_field_arena *);
 
 static
-struct bt_field *create_real_field(struct bt_field_class *);
+struct bt_field *create_real_field(struct bt_field_class *,
+		struct bt_field_arena *);
 
 static
-struct bt_field *create_string_field(struct bt_field_class *);
+struct bt_field *create_string_field(struct bt_field_class *,
+		struct bt_field_arena *);
 
 static
-struct bt_field *create_structure_field(struct bt_field_class *);
+struct bt_field *create_structure_field(struct bt_field_class *,
+		struct bt_field_arena *);
 
 static
-struct bt_field *create_static_array_field(struct bt_field_class *);
+struct bt_field *create_static_array_field(struct bt_field_class *,
+		struct bt_field_arena *);
 
 static
-struct bt_field *create_dynamic_array_field(struct bt_field_class *);
+struct bt_field *create_dynamic_array_field(struct bt_field_class *,
+		struct bt_field_arena *);
 
 static
-struct bt_field *create_option_field(struct bt_field_class *);
+struct bt_field *create_option_field(struct bt_field_class *,
+		struct bt_field_arena *);
 
 static
-struct bt_field *create_variant_field(struct bt_field_class *);
+struct bt_field *create_variant_field(struct bt_field_class *,
+		struct bt_field_arena *);
 
 static
 void destroy_bool_field(struct bt_field *field);
@@ -210,53 +220,186 @@ enum bt_field_class_type bt_field_get_class_type(const struct bt_field *field)
 	return field->class->type;
 }
 
+/*
+ * Returns the size of the structure of a field of which the class is
+ * `fc`, aligned for the next field of a field arena.
+ */
+static
+size_t field_size(const struct bt_field_class *fc)
+{
+	size_t size;
+
+	switch (fc->type) {
+	case BT_FIELD_CLASS_TYPE_BOOL:
+		size = sizeof(struct bt_field_bool);
+		break;
+	case BT_FIELD_CLASS_TYPE_BIT_ARRAY:
+		size = sizeof(struct bt_field_bit_array);
+		break;
+	case BT_FIELD_CLASS_TYPE_UNSIGNED_INTEGER:
+	case BT_FIELD_CLASS_TYPE_SIGNED_INTEGER:
+	case BT_FIELD_CLASS_TYPE_UNSIGNED_ENUMERATION:
+	case BT_FIELD_CLASS_TYPE_SIGNED_ENUMERATION:
+		size = sizeof(struct bt_field_integer);
+		break;
+	case BT_FIELD_CLASS_TYPE_SINGLE_PRECISION_REAL:
+	case BT_FIELD_CLASS_TYPE_DOUBLE_PRECISION_REAL:
+		size = sizeof(struct bt_field_real);
+		break;
+	case BT_FIELD_CLASS_TYPE_STRING:
+		size = sizeof(struct bt_field_string);
+		break;
+	case BT_FIELD_CLASS_TYPE_STRUCTURE:
+		size = sizeof(struct bt_field_structure);
+		break;
+	case BT_FIELD_CLASS_TYPE_STATIC_ARRAY:
+	case BT_FIELD_CLASS_TYPE_DYNAMIC_ARRAY_WITHOUT_LENGTH_FIELD:
+	case BT_FIELD_CLASS_TYPE_DYNAMIC_ARRAY_WITH_LENGTH_FIELD:
+		size = sizeof(struct bt_field_array);
+		break;
+	case BT_FIELD_CLASS_TYPE_OPTION_WITHOUT_SELECTOR_FIELD:
+	case BT_FIELD_CLASS_TYPE_OPTION_WITH_BOOL_SELECTOR_FIELD:
+	case BT_FIELD_CLASS_TYPE_OPTION_WITH_UNSIGNED_INTEGER_SELECTOR_FIELD:
+	case BT_FIELD_CLASS_TYPE_OPTION_WITH_SIGNED_INTEGER_SELECTOR_FIELD:
+		size = sizeof(struct bt_field_option);
+		break;
+	case BT_FIELD_CLASS_TYPE_VARIANT_WITHOUT_SELECTOR_FIELD:
+	case BT_FIELD_CLASS_TYPE_VARIANT_WITH_UNSIGNED_INTEGER_SELECTOR_FIELD:
+	case BT_FIELD_CLASS_TYPE_VARIANT_WITH_SIGNED_INTEGER_SELECTOR_FIELD:
+		size = sizeof(struct bt_field_variant);
+		break;
+	default:
+		bt_common_abort();
+	}
+
+	return ALIGN(size, BT_FIELD_ARENA_ALIGNMENT);
+}
+
 BT_HIDDEN
-struct bt_field *bt_field_create(struct bt_field_class *fc)
+size_t bt_field_class_compute_field_tree_size(const struct bt_field_class *fc)
+{
+	size_t size;
+	uint64_t i;
+
+	BT_ASSERT(fc);
+
+	/*
+	 * Lay out the field tree like bt_field_create_in_arena()
+	 * creates it: a field, then its member, content, option, or
+	 * initial element fields, recursively.
+	 */
+	size = field_size(fc);
+
+	if (fc->type == BT_FIELD_CLASS_TYPE_STRUCTURE ||
+			bt_field_class_type_is(fc->type,
+				BT_FIELD_CLASS_TYPE_VARIANT)) {
+		const struct bt_field_class_named_field_class_container *container_fc =
+			(const void *) fc;
+
+		for (i = 0; i < container_fc->named_fcs->len; i++) {
+			const struct bt_named_field_class *named_fc =
+				container_fc->named_fcs->pdata[i];
+
+			size += bt_field_class_get_field_tree_size(
+				named_fc->fc);
+		}
+	} else if (bt_field_class_type_is(fc->type,
+			BT_FIELD_CLASS_TYPE_OPTION)) {
+		const struct bt_field_class_option *opt_fc = (const void *) fc;
+
+		size += bt_field_class_get_field_tree_size(opt_fc->content_fc);
+	} else if (fc->type == BT_FIELD_CLASS_TYPE_STATIC_ARRAY) {
+		const struct bt_field_class_array_static *array_fc =
+			(const void *) fc;
+
+		size += array_fc->length *
+			bt_field_class_get_field_tree_size(
+				array_fc->common.element_fc);
+	}
+
+	return size;
+}
+
+/*
+ * Allocates the `size`-byte structure of a field within `arena`, or on
+ * its own if `arena` is exhausted.
+ */
+static
+void *alloc_field(struct bt_field_arena *arena, size_t size)
+{
+	struct bt_field *field;
+
+	size = ALIGN(size, BT_FIELD_ARENA_ALIGNMENT);
+
+	if (G_LIKELY(size <= (size_t) (arena->end - arena->addr))) {
+		/* Arena memory is already zeroed */
+		field = (void *) arena->addr;
+		arena->addr += size;
+	} else {
+		BT_LOGD("Field arena is exhausted: allocating field on its own: "
+			"arena-addr=%p, arena-end=%p, size=%zu",
+			arena->addr, arena->end, size);
+		field = g_malloc0(size);
+		if (!field) {
+			goto end;
+		}
+
+		field->owns_memory = true;
+	}
+
+end:
+	return field;
+}
+
+BT_HIDDEN
+struct bt_field *bt_field_create_in_arena(struct bt_field_class *fc,
+		struct bt_field_arena *arena)
 {
 	struct bt_field *field = NULL;
 
 	BT_ASSERT(fc);
+	BT_ASSERT(arena);
 
 	switch (fc->type) {
 	case BT_FIELD_CLASS_TYPE_BOOL:
-		field = create_bool_field(fc);
+		field = create_bool_field(fc, arena);
 		break;
 	case BT_FIELD_CLASS_TYPE_BIT_ARRAY:
-		field = create_bit_array_field(fc);
+		field = create_bit_array_field(fc, arena);
 		break;
 	case BT_FIELD_CLASS_TYPE_UNSIGNED_INTEGER:
 	case BT_FIELD_CLASS_TYPE_SIGNED_INTEGER:
 	case BT_FIELD_CLASS_TYPE_UNSIGNED_ENUMERATION:
 	case BT_FIELD_CLASS_TYPE_SIGNED_ENUMERATION:
-		field = create_integer_field(fc);
+		field = create_integer_field(fc, arena);
 		break;
 	case BT_FIELD_CLASS_TYPE_SINGLE_PRECISION_REAL:
 	case BT_FIELD_CLASS_TYPE_DOUBLE_PRECISION_REAL:
-		field = create_real_field(fc);
+		field = create_real_field(fc, arena);
 		break;
 	case BT_FIELD_CLASS_TYPE_STRING:
-		field = create_string_field(fc);
+		field = create_string_field(fc, arena);
 		break;
 	case BT_FIELD_CLASS_TYPE_STRUCTURE:
-		field = create_structure_field(fc);
+		field = create_structure_field(fc, arena);
 		break;
 	case BT_FIELD_CLASS_TYPE_STATIC_ARRAY:
-		field = create_static_array_field(fc);
+		field = create_static_array_field(fc, arena);
 		break;
 	case BT_FIELD_CLASS_TYPE_DYNAMIC_ARRAY_WITHOUT_LENGTH_FIELD:
 	case BT_FIELD_CLASS_TYPE_DYNAMIC_ARRAY_WITH_LENGTH_FIELD:
-		field = create_dynamic_array_field(fc);
+		field = create_dynamic_array_field(fc, arena);
 		break;
 	case BT_FIELD_CLASS_TYPE_OPTION_WITHOUT_SELECTOR_FIELD:
 	case BT_FIELD_CLASS_TYPE_OPTION_WITH_BOOL_SELECTOR_FIELD:
 	case BT_FIELD_CLASS_TYPE_OPTION_WITH_UNSIGNED_INTEGER_SELECTOR_FIELD:
 	case BT_FIELD_CLASS_TYPE_OPTION_WITH_SIGNED_INTEGER_SELECTOR_FIELD:
-		field = create_option_field(fc);
+		field = create_option_field(fc, arena);
 		break;
 	case BT_FIELD_CLASS_TYPE_VARIANT_WITHOUT_SELECTOR_FIELD:
 	case BT_FIELD_CLASS_TYPE_VARIANT_WITH_UNSIGNED_INTEGER_SELECTOR_FIELD:
 	case BT_FIELD_CLASS_TYPE_VARIANT_WITH_SIGNED_INTEGER_SELECTOR_FIELD:
-		field = create_variant_field(fc);
+		field = create_variant_field(fc, arena);
 		break;
 	default:
 		bt_common_abort();
@@ -272,6 +415,43 @@ end:
 	return field;
 }
 
+BT_HIDDEN
+struct bt_field *bt_field_create(struct bt_field_class *fc)
+{
+	struct bt_field *field = NULL;
+	struct bt_field_arena arena;
+	size_t size;
+	void *block;
+
+	BT_ASSERT(fc);
+	size = bt_field_class_get_field_tree_size(fc);
+	block = g_malloc0(size);
+	if (!block) {
+		BT_LIB_LOGE_APPEND_CAUSE("Failed to allocate a field arena: "
+			"size=%zu, %![fc-]+F", size, fc);
+		goto end;
+	}
+
+	arena.addr = block;
+	arena.end = arena.addr + size;
+	field = bt_field_create_in_arena(fc, &arena);
+	if (!field) {
+		/* bt_field_create_in_arena() logs errors */
+		g_free(block);
+		goto end;
+	}
+
+	/*
+	 * The root field is at the beginning of the block: destroying
+	 * it frees the whole field tree.
+	 */
+	BT_ASSERT_DBG((void *) field == block);
+	field->owns_memory = true;
+
+end:
+	return field;
+}
+
 static inline
 void init_field(struct bt_field *field, struct bt_field_class *fc,
 		struct bt_field_methods *methods)
@@ -285,12 +465,13 @@ void init_field(struct bt_field *field, struct bt_field_class *fc,
 }
 
 static
-struct bt_field *create_bool_field(struct bt_field_class *fc)
+struct bt_field *create_bool_field(struct bt_field_class *fc,
+		struct bt_field_arena *arena)
 {
 	struct bt_field_bool *bool_field;
 
 	BT_LIB_LOGD("Creating boolean field object: %![fc-]+F", fc);
-	bool_field = g_new0(struct bt_field_bool, 1);
+	bool_field = alloc_field(arena, sizeof(struct bt_field_bool));
 	if (!bool_field) {
 		BT_LIB_LOGE_APPEND_CAUSE(
 			"Failed to allocate one boolean field.");
@@ -305,12 +486,13 @@ end:
 }
 
 static
-struct bt_field *create_bit_array_field(struct bt_field_class *fc)
+struct bt_field *create_bit_array_field(struct bt_field_class *fc,
+		struct bt_field_arena *arena)
 {
 	struct bt_field_bit_array *ba_field;
 
 	BT_LIB_LOGD("Creating bit array field object: %![fc-]+F", fc);
-	ba_field = g_new0(struct bt_field_bit_array, 1);
+	ba_field = alloc_field(arena, sizeof(struct bt_field_bit_array));
 	if (!ba_field) {
 		BT_LIB_LOGE_APPEND_CAUSE(
 			"Failed to allocate one bit array field.");
@@ -325,12 +507,13 @@ end:
 }
 
 static
-struct bt_field *create_integer_field(struct bt_field_class *fc)
+struct bt_field *create_integer_field(struct bt_field_class *fc,
+		struct bt_field_arena *arena)
 {
 	struct bt_field_integer *int_field;
 
 	BT_LIB_LOGD("Creating integer field object: %![fc-]+F", fc);
-	int_field = g_new0(struct bt_field_integer, 1);
+	int_field = alloc_field(arena, sizeof(struct bt_field_integer));
 	if (!int_field) {
 		BT_LIB_LOGE_APPEND_CAUSE(
 			"Failed to allocate one integer field.");
@@ -345,12 +528,13 @@ end:
 }
 
 static
-struct bt_field *create_real_field(struct bt_field_class *fc)
+struct bt_field *create_real_field(struct bt_field_class *fc,
+		struct bt_field_arena *arena)
 {
 	struct bt_field_real *real_field;
 
 	BT_LIB_LOGD("Creating real field object: %![fc-]+F", fc);
-	real_field = g_new0(struct bt_field_real, 1);
+	real_field = alloc_field(arena, sizeof(struct bt_field_real));
 	if (!real_field) {
 		BT_LIB_LOGE_APPEND_CAUSE("Failed to allocate one real field.");
 		goto end;
@@ -364,12 +548,13 @@ end:
 }
 
 static
-struct bt_field *create_string_field(struct bt_field_class *fc)
+struct bt_field *create_string_field(struct bt_field_class *fc,
+		struct bt_field_arena *arena)
 {
 	struct bt_field_string *string_field;
 
 	BT_LIB_LOGD("Creating string field object: %![fc-]+F", fc);
-	string_field = g_new0(struct bt_field_string, 1);
+	string_field = alloc_field(arena, sizeof(struct bt_field_string));
 	if (!string_field) {
 		BT_LIB_LOGE_APPEND_CAUSE(
 			"Failed to allocate one string field.");
@@ -396,7 +581,7 @@ end:
 static inline
 int create_fields_from_named_field_classes(
 		struct bt_field_class_named_field_class_container *fc,
-		GPtrArray **fields)
+		GPtrArray **fields, struct bt_field_arena *arena)
 {
 	int ret = 0;
 	uint64_t i;
@@ -415,7 +600,7 @@ int create_fields_from_named_field_classes(
 		struct bt_field *field;
 		struct bt_named_field_class *named_fc = fc->named_fcs->pdata[i];
 
-		field = bt_field_create(named_fc->fc);
+		field = bt_field_create_in_arena(named_fc->fc, arena);
 		if (!field) {
 			BT_LIB_LOGE_APPEND_CAUSE(
 				"Failed to create structure member or variant option field: "
@@ -433,12 +618,13 @@ end:
 }
 
 static
-struct bt_field *create_structure_field(struct bt_field_class *fc)
+struct bt_field *create_structure_field(struct bt_field_class *fc,
+		struct bt_field_arena *arena)
 {
 	struct bt_field_structure *struct_field;
 
 	BT_LIB_LOGD("Creating structure field object: %![fc-]+F", fc);
-	struct_field = g_new0(struct bt_field_structure, 1);
+	struct_field = alloc_field(arena, sizeof(struct bt_field_structure));
 	if (!struct_field) {
 		BT_LIB_LOGE_APPEND_CAUSE(
 			"Failed to allocate one structure field.");
@@ -448,7 +634,7 @@ struct bt_field *create_structure_field(struct bt_field_class *fc)
 	init_field((void *) struct_field, fc, &structure_field_methods);
 
 	if (create_fields_from_named_field_classes((void *) fc,
-			&struct_field->fields)) {
+			&struct_field->fields, arena)) {
 		BT_LIB_LOGE_APPEND_CAUSE(
 			"Cannot create structure member fields: %![fc-]+F", fc);
 		bt_field_destroy((void *) struct_field);
@@ -463,13 +649,14 @@ end:
 }
 
 static
-struct bt_field *create_option_field(struct bt_field_class *fc)
+struct bt_field *create_option_field(struct bt_field_class *fc,
+		struct bt_field_arena *arena)
 {
 	struct bt_field_option *opt_field;
 	struct bt_field_class_option *opt_fc = (void *) fc;
 
 	BT_LIB_LOGD("Creating option field object: %![fc-]+F", fc);
-	opt_field = g_new0(struct bt_field_option, 1);
+	opt_field = alloc_field(arena, sizeof(struct bt_field_option));
 	if (!opt_field) {
 		BT_LIB_LOGE_APPEND_CAUSE(
 			"Failed to allocate one option field.");
@@ -477,7 +664,8 @@ struct bt_field *create_option_field(struct bt_field_class *fc)
 	}
 
 	init_field((void *) opt_field, fc, &option_field_methods);
-	opt_field->content_field = bt_field_create(opt_fc->content_fc);
+	opt_field->content_field = bt_field_create_in_arena(
+		opt_fc->content_fc, arena);
 	if (!opt_field->content_field) {
 		BT_LIB_LOGE_APPEND_CAUSE(
 			"Failed to create option field's content field: "
@@ -495,12 +683,13 @@ end:
 }
 
 static
-struct bt_field *create_variant_field(struct bt_field_class *fc)
+struct bt_field *create_variant_field(struct bt_field_class *fc,
+		struct bt_field_arena *arena)
 {
 	struct bt_field_variant *var_field;
 
 	BT_LIB_LOGD("Creating variant field object: %![fc-]+F", fc);
-	var_field = g_new0(struct bt_field_variant, 1);
+	var_field = alloc_field(arena, sizeof(struct bt_field_variant));
 	if (!var_field) {
 		BT_LIB_LOGE_APPEND_CAUSE(
 			"Failed to allocate one variant field.");
@@ -510,7 +699,7 @@ struct bt_field *create_variant_field(struct bt_field_class *fc)
 	init_field((void *) var_field, fc, &variant_field_methods);
 
 	if (create_fields_from_named_field_classes((void *) fc,
-			&var_field->fields)) {
+			&var_field->fields, arena)) {
 		BT_LIB_LOGE_APPEND_CAUSE("Cannot create variant member fields: "
 			"%![fc-]+F", fc);
 		bt_field_destroy((void *) var_field);
@@ -525,10 +714,66 @@ end:
 }
 
 static inline
-int init_array_field_fields(struct bt_field_array *array_field)
+bool array_field_class_elements_can_be_packed(
+		const struct bt_field_class_array *array_fc)
+{
+	enum bt_field_class_type elem_type = array_fc->element_fc->type;
+
+	return bt_field_class_type_is(elem_type,
+			BT_FIELD_CLASS_TYPE_INTEGER) ||
+		bt_field_class_type_is(elem_type, BT_FIELD_CLASS_TYPE_REAL);
+}
+
+/*
+ * Makes sure that `array_field->fields` contains at least `length`
+ * element fields.
+ *
+ * Creates the new element fields within `arena` if it's not `NULL`, or
+ * each one within its own arena otherwise.
+ */
+static
+int create_array_field_element_fields(struct bt_field_array *array_field,
+		uint64_t length, struct bt_field_arena *arena)
 {
 	int ret = 0;
+	struct bt_field_class_array *array_fc;
+	uint64_t cur_len = array_field->fields->len;
 	uint64_t i;
+
+	if (G_LIKELY(length <= cur_len)) {
+		goto end;
+	}
+
+	array_fc = (void *) array_field->common.class;
+
+	for (i = cur_len; i < length; i++) {
+		struct bt_field *elem_field = arena ?
+			bt_field_create_in_arena(array_fc->element_fc, arena) :
+			bt_field_create(array_fc->element_fc);
+
+		if (!elem_field) {
+			BT_LIB_LOGE_APPEND_CAUSE(
+				"Cannot create array field's element field: "
+				"index=%" PRIu64 ", %![array-field-]+f",
+				i, array_field);
+			ret = -1;
+			goto end;
+		}
+
+		/* The array field could already be frozen */
+		elem_field->frozen = array_field->common.frozen;
+		g_ptr_array_add(array_field->fields, elem_field);
+	}
+
+end:
+	return ret;
+}
+
+static inline
+int init_array_field_fields(struct bt_field_array *array_field,
+		struct bt_field_arena *arena)
+{
+	int ret = 0;
 	struct bt_field_class_array *array_fc;
 
 	BT_ASSERT(array_field);
@@ -542,32 +787,42 @@ int init_array_field_fields(struct bt_field_array *array_field)
 
 	g_ptr_array_set_free_func(array_field->fields,
 		(GDestroyNotify) bt_field_destroy);
-	g_ptr_array_set_size(array_field->fields, array_field->length);
 
-	for (i = 0; i < array_field->length; i++) {
-		array_field->fields->pdata[i] = bt_field_create(
-			array_fc->element_fc);
-		if (!array_field->fields->pdata[i]) {
-			BT_LIB_LOGE_APPEND_CAUSE(
-				"Cannot create array field's element field: "
-				"index=%" PRIu64 ", %![fc-]+F", i, array_fc);
+	if (array_field_class_elements_can_be_packed(array_fc)) {
+		array_field->values = g_array_sized_new(FALSE, TRUE,
+			sizeof(union bt_field_array_element_value),
+			array_field->length);
+		if (!array_field->values) {
+			BT_LIB_LOGE_APPEND_CAUSE("Failed to allocate a GArray.");
 			ret = -1;
 			goto end;
 		}
+
+		g_array_set_size(array_field->values, array_field->length);
+		array_field->values_are_packed = true;
 	}
 
+	/*
+	 * Also create the element fields now, even with packed values,
+	 * so that unpacking the values never needs to allocate (see
+	 * borrow_array_field_element_field_by_index()).
+	 */
+	ret = create_array_field_element_fields(array_field,
+		array_field->length, arena);
+
 end:
 	return ret;
 }
 
 static
-struct bt_field *create_static_array_field(struct bt_field_class *fc)
+struct bt_field *create_static_array_field(struct bt_field_class *fc,
+		struct bt_field_arena *arena)
 {
 	struct bt_field_class_array_static *array_fc = (void *) fc;
 	struct bt_field_array *array_field;
 
 	BT_LIB_LOGD("Creating static array field object: %![fc-]+F", fc);
-	array_field = g_new0(struct bt_field_array, 1);
+	array_field = alloc_field(arena, sizeof(struct bt_field_array));
 	if (!array_field) {
 		BT_LIB_LOGE_APPEND_CAUSE(
 			"Failed to allocate one static array field.");
@@ -577,7 +832,7 @@ struct bt_field *create_static_array_field(struct bt_field_class *fc)
 	init_field((void *) array_field, fc, &array_field_methods);
 	array_field->length = array_fc->length;
 
-	if (init_array_field_fields(array_field)) {
+	if (init_array_field_fields(array_field, arena)) {
 		BT_LIB_LOGE_APPEND_CAUSE("Cannot create static array fields: "
 			"%![fc-]+F", fc);
 		bt_field_destroy((void *) array_field);
@@ -592,12 +847,13 @@ end:
 }
 
 static
-struct bt_field *create_dynamic_array_field(struct bt_field_class *fc)
+struct bt_field *create_dynamic_array_field(struct bt_field_class *fc,
+		struct bt_field_arena *arena)
 {
 	struct bt_field_array *array_field;
 
 	BT_LIB_LOGD("Creating dynamic array field object: %![fc-]+F", fc);
-	array_field = g_new0(struct bt_field_array, 1);
+	array_field = alloc_field(arena, sizeof(struct bt_field_array));
 	if (!array_field) {
 		BT_LIB_LOGE_APPEND_CAUSE(
 			"Failed to allocate one dynamic array field.");
@@ -606,7 +862,7 @@ struct bt_field *create_dynamic_array_field(struct bt_field_class *fc)
 
 	init_field((void *) array_field, fc, &array_field_methods);
 
-	if (init_array_field_fields(array_field)) {
+	if (init_array_field_fields(array_field, arena)) {
 		BT_LIB_LOGE_APPEND_CAUSE("Cannot create dynamic array fields: "
 			"%![fc-]+F", fc);
 		bt_field_destroy((void *) array_field);
@@ -960,31 +1216,23 @@ enum bt_field_array_dynamic_set_length_status bt_field_array_dynamic_set_length(
 	BT_ASSERT_PRE_DEV_FIELD_IS_DYNAMIC_ARRAY("field", field, "Field");
 	BT_ASSERT_PRE_DEV_FIELD_HOT(field);
 
+	if (array_field->values &&
+			G_UNLIKELY(length > array_field->values->len)) {
+		/* Make more room for the packed values */
+		g_array_set_size(array_field->values, length);
+	}
+
 	if (G_UNLIKELY(length > array_field->fields->len)) {
 		/* Make more room */
-		struct bt_field_class_array *array_fc;
-		uint64_t cur_len = array_field->fields->len;
-		uint64_t i;
-
-		g_ptr_array_set_size(array_field->fields, length);
-		array_fc = (void *) field->class;
-
-		for (i = cur_len; i < array_field->fields->len; i++) {
-			struct bt_field *elem_field = bt_field_create(
-				array_fc->element_fc);
-
-			if (!elem_field) {
-				BT_LIB_LOGE_APPEND_CAUSE(
-					"Cannot create element field for "
-					"dynamic array field: "
-					"index=%" PRIu64 ", "
-					"%![array-field-]+f", i, field);
-				ret = BT_FUNC_STATUS_MEMORY_ERROR;
-				goto end;
-			}
-
-			BT_ASSERT_DBG(!array_field->fields->pdata[i]);
-			array_field->fields->pdata[i] = elem_field;
+		if (create_array_field_element_fields(array_field, length,
+				NULL)) {
+			BT_LIB_LOGE_APPEND_CAUSE(
+				"Cannot create element fields for "
+				"dynamic array field: "
+				"length=%" PRIu64 ", %![array-field-]+f",
+				length, field);
+			ret = BT_FUNC_STATUS_MEMORY_ERROR;
+			goto end;
 		}
 	}
 
@@ -994,6 +1242,88 @@ end:
 	return ret;
 }
 
+/*
+ * Copies the packed values of `array_field` to its element fields.
+ */
+static
+void unpack_array_field_values(struct bt_field_array *array_field)
+{
+	struct bt_field_class_array *array_fc =
+		(void *) array_field->common.class;
+	bool elem_is_real = bt_field_class_type_is(array_fc->element_fc->type,
+		BT_FIELD_CLASS_TYPE_REAL);
+	uint64_t i;
+
+	BT_ASSERT_DBG(array_field->values);
+	BT_ASSERT_DBG(array_field->values_are_packed);
+	BT_ASSERT_DBG(array_field->fields->len >= array_field->length);
+
+	if (!array_field->packed_values_are_set) {
+		goto done;
+	}
+
+	for (i = 0; i < array_field->length; i++) {
+		struct bt_field *elem_field = array_field->fields->pdata[i];
+		const union bt_field_array_element_value *value =
+			&g_array_index(array_field->values,
+				union bt_field_array_element_value, i);
+
+		if (elem_is_real) {
+			struct bt_field_real *real_field = (void *) elem_field;
+
+			real_field->value = value->d;
+		} else {
+			struct bt_field_integer *int_field =
+				(void *) elem_field;
+
+			int_field->value.u = value->u;
+		}
+
+		bt_field_set_single(elem_field, true);
+	}
+
+done:
+	array_field->values_are_packed = false;
+}
+
+/*
+ * Copies the values of the element fields of `array_field` to its
+ * packed values.
+ */
+static
+void pack_array_field_values(struct bt_field_array *array_field)
+{
+	struct bt_field_class_array *array_fc =
+		(void *) array_field->common.class;
+	bool elem_is_real = bt_field_class_type_is(array_fc->element_fc->type,
+		BT_FIELD_CLASS_TYPE_REAL);
+	uint64_t i;
+
+	BT_ASSERT_DBG(array_field->values);
+	BT_ASSERT_DBG(!array_field->values_are_packed);
+	BT_ASSERT_DBG(array_field->fields->len >= array_field->length);
+
+	for (i = 0; i < array_field->length; i++) {
+		const struct bt_field *elem_field =
+			array_field->fields->pdata[i];
+		union bt_field_array_element_value *value =
+			&g_array_index(array_field->values,
+				union bt_field_array_element_value, i);
+
+		if (elem_is_real) {
+			const struct bt_field_real *real_field =
+				(const void *) elem_field;
+
+			value->d = real_field->value;
+		} else {
+			const struct bt_field_integer *int_field =
+				(const void *) elem_field;
+
+			value->u = int_field->value.u;
+		}
+	}
+}
+
 static inline
 struct bt_field *borrow_array_field_element_field_by_index(
 		struct bt_field *field, uint64_t index)
@@ -1003,6 +1333,12 @@ struct bt_field *borrow_array_field_element_field_by_index(
 	BT_ASSERT_PRE_DEV_FIELD_NON_NULL(field);
 	BT_ASSERT_PRE_DEV_FIELD_IS_ARRAY("field", field, "Field");
 	BT_ASSERT_PRE_DEV_VALID_INDEX(index, array_field->length);
+
+	if (G_UNLIKELY(array_field->values_are_packed)) {
+		/* From now on, the element fields are up to date */
+		unpack_array_field_values(array_field);
+	}
+
 	return array_field->fields->pdata[index];
 }
 
@@ -1019,6 +1355,125 @@ bt_field_array_borrow_element_field_by_index_const(
 	return borrow_array_field_element_field_by_index((void *) field, index);
 }
 
+static inline
+void set_array_field_element_values(struct bt_field *field,
+		const void *values)
+{
+	struct bt_field_array *array_field = (void *) field;
+
+	BT_ASSERT_DBG(array_field->values);
+	BT_ASSERT_DBG(array_field->values->len >= array_field->length);
+
+	if (array_field->length > 0) {
+		memcpy(array_field->values->data, values,
+			array_field->length *
+				sizeof(union bt_field_array_element_value));
+	}
+
+	/* Any element field is now out of date */
+	array_field->values_are_packed = true;
+	array_field->packed_values_are_set = true;
+}
+
+void bt_field_array_set_unsigned_integer_element_values(
+		struct bt_field *field, const uint64_t *values)
+{
+	BT_ASSERT_PRE_DEV_FIELD_NON_NULL(field);
+	BT_ASSERT_PRE_DEV_FIELD_IS_ARRAY("field", field, "Field");
+	BT_ASSERT_PRE_DEV_FIELD_IS_UNSIGNED_INT_ARRAY("field", field, "Field");
+	BT_ASSERT_PRE_DEV_FIELD_HOT(field);
+	BT_ASSERT_PRE_DEV_ARRAY_FIELD_ELEMENT_VALUES_NON_NULL(field, values);
+	set_array_field_element_values(field, values);
+}
+
+void bt_field_array_set_signed_integer_element_values(
+		struct bt_field *field, const int64_t *values)
+{
+	BT_ASSERT_PRE_DEV_FIELD_NON_NULL(field);
+	BT_ASSERT_PRE_DEV_FIELD_IS_ARRAY("field", field, "Field");
+	BT_ASSERT_PRE_DEV_FIELD_IS_SIGNED_INT_ARRAY("field", field, "Field");
+	BT_ASSERT_PRE_DEV_FIELD_HOT(field);
+	BT_ASSERT_PRE_DEV_ARRAY_FIELD_ELEMENT_VALUES_NON_NULL(field, values);
+	set_array_field_element_values(field, values);
+}
+
+void bt_field_array_set_real_element_values(struct bt_field *field,
+		const double *values)
+{
+	struct bt_field_array *array_field = (void *) field;
+	struct bt_field_class_array *array_fc;
+
+	BT_ASSERT_PRE_DEV_FIELD_NON_NULL(field);
+	BT_ASSERT_PRE_DEV_FIELD_IS_ARRAY("field", field, "Field");
+	BT_ASSERT_PRE_DEV_FIELD_IS_REAL_ARRAY("field", field, "Field");
+	BT_ASSERT_PRE_DEV_FIELD_HOT(field);
+	BT_ASSERT_PRE_DEV_ARRAY_FIELD_ELEMENT_VALUES_NON_NULL(field, values);
+	set_array_field_element_values(field, values);
+	array_fc = (void *) field->class;
+
+	if (array_fc->element_fc->type ==
+			BT_FIELD_CLASS_TYPE_SINGLE_PRECISION_REAL) {
+		uint64_t i;
+
+		/* Like bt_field_real_single_precision_set_value() */
+		for (i = 0; i < array_field->length; i++) {
+			union bt_field_array_element_value *value =
+				&g_array_index(array_field->values,
+					union bt_field_array_element_value, i);
+
+			value->d = (double) (float) value->d;
+		}
+	}
+}
+
+static inline
+const void *borrow_array_field_element_values(const struct bt_field *field)
+{
+	struct bt_field_array *array_field = (void *) field;
+
+	BT_ASSERT_DBG(array_field->values);
+
+	if (!array_field->values_are_packed) {
+		/*
+		 * Keep the element fields as the current ones: the user
+		 * could have borrowed some of them.
+		 */
+		pack_array_field_values(array_field);
+	}
+
+	return array_field->values->data;
+}
+
+const uint64_t *bt_field_array_borrow_unsigned_integer_element_values_const(
+		const struct bt_field *field)
+{
+	BT_ASSERT_PRE_DEV_FIELD_NON_NULL(field);
+	BT_ASSERT_PRE_DEV_FIELD_IS_ARRAY("field", field, "Field");
+	BT_ASSERT_PRE_DEV_FIELD_IS_UNSIGNED_INT_ARRAY("field", field, "Field");
+	BT_ASSERT_PRE_DEV_FIELD_IS_SET("field", field);
+	return borrow_array_field_element_values(field);
+}
+
+const int64_t *bt_field_array_borrow_signed_integer_element_values_const(
+		const struct bt_field *field)
+{
+	BT_ASSERT_PRE_DEV_FIELD_NON_NULL(field);
+	BT_ASSERT_PRE_DEV_FIELD_IS_ARRAY("field", field, "Field");
+	BT_ASSERT_PRE_DEV_FIELD_IS_SIGNED_INT_ARRAY("field", field, "Field");
+	BT_ASSERT_PRE_DEV_FIELD_IS_SET("field", field);
+	return borrow_array_field_element_values(field);
+}
+
+const double *bt_field_array_borrow_real_element_values_const(
+		const struct bt_field *field)
+{
+	BT_ASSERT_PRE_DEV_FIELD_NON_NULL(field);
+	BT_ASSERT_PRE_DEV_FIELD_IS_ARRAY("field", field, "Field");
+	BT_ASSERT_PRE_DEV_FIELD_IS_REAL_ARRAY("field", field, "Field");
+	BT_ASSERT_PRE_DEV_FIELD_IS_SET("field", field);
+	return borrow_array_field_element_values(field);
+}
+
 static inline
 struct bt_field *borrow_structure_field_member_field_by_index(
 		struct bt_field *field, uint64_t index)
@@ -1253,7 +1708,6 @@ void destroy_bool_field(struct bt_field *field)
 	BT_ASSERT(field);
 	BT_LIB_LOGD("Destroying boolean field object: %!+f", field);
 	bt_field_finalize(field);
-	g_free(field);
 }
 
 static
@@ -1262,7 +1716,6 @@ void destroy_bit_array_field(struct bt_field *field)
 	BT_ASSERT(field);
 	BT_LIB_LOGD("Destroying bit array field object: %!+f", field);
 	bt_field_finalize(field);
-	g_free(field);
 }
 
 static
@@ -1271,7 +1724,6 @@ void destroy_integer_field(struct bt_field *field)
 	BT_ASSERT(field);
 	BT_LIB_LOGD("Destroying integer field object: %!+f", field);
 	bt_field_finalize(field);
-	g_free(field);
 }
 
 static
@@ -1280,7 +1732,6 @@ void destroy_real_field(struct bt_field *field)
 	BT_ASSERT(field);
 	BT_LIB_LOGD("Destroying real field object: %!+f", field);
 	bt_field_finalize(field);
-	g_free(field);
 }
 
 static
@@ -1296,8 +1747,6 @@ void destroy_structure_field(struct bt_field *field)
 		g_ptr_array_free(struct_field->fields, TRUE);
 		struct_field->fields = NULL;
 	}
-
-	g_free(field);
 }
 
 static
@@ -1312,8 +1761,6 @@ void destroy_option_field(struct bt_field *field)
 	if (opt_field->content_field) {
 		bt_field_destroy(opt_field->content_field);
 	}
-
-	g_free(field);
 }
 
 static
@@ -1329,8 +1776,6 @@ void destroy_variant_field(struct bt_field *field)
 		g_ptr_array_free(var_field->fields, TRUE);
 		var_field->fields = NULL;
 	}
-
-	g_free(field);
 }
 
 static
@@ -1347,7 +1792,10 @@ void destroy_array_field(struct bt_field *field)
 		array_field->fields = NULL;
 	}
 
-	g_free(field);
+	if (array_field->values) {
+		g_array_free(array_field->values, TRUE);
+		array_field->values = NULL;
+	}
 }
 
 static
@@ -1363,8 +1811,6 @@ void destroy_string_field(struct bt_field *field)
 		g_array_free(string_field->buf, TRUE);
 		string_field->buf = NULL;
 	}
-
-	g_free(field);
 }
 
 BT_HIDDEN
@@ -1414,6 +1860,10 @@ void bt_field_destroy(struct bt_field *field)
 	default:
 		bt_common_abort();
 	}
+
+	if (field->owns_memory) {
+		g_free(field);
+	}
 }
 
 static
@@ -1470,6 +1920,12 @@ void reset_array_field(struct bt_field *field)
 	for (i = 0; i < array_field->fields->len; i++) {
 		bt_field_reset(array_field->fields->pdata[i]);
 	}
+
+	if (array_field->values) {
+		/* All the element values are unset: no need to unpack */
+		array_field->values_are_packed = true;
+		array_field->packed_values_are_set = false;
+	}
 }
 
 static
@@ -1629,6 +2085,12 @@ bool array_field_is_set(const struct bt_field *field)
 
 	BT_ASSERT_DBG(field);
 
+	if (array_field->values_are_packed) {
+		is_set = array_field->length == 0 ||
+			array_field->packed_values_are_set;
+		goto end;
+	}
+
 	for (i = 0; i < array_field->length; i++) {
 		is_set = bt_field_is_set(array_field->fields->pdata[i]);
 		if (!is_set) {
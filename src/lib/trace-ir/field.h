@@ -46,6 +46,16 @@ struct bt_field {
 
 	bool is_set;
 	bool frozen;
+
+	/*
+	 * True if destroying this field frees its memory, that is, if
+	 * it's the root field of a field arena or if it was allocated
+	 * on its own (see bt_field_create()).
+	 *
+	 * Otherwise, this field lives within the memory block of some
+	 * other object (root field or event).
+	 */
+	bool owns_memory;
 };
 
 struct bt_field_bool {
@@ -102,12 +112,48 @@ struct bt_field_variant {
 	GPtrArray *fields;
 };
 
+/*
+ * Value of an element of an array field of which the element field
+ * class is an integer or a real field class (see
+ * `struct bt_field_array`).
+ */
+union bt_field_array_element_value {
+	uint64_t u;
+	int64_t i;
+	double d;
+};
+
 struct bt_field_array {
 	struct bt_field common;
 
-	/* Array of `struct bt_field *`, owned by this */
+	/*
+	 * Array of `struct bt_field *`, owned by this.
+	 *
+	 * Its length is always at least `length`, even if `values`
+	 * isn't `NULL`, so that unpacking never allocates.
+	 */
 	GPtrArray *fields;
 
+	/*
+	 * Array of `union bt_field_array_element_value`, owned by this,
+	 * if the element field class is an integer or a real field
+	 * class, or `NULL` otherwise.
+	 *
+	 * This makes it possible to set and get the values of all the
+	 * elements at once without creating one element field object
+	 * per element.
+	 */
+	GArray *values;
+
+	/*
+	 * True if `values` contains the current element values, that
+	 * is, if the element fields of `fields` are out of date.
+	 */
+	bool values_are_packed;
+
+	/* True if the values of `values` were set */
+	bool packed_values_are_set;
+
 	/* Current effective length */
 	uint64_t length;
 };
@@ -164,6 +210,73 @@ end:
 	return is_set;
 }
 
+/* Alignment of each field structure within a field arena */
+#define BT_FIELD_ARENA_ALIGNMENT	8
+
+/*
+ * Zeroed contiguous memory block in which bt_field_create_in_arena()
+ * places the structures of the fields of a field tree, one after the
+ * other.
+ *
+ * Use bt_field_class_get_field_tree_size() to get the size of the block
+ * to allocate for a given root field class.
+ */
+struct bt_field_arena {
+	/* Next available byte */
+	uint8_t *addr;
+
+	/* End of the block */
+	uint8_t *end;
+};
+
+/*
+ * Computes the size of the memory block which contains a whole field
+ * tree of which the root field class is `fc`, a multiple of
+ * `BT_FIELD_ARENA_ALIGNMENT`.
+ *
+ * bt_field_class_make_part_of_trace_class() computes and saves this
+ * size once the field class is frozen.
+ */
+BT_HIDDEN
+size_t bt_field_class_compute_field_tree_size(const struct bt_field_class *fc);
+
+/*
+ * Returns the size of the memory block which contains a whole field
+ * tree of which the root field class is `fc`.
+ *
+ * The size of a field class which isn't part of a trace class (for
+ * example, the content field class of an option field class) is not
+ * saved: this function computes it again, without modifying `fc`, so
+ * that it's safe to call from any thread.
+ */
+static inline
+size_t bt_field_class_get_field_tree_size(const struct bt_field_class *fc)
+{
+	BT_ASSERT_DBG(fc);
+
+	if (G_LIKELY(fc->field_tree_size > 0)) {
+		return fc->field_tree_size;
+	}
+
+	return bt_field_class_compute_field_tree_size(fc);
+}
+
+/*
+ * Creates a field tree of which the root field class is `fc` within
+ * `arena`, advancing it.
+ *
+ * The returned field doesn't own its memory: the arena owner must free
+ * the memory block after destroying the field with bt_field_destroy().
+ */
+BT_HIDDEN
+struct bt_field *bt_field_create_in_arena(struct bt_field_class *fc,
+		struct bt_field_arena *arena);
+
+/*
+ * Creates a field tree of which the root field class is `class` within
+ * its own field arena: the returned field owns the memory of the whole
+ * tree.
+ */
 BT_HIDDEN
 struct bt_field *bt_field_create(struct bt_field_class *class);
 
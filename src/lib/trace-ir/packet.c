@@ -16,6 +16,7 @@
 #include "common/assert.h"
 #include <inttypes.h>
 #include <stdbool.h>
+#include <string.h>
 
 #include "field.h"
 #include "field-wrapper.h"
@@ -49,6 +50,50 @@ const struct bt_field *bt_packet_borrow_context_field_const(
 	return bt_packet_borrow_context_field((void *) packet);
 }
 
+void bt_packet_set_raw_data(struct bt_packet *packet, const char *format,
+		void *raw_data, bt_packet_raw_data_destroy_func destroy_func)
+{
+	BT_ASSERT_PRE_PACKET_NON_NULL(packet);
+	BT_ASSERT_PRE_NON_NULL("format", format, "Format");
+	BT_ASSERT_PRE_NON_NULL("raw-data", raw_data, "Raw data");
+	BT_ASSERT_PRE_DEV_PACKET_HOT(packet);
+	BT_ASSERT_PRE("packet-has-no-raw-data", !packet->raw_data.data,
+		"Packet already has raw data: %!+a", packet);
+	packet->raw_data.format = format;
+	packet->raw_data.data = raw_data;
+	packet->raw_data.destroy_func = destroy_func;
+	BT_LIB_LOGD("Set packet's raw data: %!+a", packet);
+}
+
+const void *bt_packet_borrow_raw_data_const(const struct bt_packet *packet,
+		const char *format)
+{
+	BT_ASSERT_PRE_DEV_PACKET_NON_NULL(packet);
+	BT_ASSERT_PRE_DEV_NON_NULL("format", format, "Format");
+
+	if (!packet->raw_data.data ||
+			strcmp(packet->raw_data.format, format) != 0) {
+		return NULL;
+	}
+
+	return packet->raw_data.data;
+}
+
+/*
+ * Destroys the raw data of `packet`, if any.
+ */
+static inline
+void reset_raw_data(struct bt_packet *packet)
+{
+	if (packet->raw_data.destroy_func) {
+		packet->raw_data.destroy_func(packet->raw_data.data);
+	}
+
+	packet->raw_data.format = NULL;
+	packet->raw_data.data = NULL;
+	packet->raw_data.destroy_func = NULL;
+}
+
 BT_HIDDEN
 void _bt_packet_set_is_frozen(const struct bt_packet *packet, bool is_frozen)
 {
@@ -74,6 +119,7 @@ void reset_packet(struct bt_packet *packet)
 	BT_ASSERT(packet);
 	BT_LIB_LOGD("Resetting packet: %!+a", packet);
 	bt_packet_set_is_frozen(packet, false);
+	reset_raw_data(packet);
 
 	if (packet->context_field) {
 		bt_field_set_is_frozen(packet->context_field->field, false);
@@ -135,6 +181,7 @@ BT_HIDDEN
 void bt_packet_destroy(struct bt_packet *packet)
 {
 	BT_LIB_LOGD("Destroying packet: %!+a", packet);
+	reset_raw_data(packet);
 
 	if (packet->context_field) {
 		if (packet->stream) {
@@ -19,10 +19,23 @@
 
 #include "field-wrapper.h"
 
+#define BT_ASSERT_PRE_DEV_PACKET_HOT(_packet)				\
+	BT_ASSERT_PRE_DEV_HOT("packet",					\
+		((const struct bt_packet *) (_packet)), "Packet", ": %!+a",	\
+		(_packet))
+
 struct bt_packet {
 	struct bt_object base;
 	struct bt_field_wrapper *context_field;
 	struct bt_stream *stream;
+
+	/* Raw data (see bt_packet_set_raw_data()), if `data` is set */
+	struct {
+		const char *format;
+		void *data;
+		bt_packet_raw_data_destroy_func destroy_func;
+	} raw_data;
+
 	bool frozen;
 };
 
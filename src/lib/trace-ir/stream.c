@@ -132,6 +132,9 @@ struct bt_stream *create_stream_with_id(struct bt_stream_class *stream_class,
 		goto error;
 	}
 
+	bt_object_pool_set_max_size(&stream->packet_pool,
+		BT_STREAM_PACKET_POOL_MAX_SIZE);
+
 	stream->class = stream_class;
 	bt_object_get_ref_no_null_check(stream_class);
 
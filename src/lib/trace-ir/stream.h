@@ -17,6 +17,12 @@
 
 #include "utils.h"
 
+/*
+ * Maximum number of recycled packets which the packet pool of a stream
+ * keeps.
+ */
+#define BT_STREAM_PACKET_POOL_MAX_SIZE	64
+
 struct bt_stream_class;
 struct bt_stream;
 
@@ -21,6 +21,7 @@
 #include "common/assert.h"
 #include <string.h>
 #include "compat/bitfield.h"
+#include "compat/endian.h"
 #include "common/common.h"
 #include <babeltrace2/babeltrace.h>
 #include "common/align.h"
@@ -108,6 +109,13 @@ struct bt_bfcr {
 	/* Current byte order (copied to last_bo after a successful read) */
 	enum ctf_byte_order cur_bo;
 
+	/*
+	 * True to run the decode programs of structure field classes
+	 * (false if the `BABELTRACE_CTF_DISABLE_DECODE_PROGRAMS`
+	 * environment variable is `1`).
+	 */
+	bool use_decode_programs;
+
 	/* Stitch buffer infos */
 	struct {
 		/* Stitch buffer */
@@ -1023,6 +1031,334 @@ end:
 	return status;
 }
 
+static inline
+uint64_t read_byte_aligned_uint(const uint8_t *addr, unsigned int size,
+		enum ctf_byte_order bo)
+{
+	uint64_t v;
+
+	switch (size) {
+	case 1:
+		v = *addr;
+		break;
+	case 2:
+	{
+		uint16_t v16;
+
+		memcpy(&v16, addr, sizeof(v16));
+		v = bo == CTF_BYTE_ORDER_BIG ? be16toh(v16) : le16toh(v16);
+		break;
+	}
+	case 4:
+	{
+		uint32_t v32;
+
+		memcpy(&v32, addr, sizeof(v32));
+		v = bo == CTF_BYTE_ORDER_BIG ? be32toh(v32) : le32toh(v32);
+		break;
+	}
+	case 8:
+		memcpy(&v, addr, sizeof(v));
+		v = bo == CTF_BYTE_ORDER_BIG ? be64toh(v) : le64toh(v);
+		break;
+	default:
+		bt_common_abort();
+	}
+
+	return v;
+}
+
+static inline
+int64_t sign_extend(uint64_t v, unsigned int size)
+{
+	switch (size) {
+	case 1:
+		return (int8_t) v;
+	case 2:
+		return (int16_t) v;
+	case 4:
+		return (int32_t) v;
+	case 8:
+		return (int64_t) v;
+	default:
+		bt_common_abort();
+	}
+}
+
+static inline
+double byte_aligned_float_value(uint64_t v, unsigned int size)
+{
+	double dblval;
+
+	if (size == 4) {
+		union {
+			uint32_t u;
+			float f;
+		} f32;
+
+		f32.u = (uint32_t) v;
+		dblval = (double) f32.f;
+	} else {
+		union {
+			uint64_t u;
+			double d;
+		} f64;
+
+		BT_ASSERT_DBG(size == 8);
+		f64.u = v;
+		dblval = f64.d;
+	}
+
+	return dblval;
+}
+
+/*
+ * Calls the user function of the basic field class `fc` for the
+ * `size`-byte field at `addr`, of which the decode instruction type is
+ * `type`.
+ */
+static inline
+enum bt_bfcr_status call_byte_aligned_basic_cb(struct bt_bfcr *bfcr,
+		enum ctf_decode_instr_type type, struct ctf_field_class *fc,
+		const uint8_t *addr, unsigned int size, enum ctf_byte_order bo)
+{
+	enum bt_bfcr_status status = BT_BFCR_STATUS_OK;
+
+	switch (type) {
+	case CTF_DECODE_INSTR_TYPE_UNSIGNED_INT:
+		/*
+		 * Always read the current function: the compound
+		 * beginning function can change it.
+		 */
+		if (bfcr->user.cbs.classes.unsigned_int) {
+			status = bfcr->user.cbs.classes.unsigned_int(
+				read_byte_aligned_uint(addr, size, bo),
+				fc, bfcr->user.data);
+		}
+
+		break;
+	case CTF_DECODE_INSTR_TYPE_SIGNED_INT:
+		if (bfcr->user.cbs.classes.signed_int) {
+			status = bfcr->user.cbs.classes.signed_int(
+				sign_extend(read_byte_aligned_uint(addr, size,
+					bo), size),
+				fc, bfcr->user.data);
+		}
+
+		break;
+	case CTF_DECODE_INSTR_TYPE_FLOAT:
+		if (bfcr->user.cbs.classes.floating_point) {
+			status = bfcr->user.cbs.classes.floating_point(
+				byte_aligned_float_value(
+					read_byte_aligned_uint(addr, size, bo),
+					size),
+				fc, bfcr->user.data);
+		}
+
+		break;
+	default:
+		bt_common_abort();
+	}
+
+	return status;
+}
+
+/*
+ * Hands the `count` elements at `addr` of the array or sequence field
+ * class `fc` to the user: all at once if possible, or one by one
+ * otherwise.
+ */
+static
+enum bt_bfcr_status call_numeric_array_cbs(struct bt_bfcr *bfcr,
+		struct ctf_field_class *fc, const uint8_t *addr,
+		uint64_t count)
+{
+	struct ctf_field_class_array_base *array_fc = (void *) fc;
+	struct ctf_field_class_bit_array *elem_fc = (void *) array_fc->elem_fc;
+	enum bt_bfcr_status status = BT_BFCR_STATUS_OK;
+	enum ctf_decode_instr_type elem_type;
+	unsigned int elem_size = elem_fc->size / 8;
+	uint64_t i;
+
+	BT_ASSERT_DBG(array_fc->elems_are_numeric);
+
+	if (bfcr->user.cbs.classes.numeric_array) {
+		BT_COMP_LOGT("Calling user function (numeric array): "
+			"count=%" PRIu64, count);
+		status = bfcr->user.cbs.classes.numeric_array(addr, count, fc,
+			bfcr->user.data);
+		goto end;
+	}
+
+	if (elem_fc->base.type == CTF_FIELD_CLASS_TYPE_FLOAT) {
+		elem_type = CTF_DECODE_INSTR_TYPE_FLOAT;
+	} else if (((struct ctf_field_class_int *) elem_fc)->is_signed) {
+		elem_type = CTF_DECODE_INSTR_TYPE_SIGNED_INT;
+	} else {
+		elem_type = CTF_DECODE_INSTR_TYPE_UNSIGNED_INT;
+	}
+
+	for (i = 0; i < count; i++) {
+		status = call_byte_aligned_basic_cb(bfcr, elem_type,
+			&elem_fc->base, &addr[i * elem_size], elem_size,
+			elem_fc->byte_order);
+		if (status != BT_BFCR_STATUS_OK) {
+			goto end;
+		}
+	}
+
+end:
+	return status;
+}
+
+/*
+ * Runs the decode program of the structure field class `struct_fc`
+ * from the current position, which must be the beginning of the
+ * structure field, calling the user functions.
+ *
+ * Sets `*ran` to false, without consuming anything, if the BFCR cannot
+ * run the program from here: the caller must then decode the members
+ * one by one.
+ */
+static
+enum bt_bfcr_status run_decode_program(struct bt_bfcr *bfcr,
+		struct ctf_field_class_struct *struct_fc, bool *ran)
+{
+	const struct ctf_decode_program *program = struct_fc->decode_program;
+	enum bt_bfcr_status status = BT_BFCR_STATUS_OK;
+	const uint8_t *addr;
+	guint i;
+
+	*ran = false;
+
+	if (!program || !bfcr->use_decode_programs) {
+		goto end;
+	}
+
+	/* The program only works with whole bytes */
+	if (buf_at_from_addr(bfcr) % 8 != 0 ||
+			!has_enough_bits(bfcr, BYTES_TO_BITS(program->size))) {
+		goto end;
+	}
+
+	BT_COMP_LOGT("Running decode program: bfcr-addr=%p, fc-addr=%p, "
+		"instr-count=%u, member-count=%" PRIu64 ", size=%" PRIu64,
+		bfcr, struct_fc, program->instrs->len, program->member_count,
+		program->size);
+	BT_ASSERT_DBG(bfcr->buf.addr);
+	addr = &bfcr->buf.addr[BITS_TO_BYTES_FLOOR(buf_at_from_addr(bfcr))];
+
+	for (i = 0; i < program->instrs->len; i++) {
+		const struct ctf_decode_instr *instr = &g_array_index(
+			program->instrs, struct ctf_decode_instr, i);
+
+		switch (instr->type) {
+		case CTF_DECODE_INSTR_TYPE_UNSIGNED_INT:
+		case CTF_DECODE_INSTR_TYPE_SIGNED_INT:
+		case CTF_DECODE_INSTR_TYPE_FLOAT:
+			status = call_byte_aligned_basic_cb(bfcr, instr->type,
+				instr->fc, &addr[instr->offset], instr->size,
+				instr->byte_order);
+			break;
+		case CTF_DECODE_INSTR_TYPE_NUMERIC_ARRAY:
+		{
+			struct ctf_field_class_array *array_fc =
+				(void *) instr->fc;
+
+			status = call_numeric_array_cbs(bfcr, instr->fc,
+				&addr[instr->offset], array_fc->length);
+			break;
+		}
+		case CTF_DECODE_INSTR_TYPE_COMPOUND_BEGIN:
+			if (bfcr->user.cbs.classes.compound_begin) {
+				status = bfcr->user.cbs.classes.compound_begin(
+					instr->fc, bfcr->user.data);
+			}
+
+			break;
+		case CTF_DECODE_INSTR_TYPE_COMPOUND_END:
+			if (bfcr->user.cbs.classes.compound_end) {
+				status = bfcr->user.cbs.classes.compound_end(
+					instr->fc, bfcr->user.data);
+			}
+
+			break;
+		default:
+			bt_common_abort();
+		}
+
+		if (status != BT_BFCR_STATUS_OK) {
+			BT_COMP_LOGW("User function failed: bfcr-addr=%p, status=%s",
+				bfcr, bt_bfcr_status_string(status));
+			goto end;
+		}
+	}
+
+	consume_bits(bfcr, BYTES_TO_BITS(program->size));
+	stack_top(bfcr->stack)->index = (int64_t) program->member_count;
+
+	if (program->last_byte_order != CTF_BYTE_ORDER_UNKNOWN) {
+		bfcr->cur_bo = program->last_byte_order;
+		bfcr->last_bo = program->last_byte_order;
+	}
+
+	*ran = true;
+
+end:
+	return status;
+}
+
+/*
+ * At the beginning of the array or sequence field of the stack entry
+ * `top`: if its elements are numeric and all within the buffer, hands
+ * them at once to the user and marks them as decoded.
+ *
+ * Doesn't consume anything otherwise: the caller must then decode the
+ * elements one by one.
+ */
+static
+enum bt_bfcr_status read_numeric_array(struct bt_bfcr *bfcr,
+		struct stack_entry *top)
+{
+	struct ctf_field_class_array_base *array_fc = (void *) top->base_class;
+	struct ctf_field_class_bit_array *elem_fc;
+	enum bt_bfcr_status status = BT_BFCR_STATUS_OK;
+	size_t size;
+
+	if (!array_fc->elems_are_numeric) {
+		goto end;
+	}
+
+	elem_fc = (void *) array_fc->elem_fc;
+
+	/* Avoid overflowing `size` with a huge sequence length */
+	if (buf_at_from_addr(bfcr) % 8 != 0 ||
+			(uint64_t) top->base_len >
+				available_bits(bfcr) / elem_fc->size) {
+		goto end;
+	}
+
+	size = (size_t) top->base_len * elem_fc->size;
+
+	BT_ASSERT_DBG(bfcr->buf.addr);
+	status = call_numeric_array_cbs(bfcr, top->base_class,
+		&bfcr->buf.addr[BITS_TO_BYTES_FLOOR(buf_at_from_addr(bfcr))],
+		(uint64_t) top->base_len);
+	if (status != BT_BFCR_STATUS_OK) {
+		BT_COMP_LOGW("User function failed: bfcr-addr=%p, status=%s",
+			bfcr, bt_bfcr_status_string(status));
+		goto end;
+	}
+
+	consume_bits(bfcr, size);
+	top->index = top->base_len;
+	bfcr->cur_bo = elem_fc->byte_order;
+	bfcr->last_bo = elem_fc->byte_order;
+
+end:
+	return status;
+}
+
 static inline
 enum bt_bfcr_status next_field_state(struct bt_bfcr *bfcr)
 {
@@ -1037,6 +1373,37 @@ enum bt_bfcr_status next_field_state(struct bt_bfcr *bfcr)
 
 	top = stack_top(bfcr->stack);
 
+	/*
+	 * At the beginning of a structure field: try to decode its
+	 * leading fixed-layout members at once.
+	 */
+	if (top->index == 0 &&
+			top->base_class->type == CTF_FIELD_CLASS_TYPE_STRUCT) {
+		bool ran;
+
+		status = run_decode_program(bfcr, (void *) top->base_class,
+			&ran);
+		if (status != BT_BFCR_STATUS_OK) {
+			goto end;
+		}
+
+		if (ran) {
+			/* Handle the remaining members as usual */
+			top = stack_top(bfcr->stack);
+		}
+	} else if (top->index == 0 && top->base_len > 0 &&
+			(top->base_class->type == CTF_FIELD_CLASS_TYPE_ARRAY ||
+			top->base_class->type == CTF_FIELD_CLASS_TYPE_SEQUENCE)) {
+		/*
+		 * At the beginning of an array or sequence field: try to
+		 * hand all its elements at once.
+		 */
+		status = read_numeric_array(bfcr, top);
+		if (status != BT_BFCR_STATUS_OK) {
+			goto end;
+		}
+	}
+
 	/* Are we done with this base class? */
 	while (top->index == top->base_len) {
 		if (bfcr->user.cbs.classes.compound_end) {
@@ -1178,6 +1545,7 @@ struct bt_bfcr *bt_bfcr_create(struct bt_bfcr_cbs cbs, void *data,
 		bt_logging_level log_level, bt_self_component *self_comp)
 {
 	struct bt_bfcr *bfcr;
+	const char *decode_programs_env;
 
 	BT_COMP_LOG_CUR_LVL(BT_LOG_DEBUG, log_level, self_comp,
 		"Creating binary field class reader (BFCR).");
@@ -1201,7 +1569,11 @@ struct bt_bfcr *bt_bfcr_create(struct bt_bfcr_cbs cbs, void *data,
 	bfcr->state = BFCR_STATE_NEXT_FIELD;
 	bfcr->user.cbs = cbs;
 	bfcr->user.data = data;
-	BT_COMP_LOGD("Created BFCR: addr=%p", bfcr);
+	decode_programs_env = getenv("BABELTRACE_CTF_DISABLE_DECODE_PROGRAMS");
+	bfcr->use_decode_programs = !decode_programs_env ||
+		strcmp(decode_programs_env, "1") != 0;
+	BT_COMP_LOGD("Created BFCR: addr=%p, use-decode-programs=%d",
+		bfcr, bfcr->use_decode_programs);
 
 end:
 	return bfcr;
@@ -1351,3 +1723,52 @@ void bt_bfcr_set_unsigned_int_cb(struct bt_bfcr *bfcr,
 	BT_ASSERT_DBG(cb);
 	bfcr->user.cbs.classes.unsigned_int = cb;
 }
+
+BT_HIDDEN
+void bt_bfcr_decode_numeric_array_elems(const uint8_t *buf, uint64_t count,
+		struct ctf_field_class *cls, void *values)
+{
+	struct ctf_field_class_array_base *array_fc = (void *) cls;
+	struct ctf_field_class_bit_array *elem_fc = (void *) array_fc->elem_fc;
+	unsigned int elem_size = elem_fc->size / 8;
+	uint64_t i;
+
+	BT_ASSERT_DBG(array_fc->elems_are_numeric);
+	BT_ASSERT_DBG(buf || count == 0);
+	BT_ASSERT_DBG(values || count == 0);
+
+	if (elem_fc->base.type == CTF_FIELD_CLASS_TYPE_FLOAT) {
+		double *dblvalues = values;
+
+		for (i = 0; i < count; i++) {
+			dblvalues[i] = byte_aligned_float_value(
+				read_byte_aligned_uint(&buf[i * elem_size],
+					elem_size, elem_fc->byte_order),
+				elem_size);
+		}
+	} else if (((struct ctf_field_class_int *) elem_fc)->is_signed) {
+		int64_t *ivalues = values;
+
+		for (i = 0; i < count; i++) {
+			ivalues[i] = sign_extend(
+				read_byte_aligned_uint(&buf[i * elem_size],
+					elem_size, elem_fc->byte_order),
+				elem_size);
+		}
+	} else if (elem_size == 1) {
+		uint64_t *uvalues = values;
+
+		/* Common case: bytes */
+		for (i = 0; i < count; i++) {
+			uvalues[i] = buf[i];
+		}
+	} else {
+		uint64_t *uvalues = values;
+
+		for (i = 0; i < count; i++) {
+			uvalues[i] = read_byte_aligned_uint(
+				&buf[i * elem_size], elem_size,
+				elem_fc->byte_order);
+		}
+	}
+}
@@ -141,6 +141,30 @@ struct bt_bfcr_cbs {
 		enum bt_bfcr_status (* floating_point)(double value,
 				struct ctf_field_class *cls, void *data);
 
+		/**
+		 * Called, between the calls to
+		 * bt_bfcr_cbs::classes::compound_begin() and
+		 * bt_bfcr_cbs::classes::compound_end(), instead of
+		 * calling the basic class functions for each element
+		 * of an array or sequence class of which the elements
+		 * are numeric (see
+		 * ctf_field_class_array_base::elems_are_numeric) when
+		 * all the elements are available at once.
+		 *
+		 * Decode the elements with
+		 * bt_bfcr_decode_numeric_array_elems().
+		 *
+		 * @param buf		Bytes of the elements
+		 * @param count		Number of elements (at least 1)
+		 * @param class		Array or sequence class
+		 * @param data		User data
+		 * @returns		#BT_BFCR_STATUS_OK or
+		 *			#BT_BFCR_STATUS_ERROR
+		 */
+		enum bt_bfcr_status (* numeric_array)(const uint8_t *buf,
+				uint64_t count, struct ctf_field_class *cls,
+				void *data);
+
 		/**
 		 * Called when a string class begins.
 		 *
@@ -341,6 +365,25 @@ BT_HIDDEN
 void bt_bfcr_set_unsigned_int_cb(struct bt_bfcr *bfcr,
 		bt_bfcr_unsigned_int_cb_func cb);
 
+/**
+ * Decodes the \p count numeric elements of an array or sequence class
+ * \p cls from \p buf to \p values, as given to
+ * bt_bfcr_cbs::classes::numeric_array().
+ *
+ * Depending on the element class, \p values is an array of \p count
+ * \c uint64_t (unsigned integer and enumeration classes), \c int64_t
+ * (signed integer and enumeration classes), or \c double (floating
+ * point number classes) values.
+ *
+ * @param buf		Bytes of the elements
+ * @param count		Number of elements
+ * @param cls		Array or sequence class
+ * @param values	Decoded values (output)
+ */
+BT_HIDDEN
+void bt_bfcr_decode_numeric_array_elems(const uint8_t *buf, uint64_t count,
+		struct ctf_field_class *cls, void *values);
+
 static inline
 const char *bt_bfcr_status_string(enum bt_bfcr_status status)
 {
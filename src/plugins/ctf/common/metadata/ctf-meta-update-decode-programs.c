@@ -0,0 +1,449 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (C) 2023 EfficiOS Inc.
+ *
+ * Compiles the decode programs of structure field classes.
+ *
+ * The binary field class reader (BFCR) decodes a field class tree
+ * with a generic state machine: aligning the cursor, checking the byte
+ * orders, and reading each basic field with a bit-level reader. For
+ * most event records, however, the layout of the leading members of
+ * the root structure field class is fixed: a decode program is the
+ * flat list of the callbacks to call, with the byte offsets and sizes
+ * of the basic fields, so that the BFCR can decode those members at
+ * once when they are completely within its buffer.
+ *
+ * A decode program only contains byte-aligned 8-bit, 16-bit, 32-bit,
+ * and 64-bit integer and enumeration fields, 32-bit and 64-bit
+ * floating point number fields, as well as structure and static array
+ * fields made of those. The BFCR decodes the remaining members
+ * (strings, sequences, variants, bit fields) as usual.
+ *
+ * This pass also marks the array and sequence field classes of which
+ * all the elements are such numeric fields without any special role
+ * (see `struct ctf_field_class_array_base`): the BFCR hands the bytes
+ * of all the elements of such fields at once to its user instead of
+ * decoding them one by one. A decode program contains a single
+ * instruction for such a static array field, whatever its length.
+ */
+
+#include <babeltrace2/babeltrace.h>
+#include "common/macros.h"
+#include "common/assert.h"
+#include "common/align.h"
+#include <glib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "ctf-meta-visitors.h"
+
+/*
+ * Maximum number of instructions of a decode program: this limits the
+ * size of the programs of structures containing big static arrays.
+ */
+#define MAX_INSTR_COUNT		1024
+
+static
+void append_instr(struct ctf_decode_program *program,
+		enum ctf_decode_instr_type type, uint64_t at,
+		struct ctf_field_class *fc)
+{
+	struct ctf_decode_instr instr = {
+		.type = type,
+		.offset = at / 8,
+		.fc = fc,
+	};
+
+	if (type != CTF_DECODE_INSTR_TYPE_COMPOUND_BEGIN &&
+			type != CTF_DECODE_INSTR_TYPE_COMPOUND_END) {
+		struct ctf_field_class_bit_array *bit_array_fc = (void *) fc;
+
+		if (type == CTF_DECODE_INSTR_TYPE_NUMERIC_ARRAY) {
+			struct ctf_field_class_array_base *array_fc =
+				(void *) fc;
+
+			bit_array_fc = (void *) array_fc->elem_fc;
+		}
+
+		instr.size = bit_array_fc->size / 8;
+		instr.byte_order = bit_array_fc->byte_order;
+		program->last_byte_order = bit_array_fc->byte_order;
+	}
+
+	g_array_append_val(program->instrs, instr);
+}
+
+/*
+ * Sets `*type` to the instruction type to decode a field of class `fc`
+ * and returns `true` if the size and byte order of `fc` are supported
+ * by decode programs, or returns `false` otherwise.
+ */
+static
+bool get_basic_field_class_instr_type(struct ctf_field_class *fc,
+		enum ctf_decode_instr_type *type)
+{
+	struct ctf_field_class_bit_array *bit_array_fc = (void *) fc;
+	bool ret = true;
+
+	if (fc->type != CTF_FIELD_CLASS_TYPE_INT &&
+			fc->type != CTF_FIELD_CLASS_TYPE_ENUM &&
+			fc->type != CTF_FIELD_CLASS_TYPE_FLOAT) {
+		ret = false;
+		goto end;
+	}
+
+	if (bit_array_fc->byte_order != CTF_BYTE_ORDER_LITTLE &&
+			bit_array_fc->byte_order != CTF_BYTE_ORDER_BIG) {
+		ret = false;
+		goto end;
+	}
+
+	if (fc->type == CTF_FIELD_CLASS_TYPE_FLOAT) {
+		if (bit_array_fc->size != 32 && bit_array_fc->size != 64) {
+			ret = false;
+			goto end;
+		}
+
+		*type = CTF_DECODE_INSTR_TYPE_FLOAT;
+	} else {
+		struct ctf_field_class_int *int_fc = (void *) fc;
+
+		if (bit_array_fc->size != 8 && bit_array_fc->size != 16 &&
+				bit_array_fc->size != 32 &&
+				bit_array_fc->size != 64) {
+			ret = false;
+			goto end;
+		}
+
+		*type = int_fc->is_signed ?
+			CTF_DECODE_INSTR_TYPE_SIGNED_INT :
+			CTF_DECODE_INSTR_TYPE_UNSIGNED_INT;
+	}
+
+end:
+	return ret;
+}
+
+/*
+ * Returns whether or not a decoder can decode all the elements of
+ * class `elem_fc` of an array field at once, without calling the basic
+ * field functions for each one.
+ */
+static
+bool elem_field_class_is_numeric(struct ctf_field_class *elem_fc)
+{
+	struct ctf_field_class_bit_array *bit_array_fc = (void *) elem_fc;
+	enum ctf_decode_instr_type type;
+	bool ret = false;
+
+	if (!get_basic_field_class_instr_type(elem_fc, &type)) {
+		goto end;
+	}
+
+	/* Contiguous, byte-aligned elements */
+	if (elem_fc->alignment % 8 != 0 ||
+			elem_fc->alignment > bit_array_fc->size) {
+		goto end;
+	}
+
+	if (type != CTF_DECODE_INSTR_TYPE_FLOAT) {
+		struct ctf_field_class_int *int_fc = (void *) elem_fc;
+
+		/* The decoder needs each value of such an element */
+		if (int_fc->meaning != CTF_FIELD_CLASS_MEANING_NONE ||
+				int_fc->mapped_clock_class ||
+				int_fc->storing_index >= 0) {
+			goto end;
+		}
+	}
+
+	ret = true;
+
+end:
+	return ret;
+}
+
+/*
+ * Appends the instructions to decode a field of class `fc` at the
+ * offset `*at` (bits, from the beginning of the structure) to
+ * `program`, updating `*at`.
+ *
+ * Returns `false` if the layout of such a field isn't fixed or if it's
+ * not supported.
+ */
+static
+bool append_field_class_instrs(struct ctf_decode_program *program,
+		struct ctf_field_class *fc, uint64_t *at)
+{
+	bool ret = true;
+	uint64_t i;
+
+	*at = ALIGN(*at, (uint64_t) fc->alignment);
+
+	switch (fc->type) {
+	case CTF_FIELD_CLASS_TYPE_INT:
+	case CTF_FIELD_CLASS_TYPE_ENUM:
+	case CTF_FIELD_CLASS_TYPE_FLOAT:
+	{
+		struct ctf_field_class_bit_array *bit_array_fc = (void *) fc;
+		enum ctf_decode_instr_type type;
+
+		if (*at % 8 != 0 ||
+				!get_basic_field_class_instr_type(fc, &type)) {
+			ret = false;
+			goto end;
+		}
+
+		append_instr(program, type, *at, fc);
+		*at += bit_array_fc->size;
+		break;
+	}
+	case CTF_FIELD_CLASS_TYPE_STRUCT:
+	{
+		struct ctf_field_class_struct *struct_fc = (void *) fc;
+
+		append_instr(program, CTF_DECODE_INSTR_TYPE_COMPOUND_BEGIN,
+			*at, fc);
+
+		for (i = 0; i < struct_fc->members->len; i++) {
+			struct ctf_named_field_class *named_fc =
+				ctf_field_class_struct_borrow_member_by_index(
+					struct_fc, i);
+
+			if (!append_field_class_instrs(program, named_fc->fc,
+					at)) {
+				ret = false;
+				goto end;
+			}
+		}
+
+		append_instr(program, CTF_DECODE_INSTR_TYPE_COMPOUND_END,
+			*at, fc);
+		break;
+	}
+	case CTF_FIELD_CLASS_TYPE_ARRAY:
+	{
+		struct ctf_field_class_array *array_fc = (void *) fc;
+
+		if (array_fc->base.elems_are_numeric) {
+			struct ctf_field_class_bit_array *elem_fc =
+				(void *) array_fc->base.elem_fc;
+
+			if (*at % 8 != 0) {
+				ret = false;
+				goto end;
+			}
+
+			append_instr(program,
+				CTF_DECODE_INSTR_TYPE_COMPOUND_BEGIN, *at, fc);
+
+			if (array_fc->length > 0) {
+				append_instr(program,
+					CTF_DECODE_INSTR_TYPE_NUMERIC_ARRAY,
+					*at, fc);
+				*at += array_fc->length * elem_fc->size;
+			}
+
+			append_instr(program,
+				CTF_DECODE_INSTR_TYPE_COMPOUND_END, *at, fc);
+			break;
+		}
+
+		/* Each element needs at least one instruction */
+		if (array_fc->length > MAX_INSTR_COUNT) {
+			ret = false;
+			goto end;
+		}
+
+		append_instr(program, CTF_DECODE_INSTR_TYPE_COMPOUND_BEGIN,
+			*at, fc);
+
+		for (i = 0; i < array_fc->length; i++) {
+			if (!append_field_class_instrs(program,
+					array_fc->base.elem_fc, at)) {
+				ret = false;
+				goto end;
+			}
+
+			if (program->instrs->len > MAX_INSTR_COUNT) {
+				ret = false;
+				goto end;
+			}
+		}
+
+		append_instr(program, CTF_DECODE_INSTR_TYPE_COMPOUND_END,
+			*at, fc);
+		break;
+	}
+	default:
+		/* Strings, sequences, and variants have a dynamic size */
+		ret = false;
+		break;
+	}
+
+end:
+	return ret;
+}
+
+/*
+ * Compiles the decode program of `struct_fc`, keeping the longest
+ * prefix of its members which a decode program supports.
+ */
+static
+void compile_struct_decode_program(struct ctf_field_class_struct *struct_fc)
+{
+	struct ctf_decode_program *program;
+	uint64_t at = 0;
+	uint64_t i;
+
+	program = g_new0(struct ctf_decode_program, 1);
+	BT_ASSERT(program);
+	program->instrs = g_array_new(FALSE, TRUE,
+		sizeof(struct ctf_decode_instr));
+	BT_ASSERT(program->instrs);
+	program->last_byte_order = CTF_BYTE_ORDER_UNKNOWN;
+
+	for (i = 0; i < struct_fc->members->len; i++) {
+		struct ctf_named_field_class *named_fc =
+			ctf_field_class_struct_borrow_member_by_index(
+				struct_fc, i);
+		guint instr_count = program->instrs->len;
+		enum ctf_byte_order last_byte_order = program->last_byte_order;
+		uint64_t member_at = at;
+
+		if (!append_field_class_instrs(program, named_fc->fc,
+				&member_at) ||
+				program->instrs->len > MAX_INSTR_COUNT) {
+			/* Stop before this member */
+			g_array_set_size(program->instrs, instr_count);
+			program->last_byte_order = last_byte_order;
+			break;
+		}
+
+		at = member_at;
+		program->member_count++;
+	}
+
+	if (program->member_count == 0) {
+		ctf_decode_program_destroy(program);
+		goto end;
+	}
+
+	/* All the decoded basic fields are byte-aligned, whole bytes */
+	BT_ASSERT(at % 8 == 0);
+	program->size = at / 8;
+	struct_fc->decode_program = program;
+
+end:
+	return;
+}
+
+static
+void update_decode_programs(struct ctf_field_class *fc)
+{
+	uint64_t i;
+
+	if (!fc) {
+		goto end;
+	}
+
+	switch (fc->type) {
+	case CTF_FIELD_CLASS_TYPE_STRUCT:
+	{
+		struct ctf_field_class_struct *struct_fc = (void *) fc;
+
+		if (struct_fc->decode_program) {
+			/* Already compiled, with its members */
+			goto end;
+		}
+
+		for (i = 0; i < struct_fc->members->len; i++) {
+			struct ctf_named_field_class *named_fc =
+				ctf_field_class_struct_borrow_member_by_index(
+					struct_fc, i);
+
+			update_decode_programs(named_fc->fc);
+		}
+
+		/*
+		 * The beginning of a structure field is always aligned
+		 * to the structure field class's alignment, which is the
+		 * greatest alignment of its members: the offsets of the
+		 * members from the beginning of the structure are
+		 * fixed.
+		 */
+		if (fc->alignment >= 8) {
+			compile_struct_decode_program(struct_fc);
+		}
+
+		break;
+	}
+	case CTF_FIELD_CLASS_TYPE_VARIANT:
+	{
+		struct ctf_field_class_variant *var_fc = (void *) fc;
+
+		for (i = 0; i < var_fc->options->len; i++) {
+			struct ctf_named_field_class *named_fc =
+				ctf_field_class_variant_borrow_option_by_index(
+					var_fc, i);
+
+			update_decode_programs(named_fc->fc);
+		}
+
+		break;
+	}
+	case CTF_FIELD_CLASS_TYPE_ARRAY:
+	case CTF_FIELD_CLASS_TYPE_SEQUENCE:
+	{
+		struct ctf_field_class_array_base *array_fc = (void *) fc;
+
+		update_decode_programs(array_fc->elem_fc);
+		array_fc->elems_are_numeric =
+			elem_field_class_is_numeric(array_fc->elem_fc);
+		break;
+	}
+	default:
+		break;
+	}
+
+end:
+	return;
+}
+
+BT_HIDDEN
+int ctf_trace_class_update_decode_programs(struct ctf_trace_class *ctf_tc)
+{
+	uint64_t i;
+
+	if (!ctf_tc->is_translated) {
+		update_decode_programs(ctf_tc->packet_header_fc);
+	}
+
+	for (i = 0; i < ctf_tc->stream_classes->len; i++) {
+		struct ctf_stream_class *sc = ctf_tc->stream_classes->pdata[i];
+		uint64_t j;
+
+		if (!sc->is_translated) {
+			update_decode_programs(sc->packet_context_fc);
+			update_decode_programs(sc->event_header_fc);
+			update_decode_programs(sc->event_common_context_fc);
+		}
+
+		for (j = 0; j < sc->event_classes->len; j++) {
+			struct ctf_event_class *ec =
+				sc->event_classes->pdata[j];
+
+			if (ec->is_translated) {
+				continue;
+			}
+
+			update_decode_programs(ec->spec_context_fc);
+			update_decode_programs(ec->payload_fc);
+		}
+	}
+
+	return 0;
+}
@@ -9,6 +9,7 @@
 
 #include <babeltrace2/babeltrace.h>
 #include "common/common.h"
+#include "common/interval-index.h"
 #include "common/uuid.h"
 #include "common/assert.h"
 #include <glib.h>
@@ -153,11 +154,71 @@ struct ctf_named_field_class {
 	struct ctf_field_class *fc;
 };
 
+enum ctf_decode_instr_type {
+	CTF_DECODE_INSTR_TYPE_UNSIGNED_INT,
+	CTF_DECODE_INSTR_TYPE_SIGNED_INT,
+	CTF_DECODE_INSTR_TYPE_FLOAT,
+
+	/*
+	 * All the elements of an array field class of which
+	 * `elems_are_numeric` is true.
+	 */
+	CTF_DECODE_INSTR_TYPE_NUMERIC_ARRAY,
+
+	CTF_DECODE_INSTR_TYPE_COMPOUND_BEGIN,
+	CTF_DECODE_INSTR_TYPE_COMPOUND_END,
+};
+
+struct ctf_decode_instr {
+	enum ctf_decode_instr_type type;
+
+	/* Offset of the field from the beginning of the structure (bytes) */
+	uint64_t offset;
+
+	/*
+	 * Size of the field (bytes; basic field classes only) or of
+	 * one element (numeric arrays).
+	 */
+	unsigned int size;
+
+	/*
+	 * Byte order of the field (basic field classes only) or of the
+	 * elements (numeric arrays).
+	 */
+	enum ctf_byte_order byte_order;
+
+	/* Weak */
+	struct ctf_field_class *fc;
+};
+
+/*
+ * Flat decode program of the leading members of a structure field
+ * class which only contain byte-aligned, fixed-size integer and
+ * floating point number fields (see
+ * ctf-meta-update-decode-programs.c).
+ */
+struct ctf_decode_program {
+	/* Array of `struct ctf_decode_instr` */
+	GArray *instrs;
+
+	/* Number of leading structure members which the program decodes */
+	uint64_t member_count;
+
+	/* Size of the decoded members, including padding (bytes) */
+	uint64_t size;
+
+	/* Byte order of the last decoded basic field */
+	enum ctf_byte_order last_byte_order;
+};
+
 struct ctf_field_class_struct {
 	struct ctf_field_class base;
 
 	/* Array of `struct ctf_named_field_class` */
 	GArray *members;
+
+	/* Owned by this, `NULL` if none */
+	struct ctf_decode_program *decode_program;
 };
 
 struct ctf_field_path {
@@ -184,6 +245,12 @@ struct ctf_field_class_variant {
 	/* Array of `struct ctf_field_class_variant_range` */
 	GArray *ranges;
 
+	/*
+	 * Index of `ranges` (items are range indexes), built when
+	 * setting the tag field class
+	 */
+	struct bt_interval_index *range_index;
+
 	/* Weak */
 	struct ctf_field_class_enum *tag_fc;
 };
@@ -192,6 +259,14 @@ struct ctf_field_class_array_base {
 	struct ctf_field_class base;
 	struct ctf_field_class *elem_fc;
 	bool is_text;
+
+	/*
+	 * True if the elements are byte-aligned, fixed-size integer and
+	 * floating point number fields without any special role, so
+	 * that a decoder can decode all of them at once (see
+	 * ctf-meta-update-decode-programs.c).
+	 */
+	bool elems_are_numeric;
 };
 
 struct ctf_field_class_array {
@@ -304,6 +379,12 @@ struct ctf_trace_class {
 	/* Weak, set during translation */
 	bt_trace_class *ir_tc;
 
+	/*
+	 * Reference count (see ctf_trace_class_get_ref() and
+	 * ctf_trace_class_put_ref())
+	 */
+	gint ref_count;
+
 	struct {
 		bool lttng_crash;
 		bool lttng_event_after_packet;
@@ -561,10 +642,25 @@ void _ctf_field_class_string_destroy(struct ctf_field_class_string *fc)
 	g_free(fc);
 }
 
+static inline
+void ctf_decode_program_destroy(struct ctf_decode_program *program)
+{
+	if (!program) {
+		return;
+	}
+
+	if (program->instrs) {
+		g_array_free(program->instrs, TRUE);
+	}
+
+	g_free(program);
+}
+
 static inline
 void _ctf_field_class_struct_destroy(struct ctf_field_class_struct *fc)
 {
 	BT_ASSERT(fc);
+	ctf_decode_program_destroy(fc->decode_program);
 
 	if (fc->members) {
 		uint64_t i;
@@ -635,6 +731,8 @@ void _ctf_field_class_variant_destroy(struct ctf_field_class_variant *fc)
 		g_array_free(fc->ranges, TRUE);
 	}
 
+	bt_interval_index_destroy(fc->range_index);
+
 	if (fc->tag_ref) {
 		g_string_free(fc->tag_ref, TRUE);
 	}
@@ -939,6 +1037,53 @@ void ctf_field_class_variant_append_option(struct ctf_field_class_variant *fc,
 	named_fc->fc = option_fc;
 }
 
+/*
+ * Builds the range index of `fc` from its ranges and the signedness of
+ * its tag field class.
+ *
+ * The range indexes are sorted: the first item of a lookup is the
+ * first range, in option order, which contains the tag value.
+ */
+static inline
+void ctf_field_class_variant_build_range_index(
+		struct ctf_field_class_variant *fc)
+{
+	GArray *index_ranges;
+	uint64_t range_i;
+
+	BT_ASSERT(fc);
+	BT_ASSERT(fc->tag_fc);
+	index_ranges = g_array_sized_new(FALSE, FALSE,
+		sizeof(struct bt_interval_index_range), fc->ranges->len);
+	BT_ASSERT(index_ranges);
+
+	for (range_i = 0; range_i < fc->ranges->len; range_i++) {
+		struct ctf_field_class_variant_range *var_range =
+			ctf_field_class_variant_borrow_range_by_index(fc,
+				range_i);
+		struct bt_interval_index_range index_range;
+
+		if (fc->tag_fc->base.is_signed) {
+			index_range.lower = bt_interval_index_signed_key(
+				var_range->range.lower.i);
+			index_range.upper = bt_interval_index_signed_key(
+				var_range->range.upper.i);
+		} else {
+			index_range.lower = var_range->range.lower.u;
+			index_range.upper = var_range->range.upper.u;
+		}
+
+		index_range.item = range_i;
+		g_array_append_val(index_ranges, index_range);
+	}
+
+	bt_interval_index_destroy(fc->range_index);
+	fc->range_index = bt_interval_index_create(
+		(const void *) index_ranges->data, index_ranges->len);
+	BT_ASSERT(fc->range_index);
+	g_array_free(index_ranges, TRUE);
+}
+
 static inline
 void ctf_field_class_variant_set_tag_field_class(
 		struct ctf_field_class_variant *fc,
@@ -975,6 +1120,8 @@ void ctf_field_class_variant_set_tag_field_class(
 			g_array_append_val(fc->ranges, var_range);
 		}
 	}
+
+	ctf_field_class_variant_build_range_index(fc);
 }
 
 static inline
@@ -1645,6 +1792,7 @@ struct ctf_trace_class *ctf_trace_class_create(void)
 	BT_ASSERT(tc->stream_classes);
 	tc->env_entries = g_array_new(FALSE, TRUE,
 		sizeof(struct ctf_trace_class_env_entry));
+	tc->ref_count = 1;
 	return tc;
 }
 
@@ -1682,6 +1830,31 @@ void ctf_trace_class_destroy(struct ctf_trace_class *tc)
 	g_free(tc);
 }
 
+/*
+ * Gets a reference on `tc`, for example to keep its event classes
+ * alive after its metadata decoder is destroyed.
+ *
+ * Getting and putting references is thread-safe.
+ */
+static inline
+struct ctf_trace_class *ctf_trace_class_get_ref(struct ctf_trace_class *tc)
+{
+	BT_ASSERT(tc);
+	g_atomic_int_inc(&tc->ref_count);
+	return tc;
+}
+
+/*
+ * Puts a reference on `tc`, destroying it if it's the last one.
+ */
+static inline
+void ctf_trace_class_put_ref(struct ctf_trace_class *tc)
+{
+	if (tc && g_atomic_int_dec_and_test(&tc->ref_count)) {
+		ctf_trace_class_destroy(tc);
+	}
+}
+
 static inline
 void ctf_trace_class_append_env_entry(struct ctf_trace_class *tc,
 		const char *name, enum ctf_trace_class_env_entry_type type,
@@ -541,9 +541,7 @@ void ctx_destroy(struct ctx *ctx)
 
 	bt_trace_class_put_ref(ctx->trace_class);
 
-	if (ctx->ctf_tc) {
-		ctf_trace_class_destroy(ctx->ctf_tc);
-	}
+	ctf_trace_class_put_ref(ctx->ctf_tc);
 
 	g_free(ctx);
 
@@ -4903,6 +4901,13 @@ int ctf_visitor_generate_ir_visit_node(struct ctf_visitor_generate_ir *visitor,
 		goto end;
 	}
 
+	/* Compile structure decode programs */
+	ret = ctf_trace_class_update_decode_programs(ctx->ctf_tc);
+	if (ret) {
+		ret = -EINVAL;
+		goto end;
+	}
+
 	/* Validate what we have so far */
 	ret = ctf_trace_class_validate(ctx->ctf_tc, &ctx->log_cfg);
 	if (ret) {
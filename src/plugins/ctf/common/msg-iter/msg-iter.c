@@ -21,12 +21,30 @@
 #include <string.h>
 #include <babeltrace2/babeltrace.h>
 #include "common/common.h"
+#include "compat/glib.h"
 #include <glib.h>
 #include <stdlib.h>
 
 #include "msg-iter.h"
 #include "../bfcr/bfcr.h"
 
+/*
+ * Like BT_COMP_LOGE_APPEND_CAUSE(), but also for a message iterator
+ * without a component, that is, one which decodes a deferred event
+ * payload field (see materialize_lazy_event_payload()).
+ */
+#define MSG_IT_LOGE_APPEND_CAUSE(_msg_it, _fmt, ...)			\
+	do {								\
+		if ((_msg_it)->self_comp) {				\
+			BT_COMP_LOGE_APPEND_CAUSE((_msg_it)->self_comp,	\
+				_fmt, ##__VA_ARGS__);			\
+		} else {						\
+			BT_COMP_LOGE(_fmt, ##__VA_ARGS__);		\
+			(void) BT_CURRENT_THREAD_ERROR_APPEND_CAUSE_FROM_UNKNOWN( \
+				BT_LOG_TAG, _fmt, ##__VA_ARGS__);	\
+		}							\
+	} while (0)
+
 struct ctf_msg_iter;
 
 /* A visit stack entry */
@@ -104,6 +122,53 @@ struct end_of_packet_snapshots {
 	uint64_t end_clock;
 };
 
+struct ctf_msg_iter_event_class_filter {
+	/* Set of event class names (`char *`, owned) */
+	GHashTable *names;
+
+	/* Set of event class IDs (`gint64 *`, owned) */
+	GHashTable *ids;
+};
+
+/*
+ * Copied event payload field of which the decoding is deferred to its
+ * first access (see ctf_msg_iter_set_lazy_event_payloads()).
+ *
+ * The stored values and the payload bytes follow this structure within
+ * the same memory block.
+ */
+struct lazy_event_payload {
+	/*
+	 * Strong reference: `ec` belongs to this trace class, which the
+	 * metadata decoder of the component can destroy before the
+	 * event is destroyed.
+	 */
+	struct ctf_trace_class *tc;
+
+	/* Weak, owned by `tc` */
+	struct ctf_event_class *ec;
+
+	bt_logging_level log_level;
+
+	/* Offset of the payload field within its packet (bits) */
+	size_t packet_offset;
+
+	/* Offset of the payload field within `data` (bits; less than 8) */
+	size_t offset;
+
+	/* Stored values when the payload field was decoded */
+	const uint64_t *stored_values;
+	uint64_t stored_value_count;
+
+	/* Bytes of the payload field */
+	const uint8_t *data;
+	size_t data_size;
+};
+
+/* Values of `struct ctf_msg_iter::ec_filter_results` */
+#define EC_FILTER_RESULT_KEEP	GINT_TO_POINTER(1)
+#define EC_FILTER_RESULT_SKIP	GINT_TO_POINTER(2)
+
 /* CTF message iterator */
 struct ctf_msg_iter {
 	/* Visit stack */
@@ -118,6 +183,48 @@ struct ctf_msg_iter {
 	 */
 	bool dry_run;
 
+	/*
+	 * Event class filter (weak), or `NULL` to emit the messages of
+	 * all the events.
+	 */
+	const struct ctf_msg_iter_event_class_filter *ec_filter;
+
+	/*
+	 * Cache of the decisions of `ec_filter`: `struct ctf_event_class *`
+	 * (weak) to `EC_FILTER_RESULT_KEEP` or `EC_FILTER_RESULT_SKIP`.
+	 */
+	GHashTable *ec_filter_results;
+
+	/*
+	 * True if `ec_filter` filters out the current event: decode it
+	 * like in dry run mode and don't emit its message.
+	 */
+	bool skip_cur_event;
+
+	/*
+	 * True to defer the decoding of the event payload fields to
+	 * their first access (see ctf_msg_iter_set_lazy_event_payloads()).
+	 */
+	bool lazy_event_payloads;
+
+	/* Current event payload field of which the decoding is deferred */
+	struct {
+		/*
+		 * True while decoding the current event payload field
+		 * without creating any library object.
+		 */
+		bool active;
+
+		/* Offset of the payload field within its packet (bits) */
+		size_t packet_offset;
+
+		/* Offset of the payload field within `data` (bits) */
+		size_t offset;
+
+		/* Bytes of the payload field, so far */
+		GByteArray *data;
+	} lazy_payload;
+
 	/*
 	 * Current dynamic scope field pointer.
 	 *
@@ -145,6 +252,12 @@ struct ctf_msg_iter {
 	/* Current packet (NULL if not created yet) */
 	bt_packet *packet;
 
+	/*
+	 * Number of events of the current packet decoded so far,
+	 * including the ones which `ec_filter` filters out.
+	 */
+	uint64_t packet_event_count;
+
 	/* Current stream (NULL if not set yet) */
 	bt_stream *stream;
 
@@ -246,6 +359,13 @@ struct ctf_msg_iter {
 	/* Stored values (for sequence lengths, variant tags) */
 	GArray *stored_values;
 
+	/*
+	 * Decoded element values of the current numeric array field
+	 * (array of `uint64_t`, `int64_t`, or `double`, depending on the
+	 * element class; see bfcr_numeric_array_cb())
+	 */
+	GArray *numeric_array_values;
+
 	/* Iterator's current log level */
 	bt_logging_level log_level;
 
@@ -325,12 +445,11 @@ const char *state_string(enum state state)
 static
 struct stack *stack_new(struct ctf_msg_iter *msg_it)
 {
-	bt_self_component *self_comp = msg_it->self_comp;
 	struct stack *stack = NULL;
 
 	stack = g_new0(struct stack, 1);
 	if (!stack) {
-		BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+		MSG_IT_LOGE_APPEND_CAUSE(msg_it,
 			"Failed to allocate one stack.");
 		goto error;
 	}
@@ -338,7 +457,7 @@ struct stack *stack_new(struct ctf_msg_iter *msg_it)
 	stack->msg_it = msg_it;
 	stack->entries = g_array_new(FALSE, TRUE, sizeof(struct stack_entry));
 	if (!stack->entries) {
-		BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+		MSG_IT_LOGE_APPEND_CAUSE(msg_it,
 			"Failed to allocate a GArray.");
 		goto error;
 	}
@@ -568,6 +687,28 @@ enum ctf_msg_iter_status buf_ensure_available_bits(
 	return status;
 }
 
+/*
+ * Copies the bytes which contain the next `bit_count` bits of the
+ * current medium buffer to the bytes of the current event payload
+ * field of which the decoding is deferred.
+ */
+static
+void copy_lazy_payload_bits(struct ctf_msg_iter *msg_it, size_t bit_count)
+{
+	const size_t begin = msg_it->buf.at / 8;
+	const size_t end = (msg_it->buf.at + bit_count + 7) / 8;
+
+	/*
+	 * The BFCR consumes all the bits of a medium buffer before
+	 * needing another one, so that only the first copied byte can
+	 * start within a payload field.
+	 */
+	BT_ASSERT_DBG(msg_it->lazy_payload.data->len == 0 ||
+		msg_it->buf.at == 0);
+	g_byte_array_append(msg_it->lazy_payload.data,
+		&msg_it->buf.addr[begin], end - begin);
+}
+
 static
 enum ctf_msg_iter_status read_dscope_begin_state(
 		struct ctf_msg_iter *msg_it,
@@ -607,6 +748,10 @@ enum ctf_msg_iter_status read_dscope_begin_state(
 		goto end;
 	}
 
+	if (G_UNLIKELY(msg_it->lazy_payload.active)) {
+		copy_lazy_payload_bits(msg_it, consumed_bits);
+	}
+
 	/* Consume bits now since we know we're not in an error state */
 	buf_consume_bits(msg_it, consumed_bits);
 
@@ -665,6 +810,10 @@ enum ctf_msg_iter_status read_dscope_continue_state(
 		goto end;
 	}
 
+	if (G_UNLIKELY(msg_it->lazy_payload.active)) {
+		copy_lazy_payload_bits(msg_it, consumed_bits);
+	}
+
 	/* Consume bits now since we know we're not in an error state. */
 	buf_consume_bits(msg_it, consumed_bits);
 end:
@@ -972,6 +1121,25 @@ enum ctf_msg_iter_status set_current_packet(struct ctf_msg_iter *msg_it)
 		goto error;
 	}
 
+	msg_it->packet_event_count = 0;
+
+	if (msg_it->medium.medops.packet_created) {
+		enum ctf_msg_iter_medium_status medium_status;
+
+		BT_COMP_LOGD("Calling user function (packet created): "
+			"msg-it-addr=%p, packet-addr=%p", msg_it, packet);
+		medium_status = msg_it->medium.medops.packet_created(packet,
+			msg_it->medium.data);
+		if (medium_status != CTF_MSG_ITER_MEDIUM_STATUS_OK) {
+			BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+				"User function failed to handle the new packet: "
+				"msg-it-addr=%p, packet-addr=%p, status=%s",
+				msg_it, packet,
+				ctf_msg_iter_medium_status_string(medium_status));
+			goto error;
+		}
+	}
+
 	goto end;
 
 error:
@@ -1229,6 +1397,56 @@ enum ctf_msg_iter_status read_event_header_continue_state(
 		STATE_AFTER_EVENT_HEADER);
 }
 
+/*
+ * Returns whether or not the message iterator must not create or use
+ * library objects while decoding the current field.
+ */
+static inline
+bool skip_ir_objects(struct ctf_msg_iter *msg_it)
+{
+	return msg_it->dry_run || msg_it->skip_cur_event ||
+		msg_it->lazy_payload.active;
+}
+
+/*
+ * Returns whether or not the event class filter of `msg_it`, if any,
+ * filters out the event class `ec`.
+ */
+static inline
+bool event_class_is_filtered_out(struct ctf_msg_iter *msg_it,
+		struct ctf_event_class *ec)
+{
+	gpointer result;
+
+	if (G_LIKELY(!msg_it->ec_filter)) {
+		return false;
+	}
+
+	result = g_hash_table_lookup(msg_it->ec_filter_results, ec);
+	if (G_UNLIKELY(!result)) {
+		const struct ctf_msg_iter_event_class_filter *filter =
+			msg_it->ec_filter;
+		gint64 id = (gint64) ec->id;
+
+		if (bt_g_hash_table_contains(filter->names, ec->name->str) ||
+				bt_g_hash_table_contains(filter->ids, &id)) {
+			result = EC_FILTER_RESULT_KEEP;
+		} else {
+			result = EC_FILTER_RESULT_SKIP;
+		}
+
+		g_hash_table_insert(msg_it->ec_filter_results, ec, result);
+		BT_COMP_LOGD("Applied event class filter: "
+			"msg-it-addr=%p, event-class-addr=%p, "
+			"event-class-id=%" PRId64 ", "
+			"event-class-name=\"%s\", keep=%d",
+			msg_it, ec, ec->id, ec->name->str,
+			result == EC_FILTER_RESULT_KEEP);
+	}
+
+	return result == EC_FILTER_RESULT_SKIP;
+}
+
 static inline
 enum ctf_msg_iter_status set_current_event_class(struct ctf_msg_iter *msg_it)
 {
@@ -1340,7 +1558,10 @@ enum ctf_msg_iter_status after_event_header_state(
 		goto end;
 	}
 
-	if (G_UNLIKELY(msg_it->dry_run)) {
+	msg_it->packet_event_count++;
+	msg_it->skip_cur_event = event_class_is_filtered_out(msg_it,
+		msg_it->meta.ec);
+	if (G_UNLIKELY(skip_ir_objects(msg_it))) {
 		goto next_state;
 	}
 
@@ -1374,7 +1595,7 @@ enum ctf_msg_iter_status read_event_common_context_begin_state(
 		goto end;
 	}
 
-	if (event_common_context_fc->in_ir && !msg_it->dry_run) {
+	if (event_common_context_fc->in_ir && !skip_ir_objects(msg_it)) {
 		BT_ASSERT_DBG(!msg_it->dscopes.event_common_context);
 		msg_it->dscopes.event_common_context =
 			bt_event_borrow_common_context_field(
@@ -1429,7 +1650,7 @@ enum ctf_msg_iter_status read_event_spec_context_begin_state(
 		goto end;
 	}
 
-	if (event_spec_context_fc->in_ir && !msg_it->dry_run) {
+	if (event_spec_context_fc->in_ir && !skip_ir_objects(msg_it)) {
 		BT_ASSERT_DBG(!msg_it->dscopes.event_spec_context);
 		msg_it->dscopes.event_spec_context =
 			bt_event_borrow_specific_context_field(
@@ -1487,12 +1708,23 @@ enum ctf_msg_iter_status read_event_payload_begin_state(
 		goto end;
 	}
 
-	if (event_payload_fc->in_ir && !msg_it->dry_run) {
-		BT_ASSERT_DBG(!msg_it->dscopes.event_payload);
-		msg_it->dscopes.event_payload =
-			bt_event_borrow_payload_field(
-				msg_it->event);
-		BT_ASSERT_DBG(msg_it->dscopes.event_payload);
+	if (event_payload_fc->in_ir && !skip_ir_objects(msg_it)) {
+		if (msg_it->lazy_event_payloads) {
+			/*
+			 * Only copy the bytes of the payload field: see
+			 * defer_event_payload_decoding().
+			 */
+			msg_it->lazy_payload.active = true;
+			msg_it->lazy_payload.packet_offset = packet_at(msg_it);
+			msg_it->lazy_payload.offset = msg_it->buf.at % 8;
+			g_byte_array_set_size(msg_it->lazy_payload.data, 0);
+		} else {
+			BT_ASSERT_DBG(!msg_it->dscopes.event_payload);
+			msg_it->dscopes.event_payload =
+				bt_event_borrow_payload_field(
+					msg_it->event);
+			BT_ASSERT_DBG(msg_it->dscopes.event_payload);
+		}
 	}
 
 	BT_COMP_LOGT("Decoding event payload field: "
@@ -1793,6 +2025,8 @@ void ctf_msg_iter_reset_for_next_stream_file(struct ctf_msg_iter *msg_it)
 	stack_clear(msg_it->stack);
 	msg_it->meta.sc = NULL;
 	msg_it->meta.ec = NULL;
+	msg_it->skip_cur_event = false;
+	msg_it->lazy_payload.active = false;
 	BT_PACKET_PUT_REF_AND_RESET(msg_it->packet);
 	BT_STREAM_PUT_REF_AND_RESET(msg_it->stream);
 	BT_MESSAGE_PUT_REF_AND_RESET(msg_it->event_msg);
@@ -1989,7 +2223,7 @@ update_def_clock:
 			(uint64_t) int_fc->storing_index) = value;
 	}
 
-	if (G_UNLIKELY(!fc->in_ir || msg_it->dry_run)) {
+	if (G_UNLIKELY(!fc->in_ir || skip_ir_objects(msg_it))) {
 		goto end;
 	}
 
@@ -2011,7 +2245,6 @@ enum bt_bfcr_status bfcr_unsigned_int_char_cb(uint64_t value,
 {
 	int ret;
 	struct ctf_msg_iter *msg_it = data;
-	bt_self_component *self_comp = msg_it->self_comp;
 	enum bt_bfcr_status status = BT_BFCR_STATUS_OK;
 	bt_field *string_field = NULL;
 	struct ctf_field_class_int *int_fc = (void *) fc;
@@ -2025,7 +2258,7 @@ enum bt_bfcr_status bfcr_unsigned_int_char_cb(uint64_t value,
 	BT_ASSERT_DBG(!int_fc->mapped_clock_class);
 	BT_ASSERT_DBG(int_fc->storing_index < 0);
 
-	if (G_UNLIKELY(!fc->in_ir || msg_it->dry_run)) {
+	if (G_UNLIKELY(!fc->in_ir || skip_ir_objects(msg_it))) {
 		goto end;
 	}
 
@@ -2046,7 +2279,7 @@ enum bt_bfcr_status bfcr_unsigned_int_char_cb(uint64_t value,
 	str[0] = (char) value;
 	ret = bt_field_string_append_with_length(string_field, str, 1);
 	if (ret) {
-		BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+		MSG_IT_LOGE_APPEND_CAUSE(msg_it,
 			"Cannot append character to string field's value: "
 			"msg-it-addr=%p, field-addr=%p, ret=%d",
 			msg_it, string_field, ret);
@@ -2078,7 +2311,7 @@ enum bt_bfcr_status bfcr_signed_int_cb(int64_t value,
 			(uint64_t) int_fc->storing_index) = (uint64_t) value;
 	}
 
-	if (G_UNLIKELY(!fc->in_ir || msg_it->dry_run)) {
+	if (G_UNLIKELY(!fc->in_ir || skip_ir_objects(msg_it))) {
 		goto end;
 	}
 
@@ -2108,7 +2341,7 @@ enum bt_bfcr_status bfcr_floating_point_cb(double value,
 		"fc-type=%d, fc-in-ir=%d, value=%f",
 		msg_it, msg_it->bfcr, fc, fc->type, fc->in_ir, value);
 
-	if (G_UNLIKELY(!fc->in_ir || msg_it->dry_run)) {
+	if (G_UNLIKELY(!fc->in_ir || skip_ir_objects(msg_it))) {
 		goto end;
 	}
 
@@ -2141,7 +2374,7 @@ enum bt_bfcr_status bfcr_string_begin_cb(
 		"fc-type=%d, fc-in-ir=%d",
 		msg_it, msg_it->bfcr, fc, fc->type, fc->in_ir);
 
-	if (G_UNLIKELY(!fc->in_ir || msg_it->dry_run)) {
+	if (G_UNLIKELY(!fc->in_ir || skip_ir_objects(msg_it))) {
 		goto end;
 	}
 
@@ -2170,7 +2403,6 @@ enum bt_bfcr_status bfcr_string_cb(const char *value,
 	enum bt_bfcr_status status = BT_BFCR_STATUS_OK;
 	bt_field *field = NULL;
 	struct ctf_msg_iter *msg_it = data;
-	bt_self_component *self_comp = msg_it->self_comp;
 	int ret;
 
 	BT_COMP_LOGT("String (substring) function called from BFCR: "
@@ -2179,7 +2411,7 @@ enum bt_bfcr_status bfcr_string_cb(const char *value,
 		msg_it, msg_it->bfcr, fc, fc->type, fc->in_ir,
 		len);
 
-	if (G_UNLIKELY(!fc->in_ir || msg_it->dry_run)) {
+	if (G_UNLIKELY(!fc->in_ir || skip_ir_objects(msg_it))) {
 		goto end;
 	}
 
@@ -2189,7 +2421,7 @@ enum bt_bfcr_status bfcr_string_cb(const char *value,
 	/* Append current substring */
 	ret = bt_field_string_append_with_length(field, value, len);
 	if (ret) {
-		BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+		MSG_IT_LOGE_APPEND_CAUSE(msg_it,
 			"Cannot append substring to string field's value: "
 			"msg-it-addr=%p, field-addr=%p, string-length=%zu, "
 			"ret=%d", msg_it, field, len, ret);
@@ -2212,7 +2444,7 @@ enum bt_bfcr_status bfcr_string_end_cb(
 		"fc-type=%d, fc-in-ir=%d",
 		msg_it, msg_it->bfcr, fc, fc->type, fc->in_ir);
 
-	if (G_UNLIKELY(!fc->in_ir || msg_it->dry_run)) {
+	if (G_UNLIKELY(!fc->in_ir || skip_ir_objects(msg_it))) {
 		goto end;
 	}
 
@@ -2226,6 +2458,80 @@ end:
 	return BT_BFCR_STATUS_OK;
 }
 
+static
+enum bt_bfcr_status bfcr_numeric_array_cb(const uint8_t *buf,
+		uint64_t count, struct ctf_field_class *fc, void *data)
+{
+	int ret;
+	struct ctf_msg_iter *msg_it = data;
+	enum bt_bfcr_status status = BT_BFCR_STATUS_OK;
+	struct ctf_field_class_array_base *array_fc = (void *) fc;
+	struct ctf_field_class *elem_fc = array_fc->elem_fc;
+	bt_field *field;
+
+	BT_COMP_LOGT("Numeric array function called from BFCR: "
+		"msg-it-addr=%p, bfcr-addr=%p, fc-addr=%p, "
+		"fc-type=%d, fc-in-ir=%d, count=%" PRIu64,
+		msg_it, msg_it->bfcr, fc, fc->type, fc->in_ir, count);
+
+	if (G_UNLIKELY(!fc->in_ir || skip_ir_objects(msg_it))) {
+		goto end;
+	}
+
+	/* Pushed by bfcr_compound_begin_cb() */
+	field = stack_top(msg_it->stack)->base;
+	BT_ASSERT_DBG(bt_field_borrow_class_const(field) == fc->ir_fc);
+
+	if (array_fc->is_text) {
+		/*
+		 * Up to the first null character, like
+		 * bfcr_unsigned_int_char_cb().
+		 */
+		const uint8_t *nul = memchr(buf, '\0', count);
+		uint64_t len = nul ? (uint64_t) (nul - buf) : count;
+
+		BT_ASSERT_DBG(bt_field_get_class_type(field) ==
+			BT_FIELD_CLASS_TYPE_STRING);
+		BT_ASSERT_DBG(!msg_it->done_filling_string);
+		msg_it->done_filling_string = nul != NULL;
+
+		if (len == 0) {
+			goto end;
+		}
+
+		ret = bt_field_string_append_with_length(field,
+			(const char *) buf, len);
+		if (ret) {
+			MSG_IT_LOGE_APPEND_CAUSE(msg_it,
+				"Cannot append characters to string field's value: "
+				"msg-it-addr=%p, field-addr=%p, ret=%d",
+				msg_it, field, ret);
+			status = BT_BFCR_STATUS_ERROR;
+		}
+
+		goto end;
+	}
+
+	BT_ASSERT_DBG(bt_field_array_get_length(field) == count);
+	g_array_set_size(msg_it->numeric_array_values, count);
+	bt_bfcr_decode_numeric_array_elems(buf, count, fc,
+		msg_it->numeric_array_values->data);
+
+	if (elem_fc->type == CTF_FIELD_CLASS_TYPE_FLOAT) {
+		bt_field_array_set_real_element_values(field,
+			(const double *) msg_it->numeric_array_values->data);
+	} else if (((struct ctf_field_class_int *) elem_fc)->is_signed) {
+		bt_field_array_set_signed_integer_element_values(field,
+			(const int64_t *) msg_it->numeric_array_values->data);
+	} else {
+		bt_field_array_set_unsigned_integer_element_values(field,
+			(const uint64_t *) msg_it->numeric_array_values->data);
+	}
+
+end:
+	return status;
+}
+
 static
 enum bt_bfcr_status bfcr_compound_begin_cb(
 		struct ctf_field_class *fc, void *data)
@@ -2238,7 +2544,7 @@ enum bt_bfcr_status bfcr_compound_begin_cb(
 		"fc-type=%d, fc-in-ir=%d",
 		msg_it, msg_it->bfcr, fc, fc->type, fc->in_ir);
 
-	if (G_UNLIKELY(!fc->in_ir || msg_it->dry_run)) {
+	if (G_UNLIKELY(!fc->in_ir || skip_ir_objects(msg_it))) {
 		goto end;
 	}
 
@@ -2289,7 +2595,7 @@ enum bt_bfcr_status bfcr_compound_end_cb(
 		"fc-type=%d, fc-in-ir=%d",
 		msg_it, msg_it->bfcr, fc, fc->type, fc->in_ir);
 
-	if (G_UNLIKELY(!fc->in_ir || msg_it->dry_run)) {
+	if (G_UNLIKELY(!fc->in_ir || skip_ir_objects(msg_it))) {
 		goto end;
 	}
 
@@ -2331,7 +2637,6 @@ int64_t bfcr_get_sequence_length_cb(struct ctf_field_class *fc, void *data)
 {
 	bt_field *seq_field;
 	struct ctf_msg_iter *msg_it = data;
-	bt_self_component *self_comp = msg_it->self_comp;
 	struct ctf_field_class_sequence *seq_fc = (void *) fc;
 	int64_t length;
 	int ret;
@@ -2339,7 +2644,7 @@ int64_t bfcr_get_sequence_length_cb(struct ctf_field_class *fc, void *data)
 	length = (uint64_t) g_array_index(msg_it->stored_values, uint64_t,
 		seq_fc->stored_length_index);
 
-	if (G_UNLIKELY(msg_it->dry_run)){
+	if (G_UNLIKELY(skip_ir_objects(msg_it))) {
 		goto end;
 	}
 
@@ -2359,7 +2664,7 @@ int64_t bfcr_get_sequence_length_cb(struct ctf_field_class *fc, void *data)
 		ret = bt_field_array_dynamic_set_length(seq_field,
 			(uint64_t) length);
 		if (ret) {
-			BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+			MSG_IT_LOGE_APPEND_CAUSE(msg_it,
 				"Cannot set dynamic array field's length field: "
 				"msg-it-addr=%p, field-addr=%p, "
 				"length=%" PRIu64, msg_it, seq_field, length);
@@ -2376,12 +2681,12 @@ struct ctf_field_class *bfcr_borrow_variant_selected_field_class_cb(
 		struct ctf_field_class *fc, void *data)
 {
 	int ret;
-	uint64_t i;
+	const uint64_t *range_indexes;
+	uint64_t range_count;
 	int64_t option_index = -1;
 	struct ctf_msg_iter *msg_it = data;
 	struct ctf_field_class_variant *var_fc = (void *) fc;
 	struct ctf_named_field_class *selected_option = NULL;
-	bt_self_component *self_comp = msg_it->self_comp;
 	struct ctf_field_class *ret_fc = NULL;
 	union {
 		uint64_t u;
@@ -2393,36 +2698,22 @@ struct ctf_field_class *bfcr_borrow_variant_selected_field_class_cb(
 		var_fc->stored_tag_index);
 
 	/*
-	 * Check each range to find the selected option's index.
+	 * Look up the first range which contains the tag to find the
+	 * selected option's index.
 	 */
-	if (var_fc->tag_fc->base.is_signed) {
-		for (i = 0; i < var_fc->ranges->len; i++) {
-			struct ctf_field_class_variant_range *range =
-				ctf_field_class_variant_borrow_range_by_index(
-					var_fc, i);
-
-			if (tag.i >= range->range.lower.i &&
-					tag.i <= range->range.upper.i) {
-				option_index = (int64_t) range->option_index;
-				break;
-			}
-		}
-	} else {
-		for (i = 0; i < var_fc->ranges->len; i++) {
-			struct ctf_field_class_variant_range *range =
-				ctf_field_class_variant_borrow_range_by_index(
-					var_fc, i);
-
-			if (tag.u >= range->range.lower.u &&
-					tag.u <= range->range.upper.u) {
-				option_index = (int64_t) range->option_index;
-				break;
-			}
-		}
+	BT_ASSERT_DBG(var_fc->range_index);
+	range_indexes = bt_interval_index_lookup(var_fc->range_index,
+		var_fc->tag_fc->base.is_signed ?
+			bt_interval_index_signed_key(tag.i) : tag.u,
+		&range_count);
+	if (range_count > 0) {
+		option_index = (int64_t)
+			ctf_field_class_variant_borrow_range_by_index(var_fc,
+				range_indexes[0])->option_index;
 	}
 
 	if (option_index < 0) {
-		BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+		MSG_IT_LOGE_APPEND_CAUSE(msg_it,
 			"Cannot find variant field class's option: "
 			"msg-it-addr=%p, var-fc-addr=%p, u-tag=%" PRIu64 ", "
 			"i-tag=%" PRId64, msg_it, var_fc, tag.u, tag.i);
@@ -2433,13 +2724,13 @@ struct ctf_field_class *bfcr_borrow_variant_selected_field_class_cb(
 	selected_option = ctf_field_class_variant_borrow_option_by_index(
 		var_fc, (uint64_t) option_index);
 
-	if (selected_option->fc->in_ir && !msg_it->dry_run) {
+	if (selected_option->fc->in_ir && !skip_ir_objects(msg_it)) {
 		bt_field *var_field = stack_top(msg_it->stack)->base;
 
 		ret = bt_field_variant_select_option_by_index(
 			var_field, option_index);
 		if (ret) {
-			BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+			MSG_IT_LOGE_APPEND_CAUSE(msg_it,
 				"Cannot select variant field's option field: "
 				"msg-it-addr=%p, var-field-addr=%p, "
 				"opt-index=%" PRId64, msg_it, var_field,
@@ -2593,6 +2884,26 @@ bt_message *create_msg_packet_end(struct ctf_msg_iter *msg_it)
 		goto end;
 	}
 
+	if (msg_it->medium.medops.packet_ended) {
+		enum ctf_msg_iter_medium_status medium_status;
+
+		BT_COMP_LOGD("Calling user function (packet ended): "
+			"msg-it-addr=%p, packet-addr=%p, event-count=%" PRIu64,
+			msg_it, msg_it->packet, msg_it->packet_event_count);
+		medium_status = msg_it->medium.medops.packet_ended(
+			msg_it->packet, msg_it->packet_event_count,
+			msg_it->medium.data);
+		if (medium_status != CTF_MSG_ITER_MEDIUM_STATUS_OK) {
+			BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+				"User function failed to handle the end of the packet: "
+				"msg-it-addr=%p, packet-addr=%p, status=%s",
+				msg_it, msg_it->packet,
+				ctf_msg_iter_medium_status_string(medium_status));
+			msg = NULL;
+			goto end;
+		}
+	}
+
 	/* Check if may be affected by lttng-crash timestamp_end quirk. */
 	if (G_UNLIKELY(msg_it->meta.tc->quirks.lttng_crash)) {
 		/*
@@ -2752,16 +3063,13 @@ end:
 	return msg;
 }
 
-BT_HIDDEN
-struct ctf_msg_iter *ctf_msg_iter_create(
-		struct ctf_trace_class *tc,
-		size_t max_request_sz,
-		struct ctf_msg_iter_medium_ops medops, void *data,
-		bt_logging_level log_level,
-		bt_self_component *self_comp,
-		bt_self_message_iterator *self_msg_iter)
+/*
+ * Creates a BFCR of which the user functions fill the fields of
+ * `msg_it`.
+ */
+static
+struct bt_bfcr *create_bfcr(struct ctf_msg_iter *msg_it)
 {
-	struct ctf_msg_iter *msg_it = NULL;
 	struct bt_bfcr_cbs cbs = {
 		.classes = {
 			.signed_int = bfcr_signed_int_cb,
@@ -2772,6 +3080,7 @@ struct ctf_msg_iter *ctf_msg_iter_create(
 			.string_end = bfcr_string_end_cb,
 			.compound_begin = bfcr_compound_begin_cb,
 			.compound_end = bfcr_compound_end_cb,
+			.numeric_array = bfcr_numeric_array_cb,
 		},
 		.query = {
 			.get_sequence_length = bfcr_get_sequence_length_cb,
@@ -2779,6 +3088,20 @@ struct ctf_msg_iter *ctf_msg_iter_create(
 		},
 	};
 
+	return bt_bfcr_create(cbs, msg_it, msg_it->log_level, NULL);
+}
+
+BT_HIDDEN
+struct ctf_msg_iter *ctf_msg_iter_create(
+		struct ctf_trace_class *tc,
+		size_t max_request_sz,
+		struct ctf_msg_iter_medium_ops medops, void *data,
+		bt_logging_level log_level,
+		bt_self_component *self_comp,
+		bt_self_message_iterator *self_msg_iter)
+{
+	struct ctf_msg_iter *msg_it = NULL;
+
 	BT_ASSERT(tc);
 	BT_ASSERT(medops.request_bytes);
 	BT_ASSERT(medops.borrow_stream);
@@ -2805,6 +3128,9 @@ struct ctf_msg_iter *ctf_msg_iter_create(
 	msg_it->stack = stack_new(msg_it);
 	msg_it->stored_values = g_array_new(FALSE, TRUE, sizeof(uint64_t));
 	g_array_set_size(msg_it->stored_values, tc->stored_value_count);
+	msg_it->numeric_array_values = g_array_new(FALSE, FALSE,
+		sizeof(uint64_t));
+	msg_it->lazy_payload.data = g_byte_array_new();
 
 	if (!msg_it->stack) {
 		BT_COMP_LOGE_APPEND_CAUSE(self_comp,
@@ -2812,7 +3138,7 @@ struct ctf_msg_iter *ctf_msg_iter_create(
 		goto error;
 	}
 
-	msg_it->bfcr = bt_bfcr_create(cbs, msg_it, log_level, NULL);
+	msg_it->bfcr = create_bfcr(msg_it);
 	if (!msg_it->bfcr) {
 		BT_COMP_LOGE_APPEND_CAUSE(self_comp,
 			"Failed to create binary class reader (BFCR).");
@@ -2858,9 +3184,176 @@ void ctf_msg_iter_destroy(struct ctf_msg_iter *msg_it)
 		g_array_free(msg_it->stored_values, TRUE);
 	}
 
+	if (msg_it->numeric_array_values) {
+		g_array_free(msg_it->numeric_array_values, TRUE);
+	}
+
+	if (msg_it->ec_filter_results) {
+		g_hash_table_destroy(msg_it->ec_filter_results);
+	}
+
+	if (msg_it->lazy_payload.data) {
+		g_byte_array_free(msg_it->lazy_payload.data, TRUE);
+	}
+
 	g_free(msg_it);
 }
 
+/*
+ * Fills the event payload field `payload_field` from the copied event
+ * payload field `user_data` (`struct lazy_event_payload *`).
+ *
+ * This function decodes the payload field with a temporary message
+ * iterator which only has what the BFCR user functions need: the
+ * message iterator which copied the payload field could be finalized,
+ * or decoding the next event in another thread. This temporary message
+ * iterator has no component as the component could also be finalized.
+ *
+ * defer_event_payload_decoding() copied the payload field after having
+ * successfully decoded it with the same field class and stored values,
+ * so that this function only fails when out of memory.
+ */
+static
+bt_event_payload_field_materialize_func_status materialize_lazy_event_payload(
+		bt_field *payload_field, void *user_data)
+{
+	bt_event_payload_field_materialize_func_status status =
+		BT_EVENT_PAYLOAD_FIELD_MATERIALIZE_FUNC_STATUS_OK;
+	const struct lazy_event_payload *lazy = user_data;
+	bt_logging_level log_level = lazy->log_level;
+	struct ctf_msg_iter *msg_it;
+	enum bt_bfcr_status bfcr_status;
+
+	BT_COMP_LOG_CUR_LVL(BT_LOG_DEBUG, log_level, NULL,
+		"Decoding deferred event payload field: "
+		"event-class-addr=%p, event-class-name=\"%s\", "
+		"event-class-id=%" PRId64 ", packet-offset=%zu, size=%zu",
+		lazy->ec, lazy->ec->name->str, lazy->ec->id,
+		lazy->packet_offset, lazy->data_size);
+	msg_it = g_new0(struct ctf_msg_iter, 1);
+	if (!msg_it) {
+		BT_COMP_LOG_CUR_LVL(BT_LOG_ERROR, log_level, NULL,
+			"Failed to allocate one CTF plugin message iterator.");
+		(void) BT_CURRENT_THREAD_ERROR_APPEND_CAUSE_FROM_UNKNOWN(
+			BT_LOG_TAG,
+			"Failed to allocate one CTF plugin message iterator.");
+		status = BT_EVENT_PAYLOAD_FIELD_MATERIALIZE_FUNC_STATUS_MEMORY_ERROR;
+		goto end;
+	}
+
+	msg_it->log_level = log_level;
+	msg_it->meta.ec = lazy->ec;
+	msg_it->stack = stack_new(msg_it);
+	msg_it->stored_values = g_array_sized_new(FALSE, FALSE,
+		sizeof(uint64_t), lazy->stored_value_count);
+	msg_it->numeric_array_values = g_array_new(FALSE, FALSE,
+		sizeof(uint64_t));
+	msg_it->bfcr = create_bfcr(msg_it);
+	if (!msg_it->stack || !msg_it->stored_values ||
+			!msg_it->numeric_array_values || !msg_it->bfcr) {
+		MSG_IT_LOGE_APPEND_CAUSE(msg_it,
+			"Failed to create the state of a CTF plugin message iterator.");
+		status = BT_EVENT_PAYLOAD_FIELD_MATERIALIZE_FUNC_STATUS_MEMORY_ERROR;
+		goto end;
+	}
+
+	g_array_append_vals(msg_it->stored_values, lazy->stored_values,
+		lazy->stored_value_count);
+	msg_it->cur_dscope_field = payload_field;
+	bt_bfcr_start(msg_it->bfcr, lazy->ec->payload_fc, lazy->data,
+		lazy->offset, lazy->packet_offset, lazy->data_size,
+		&bfcr_status);
+	if (bfcr_status != BT_BFCR_STATUS_OK) {
+		/* Only a field allocation can fail (see comment above) */
+		BT_ASSERT(bfcr_status == BT_BFCR_STATUS_ERROR);
+		MSG_IT_LOGE_APPEND_CAUSE(msg_it,
+			"Cannot decode deferred event payload field: "
+			"event-class-addr=%p, event-class-name=\"%s\", "
+			"event-class-id=%" PRId64 ", status=%s",
+			lazy->ec, lazy->ec->name->str, lazy->ec->id,
+			bt_bfcr_status_string(bfcr_status));
+		status = BT_EVENT_PAYLOAD_FIELD_MATERIALIZE_FUNC_STATUS_MEMORY_ERROR;
+		goto end;
+	}
+
+end:
+	if (msg_it) {
+		ctf_msg_iter_destroy(msg_it);
+	}
+
+	return status;
+}
+
+/*
+ * Destroys the copied event payload field `user_data`
+ * (`struct lazy_event_payload *`).
+ */
+static
+void destroy_lazy_event_payload(void *user_data)
+{
+	struct lazy_event_payload *lazy = user_data;
+
+	ctf_trace_class_put_ref(lazy->tc);
+	g_free(lazy);
+}
+
+/*
+ * Copies the current event payload field, of which the decoding is
+ * deferred, and makes the current event decode it on its first access
+ * with materialize_lazy_event_payload().
+ *
+ * While copying the payload field, the BFCR decoded it without
+ * creating library fields (see skip_ir_objects()): this validated
+ * what materialize_lazy_event_payload() depends on (the size of the
+ * payload field, its sequence lengths, and its variant options), so
+ * that decoding errors occur here, when the message iterator can still
+ * report them, rather than on the first access of the payload field.
+ */
+static
+enum ctf_msg_iter_status defer_event_payload_decoding(
+		struct ctf_msg_iter *msg_it)
+{
+	enum ctf_msg_iter_status status = CTF_MSG_ITER_STATUS_OK;
+	bt_self_component *self_comp = msg_it->self_comp;
+	const size_t stored_values_size =
+		msg_it->stored_values->len * sizeof(uint64_t);
+	struct lazy_event_payload *lazy;
+	uint8_t *addr;
+
+	msg_it->lazy_payload.active = false;
+	lazy = g_malloc(sizeof(*lazy) + stored_values_size +
+		msg_it->lazy_payload.data->len);
+	if (!lazy) {
+		BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+			"Failed to allocate a deferred event payload field: "
+			"msg-it-addr=%p, size=%u",
+			msg_it, msg_it->lazy_payload.data->len);
+		status = CTF_MSG_ITER_STATUS_MEMORY_ERROR;
+		goto end;
+	}
+
+	lazy->tc = ctf_trace_class_get_ref(msg_it->meta.tc);
+	lazy->ec = msg_it->meta.ec;
+	lazy->log_level = msg_it->log_level;
+	lazy->packet_offset = msg_it->lazy_payload.packet_offset;
+	lazy->offset = msg_it->lazy_payload.offset;
+	addr = (uint8_t *) (lazy + 1);
+	memcpy(addr, msg_it->stored_values->data, stored_values_size);
+	lazy->stored_values = (const uint64_t *) addr;
+	lazy->stored_value_count = msg_it->stored_values->len;
+	addr += stored_values_size;
+	memcpy(addr, msg_it->lazy_payload.data->data,
+		msg_it->lazy_payload.data->len);
+	lazy->data = addr;
+	lazy->data_size = msg_it->lazy_payload.data->len;
+	bt_event_set_payload_field_materialize_func(msg_it->event,
+		materialize_lazy_event_payload, destroy_lazy_event_payload,
+		lazy);
+
+end:
+	return status;
+}
+
 enum ctf_msg_iter_status ctf_msg_iter_get_next_message(
 		struct ctf_msg_iter *msg_it,
 		const bt_message **message)
@@ -2886,8 +3379,21 @@ enum ctf_msg_iter_status ctf_msg_iter_get_next_message(
 
 		switch (msg_it->state) {
 		case STATE_EMIT_MSG_EVENT:
+			if (G_UNLIKELY(msg_it->skip_cur_event)) {
+				/* Filtered out event: continue with the next one */
+				msg_it->skip_cur_event = false;
+				break;
+			}
+
 			BT_ASSERT_DBG(msg_it->event_msg);
 
+			if (msg_it->lazy_payload.active) {
+				status = defer_event_payload_decoding(msg_it);
+				if (status != CTF_MSG_ITER_STATUS_OK) {
+					goto end;
+				}
+			}
+
 			/*
 			 * Check if we need to emit the delayed packet
 			 * beginning message instead of the event message.
@@ -3116,6 +3622,28 @@ end:
 	return status;
 }
 
+BT_HIDDEN
+void ctf_msg_iter_skip_current_packet(struct ctf_msg_iter *msg_it)
+{
+	BT_ASSERT(msg_it);
+	BT_ASSERT(msg_it->medium.medops.switch_packet);
+
+	/*
+	 * ctf_msg_iter_get_packet_properties() stops decoding right
+	 * before emitting the packet beginning message.
+	 */
+	BT_ASSERT(msg_it->state == STATE_EMIT_MSG_PACKET_BEGINNING);
+	BT_COMP_LOGD("Skipping current packet: msg-it-addr=%p, "
+		"packet-offset=%" PRId64, msg_it, msg_it->cur_packet_offset);
+
+	/*
+	 * switch_packet_state() keeps the current packet's snapshots as
+	 * the previous packet's snapshots and asks the medium for the
+	 * next packet.
+	 */
+	msg_it->state = STATE_SWITCH_PACKET;
+}
+
 static
 enum ctf_msg_iter_status clock_snapshot_at_msg_iter_state(
 		struct ctf_msg_iter *msg_it, enum state target_state_1,
@@ -3185,3 +3713,118 @@ void ctf_msg_iter_set_dry_run(struct ctf_msg_iter *msg_it,
 {
 	msg_it->dry_run = val;
 }
+
+BT_HIDDEN
+void ctf_msg_iter_set_lazy_event_payloads(struct ctf_msg_iter *msg_it,
+		bool lazy_event_payloads)
+{
+	msg_it->lazy_event_payloads = lazy_event_payloads;
+}
+
+BT_HIDDEN
+struct ctf_msg_iter_event_class_filter *ctf_msg_iter_event_class_filter_create(
+		const bt_value *names_value, const bt_value *ids_value)
+{
+	struct ctf_msg_iter_event_class_filter *filter;
+	uint64_t i;
+
+	filter = g_new0(struct ctf_msg_iter_event_class_filter, 1);
+	if (!filter) {
+		goto error;
+	}
+
+	filter->names = g_hash_table_new_full(g_str_hash, g_str_equal,
+		g_free, NULL);
+	if (!filter->names) {
+		goto error;
+	}
+
+	filter->ids = g_hash_table_new_full(g_int64_hash, g_int64_equal,
+		g_free, NULL);
+	if (!filter->ids) {
+		goto error;
+	}
+
+	for (i = 0; names_value && i < bt_value_array_get_length(names_value);
+			i++) {
+		const bt_value *name_value =
+			bt_value_array_borrow_element_by_index_const(
+				names_value, i);
+		gchar *name = g_strdup(bt_value_string_get(name_value));
+
+		g_hash_table_replace(filter->names, name, name);
+	}
+
+	for (i = 0; ids_value && i < bt_value_array_get_length(ids_value);
+			i++) {
+		const bt_value *id_value =
+			bt_value_array_borrow_element_by_index_const(
+				ids_value, i);
+		gint64 *id = g_new(gint64, 1);
+
+		if (!id) {
+			goto error;
+		}
+
+		*id = (gint64) bt_value_integer_unsigned_get(id_value);
+		g_hash_table_replace(filter->ids, id, id);
+	}
+
+	goto end;
+
+error:
+	ctf_msg_iter_event_class_filter_destroy(filter);
+	filter = NULL;
+
+end:
+	return filter;
+}
+
+BT_HIDDEN
+void ctf_msg_iter_event_class_filter_destroy(
+		struct ctf_msg_iter_event_class_filter *filter)
+{
+	if (!filter) {
+		return;
+	}
+
+	if (filter->names) {
+		g_hash_table_destroy(filter->names);
+	}
+
+	if (filter->ids) {
+		g_hash_table_destroy(filter->ids);
+	}
+
+	g_free(filter);
+}
+
+BT_HIDDEN
+int ctf_msg_iter_set_event_class_filter(struct ctf_msg_iter *msg_it,
+		const struct ctf_msg_iter_event_class_filter *filter)
+{
+	int ret = 0;
+	bt_self_component *self_comp = msg_it->self_comp;
+
+	BT_ASSERT(msg_it);
+
+	if (msg_it->ec_filter_results) {
+		g_hash_table_destroy(msg_it->ec_filter_results);
+		msg_it->ec_filter_results = NULL;
+	}
+
+	msg_it->ec_filter = filter;
+
+	if (filter) {
+		msg_it->ec_filter_results = g_hash_table_new(g_direct_hash,
+			g_direct_equal);
+		if (!msg_it->ec_filter_results) {
+			BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+				"Failed to allocate a GHashTable.");
+			msg_it->ec_filter = NULL;
+			ret = -1;
+		}
+	}
+
+	return ret;
+}
@@ -203,6 +203,40 @@ struct ctf_msg_iter_medium_ops {
 	 */
 	bt_stream * (* borrow_stream)(bt_stream_class *stream_class,
 			int64_t stream_id, void *data);
+
+	/**
+	 * Called when the message iterator creates the packet object
+	 * of the current packet, before it creates the corresponding
+	 * packet beginning message.
+	 *
+	 * This *optional* method lets the medium attach data to the
+	 * packet, for example with bt_packet_set_raw_data().
+	 *
+	 * @param packet	New packet (weak reference)
+	 * @param data		User data
+	 * @returns		One of #ctf_msg_iter_medium_status values
+	 */
+	enum ctf_msg_iter_medium_status (* packet_created)(bt_packet *packet,
+			void *data);
+
+	/**
+	 * Called when the message iterator is done decoding the
+	 * current packet, before it creates the corresponding packet
+	 * end message.
+	 *
+	 * This *optional* method lets the medium complete the data
+	 * which it attached to the packet with
+	 * ctf_msg_iter_medium_ops::packet_created().
+	 *
+	 * @param packet	Ending packet (weak reference)
+	 * @param event_count	Number of events of the packet,
+	 *			including the ones which the event
+	 *			class filter filters out
+	 * @param data		User data
+	 * @returns		One of #ctf_msg_iter_medium_status values
+	 */
+	enum ctf_msg_iter_medium_status (* packet_ended)(bt_packet *packet,
+			uint64_t event_count, void *data);
 };
 
 /** CTF message iterator. */
@@ -297,6 +331,20 @@ BT_HIDDEN
 enum ctf_msg_iter_status ctf_msg_iter_seek(
 		struct ctf_msg_iter *msg_it, off_t offset);
 
+/*
+ * Skips the rest of the current packet, of which the header and context
+ * fields were read with ctf_msg_iter_get_packet_properties(), without
+ * emitting any of its messages.
+ *
+ * The skipped packet's properties still act as the previous packet's
+ * properties to compute the discarded events and packets messages of
+ * the next packet.
+ *
+ * The iterator's medium must implement the `switch_packet` operation.
+ */
+BT_HIDDEN
+void ctf_msg_iter_skip_current_packet(struct ctf_msg_iter *msg_it);
+
 /*
  * Resets the iterator so that the next requested medium bytes are
  * assumed to be the first bytes of a new stream. Depending on
@@ -317,6 +365,63 @@ BT_HIDDEN
 void ctf_msg_iter_set_dry_run(struct ctf_msg_iter *msg_it,
 		bool val);
 
+/*
+ * Sets whether or not `msg_it` defers the decoding of the payload
+ * fields of the events it emits to their first access.
+ *
+ * In this mode, `msg_it` decodes the event payload fields without
+ * creating any library object, like for an event which the event class
+ * filter filters out, and copies their bytes: the library calls back
+ * the CTF message iterator to fill an event payload field from its
+ * copied bytes when bt_event_borrow_payload_field() or
+ * bt_event_borrow_payload_field_const() borrows it.
+ *
+ * The CTF trace class of `msg_it` must exist as long as any event
+ * which `msg_it` creates exists.
+ */
+BT_HIDDEN
+void ctf_msg_iter_set_lazy_event_payloads(struct ctf_msg_iter *msg_it,
+		bool lazy_event_payloads);
+
+/*
+ * Set of event classes, by name or by ID (within their stream class),
+ * of which a CTF message iterator emits the event messages.
+ */
+struct ctf_msg_iter_event_class_filter;
+
+/*
+ * Creates an event class filter which keeps the event classes of
+ * which the name is an element of the array value of strings
+ * `names_value`, or of which the ID is an element of the array value of
+ * unsigned integers `ids_value`.
+ *
+ * `names_value` and `ids_value` may be `NULL` (empty set).
+ *
+ * Returns `NULL` on memory error.
+ */
+BT_HIDDEN
+struct ctf_msg_iter_event_class_filter *ctf_msg_iter_event_class_filter_create(
+		const bt_value *names_value, const bt_value *ids_value);
+
+BT_HIDDEN
+void ctf_msg_iter_event_class_filter_destroy(
+		struct ctf_msg_iter_event_class_filter *filter);
+
+/*
+ * Sets the event class filter of `msg_it` to `filter` (weak: `filter`
+ * must exist as long as `msg_it` exists).
+ *
+ * `msg_it` decodes the events of the other event classes without
+ * creating any library object: it only reads what it needs to find
+ * the next event (field lengths, sequence lengths, variant tags, and
+ * clock values) and doesn't emit their messages.
+ *
+ * Returns 0 on success, or a negative value on memory error.
+ */
+BT_HIDDEN
+int ctf_msg_iter_set_event_class_filter(struct ctf_msg_iter *msg_it,
+		const struct ctf_msg_iter_event_class_filter *filter);
+
 static inline
 const char *ctf_msg_iter_medium_status_string(
 		enum ctf_msg_iter_medium_status status)
@@ -0,0 +1,208 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (C) 2023 EfficiOS Inc.
+ */
+
+#ifndef CTF_RAW_PACKET_H
+#define CTF_RAW_PACKET_H
+
+#include <glib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <babeltrace2/babeltrace.h>
+
+/*
+ * Name of the format of the raw data (see bt_packet_set_raw_data())
+ * which src.ctf.fs attaches to its packets and which sink.ctf.fs can
+ * copy verbatim.
+ */
+#define CTF_RAW_PACKET_FORMAT	"ctf-1.8-file-range"
+
+/*
+ * Plain text metadata (TSDL) shared by the raw packets of a trace.
+ *
+ * The reference count is atomic: raw packets can be destroyed from
+ * any thread.
+ */
+struct ctf_raw_packet_metadata {
+	gint ref_count;
+
+	/* Owned by this */
+	gchar *text;
+
+	/* Length (bytes) of `text`, excluding its null character */
+	gsize len;
+};
+
+/*
+ * Creates raw packet metadata from a copy of `text` with an initial
+ * reference count of 1.
+ *
+ * Returns `NULL` on memory error.
+ */
+static inline
+struct ctf_raw_packet_metadata *ctf_raw_packet_metadata_create(
+		const char *text)
+{
+	struct ctf_raw_packet_metadata *metadata =
+		g_new0(struct ctf_raw_packet_metadata, 1);
+
+	if (!metadata) {
+		goto end;
+	}
+
+	metadata->text = g_strdup(text);
+	if (!metadata->text) {
+		g_free(metadata);
+		metadata = NULL;
+		goto end;
+	}
+
+	metadata->len = strlen(text);
+	metadata->ref_count = 1;
+
+end:
+	return metadata;
+}
+
+static inline
+struct ctf_raw_packet_metadata *ctf_raw_packet_metadata_get_ref(
+		struct ctf_raw_packet_metadata *metadata)
+{
+	g_atomic_int_inc(&metadata->ref_count);
+	return metadata;
+}
+
+static inline
+void ctf_raw_packet_metadata_put_ref(struct ctf_raw_packet_metadata *metadata)
+{
+	if (!metadata) {
+		return;
+	}
+
+	if (g_atomic_int_dec_and_test(&metadata->ref_count)) {
+		g_free(metadata->text);
+		g_free(metadata);
+	}
+}
+
+/*
+ * Returns whether or not the raw packet metadata `a` and `b` have the
+ * same text.
+ */
+static inline
+bool ctf_raw_packet_metadata_equal(const struct ctf_raw_packet_metadata *a,
+		const struct ctf_raw_packet_metadata *b)
+{
+	return a == b ||
+		(a->len == b->len && memcmp(a->text, b->text, a->len) == 0);
+}
+
+/*
+ * Location of the original bytes of a CTF packet.
+ *
+ * A raw packet doesn't refer to any state of the source component: it
+ * can outlive its message iterator.
+ */
+struct ctf_raw_packet {
+	/*
+	 * Plain text metadata (TSDL) of the packet's trace, owned
+	 * reference.
+	 *
+	 * Two raw packets with the same metadata text have compatible
+	 * layouts.
+	 */
+	struct ctf_raw_packet_metadata *metadata;
+
+	/* Path of the data stream file which contains the packet */
+	gchar *path;
+
+	/* Offset (bytes) of the packet within the file at `path` */
+	uint64_t offset;
+
+	/* Total size (bytes) of the packet, including its padding */
+	uint64_t size;
+
+	/*
+	 * Number of events which the packet contains, or
+	 * `UINT64_C(-1)` if unknown.
+	 *
+	 * The source sets it once it decoded the whole packet, before
+	 * it creates its packet end message. A sink which receives
+	 * fewer event messages for the packet must not copy it: some
+	 * of its events were removed upstream.
+	 */
+	uint64_t event_count;
+};
+
+static inline
+void ctf_raw_packet_destroy(void *data)
+{
+	struct ctf_raw_packet *raw_packet = data;
+
+	if (!raw_packet) {
+		return;
+	}
+
+	ctf_raw_packet_metadata_put_ref(raw_packet->metadata);
+	g_free(raw_packet->path);
+	g_free(raw_packet);
+}
+
+/*
+ * Creates a raw packet, getting a reference on `metadata`.
+ *
+ * Returns `NULL` on memory error.
+ */
+static inline
+struct ctf_raw_packet *ctf_raw_packet_create(
+		struct ctf_raw_packet_metadata *metadata,
+		const char *path, uint64_t offset, uint64_t size)
+{
+	struct ctf_raw_packet *raw_packet = g_new0(struct ctf_raw_packet, 1);
+
+	if (!raw_packet) {
+		goto end;
+	}
+
+	raw_packet->metadata = ctf_raw_packet_metadata_get_ref(metadata);
+	raw_packet->path = g_strdup(path);
+	if (!raw_packet->path) {
+		ctf_raw_packet_destroy(raw_packet);
+		raw_packet = NULL;
+		goto end;
+	}
+
+	raw_packet->offset = offset;
+	raw_packet->size = size;
+	raw_packet->event_count = UINT64_C(-1);
+
+end:
+	return raw_packet;
+}
+
+/*
+ * Returns whether or not a sink received all the events of the packet
+ * of `raw_packet`, having received `event_count` event messages for it.
+ */
+static inline
+bool ctf_raw_packet_is_complete(const struct ctf_raw_packet *raw_packet,
+		uint64_t event_count)
+{
+	return raw_packet->event_count != UINT64_C(-1) &&
+		raw_packet->event_count == event_count;
+}
+
+/*
+ * Borrows the raw packet which src.ctf.fs attached to `packet`, or
+ * returns `NULL` if there's none.
+ */
+static inline
+const struct ctf_raw_packet *ctf_raw_packet_borrow(const bt_packet *packet)
+{
+	return bt_packet_borrow_raw_data_const(packet, CTF_RAW_PACKET_FORMAT);
+}
+
+#endif /* CTF_RAW_PACKET_H */
@@ -71,11 +71,111 @@ struct fs_sink_ctf_named_field_class {
 	struct fs_sink_ctf_field_class *fc;
 };
 
+/*
+ * Type of a step of a structure field serialization plan.
+ */
+enum fs_sink_ctf_ser_plan_op_type {
+	/*
+	 * Run of consecutive byte-aligned scalar members which have
+	 * fixed offsets from the beginning of the run.
+	 */
+	FS_SINK_CTF_SER_PLAN_OP_TYPE_RUN,
+
+	/* Any other member: generic serialization */
+	FS_SINK_CTF_SER_PLAN_OP_TYPE_FIELD,
+};
+
+/*
+ * Type of a member within a serialization plan run.
+ */
+enum fs_sink_ctf_ser_plan_item_type {
+	FS_SINK_CTF_SER_PLAN_ITEM_TYPE_BOOL,
+	FS_SINK_CTF_SER_PLAN_ITEM_TYPE_BIT_ARRAY,
+	FS_SINK_CTF_SER_PLAN_ITEM_TYPE_UNSIGNED_INT,
+	FS_SINK_CTF_SER_PLAN_ITEM_TYPE_SIGNED_INT,
+	FS_SINK_CTF_SER_PLAN_ITEM_TYPE_FLOAT32,
+	FS_SINK_CTF_SER_PLAN_ITEM_TYPE_FLOAT64,
+};
+
+/*
+ * Member within a serialization plan run.
+ */
+struct fs_sink_ctf_ser_plan_item {
+	enum fs_sink_ctf_ser_plan_item_type type;
+
+	/* Index of the member within its structure field */
+	uint64_t member_index;
+
+	/* Offset (bytes) of the member from the beginning of the run */
+	uint64_t offset;
+
+	/* Size (bytes) of the member: 1, 2, 4, or 8 */
+	unsigned int size;
+};
+
+/*
+ * Step of a structure field serialization plan.
+ */
+struct fs_sink_ctf_ser_plan_op {
+	enum fs_sink_ctf_ser_plan_op_type type;
+
+	union {
+		/* `FS_SINK_CTF_SER_PLAN_OP_TYPE_RUN` */
+		struct {
+			/* Alignment (bits) of the run */
+			unsigned int alignment;
+
+			/* Total size (bytes) of the run */
+			uint64_t size;
+
+			/*
+			 * Index, within the items of the plan, of
+			 * the run's first item.
+			 */
+			guint first_item_index;
+
+			guint item_count;
+		} run;
+
+		/* `FS_SINK_CTF_SER_PLAN_OP_TYPE_FIELD` */
+		struct {
+			/* Index of the member within its structure field */
+			uint64_t member_index;
+
+			/* Weak */
+			struct fs_sink_ctf_field_class *fc;
+		} field;
+	} u;
+};
+
+/*
+ * Serialization plan of a structure field class.
+ *
+ * Instead of dispatching on the class of each member field, a plan
+ * serializes each run of consecutive byte-aligned integer, boolean,
+ * and floating point number member fields with a single packet space
+ * check, writing their values at offsets which are known when
+ * translating the field class.
+ */
+struct fs_sink_ctf_ser_plan {
+	/* Array of `struct fs_sink_ctf_ser_plan_op` */
+	GArray *ops;
+
+	/* Array of `struct fs_sink_ctf_ser_plan_item` */
+	GArray *items;
+};
+
 struct fs_sink_ctf_field_class_struct {
 	struct fs_sink_ctf_field_class base;
 
 	/* Array of `struct fs_sink_ctf_named_field_class` */
 	GArray *members;
+
+	/*
+	 * Serialization plan, owned by this, or `NULL` to serialize
+	 * each member field generically.
+	 */
+	struct fs_sink_ctf_ser_plan *ser_plan;
 };
 
 struct fs_sink_ctf_field_class_option {
@@ -336,6 +436,42 @@ struct fs_sink_ctf_field_class_struct *fs_sink_ctf_field_class_struct_create_emp
 	return fc;
 }
 
+static inline
+struct fs_sink_ctf_ser_plan *fs_sink_ctf_ser_plan_create(void)
+{
+	struct fs_sink_ctf_ser_plan *plan =
+		g_new0(struct fs_sink_ctf_ser_plan, 1);
+
+	BT_ASSERT(plan);
+	plan->ops = g_array_new(FALSE, TRUE,
+		sizeof(struct fs_sink_ctf_ser_plan_op));
+	BT_ASSERT(plan->ops);
+	plan->items = g_array_new(FALSE, TRUE,
+		sizeof(struct fs_sink_ctf_ser_plan_item));
+	BT_ASSERT(plan->items);
+	return plan;
+}
+
+static inline
+void fs_sink_ctf_ser_plan_destroy(struct fs_sink_ctf_ser_plan *plan)
+{
+	if (!plan) {
+		return;
+	}
+
+	if (plan->ops) {
+		g_array_free(plan->ops, TRUE);
+		plan->ops = NULL;
+	}
+
+	if (plan->items) {
+		g_array_free(plan->items, TRUE);
+		plan->items = NULL;
+	}
+
+	g_free(plan);
+}
+
 static inline
 struct fs_sink_ctf_field_class_option *fs_sink_ctf_field_class_option_create_empty(
 		const bt_field_class *ir_fc, uint64_t index_in_parent)
@@ -491,6 +627,8 @@ void _fs_sink_ctf_field_class_struct_destroy(
 		fc->members = NULL;
 	}
 
+	fs_sink_ctf_ser_plan_destroy(fc->ser_plan);
+	fc->ser_plan = NULL;
 	g_free(fc);
 }
 
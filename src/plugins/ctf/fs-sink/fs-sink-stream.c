@@ -12,10 +12,13 @@
 #include <babeltrace2/babeltrace.h>
 #include <stdio.h>
 #include <stdbool.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <glib.h>
 #include "common/assert.h"
 #include "ctfser/ctfser.h"
 #include "compat/endian.h"
+#include "plugins/ctf/common/lttng-index.h"
 
 #include "fs-sink.h"
 #include "fs-sink-trace.h"
@@ -31,12 +34,31 @@ void fs_sink_stream_destroy(struct fs_sink_stream *stream)
 
 	bt_ctfser_fini(&stream->ctfser);
 
+	if (stream->index_fp) {
+		if (fclose(stream->index_fp) != 0) {
+			BT_COMP_LOGW_ERRNO("Cannot close index file",
+				": stream-file-name=%s",
+				stream->file_name->str);
+		}
+
+		stream->index_fp = NULL;
+	}
+
+	if (stream->raw_packet_file.fd >= 0) {
+		(void) close(stream->raw_packet_file.fd);
+		stream->raw_packet_file.fd = -1;
+	}
+
+	if (stream->raw_packet_file.path) {
+		g_string_free(stream->raw_packet_file.path, TRUE);
+		stream->raw_packet_file.path = NULL;
+	}
+
 	if (stream->file_name) {
 		g_string_free(stream->file_name, TRUE);
 		stream->file_name = NULL;
 	}
 
-	bt_packet_put_ref(stream->packet_state.packet);
 	g_free(stream);
 
 end:
@@ -104,8 +126,10 @@ GString *make_unique_stream_file_name(struct fs_sink_trace *trace,
 
 	BT_ASSERT(name);
 
-	while (stream_file_name_exists(trace, name->str) &&
-			strcmp(name->str, "metadata") == 0) {
+	/* `metadata` and `index` are reserved within a trace directory */
+	while (stream_file_name_exists(trace, name->str) ||
+			strcmp(name->str, "metadata") == 0 ||
+			strcmp(name->str, "index") == 0) {
 		g_string_printf(name, "%s-%u", san_base->str, suffix);
 		suffix++;
 	}
@@ -148,6 +172,7 @@ struct fs_sink_stream *fs_sink_stream_create(struct fs_sink_trace *trace,
 	stream->prev_packet_state.end_cs = UINT64_C(-1);
 	stream->prev_packet_state.discarded_events_counter = UINT64_C(-1);
 	stream->prev_packet_state.seq_num = UINT64_C(-1);
+	stream->raw_packet_file.fd = -1;
 	ret = try_translate_stream_class_trace_ir_to_ctf_ir(trace->fs_sink,
 		trace->trace, bt_stream_borrow_class_const(ir_stream),
 		&stream->sc);
@@ -155,10 +180,26 @@ struct fs_sink_stream *fs_sink_stream_create(struct fs_sink_trace *trace,
 		goto error;
 	}
 
+	stream->has_index = stream->sc->default_clock_class &&
+		stream->sc->packets_have_ts_begin &&
+		stream->sc->packets_have_ts_end;
 	set_stream_file_name(stream);
 	g_string_append_printf(path, "/%s", stream->file_name->str);
-	ret = bt_ctfser_init(&stream->ctfser, path->str,
-		stream->log_level);
+
+	if (trace->fs_sink->compress) {
+		/*
+		 * The file name (and therefore the index file name)
+		 * doesn't contain the suffix: a reader finds the
+		 * index file of `NAME.gz` at `index/NAME.idx`.
+		 */
+		g_string_append(path, FS_SINK_GZ_SUFFIX);
+		ret = bt_ctfser_init_gzip(&stream->ctfser, path->str,
+			stream->log_level);
+	} else {
+		ret = bt_ctfser_init(&stream->ctfser, path->str,
+			stream->log_level);
+	}
+
 	if (ret) {
 		goto error;
 	}
@@ -257,6 +298,101 @@ int write_string_field(struct fs_sink_stream *stream,
 		bt_field_string_get_value(field));
 }
 
+/*
+ * Writes the `size` (1, 2, 4, or 8) least significant bytes of `value`
+ * at `addr`, in the machine's native byte order.
+ */
+static inline
+void write_native_uint(uint8_t *addr, uint64_t value, unsigned int size)
+{
+	switch (size) {
+	case 1:
+	{
+		uint8_t v = (uint8_t) value;
+
+		memcpy(addr, &v, sizeof(v));
+		break;
+	}
+	case 2:
+	{
+		uint16_t v = (uint16_t) value;
+
+		memcpy(addr, &v, sizeof(v));
+		break;
+	}
+	case 4:
+	{
+		uint32_t v = (uint32_t) value;
+
+		memcpy(addr, &v, sizeof(v));
+		break;
+	}
+	case 8:
+		memcpy(addr, &value, sizeof(value));
+		break;
+	default:
+		bt_common_abort();
+	}
+}
+
+static inline
+uint64_t float32_bits(double value)
+{
+	union {
+		uint32_t u;
+		float f;
+	} u32f;
+
+	u32f.f = (float) value;
+	return (uint64_t) u32f.u;
+}
+
+static inline
+uint64_t float64_bits(double value)
+{
+	union {
+		uint64_t u;
+		double d;
+	} u64f;
+
+	u64f.d = value;
+	return u64f.u;
+}
+
+/*
+ * Returns whether or not the elements of an array field of which the
+ * element field class is `elem_fc` are contiguous native integers of
+ * 1, 2, 4, or 8 bytes, setting `*size` to their size (bytes) if so.
+ */
+static inline
+bool array_elems_are_contiguous(struct fs_sink_ctf_field_class *elem_fc,
+		unsigned int *size)
+{
+	bool is_contiguous = false;
+	unsigned int size_bits;
+
+	if (elem_fc->type != FS_SINK_CTF_FIELD_CLASS_TYPE_INT &&
+			elem_fc->type != FS_SINK_CTF_FIELD_CLASS_TYPE_FLOAT) {
+		goto end;
+	}
+
+	if (elem_fc->alignment != 8) {
+		goto end;
+	}
+
+	size_bits = ((struct fs_sink_ctf_field_class_bit_array *) elem_fc)->size;
+	if (size_bits != 8 && size_bits != 16 && size_bits != 32 &&
+			size_bits != 64) {
+		goto end;
+	}
+
+	*size = size_bits / 8;
+	is_contiguous = true;
+
+end:
+	return is_contiguous;
+}
+
 static inline
 int write_array_field_elements(struct fs_sink_stream *stream,
 		struct fs_sink_ctf_field_class_array_base *fc,
@@ -266,14 +402,138 @@ int write_array_field_elements(struct fs_sink_stream *stream,
 	uint64_t len = bt_field_array_get_length(field);
 	int ret = 0;
 
-	for (i = 0; i < len; i++) {
-		const bt_field *elem_field =
-			bt_field_array_borrow_element_field_by_index_const(
-				field, i);
-		ret = write_field(stream, fc->elem_fc, elem_field);
+	unsigned int elem_size;
+
+	if (len == 0) {
+		goto end;
+	}
+
+	if (array_elems_are_contiguous(fc->elem_fc, &elem_size)) {
+		uint8_t *addr;
+
+		/*
+		 * Elements are byte-aligned and have no padding between
+		 * them: reserve the space of the whole array at once.
+		 */
+		ret = bt_ctfser_reserve_bytes(&stream->ctfser, 8,
+			len * elem_size, &addr);
 		if (G_UNLIKELY(ret)) {
 			goto end;
 		}
+
+		if (fc->elem_fc->type == FS_SINK_CTF_FIELD_CLASS_TYPE_FLOAT) {
+			const double *values =
+				bt_field_array_borrow_real_element_values_const(
+					field);
+
+			for (i = 0; i < len; i++) {
+				write_native_uint(&addr[i * elem_size],
+					elem_size == 4 ? float32_bits(values[i]) :
+						float64_bits(values[i]),
+					elem_size);
+			}
+		} else if (((struct fs_sink_ctf_field_class_int *)
+				fc->elem_fc)->is_signed) {
+			const int64_t *values =
+				bt_field_array_borrow_signed_integer_element_values_const(
+					field);
+
+			for (i = 0; i < len; i++) {
+				write_native_uint(&addr[i * elem_size],
+					(uint64_t) values[i], elem_size);
+			}
+		} else {
+			const uint64_t *values =
+				bt_field_array_borrow_unsigned_integer_element_values_const(
+					field);
+
+			for (i = 0; i < len; i++) {
+				write_native_uint(&addr[i * elem_size],
+					values[i], elem_size);
+			}
+		}
+
+		goto end;
+	}
+
+	/*
+	 * Write the values of numeric elements directly: this avoids
+	 * borrowing (and creating) each element field.
+	 */
+	switch (fc->elem_fc->type) {
+	case FS_SINK_CTF_FIELD_CLASS_TYPE_INT:
+	{
+		struct fs_sink_ctf_field_class_int *int_fc =
+			(void *) fc->elem_fc;
+		unsigned int alignment = int_fc->base.base.alignment;
+		unsigned int size = int_fc->base.size;
+
+		if (int_fc->is_signed) {
+			const int64_t *values =
+				bt_field_array_borrow_signed_integer_element_values_const(
+					field);
+
+			for (i = 0; i < len; i++) {
+				ret = bt_ctfser_write_signed_int(
+					&stream->ctfser, values[i], alignment,
+					size, BYTE_ORDER);
+				if (G_UNLIKELY(ret)) {
+					goto end;
+				}
+			}
+		} else {
+			const uint64_t *values =
+				bt_field_array_borrow_unsigned_integer_element_values_const(
+					field);
+
+			for (i = 0; i < len; i++) {
+				ret = bt_ctfser_write_unsigned_int(
+					&stream->ctfser, values[i], alignment,
+					size, BYTE_ORDER);
+				if (G_UNLIKELY(ret)) {
+					goto end;
+				}
+			}
+		}
+
+		break;
+	}
+	case FS_SINK_CTF_FIELD_CLASS_TYPE_FLOAT:
+	{
+		struct fs_sink_ctf_field_class_float *float_fc =
+			(void *) fc->elem_fc;
+		unsigned int alignment = float_fc->base.base.alignment;
+		const double *values =
+			bt_field_array_borrow_real_element_values_const(field);
+
+		for (i = 0; i < len; i++) {
+			if (float_fc->base.size == 32) {
+				ret = bt_ctfser_write_float32(&stream->ctfser,
+					values[i], alignment, BYTE_ORDER);
+			} else {
+				ret = bt_ctfser_write_float64(&stream->ctfser,
+					values[i], alignment, BYTE_ORDER);
+			}
+
+			if (G_UNLIKELY(ret)) {
+				goto end;
+			}
+		}
+
+		break;
+	}
+	default:
+		for (i = 0; i < len; i++) {
+			const bt_field *elem_field =
+				bt_field_array_borrow_element_field_by_index_const(
+					field, i);
+			ret = write_field(stream, fc->elem_fc, elem_field);
+			if (G_UNLIKELY(ret)) {
+				goto end;
+			}
+		}
+
+		break;
 	}
 
 end:
@@ -301,6 +561,104 @@ end:
 	return ret;
 }
 
+/*
+ * Writes the member fields of the structure field `field` which a
+ * serialization plan run (`op`) covers.
+ */
+static inline
+int write_ser_plan_run(struct fs_sink_stream *stream,
+		struct fs_sink_ctf_ser_plan *plan,
+		struct fs_sink_ctf_ser_plan_op *op, const bt_field *field)
+{
+	int ret;
+	uint8_t *addr;
+	guint i;
+
+	/* Single packet space check for the whole run */
+	ret = bt_ctfser_reserve_bytes(&stream->ctfser, op->u.run.alignment,
+		op->u.run.size, &addr);
+	if (G_UNLIKELY(ret)) {
+		goto end;
+	}
+
+	for (i = 0; i < op->u.run.item_count; i++) {
+		struct fs_sink_ctf_ser_plan_item *item = &g_array_index(
+			plan->items, struct fs_sink_ctf_ser_plan_item,
+			op->u.run.first_item_index + i);
+		const bt_field *memb_field =
+			bt_field_structure_borrow_member_field_by_index_const(
+				field, item->member_index);
+		uint64_t value;
+
+		switch (item->type) {
+		case FS_SINK_CTF_SER_PLAN_ITEM_TYPE_BOOL:
+			value = bt_field_bool_get_value(memb_field) ? 1 : 0;
+			break;
+		case FS_SINK_CTF_SER_PLAN_ITEM_TYPE_BIT_ARRAY:
+			value = bt_field_bit_array_get_value_as_integer(
+				memb_field);
+			break;
+		case FS_SINK_CTF_SER_PLAN_ITEM_TYPE_UNSIGNED_INT:
+			value = bt_field_integer_unsigned_get_value(memb_field);
+			break;
+		case FS_SINK_CTF_SER_PLAN_ITEM_TYPE_SIGNED_INT:
+			value = (uint64_t) bt_field_integer_signed_get_value(
+				memb_field);
+			break;
+		case FS_SINK_CTF_SER_PLAN_ITEM_TYPE_FLOAT32:
+			value = float32_bits((double)
+				bt_field_real_single_precision_get_value(
+					memb_field));
+			break;
+		case FS_SINK_CTF_SER_PLAN_ITEM_TYPE_FLOAT64:
+			value = float64_bits(
+				bt_field_real_double_precision_get_value(
+					memb_field));
+			break;
+		default:
+			bt_common_abort();
+		}
+
+		write_native_uint(&addr[item->offset], value, item->size);
+	}
+
+end:
+	return ret;
+}
+
+static inline
+int write_struct_field_with_plan(struct fs_sink_stream *stream,
+		struct fs_sink_ctf_ser_plan *plan, const bt_field *field)
+{
+	int ret = 0;
+	guint i;
+
+	for (i = 0; i < plan->ops->len; i++) {
+		struct fs_sink_ctf_ser_plan_op *op = &g_array_index(plan->ops,
+			struct fs_sink_ctf_ser_plan_op, i);
+
+		switch (op->type) {
+		case FS_SINK_CTF_SER_PLAN_OP_TYPE_RUN:
+			ret = write_ser_plan_run(stream, plan, op, field);
+			break;
+		case FS_SINK_CTF_SER_PLAN_OP_TYPE_FIELD:
+			ret = write_field(stream, op->u.field.fc,
+				bt_field_structure_borrow_member_field_by_index_const(
+					field, op->u.field.member_index));
+			break;
+		default:
+			bt_common_abort();
+		}
+
+		if (G_UNLIKELY(ret)) {
+			goto end;
+		}
+	}
+
+end:
+	return ret;
+}
+
 static inline
 int write_struct_field(struct fs_sink_stream *stream,
 		struct fs_sink_ctf_field_class_struct *fc,
@@ -317,6 +675,12 @@ int write_struct_field(struct fs_sink_stream *stream,
 		}
 	}
 
+	if (fc->ser_plan) {
+		ret = write_struct_field_with_plan(stream, fc->ser_plan,
+			field);
+		goto end;
+	}
+
 	for (i = 0; i < fc->members->len; i++) {
 		const bt_field *memb_field =
 			bt_field_structure_borrow_member_field_by_index_const(
@@ -600,9 +964,7 @@ int fs_sink_stream_open_packet(struct fs_sink_stream *stream,
 	uint64_t i;
 
 	BT_ASSERT(!stream->packet_state.is_open);
-	bt_packet_put_ref(stream->packet_state.packet);
 	stream->packet_state.packet = packet;
-	bt_packet_get_ref(stream->packet_state.packet);
 	if (cs) {
 		stream->packet_state.beginning_cs =
 			bt_clock_snapshot_get_value(cs);
@@ -673,6 +1035,106 @@ end:
 	return ret;
 }
 
+/*
+ * Opens the LTTng index file of `stream` and writes its header.
+ */
+static
+int open_index_file(struct fs_sink_stream *stream)
+{
+	int ret = 0;
+	gchar *index_dir_path;
+	GString *index_path = NULL;
+	struct ctf_packet_index_file_hdr hdr;
+
+	BT_ASSERT(!stream->index_fp);
+	index_dir_path = g_build_filename(stream->trace->path->str, "index",
+		NULL);
+	BT_ASSERT(index_dir_path);
+	ret = g_mkdir_with_parents(index_dir_path, 0755);
+	if (ret) {
+		BT_COMP_LOGE_ERRNO("Cannot create index directory",
+			": path=\"%s\"", index_dir_path);
+		goto end;
+	}
+
+	index_path = g_string_new(index_dir_path);
+	BT_ASSERT(index_path);
+	g_string_append_printf(index_path, "/%s.idx", stream->file_name->str);
+	stream->index_fp = fopen(index_path->str, "wb");
+	if (!stream->index_fp) {
+		BT_COMP_LOGE_ERRNO("Cannot open index file for writing",
+			": path=\"%s\"", index_path->str);
+		ret = -1;
+		goto end;
+	}
+
+	hdr.magic = htobe32(CTF_INDEX_MAGIC);
+	hdr.index_major = htobe32(CTF_INDEX_MAJOR);
+	hdr.index_minor = htobe32(CTF_INDEX_MINOR);
+	hdr.packet_index_len = htobe32(sizeof(struct ctf_packet_index));
+	if (fwrite(&hdr, sizeof(hdr), 1, stream->index_fp) != 1) {
+		BT_COMP_LOGE_ERRNO("Cannot write index file header",
+			": path=\"%s\"", index_path->str);
+		ret = -1;
+		goto end;
+	}
+
+	BT_COMP_LOGD("Opened index file: path=\"%s\"", index_path->str);
+
+end:
+	g_free(index_dir_path);
+
+	if (index_path) {
+		g_string_free(index_path, TRUE);
+	}
+
+	return ret;
+}
+
+/*
+ * Appends the LTTng index entry of the current packet, of which the
+ * offset within the stream file is `offset_bytes`, to the index file
+ * of `stream`.
+ */
+static
+int write_index_entry(struct fs_sink_stream *stream, uint64_t offset_bytes)
+{
+	int ret = 0;
+	struct ctf_packet_index entry;
+
+	if (!stream->has_index) {
+		goto end;
+	}
+
+	if (!stream->index_fp) {
+		ret = open_index_file(stream);
+		if (ret) {
+			goto end;
+		}
+	}
+
+	entry.offset = htobe64(offset_bytes);
+	entry.packet_size = htobe64(stream->packet_state.total_size);
+	entry.content_size = htobe64(stream->packet_state.content_size);
+	entry.timestamp_begin = htobe64(stream->packet_state.beginning_cs);
+	entry.timestamp_end = htobe64(stream->packet_state.end_cs);
+	entry.events_discarded = htobe64(stream->sc->has_discarded_events ?
+		stream->packet_state.discarded_events_counter : 0);
+	entry.stream_id = htobe64(bt_stream_class_get_id(stream->sc->ir_sc));
+	entry.stream_instance_id = htobe64(bt_stream_get_id(stream->ir_stream));
+	entry.packet_seq_num = htobe64(stream->packet_state.seq_num);
+	if (fwrite(&entry, sizeof(entry), 1, stream->index_fp) != 1) {
+		BT_COMP_LOGE_ERRNO("Cannot write index file entry",
+			": stream-file-name=%s, offset-bytes=%" PRIu64,
+			stream->file_name->str, offset_bytes);
+		ret = -1;
+		goto end;
+	}
+
+end:
+	return ret;
+}
+
 BT_HIDDEN
 int fs_sink_stream_close_packet(struct fs_sink_stream *stream,
 		const bt_clock_snapshot *cs)
@@ -698,9 +1160,19 @@ int fs_sink_stream_close_packet(struct fs_sink_stream *stream,
 		goto end;
 	}
 
+	ret = write_index_entry(stream,
+		bt_ctfser_get_current_packet_offset_bytes(&stream->ctfser));
+	if (ret) {
+		goto end;
+	}
+
 	/* Close packet */
-	bt_ctfser_close_current_packet(&stream->ctfser,
+	ret = bt_ctfser_close_current_packet(&stream->ctfser,
 		stream->packet_state.total_size / 8);
+	if (ret) {
+		/* bt_ctfser_close_current_packet() logs errors */
+		goto end;
+	}
 
 	/* Partially copy current packet state to previous packet state */
 	stream->prev_packet_state.end_cs = stream->packet_state.end_cs;
@@ -717,7 +1189,99 @@ int fs_sink_stream_close_packet(struct fs_sink_stream *stream,
 	stream->packet_state.seq_num += 1;
 	stream->packet_state.context_offset_bits = 0;
 	stream->packet_state.is_open = false;
-	BT_PACKET_PUT_REF_AND_RESET(stream->packet_state.packet);
+	stream->packet_state.packet = NULL;
+
+end:
+	return ret;
+}
+
+BT_HIDDEN
+void fs_sink_stream_open_raw_packet(struct fs_sink_stream *stream,
+		const bt_packet *packet, const struct ctf_raw_packet *raw_packet)
+{
+	BT_ASSERT(!stream->packet_state.is_open);
+	BT_ASSERT(raw_packet);
+	stream->packet_state.packet = packet;
+	stream->packet_state.raw_packet = raw_packet;
+	stream->packet_state.is_open = true;
+}
+
+/*
+ * Opens the file of `raw_packet` if it's not the file of the previous
+ * raw packet.
+ */
+static
+int open_raw_packet_file(struct fs_sink_stream *stream,
+		const struct ctf_raw_packet *raw_packet)
+{
+	int ret = 0;
+
+	if (stream->raw_packet_file.path &&
+			strcmp(stream->raw_packet_file.path->str,
+				raw_packet->path) == 0) {
+		goto end;
+	}
+
+	if (stream->raw_packet_file.fd >= 0) {
+		(void) close(stream->raw_packet_file.fd);
+	}
+
+	stream->raw_packet_file.fd = open(raw_packet->path, O_RDONLY);
+	if (stream->raw_packet_file.fd < 0) {
+		BT_COMP_LOGE_ERRNO("Cannot open raw packet's file",
+			": path=\"%s\"", raw_packet->path);
+		ret = -1;
+
+		/* Not the file of the next raw packet anymore */
+		if (stream->raw_packet_file.path) {
+			g_string_free(stream->raw_packet_file.path, TRUE);
+			stream->raw_packet_file.path = NULL;
+		}
+
+		goto end;
+	}
+
+	if (!stream->raw_packet_file.path) {
+		stream->raw_packet_file.path = g_string_new(NULL);
+		BT_ASSERT(stream->raw_packet_file.path);
+	}
+
+	g_string_assign(stream->raw_packet_file.path, raw_packet->path);
+
+end:
+	return ret;
+}
+
+BT_HIDDEN
+int fs_sink_stream_close_raw_packet(struct fs_sink_stream *stream)
+{
+	const struct ctf_raw_packet *raw_packet =
+		stream->packet_state.raw_packet;
+	int ret;
+
+	BT_ASSERT(stream->packet_state.is_open);
+	BT_ASSERT(raw_packet);
+	ret = open_raw_packet_file(stream, raw_packet);
+	if (ret) {
+		goto end;
+	}
+
+	ret = bt_ctfser_write_raw_packet(&stream->ctfser,
+		stream->raw_packet_file.fd, (off_t) raw_packet->offset,
+		raw_packet->size);
+	if (ret) {
+		BT_COMP_LOGE("Cannot copy raw packet: "
+			"stream-file-name=%s, raw-packet-path=\"%s\", "
+			"raw-packet-offset=%" PRIu64 ", "
+			"raw-packet-size=%" PRIu64,
+			stream->file_name->str, raw_packet->path,
+			raw_packet->offset, raw_packet->size);
+		goto end;
+	}
+
+	stream->packet_state.raw_packet = NULL;
+	stream->packet_state.is_open = false;
+	stream->packet_state.packet = NULL;
 
 end:
 	return ret;
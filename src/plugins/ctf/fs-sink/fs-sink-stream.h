@@ -13,10 +13,13 @@
 #include <glib.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <stdio.h>
 
 #include "fs-sink-ctf-meta.h"
+#include "plugins/ctf/common/raw-packet.h"
 
 struct fs_sink_trace;
+struct fs_sink_writer;
 
 struct fs_sink_stream {
 	bt_logging_level log_level;
@@ -26,11 +29,37 @@ struct fs_sink_stream {
 	/* Stream's file name */
 	GString *file_name;
 
+	/*
+	 * True if this stream gets an LTTng index file (see
+	 * `plugins/ctf/common/lttng-index.h`), that is, if its packets
+	 * have beginning and end default clock snapshots.
+	 */
+	bool has_index;
+
+	/*
+	 * LTTng index file (`index/NAME.idx`, where `NAME` is the
+	 * stream's file name), or `NULL` if not opened yet.
+	 *
+	 * The component opens it when closing the first encoded
+	 * packet: raw packets (see fs_sink_stream_open_raw_packet())
+	 * don't get index entries.
+	 */
+	FILE *index_fp;
+
 	/* Weak */
 	const bt_stream *ir_stream;
 
 	struct fs_sink_ctf_stream_class *sc;
 
+	/*
+	 * Writer which handles the messages of this stream, or `NULL`
+	 * if the component handles them from ctf_fs_sink_consume()
+	 * directly.
+	 *
+	 * Weak: belongs to the component.
+	 */
+	struct fs_sink_writer *writer;
+
 	/* Current packet's state */
 	struct {
 		/*
@@ -80,12 +109,37 @@ struct fs_sink_stream {
 		uint64_t context_offset_bits;
 
 		/*
-		 * Owned by this; `NULL` if the current packet is closed
-		 * or if the trace IR stream does not support packets.
+		 * `NULL` if the current packet is closed or if the
+		 * trace IR stream does not support packets.
+		 *
+		 * Weak: this object only borrows the packet's context
+		 * field and raw packet while handling its packet
+		 * beginning and end messages, which keep it alive. This
+		 * also means that a writer thread (see
+		 * `struct fs_sink_writer`) never needs to change its
+		 * reference count.
 		 */
 		const bt_packet *packet;
+
+		/*
+		 * Raw packet of `packet` above to copy verbatim when
+		 * closing the current packet, or `NULL` to encode the
+		 * current packet.
+		 *
+		 * Weak: `packet` owns it.
+		 */
+		const struct ctf_raw_packet *raw_packet;
 	} packet_state;
 
+	/* File from which the last raw packet was copied */
+	struct {
+		/* `NULL` if none */
+		GString *path;
+
+		/* File descriptor of `path` (-1 if none) */
+		int fd;
+	} raw_packet_file;
+
 	/* Previous packet's state */
 	struct {
 		/* End default clock snapshot (`UINT64_C(-1)` if not set) */
@@ -176,4 +230,16 @@ BT_HIDDEN
 int fs_sink_stream_close_packet(struct fs_sink_stream *stream,
 		const bt_clock_snapshot *cs);
 
+/*
+ * Opens a packet of which the events are not encoded: closing it with
+ * fs_sink_stream_close_raw_packet() copies the original bytes which
+ * `raw_packet` locates to the stream file.
+ */
+BT_HIDDEN
+void fs_sink_stream_open_raw_packet(struct fs_sink_stream *stream,
+		const bt_packet *packet, const struct ctf_raw_packet *raw_packet);
+
+BT_HIDDEN
+int fs_sink_stream_close_raw_packet(struct fs_sink_stream *stream);
+
 #endif /* BABELTRACE_PLUGIN_CTF_FS_SINK_FS_SINK_STREAM_H */
@@ -12,7 +12,9 @@
 #include <babeltrace2/babeltrace.h>
 #include <stdio.h>
 #include <stdbool.h>
+#include <string.h>
 #include <glib.h>
+#include <zlib.h>
 #include "common/assert.h"
 #include "ctfser/ctfser.h"
 
@@ -467,6 +469,39 @@ end:
 	return unique_full_path;
 }
 
+/*
+ * Writes `tsdl` to the gzip-compressed metadata file of `trace`.
+ */
+static
+void write_gz_metadata_file(struct fs_sink_trace *trace, const GString *tsdl)
+{
+	gzFile fh = gzopen(trace->metadata_path->str, "wb");
+
+	if (!fh) {
+		BT_COMP_LOGF_ERRNO("In trace destruction listener: "
+			"cannot open metadata file for writing",
+			": path=\"%s\"", trace->metadata_path->str);
+		bt_common_abort();
+	}
+
+	if (tsdl->len > 0 &&
+			gzwrite(fh, tsdl->str, (unsigned int) tsdl->len) !=
+				(int) tsdl->len) {
+		BT_COMP_LOGF("In trace destruction listener: "
+			"cannot write metadata file: path=\"%s\"",
+			trace->metadata_path->str);
+		bt_common_abort();
+	}
+
+	/* Closing the file flushes the compressed metadata */
+	if (gzclose(fh) != Z_OK) {
+		BT_COMP_LOGF("In trace destruction listener: "
+			"cannot close metadata file: path=\"%s\"",
+			trace->metadata_path->str);
+		bt_common_abort();
+	}
+}
+
 BT_HIDDEN
 void fs_sink_trace_destroy(struct fs_sink_trace *trace)
 {
@@ -489,6 +524,25 @@ void fs_sink_trace_destroy(struct fs_sink_trace *trace)
 		trace->ir_trace_destruction_listener_id = UINT64_C(-1);
 	}
 
+	if (trace->pending_msgs) {
+		/*
+		 * The component is being finalized before it decided
+		 * whether or not this trace copies raw packets.
+		 */
+		while (!g_queue_is_empty(trace->pending_msgs)) {
+			bt_message_put_ref(
+				g_queue_pop_head(trace->pending_msgs));
+		}
+
+		g_queue_free(trace->pending_msgs);
+		trace->pending_msgs = NULL;
+	}
+
+	if (trace->pending_packet_event_counts) {
+		g_hash_table_destroy(trace->pending_packet_event_counts);
+		trace->pending_packet_event_counts = NULL;
+	}
+
 	if (trace->streams) {
 		g_hash_table_destroy(trace->streams);
 		trace->streams = NULL;
@@ -496,23 +550,46 @@ void fs_sink_trace_destroy(struct fs_sink_trace *trace)
 
 	tsdl = g_string_new(NULL);
 	BT_ASSERT(tsdl);
-	translate_trace_ctf_ir_to_tsdl(trace->trace, tsdl);
 
-	BT_ASSERT(trace->metadata_path);
-	fh = fopen(trace->metadata_path->str, "wb");
-	if (!fh) {
-		BT_COMP_LOGF_ERRNO("In trace destruction listener: "
-			"cannot open metadata file for writing",
-			": path=\"%s\"", trace->metadata_path->str);
-		bt_common_abort();
+	if (trace->raw_packet_metadata) {
+		static const char signature[] = "/* CTF 1.8";
+		const char *text = trace->raw_packet_metadata->text;
+		gsize size = trace->raw_packet_metadata->len;
+
+		/* Plain text metadata starts with a signature */
+		if (size < sizeof(signature) - 1 ||
+				strncmp(text, signature,
+					sizeof(signature) - 1) != 0) {
+			g_string_assign(tsdl, "/* CTF 1.8 */\n\n");
+		}
+
+		g_string_append_len(tsdl, text, size);
+		ctf_raw_packet_metadata_put_ref(trace->raw_packet_metadata);
+		trace->raw_packet_metadata = NULL;
+	} else {
+		translate_trace_ctf_ir_to_tsdl(trace->trace, tsdl);
 	}
 
-	len = fwrite(tsdl->str, sizeof(*tsdl->str), tsdl->len, fh);
-	if (len != tsdl->len) {
-		BT_COMP_LOGF_ERRNO("In trace destruction listener: "
-			"cannot write metadata file",
-			": path=\"%s\"", trace->metadata_path->str);
-		bt_common_abort();
+	BT_ASSERT(trace->metadata_path);
+
+	if (trace->fs_sink->compress) {
+		write_gz_metadata_file(trace, tsdl);
+	} else {
+		fh = fopen(trace->metadata_path->str, "wb");
+		if (!fh) {
+			BT_COMP_LOGF_ERRNO("In trace destruction listener: "
+				"cannot open metadata file for writing",
+				": path=\"%s\"", trace->metadata_path->str);
+			bt_common_abort();
+		}
+
+		len = fwrite(tsdl->str, sizeof(*tsdl->str), tsdl->len, fh);
+		if (len != tsdl->len) {
+			BT_COMP_LOGF_ERRNO("In trace destruction listener: "
+				"cannot write metadata file",
+				": path=\"%s\"", trace->metadata_path->str);
+			bt_common_abort();
+		}
 	}
 
 	if (!trace->fs_sink->quiet) {
@@ -594,6 +671,10 @@ struct fs_sink_trace *fs_sink_trace_create(struct fs_sink_comp *fs_sink,
 	trace->metadata_path = g_string_new(trace->path->str);
 	BT_ASSERT(trace->metadata_path);
 	g_string_append(trace->metadata_path, "/metadata");
+	if (fs_sink->compress) {
+		g_string_append(trace->metadata_path, FS_SINK_GZ_SUFFIX);
+	}
+
 	trace->streams = g_hash_table_new_full(g_direct_hash, g_direct_equal,
 		NULL, (GDestroyNotify) fs_sink_stream_destroy);
 	BT_ASSERT(trace->streams);
@@ -14,6 +14,7 @@
 #include <stdint.h>
 
 #include "fs-sink-ctf-meta.h"
+#include "plugins/ctf/common/raw-packet.h"
 
 struct fs_sink_comp;
 
@@ -51,6 +52,57 @@ struct fs_sink_trace {
 	 * `struct fs_sink_stream *` (owned by hash table).
 	 */
 	GHashTable *streams;
+
+	/*
+	 * True once the component decided whether or not this trace
+	 * copies raw packets, setting `raw_packet_metadata` below.
+	 */
+	bool raw_packet_mode_is_set;
+
+	/*
+	 * Messages of this trace (owned references) which the component
+	 * holds back, from the beginning of its first packet when this
+	 * packet has a raw packet (see `struct ctf_raw_packet`), until
+	 * it decides whether or not it copies the packets of this trace
+	 * verbatim, or `NULL` if none.
+	 *
+	 * The component copies the packets of a trace only if all of
+	 * them have a raw packet with the same metadata and if it
+	 * received all their events. It decides to encode as soon as a
+	 * packet doesn't qualify, but it can only decide to copy once
+	 * it received all the messages of its upstream message
+	 * iterator: until then, it holds back the whole trace.
+	 */
+	GQueue *pending_msgs;
+
+	/*
+	 * Metadata of the raw packets of the messages of
+	 * `pending_msgs`.
+	 *
+	 * Weak: a raw packet of a message of `pending_msgs` owns it.
+	 */
+	struct ctf_raw_packet_metadata *pending_metadata;
+
+	/*
+	 * Hash table of `const bt_packet *` (weak: a message of
+	 * `pending_msgs` owns it) to `uint64_t *` (owned by hash table):
+	 * number of event messages of each open packet of
+	 * `pending_msgs`.
+	 */
+	GHashTable *pending_packet_event_counts;
+
+	/*
+	 * Metadata text of the raw packets (see `struct
+	 * ctf_raw_packet`) which this trace copies verbatim, or `NULL`
+	 * if this trace encodes its packets.
+	 *
+	 * If set, then this is the content of the `metadata` file
+	 * instead of the translation of the trace IR trace class, as
+	 * the copied packets follow the original layout.
+	 *
+	 * Owned by this.
+	 */
+	struct ctf_raw_packet_metadata *raw_packet_metadata;
 };
 
 BT_HIDDEN
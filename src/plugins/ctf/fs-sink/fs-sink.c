@@ -14,6 +14,7 @@
 #include <stdbool.h>
 #include <glib.h>
 #include "common/assert.h"
+#include "compat/glib.h"
 #include "ctfser/ctfser.h"
 #include "plugins/common/param-validation/param-validation.h"
 
@@ -52,9 +53,12 @@ end:
 static struct bt_param_validation_map_value_entry_descr fs_sink_params_descr[] = {
 	{ "path", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_MANDATORY, { .type = BT_VALUE_TYPE_STRING } },
 	{ "assume-single-trace", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_BOOL } },
+	{ "compress", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_BOOL } },
+	{ "copy-raw-packets", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_BOOL } },
 	{ "ignore-discarded-events", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_BOOL } },
 	{ "ignore-discarded-packets", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_BOOL } },
 	{ "quiet", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_BOOL } },
+	{ "writer-thread-count", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_UNSIGNED_INTEGER } },
 	BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_END
 };
 
@@ -89,6 +93,18 @@ configure_component(struct fs_sink_comp *fs_sink, const bt_value *params)
 		fs_sink->assume_single_trace = (bool) bt_value_bool_get(value);
 	}
 
+	value = bt_value_map_borrow_entry_value_const(params,
+		"compress");
+	if (value) {
+		fs_sink->compress = (bool) bt_value_bool_get(value);
+	}
+
+	value = bt_value_map_borrow_entry_value_const(params,
+		"copy-raw-packets");
+	if (value) {
+		fs_sink->copy_raw_packets = (bool) bt_value_bool_get(value);
+	}
+
 	value = bt_value_map_borrow_entry_value_const(params,
 		"ignore-discarded-events");
 	if (value) {
@@ -109,6 +125,22 @@ configure_component(struct fs_sink_comp *fs_sink, const bt_value *params)
 		fs_sink->quiet = (bool) bt_value_bool_get(value);
 	}
 
+	value = bt_value_map_borrow_entry_value_const(params,
+		"writer-thread-count");
+	if (value) {
+		fs_sink->writer_thread_count =
+			bt_value_integer_unsigned_get(value);
+
+		if (fs_sink->writer_thread_count > G_MAXINT) {
+			BT_COMP_LOGE_APPEND_CAUSE(fs_sink->self_comp,
+				"Invalid `writer-thread-count` parameter: "
+				"value is too large: count=%" PRIu64,
+				fs_sink->writer_thread_count);
+			status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_ERROR;
+			goto end;
+		}
+	}
+
 	status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_OK;
 
 end:
@@ -116,6 +148,37 @@ end:
 	return status;
 }
 
+static
+void handle_writer_ops(gpointer data, gpointer user_data);
+
+static
+bt_component_class_sink_consume_method_status reclaim_all_writer_ops(
+		struct fs_sink_comp *fs_sink, bool wait);
+
+static
+void destroy_writer(struct fs_sink_writer *writer)
+{
+	if (!writer) {
+		goto end;
+	}
+
+	/* reclaim_all_writer_ops() released all the messages */
+	BT_ASSERT(writer->reclaimed_count == writer->pushed_count);
+
+	if (writer->error) {
+		bt_error_release(writer->error);
+		writer->error = NULL;
+	}
+
+	bt_g_cond_free(writer->cond);
+	bt_g_mutex_free(writer->lock);
+	g_free(writer->ops);
+	g_free(writer);
+
+end:
+	return;
+}
+
 static
 void destroy_fs_sink_comp(struct fs_sink_comp *fs_sink)
 {
@@ -123,6 +186,31 @@ void destroy_fs_sink_comp(struct fs_sink_comp *fs_sink)
 		goto end;
 	}
 
+	if (fs_sink->writers) {
+		/*
+		 * Let the writers write what they have, as if the
+		 * component wrote it from ctf_fs_sink_consume(), and
+		 * release the messages while the traces exist.
+		 */
+		if (reclaim_all_writer_ops(fs_sink, true) !=
+				BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_OK) {
+			BT_COMP_LOGW_STR("Writer failed while finalizing the component: "
+				"generated CTF traces could be incomplete.");
+			bt_current_thread_clear_error();
+		}
+	}
+
+	if (fs_sink->writer_thread_pool) {
+		/* There's no job left: wait for the threads */
+		g_thread_pool_free(fs_sink->writer_thread_pool, FALSE, TRUE);
+		fs_sink->writer_thread_pool = NULL;
+	}
+
+	if (fs_sink->writers) {
+		g_ptr_array_free(fs_sink->writers, TRUE);
+		fs_sink->writers = NULL;
+	}
+
 	if (fs_sink->output_dir_path) {
 		g_string_free(fs_sink->output_dir_path, TRUE);
 		fs_sink->output_dir_path = NULL;
@@ -141,6 +229,76 @@ end:
 	return;
 }
 
+static
+bt_component_class_initialize_method_status create_writers(
+		struct fs_sink_comp *fs_sink)
+{
+	bt_component_class_initialize_method_status status =
+		BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_OK;
+	GError *gerror = NULL;
+	uint64_t i;
+
+	if (fs_sink->writer_thread_count == 0) {
+		goto end;
+	}
+
+	fs_sink->writers = g_ptr_array_new_with_free_func(
+		(GDestroyNotify) destroy_writer);
+	if (!fs_sink->writers) {
+		BT_COMP_LOGE_APPEND_CAUSE(fs_sink->self_comp,
+			"Failed to allocate one GPtrArray.");
+		status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
+		goto end;
+	}
+
+	for (i = 0; i < fs_sink->writer_thread_count; i++) {
+		struct fs_sink_writer *writer = g_new0(struct fs_sink_writer, 1);
+
+		if (!writer) {
+			BT_COMP_LOGE_APPEND_CAUSE(fs_sink->self_comp,
+				"Failed to allocate one writer.");
+			status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
+			goto end;
+		}
+
+		g_ptr_array_add(fs_sink->writers, writer);
+		writer->fs_sink = fs_sink;
+		writer->status = BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_OK;
+		writer->ops = g_new0(struct fs_sink_writer_op,
+			FS_SINK_WRITER_OPS_CAPACITY);
+		writer->lock = bt_g_mutex_new();
+		writer->cond = bt_g_cond_new();
+		if (!writer->ops || !writer->lock || !writer->cond) {
+			BT_COMP_LOGE_APPEND_CAUSE(fs_sink->self_comp,
+				"Failed to allocate one writer.");
+			status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
+			goto end;
+		}
+	}
+
+	bt_g_thread_init();
+	fs_sink->writer_thread_pool = g_thread_pool_new(handle_writer_ops,
+		NULL, (gint) fs_sink->writer_thread_count, FALSE, &gerror);
+	if (!fs_sink->writer_thread_pool) {
+		BT_COMP_LOGE_APPEND_CAUSE(fs_sink->self_comp,
+			"Cannot create writer thread pool: %s",
+			gerror ? gerror->message : "unknown error");
+
+		if (gerror) {
+			g_error_free(gerror);
+		}
+
+		status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_ERROR;
+		goto end;
+	}
+
+	BT_COMP_LOGI("Created writer thread pool: thread-count=%" PRIu64,
+		fs_sink->writer_thread_count);
+
+end:
+	return status;
+}
+
 BT_HIDDEN
 bt_component_class_initialize_method_status ctf_fs_sink_init(
 		bt_self_component_sink *self_comp_sink,
@@ -199,6 +357,12 @@ bt_component_class_initialize_method_status ctf_fs_sink_init(
 		goto end;
 	}
 
+	status = create_writers(fs_sink);
+	if (status != BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_OK) {
+		/* create_writers() logs errors */
+		goto end;
+	}
+
 	add_port_status = bt_self_component_sink_add_input_port(
 		self_comp_sink, in_port_name, NULL, NULL);
 	if (add_port_status != BT_SELF_COMPONENT_ADD_PORT_STATUS_OK) {
@@ -248,35 +412,117 @@ struct fs_sink_stream *borrow_stream(struct fs_sink_comp *fs_sink,
 		if (!stream) {
 			goto end;
 		}
+
+		if (fs_sink->writers) {
+			/* Shard the streams among the writers */
+			stream->writer = fs_sink->writers->pdata[
+				fs_sink->next_writer_index];
+			fs_sink->next_writer_index =
+				(fs_sink->next_writer_index + 1) %
+				fs_sink->writers->len;
+		}
 	}
 
 end:
 	return stream;
 }
 
+/*
+ * Returns the raw packet of `ir_packet` to copy verbatim to the stream
+ * file of `stream`, or `NULL` to encode the events of `ir_packet`.
+ *
+ * A trace copies raw packets only if hold_back_msg() checked that all
+ * its packets have a raw packet with the same metadata, as there's a
+ * single metadata stream per CTF trace, and that the component
+ * received all their events.
+ */
 static inline
-bt_component_class_sink_consume_method_status handle_event_msg(
-		struct fs_sink_comp *fs_sink, const bt_message *msg)
+const struct ctf_raw_packet *borrow_raw_packet_to_copy(
+		struct fs_sink_comp *fs_sink, struct fs_sink_stream *stream,
+		const bt_packet *ir_packet)
+{
+	struct fs_sink_trace *trace = stream->trace;
+	const struct ctf_raw_packet *raw_packet = NULL;
+
+	if (!fs_sink->copy_raw_packets) {
+		goto end;
+	}
+
+	if (G_UNLIKELY(!trace->raw_packet_mode_is_set)) {
+		/*
+		 * hold_back_msg() holds back the first packet of a
+		 * trace when it has a raw packet.
+		 */
+		BT_ASSERT(!ctf_raw_packet_borrow(ir_packet));
+		trace->raw_packet_mode_is_set = true;
+		BT_COMP_LOGI("Encoding packets of trace: trace-name=\"%s\", "
+			"path=\"%s\"",
+			bt_trace_get_name(trace->ir_trace), trace->path->str);
+	}
+
+	if (trace->raw_packet_metadata) {
+		raw_packet = ctf_raw_packet_borrow(ir_packet);
+		BT_ASSERT_DBG(raw_packet);
+	}
+
+end:
+	return raw_packet;
+}
+
+/*
+ * Sets the stream of `op` to the stream of `ir_stream`, creating it if
+ * needed.
+ */
+static inline
+bt_component_class_sink_consume_method_status set_op_stream(
+		struct fs_sink_comp *fs_sink, struct fs_sink_writer_op *op,
+		const bt_stream *ir_stream)
 {
-	int ret;
 	bt_component_class_sink_consume_method_status status =
 		BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_OK;
-	const bt_event *ir_event = bt_message_event_borrow_event_const(msg);
-	const bt_stream *ir_stream = bt_event_borrow_stream_const(ir_event);
-	struct fs_sink_stream *stream;
-	struct fs_sink_ctf_event_class *ec = NULL;
-	const bt_clock_snapshot *cs = NULL;
 
-	stream = borrow_stream(fs_sink, ir_stream);
-	if (G_UNLIKELY(!stream)) {
+	op->stream = borrow_stream(fs_sink, ir_stream);
+	if (G_UNLIKELY(!op->stream)) {
 		BT_COMP_LOGE_APPEND_CAUSE(fs_sink->self_comp,
 			"Failed to borrow stream.");
 		status = BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_ERROR;
+	}
+
+	return status;
+}
+
+static inline
+bt_component_class_sink_consume_method_status prepare_event_msg(
+		struct fs_sink_comp *fs_sink, struct fs_sink_writer_op *op)
+{
+	int ret;
+	bt_component_class_sink_consume_method_status status;
+	const bt_event *ir_event = bt_message_event_borrow_event_const(op->msg);
+	const bt_stream *ir_stream = bt_event_borrow_stream_const(ir_event);
+	struct fs_sink_stream *stream;
+
+	status = set_op_stream(fs_sink, op, ir_stream);
+	if (G_UNLIKELY(status != BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_OK)) {
+		goto end;
+	}
+
+	stream = op->stream;
+
+	if (stream->trace->raw_packet_metadata) {
+		/*
+		 * hold_back_msg() makes a trace encode its packets when
+		 * one of its events is outside a raw packet: closing
+		 * the raw packet of this event copies it as is.
+		 */
+		op->stream = NULL;
 		goto end;
 	}
 
+	/* Artificial packets: this trace encodes its packets */
+	stream->trace->raw_packet_mode_is_set = true;
+
 	ret = try_translate_event_class_trace_ir_to_ctf_ir(fs_sink,
-		stream->sc, bt_event_borrow_class_const(ir_event), &ec);
+		stream->sc, bt_event_borrow_class_const(ir_event), &op->ec);
 	if (ret) {
 		BT_COMP_LOGE_APPEND_CAUSE(fs_sink->self_comp,
 			"Failed to translate event class to CTF IR.");
@@ -284,11 +530,34 @@ bt_component_class_sink_consume_method_status handle_event_msg(
 		goto end;
 	}
 
-	BT_ASSERT_DBG(ec);
+	BT_ASSERT_DBG(op->ec);
+
+	/*
+	 * Borrowing the payload field of an event for the first time
+	 * can materialize it (see
+	 * bt_event_set_payload_field_materialize_func()), which creates
+	 * library objects: do it here, on the graph's thread, so that
+	 * write_event_msg() only reads existing fields.
+	 */
+	(void) bt_event_borrow_payload_field_const(ir_event);
+
+end:
+	return status;
+}
+
+static inline
+bt_component_class_sink_consume_method_status write_event_msg(
+		struct fs_sink_comp *fs_sink, const struct fs_sink_writer_op *op)
+{
+	int ret;
+	bt_component_class_sink_consume_method_status status =
+		BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_OK;
+	struct fs_sink_stream *stream = op->stream;
+	const bt_clock_snapshot *cs = NULL;
 
 	if (stream->sc->default_clock_class) {
 		cs = bt_message_event_borrow_default_clock_snapshot_const(
-			msg);
+			op->msg);
 	}
 
 	/*
@@ -331,7 +600,8 @@ bt_component_class_sink_consume_method_status handle_event_msg(
 	}
 
 	BT_ASSERT_DBG(stream->packet_state.is_open);
-	ret = fs_sink_stream_write_event(stream, cs, ir_event, ec);
+	ret = fs_sink_stream_write_event(stream, cs,
+		bt_message_event_borrow_event_const(op->msg), op->ec);
 	if (G_UNLIKELY(ret)) {
 		BT_COMP_LOGE_APPEND_CAUSE(fs_sink->self_comp,
 			"Failed to write event.");
@@ -344,29 +614,54 @@ end:
 }
 
 static inline
-bt_component_class_sink_consume_method_status handle_packet_beginning_msg(
-		struct fs_sink_comp *fs_sink, const bt_message *msg)
+bt_component_class_sink_consume_method_status prepare_packet_beginning_msg(
+		struct fs_sink_comp *fs_sink, struct fs_sink_writer_op *op)
+{
+	bt_component_class_sink_consume_method_status status;
+	const bt_packet *ir_packet =
+		bt_message_packet_beginning_borrow_packet_const(op->msg);
+
+	status = set_op_stream(fs_sink, op,
+		bt_packet_borrow_stream_const(ir_packet));
+	if (G_UNLIKELY(status != BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_OK)) {
+		goto end;
+	}
+
+	op->raw_packet = borrow_raw_packet_to_copy(fs_sink, op->stream,
+		ir_packet);
+
+end:
+	return status;
+}
+
+static inline
+bt_component_class_sink_consume_method_status write_packet_beginning_msg(
+		struct fs_sink_comp *fs_sink, const struct fs_sink_writer_op *op)
 {
 	int ret;
 	bt_component_class_sink_consume_method_status status =
 		BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_OK;
 	const bt_packet *ir_packet =
-		bt_message_packet_beginning_borrow_packet_const(msg);
+		bt_message_packet_beginning_borrow_packet_const(op->msg);
 	const bt_stream *ir_stream = bt_packet_borrow_stream_const(ir_packet);
-	struct fs_sink_stream *stream;
+	struct fs_sink_stream *stream = op->stream;
 	const bt_clock_snapshot *cs = NULL;
 
-	stream = borrow_stream(fs_sink, ir_stream);
-	if (G_UNLIKELY(!stream)) {
-		BT_COMP_LOGE_APPEND_CAUSE(fs_sink->self_comp,
-			"Failed to borrow stream.");
-		status = BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_ERROR;
+	if (op->raw_packet) {
+		/*
+		 * The contexts of the raw packets already contain the
+		 * discarded events and packets counters.
+		 */
+		stream->discarded_events_state.in_range = false;
+		stream->discarded_packets_state.in_range = false;
+		fs_sink_stream_open_raw_packet(stream, ir_packet,
+			op->raw_packet);
 		goto end;
 	}
 
 	if (stream->sc->packets_have_ts_begin) {
 		cs = bt_message_packet_beginning_borrow_default_clock_snapshot_const(
-			msg);
+			op->msg);
 		BT_ASSERT(cs);
 	}
 
@@ -379,12 +674,12 @@ bt_component_class_sink_consume_method_status handle_packet_beginning_msg(
 	 *   time (or the current packet's beginning time if
 	 *   this is the first packet).
 	 *
-	 * We check this here instead of in handle_packet_end_msg()
+	 * We check this here instead of in write_packet_end_msg()
 	 * because we want to catch any incompatible message as early as
 	 * possible to report the error.
 	 *
 	 * Validation of the discarded events message's end time is
-	 * performed in handle_packet_end_msg().
+	 * performed in write_packet_end_msg().
 	 */
 	if (stream->discarded_events_state.in_range) {
 		uint64_t expected_cs;
@@ -540,29 +835,32 @@ end:
 }
 
 static inline
-bt_component_class_sink_consume_method_status handle_packet_end_msg(
-		struct fs_sink_comp *fs_sink, const bt_message *msg)
+bt_component_class_sink_consume_method_status write_packet_end_msg(
+		struct fs_sink_comp *fs_sink, const struct fs_sink_writer_op *op)
 {
 	int ret;
 	bt_component_class_sink_consume_method_status status =
 		BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_OK;
 	const bt_packet *ir_packet =
-		bt_message_packet_end_borrow_packet_const(msg);
+		bt_message_packet_end_borrow_packet_const(op->msg);
 	const bt_stream *ir_stream = bt_packet_borrow_stream_const(ir_packet);
-	struct fs_sink_stream *stream;
+	struct fs_sink_stream *stream = op->stream;
 	const bt_clock_snapshot *cs = NULL;
 
-	stream = borrow_stream(fs_sink, ir_stream);
-	if (G_UNLIKELY(!stream)) {
-		BT_COMP_LOGE_APPEND_CAUSE(fs_sink->self_comp,
-			"Failed to borrow stream.");
-		status = BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_ERROR;
+	if (stream->packet_state.raw_packet) {
+		ret = fs_sink_stream_close_raw_packet(stream);
+		if (ret) {
+			BT_COMP_LOGE_APPEND_CAUSE(fs_sink->self_comp,
+				"Failed to copy raw packet.");
+			status = BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_ERROR;
+		}
+
 		goto end;
 	}
 
 	if (stream->sc->packets_have_ts_end) {
 		cs = bt_message_packet_end_borrow_default_clock_snapshot_const(
-			msg);
+			op->msg);
 		BT_ASSERT(cs);
 	}
 
@@ -574,7 +872,7 @@ bt_component_class_sink_consume_method_status handle_packet_end_msg(
 	 * * Its end time is the current packet's end time.
 	 *
 	 * Validation of the discarded events message's beginning time
-	 * is performed in handle_packet_beginning_msg().
+	 * is performed in write_packet_beginning_msg().
 	 */
 	if (stream->discarded_events_state.in_range) {
 		uint64_t expected_cs;
@@ -734,22 +1032,14 @@ end:
 }
 
 static inline
-bt_component_class_sink_consume_method_status handle_stream_end_msg(
-		struct fs_sink_comp *fs_sink, const bt_message *msg)
+bt_component_class_sink_consume_method_status write_stream_end_msg(
+		struct fs_sink_comp *fs_sink, const struct fs_sink_writer_op *op)
 {
 	bt_component_class_sink_consume_method_status status =
 		BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_OK;
 	const bt_stream *ir_stream =
-		bt_message_stream_end_borrow_stream_const(msg);
-	struct fs_sink_stream *stream;
-
-	stream = borrow_stream(fs_sink, ir_stream);
-	if (!stream) {
-		BT_COMP_LOGE_APPEND_CAUSE(fs_sink->self_comp,
-			"Failed to borrow stream.");
-		status = BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_ERROR;
-		goto end;
-	}
+		bt_message_stream_end_borrow_stream_const(op->msg);
+	struct fs_sink_stream *stream = op->stream;
 
 	if (G_UNLIKELY(!stream->sc->has_packets &&
 			stream->packet_state.is_open)) {
@@ -771,34 +1061,29 @@ bt_component_class_sink_consume_method_status handle_stream_end_msg(
 		bt_trace_get_name(bt_stream_borrow_trace_const(ir_stream)),
 		stream->trace->path->str, stream->file_name->str);
 
-	/*
-	 * This destroys the stream object and frees all its resources,
-	 * closing the stream file.
-	 */
-	g_hash_table_remove(stream->trace->streams, ir_stream);
-
 end:
 	return status;
 }
 
 static inline
-bt_component_class_sink_consume_method_status handle_discarded_events_msg(
-		struct fs_sink_comp *fs_sink, const bt_message *msg)
+bt_component_class_sink_consume_method_status prepare_discarded_events_msg(
+		struct fs_sink_comp *fs_sink, struct fs_sink_writer_op *op)
 {
-	bt_component_class_sink_consume_method_status status =
-		BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_OK;
+	bt_component_class_sink_consume_method_status status;
 	const bt_stream *ir_stream =
-		bt_message_discarded_events_borrow_stream_const(msg);
+		bt_message_discarded_events_borrow_stream_const(op->msg);
 	struct fs_sink_stream *stream;
-	const bt_clock_snapshot *cs = NULL;
-	bt_property_availability avail;
-	uint64_t count;
 
-	stream = borrow_stream(fs_sink, ir_stream);
-	if (!stream) {
-		BT_COMP_LOGE_APPEND_CAUSE(fs_sink->self_comp,
-			"Failed to borrow stream.");
-		status = BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_ERROR;
+	status = set_op_stream(fs_sink, op, ir_stream);
+	if (status != BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_OK) {
+		goto end;
+	}
+
+	stream = op->stream;
+
+	if (stream->trace->raw_packet_metadata) {
+		/* The contexts of the copied packets contain this count */
+		op->stream = NULL;
 		goto end;
 	}
 
@@ -811,9 +1096,27 @@ bt_component_class_sink_consume_method_status handle_discarded_events_msg(
 			bt_trace_get_name(
 				bt_stream_borrow_trace_const(ir_stream)),
 			stream->trace->path->str, stream->file_name->str);
+		op->stream = NULL;
 		goto end;
 	}
 
+end:
+	return status;
+}
+
+static inline
+bt_component_class_sink_consume_method_status write_discarded_events_msg(
+		struct fs_sink_comp *fs_sink, const struct fs_sink_writer_op *op)
+{
+	bt_component_class_sink_consume_method_status status =
+		BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_OK;
+	const bt_stream *ir_stream =
+		bt_message_discarded_events_borrow_stream_const(op->msg);
+	struct fs_sink_stream *stream = op->stream;
+	const bt_clock_snapshot *cs = NULL;
+	bt_property_availability avail;
+	uint64_t count;
+
 	if (stream->discarded_events_state.in_range) {
 		BT_COMP_LOGE_APPEND_CAUSE(fs_sink->self_comp,
 			"Unsupported contiguous discarded events message: "
@@ -863,21 +1166,21 @@ bt_component_class_sink_consume_method_status handle_discarded_events_msg(
 		/*
 		 * The clock snapshot values will be validated when
 		 * handling the next packet beginning and end messages
-		 * (next calls to handle_packet_beginning_msg() and
-		 * handle_packet_end_msg()).
+		 * (next calls to write_packet_beginning_msg() and
+		 * write_packet_end_msg()).
 		 */
 		cs = bt_message_discarded_events_borrow_beginning_default_clock_snapshot_const(
-			msg);
+			op->msg);
 		BT_ASSERT(cs);
 		stream->discarded_events_state.beginning_cs =
 			bt_clock_snapshot_get_value(cs);
 		cs = bt_message_discarded_events_borrow_end_default_clock_snapshot_const(
-			msg);
+			op->msg);
 		BT_ASSERT(cs);
 		stream->discarded_events_state.end_cs = bt_clock_snapshot_get_value(cs);
 	}
 
-	avail = bt_message_discarded_events_get_count(msg, &count);
+	avail = bt_message_discarded_events_get_count(op->msg, &count);
 	if (avail != BT_PROPERTY_AVAILABILITY_AVAILABLE) {
 		/*
 		 * There's no specific count of discarded events: set it
@@ -894,23 +1197,24 @@ end:
 }
 
 static inline
-bt_component_class_sink_consume_method_status handle_discarded_packets_msg(
-		struct fs_sink_comp *fs_sink, const bt_message *msg)
+bt_component_class_sink_consume_method_status prepare_discarded_packets_msg(
+		struct fs_sink_comp *fs_sink, struct fs_sink_writer_op *op)
 {
-	bt_component_class_sink_consume_method_status status =
-		BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_OK;
+	bt_component_class_sink_consume_method_status status;
 	const bt_stream *ir_stream =
-		bt_message_discarded_packets_borrow_stream_const(msg);
+		bt_message_discarded_packets_borrow_stream_const(op->msg);
 	struct fs_sink_stream *stream;
-	const bt_clock_snapshot *cs = NULL;
-	bt_property_availability avail;
-	uint64_t count;
 
-	stream = borrow_stream(fs_sink, ir_stream);
-	if (!stream) {
-		BT_COMP_LOGE_APPEND_CAUSE(fs_sink->self_comp,
-			"Failed to borrow stream.");
-		status = BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_ERROR;
+	status = set_op_stream(fs_sink, op, ir_stream);
+	if (status != BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_OK) {
+		goto end;
+	}
+
+	stream = op->stream;
+
+	if (stream->trace->raw_packet_metadata) {
+		/* The contexts of the copied packets contain this count */
+		op->stream = NULL;
 		goto end;
 	}
 
@@ -923,9 +1227,27 @@ bt_component_class_sink_consume_method_status handle_discarded_packets_msg(
 			bt_trace_get_name(
 				bt_stream_borrow_trace_const(ir_stream)),
 			stream->trace->path->str, stream->file_name->str);
+		op->stream = NULL;
 		goto end;
 	}
 
+end:
+	return status;
+}
+
+static inline
+bt_component_class_sink_consume_method_status write_discarded_packets_msg(
+		struct fs_sink_comp *fs_sink, const struct fs_sink_writer_op *op)
+{
+	bt_component_class_sink_consume_method_status status =
+		BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_OK;
+	const bt_stream *ir_stream =
+		bt_message_discarded_packets_borrow_stream_const(op->msg);
+	struct fs_sink_stream *stream = op->stream;
+	const bt_clock_snapshot *cs = NULL;
+	bt_property_availability avail;
+	uint64_t count;
+
 	if (stream->discarded_packets_state.in_range) {
 		BT_COMP_LOGE_APPEND_CAUSE(fs_sink->self_comp,
 			"Unsupported contiguous discarded packets message: "
@@ -957,21 +1279,21 @@ bt_component_class_sink_consume_method_status handle_discarded_packets_msg(
 		/*
 		 * The clock snapshot values will be validated when
 		 * handling the next packet beginning message (next call
-		 * to handle_packet_beginning_msg()).
+		 * to write_packet_beginning_msg()).
 		 */
 		cs = bt_message_discarded_packets_borrow_beginning_default_clock_snapshot_const(
-			msg);
+			op->msg);
 		BT_ASSERT(cs);
 		stream->discarded_packets_state.beginning_cs =
 			bt_clock_snapshot_get_value(cs);
 		cs = bt_message_discarded_packets_borrow_end_default_clock_snapshot_const(
-			msg);
+			op->msg);
 		BT_ASSERT(cs);
 		stream->discarded_packets_state.end_cs =
 			bt_clock_snapshot_get_value(cs);
 	}
 
-	avail = bt_message_discarded_packets_get_count(msg, &count);
+	avail = bt_message_discarded_packets_get_count(op->msg, &count);
 	if (avail != BT_PROPERTY_AVAILABILITY_AVAILABLE) {
 		/*
 		 * There's no specific count of discarded packets: set
@@ -987,12 +1309,719 @@ end:
 	return status;
 }
 
+/*
+ * Does everything which involves the state of the component or of a
+ * trace to handle the message of `op`, from the graph's thread.
+ *
+ * On success, if the stream of `op` is set, then write_msg() must
+ * write the message to this stream.
+ */
 static inline
-void put_messages(bt_message_array_const msgs, uint64_t count)
+bt_component_class_sink_consume_method_status prepare_msg(
+		struct fs_sink_comp *fs_sink, struct fs_sink_writer_op *op)
 {
-	uint64_t i;
+	bt_component_class_sink_consume_method_status status =
+		BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_OK;
 
-	for (i = 0; i < count; i++) {
+	switch (bt_message_get_type(op->msg)) {
+	case BT_MESSAGE_TYPE_EVENT:
+		status = prepare_event_msg(fs_sink, op);
+		break;
+	case BT_MESSAGE_TYPE_PACKET_BEGINNING:
+		status = prepare_packet_beginning_msg(fs_sink, op);
+		break;
+	case BT_MESSAGE_TYPE_PACKET_END:
+		status = set_op_stream(fs_sink, op,
+			bt_packet_borrow_stream_const(
+				bt_message_packet_end_borrow_packet_const(
+					op->msg)));
+		break;
+	case BT_MESSAGE_TYPE_MESSAGE_ITERATOR_INACTIVITY:
+		/* Ignore */
+		BT_COMP_LOGD_STR("Ignoring message iterator inactivity message.");
+		break;
+	case BT_MESSAGE_TYPE_STREAM_BEGINNING:
+		status = handle_stream_beginning_msg(fs_sink, op->msg);
+		break;
+	case BT_MESSAGE_TYPE_STREAM_END:
+		status = set_op_stream(fs_sink, op,
+			bt_message_stream_end_borrow_stream_const(op->msg));
+		break;
+	case BT_MESSAGE_TYPE_DISCARDED_EVENTS:
+		status = prepare_discarded_events_msg(fs_sink, op);
+		break;
+	case BT_MESSAGE_TYPE_DISCARDED_PACKETS:
+		status = prepare_discarded_packets_msg(fs_sink, op);
+		break;
+	default:
+		bt_common_abort();
+	}
+
+	return status;
+}
+
+/*
+ * Writes the message of `op`, which prepare_msg() prepared, to its
+ * stream.
+ *
+ * This only involves the state of the stream of `op`: the writer of
+ * this stream, if any, calls this from its thread.
+ */
+static inline
+bt_component_class_sink_consume_method_status write_msg(
+		struct fs_sink_comp *fs_sink, const struct fs_sink_writer_op *op)
+{
+	bt_component_class_sink_consume_method_status status;
+
+	switch (bt_message_get_type(op->msg)) {
+	case BT_MESSAGE_TYPE_EVENT:
+		status = write_event_msg(fs_sink, op);
+		break;
+	case BT_MESSAGE_TYPE_PACKET_BEGINNING:
+		status = write_packet_beginning_msg(fs_sink, op);
+		break;
+	case BT_MESSAGE_TYPE_PACKET_END:
+		status = write_packet_end_msg(fs_sink, op);
+		break;
+	case BT_MESSAGE_TYPE_STREAM_END:
+		status = write_stream_end_msg(fs_sink, op);
+		break;
+	case BT_MESSAGE_TYPE_DISCARDED_EVENTS:
+		status = write_discarded_events_msg(fs_sink, op);
+		break;
+	case BT_MESSAGE_TYPE_DISCARDED_PACKETS:
+		status = write_discarded_packets_msg(fs_sink, op);
+		break;
+	default:
+		bt_common_abort();
+	}
+
+	return status;
+}
+
+/*
+ * Completes, from the graph's thread, the handling of the message of
+ * `op` once write_msg() wrote it successfully.
+ */
+static inline
+void finish_op(const struct fs_sink_writer_op *op)
+{
+	if (bt_message_get_type(op->msg) == BT_MESSAGE_TYPE_STREAM_END) {
+		/*
+		 * This destroys the stream object and frees all its
+		 * resources, closing the stream file.
+		 */
+		g_hash_table_remove(op->stream->trace->streams,
+			op->stream->ir_stream);
+	}
+}
+
+/*
+ * Job of a writer, running on one of the threads of the component's
+ * writer thread pool.
+ *
+ * The job handles the pending operations of the writer, in batches,
+ * until there's none left.
+ */
+static
+void handle_writer_ops(gpointer data, __attribute__((unused)) gpointer user_data)
+{
+	struct fs_sink_writer *writer = data;
+	struct fs_sink_comp *fs_sink = writer->fs_sink;
+
+	g_mutex_lock(writer->lock);
+
+	while (writer->handled_count < writer->pushed_count) {
+		bt_component_class_sink_consume_method_status status =
+			writer->status;
+		uint64_t end = writer->pushed_count;
+		uint64_t i;
+
+		/* Write without holding the lock */
+		g_mutex_unlock(writer->lock);
+
+		for (i = writer->handled_count; i < end &&
+				status == BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_OK;
+				i++) {
+			status = write_msg(fs_sink,
+				&writer->ops[i % FS_SINK_WRITER_OPS_CAPACITY]);
+		}
+
+		g_mutex_lock(writer->lock);
+
+		/* After a failure, skip the remaining operations */
+		writer->handled_count = end;
+
+		if (status != BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_OK &&
+				writer->status ==
+					BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_OK) {
+			writer->status = status;
+
+			/*
+			 * The error belongs to this worker thread: hand
+			 * it over to the graph's thread.
+			 */
+			writer->error = bt_current_thread_take_error();
+		}
+
+		if (writer->consumer_waiting) {
+			g_cond_signal(writer->cond);
+		}
+	}
+
+	writer->job_pending = false;
+
+	if (writer->consumer_waiting) {
+		g_cond_signal(writer->cond);
+	}
+
+	g_mutex_unlock(writer->lock);
+}
+
+/*
+ * Queues a job for `writer` if there's none.
+ *
+ * Call with `writer->lock` held.
+ */
+static
+int schedule_writer_job(struct fs_sink_writer *writer)
+{
+	int ret = 0;
+	GError *gerror = NULL;
+	struct fs_sink_comp *fs_sink = writer->fs_sink;
+
+	if (writer->job_pending) {
+		goto end;
+	}
+
+	writer->job_pending = true;
+	g_thread_pool_push(fs_sink->writer_thread_pool, writer, &gerror);
+	if (gerror) {
+		BT_COMP_LOGE_APPEND_CAUSE(fs_sink->self_comp,
+			"Cannot queue writer job: %s", gerror->message);
+		writer->job_pending = false;
+		g_error_free(gerror);
+		ret = -1;
+	}
+
+end:
+	return ret;
+}
+
+/*
+ * Moves the error of `writer`, if any, to the current thread.
+ */
+static
+void move_writer_error(struct fs_sink_writer *writer)
+{
+	const struct bt_error *error;
+
+	g_mutex_lock(writer->lock);
+	error = writer->error;
+	writer->error = NULL;
+	g_mutex_unlock(writer->lock);
+
+	if (error) {
+		bt_current_thread_move_error(error);
+	}
+}
+
+/*
+ * Releases the messages of the operations which `writer` handled,
+ * finishing them (see finish_op()) if the writer didn't fail.
+ *
+ * Returns the status of the writer.
+ */
+static
+bt_component_class_sink_consume_method_status reclaim_writer_ops(
+		struct fs_sink_writer *writer)
+{
+	bt_component_class_sink_consume_method_status status;
+	uint64_t handled_count;
+
+	g_mutex_lock(writer->lock);
+	handled_count = writer->handled_count;
+	status = writer->status;
+	g_mutex_unlock(writer->lock);
+
+	while (writer->reclaimed_count < handled_count) {
+		struct fs_sink_writer_op *op = &writer->ops[
+			writer->reclaimed_count % FS_SINK_WRITER_OPS_CAPACITY];
+
+		if (status == BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_OK) {
+			finish_op(op);
+		}
+
+		BT_MESSAGE_PUT_REF_AND_RESET(op->msg);
+		writer->reclaimed_count++;
+	}
+
+	return status;
+}
+
+/*
+ * Releases the messages of the operations which all the writers
+ * handled, first waiting for each writer to handle all its pending
+ * operations if `wait` is true.
+ *
+ * Returns the status of the first writer which failed, moving its
+ * error to the current thread.
+ */
+static
+bt_component_class_sink_consume_method_status reclaim_all_writer_ops(
+		struct fs_sink_comp *fs_sink, bool wait)
+{
+	bt_component_class_sink_consume_method_status status =
+		BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_OK;
+	guint i;
+
+	for (i = 0; i < fs_sink->writers->len; i++) {
+		struct fs_sink_writer *writer = fs_sink->writers->pdata[i];
+		bt_component_class_sink_consume_method_status writer_status;
+
+		if (wait) {
+			g_mutex_lock(writer->lock);
+
+			while (writer->job_pending) {
+				writer->consumer_waiting = true;
+				g_cond_wait(writer->cond, writer->lock);
+				writer->consumer_waiting = false;
+			}
+
+			g_mutex_unlock(writer->lock);
+		}
+
+		writer_status = reclaim_writer_ops(writer);
+		if (writer_status != BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_OK &&
+				status == BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_OK) {
+			status = writer_status;
+			move_writer_error(writer);
+		}
+	}
+
+	return status;
+}
+
+/*
+ * Routes `op` to `writer`, moving the reference of `op->msg` on
+ * success.
+ *
+ * Waits for the writer if it has `FS_SINK_WRITER_OPS_CAPACITY`
+ * operations of which the messages are not released yet.
+ */
+static
+bt_component_class_sink_consume_method_status push_writer_op(
+		struct fs_sink_writer *writer, struct fs_sink_writer_op *op)
+{
+	bt_component_class_sink_consume_method_status status =
+		BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_OK;
+
+	/* Only the graph's thread modifies `pushed_count` */
+	while (writer->pushed_count - writer->reclaimed_count >=
+			FS_SINK_WRITER_OPS_CAPACITY) {
+		g_mutex_lock(writer->lock);
+
+		while (writer->handled_count == writer->reclaimed_count) {
+			BT_ASSERT(writer->job_pending);
+			writer->consumer_waiting = true;
+			g_cond_wait(writer->cond, writer->lock);
+			writer->consumer_waiting = false;
+		}
+
+		g_mutex_unlock(writer->lock);
+		status = reclaim_writer_ops(writer);
+		if (status != BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_OK) {
+			move_writer_error(writer);
+			goto end;
+		}
+	}
+
+	g_mutex_lock(writer->lock);
+
+	if (writer->status != BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_OK) {
+		/* Report the failure as soon as possible */
+		status = writer->status;
+		g_mutex_unlock(writer->lock);
+		move_writer_error(writer);
+		goto end;
+	}
+
+	if (schedule_writer_job(writer)) {
+		status = BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_ERROR;
+		g_mutex_unlock(writer->lock);
+		goto end;
+	}
+
+	writer->ops[writer->pushed_count % FS_SINK_WRITER_OPS_CAPACITY] = *op;
+	writer->pushed_count++;
+	op->msg = NULL;
+	g_mutex_unlock(writer->lock);
+
+end:
+	return status;
+}
+
+static
+bt_component_class_sink_consume_method_status handle_msg(
+		struct fs_sink_comp *fs_sink, struct fs_sink_writer_op *op);
+
+/*
+ * Returns the trace IR stream of `msg`, or `NULL` if it has none.
+ */
+static inline
+const bt_stream *borrow_msg_stream(const bt_message *msg)
+{
+	const bt_stream *ir_stream = NULL;
+
+	switch (bt_message_get_type(msg)) {
+	case BT_MESSAGE_TYPE_EVENT:
+		ir_stream = bt_event_borrow_stream_const(
+			bt_message_event_borrow_event_const(msg));
+		break;
+	case BT_MESSAGE_TYPE_PACKET_BEGINNING:
+		ir_stream = bt_packet_borrow_stream_const(
+			bt_message_packet_beginning_borrow_packet_const(msg));
+		break;
+	case BT_MESSAGE_TYPE_PACKET_END:
+		ir_stream = bt_packet_borrow_stream_const(
+			bt_message_packet_end_borrow_packet_const(msg));
+		break;
+	case BT_MESSAGE_TYPE_STREAM_BEGINNING:
+		ir_stream = bt_message_stream_beginning_borrow_stream_const(msg);
+		break;
+	case BT_MESSAGE_TYPE_STREAM_END:
+		ir_stream = bt_message_stream_end_borrow_stream_const(msg);
+		break;
+	case BT_MESSAGE_TYPE_DISCARDED_EVENTS:
+		ir_stream = bt_message_discarded_events_borrow_stream_const(msg);
+		break;
+	case BT_MESSAGE_TYPE_DISCARDED_PACKETS:
+		ir_stream = bt_message_discarded_packets_borrow_stream_const(msg);
+		break;
+	default:
+		break;
+	}
+
+	return ir_stream;
+}
+
+/*
+ * Decides whether or not `trace` copies raw packets, depending on
+ * `copy`, and then handles the messages which hold_back_msg() held
+ * back for it.
+ */
+static
+bt_component_class_sink_consume_method_status release_pending_msgs(
+		struct fs_sink_comp *fs_sink, struct fs_sink_trace *trace,
+		bool copy)
+{
+	bt_component_class_sink_consume_method_status status =
+		BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_OK;
+	GQueue *pending_msgs = trace->pending_msgs;
+
+	if (copy) {
+		trace->raw_packet_metadata = ctf_raw_packet_metadata_get_ref(
+			trace->pending_metadata);
+	}
+
+	trace->raw_packet_mode_is_set = true;
+	BT_COMP_LOGI("%s packets of trace: trace-name=\"%s\", "
+		"path=\"%s\", pending-msg-count=%u",
+		trace->raw_packet_metadata ? "Copying raw" : "Encoding",
+		bt_trace_get_name(trace->ir_trace), trace->path->str,
+		g_queue_get_length(pending_msgs));
+	trace->pending_msgs = NULL;
+	trace->pending_metadata = NULL;
+	g_hash_table_destroy(trace->pending_packet_event_counts);
+	trace->pending_packet_event_counts = NULL;
+
+	/*
+	 * Handling the last message can destroy `trace`: don't use it
+	 * below.
+	 */
+	while (!g_queue_is_empty(pending_msgs)) {
+		struct fs_sink_writer_op op = {
+			.msg = g_queue_pop_head(pending_msgs),
+		};
+
+		if (status == BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_OK) {
+			status = handle_msg(fs_sink, &op);
+		}
+
+		BT_MESSAGE_PUT_REF_AND_RESET(op.msg);
+	}
+
+	g_queue_free(pending_msgs);
+	return status;
+}
+
+/*
+ * Handles the messages which hold_back_msg() held back for all the
+ * traces, copying their raw packets: the upstream message iterator
+ * ended, and none of their packets made them fall back to encoding.
+ *
+ * A packet which never ended can't be copied, however.
+ */
+static
+bt_component_class_sink_consume_method_status release_all_pending_msgs(
+		struct fs_sink_comp *fs_sink)
+{
+	bt_component_class_sink_consume_method_status status =
+		BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_OK;
+	GPtrArray *traces;
+	GHashTableIter iter;
+	gpointer value;
+	guint i;
+
+	traces = g_ptr_array_new();
+	if (!traces) {
+		BT_COMP_LOGE_APPEND_CAUSE(fs_sink->self_comp,
+			"Failed to allocate one GPtrArray.");
+		status = BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_MEMORY_ERROR;
+		goto end;
+	}
+
+	/*
+	 * Releasing the messages of a trace can destroy it, removing
+	 * it from `fs_sink->traces`: collect the traces first.
+	 */
+	g_hash_table_iter_init(&iter, fs_sink->traces);
+
+	while (g_hash_table_iter_next(&iter, NULL, &value)) {
+		struct fs_sink_trace *trace = value;
+
+		if (trace->pending_msgs) {
+			g_ptr_array_add(traces, trace);
+		}
+	}
+
+	for (i = 0; i < traces->len; i++) {
+		struct fs_sink_trace *trace = g_ptr_array_index(traces, i);
+
+		status = release_pending_msgs(fs_sink, trace,
+			g_hash_table_size(
+				trace->pending_packet_event_counts) == 0);
+		if (status != BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_OK) {
+			goto end;
+		}
+	}
+
+end:
+	if (traces) {
+		g_ptr_array_free(traces, TRUE);
+	}
+
+	return status;
+}
+
+/*
+ * Holds back the message of `op`, moving its reference, if its trace
+ * didn't decide yet whether or not it copies raw packets and the
+ * message is part of its first packet with a raw packet, or follows
+ * it.
+ *
+ * Makes the trace fall back to encoding its packets, releasing its
+ * messages, as soon as `msg` shows that the component cannot copy one
+ * of its packets.
+ *
+ * Sets `*held_back` to whether or not this function held back the
+ * message.
+ */
+static
+bt_component_class_sink_consume_method_status hold_back_msg(
+		struct fs_sink_comp *fs_sink, struct fs_sink_writer_op *op,
+		bool *held_back)
+{
+	bt_component_class_sink_consume_method_status status =
+		BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_OK;
+	const bt_message *msg = op->msg;
+	const bt_stream *ir_stream = borrow_msg_stream(msg);
+	const struct ctf_raw_packet *raw_packet;
+	const bt_packet *ir_packet;
+	struct fs_sink_trace *trace;
+	uint64_t *event_count;
+	bool copy = true;
+
+	*held_back = false;
+
+	if (!ir_stream) {
+		goto end;
+	}
+
+	trace = g_hash_table_lookup(fs_sink->traces,
+		bt_stream_borrow_trace_const(ir_stream));
+	if (!trace || trace->raw_packet_mode_is_set) {
+		goto end;
+	}
+
+	if (!trace->pending_msgs) {
+		if (bt_message_get_type(msg) !=
+				BT_MESSAGE_TYPE_PACKET_BEGINNING) {
+			goto end;
+		}
+
+		raw_packet = ctf_raw_packet_borrow(
+			bt_message_packet_beginning_borrow_packet_const(msg));
+		if (!raw_packet) {
+			/* borrow_raw_packet_to_copy() decides to encode */
+			goto end;
+		}
+
+		trace->pending_msgs = g_queue_new();
+		trace->pending_packet_event_counts = g_hash_table_new_full(
+			g_direct_hash, g_direct_equal, NULL, g_free);
+		if (!trace->pending_msgs ||
+				!trace->pending_packet_event_counts) {
+			BT_COMP_LOGE_APPEND_CAUSE(fs_sink->self_comp,
+				"Failed to allocate the pending messages of a trace.");
+			status = BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_MEMORY_ERROR;
+			goto end;
+		}
+
+		trace->pending_metadata = raw_packet->metadata;
+	}
+
+	g_queue_push_tail(trace->pending_msgs, (gpointer) msg);
+	op->msg = NULL;
+	*held_back = true;
+
+	switch (bt_message_get_type(msg)) {
+	case BT_MESSAGE_TYPE_PACKET_BEGINNING:
+		ir_packet = bt_message_packet_beginning_borrow_packet_const(msg);
+		raw_packet = ctf_raw_packet_borrow(ir_packet);
+		if (!raw_packet ||
+				(raw_packet->metadata != trace->pending_metadata &&
+				!ctf_raw_packet_metadata_equal(
+					raw_packet->metadata,
+					trace->pending_metadata))) {
+			BT_COMP_LOGI("Packet has no raw packet, or its metadata "
+				"differs from the one of the previous packets "
+				"of its trace: "
+				"stream-id=%" PRIu64 ", stream-name=\"%s\", "
+				"trace-path=\"%s\"",
+				bt_stream_get_id(ir_stream),
+				bt_stream_get_name(ir_stream),
+				trace->path->str);
+			copy = false;
+			break;
+		}
+
+		event_count = g_new0(uint64_t, 1);
+		if (!event_count) {
+			BT_COMP_LOGE_APPEND_CAUSE(fs_sink->self_comp,
+				"Failed to allocate one event count.");
+			status = BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_MEMORY_ERROR;
+			goto end;
+		}
+
+		g_hash_table_insert(trace->pending_packet_event_counts,
+			(gpointer) ir_packet, event_count);
+		break;
+	case BT_MESSAGE_TYPE_EVENT:
+		ir_packet = bt_event_borrow_packet_const(
+			bt_message_event_borrow_event_const(msg));
+		event_count = ir_packet ?
+			g_hash_table_lookup(trace->pending_packet_event_counts,
+				ir_packet) : NULL;
+		if (!event_count) {
+			/* Event outside a packet with a raw packet */
+			copy = false;
+			break;
+		}
+
+		(*event_count)++;
+		break;
+	case BT_MESSAGE_TYPE_PACKET_END:
+		ir_packet = bt_message_packet_end_borrow_packet_const(msg);
+		raw_packet = ctf_raw_packet_borrow(ir_packet);
+		event_count = g_hash_table_lookup(
+			trace->pending_packet_event_counts, ir_packet);
+		BT_ASSERT(raw_packet);
+		BT_ASSERT(event_count);
+
+		if (!ctf_raw_packet_is_complete(raw_packet, *event_count)) {
+			/*
+			 * Copying this packet would bring back the
+			 * events which were removed upstream (for
+			 * example, by a trimmer).
+			 */
+			BT_COMP_LOGI("Component didn't receive all the events "
+				"of packet: event-msg-count=%" PRIu64 ", "
+				"packet-event-count=%" PRIu64 ", "
+				"stream-id=%" PRIu64 ", stream-name=\"%s\", "
+				"trace-path=\"%s\"",
+				*event_count, raw_packet->event_count,
+				bt_stream_get_id(ir_stream),
+				bt_stream_get_name(ir_stream),
+				trace->path->str);
+			copy = false;
+			break;
+		}
+
+		g_hash_table_remove(trace->pending_packet_event_counts,
+			ir_packet);
+		break;
+	default:
+		break;
+	}
+
+	if (!copy) {
+		status = release_pending_msgs(fs_sink, trace, false);
+	}
+
+end:
+	return status;
+}
+
+/*
+ * Handles the message of `op`, either writing it directly or routing
+ * it to the writer of its stream.
+ *
+ * Resets `op->msg` if it moves its reference to a writer, or if
+ * hold_back_msg() holds it back.
+ */
+static
+bt_component_class_sink_consume_method_status handle_msg(
+		struct fs_sink_comp *fs_sink, struct fs_sink_writer_op *op)
+{
+	bt_component_class_sink_consume_method_status status;
+
+	if (G_UNLIKELY(fs_sink->copy_raw_packets)) {
+		bool held_back;
+
+		status = hold_back_msg(fs_sink, op, &held_back);
+		if (status != BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_OK ||
+				held_back) {
+			goto end;
+		}
+	}
+
+	status = prepare_msg(fs_sink, op);
+	if (status != BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_OK ||
+			!op->stream) {
+		goto end;
+	}
+
+	if (op->stream->writer) {
+		status = push_writer_op(op->stream->writer, op);
+		goto end;
+	}
+
+	status = write_msg(fs_sink, op);
+	if (status == BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_OK) {
+		finish_op(op);
+	}
+
+end:
+	return status;
+}
+
+static inline
+void put_messages(bt_message_array_const msgs, uint64_t count)
+{
+	uint64_t i;
+
+	for (i = 0; i < count; i++) {
 		BT_MESSAGE_PUT_REF_AND_RESET(msgs[i]);
 	}
 }
@@ -1029,54 +2058,22 @@ bt_component_class_sink_consume_method_status ctf_fs_sink_consume(
 		uint64_t i;
 
 		for (i = 0; i < msg_count; i++) {
-			const bt_message *msg = msgs[i];
-
-			BT_ASSERT_DBG(msg);
-
-			switch (bt_message_get_type(msg)) {
-			case BT_MESSAGE_TYPE_EVENT:
-				status = handle_event_msg(fs_sink, msg);
-				break;
-			case BT_MESSAGE_TYPE_PACKET_BEGINNING:
-				status = handle_packet_beginning_msg(
-					fs_sink, msg);
-				break;
-			case BT_MESSAGE_TYPE_PACKET_END:
-				status = handle_packet_end_msg(
-					fs_sink, msg);
-				break;
-			case BT_MESSAGE_TYPE_MESSAGE_ITERATOR_INACTIVITY:
-				/* Ignore */
-				BT_COMP_LOGD_STR("Ignoring message iterator inactivity message.");
-				break;
-			case BT_MESSAGE_TYPE_STREAM_BEGINNING:
-				status = handle_stream_beginning_msg(
-					fs_sink, msg);
-				break;
-			case BT_MESSAGE_TYPE_STREAM_END:
-				status = handle_stream_end_msg(
-					fs_sink, msg);
-				break;
-			case BT_MESSAGE_TYPE_DISCARDED_EVENTS:
-				status = handle_discarded_events_msg(
-					fs_sink, msg);
-				break;
-			case BT_MESSAGE_TYPE_DISCARDED_PACKETS:
-				status = handle_discarded_packets_msg(
-					fs_sink, msg);
-				break;
-			default:
-				bt_common_abort();
-			}
+			struct fs_sink_writer_op op = { .msg = msgs[i] };
 
-			BT_MESSAGE_PUT_REF_AND_RESET(msgs[i]);
+			BT_ASSERT_DBG(op.msg);
+			msgs[i] = NULL;
+			status = handle_msg(fs_sink, &op);
+			BT_MESSAGE_PUT_REF_AND_RESET(op.msg);
 
 			if (status != BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_OK) {
-				BT_COMP_LOGE_APPEND_CAUSE(fs_sink->self_comp,
-					"Failed to handle message: "
-					"generated CTF traces could be incomplete: "
-					"output-dir-path=\"%s\"",
-					fs_sink->output_dir_path->str);
+				goto error;
+			}
+		}
+
+		if (fs_sink->writers) {
+			/* Release what the writers wrote meanwhile */
+			status = reclaim_all_writer_ops(fs_sink, false);
+			if (status != BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_OK) {
 				goto error;
 			}
 		}
@@ -1087,6 +2084,21 @@ bt_component_class_sink_consume_method_status ctf_fs_sink_consume(
 		status = BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_AGAIN;
 		break;
 	case BT_MESSAGE_ITERATOR_NEXT_STATUS_END:
+		if (fs_sink->copy_raw_packets) {
+			status = release_all_pending_msgs(fs_sink);
+			if (status != BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_OK) {
+				goto error;
+			}
+		}
+
+		if (fs_sink->writers) {
+			/* Make sure the writers wrote everything */
+			status = reclaim_all_writer_ops(fs_sink, true);
+			if (status != BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_OK) {
+				goto error;
+			}
+		}
+
 		/* TODO: Finalize all traces (should already be done?) */
 		status = BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_END;
 		break;
@@ -1098,6 +2110,11 @@ bt_component_class_sink_consume_method_status ctf_fs_sink_consume(
 
 error:
 	BT_ASSERT(status != BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_OK);
+	BT_COMP_LOGE_APPEND_CAUSE(fs_sink->self_comp,
+		"Failed to handle message: "
+		"generated CTF traces could be incomplete: "
+		"output-dir-path=\"%s\"",
+		fs_sink->output_dir_path->str);
 	put_messages(msgs, msg_count);
 
 end:
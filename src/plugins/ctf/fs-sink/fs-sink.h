@@ -11,6 +11,112 @@
 #include <babeltrace2/babeltrace.h>
 #include <stdbool.h>
 #include <glib.h>
+#include <stdint.h>
+
+#include "plugins/ctf/common/raw-packet.h"
+
+struct fs_sink_stream;
+struct fs_sink_ctf_event_class;
+
+/*
+ * Maximum number of messages which the component routes to a writer
+ * (see `struct fs_sink_writer`) and which it did not release yet.
+ */
+#define FS_SINK_WRITER_OPS_CAPACITY	1024
+
+/* Suffix of the metadata and data stream files which the component compresses */
+#define FS_SINK_GZ_SUFFIX		".gz"
+
+/*
+ * Message of which a writer or ctf_fs_sink_consume() writes the
+ * contents to the file of a stream.
+ *
+ * ctf_fs_sink_consume() does everything which involves the state of a
+ * trace, shared by its streams, before it routes the message: borrowing
+ * or creating the stream, translating the event class, and choosing
+ * between encoding and copying a raw packet.
+ */
+struct fs_sink_writer_op {
+	/* Owned by this when within `struct fs_sink_writer` */
+	const bt_message *msg;
+
+	/* Weak */
+	struct fs_sink_stream *stream;
+
+	/* Translated event class of an event message (weak) */
+	struct fs_sink_ctf_event_class *ec;
+
+	/*
+	 * Raw packet to copy for a packet beginning message, or `NULL`
+	 * to encode the packet.
+	 *
+	 * Weak: the packet of `msg` owns it.
+	 */
+	const struct ctf_raw_packet *raw_packet;
+};
+
+/*
+ * Writer of a subset of the streams of the component, handling their
+ * messages, in order, on the component's writer thread pool.
+ *
+ * At most one job for this writer is queued or running on the thread
+ * pool at any time, and while it is, only this job may use the streams
+ * of the pending operations.
+ *
+ * `ops` is a ring buffer of `FS_SINK_WRITER_OPS_CAPACITY` operations,
+ * indexed with free running counters (modulo the capacity):
+ *
+ * * [`reclaimed_count`, `handled_count`[: operations which the
+ *   writer handled and of which ctf_fs_sink_consume() must release the
+ *   message.
+ *
+ * * [`handled_count`, `pushed_count`[: operations which the writer
+ *   needs to handle.
+ *
+ * A writer never changes the reference count of a library object, nor
+ * creates one (for example, by materializing the payload field of an
+ * event): the library doesn't support this concurrently with the
+ * graph's thread.
+ */
+struct fs_sink_writer {
+	/* Weak */
+	struct fs_sink_comp *fs_sink;
+
+	/* Owned by this */
+	struct fs_sink_writer_op *ops;
+
+	/* Only accessed by the graph's thread */
+	uint64_t reclaimed_count;
+
+	/* Protects all the members below; owned by this */
+	GMutex *lock;
+
+	/*
+	 * Signaled when a job handles operations or ends while
+	 * `consumer_waiting` is true; owned by this.
+	 */
+	GCond *cond;
+
+	uint64_t handled_count;
+	uint64_t pushed_count;
+
+	/* True while a job is queued or running */
+	bool job_pending;
+
+	/* True while the graph's thread waits on `cond` */
+	bool consumer_waiting;
+
+	/*
+	 * Status of the first operation which failed, or
+	 * `BT_COMPONENT_CLASS_SINK_CONSUME_METHOD_STATUS_OK`, with
+	 * `error` (owned by this, `NULL` once ctf_fs_sink_consume()
+	 * reports it).
+	 *
+	 * The writer skips all its operations after a failure.
+	 */
+	bt_component_class_sink_consume_method_status status;
+	const struct bt_error *error;
+};
 
 struct fs_sink_comp {
 	bt_logging_level log_level;
@@ -36,12 +142,43 @@ struct fs_sink_comp {
 	/* True to completely ignore discarded packets messages */
 	bool ignore_discarded_packets;
 
+	/*
+	 * True to copy the original bytes of the packets which have a
+	 * raw packet (see `struct ctf_raw_packet`) instead of encoding
+	 * their events.
+	 */
+	bool copy_raw_packets;
+
+	/*
+	 * True to write gzip-compressed metadata and data stream files,
+	 * each packet being its own gzip member.
+	 */
+	bool compress;
+
 	/*
 	 * True to make the component quiet (nothing printed to the
 	 * standard output).
 	 */
 	bool quiet;
 
+	/*
+	 * Number of writer threads, and therefore of writers (0 to
+	 * handle all the messages from ctf_fs_sink_consume()).
+	 */
+	uint64_t writer_thread_count;
+
+	/* Owned by this; `NULL` if `writer_thread_count` is 0 */
+	GThreadPool *writer_thread_pool;
+
+	/*
+	 * Array of `struct fs_sink_writer *` (owned by this) of
+	 * `writer_thread_count` elements.
+	 */
+	GPtrArray *writers;
+
+	/* Index, within `writers`, of the writer of the next stream */
+	guint next_writer_index;
+
 	/*
 	 * Hash table of `const bt_trace *` (weak) to
 	 * `struct fs_sink_trace *` (owned by hash table).
@@ -15,6 +15,7 @@
 #include "common/macros.h"
 #include "common/common.h"
 #include "common/assert.h"
+#include "common/align.h"
 #include <stdio.h>
 #include <stdbool.h>
 #include <string.h>
@@ -1595,6 +1596,178 @@ end:
 	return ret;
 }
 
+/*
+ * Sets `*item_type` and `*size` (bytes) to the serialization plan run
+ * item type and size of `fc`, returning whether or not a field of
+ * which the class is `fc` can be part of a serialization plan run.
+ */
+static
+bool get_ser_plan_item_type(struct fs_sink_ctf_field_class *fc,
+		enum fs_sink_ctf_ser_plan_item_type *item_type,
+		unsigned int *size)
+{
+	bool is_item = false;
+	struct fs_sink_ctf_field_class_bit_array *bit_array_fc;
+
+	switch (fc->type) {
+	case FS_SINK_CTF_FIELD_CLASS_TYPE_BOOL:
+		*item_type = FS_SINK_CTF_SER_PLAN_ITEM_TYPE_BOOL;
+		break;
+	case FS_SINK_CTF_FIELD_CLASS_TYPE_BIT_ARRAY:
+		*item_type = FS_SINK_CTF_SER_PLAN_ITEM_TYPE_BIT_ARRAY;
+		break;
+	case FS_SINK_CTF_FIELD_CLASS_TYPE_INT:
+		*item_type = ((struct fs_sink_ctf_field_class_int *) fc)->is_signed ?
+			FS_SINK_CTF_SER_PLAN_ITEM_TYPE_SIGNED_INT :
+			FS_SINK_CTF_SER_PLAN_ITEM_TYPE_UNSIGNED_INT;
+		break;
+	case FS_SINK_CTF_FIELD_CLASS_TYPE_FLOAT:
+		*item_type = ((struct fs_sink_ctf_field_class_float *) fc)->base.size == 32 ?
+			FS_SINK_CTF_SER_PLAN_ITEM_TYPE_FLOAT32 :
+			FS_SINK_CTF_SER_PLAN_ITEM_TYPE_FLOAT64;
+		break;
+	default:
+		goto end;
+	}
+
+	bit_array_fc = (void *) fc;
+	if (fc->alignment % 8 != 0) {
+		goto end;
+	}
+
+	switch (bit_array_fc->size) {
+	case 8:
+	case 16:
+	case 32:
+	case 64:
+		break;
+	default:
+		goto end;
+	}
+
+	*size = bit_array_fc->size / 8;
+	is_item = true;
+
+end:
+	return is_item;
+}
+
+/*
+ * Compiles the serialization plan of the structure field class `fc`.
+ *
+ * Leaves `fc->ser_plan` as `NULL` if a plan would have no runs.
+ */
+static
+void compile_struct_ser_plan(struct fs_sink_ctf_field_class_struct *fc)
+{
+	struct fs_sink_ctf_ser_plan *plan = fs_sink_ctf_ser_plan_create();
+	struct fs_sink_ctf_ser_plan_op *run_op = NULL;
+	bool has_runs = false;
+	uint64_t i;
+
+	for (i = 0; i < fc->members->len; i++) {
+		struct fs_sink_ctf_field_class *member_fc =
+			fs_sink_ctf_field_class_struct_borrow_member_by_index(
+				fc, i)->fc;
+		struct fs_sink_ctf_ser_plan_item item;
+		struct fs_sink_ctf_ser_plan_op op = { 0 };
+
+		if (!get_ser_plan_item_type(member_fc, &item.type,
+				&item.size)) {
+			op.type = FS_SINK_CTF_SER_PLAN_OP_TYPE_FIELD;
+			op.u.field.member_index = i;
+			op.u.field.fc = member_fc;
+			g_array_append_val(plan->ops, op);
+			run_op = NULL;
+			continue;
+		}
+
+		/*
+		 * The offsets of the members of a run are fixed only if
+		 * their alignments divide the run's alignment: start a
+		 * new run otherwise.
+		 */
+		if (!run_op || member_fc->alignment > run_op->u.run.alignment) {
+			op.type = FS_SINK_CTF_SER_PLAN_OP_TYPE_RUN;
+			op.u.run.alignment = member_fc->alignment;
+			op.u.run.first_item_index = plan->items->len;
+			g_array_append_val(plan->ops, op);
+			run_op = &g_array_index(plan->ops,
+				struct fs_sink_ctf_ser_plan_op,
+				plan->ops->len - 1);
+			has_runs = true;
+		}
+
+		item.member_index = i;
+		item.offset = ALIGN(run_op->u.run.size * 8,
+			member_fc->alignment) / 8;
+		run_op->u.run.size = item.offset + item.size;
+		run_op->u.run.item_count++;
+		g_array_append_val(plan->items, item);
+	}
+
+	if (!has_runs) {
+		fs_sink_ctf_ser_plan_destroy(plan);
+		plan = NULL;
+	}
+
+	BT_ASSERT(!fc->ser_plan);
+	fc->ser_plan = plan;
+}
+
+/*
+ * Compiles the serialization plans of all the structure field classes
+ * within `fc` (including `fc` itself).
+ */
+static
+void compile_ser_plans(struct fs_sink_ctf_field_class *fc)
+{
+	uint64_t i;
+
+	if (!fc) {
+		return;
+	}
+
+	switch (fc->type) {
+	case FS_SINK_CTF_FIELD_CLASS_TYPE_STRUCT:
+	{
+		struct fs_sink_ctf_field_class_struct *struct_fc = (void *) fc;
+
+		for (i = 0; i < struct_fc->members->len; i++) {
+			compile_ser_plans(
+				fs_sink_ctf_field_class_struct_borrow_member_by_index(
+					struct_fc, i)->fc);
+		}
+
+		compile_struct_ser_plan(struct_fc);
+		break;
+	}
+	case FS_SINK_CTF_FIELD_CLASS_TYPE_ARRAY:
+	case FS_SINK_CTF_FIELD_CLASS_TYPE_SEQUENCE:
+		compile_ser_plans(
+			((struct fs_sink_ctf_field_class_array_base *) fc)->elem_fc);
+		break;
+	case FS_SINK_CTF_FIELD_CLASS_TYPE_OPTION:
+		compile_ser_plans(
+			((struct fs_sink_ctf_field_class_option *) fc)->content_fc);
+		break;
+	case FS_SINK_CTF_FIELD_CLASS_TYPE_VARIANT:
+	{
+		struct fs_sink_ctf_field_class_variant *var_fc = (void *) fc;
+
+		for (i = 0; i < var_fc->options->len; i++) {
+			compile_ser_plans(
+				fs_sink_ctf_field_class_variant_borrow_option_by_index(
+					var_fc, i)->fc);
+		}
+
+		break;
+	}
+	default:
+		break;
+	}
+}
+
 static inline
 void ctx_init(struct ctx *ctx, struct fs_sink_comp *fs_sink)
 {
@@ -1648,6 +1821,10 @@ int translate_event_class(struct fs_sink_comp *fs_sink,
 		goto end;
 	}
 
+	/* Event fields are serialized on the hot path: compile plans */
+	compile_ser_plans(ec->spec_context_fc);
+	compile_ser_plans(ec->payload_fc);
+
 end:
 	ctx_fini(&ctx);
 	*out_ec = ec;
@@ -1791,6 +1968,8 @@ int translate_stream_class(struct fs_sink_comp *fs_sink,
 		goto error;
 	}
 
+	compile_ser_plans((*out_sc)->event_common_context_fc);
+
 	goto end;
 
 error:
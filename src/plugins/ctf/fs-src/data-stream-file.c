@@ -17,6 +17,7 @@
 #include <stdlib.h>
 #include <glib.h>
 #include <inttypes.h>
+#include <sys/stat.h>
 #include "compat/mman.h"
 #include "compat/endian.h"
 #include <babeltrace2/babeltrace.h>
@@ -24,8 +25,10 @@
 #include "file.h"
 #include "metadata.h"
 #include "../common/msg-iter/msg-iter.h"
+#include "../common/raw-packet.h"
 #include "common/assert.h"
 #include "data-stream-file.h"
+#include "index-cache.h"
 #include <string.h>
 
 static inline
@@ -61,6 +64,13 @@ enum ctf_msg_iter_medium_status ds_file_munmap(
 		goto end;
 	}
 
+	if (ds_file->gz_reader) {
+		/* Decompressed data: nothing to unmap */
+		ds_file->mmap_addr = NULL;
+		status = CTF_MSG_ITER_MEDIUM_STATUS_OK;
+		goto end;
+	}
+
 	if (bt_munmap(ds_file->mmap_addr, ds_file->mmap_len)) {
 		BT_COMP_LOGE_ERRNO("Cannot memory-unmap file",
 			": address=%p, size=%zu, file_path=\"%s\", file=%p",
@@ -78,6 +88,89 @@ end:
 	return status;
 }
 
+/*
+ * Asks the kernel to read, in the background, the rest of the current
+ * mapping of `ds_file` as well as its `read_ahead_window_count` next
+ * windows, skipping what it was already asked to read.
+ */
+static
+void ds_file_read_ahead(struct ctf_fs_ds_file *ds_file)
+{
+	bt_self_component *self_comp = ds_file->self_comp;
+	bt_logging_level log_level = ds_file->log_level;
+	off_t begin = ds_file->mmap_offset_in_file +
+		ds_file->request_offset_in_mapping;
+	off_t end = ds_file->mmap_offset_in_file + ds_file->mmap_len;
+	size_t window_len = ds_file->mmap_window_len;
+	uint64_t i;
+	int ret;
+
+	for (i = 0; i < ds_file->read_ahead_window_count &&
+			end < ds_file->file->size; i++) {
+		window_len = MIN(window_len * 2, ds_file->mmap_max_len);
+		end += MIN(ds_file->file->size - end, window_len);
+	}
+
+	begin = MAX(begin, ds_file->read_ahead_end_offset_in_file);
+	if (end <= begin) {
+		goto end;
+	}
+
+	ret = bt_mmap_read_ahead(fileno(ds_file->file->fp), begin,
+		end - begin);
+	if (ret) {
+		/* Only a hint: the mapping still works without it */
+		BT_COMP_LOGD("Cannot read data stream file ahead: "
+			"file-path=\"%s\", offset=%jd, size=%jd: %s",
+			ds_file->file->path->str, (intmax_t) begin,
+			(intmax_t) (end - begin), g_strerror(ret));
+	}
+
+	ds_file->read_ahead_end_offset_in_file = end;
+
+end:
+	return;
+}
+
+/*
+ * Decompresses the region of the gzip-compressed `ds_file` which starts
+ * at `requested_offset_in_file` into its decompressed data buffer,
+ * making it the current "mapping".
+ */
+static
+enum ctf_msg_iter_medium_status ds_file_gz_read(
+		struct ctf_fs_ds_file *ds_file, off_t requested_offset_in_file)
+{
+	enum ctf_msg_iter_medium_status status;
+	bt_self_component *self_comp = ds_file->self_comp;
+	bt_logging_level log_level = ds_file->log_level;
+	const size_t len = MIN(ds_file->file->size - requested_offset_in_file,
+		ds_file->mmap_max_len);
+
+	/* Invalidate the current mapping until the new one is complete */
+	ds_file->mmap_addr = NULL;
+	ds_file->mmap_len = 0;
+	ds_file->mmap_offset_in_file = requested_offset_in_file;
+	ds_file->request_offset_in_mapping = 0;
+
+	if (ctf_fs_gz_reader_read(ds_file->gz_reader,
+			requested_offset_in_file, ds_file->gz_buf, len)) {
+		BT_COMP_LOGE("Cannot decompress data stream file: "
+			"file-path=\"%s\", offset=%jd",
+			ds_file->file->path->str,
+			(intmax_t) requested_offset_in_file);
+		status = CTF_MSG_ITER_MEDIUM_STATUS_ERROR;
+		goto end;
+	}
+
+	ds_file->mmap_addr = ds_file->gz_buf;
+	ds_file->mmap_len = len;
+	status = CTF_MSG_ITER_MEDIUM_STATUS_OK;
+
+end:
+	return status;
+}
+
 /*
  * mmap a region of `ds_file` such that `requested_offset_in_file` is in the
  * mapping.  If the currently mmap-ed region already contains
@@ -112,6 +205,27 @@ enum ctf_msg_iter_medium_status ds_file_mmap(
 		goto end;
 	}
 
+	if (ds_file->gz_reader) {
+		status = ds_file_gz_read(ds_file, requested_offset_in_file);
+		goto end;
+	}
+
+	/*
+	 * In read-ahead mode, grow the window while the file is read
+	 * sequentially, and start over with a small one after a seek.
+	 */
+	if (ds_file->io_mode == CTF_FS_DS_FILE_IO_MODE_READ_AHEAD) {
+		if (ds_file->mmap_addr && requested_offset_in_file ==
+				ds_file->mmap_offset_in_file + ds_file->mmap_len) {
+			ds_file->mmap_window_len = MIN(
+				ds_file->mmap_window_len * 2,
+				ds_file->mmap_max_len);
+		} else {
+			ds_file->mmap_window_len = ds_file->mmap_min_len;
+			ds_file->read_ahead_end_offset_in_file = 0;
+		}
+	}
+
 	/* Unmap old region */
 	status = ds_file_munmap(ds_file);
 	if (status != CTF_MSG_ITER_MEDIUM_STATUS_OK) {
@@ -127,13 +241,35 @@ enum ctf_msg_iter_medium_status ds_file_mmap(
 	ds_file->mmap_offset_in_file =
 		requested_offset_in_file - ds_file->request_offset_in_mapping;
 	ds_file->mmap_len = MIN(ds_file->file->size - ds_file->mmap_offset_in_file,
-		ds_file->mmap_max_len);
+		ds_file->mmap_window_len);
 
 	BT_ASSERT(ds_file->mmap_len > 0);
 
 	ds_file->mmap_addr = bt_mmap((void *) 0, ds_file->mmap_len,
 			PROT_READ, MAP_PRIVATE, fileno(ds_file->file->fp),
 			ds_file->mmap_offset_in_file, ds_file->log_level);
+	if (ds_file->mmap_addr == MAP_FAILED &&
+			ds_file->io_mode == CTF_FS_DS_FILE_IO_MODE_WHOLE_FILE &&
+			ds_file->mmap_len > ds_file->mmap_max_len) {
+		/*
+		 * Not enough address space to map the whole file: fall
+		 * back to fixed-size windows for this file.
+		 */
+		BT_COMP_LOGI("Cannot memory-map whole file: "
+			"falling back to windows: "
+			"file-path=\"%s\", size=%zu: %s",
+			ds_file->file->path->str, ds_file->mmap_len,
+			strerror(errno));
+		ds_file->io_mode = CTF_FS_DS_FILE_IO_MODE_WINDOW;
+		ds_file->mmap_window_len = ds_file->mmap_max_len;
+		ds_file->mmap_len = MIN(
+			ds_file->file->size - ds_file->mmap_offset_in_file,
+			ds_file->mmap_window_len);
+		ds_file->mmap_addr = bt_mmap((void *) 0, ds_file->mmap_len,
+				PROT_READ, MAP_PRIVATE, fileno(ds_file->file->fp),
+				ds_file->mmap_offset_in_file, ds_file->log_level);
+	}
+
 	if (ds_file->mmap_addr == MAP_FAILED) {
 		BT_COMP_LOGE("Cannot memory-map address (size %zu) of file \"%s\" (%p) at offset %jd: %s",
 				ds_file->mmap_len, ds_file->file->path->str,
@@ -143,6 +279,10 @@ enum ctf_msg_iter_medium_status ds_file_mmap(
 		goto end;
 	}
 
+	if (ds_file->io_mode == CTF_FS_DS_FILE_IO_MODE_READ_AHEAD) {
+		ds_file_read_ahead(ds_file);
+	}
+
 	status = CTF_MSG_ITER_MEDIUM_STATUS_OK;
 
 end:
@@ -422,6 +562,66 @@ end:
 	return status;
 }
 
+static
+enum ctf_msg_iter_medium_status medop_group_packet_created(bt_packet *packet,
+		void *void_data)
+{
+	struct ctf_fs_ds_group_medops_data *data = void_data;
+	struct ctf_raw_packet_metadata *metadata =
+		data->ds_file_group->ctf_fs_trace->metadata->raw_packet_metadata;
+	struct ctf_fs_ds_index_entry *index_entry;
+	struct ctf_raw_packet *raw_packet;
+	enum ctf_msg_iter_medium_status status = CTF_MSG_ITER_MEDIUM_STATUS_OK;
+	bt_logging_level log_level = data->log_level;
+
+	/*
+	 * The bytes of a packet of a gzip-compressed data stream file
+	 * aren't at its index entry's offset in the file.
+	 */
+	if (!metadata || data->file->gz_reader) {
+		goto end;
+	}
+
+	/* medop_group_switch_packet() went past the current packet */
+	BT_ASSERT(data->next_index_entry_index > 0);
+	index_entry = g_ptr_array_index(data->ds_file_group->index->entries,
+		data->next_index_entry_index - 1);
+	raw_packet = ctf_raw_packet_create(metadata, index_entry->path,
+		index_entry->offset, index_entry->packet_size);
+	if (!raw_packet) {
+		BT_MSG_ITER_LOGE_APPEND_CAUSE(data->self_msg_iter,
+			"Failed to create a raw packet.");
+		status = CTF_MSG_ITER_MEDIUM_STATUS_MEMORY_ERROR;
+		goto end;
+	}
+
+	bt_packet_set_raw_data(packet, CTF_RAW_PACKET_FORMAT, raw_packet,
+		ctf_raw_packet_destroy);
+
+end:
+	return status;
+}
+
+static
+enum ctf_msg_iter_medium_status medop_group_packet_ended(bt_packet *packet,
+		uint64_t event_count,
+		__attribute__((unused)) void *void_data)
+{
+	/*
+	 * medop_group_packet_created() created this raw packet: the
+	 * packet only exposes it as a constant object to the other
+	 * components.
+	 */
+	struct ctf_raw_packet *raw_packet =
+		(struct ctf_raw_packet *) ctf_raw_packet_borrow(packet);
+
+	if (raw_packet) {
+		raw_packet->event_count = event_count;
+	}
+
+	return CTF_MSG_ITER_MEDIUM_STATUS_OK;
+}
+
 BT_HIDDEN
 void ctf_fs_ds_group_medops_data_destroy(
 		struct ctf_fs_ds_group_medops_data *data)
@@ -486,10 +686,21 @@ void ctf_fs_ds_group_medops_data_reset(struct ctf_fs_ds_group_medops_data *data)
 	data->next_index_entry_index = 0;
 }
 
+void ctf_fs_ds_group_medops_data_seek_index_entry(
+		struct ctf_fs_ds_group_medops_data *data,
+		guint index_entry_index)
+{
+	BT_ASSERT(data);
+	BT_ASSERT(index_entry_index <= data->ds_file_group->index->entries->len);
+	data->next_index_entry_index = index_entry_index;
+}
+
 struct ctf_msg_iter_medium_ops ctf_fs_ds_group_medops = {
 	.request_bytes = medop_group_request_bytes,
 	.borrow_stream = medop_group_borrow_stream,
 	.switch_packet = medop_group_switch_packet,
+	.packet_created = medop_group_packet_created,
+	.packet_ended = medop_group_packet_ended,
 
 	/*
 	 * We don't support seeking using this medops.  It would probably be
@@ -589,6 +800,15 @@ struct ctf_fs_ds_index *build_index_from_idx_file(
 		goto error;
 	}
 
+	/*
+	 * The index of a compressed data stream file is the one of the
+	 * uncompressed file.
+	 */
+	if (ctf_fs_gz_is_compressed_path(index_basename->str)) {
+		g_string_truncate(index_basename, index_basename->len -
+			strlen(CTF_FS_GZ_SUFFIX));
+	}
+
 	g_string_append(index_basename, ".idx");
 	index_file_path = g_build_filename(directory, "index",
 			index_basename->str, NULL);
@@ -909,6 +1129,373 @@ error:
 	goto end;
 }
 
+/*
+ * Returns the path of the index cache file of `ds_file` within
+ * `cache_dir`, to free with g_free().
+ *
+ * The name of the cache file is a digest of the data stream file's
+ * path, which is absolute, so that data stream files with the same
+ * name in different traces share the same cache directory.
+ */
+static
+gchar *get_index_cache_file_path(struct ctf_fs_ds_file *ds_file,
+		const char *cache_dir)
+{
+	gchar *digest;
+	gchar *basename;
+	gchar *path;
+
+	digest = g_compute_checksum_for_string(G_CHECKSUM_SHA1,
+		ds_file->file->path->str, -1);
+	basename = g_strdup_printf("%s.btidx", digest);
+	path = g_build_filename(cache_dir, basename, NULL);
+	g_free(basename);
+	g_free(digest);
+	return path;
+}
+
+/*
+ * Identity of a data stream file, as recorded in its index cache file.
+ */
+struct ds_file_stamp {
+	uint64_t mtime_sec;
+	uint64_t mtime_nsec;
+	uint64_t dev;
+	uint64_t ino;
+};
+
+static
+int get_ds_file_stamp(struct ctf_fs_ds_file *ds_file,
+		struct ds_file_stamp *stamp)
+{
+	struct stat st;
+	int ret;
+
+	ret = fstat(fileno(ds_file->file->fp), &st);
+	if (ret) {
+		goto end;
+	}
+
+	stamp->mtime_sec = (uint64_t) st.st_mtime;
+#ifdef HAVE_STRUCT_STAT_ST_MTIM
+	stamp->mtime_nsec = (uint64_t) st.st_mtim.tv_nsec;
+#else
+	stamp->mtime_nsec = 0;
+#endif
+	stamp->dev = (uint64_t) st.st_dev;
+	stamp->ino = (uint64_t) st.st_ino;
+
+end:
+	return ret;
+}
+
+static
+struct ctf_fs_ds_index *build_index_from_cache_file(
+		struct ctf_fs_ds_file *ds_file,
+		struct ctf_fs_ds_file_info *file_info,
+		struct ctf_msg_iter *msg_iter,
+		const char *cache_dir)
+{
+	int ret;
+	gchar *cache_file_path = NULL;
+	gchar *contents = NULL;
+	gsize contents_len;
+	const char *file_pos;
+	const struct ctf_fs_index_cache_file_hdr *header;
+	struct ctf_fs_ds_index *index = NULL;
+	struct ctf_fs_ds_index_entry *index_entry = NULL;
+	struct ctf_stream_class *sc;
+	struct ctf_msg_iter_packet_properties props;
+	uint64_t total_packets_size = 0;
+	uint64_t entry_count;
+	struct ds_file_stamp stamp;
+	size_t path_len;
+	uint64_t i;
+	bt_self_component *self_comp = ds_file->self_comp;
+	bt_logging_level log_level = ds_file->log_level;
+
+	BT_COMP_LOGI("Building index from cache file of stream file %s",
+		ds_file->file->path->str);
+	ret = ctf_msg_iter_get_packet_properties(msg_iter, &props);
+	if (ret) {
+		BT_COMP_LOGI_STR("Cannot read first packet's header and context fields.");
+		goto error;
+	}
+
+	sc = ctf_trace_class_borrow_stream_class_by_id(ds_file->metadata->tc,
+		props.stream_class_id);
+	BT_ASSERT(sc);
+
+	if (get_ds_file_stamp(ds_file, &stamp)) {
+		BT_COMP_LOGW("Cannot get status of stream file %s",
+			ds_file->file->path->str);
+		goto error;
+	}
+
+	cache_file_path = get_index_cache_file_path(ds_file, cache_dir);
+	if (!g_file_get_contents(cache_file_path, &contents, &contents_len,
+			NULL)) {
+		BT_COMP_LOGD("Cannot read index cache file %s",
+			cache_file_path);
+		goto error;
+	}
+
+	if (contents_len < sizeof(*header)) {
+		BT_COMP_LOGW("Invalid index cache file: "
+			"file size (%zu bytes) < header size (%zu bytes)",
+			(size_t) contents_len, sizeof(*header));
+		goto error;
+	}
+
+	header = (const struct ctf_fs_index_cache_file_hdr *) contents;
+	if (be32toh(header->magic) != CTF_FS_INDEX_CACHE_MAGIC ||
+			be32toh(header->version) != CTF_FS_INDEX_CACHE_VERSION ||
+			be32toh(header->entry_len) !=
+				sizeof(struct ctf_fs_index_cache_entry)) {
+		BT_COMP_LOGW("Invalid or unsupported index cache file: %s",
+			cache_file_path);
+		goto error;
+	}
+
+	/* Make sure the cache is about this data stream file */
+	path_len = be32toh(header->path_len);
+	if (path_len != ds_file->file->path->len ||
+			contents_len - sizeof(*header) < path_len ||
+			memcmp(contents + sizeof(*header),
+				ds_file->file->path->str, path_len) != 0) {
+		BT_COMP_LOGI("Index cache file is about another stream file: %s",
+			cache_file_path);
+		goto error;
+	}
+
+	/* Make sure the data stream file didn't change since */
+	if (be64toh(header->file_size) != (uint64_t) ds_file->file->size ||
+			be64toh(header->file_mtime_sec) != stamp.mtime_sec ||
+			be64toh(header->file_mtime_nsec) != stamp.mtime_nsec ||
+			be64toh(header->file_dev) != stamp.dev ||
+			be64toh(header->file_ino) != stamp.ino) {
+		BT_COMP_LOGI("Index cache file is outdated: path=%s, "
+			"cached-size=%" PRIu64 ", size=%jd, "
+			"cached-mtime=%" PRIu64 ".%09" PRIu64 ", "
+			"mtime=%" PRIu64 ".%09" PRIu64 ", "
+			"cached-dev=%" PRIu64 ", dev=%" PRIu64 ", "
+			"cached-ino=%" PRIu64 ", ino=%" PRIu64,
+			cache_file_path, (uint64_t) be64toh(header->file_size),
+			(intmax_t) ds_file->file->size,
+			(uint64_t) be64toh(header->file_mtime_sec),
+			(uint64_t) be64toh(header->file_mtime_nsec),
+			stamp.mtime_sec, stamp.mtime_nsec,
+			(uint64_t) be64toh(header->file_dev), stamp.dev,
+			(uint64_t) be64toh(header->file_ino), stamp.ino);
+		goto error;
+	}
+
+	entry_count = be64toh(header->entry_count);
+	if ((contents_len - sizeof(*header) - path_len) /
+				sizeof(struct ctf_fs_index_cache_entry) !=
+				entry_count ||
+			(contents_len - sizeof(*header) - path_len) %
+				sizeof(struct ctf_fs_index_cache_entry) != 0) {
+		BT_COMP_LOGW("Invalid index cache file: unexpected size: "
+			"file-size=%zu, entry-count=%" PRIu64,
+			(size_t) contents_len, entry_count);
+		goto error;
+	}
+
+	index = ctf_fs_ds_index_create(ds_file->log_level, ds_file->self_comp);
+	if (!index) {
+		goto error;
+	}
+
+	file_pos = contents + sizeof(*header) + path_len;
+
+	for (i = 0; i < entry_count; i++) {
+		const struct ctf_fs_index_cache_entry *file_entry =
+			(const struct ctf_fs_index_cache_entry *) file_pos;
+
+		index_entry = ctf_fs_ds_index_entry_create(
+			ds_file->self_comp, ds_file->log_level);
+		if (!index_entry) {
+			BT_COMP_LOGE_APPEND_CAUSE(ds_file->self_comp,
+				"Failed to create a ctf_fs_ds_index_entry.");
+			goto error;
+		}
+
+		/* Set path to stream file. */
+		index_entry->path = file_info->path->str;
+		index_entry->offset = be64toh(file_entry->offset);
+		index_entry->packet_size = be64toh(file_entry->packet_size);
+
+		/* Packets are contiguous within a data stream file */
+		if (index_entry->offset != total_packets_size ||
+				index_entry->packet_size == 0) {
+			BT_COMP_LOGW("Invalid packet offset or size in index cache file: "
+				"offset=%" PRIu64 ", expected-offset=%" PRIu64 ", "
+				"size=%" PRIu64, index_entry->offset,
+				total_packets_size, index_entry->packet_size);
+			goto error;
+		}
+
+		index_entry->timestamp_begin =
+			be64toh(file_entry->timestamp_begin);
+		index_entry->timestamp_end = be64toh(file_entry->timestamp_end);
+		index_entry->timestamp_begin_ns = UINT64_C(-1);
+		index_entry->timestamp_end_ns = UINT64_C(-1);
+
+		if ((index_entry->timestamp_begin != UINT64_C(-1) ||
+				index_entry->timestamp_end != UINT64_C(-1)) &&
+				!sc->default_clock_class) {
+			BT_COMP_LOGW_STR("Invalid index cache file: "
+				"packet has time bounds, but stream class has no default clock class.");
+			goto error;
+		}
+
+		/* Convert the packet's bounds to nanoseconds since Epoch. */
+		if (index_entry->timestamp_begin != UINT64_C(-1)) {
+			ret = convert_cycles_to_ns(sc->default_clock_class,
+				index_entry->timestamp_begin,
+				&index_entry->timestamp_begin_ns);
+			if (ret) {
+				BT_COMP_LOGI_STR("Failed to convert raw timestamp to nanoseconds since Epoch.");
+				goto error;
+			}
+		}
+
+		if (index_entry->timestamp_end != UINT64_C(-1)) {
+			ret = convert_cycles_to_ns(sc->default_clock_class,
+				index_entry->timestamp_end,
+				&index_entry->timestamp_end_ns);
+			if (ret) {
+				BT_COMP_LOGI_STR("Failed to convert raw timestamp to nanoseconds since Epoch.");
+				goto error;
+			}
+		}
+
+		index_entry->packet_seq_num = be64toh(file_entry->packet_seq_num);
+		total_packets_size += index_entry->packet_size;
+		file_pos += sizeof(*file_entry);
+
+		/* Give ownership of `index_entry` to `index->entries`. */
+		g_ptr_array_add(index->entries, index_entry);
+		index_entry = NULL;
+	}
+
+	/* Validate that the index addresses the complete stream. */
+	if (ds_file->file->size != total_packets_size) {
+		BT_COMP_LOGW("Invalid index cache file; indexed size != stream file size: "
+			"file-size=%" PRIu64 ", total-packets-size=%" PRIu64,
+			ds_file->file->size, total_packets_size);
+		goto error;
+	}
+
+	goto end;
+
+error:
+	ctf_fs_ds_index_destroy(index);
+	g_free(index_entry);
+	index = NULL;
+
+end:
+	g_free(contents);
+	g_free(cache_file_path);
+	return index;
+}
+
+/*
+ * Writes `index`, the index of `ds_file`, to its cache file within
+ * `cache_dir`.
+ *
+ * Failing to write the cache file is not an error: the next time,
+ * the component indexes the stream file again.
+ */
+static
+void write_index_cache_file(struct ctf_fs_ds_file *ds_file,
+		struct ctf_fs_ds_index *index, const char *cache_dir)
+{
+	struct ctf_fs_index_cache_file_hdr header;
+	GByteArray *contents = NULL;
+	gchar *cache_file_path = NULL;
+	GError *gerror = NULL;
+	struct ds_file_stamp stamp;
+	guint i;
+	bt_self_component *self_comp = ds_file->self_comp;
+	bt_logging_level log_level = ds_file->log_level;
+
+	if (get_ds_file_stamp(ds_file, &stamp)) {
+		BT_COMP_LOGW("Cannot get status of stream file %s",
+			ds_file->file->path->str);
+		goto end;
+	}
+
+	if (g_mkdir_with_parents(cache_dir, 0755)) {
+		BT_COMP_LOGW("Cannot create index cache directory %s: %s",
+			cache_dir, g_strerror(errno));
+		goto end;
+	}
+
+	contents = g_byte_array_sized_new(sizeof(header) +
+		ds_file->file->path->len +
+		index->entries->len * sizeof(struct ctf_fs_index_cache_entry));
+	if (!contents) {
+		BT_COMP_LOGW_STR("Failed to allocate a GByteArray.");
+		goto end;
+	}
+
+	header.magic = htobe32(CTF_FS_INDEX_CACHE_MAGIC);
+	header.version = htobe32(CTF_FS_INDEX_CACHE_VERSION);
+	header.entry_len = htobe32(sizeof(struct ctf_fs_index_cache_entry));
+	header.path_len = htobe32(ds_file->file->path->len);
+	header.file_size = htobe64((uint64_t) ds_file->file->size);
+	header.file_mtime_sec = htobe64(stamp.mtime_sec);
+	header.file_mtime_nsec = htobe64(stamp.mtime_nsec);
+	header.file_dev = htobe64(stamp.dev);
+	header.file_ino = htobe64(stamp.ino);
+	header.entry_count = htobe64(index->entries->len);
+	g_byte_array_append(contents, (const guint8 *) &header, sizeof(header));
+	g_byte_array_append(contents,
+		(const guint8 *) ds_file->file->path->str,
+		ds_file->file->path->len);
+
+	for (i = 0; i < index->entries->len; i++) {
+		struct ctf_fs_ds_index_entry *index_entry =
+			g_ptr_array_index(index->entries, i);
+		struct ctf_fs_index_cache_entry file_entry;
+
+		file_entry.offset = htobe64(index_entry->offset);
+		file_entry.packet_size = htobe64(index_entry->packet_size);
+		file_entry.timestamp_begin =
+			htobe64(index_entry->timestamp_begin);
+		file_entry.timestamp_end = htobe64(index_entry->timestamp_end);
+		file_entry.packet_seq_num =
+			htobe64(index_entry->packet_seq_num);
+		g_byte_array_append(contents, (const guint8 *) &file_entry,
+			sizeof(file_entry));
+	}
+
+	cache_file_path = get_index_cache_file_path(ds_file, cache_dir);
+
+	/* This writes a temporary file and renames it: no partial file */
+	if (!g_file_set_contents(cache_file_path, (const gchar *) contents->data,
+			contents->len, &gerror)) {
+		BT_COMP_LOGW("Cannot write index cache file %s: %s",
+			cache_file_path, gerror->message);
+		g_error_free(gerror);
+		goto end;
+	}
+
+	BT_COMP_LOGI("Wrote index cache file: stream-file-path=%s, "
+		"cache-file-path=%s, entry-count=%u",
+		ds_file->file->path->str, cache_file_path,
+		index->entries->len);
+
+end:
+	if (contents) {
+		g_byte_array_free(contents, TRUE);
+	}
+
+	g_free(cache_file_path);
+}
+
 BT_HIDDEN
 struct ctf_fs_ds_file *ctf_fs_ds_file_create(
 		struct ctf_fs_trace *ctf_fs_trace,
@@ -918,6 +1505,7 @@ struct ctf_fs_ds_file *ctf_fs_ds_file_create(
 {
 	int ret;
 	const size_t offset_align = bt_mmap_get_offset_align_size(log_level);
+	bt_self_component *self_comp = ctf_fs_trace->self_comp;
 	struct ctf_fs_ds_file *ds_file = g_new0(struct ctf_fs_ds_file, 1);
 
 	if (!ds_file) {
@@ -943,6 +1531,61 @@ struct ctf_fs_ds_file *ctf_fs_ds_file_create(
 
 	ds_file->mmap_max_len = offset_align * 2048;
 
+	/*
+	 * Only a message iterator reads a whole data stream file: the
+	 * indexing step only reads its packet headers and contexts, so
+	 * it keeps fixed-size windows.
+	 */
+	ds_file->io_mode = self_msg_iter ?
+		ctf_fs_trace->ds_file_io_config.mode :
+		CTF_FS_DS_FILE_IO_MODE_WINDOW;
+	ds_file->read_ahead_window_count =
+		ctf_fs_trace->ds_file_io_config.read_ahead_window_count;
+
+	if (ctf_fs_gz_is_compressed_path(path)) {
+		const struct ctf_fs_gz_index *gz_index;
+
+		/*
+		 * Decompress fixed-size windows: the other I/O modes
+		 * only make sense for a memory mapping.
+		 */
+		ds_file->io_mode = CTF_FS_DS_FILE_IO_MODE_WINDOW;
+		gz_index = ctf_fs_gz_index_cache_borrow_index(
+			ctf_fs_trace->gz_index_cache, ds_file->file->fp,
+			path, log_level, self_comp);
+		if (!gz_index) {
+			BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+				"Cannot index gzip-compressed data stream file: "
+				"path=\"%s\"", path);
+			goto error;
+		}
+
+		ds_file->file->size = ctf_fs_gz_index_get_size(gz_index);
+		ds_file->gz_reader = ctf_fs_gz_reader_create(gz_index,
+			ds_file->file->fp, ds_file->file->path->str,
+			log_level, self_comp);
+		ds_file->gz_buf = g_malloc(ds_file->mmap_max_len);
+		if (!ds_file->gz_reader || !ds_file->gz_buf) {
+			goto error;
+		}
+	}
+
+	switch (ds_file->io_mode) {
+	case CTF_FS_DS_FILE_IO_MODE_WINDOW:
+		ds_file->mmap_window_len = ds_file->mmap_max_len;
+		break;
+	case CTF_FS_DS_FILE_IO_MODE_READ_AHEAD:
+		ds_file->mmap_min_len = offset_align * 256;
+		ds_file->mmap_max_len = offset_align * 16384;
+		ds_file->mmap_window_len = ds_file->mmap_min_len;
+		break;
+	case CTF_FS_DS_FILE_IO_MODE_WHOLE_FILE:
+		ds_file->mmap_window_len = SIZE_MAX;
+		break;
+	default:
+		bt_common_abort();
+	}
+
 	goto end;
 
 error:
@@ -958,7 +1601,8 @@ BT_HIDDEN
 struct ctf_fs_ds_index *ctf_fs_ds_file_build_index(
 		struct ctf_fs_ds_file *ds_file,
 		struct ctf_fs_ds_file_info *file_info,
-		struct ctf_msg_iter *msg_iter)
+		struct ctf_msg_iter *msg_iter,
+		const char *index_cache_dir)
 {
 	struct ctf_fs_ds_index *index;
 	bt_self_component *self_comp = ds_file->self_comp;
@@ -969,9 +1613,22 @@ struct ctf_fs_ds_index *ctf_fs_ds_file_build_index(
 		goto end;
 	}
 
+	if (index_cache_dir) {
+		index = build_index_from_cache_file(ds_file, file_info,
+			msg_iter, index_cache_dir);
+		if (index) {
+			goto end;
+		}
+	}
+
 	BT_COMP_LOGI("Failed to build index from .index file; "
 		"falling back to stream indexing.");
 	index = build_index_from_stream_file(ds_file, file_info, msg_iter);
+
+	if (index && index_cache_dir) {
+		write_index_cache_file(ds_file, index, index_cache_dir);
+	}
+
 end:
 	return index;
 }
@@ -1013,6 +1670,8 @@ void ctf_fs_ds_file_destroy(struct ctf_fs_ds_file *ds_file)
 
 	bt_stream_put_ref(ds_file->stream);
 	(void) ds_file_munmap(ds_file);
+	ctf_fs_gz_reader_destroy(ds_file->gz_reader);
+	g_free(ds_file->gz_buf);
 
 	if (ds_file->file) {
 		ctf_fs_file_destroy(ds_file->file);
@@ -14,7 +14,8 @@
 #include <babeltrace2/babeltrace.h>
 
 #include "../common/msg-iter/msg-iter.h"
-#include "lttng-index.h"
+#include "gz-file.h"
+#include "../common/lttng-index.h"
 
 struct ctf_fs_component;
 struct ctf_fs_file;
@@ -33,6 +34,35 @@ struct ctf_fs_ds_file_info {
 
 struct ctf_fs_metadata;
 
+/*
+ * How a data stream file which a message iterator reads gets mapped
+ * into memory.
+ */
+enum ctf_fs_ds_file_io_mode {
+	/* Fixed-size windows, mapped on demand */
+	CTF_FS_DS_FILE_IO_MODE_WINDOW,
+
+	/*
+	 * Windows which grow while the file is read sequentially, the
+	 * kernel reading the next ones ahead in the background.
+	 */
+	CTF_FS_DS_FILE_IO_MODE_READ_AHEAD,
+
+	/* Whole file, when the address space allows it */
+	CTF_FS_DS_FILE_IO_MODE_WHOLE_FILE,
+};
+
+struct ctf_fs_ds_file_io_config {
+	enum ctf_fs_ds_file_io_mode mode;
+
+	/*
+	 * Number of windows, following the current one, which the
+	 * kernel reads ahead in `CTF_FS_DS_FILE_IO_MODE_READ_AHEAD`
+	 * mode.
+	 */
+	uint64_t read_ahead_window_count;
+};
+
 struct ctf_fs_ds_file {
 	bt_logging_level log_level;
 
@@ -51,14 +81,43 @@ struct ctf_fs_ds_file {
 	/* Owned by this */
 	bt_stream *stream;
 
+	/*
+	 * Reader of the file when it's gzip-compressed, owned by this,
+	 * or `NULL`.
+	 *
+	 * In this case, the "mapping" is the decompressed data which
+	 * `gz_buf` (`mmap_max_len` bytes, owned by this) contains, and
+	 * the file's size is its uncompressed size.
+	 */
+	struct ctf_fs_gz_reader *gz_reader;
+	uint8_t *gz_buf;
+
 	void *mmap_addr;
 
+	enum ctf_fs_ds_file_io_mode io_mode;
+
+	/* Number of windows to read ahead (read-ahead mode) */
+	uint64_t read_ahead_window_count;
+
 	/*
 	 * Max length of chunk to mmap() when updating the current mapping.
 	 * This value must be page-aligned.
 	 */
 	size_t mmap_max_len;
 
+	/*
+	 * Length of the first chunk to mmap() after a seek (read-ahead
+	 * mode). This value must be page-aligned.
+	 */
+	size_t mmap_min_len;
+
+	/*
+	 * Length of the chunk to mmap() when updating the current
+	 * mapping, between `mmap_min_len` and `mmap_max_len`
+	 * (read-ahead mode), or `SIZE_MAX` (whole file mode).
+	 */
+	size_t mmap_window_len;
+
 	/* Length of the current mapping. Never exceeds the file's length. */
 	size_t mmap_len;
 
@@ -70,6 +129,12 @@ struct ctf_fs_ds_file {
 	 * request.
 	 */
 	off_t request_offset_in_mapping;
+
+	/*
+	 * Offset in the file up to which the kernel was asked to read
+	 * ahead (read-ahead mode).
+	 */
+	off_t read_ahead_end_offset_in_file;
 };
 
 BT_HIDDEN
@@ -86,7 +151,8 @@ BT_HIDDEN
 struct ctf_fs_ds_index *ctf_fs_ds_file_build_index(
 		struct ctf_fs_ds_file *ds_file,
 		struct ctf_fs_ds_file_info *ds_file_info,
-		struct ctf_msg_iter *msg_iter);
+		struct ctf_msg_iter *msg_iter,
+		const char *index_cache_dir);
 
 BT_HIDDEN
 struct ctf_fs_ds_index *ctf_fs_ds_index_create(bt_logging_level log_level,
@@ -123,6 +189,19 @@ enum ctf_msg_iter_medium_status ctf_fs_ds_group_medops_data_create(
 BT_HIDDEN
 void ctf_fs_ds_group_medops_data_reset(struct ctf_fs_ds_group_medops_data *data);
 
+/*
+ * Make the next packet switch of `data` go to the packet described by
+ * the index entry at position `index_entry_index` within the group's
+ * index.
+ *
+ * If `index_entry_index` is the index's entry count, the next packet
+ * switch reports the end of the group.
+ */
+BT_HIDDEN
+void ctf_fs_ds_group_medops_data_seek_index_entry(
+		struct ctf_fs_ds_group_medops_data *data,
+		guint index_entry_index);
+
 BT_HIDDEN
 void ctf_fs_ds_group_medops_data_destroy(
 		struct ctf_fs_ds_group_medops_data *data);
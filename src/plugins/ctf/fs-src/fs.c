@@ -17,6 +17,7 @@
 #include "common/uuid.h"
 #include <glib.h>
 #include "common/assert.h"
+#include "compat/glib.h"
 #include <inttypes.h>
 #include <stdbool.h>
 #include "fs.h"
@@ -29,6 +30,24 @@
 #include "query.h"
 #include "plugins/common/param-validation/param-validation.h"
 
+/*
+ * Maximum number of decoded messages which a message iterator keeps
+ * ahead of what it returned when decoding on a worker thread.
+ */
+#define CTF_FS_DECODED_MSGS_CAPACITY	1024
+
+/*
+ * Maximum number of messages which a worker thread decodes before
+ * making them available to the message iterator.
+ */
+#define CTF_FS_DECODING_BATCH_SIZE	32
+
+/*
+ * Maximum time (µs) during which a message iterator waits for its
+ * decoding job before checking whether or not it's interrupted.
+ */
+#define CTF_FS_DECODING_WAIT_TIMEOUT_US	(100 * 1000)
+
 struct tracer_info {
 	const char *name;
 	int64_t major;
@@ -36,6 +55,64 @@ struct tracer_info {
 	int64_t patch;
 };
 
+static
+void clear_seek_msgs(struct ctf_fs_msg_iter_data *msg_iter_data)
+{
+	while (!g_queue_is_empty(msg_iter_data->seek_msgs)) {
+		bt_message_put_ref(g_queue_pop_head(msg_iter_data->seek_msgs));
+	}
+}
+
+static
+void release_next_saved_error(struct ctf_fs_msg_iter_data *msg_iter_data)
+{
+	if (msg_iter_data->next_saved_error) {
+		bt_error_release(msg_iter_data->next_saved_error);
+		msg_iter_data->next_saved_error = NULL;
+	}
+}
+
+/*
+ * Makes the decoding job of `msg_iter_data`, if any, return, waits for
+ * it, and discards everything it decoded ahead.
+ *
+ * After this, the caller may use `msg_iter_data->msg_iter` again.
+ */
+static
+void stop_decoding(struct ctf_fs_msg_iter_data *msg_iter_data)
+{
+	if (!msg_iter_data->decoding.msgs) {
+		return;
+	}
+
+	g_mutex_lock(msg_iter_data->decoding.lock);
+	msg_iter_data->decoding.stop = true;
+
+	while (msg_iter_data->decoding.job_pending) {
+		msg_iter_data->decoding.consumer_waiting = true;
+		g_cond_wait(msg_iter_data->decoding.cond,
+			msg_iter_data->decoding.lock);
+		msg_iter_data->decoding.consumer_waiting = false;
+	}
+
+	msg_iter_data->decoding.stop = false;
+
+	while (!g_queue_is_empty(msg_iter_data->decoding.msgs)) {
+		bt_message_put_ref(
+			g_queue_pop_head(msg_iter_data->decoding.msgs));
+	}
+
+	msg_iter_data->decoding.status =
+		BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK;
+
+	if (msg_iter_data->decoding.error) {
+		bt_error_release(msg_iter_data->decoding.error);
+		msg_iter_data->decoding.error = NULL;
+	}
+
+	g_mutex_unlock(msg_iter_data->decoding.lock);
+}
+
 static
 void ctf_fs_msg_iter_data_destroy(
 		struct ctf_fs_msg_iter_data *msg_iter_data)
@@ -44,6 +121,21 @@ void ctf_fs_msg_iter_data_destroy(
 		return;
 	}
 
+	if (msg_iter_data->decoding.msgs) {
+		stop_decoding(msg_iter_data);
+		g_queue_free(msg_iter_data->decoding.msgs);
+	}
+
+	bt_g_cond_free(msg_iter_data->decoding.cond);
+	bt_g_mutex_free(msg_iter_data->decoding.lock);
+
+	if (msg_iter_data->seek_msgs) {
+		clear_seek_msgs(msg_iter_data);
+		g_queue_free(msg_iter_data->seek_msgs);
+	}
+
+	release_next_saved_error(msg_iter_data);
+
 	if (msg_iter_data->msg_iter) {
 		ctf_msg_iter_destroy(msg_iter_data->msg_iter);
 	}
@@ -105,6 +197,200 @@ bt_message_iterator_class_next_method_status ctf_fs_iterator_next_one(
 	return status;
 }
 
+/*
+ * Decoding job of a message iterator, running on one of the threads of
+ * the component's decoding thread pool.
+ *
+ * The job decodes messages, in batches, until the queue of decoded
+ * messages is full, until the CTF message iterator ends or fails, or
+ * until the message iterator asks it to stop.
+ */
+static
+void decode_ahead(gpointer data, __attribute__((unused)) gpointer user_data)
+{
+	struct ctf_fs_msg_iter_data *msg_iter_data = data;
+	bt_message_iterator_class_next_method_status status =
+		BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK;
+	const bt_message *batch[CTF_FS_DECODING_BATCH_SIZE];
+
+	g_mutex_lock(msg_iter_data->decoding.lock);
+
+	while (!msg_iter_data->decoding.stop &&
+			status == BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK) {
+		guint room = CTF_FS_DECODED_MSGS_CAPACITY -
+			g_queue_get_length(msg_iter_data->decoding.msgs);
+		guint count = 0;
+		guint i;
+
+		if (room == 0) {
+			break;
+		}
+
+		room = MIN(room, CTF_FS_DECODING_BATCH_SIZE);
+
+		/* Decode without holding the lock */
+		g_mutex_unlock(msg_iter_data->decoding.lock);
+
+		while (count < room &&
+				status == BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK) {
+			status = ctf_fs_iterator_next_one(msg_iter_data,
+				&batch[count]);
+			if (status == BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK) {
+				count++;
+			}
+		}
+
+		g_mutex_lock(msg_iter_data->decoding.lock);
+
+		for (i = 0; i < count; i++) {
+			g_queue_push_tail(msg_iter_data->decoding.msgs,
+				(gpointer) batch[i]);
+		}
+
+		if (status != BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK) {
+			msg_iter_data->decoding.status = status;
+
+			if (status < 0) {
+				/*
+				 * The error belongs to this worker
+				 * thread: hand it over to the graph's
+				 * thread.
+				 */
+				msg_iter_data->decoding.error =
+					bt_current_thread_take_error();
+			}
+		}
+
+		if (msg_iter_data->decoding.consumer_waiting) {
+			g_cond_signal(msg_iter_data->decoding.cond);
+		}
+	}
+
+	msg_iter_data->decoding.job_pending = false;
+
+	if (msg_iter_data->decoding.consumer_waiting) {
+		g_cond_signal(msg_iter_data->decoding.cond);
+	}
+
+	g_mutex_unlock(msg_iter_data->decoding.lock);
+}
+
+/*
+ * Queues a decoding job for `msg_iter_data` if there's none and if
+ * decoding is not done.
+ *
+ * Call with `msg_iter_data->decoding.lock` held.
+ */
+static
+int schedule_decoding(struct ctf_fs_msg_iter_data *msg_iter_data)
+{
+	int ret = 0;
+	GError *gerror = NULL;
+	bt_logging_level log_level = msg_iter_data->log_level;
+	bt_self_component *self_comp = msg_iter_data->self_comp;
+
+	if (msg_iter_data->decoding.job_pending ||
+			msg_iter_data->decoding.status !=
+				BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK) {
+		goto end;
+	}
+
+	msg_iter_data->decoding.job_pending = true;
+	g_thread_pool_push(msg_iter_data->decoding.thread_pool,
+		msg_iter_data, &gerror);
+	if (gerror) {
+		BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+			"Cannot queue decoding job: %s", gerror->message);
+		msg_iter_data->decoding.job_pending = false;
+		g_error_free(gerror);
+		ret = -1;
+	}
+
+end:
+	return ret;
+}
+
+/*
+ * Moves up to `capacity - *count` messages which a worker thread
+ * decoded ahead to `msgs`, starting at `*count`, waiting for the worker
+ * thread if there's none yet.
+ *
+ * Returns the status which ended the decoding once all the decoded
+ * messages are returned, or
+ * `BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_AGAIN` if the message
+ * iterator is interrupted while waiting and `*count` is 0.
+ */
+static
+bt_message_iterator_class_next_method_status get_decoded_msgs(
+		struct ctf_fs_msg_iter_data *msg_iter_data,
+		bt_message_array_const msgs, uint64_t capacity,
+		uint64_t *count)
+{
+	bt_message_iterator_class_next_method_status status =
+		BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK;
+	GQueue *decoded_msgs = msg_iter_data->decoding.msgs;
+
+	g_mutex_lock(msg_iter_data->decoding.lock);
+
+	while (g_queue_is_empty(decoded_msgs) &&
+			msg_iter_data->decoding.status ==
+				BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK) {
+		if (schedule_decoding(msg_iter_data)) {
+			status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_ERROR;
+			goto end;
+		}
+
+		if (bt_self_message_iterator_is_interrupted(
+				msg_iter_data->self_msg_iter)) {
+			if (*count == 0) {
+				status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_AGAIN;
+			}
+
+			goto end;
+		}
+
+		msg_iter_data->decoding.consumer_waiting = true;
+		bt_g_cond_wait_for(msg_iter_data->decoding.cond,
+			msg_iter_data->decoding.lock,
+			CTF_FS_DECODING_WAIT_TIMEOUT_US);
+		msg_iter_data->decoding.consumer_waiting = false;
+	}
+
+	while (*count < capacity && !g_queue_is_empty(decoded_msgs)) {
+		msgs[*count] = g_queue_pop_head(decoded_msgs);
+		(*count)++;
+	}
+
+	if (g_queue_is_empty(decoded_msgs) &&
+			msg_iter_data->decoding.status !=
+				BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK) {
+		/* Decoding is done and we returned everything */
+		status = msg_iter_data->decoding.status;
+
+		if (msg_iter_data->decoding.error) {
+			BT_CURRENT_THREAD_MOVE_ERROR_AND_RESET(
+				msg_iter_data->decoding.error);
+		}
+
+		goto end;
+	}
+
+	/*
+	 * Keep the worker thread busy, but don't queue a job for only a
+	 * few messages.
+	 */
+	if (g_queue_get_length(decoded_msgs) <=
+			CTF_FS_DECODED_MSGS_CAPACITY / 2) {
+		if (schedule_decoding(msg_iter_data)) {
+			status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_ERROR;
+		}
+	}
+
+end:
+	g_mutex_unlock(msg_iter_data->decoding.lock);
+	return status;
+}
+
 BT_HIDDEN
 bt_message_iterator_class_next_method_status ctf_fs_iterator_next(
 		bt_self_message_iterator *iterator,
@@ -127,13 +413,29 @@ bt_message_iterator_class_next_method_status ctf_fs_iterator_next(
 		goto end;
 	}
 
-	do {
-		status = ctf_fs_iterator_next_one(msg_iter_data, &msgs[i]);
-		if (status == BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK) {
-			i++;
+	/* Return what the last seek operation left first. */
+	while (i < capacity && !g_queue_is_empty(msg_iter_data->seek_msgs)) {
+		msgs[i] = g_queue_pop_head(msg_iter_data->seek_msgs);
+		i++;
+	}
+
+	status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK;
+
+	if (msg_iter_data->decoding.msgs) {
+		if (i < capacity) {
+			status = get_decoded_msgs(msg_iter_data, msgs,
+				capacity, &i);
 		}
-	} while (i < capacity &&
-			status == BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK);
+	} else {
+		while (i < capacity &&
+				status == BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK) {
+			status = ctf_fs_iterator_next_one(msg_iter_data,
+				&msgs[i]);
+			if (status == BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK) {
+				i++;
+			}
+		}
+	}
 
 	if (i > 0) {
 		/*
@@ -176,12 +478,442 @@ ctf_fs_iterator_seek_beginning(bt_self_message_iterator *it)
 
 	BT_ASSERT(msg_iter_data);
 
+	stop_decoding(msg_iter_data);
+	clear_seek_msgs(msg_iter_data);
+	release_next_saved_error(msg_iter_data);
 	ctf_msg_iter_reset(msg_iter_data->msg_iter);
 	ctf_fs_ds_group_medops_data_reset(msg_iter_data->msg_iter_medops_data);
 
 	return BT_MESSAGE_ITERATOR_CLASS_SEEK_BEGINNING_METHOD_STATUS_OK;
 }
 
+BT_HIDDEN
+bt_message_iterator_class_can_seek_ns_from_origin_method_status
+ctf_fs_iterator_can_seek_ns_from_origin(bt_self_message_iterator *it,
+		int64_t ns_from_origin, bt_bool *can_seek)
+{
+	struct ctf_fs_msg_iter_data *msg_iter_data =
+		bt_self_message_iterator_get_data(it);
+
+	BT_ASSERT(msg_iter_data);
+
+	/*
+	 * If the index doesn't have time bounds, the library falls back
+	 * to seeking the beginning and fast-forwarding.
+	 */
+	*can_seek = msg_iter_data->can_seek_ns_from_origin;
+	return BT_MESSAGE_ITERATOR_CLASS_CAN_SEEK_NS_FROM_ORIGIN_METHOD_STATUS_OK;
+}
+
+/*
+ * Returns the position, within `index`, of the first entry of which the
+ * end time is greater than or equal to `ns_from_origin`, or the
+ * index's entry count if there's none.
+ *
+ * The entries of a data stream file group's index are sorted by time
+ * and their packets don't overlap, so that their end times are sorted
+ * too.
+ */
+static
+guint find_index_entry_by_ns_from_origin(struct ctf_fs_ds_index *index,
+		int64_t ns_from_origin)
+{
+	guint low = 0;
+	guint high = index->entries->len;
+
+	while (low < high) {
+		const guint mid = low + (high - low) / 2;
+		const struct ctf_fs_ds_index_entry *entry =
+			g_ptr_array_index(index->entries, mid);
+
+		if (entry->timestamp_end_ns < ns_from_origin) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+
+	return low;
+}
+
+/*
+ * Sets `*ns_from_origin` to the time of the default clock snapshot of
+ * `msg` (the beginning one for a discarded items message) and
+ * `*has_cs` to true, or sets `*has_cs` to false if `msg` has no
+ * default clock snapshot.
+ */
+static
+int get_msg_ns_from_origin(const bt_message *msg, int64_t *ns_from_origin,
+		bool *has_cs)
+{
+	const bt_clock_snapshot *cs = NULL;
+	const bt_stream_class *sc;
+	int ret = 0;
+
+	switch (bt_message_get_type(msg)) {
+	case BT_MESSAGE_TYPE_EVENT:
+		cs = bt_message_event_borrow_default_clock_snapshot_const(msg);
+		break;
+	case BT_MESSAGE_TYPE_PACKET_BEGINNING:
+		sc = bt_stream_borrow_class_const(bt_packet_borrow_stream_const(
+			bt_message_packet_beginning_borrow_packet_const(msg)));
+		if (bt_stream_class_packets_have_beginning_default_clock_snapshot(sc)) {
+			cs = bt_message_packet_beginning_borrow_default_clock_snapshot_const(
+				msg);
+		}
+		break;
+	case BT_MESSAGE_TYPE_PACKET_END:
+		sc = bt_stream_borrow_class_const(bt_packet_borrow_stream_const(
+			bt_message_packet_end_borrow_packet_const(msg)));
+		if (bt_stream_class_packets_have_end_default_clock_snapshot(sc)) {
+			cs = bt_message_packet_end_borrow_default_clock_snapshot_const(
+				msg);
+		}
+		break;
+	case BT_MESSAGE_TYPE_DISCARDED_EVENTS:
+		sc = bt_stream_borrow_class_const(
+			bt_message_discarded_events_borrow_stream_const(msg));
+		if (bt_stream_class_discarded_events_have_default_clock_snapshots(sc)) {
+			cs = bt_message_discarded_events_borrow_beginning_default_clock_snapshot_const(
+				msg);
+		}
+		break;
+	case BT_MESSAGE_TYPE_DISCARDED_PACKETS:
+		sc = bt_stream_borrow_class_const(
+			bt_message_discarded_packets_borrow_stream_const(msg));
+		if (bt_stream_class_discarded_packets_have_default_clock_snapshots(sc)) {
+			cs = bt_message_discarded_packets_borrow_beginning_default_clock_snapshot_const(
+				msg);
+		}
+		break;
+	case BT_MESSAGE_TYPE_STREAM_BEGINNING:
+	case BT_MESSAGE_TYPE_STREAM_END:
+		/* The CTF message iterator never sets those. */
+		break;
+	default:
+		bt_common_abort();
+	}
+
+	*has_cs = cs != NULL;
+
+	if (cs) {
+		ret = bt_clock_snapshot_get_ns_from_origin(cs, ns_from_origin);
+	}
+
+	return ret;
+}
+
+/*
+ * Creates a copy of the discarded items message `msg`, of which the
+ * time range contains `ns_from_origin`, which begins at
+ * `begin_raw_value` instead and which has no item count, as we don't
+ * know how many items were discarded within the new time range.
+ */
+static
+const bt_message *create_cut_discarded_items_msg(
+		struct ctf_fs_msg_iter_data *msg_iter_data,
+		const bt_message *msg, uint64_t begin_raw_value)
+{
+	const bt_message *new_msg;
+
+	if (bt_message_get_type(msg) == BT_MESSAGE_TYPE_DISCARDED_EVENTS) {
+		new_msg = bt_message_discarded_events_create_with_default_clock_snapshots(
+			msg_iter_data->self_msg_iter,
+			bt_message_discarded_events_borrow_stream_const(msg),
+			begin_raw_value,
+			bt_clock_snapshot_get_value(
+				bt_message_discarded_events_borrow_end_default_clock_snapshot_const(
+					msg)));
+	} else {
+		BT_ASSERT(bt_message_get_type(msg) ==
+			BT_MESSAGE_TYPE_DISCARDED_PACKETS);
+		new_msg = bt_message_discarded_packets_create_with_default_clock_snapshots(
+			msg_iter_data->self_msg_iter,
+			bt_message_discarded_packets_borrow_stream_const(msg),
+			begin_raw_value,
+			bt_clock_snapshot_get_value(
+				bt_message_discarded_packets_borrow_end_default_clock_snapshot_const(
+					msg)));
+	}
+
+	return new_msg;
+}
+
+/*
+ * Decodes and discards the messages of the data stream file group
+ * until the first one of which the time is greater than or equal to
+ * `ns_from_origin`, putting the messages which ctf_fs_iterator_next()
+ * must return first into `msg_iter_data->seek_msgs`.
+ *
+ * Like the library's automatic seeking, this function puts the stream
+ * back in its state at `ns_from_origin` by prepending stream beginning
+ * and packet beginning messages (with `ns_from_origin` as their time,
+ * if possible) as needed.
+ */
+static
+bt_message_iterator_class_seek_ns_from_origin_method_status
+fast_forward_to_ns_from_origin(struct ctf_fs_msg_iter_data *msg_iter_data,
+		int64_t ns_from_origin)
+{
+	bt_message_iterator_class_seek_ns_from_origin_method_status status;
+	bt_logging_level log_level = msg_iter_data->log_level;
+	bt_self_component *self_comp = msg_iter_data->self_comp;
+	struct ctf_clock_class *cc =
+		msg_iter_data->ds_file_group->sc->default_clock_class;
+	const bt_message *msg = NULL;
+	const bt_message *stream_beginning_msg = NULL;
+	const bt_message *packet_beginning_msg = NULL;
+	bool seen_cs = false;
+	bool got_first = false;
+	uint64_t raw_value = 0;
+	int ret;
+
+	BT_ASSERT(cc);
+	ret = bt_common_clock_value_from_ns_from_origin(cc->offset_seconds,
+		cc->offset_cycles, cc->frequency, ns_from_origin, &raw_value);
+
+	while (!got_first) {
+		bt_message_iterator_class_next_method_status next_status;
+		int64_t msg_ns_from_origin;
+		bool has_cs;
+
+		next_status = ctf_fs_iterator_next_one(msg_iter_data, &msg);
+		if (next_status == BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_END) {
+			break;
+		} else if (next_status != BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK) {
+			/* ctf_fs_iterator_next_one() appends error causes */
+			status = (int) next_status;
+			goto end;
+		}
+
+		if (get_msg_ns_from_origin(msg, &msg_ns_from_origin, &has_cs)) {
+			BT_MSG_ITER_LOGE_APPEND_CAUSE(msg_iter_data->self_msg_iter,
+				"Cannot get message's time: msg-addr=%p", msg);
+			status = BT_MESSAGE_ITERATOR_CLASS_SEEK_NS_FROM_ORIGIN_METHOD_STATUS_ERROR;
+			goto end;
+		}
+
+		if (has_cs && msg_ns_from_origin >= ns_from_origin) {
+			got_first = true;
+			g_queue_push_tail(msg_iter_data->seek_msgs,
+				(void *) BT_MOVE_REF(msg));
+			break;
+		}
+
+		seen_cs = seen_cs || has_cs;
+
+		switch (bt_message_get_type(msg)) {
+		case BT_MESSAGE_TYPE_STREAM_BEGINNING:
+			BT_MESSAGE_MOVE_REF(stream_beginning_msg, msg);
+			break;
+		case BT_MESSAGE_TYPE_PACKET_BEGINNING:
+			BT_MESSAGE_MOVE_REF(packet_beginning_msg, msg);
+			break;
+		case BT_MESSAGE_TYPE_PACKET_END:
+			BT_MESSAGE_PUT_REF_AND_RESET(packet_beginning_msg);
+			break;
+		case BT_MESSAGE_TYPE_STREAM_END:
+			BT_MESSAGE_PUT_REF_AND_RESET(stream_beginning_msg);
+			break;
+		case BT_MESSAGE_TYPE_DISCARDED_EVENTS:
+		case BT_MESSAGE_TYPE_DISCARDED_PACKETS:
+		{
+			const bt_clock_snapshot *end_cs;
+			int64_t end_ns_from_origin;
+
+			if (!has_cs) {
+				break;
+			}
+
+			if (bt_message_get_type(msg) ==
+					BT_MESSAGE_TYPE_DISCARDED_EVENTS) {
+				end_cs = bt_message_discarded_events_borrow_end_default_clock_snapshot_const(
+					msg);
+			} else {
+				end_cs = bt_message_discarded_packets_borrow_end_default_clock_snapshot_const(
+					msg);
+			}
+
+			if (bt_clock_snapshot_get_ns_from_origin(end_cs,
+					&end_ns_from_origin)) {
+				BT_MSG_ITER_LOGE_APPEND_CAUSE(msg_iter_data->self_msg_iter,
+					"Cannot get discarded items message's end time: "
+					"msg-addr=%p", msg);
+				status = BT_MESSAGE_ITERATOR_CLASS_SEEK_NS_FROM_ORIGIN_METHOD_STATUS_ERROR;
+				goto end;
+			}
+
+			if (end_ns_from_origin >= ns_from_origin) {
+				/*
+				 * The discarded items time range contains
+				 * the seeking time: keep its part after it.
+				 */
+				const bt_message *cut_msg;
+
+				if (ret) {
+					break;
+				}
+
+				cut_msg = create_cut_discarded_items_msg(
+					msg_iter_data, msg, raw_value);
+				if (!cut_msg) {
+					BT_MSG_ITER_LOGE_APPEND_CAUSE(
+						msg_iter_data->self_msg_iter,
+						"Cannot create discarded items message.");
+					status = BT_MESSAGE_ITERATOR_CLASS_SEEK_NS_FROM_ORIGIN_METHOD_STATUS_MEMORY_ERROR;
+					goto end;
+				}
+
+				g_queue_push_tail(msg_iter_data->seek_msgs,
+					(void *) cut_msg);
+			}
+
+			break;
+		}
+		default:
+			break;
+		}
+
+		BT_MESSAGE_PUT_REF_AND_RESET(msg);
+	}
+
+	/*
+	 * If we saw a clock snapshot before the seeking time, then
+	 * `ns_from_origin` is within the clock's range and the stream
+	 * was active at that time.
+	 */
+	if (seen_cs && ret) {
+		BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+			"Cannot convert nanoseconds from origin to clock value: "
+			"ns-from-origin=%" PRId64 ", clock-class-name=\"%s\"",
+			ns_from_origin, cc->name->str);
+		status = BT_MESSAGE_ITERATOR_CLASS_SEEK_NS_FROM_ORIGIN_METHOD_STATUS_ERROR;
+		goto end;
+	}
+
+	if (packet_beginning_msg) {
+		BT_ASSERT(stream_beginning_msg);
+
+		if (msg_iter_data->ds_file_group->sc->packets_have_ts_begin) {
+			const bt_message *new_msg =
+				bt_message_packet_beginning_create_with_default_clock_snapshot(
+					msg_iter_data->self_msg_iter,
+					bt_message_packet_beginning_borrow_packet_const(
+						packet_beginning_msg),
+					raw_value);
+
+			if (!new_msg) {
+				BT_MSG_ITER_LOGE_APPEND_CAUSE(
+					msg_iter_data->self_msg_iter,
+					"Cannot create packet beginning message.");
+				status = BT_MESSAGE_ITERATOR_CLASS_SEEK_NS_FROM_ORIGIN_METHOD_STATUS_MEMORY_ERROR;
+				goto end;
+			}
+
+			BT_MESSAGE_MOVE_REF(packet_beginning_msg, new_msg);
+		}
+
+		g_queue_push_head(msg_iter_data->seek_msgs,
+			(void *) BT_MOVE_REF(packet_beginning_msg));
+	}
+
+	if (stream_beginning_msg) {
+		if (seen_cs) {
+			/* We own the only reference to this message. */
+			bt_message_stream_beginning_set_default_clock_snapshot(
+				(bt_message *) stream_beginning_msg, raw_value);
+		}
+
+		g_queue_push_head(msg_iter_data->seek_msgs,
+			(void *) BT_MOVE_REF(stream_beginning_msg));
+	}
+
+	BT_COMP_LOGD("Fast-forwarded to first message at or after seeking time: "
+		"ns-from-origin=%" PRId64 ", got-first=%d, queued-msg-count=%u",
+		ns_from_origin, got_first,
+		g_queue_get_length(msg_iter_data->seek_msgs));
+	status = BT_MESSAGE_ITERATOR_CLASS_SEEK_NS_FROM_ORIGIN_METHOD_STATUS_OK;
+
+end:
+	BT_MESSAGE_PUT_REF_AND_RESET(msg);
+	BT_MESSAGE_PUT_REF_AND_RESET(stream_beginning_msg);
+	BT_MESSAGE_PUT_REF_AND_RESET(packet_beginning_msg);
+	return status;
+}
+
+BT_HIDDEN
+bt_message_iterator_class_seek_ns_from_origin_method_status
+ctf_fs_iterator_seek_ns_from_origin(bt_self_message_iterator *it,
+		int64_t ns_from_origin)
+{
+	struct ctf_fs_msg_iter_data *msg_iter_data =
+		bt_self_message_iterator_get_data(it);
+	bt_message_iterator_class_seek_ns_from_origin_method_status status;
+	bt_logging_level log_level;
+	bt_self_component *self_comp;
+	struct ctf_fs_ds_index *index;
+	guint entry_index;
+
+	BT_ASSERT(msg_iter_data);
+	BT_ASSERT(msg_iter_data->can_seek_ns_from_origin);
+	log_level = msg_iter_data->log_level;
+	self_comp = msg_iter_data->self_comp;
+	index = msg_iter_data->ds_file_group->index;
+
+	stop_decoding(msg_iter_data);
+	clear_seek_msgs(msg_iter_data);
+	release_next_saved_error(msg_iter_data);
+	ctf_msg_iter_reset(msg_iter_data->msg_iter);
+
+	/*
+	 * Find the packet which contains the seeking time, or the first
+	 * one after it, using the index instead of decoding everything
+	 * from the beginning.
+	 */
+	entry_index = find_index_entry_by_ns_from_origin(index,
+		ns_from_origin);
+	BT_COMP_LOGD("Seeking data stream file group using its index: "
+		"ns-from-origin=%" PRId64 ", index-entry-index=%u, "
+		"index-entry-count=%u", ns_from_origin, entry_index,
+		index->entries->len);
+
+	if (entry_index > 0) {
+		enum ctf_msg_iter_status msg_iter_status;
+		struct ctf_msg_iter_packet_properties props;
+
+		/*
+		 * Only decode the header and context of the previous
+		 * packet so that the CTF message iterator knows the
+		 * discarded events and packets counters before the
+		 * target packet.
+		 */
+		ctf_fs_ds_group_medops_data_seek_index_entry(
+			msg_iter_data->msg_iter_medops_data, entry_index - 1);
+		msg_iter_status = ctf_msg_iter_get_packet_properties(
+			msg_iter_data->msg_iter, &props);
+		if (msg_iter_status != CTF_MSG_ITER_STATUS_OK) {
+			BT_MSG_ITER_LOGE_APPEND_CAUSE(msg_iter_data->self_msg_iter,
+				"Cannot read packet's header and context fields: "
+				"index-entry-index=%u", entry_index - 1);
+			status = msg_iter_status ==
+					CTF_MSG_ITER_STATUS_MEMORY_ERROR ?
+				BT_MESSAGE_ITERATOR_CLASS_SEEK_NS_FROM_ORIGIN_METHOD_STATUS_MEMORY_ERROR :
+				BT_MESSAGE_ITERATOR_CLASS_SEEK_NS_FROM_ORIGIN_METHOD_STATUS_ERROR;
+			goto end;
+		}
+
+		ctf_msg_iter_skip_current_packet(msg_iter_data->msg_iter);
+	} else {
+		ctf_fs_ds_group_medops_data_seek_index_entry(
+			msg_iter_data->msg_iter_medops_data, 0);
+	}
+
+	status = fast_forward_to_ns_from_origin(msg_iter_data, ns_from_origin);
+
+end:
+	return status;
+}
+
 BT_HIDDEN
 void ctf_fs_iterator_finalize(bt_self_message_iterator *it)
 {
@@ -246,13 +978,79 @@ bt_message_iterator_class_initialize_method_status ctf_fs_iterator_init(
 		goto error;
 	}
 
+	if (ctf_msg_iter_set_event_class_filter(msg_iter_data->msg_iter,
+			port_data->ctf_fs->ec_filter)) {
+		status = BT_MESSAGE_ITERATOR_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
+		goto error;
+	}
+
+	ctf_msg_iter_set_lazy_event_payloads(msg_iter_data->msg_iter,
+		port_data->ctf_fs->lazy_event_payloads);
+
+	msg_iter_data->seek_msgs = g_queue_new();
+	if (!msg_iter_data->seek_msgs) {
+		BT_COMP_LOGE_APPEND_CAUSE(self_comp, "Failed to allocate a GQueue.");
+		status = BT_MESSAGE_ITERATOR_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
+		goto error;
+	}
+
+	if (port_data->ctf_fs->decoding_thread_pool) {
+		msg_iter_data->decoding.thread_pool =
+			port_data->ctf_fs->decoding_thread_pool;
+		msg_iter_data->decoding.lock = bt_g_mutex_new();
+		msg_iter_data->decoding.cond = bt_g_cond_new();
+		if (!msg_iter_data->decoding.lock ||
+				!msg_iter_data->decoding.cond) {
+			BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+				"Failed to allocate a mutex or a condition variable.");
+			status = BT_MESSAGE_ITERATOR_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
+			goto error;
+		}
+
+		/* Only set once `lock` and `cond` exist (see stop_decoding()) */
+		msg_iter_data->decoding.msgs = g_queue_new();
+		if (!msg_iter_data->decoding.msgs) {
+			BT_COMP_LOGE_APPEND_CAUSE(self_comp, "Failed to allocate a GQueue.");
+			status = BT_MESSAGE_ITERATOR_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
+			goto error;
+		}
+
+		/*
+		 * Worker threads create and release messages, events,
+		 * packets, and clock snapshots.
+		 */
+		bt_self_message_iterator_configuration_set_is_multithreaded(
+			config, BT_TRUE);
+	}
+
 	/*
 	 * This iterator can seek forward if its stream class has a default
 	 * clock class.
 	 */
 	if (msg_iter_data->ds_file_group->sc->default_clock_class) {
+		struct ctf_fs_ds_index *index =
+			msg_iter_data->ds_file_group->index;
+		guint i;
+
 		bt_self_message_iterator_configuration_set_can_seek_forward(
 			config, true);
+
+		/*
+		 * It can also seek a given time by itself if all the
+		 * packets of its index have time bounds.
+		 */
+		msg_iter_data->can_seek_ns_from_origin = true;
+
+		for (i = 0; i < index->entries->len; i++) {
+			struct ctf_fs_ds_index_entry *entry =
+				g_ptr_array_index(index->entries, i);
+
+			if (entry->timestamp_begin == UINT64_C(-1) ||
+					entry->timestamp_end == UINT64_C(-1)) {
+				msg_iter_data->can_seek_ns_from_origin = false;
+				break;
+			}
+		}
 	}
 
 	bt_self_message_iterator_set_data(self_msg_iter,
@@ -292,6 +1090,7 @@ void ctf_fs_trace_destroy(struct ctf_fs_trace *ctf_fs_trace)
 		g_free(ctf_fs_trace->metadata);
 	}
 
+	ctf_fs_gz_index_cache_destroy(ctf_fs_trace->gz_index_cache);
 	g_free(ctf_fs_trace);
 }
 
@@ -302,12 +1101,25 @@ void ctf_fs_destroy(struct ctf_fs_component *ctf_fs)
 		return;
 	}
 
+	if (ctf_fs->decoding_thread_pool) {
+		/*
+		 * All the message iterators are finalized at this
+		 * point, so there's no job left: wait for the threads.
+		 */
+		g_thread_pool_free(ctf_fs->decoding_thread_pool, FALSE, TRUE);
+	}
+
 	ctf_fs_trace_destroy(ctf_fs->trace);
 
 	if (ctf_fs->port_data) {
 		g_ptr_array_free(ctf_fs->port_data, TRUE);
 	}
 
+	if (ctf_fs->index_cache_dir) {
+		g_string_free(ctf_fs->index_cache_dir, TRUE);
+	}
+
+	ctf_msg_iter_event_class_filter_destroy(ctf_fs->ec_filter);
 	g_free(ctf_fs);
 }
 
@@ -344,6 +1156,9 @@ struct ctf_fs_component *ctf_fs_component_create(bt_logging_level log_level,
 	}
 
 	ctf_fs->log_level = log_level;
+	ctf_fs->indexing_thread_count = 1;
+	ctf_fs->ds_file_io_config.mode = CTF_FS_DS_FILE_IO_MODE_WINDOW;
+	ctf_fs->ds_file_io_config.read_ahead_window_count = 2;
 	ctf_fs->port_data =
 		g_ptr_array_new_with_free_func(port_data_destroy_notifier);
 	if (!ctf_fs->port_data) {
@@ -689,36 +1504,208 @@ void ds_index_insert_ds_index_entry_sorted(
 }
 
 static
-void merge_ctf_fs_ds_indexes(struct ctf_fs_ds_index *dest, struct ctf_fs_ds_index *src)
+void merge_ctf_fs_ds_indexes(struct ctf_fs_ds_index *dest, struct ctf_fs_ds_index *src)
+{
+	guint i;
+
+	for (i = 0; i < src->entries->len; i++) {
+		struct ctf_fs_ds_index_entry *entry =
+			g_ptr_array_index(src->entries, i);
+
+		/*
+		* Ownership of the ctf_fs_ds_index_entry is transferred to
+		* ds_index_insert_ds_index_entry_sorted.
+		*/
+		g_ptr_array_index(src->entries, i) = NULL;
+		ds_index_insert_ds_index_entry_sorted(dest, entry);
+	}
+}
+
+/* A function call which run_jobs() makes */
+struct ctf_fs_job {
+	int (*func)(void *data);
+
+	/* Weak */
+	void *data;
+
+	/* Return value of `func` */
+	int ret;
+
+	/* Error of the thread which called `func` if `ret` isn't 0, owned by this */
+	const bt_error *error;
+};
+
+static
+void run_job(gpointer data, __attribute__((unused)) gpointer user_data)
+{
+	struct ctf_fs_job *job = data;
+
+	job->ret = job->func(job->data);
+	if (job->ret) {
+		/*
+		 * The error belongs to the current thread: hand it over
+		 * to run_jobs().
+		 */
+		job->error = bt_current_thread_take_error();
+	}
+}
+
+/*
+ * Calls `func` with each of the `count` elements of `data`, using a
+ * pool of up to `thread_count` threads when `thread_count` is greater
+ * than 1, or from the current thread otherwise.
+ *
+ * The calls must be independent from each other.
+ *
+ * If any call fails, the error of the first failing call, in `data`
+ * order, becomes the current thread's error so that the outcome never
+ * depends on the scheduling of the threads.
+ */
+static
+int run_jobs(int (*func)(void *), void **data, guint count,
+		uint64_t thread_count, bt_logging_level log_level,
+		bt_self_component *self_comp,
+		bt_self_component_class *self_comp_class)
+{
+	struct ctf_fs_job *jobs = NULL;
+	GThreadPool *pool = NULL;
+	GError *gerror = NULL;
+	guint i;
+	int ret = 0;
+
+	if (thread_count > 1 && count > 1) {
+		bt_g_thread_init();
+		pool = g_thread_pool_new(run_job, NULL,
+			(gint) MIN(thread_count, count), TRUE, &gerror);
+		if (!pool) {
+			BT_COMP_OR_COMP_CLASS_LOGW(self_comp, self_comp_class,
+				"Cannot create thread pool: "
+				"falling back to the current thread: %s",
+				gerror ? gerror->message : "unknown error");
+
+			if (gerror) {
+				g_error_free(gerror);
+				gerror = NULL;
+			}
+		}
+	}
+
+	if (!pool) {
+		for (i = 0; i < count; i++) {
+			ret = func(data[i]);
+			if (ret) {
+				goto end;
+			}
+		}
+
+		goto end;
+	}
+
+	jobs = g_new0(struct ctf_fs_job, count);
+	if (!jobs) {
+		BT_COMP_OR_COMP_CLASS_LOGE_APPEND_CAUSE(self_comp,
+			self_comp_class, "Failed to allocate jobs.");
+		g_thread_pool_free(pool, TRUE, TRUE);
+		ret = -1;
+		goto end;
+	}
+
+	for (i = 0; i < count; i++) {
+		jobs[i].func = func;
+		jobs[i].data = data[i];
+		g_thread_pool_push(pool, &jobs[i], &gerror);
+		if (gerror) {
+			/* Cannot start a new thread: call it from here */
+			g_error_free(gerror);
+			gerror = NULL;
+			run_job(&jobs[i], NULL);
+		}
+	}
+
+	/* Wait for all the jobs to finish */
+	g_thread_pool_free(pool, FALSE, TRUE);
+
+	for (i = 0; i < count; i++) {
+		if (jobs[i].ret && ret == 0) {
+			ret = jobs[i].ret;
+
+			if (jobs[i].error) {
+				bt_current_thread_move_error(jobs[i].error);
+				jobs[i].error = NULL;
+			}
+		} else if (jobs[i].error) {
+			bt_error_release(jobs[i].error);
+		}
+	}
+
+end:
+	g_free(jobs);
+	return ret;
+}
+
+/*
+ * Indexing of a single data stream file, which is independent from the
+ * indexing of the other data stream files (see create_ds_file_groups()).
+ */
+struct ds_file_indexing_job {
+	/* Weak */
+	struct ctf_fs_trace *ctf_fs_trace;
+
+	/* Owned by this */
+	gchar *path;
+
+	/* Weak, set by index_ds_file() */
+	struct ctf_stream_class *sc;
+
+	/* Set by index_ds_file(); -1 means none */
+	int64_t stream_instance_id;
+
+	/*
+	 * Owned by this, set by index_ds_file(), or `NULL` if the data
+	 * stream file is empty once decompressed
+	 */
+	struct ctf_fs_ds_file_info *ds_file_info;
+
+	/* Owned by this, set by index_ds_file() */
+	struct ctf_fs_ds_index *index;
+};
+
+static
+void ds_file_indexing_job_destroy(struct ds_file_indexing_job *job)
 {
-	guint i;
+	if (!job) {
+		return;
+	}
 
-	for (i = 0; i < src->entries->len; i++) {
-		struct ctf_fs_ds_index_entry *entry =
-			g_ptr_array_index(src->entries, i);
+	g_free(job->path);
+	ctf_fs_ds_file_info_destroy(job->ds_file_info);
+	ctf_fs_ds_index_destroy(job->index);
+	g_free(job);
+}
 
-		/*
-		* Ownership of the ctf_fs_ds_index_entry is transferred to
-		* ds_index_insert_ds_index_entry_sorted.
-		*/
-		g_ptr_array_index(src->entries, i) = NULL;
-		ds_index_insert_ds_index_entry_sorted(dest, entry);
-	}
+static
+void ds_file_indexing_job_destroy_notifier(void *data)
+{
+	ds_file_indexing_job_destroy(data);
 }
 
+/*
+ * Reads the properties of the data stream file of `data`, a
+ * `struct ds_file_indexing_job`, and builds its index.
+ *
+ * This function only reads the trace's metadata and creates no
+ * Babeltrace library object, so that the indexing jobs of different
+ * data stream files may run concurrently.
+ */
 static
-int add_ds_file_to_ds_file_group(struct ctf_fs_trace *ctf_fs_trace,
-		const char *path)
+int index_ds_file(void *data)
 {
-	int64_t stream_instance_id = -1;
+	struct ds_file_indexing_job *job = data;
+	struct ctf_fs_trace *ctf_fs_trace = job->ctf_fs_trace;
+	const char *path = job->path;
 	int64_t begin_ns = -1;
-	struct ctf_fs_ds_file_group *ds_file_group = NULL;
-	bool add_group = false;
 	int ret;
-	size_t i;
 	struct ctf_fs_ds_file *ds_file = NULL;
-	struct ctf_fs_ds_file_info *ds_file_info = NULL;
-	struct ctf_fs_ds_index *index = NULL;
 	struct ctf_msg_iter *msg_iter = NULL;
 	struct ctf_stream_class *sc = NULL;
 	struct ctf_msg_iter_packet_properties props;
@@ -736,6 +1723,13 @@ int add_ds_file_to_ds_file_group(struct ctf_fs_trace *ctf_fs_trace,
 		goto error;
 	}
 
+	if (ds_file->file->size == 0) {
+		/* Compressed empty stream: skip it */
+		BT_COMP_LOGI("Ignoring empty file `%s`", path);
+		ret = 0;
+		goto end;
+	}
+
 	/* Create a temporary iterator to read the ds_file. */
 	msg_iter = ctf_msg_iter_create(ctf_fs_trace->metadata->tc,
 		bt_common_get_page_size(log_level) * 8,
@@ -758,7 +1752,8 @@ int add_ds_file_to_ds_file_group(struct ctf_fs_trace *ctf_fs_trace,
 	sc = ctf_trace_class_borrow_stream_class_by_id(ds_file->metadata->tc,
 		props.stream_class_id);
 	BT_ASSERT(sc);
-	stream_instance_id = props.data_stream_id;
+	job->sc = sc;
+	job->stream_instance_id = props.data_stream_id;
 
 	if (props.snapshots.beginning_clock != UINT64_C(-1)) {
 		BT_ASSERT(sc->default_clock_class);
@@ -775,13 +1770,14 @@ int add_ds_file_to_ds_file_group(struct ctf_fs_trace *ctf_fs_trace,
 		}
 	}
 
-	ds_file_info = ctf_fs_ds_file_info_create(path, begin_ns);
-	if (!ds_file_info) {
+	job->ds_file_info = ctf_fs_ds_file_info_create(path, begin_ns);
+	if (!job->ds_file_info) {
 		goto error;
 	}
 
-	index = ctf_fs_ds_file_build_index(ds_file, ds_file_info, msg_iter);
-	if (!index) {
+	job->index = ctf_fs_ds_file_build_index(ds_file, job->ds_file_info,
+		msg_iter, ctf_fs_trace->index_cache_dir);
+	if (!job->index) {
 		BT_COMP_OR_COMP_CLASS_LOGE_APPEND_CAUSE(
 			self_comp, self_comp_class,
 			"Failed to index CTF stream file \'%s\'",
@@ -795,9 +1791,40 @@ int add_ds_file_to_ds_file_group(struct ctf_fs_trace *ctf_fs_trace,
 		 * within a stream file group, so consider that this
 		 * file must be the only one within its group.
 		 */
-		stream_instance_id = -1;
+		job->stream_instance_id = -1;
 	}
 
+	ret = 0;
+	goto end;
+
+error:
+	ret = -1;
+
+end:
+	ctf_fs_ds_file_destroy(ds_file);
+
+	if (msg_iter) {
+		ctf_msg_iter_destroy(msg_iter);
+	}
+
+	return ret;
+}
+
+/*
+ * Adds the data stream file which `job` indexed to its data stream file
+ * group, stealing the data stream file info and index of `job`.
+ */
+static
+int add_ds_file_to_ds_file_group(struct ctf_fs_trace *ctf_fs_trace,
+		struct ds_file_indexing_job *job)
+{
+	int64_t stream_instance_id = job->stream_instance_id;
+	struct ctf_fs_ds_file_group *ds_file_group = NULL;
+	struct ctf_stream_class *sc = job->sc;
+	bool add_group = false;
+	int ret = 0;
+	size_t i;
+
 	if (stream_instance_id == -1) {
 		/*
 		 * No stream instance ID or no beginning timestamp:
@@ -807,23 +1834,23 @@ int add_ds_file_to_ds_file_group(struct ctf_fs_trace *ctf_fs_trace,
 		 * group.
 		 */
 		ds_file_group = ctf_fs_ds_file_group_create(ctf_fs_trace,
-			sc, UINT64_C(-1), index);
+			sc, UINT64_C(-1), job->index);
 		/* Ownership of index is transferred. */
-		index = NULL;
+		job->index = NULL;
 
 		if (!ds_file_group) {
 			goto error;
 		}
 
 		ds_file_group_insert_ds_file_info_sorted(ds_file_group,
-			BT_MOVE_REF(ds_file_info));
+			BT_MOVE_REF(job->ds_file_info));
 
 		add_group = true;
 		goto end;
 	}
 
 	BT_ASSERT(stream_instance_id != -1);
-	BT_ASSERT(begin_ns != -1);
+	BT_ASSERT(job->ds_file_info->begin_ns != -1);
 
 	/* Find an existing stream file group with this ID */
 	for (i = 0; i < ctf_fs_trace->ds_file_groups->len; i++) {
@@ -841,20 +1868,20 @@ int add_ds_file_to_ds_file_group(struct ctf_fs_trace *ctf_fs_trace,
 
 	if (!ds_file_group) {
 		ds_file_group = ctf_fs_ds_file_group_create(ctf_fs_trace,
-			sc, stream_instance_id, index);
+			sc, stream_instance_id, job->index);
 		/* Ownership of index is transferred. */
-		index = NULL;
+		job->index = NULL;
 		if (!ds_file_group) {
 			goto error;
 		}
 
 		add_group = true;
 	} else {
-		merge_ctf_fs_ds_indexes(ds_file_group->index, index);
+		merge_ctf_fs_ds_indexes(ds_file_group->index, job->index);
 	}
 
 	ds_file_group_insert_ds_file_info_sorted(ds_file_group,
-		BT_MOVE_REF(ds_file_info));
+		BT_MOVE_REF(job->ds_file_info));
 
 	goto end;
 
@@ -868,14 +1895,6 @@ end:
 		g_ptr_array_add(ctf_fs_trace->ds_file_groups, ds_file_group);
 	}
 
-	ctf_fs_ds_file_destroy(ds_file);
-	ctf_fs_ds_file_info_destroy(ds_file_info);
-
-	if (msg_iter) {
-		ctf_msg_iter_destroy(msg_iter);
-	}
-
-	ctf_fs_ds_index_destroy(index);
 	return ret;
 }
 
@@ -886,10 +1905,21 @@ int create_ds_file_groups(struct ctf_fs_trace *ctf_fs_trace)
 	const char *basename;
 	GError *error = NULL;
 	GDir *dir = NULL;
+	GPtrArray *jobs = NULL;
+	guint i;
 	bt_logging_level log_level = ctf_fs_trace->log_level;
 	bt_self_component *self_comp = ctf_fs_trace->self_comp;
 	bt_self_component_class *self_comp_class = ctf_fs_trace->self_comp_class;
 
+	/* Array of struct ds_file_indexing_job *, owned by this */
+	jobs = g_ptr_array_new_with_free_func(
+		ds_file_indexing_job_destroy_notifier);
+	if (!jobs) {
+		BT_COMP_OR_COMP_CLASS_LOGE_APPEND_CAUSE(self_comp, self_comp_class,
+			"Failed to allocate a GPtrArray.");
+		goto error;
+	}
+
 	/* Check each file in the path directory, except specific ones */
 	dir = g_dir_open(ctf_fs_trace->path->str, 0, &error);
 	if (!dir) {
@@ -902,8 +1932,11 @@ int create_ds_file_groups(struct ctf_fs_trace *ctf_fs_trace)
 
 	while ((basename = g_dir_read_name(dir))) {
 		struct ctf_fs_file *file;
+		struct ds_file_indexing_job *job;
 
-		if (strcmp(basename, CTF_FS_METADATA_FILENAME) == 0) {
+		if (strcmp(basename, CTF_FS_METADATA_FILENAME) == 0 ||
+				strcmp(basename, CTF_FS_METADATA_FILENAME
+					CTF_FS_GZ_SUFFIX) == 0) {
 			/* Ignore the metadata stream. */
 			BT_COMP_LOGI("Ignoring metadata file `%s" G_DIR_SEPARATOR_S "%s`",
 				ctf_fs_trace->path->str, basename);
@@ -951,19 +1984,55 @@ int create_ds_file_groups(struct ctf_fs_trace *ctf_fs_trace)
 			continue;
 		}
 
-		ret = add_ds_file_to_ds_file_group(ctf_fs_trace,
-			file->path->str);
-		if (ret) {
+		job = g_new0(struct ds_file_indexing_job, 1);
+		if (!job) {
 			BT_COMP_OR_COMP_CLASS_LOGE_APPEND_CAUSE(self_comp, self_comp_class,
-				"Cannot add stream file `%s` to stream file group",
-				file->path->str);
+				"Failed to allocate a data stream file indexing job.");
 			ctf_fs_file_destroy(file);
 			goto error;
 		}
 
+		job->ctf_fs_trace = ctf_fs_trace;
+		job->path = g_strdup(file->path->str);
+		g_ptr_array_add(jobs, job);
 		ctf_fs_file_destroy(file);
 	}
 
+	/*
+	 * Index the data stream files concurrently: each job has its
+	 * own file and CTF message iterator.
+	 */
+	ret = run_jobs(index_ds_file, jobs->pdata, jobs->len,
+		ctf_fs_trace->indexing_thread_count, log_level, self_comp,
+		self_comp_class);
+	if (ret) {
+		BT_COMP_OR_COMP_CLASS_LOGE_APPEND_CAUSE(self_comp, self_comp_class,
+			"Cannot index stream files of trace `%s`",
+			ctf_fs_trace->path->str);
+		goto error;
+	}
+
+	/*
+	 * Add the data stream files to their groups in directory order,
+	 * whatever the order in which the jobs finished.
+	 */
+	for (i = 0; i < jobs->len; i++) {
+		struct ds_file_indexing_job *job = g_ptr_array_index(jobs, i);
+
+		if (!job->ds_file_info) {
+			/* index_ds_file() ignored this empty file */
+			continue;
+		}
+
+		ret = add_ds_file_to_ds_file_group(ctf_fs_trace, job);
+		if (ret) {
+			BT_COMP_OR_COMP_CLASS_LOGE_APPEND_CAUSE(self_comp, self_comp_class,
+				"Cannot add stream file `%s` to stream file group",
+				job->path);
+			goto error;
+		}
+	}
+
 	goto end;
 
 error:
@@ -979,6 +2048,10 @@ end:
 		g_error_free(error);
 	}
 
+	if (jobs) {
+		g_ptr_array_free(jobs, TRUE);
+	}
+
 	return ret;
 }
 
@@ -1036,6 +2109,9 @@ struct ctf_fs_trace *ctf_fs_trace_create(
 		bt_self_component_class *self_comp_class,
 		const char *path, const char *name,
 		struct ctf_fs_metadata_config *metadata_config,
+		const char *index_cache_dir,
+		uint64_t indexing_thread_count,
+		const struct ctf_fs_ds_file_io_config *ds_file_io_config,
 		bt_logging_level log_level)
 {
 	struct ctf_fs_trace *ctf_fs_trace;
@@ -1052,6 +2128,9 @@ struct ctf_fs_trace *ctf_fs_trace_create(
 	ctf_fs_trace->log_level = log_level;
 	ctf_fs_trace->self_comp = self_comp;
 	ctf_fs_trace->self_comp_class = self_comp_class;
+	ctf_fs_trace->index_cache_dir = index_cache_dir;
+	ctf_fs_trace->indexing_thread_count = indexing_thread_count;
+	ctf_fs_trace->ds_file_io_config = *ds_file_io_config;
 	ctf_fs_trace->path = g_string_new(path);
 	if (!ctf_fs_trace->path) {
 		goto error;
@@ -1063,6 +2142,11 @@ struct ctf_fs_trace *ctf_fs_trace_create(
 	}
 
 	ctf_fs_metadata_init(ctf_fs_trace->metadata);
+	ctf_fs_trace->gz_index_cache = ctf_fs_gz_index_cache_create();
+	if (!ctf_fs_trace->gz_index_cache) {
+		goto error;
+	}
+
 	ctf_fs_trace->ds_file_groups = g_ptr_array_new_with_free_func(
 		(GDestroyNotify) ctf_fs_ds_file_group_destroy);
 	if (!ctf_fs_trace->ds_file_groups) {
@@ -1130,6 +2214,13 @@ int path_is_ctf_trace(const char *path)
 		goto end;
 	}
 
+	g_string_append(metadata_path, CTF_FS_GZ_SUFFIX);
+
+	if (g_file_test(metadata_path->str, G_FILE_TEST_IS_REGULAR)) {
+		ret = 1;
+		goto end;
+	}
+
 end:
 	g_string_free(metadata_path, TRUE);
 	return ret;
@@ -1181,7 +2272,10 @@ int ctf_fs_component_create_ctf_fs_trace_one_path(
 	}
 
 	ctf_fs_trace = ctf_fs_trace_create(self_comp, self_comp_class, norm_path->str,
-		trace_name, &ctf_fs->metadata_config, log_level);
+		trace_name, &ctf_fs->metadata_config,
+		ctf_fs->index_cache_dir ? ctf_fs->index_cache_dir->str : NULL,
+		ctf_fs->indexing_thread_count, &ctf_fs->ds_file_io_config,
+		log_level);
 	if (!ctf_fs_trace) {
 		BT_COMP_OR_COMP_CLASS_LOGE_APPEND_CAUSE(self_comp, self_comp_class,
 			"Cannot create trace for `%s`.",
@@ -1552,78 +2646,77 @@ int decode_packet_last_event_timestamp(struct ctf_fs_trace *ctf_fs_trace,
  *  - before lttng-module 2.9.13
  */
 static
-int fix_index_lttng_event_after_packet_bug(struct ctf_fs_trace *trace)
+int fix_ds_file_group_index_lttng_event_after_packet_bug(void *data)
 {
 	int ret = 0;
-	guint ds_file_group_i;
-	GPtrArray *ds_file_groups = trace->ds_file_groups;
+	guint entry_i;
+	struct ctf_clock_class *default_cc;
+	struct ctf_fs_ds_index_entry *last_entry;
+	struct ctf_fs_ds_index *index;
+	struct ctf_fs_ds_file_group *ds_file_group = data;
+	struct ctf_fs_trace *trace = ds_file_group->ctf_fs_trace;
 	bt_logging_level log_level = trace->log_level;
 
-	for (ds_file_group_i = 0; ds_file_group_i < ds_file_groups->len;
-			ds_file_group_i++) {
-		guint entry_i;
-		struct ctf_clock_class *default_cc;
-		struct ctf_fs_ds_index_entry *last_entry;
-		struct ctf_fs_ds_index *index;
+	index = ds_file_group->index;
 
-		struct ctf_fs_ds_file_group *ds_file_group =
-			g_ptr_array_index(ds_file_groups, ds_file_group_i);
+	BT_ASSERT(index);
+	BT_ASSERT(index->entries);
+	BT_ASSERT(index->entries->len > 0);
 
-		BT_ASSERT(ds_file_group);
-		index = ds_file_group->index;
+	/*
+	 * Iterate over all entries but the last one. The last one is
+	 * fixed differently after.
+	 */
+	for (entry_i = 0; entry_i < index->entries->len - 1;
+			entry_i++) {
+		struct ctf_fs_ds_index_entry *curr_entry, *next_entry;
 
-		BT_ASSERT(index);
-		BT_ASSERT(index->entries);
-		BT_ASSERT(index->entries->len > 0);
+		curr_entry = g_ptr_array_index(index->entries, entry_i);
+		next_entry = g_ptr_array_index(index->entries, entry_i + 1);
 
 		/*
-		 * Iterate over all entries but the last one. The last one is
-		 * fixed differently after.
+		 * 1. Set the current index entry `end` timestamp to
+		 * the next index entry `begin` timestamp.
 		 */
-		for (entry_i = 0; entry_i < index->entries->len - 1;
-				entry_i++) {
-			struct ctf_fs_ds_index_entry *curr_entry, *next_entry;
-
-			curr_entry = g_ptr_array_index(index->entries, entry_i);
-			next_entry = g_ptr_array_index(index->entries, entry_i + 1);
-
-			/*
-			 * 1. Set the current index entry `end` timestamp to
-			 * the next index entry `begin` timestamp.
-			 */
-			curr_entry->timestamp_end = next_entry->timestamp_begin;
-			curr_entry->timestamp_end_ns = next_entry->timestamp_begin_ns;
-		}
+		curr_entry->timestamp_end = next_entry->timestamp_begin;
+		curr_entry->timestamp_end_ns = next_entry->timestamp_begin_ns;
+	}
 
-		/*
-		 * 2. Fix the last entry by decoding the last event of the last
-		 * packet.
-		 */
-		last_entry = g_ptr_array_index(index->entries,
-			index->entries->len - 1);
-		BT_ASSERT(last_entry);
+	/*
+	 * 2. Fix the last entry by decoding the last event of the last
+	 * packet.
+	 */
+	last_entry = g_ptr_array_index(index->entries,
+		index->entries->len - 1);
+	BT_ASSERT(last_entry);
 
-		BT_ASSERT(ds_file_group->sc->default_clock_class);
-		default_cc = ds_file_group->sc->default_clock_class;
+	BT_ASSERT(ds_file_group->sc->default_clock_class);
+	default_cc = ds_file_group->sc->default_clock_class;
 
-		/*
-		 * Decode packet to read the timestamp of the last event of the
-		 * entry.
-		 */
-		ret = decode_packet_last_event_timestamp(trace, default_cc,
-			last_entry, &last_entry->timestamp_end,
-			&last_entry->timestamp_end_ns);
-		if (ret) {
-			BT_COMP_LOGE_APPEND_CAUSE(trace->self_comp,
-				"Failed to decode stream's last packet to get its last event's clock snapshot.");
-			goto end;
-		}
+	/*
+	 * Decode packet to read the timestamp of the last event of the
+	 * entry.
+	 */
+	ret = decode_packet_last_event_timestamp(trace, default_cc,
+		last_entry, &last_entry->timestamp_end,
+		&last_entry->timestamp_end_ns);
+	if (ret) {
+		BT_COMP_LOGE_APPEND_CAUSE(trace->self_comp,
+			"Failed to decode stream's last packet to get its last event's clock snapshot.");
 	}
 
-end:
 	return ret;
 }
 
+static
+int fix_index_lttng_event_after_packet_bug(struct ctf_fs_trace *trace)
+{
+	return run_jobs(fix_ds_file_group_index_lttng_event_after_packet_bug,
+		trace->ds_file_groups->pdata, trace->ds_file_groups->len,
+		trace->indexing_thread_count, trace->log_level,
+		trace->self_comp, trace->self_comp_class);
+}
+
 /*
  * Fix up packet index entries for barectf's "event-before-packet" bug.
  * Some buggy barectf tracer versions may emit events with a timestamp that is
@@ -1639,63 +2732,66 @@ end:
  *  - before barectf 2.3.1
  */
 static
-int fix_index_barectf_event_before_packet_bug(struct ctf_fs_trace *trace)
+int fix_ds_file_group_index_barectf_event_before_packet_bug(void *data)
 {
 	int ret = 0;
-	guint ds_file_group_i;
-	GPtrArray *ds_file_groups = trace->ds_file_groups;
+	guint entry_i;
+	struct ctf_clock_class *default_cc;
+	struct ctf_fs_ds_file_group *ds_file_group = data;
+	struct ctf_fs_ds_index *index = ds_file_group->index;
+	struct ctf_fs_trace *trace = ds_file_group->ctf_fs_trace;
 	bt_logging_level log_level = trace->log_level;
 
-	for (ds_file_group_i = 0; ds_file_group_i < ds_file_groups->len;
-			ds_file_group_i++) {
-		guint entry_i;
-		struct ctf_clock_class *default_cc;
-		struct ctf_fs_ds_file_group *ds_file_group =
-			g_ptr_array_index(ds_file_groups, ds_file_group_i);
-
-		struct ctf_fs_ds_index *index = ds_file_group->index;
+	BT_ASSERT(index);
+	BT_ASSERT(index->entries);
+	BT_ASSERT(index->entries->len > 0);
 
-		BT_ASSERT(index);
-		BT_ASSERT(index->entries);
-		BT_ASSERT(index->entries->len > 0);
-
-		BT_ASSERT(ds_file_group->sc->default_clock_class);
-		default_cc = ds_file_group->sc->default_clock_class;
+	BT_ASSERT(ds_file_group->sc->default_clock_class);
+	default_cc = ds_file_group->sc->default_clock_class;
 
+	/*
+	 * 1. Iterate over the index, starting from the second entry
+	 * (index = 1).
+	 */
+	for (entry_i = 1; entry_i < index->entries->len;
+			entry_i++) {
+		struct ctf_fs_ds_index_entry *curr_entry, *prev_entry;
+		prev_entry = g_ptr_array_index(index->entries, entry_i - 1);
+		curr_entry = g_ptr_array_index(index->entries, entry_i);
 		/*
-		 * 1. Iterate over the index, starting from the second entry
-		 * (index = 1).
+		 * 2. Set the current entry `begin` timestamp to the
+		 * timestamp of the first event of the current packet.
 		 */
-		for (entry_i = 1; entry_i < index->entries->len;
-				entry_i++) {
-			struct ctf_fs_ds_index_entry *curr_entry, *prev_entry;
-			prev_entry = g_ptr_array_index(index->entries, entry_i - 1);
-			curr_entry = g_ptr_array_index(index->entries, entry_i);
-			/*
-			 * 2. Set the current entry `begin` timestamp to the
-			 * timestamp of the first event of the current packet.
-			 */
-			ret = decode_packet_first_event_timestamp(trace, default_cc,
-				curr_entry, &curr_entry->timestamp_begin,
-				&curr_entry->timestamp_begin_ns);
-			if (ret) {
-				BT_COMP_LOGE_APPEND_CAUSE(trace->self_comp,
-					"Failed to decode first event's clock snapshot");
-				goto end;
-			}
-
-			/*
-			 * 3. Set the previous entry `end` timestamp to the
-			 * timestamp of the first event of the current packet.
-			 */
-			prev_entry->timestamp_end = curr_entry->timestamp_begin;
-			prev_entry->timestamp_end_ns = curr_entry->timestamp_begin_ns;
+		ret = decode_packet_first_event_timestamp(trace, default_cc,
+			curr_entry, &curr_entry->timestamp_begin,
+			&curr_entry->timestamp_begin_ns);
+		if (ret) {
+			BT_COMP_LOGE_APPEND_CAUSE(trace->self_comp,
+				"Failed to decode first event's clock snapshot");
+			goto end;
 		}
+
+		/*
+		 * 3. Set the previous entry `end` timestamp to the
+		 * timestamp of the first event of the current packet.
+		 */
+		prev_entry->timestamp_end = curr_entry->timestamp_begin;
+		prev_entry->timestamp_end_ns = curr_entry->timestamp_begin_ns;
 	}
+
 end:
 	return ret;
 }
 
+static
+int fix_index_barectf_event_before_packet_bug(struct ctf_fs_trace *trace)
+{
+	return run_jobs(fix_ds_file_group_index_barectf_event_before_packet_bug,
+		trace->ds_file_groups->pdata, trace->ds_file_groups->len,
+		trace->indexing_thread_count, trace->log_level,
+		trace->self_comp, trace->self_comp_class);
+}
+
 /*
  * When using the lttng-crash feature it's likely that the last packets of each
  * stream have their timestamp_end set to zero. This is caused by the fact that
@@ -1714,72 +2810,64 @@ end:
  * - All current and future lttng-ust and lttng-modules versions.
  */
 static
-int fix_index_lttng_crash_quirk(struct ctf_fs_trace *trace)
+int fix_ds_file_group_index_lttng_crash_quirk(void *data)
 {
 	int ret = 0;
-	guint ds_file_group_idx;
-	GPtrArray *ds_file_groups = trace->ds_file_groups;
+	guint entry_idx;
+	struct ctf_clock_class *default_cc;
+	struct ctf_fs_ds_index_entry *last_entry;
+	struct ctf_fs_ds_index *index;
+	struct ctf_fs_ds_file_group *ds_file_group = data;
+	struct ctf_fs_trace *trace = ds_file_group->ctf_fs_trace;
 	bt_logging_level log_level = trace->log_level;
 
-	for (ds_file_group_idx = 0; ds_file_group_idx < ds_file_groups->len;
-			ds_file_group_idx++) {
-		guint entry_idx;
-		struct ctf_clock_class *default_cc;
-		struct ctf_fs_ds_index_entry *last_entry;
-		struct ctf_fs_ds_index *index;
+	index = ds_file_group->index;
 
-		struct ctf_fs_ds_file_group *ds_file_group =
-			g_ptr_array_index(ds_file_groups, ds_file_group_idx);
+	BT_ASSERT(ds_file_group->sc->default_clock_class);
+	default_cc = ds_file_group->sc->default_clock_class;
 
-		BT_ASSERT(ds_file_group);
-		index = ds_file_group->index;
+	BT_ASSERT(index);
+	BT_ASSERT(index->entries);
+	BT_ASSERT(index->entries->len > 0);
 
-		BT_ASSERT(ds_file_group->sc->default_clock_class);
-		default_cc = ds_file_group->sc->default_clock_class;
+	last_entry = g_ptr_array_index(index->entries,
+		index->entries->len - 1);
+	BT_ASSERT(last_entry);
 
-		BT_ASSERT(index);
-		BT_ASSERT(index->entries);
-		BT_ASSERT(index->entries->len > 0);
 
-		last_entry = g_ptr_array_index(index->entries,
-			index->entries->len - 1);
-		BT_ASSERT(last_entry);
+	/* 1. Fix the last entry first. */
+	if (last_entry->timestamp_end == 0 &&
+			last_entry->timestamp_begin != 0) {
+		/*
+		 * Decode packet to read the timestamp of the
+		 * last event of the stream file.
+		 */
+		ret = decode_packet_last_event_timestamp(trace,
+			default_cc, last_entry,
+			&last_entry->timestamp_end,
+			&last_entry->timestamp_end_ns);
+		if (ret) {
+			BT_COMP_LOGE_APPEND_CAUSE(trace->self_comp,
+				"Failed to decode last event's clock snapshot");
+			goto end;
+		}
+	}
 
+	/* Iterate over all entries but the last one. */
+	for (entry_idx = 0; entry_idx < index->entries->len - 1;
+			entry_idx++) {
+		struct ctf_fs_ds_index_entry *curr_entry, *next_entry;
+		curr_entry = g_ptr_array_index(index->entries, entry_idx);
+		next_entry = g_ptr_array_index(index->entries, entry_idx + 1);
 
-		/* 1. Fix the last entry first. */
-		if (last_entry->timestamp_end == 0 &&
-				last_entry->timestamp_begin != 0) {
+		if (curr_entry->timestamp_end == 0 &&
+				curr_entry->timestamp_begin != 0) {
 			/*
-			 * Decode packet to read the timestamp of the
-			 * last event of the stream file.
+			 * 2. Set the current index entry `end` timestamp to
+			 * the next index entry `begin` timestamp.
 			 */
-			ret = decode_packet_last_event_timestamp(trace,
-				default_cc, last_entry,
-				&last_entry->timestamp_end,
-				&last_entry->timestamp_end_ns);
-			if (ret) {
-				BT_COMP_LOGE_APPEND_CAUSE(trace->self_comp,
-					"Failed to decode last event's clock snapshot");
-				goto end;
-			}
-		}
-
-		/* Iterate over all entries but the last one. */
-		for (entry_idx = 0; entry_idx < index->entries->len - 1;
-				entry_idx++) {
-			struct ctf_fs_ds_index_entry *curr_entry, *next_entry;
-			curr_entry = g_ptr_array_index(index->entries, entry_idx);
-			next_entry = g_ptr_array_index(index->entries, entry_idx + 1);
-
-			if (curr_entry->timestamp_end == 0 &&
-					curr_entry->timestamp_begin != 0) {
-				/*
-				 * 2. Set the current index entry `end` timestamp to
-				 * the next index entry `begin` timestamp.
-				 */
-				curr_entry->timestamp_end = next_entry->timestamp_begin;
-				curr_entry->timestamp_end_ns = next_entry->timestamp_begin_ns;
-			}
+			curr_entry->timestamp_end = next_entry->timestamp_begin;
+			curr_entry->timestamp_end_ns = next_entry->timestamp_begin_ns;
 		}
 	}
 
@@ -1787,6 +2875,15 @@ end:
 	return ret;
 }
 
+static
+int fix_index_lttng_crash_quirk(struct ctf_fs_trace *trace)
+{
+	return run_jobs(fix_ds_file_group_index_lttng_crash_quirk,
+		trace->ds_file_groups->pdata, trace->ds_file_groups->len,
+		trace->indexing_thread_count, trace->log_level,
+		trace->self_comp, trace->self_comp_class);
+}
+
 /*
  * Extract the tracer information necessary to compare versions.
  * Returns 0 on success, and -1 if the extraction is not successful because the
@@ -2295,6 +3392,26 @@ static const struct bt_param_validation_value_descr inputs_elem_descr = {
 	.type = BT_VALUE_TYPE_STRING,
 };
 
+static const struct bt_param_validation_value_descr event_class_names_elem_descr = {
+	.type = BT_VALUE_TYPE_STRING,
+};
+
+static const struct bt_param_validation_value_descr event_class_ids_elem_descr = {
+	.type = BT_VALUE_TYPE_UNSIGNED_INTEGER,
+};
+
+#define IO_MODE_PARAM		"io-mode"
+#define IO_MODE_WINDOW_STR	"window"
+#define IO_MODE_READ_AHEAD_STR	"read-ahead"
+#define IO_MODE_WHOLE_FILE_STR	"whole-file"
+
+static const char *io_mode_choices[] = {
+	IO_MODE_WINDOW_STR,
+	IO_MODE_READ_AHEAD_STR,
+	IO_MODE_WHOLE_FILE_STR,
+	NULL,
+};
+
 static const struct bt_param_validation_map_value_entry_descr fs_params_entries_descr[] = {
 	{ "inputs", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_MANDATORY, {
 		BT_VALUE_TYPE_ARRAY,
@@ -2308,6 +3425,30 @@ static const struct bt_param_validation_map_value_entry_descr fs_params_entries_
 	{ "clock-class-offset-s", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_SIGNED_INTEGER } },
 	{ "clock-class-offset-ns", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_SIGNED_INTEGER } },
 	{ "force-clock-class-origin-unix-epoch", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_BOOL } },
+	{ "decoding-thread-count", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_UNSIGNED_INTEGER } },
+	{ "index-cache-dir", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_STRING } },
+	{ "indexing-thread-count", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_UNSIGNED_INTEGER } },
+	{ "event-class-names", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, {
+		BT_VALUE_TYPE_ARRAY,
+		.array = {
+			.min_length = 0,
+			.max_length = BT_PARAM_VALIDATION_INFINITE,
+			.element_type = &event_class_names_elem_descr,
+		}
+	}},
+	{ "event-class-ids", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, {
+		BT_VALUE_TYPE_ARRAY,
+		.array = {
+			.min_length = 0,
+			.max_length = BT_PARAM_VALIDATION_INFINITE,
+			.element_type = &event_class_ids_elem_descr,
+		}
+	}},
+	{ "lazy-event-payloads", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_BOOL } },
+	{ IO_MODE_PARAM, BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { BT_VALUE_TYPE_STRING, .string = {
+		.choices = io_mode_choices,
+	} } },
+	{ "read-ahead-window-count", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_UNSIGNED_INTEGER } },
 	BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_END
 };
 
@@ -2320,6 +3461,8 @@ bool read_src_fs_parameters(const bt_value *params,
 		bt_self_component_class *self_comp_class) {
 	bool ret;
 	const bt_value *value;
+	const bt_value *event_class_names_value;
+	const bt_value *event_class_ids_value;
 	bt_logging_level log_level = ctf_fs->log_level;
 	enum bt_param_validation_status validate_value_status;
 	gchar *error = NULL;
@@ -2360,6 +3503,110 @@ bool read_src_fs_parameters(const bt_value *params,
 			bt_value_bool_get(value);
 	}
 
+	/* decoding-thread-count parameter */
+	value = bt_value_map_borrow_entry_value_const(params,
+		"decoding-thread-count");
+	if (value) {
+		ctf_fs->decoding_thread_count =
+			bt_value_integer_unsigned_get(value);
+
+		if (ctf_fs->decoding_thread_count > G_MAXINT) {
+			BT_COMP_OR_COMP_CLASS_LOGE_APPEND_CAUSE(self_comp,
+				self_comp_class,
+				"Invalid `decoding-thread-count` parameter: "
+				"value is too large: count=%" PRIu64,
+				ctf_fs->decoding_thread_count);
+			ret = false;
+			goto end;
+		}
+	}
+
+	/* index-cache-dir parameter */
+	value = bt_value_map_borrow_entry_value_const(params,
+		"index-cache-dir");
+	if (value) {
+		ctf_fs->index_cache_dir =
+			g_string_new(bt_value_string_get(value));
+		if (!ctf_fs->index_cache_dir) {
+			BT_COMP_OR_COMP_CLASS_LOGE_APPEND_CAUSE(self_comp,
+				self_comp_class, "Failed to allocate a GString.");
+			ret = false;
+			goto end;
+		}
+	}
+
+	/* indexing-thread-count parameter */
+	value = bt_value_map_borrow_entry_value_const(params,
+		"indexing-thread-count");
+	if (value) {
+		ctf_fs->indexing_thread_count =
+			bt_value_integer_unsigned_get(value);
+
+		if (ctf_fs->indexing_thread_count == 0 ||
+				ctf_fs->indexing_thread_count > G_MAXINT) {
+			BT_COMP_OR_COMP_CLASS_LOGE_APPEND_CAUSE(self_comp,
+				self_comp_class,
+				"Invalid `indexing-thread-count` parameter: "
+				"expecting a value between 1 and %d: count=%" PRIu64,
+				G_MAXINT, ctf_fs->indexing_thread_count);
+			ret = false;
+			goto end;
+		}
+	}
+
+	/* event-class-names and event-class-ids parameters */
+	event_class_names_value = bt_value_map_borrow_entry_value_const(params,
+		"event-class-names");
+	event_class_ids_value = bt_value_map_borrow_entry_value_const(params,
+		"event-class-ids");
+	if (event_class_names_value || event_class_ids_value) {
+		ctf_fs->ec_filter = ctf_msg_iter_event_class_filter_create(
+			event_class_names_value, event_class_ids_value);
+		if (!ctf_fs->ec_filter) {
+			BT_COMP_OR_COMP_CLASS_LOGE_APPEND_CAUSE(self_comp,
+				self_comp_class,
+				"Failed to create an event class filter.");
+			ret = false;
+			goto end;
+		}
+
+		ctf_fs->metadata_config.filters_events = true;
+	}
+
+	/* lazy-event-payloads parameter */
+	value = bt_value_map_borrow_entry_value_const(params,
+		"lazy-event-payloads");
+	if (value) {
+		ctf_fs->lazy_event_payloads = bt_value_bool_get(value);
+	}
+
+	/* io-mode parameter */
+	value = bt_value_map_borrow_entry_value_const(params, IO_MODE_PARAM);
+	if (value) {
+		const char *io_mode_str = bt_value_string_get(value);
+
+		if (strcmp(io_mode_str, IO_MODE_WINDOW_STR) == 0) {
+			ctf_fs->ds_file_io_config.mode =
+				CTF_FS_DS_FILE_IO_MODE_WINDOW;
+		} else if (strcmp(io_mode_str, IO_MODE_READ_AHEAD_STR) == 0) {
+			ctf_fs->ds_file_io_config.mode =
+				CTF_FS_DS_FILE_IO_MODE_READ_AHEAD;
+		} else {
+			BT_ASSERT(strcmp(io_mode_str,
+				IO_MODE_WHOLE_FILE_STR) == 0);
+			ctf_fs->ds_file_io_config.mode =
+				CTF_FS_DS_FILE_IO_MODE_WHOLE_FILE;
+		}
+	}
+
+	/* read-ahead-window-count parameter */
+	value = bt_value_map_borrow_entry_value_const(params,
+		"read-ahead-window-count");
+	if (value) {
+		ctf_fs->ds_file_io_config.read_ahead_window_count =
+			bt_value_integer_unsigned_get(value);
+	}
+
 	/* trace-name parameter */
 	*trace_name = bt_value_map_borrow_entry_value_const(params, "trace-name");
 
@@ -2407,6 +3654,30 @@ struct ctf_fs_component *ctf_fs_create(
 		goto error;
 	}
 
+	if (ctf_fs->decoding_thread_count > 0) {
+		GError *gerror = NULL;
+		bt_logging_level log_level = ctf_fs->log_level;
+
+		bt_g_thread_init();
+		ctf_fs->decoding_thread_pool = g_thread_pool_new(decode_ahead,
+			NULL, (gint) ctf_fs->decoding_thread_count, FALSE,
+			&gerror);
+		if (!ctf_fs->decoding_thread_pool) {
+			BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+				"Cannot create decoding thread pool: %s",
+				gerror ? gerror->message : "unknown error");
+
+			if (gerror) {
+				g_error_free(gerror);
+			}
+
+			goto error;
+		}
+
+		BT_COMP_LOGI("Created decoding thread pool: thread-count=%" PRIu64,
+			ctf_fs->decoding_thread_count);
+	}
+
 	goto end;
 
 error:
@@ -11,11 +11,13 @@
 #define BABELTRACE_PLUGIN_CTF_FS_H
 
 #include <stdbool.h>
+#include <glib.h>
 #include "common/macros.h"
 #include <babeltrace2/babeltrace.h>
 #include "data-stream-file.h"
 #include "metadata.h"
 #include "../common/metadata/decoder.h"
+#include "../common/raw-packet.h"
 
 BT_HIDDEN
 extern bool ctf_fs_debug;
@@ -48,6 +50,13 @@ struct ctf_fs_metadata {
 	/* Owned by this */
 	char *text;
 
+	/*
+	 * Plain text of the metadata to which the raw packets (see
+	 * `struct ctf_raw_packet`) refer, or `NULL` to not attach raw
+	 * packets to the packets. Owned by this.
+	 */
+	struct ctf_raw_packet_metadata *raw_packet_metadata;
+
 	int bo;
 };
 
@@ -61,6 +70,53 @@ struct ctf_fs_component {
 	struct ctf_fs_trace *trace;
 
 	struct ctf_fs_metadata_config metadata_config;
+
+	/*
+	 * Number of worker threads which decode the data stream file
+	 * groups ahead of the message iterators (`decoding-thread-count`
+	 * parameter).
+	 *
+	 * 0 means each message iterator decodes its data stream file
+	 * group itself, on demand, from the graph's thread.
+	 */
+	uint64_t decoding_thread_count;
+
+	/*
+	 * Pool of `decoding_thread_count` worker threads, owned by this,
+	 * or `NULL` if `decoding_thread_count` is 0.
+	 */
+	GThreadPool *decoding_thread_pool;
+
+	/*
+	 * Directory of the packet index cache files (`index-cache-dir`
+	 * parameter), owned by this, or `NULL` to disable the cache.
+	 */
+	GString *index_cache_dir;
+
+	/*
+	 * Maximum number of threads which index the data stream files
+	 * concurrently (`indexing-thread-count` parameter).
+	 */
+	uint64_t indexing_thread_count;
+
+	/*
+	 * Event classes of which the message iterators emit the event
+	 * messages (`event-class-names` and `event-class-ids`
+	 * parameters), owned by this, or `NULL` to emit all of them.
+	 */
+	struct ctf_msg_iter_event_class_filter *ec_filter;
+
+	/*
+	 * True to defer the decoding of the event payload fields to
+	 * their first access (`lazy-event-payloads` parameter).
+	 */
+	bool lazy_event_payloads;
+
+	/*
+	 * How the message iterators map the data stream files into
+	 * memory (`io-mode` and `read-ahead-window-count` parameters).
+	 */
+	struct ctf_fs_ds_file_io_config ds_file_io_config;
 };
 
 struct ctf_fs_trace {
@@ -88,6 +144,28 @@ struct ctf_fs_trace {
 
 	/* Next automatic stream ID when not provided by packet header */
 	uint64_t next_stream_id;
+
+	/*
+	 * Weak, directory of the packet index cache files, or `NULL` to
+	 * disable the cache.
+	 */
+	const char *index_cache_dir;
+
+	/*
+	 * Maximum number of threads which index the data stream files
+	 * and fix their indexes concurrently; 1 means to do it from the
+	 * current thread.
+	 */
+	uint64_t indexing_thread_count;
+
+	/*
+	 * How the message iterators map the data stream files into
+	 * memory.
+	 */
+	struct ctf_fs_ds_file_io_config ds_file_io_config;
+
+	/* Indexes of the gzip-compressed data stream files, owned by this */
+	struct ctf_fs_gz_index_cache *gz_index_cache;
 };
 
 struct ctf_fs_ds_index_entry {
@@ -185,6 +263,73 @@ struct ctf_fs_msg_iter_data {
 	const struct bt_error *next_saved_error;
 
 	struct ctf_fs_ds_group_medops_data *msg_iter_medops_data;
+
+	/*
+	 * True if all the entries of the index of `ds_file_group` have
+	 * beginning and end times, in which case this iterator seeks a
+	 * given time by itself using the index.
+	 */
+	bool can_seek_ns_from_origin;
+
+	/*
+	 * Queue of `const bt_message *` (owned by this) which the last
+	 * "seek nanoseconds from origin" operation decoded or created
+	 * and which ctf_fs_iterator_next() must return before decoding
+	 * anything else.
+	 */
+	GQueue *seek_msgs;
+
+	/*
+	 * Decoding ahead of time on a worker thread.
+	 *
+	 * `msgs` is `NULL` when the component has no decoding thread
+	 * pool, in which case ctf_fs_iterator_next() decodes
+	 * `msg_iter` itself.
+	 *
+	 * Otherwise, at most one decoding job for this message
+	 * iterator is queued or running on `thread_pool` at any time,
+	 * and while it is, only this job may use `msg_iter`.
+	 */
+	struct {
+		/* Weak, belongs to the component */
+		GThreadPool *thread_pool;
+
+		/* Protects all the members below; owned by this */
+		GMutex *lock;
+
+		/*
+		 * Signaled when a job adds messages to `msgs` or ends
+		 * while `consumer_waiting` is true; owned by this.
+		 */
+		GCond *cond;
+
+		/*
+		 * Queue of `const bt_message *` (owned by this) which
+		 * a job decoded and which ctf_fs_iterator_next() did
+		 * not return yet. Its length is at most
+		 * `CTF_FS_DECODED_MSGS_CAPACITY`.
+		 */
+		GQueue *msgs;
+
+		/* True while a decoding job is queued or running */
+		bool job_pending;
+
+		/* True to make the current decoding job return early */
+		bool stop;
+
+		/* True while the graph's thread waits on `cond` */
+		bool consumer_waiting;
+
+		/*
+		 * Status which ended the decoding, or
+		 * `BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK` if
+		 * it's not done. ctf_fs_iterator_next() returns it,
+		 * with `error` (owned by this) if it's an error
+		 * status, once `msgs` is empty.
+		 */
+		bt_message_iterator_class_next_method_status status;
+		const struct bt_error *error;
+	} decoding;
 };
 
 BT_HIDDEN
@@ -222,6 +367,18 @@ BT_HIDDEN
 bt_message_iterator_class_seek_beginning_method_status ctf_fs_iterator_seek_beginning(
 		bt_self_message_iterator *message_iterator);
 
+BT_HIDDEN
+bt_message_iterator_class_seek_ns_from_origin_method_status
+ctf_fs_iterator_seek_ns_from_origin(
+		bt_self_message_iterator *message_iterator,
+		int64_t ns_from_origin);
+
+BT_HIDDEN
+bt_message_iterator_class_can_seek_ns_from_origin_method_status
+ctf_fs_iterator_can_seek_ns_from_origin(
+		bt_self_message_iterator *message_iterator,
+		int64_t ns_from_origin, bt_bool *can_seek);
+
 /* Create and initialize a new, empty ctf_fs_component. */
 
 BT_HIDDEN
@@ -0,0 +1,797 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (C) 2023 EfficiOS Inc.
+ */
+
+#define BT_COMP_LOG_SELF_COMP (self_comp)
+#define BT_LOG_OUTPUT_LEVEL (log_level)
+#define BT_LOG_TAG "PLUGIN/SRC.CTF.FS/GZ"
+#include "logging/comp-logging.h"
+
+#include <glib.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <zlib.h>
+
+#include "common/assert.h"
+#include "compat/glib.h"
+#include "gz-file.h"
+
+/* Size of a deflate dictionary, in bytes */
+#define DICT_SIZE		32768
+
+/* Size of the compressed data input buffers, in bytes */
+#define IN_BUF_SIZE		65536
+
+/*
+ * Approximate number of uncompressed bytes between two access points
+ * with a dictionary.
+ */
+#define ACCESS_POINT_SPAN	(4 * 1024 * 1024)
+
+/* inflateInit2() window bits to decode a gzip member */
+#define WINDOW_BITS_GZIP	(15 + 16)
+
+/* inflateInit2() window bits to decode a raw deflate stream */
+#define WINDOW_BITS_RAW		(-15)
+
+struct access_point {
+	/* Offset of the next uncompressed byte */
+	uint64_t out_offset;
+
+	/* Offset of the next complete compressed byte */
+	uint64_t in_offset;
+
+	/*
+	 * Number of bits (1 to 7) of the compressed byte before
+	 * `in_offset` which are part of the next deflate block, or 0.
+	 */
+	int bits;
+
+	/*
+	 * Dictionary (`DICT_SIZE` bytes), owned by this, or `NULL` if
+	 * this access point is the beginning of a gzip member.
+	 */
+	uint8_t *dict;
+};
+
+struct ctf_fs_gz_index {
+	/* Array of `struct access_point`, sorted by offset */
+	GArray *access_points;
+
+	/* Uncompressed size of the file, in bytes */
+	uint64_t size;
+};
+
+struct ctf_fs_gz_index_cache {
+	/* Owned by this */
+	GMutex *lock;
+
+	/* Path (owned by this) -> `struct ctf_fs_gz_index *` (owned by this) */
+	GHashTable *indexes;
+};
+
+struct ctf_fs_gz_reader {
+	bt_logging_level log_level;
+
+	/* Weak */
+	bt_self_component *self_comp;
+
+	/* Weak */
+	const struct ctf_fs_gz_index *index;
+
+	/* Weak */
+	FILE *fp;
+
+	/* Weak */
+	const char *path;
+
+	z_stream zstrm;
+	bool zstrm_is_init;
+
+	/* True if `zstrm` is ready to decompress from `out_offset` */
+	bool is_positioned;
+
+	/*
+	 * True if `zstrm` reached the end of a gzip member: the
+	 * decompression must restart at the next member.
+	 */
+	bool is_at_member_end;
+
+	/* Offset of the next uncompressed byte */
+	uint64_t out_offset;
+
+	/* Offset of the next compressed byte which `zstrm` consumes */
+	uint64_t in_offset;
+
+	uint8_t in_buf[IN_BUF_SIZE];
+
+	/* Output of the decompression before the requested offset */
+	uint8_t discard_buf[DICT_SIZE];
+};
+
+BT_HIDDEN
+bool ctf_fs_gz_is_compressed_path(const char *path)
+{
+	return g_str_has_suffix(path, CTF_FS_GZ_SUFFIX);
+}
+
+static
+void destroy_access_points(GArray *access_points)
+{
+	guint i;
+
+	if (!access_points) {
+		return;
+	}
+
+	for (i = 0; i < access_points->len; i++) {
+		g_free(g_array_index(access_points, struct access_point,
+			i).dict);
+	}
+
+	g_array_free(access_points, TRUE);
+}
+
+/*
+ * Appends an access point to `index`.
+ *
+ * If `window` is not `NULL`, it's the circular output buffer
+ * (`DICT_SIZE` bytes) of the decompression, of which the last
+ * `window_left` bytes are older than the other ones: the access point's
+ * dictionary is its contents, from the oldest to the newest byte.
+ */
+static
+int append_access_point(struct ctf_fs_gz_index *index, uint64_t out_offset,
+		uint64_t in_offset, int bits, const uint8_t *window,
+		size_t window_left)
+{
+	struct access_point access_point = {
+		.out_offset = out_offset,
+		.in_offset = in_offset,
+		.bits = bits,
+		.dict = NULL,
+	};
+
+	if (window) {
+		access_point.dict = g_malloc(DICT_SIZE);
+		if (!access_point.dict) {
+			return -1;
+		}
+
+		memcpy(access_point.dict, window + DICT_SIZE - window_left,
+			window_left);
+		memcpy(access_point.dict + window_left, window,
+			DICT_SIZE - window_left);
+	}
+
+	g_array_append_val(index->access_points, access_point);
+	return 0;
+}
+
+BT_HIDDEN
+struct ctf_fs_gz_index *ctf_fs_gz_index_build(FILE *fp, const char *path,
+		bt_logging_level log_level, bt_self_component *self_comp)
+{
+	struct ctf_fs_gz_index *index = NULL;
+	z_stream zstrm = { 0 };
+	bool zstrm_is_init = false;
+	bool is_in_member = false;
+	uint8_t *in_buf = NULL;
+	uint8_t *window = NULL;
+	uint64_t in_offset = 0;
+	uint64_t out_offset = 0;
+	uint64_t last_access_point_out_offset = 0;
+	int zret;
+
+	BT_COMP_LOGI("Indexing gzip-compressed file: path=\"%s\"", path);
+	index = g_new0(struct ctf_fs_gz_index, 1);
+	if (!index) {
+		BT_COMP_LOGE_STR("Failed to allocate a gzip index.");
+		goto error;
+	}
+
+	index->access_points = g_array_new(FALSE, FALSE,
+		sizeof(struct access_point));
+	in_buf = g_malloc(IN_BUF_SIZE);
+	window = g_malloc0(DICT_SIZE);
+	if (!index->access_points || !in_buf || !window) {
+		BT_COMP_LOGE_STR("Failed to allocate gzip index buffers.");
+		goto error;
+	}
+
+	if (fseek(fp, 0, SEEK_SET)) {
+		BT_COMP_LOGE_ERRNO("Cannot seek file", ": path=\"%s\"", path);
+		goto error;
+	}
+
+	zret = inflateInit2(&zstrm, WINDOW_BITS_GZIP);
+	if (zret != Z_OK) {
+		BT_COMP_LOGE("Cannot initialize zlib stream: zlib-ret=%d",
+			zret);
+		goto error;
+	}
+
+	zstrm_is_init = true;
+
+	while (true) {
+		if (zstrm.avail_in == 0) {
+			zstrm.avail_in = fread(in_buf, 1, IN_BUF_SIZE, fp);
+			zstrm.next_in = in_buf;
+
+			if (ferror(fp)) {
+				BT_COMP_LOGE("Cannot read file: path=\"%s\"",
+					path);
+				goto error;
+			}
+
+			if (zstrm.avail_in == 0) {
+				if (is_in_member) {
+					BT_COMP_LOGE("Unexpected end of gzip-compressed file: "
+						"path=\"%s\", offset=%" PRIu64,
+						path, in_offset);
+					goto error;
+				}
+
+				break;
+			}
+		}
+
+		if (!is_in_member) {
+			/* Another member begins here */
+			if (append_access_point(index, out_offset, in_offset,
+					0, NULL, 0)) {
+				BT_COMP_LOGE_STR("Failed to append a gzip access point.");
+				goto error;
+			}
+
+			last_access_point_out_offset = out_offset;
+			is_in_member = true;
+		}
+
+		if (zstrm.avail_out == 0) {
+			zstrm.next_out = window;
+			zstrm.avail_out = DICT_SIZE;
+		}
+
+		/* Stop at each deflate block boundary */
+		in_offset += zstrm.avail_in;
+		out_offset += zstrm.avail_out;
+		zret = inflate(&zstrm, Z_BLOCK);
+		in_offset -= zstrm.avail_in;
+		out_offset -= zstrm.avail_out;
+
+		if (zret == Z_STREAM_END) {
+			zret = inflateReset(&zstrm);
+			BT_ASSERT(zret == Z_OK);
+			is_in_member = false;
+			continue;
+		} else if (zret != Z_OK) {
+			BT_COMP_LOGE("Cannot decompress gzip-compressed file: "
+				"path=\"%s\", offset=%" PRIu64 ", zlib-ret=%d, "
+				"msg=\"%s\"", path, in_offset, zret,
+				zstrm.msg ? zstrm.msg : "");
+			goto error;
+		}
+
+		/*
+		 * At the end of a deflate block which isn't the last
+		 * one of its member, the decompression can restart with
+		 * the last 32 KiB of output as the dictionary.
+		 */
+		if ((zstrm.data_type & 128) && !(zstrm.data_type & 64) &&
+				out_offset - last_access_point_out_offset >=
+					ACCESS_POINT_SPAN) {
+			if (append_access_point(index, out_offset, in_offset,
+					zstrm.data_type & 7, window,
+					zstrm.avail_out)) {
+				BT_COMP_LOGE_STR("Failed to append a gzip access point.");
+				goto error;
+			}
+
+			last_access_point_out_offset = out_offset;
+		}
+	}
+
+	index->size = out_offset;
+	BT_COMP_LOGI("Indexed gzip-compressed file: path=\"%s\", "
+		"compressed-size=%" PRIu64 ", size=%" PRIu64 ", "
+		"access-point-count=%u", path, in_offset, index->size,
+		index->access_points->len);
+	goto end;
+
+error:
+	ctf_fs_gz_index_destroy(index);
+	index = NULL;
+
+end:
+	if (zstrm_is_init) {
+		inflateEnd(&zstrm);
+	}
+
+	g_free(in_buf);
+	g_free(window);
+	return index;
+}
+
+BT_HIDDEN
+void ctf_fs_gz_index_destroy(struct ctf_fs_gz_index *index)
+{
+	if (!index) {
+		return;
+	}
+
+	destroy_access_points(index->access_points);
+	g_free(index);
+}
+
+BT_HIDDEN
+uint64_t ctf_fs_gz_index_get_size(const struct ctf_fs_gz_index *index)
+{
+	BT_ASSERT_DBG(index);
+	return index->size;
+}
+
+BT_HIDDEN
+struct ctf_fs_gz_index_cache *ctf_fs_gz_index_cache_create(void)
+{
+	struct ctf_fs_gz_index_cache *cache =
+		g_new0(struct ctf_fs_gz_index_cache, 1);
+
+	if (!cache) {
+		goto end;
+	}
+
+	cache->lock = bt_g_mutex_new();
+	if (!cache->lock) {
+		ctf_fs_gz_index_cache_destroy(cache);
+		cache = NULL;
+		goto end;
+	}
+
+	cache->indexes = g_hash_table_new_full(g_str_hash, g_str_equal,
+		g_free, (GDestroyNotify) ctf_fs_gz_index_destroy);
+	if (!cache->indexes) {
+		ctf_fs_gz_index_cache_destroy(cache);
+		cache = NULL;
+	}
+
+end:
+	return cache;
+}
+
+BT_HIDDEN
+void ctf_fs_gz_index_cache_destroy(struct ctf_fs_gz_index_cache *cache)
+{
+	if (!cache) {
+		return;
+	}
+
+	if (cache->indexes) {
+		g_hash_table_destroy(cache->indexes);
+	}
+
+	bt_g_mutex_free(cache->lock);
+	g_free(cache);
+}
+
+BT_HIDDEN
+const struct ctf_fs_gz_index *ctf_fs_gz_index_cache_borrow_index(
+		struct ctf_fs_gz_index_cache *cache, FILE *fp, const char *path,
+		bt_logging_level log_level, bt_self_component *self_comp)
+{
+	struct ctf_fs_gz_index *index;
+	struct ctf_fs_gz_index *existing_index;
+
+	BT_ASSERT(cache);
+	g_mutex_lock(cache->lock);
+	index = g_hash_table_lookup(cache->indexes, path);
+	g_mutex_unlock(cache->lock);
+
+	if (index) {
+		goto end;
+	}
+
+	/*
+	 * Build the index without holding the lock so that different
+	 * threads index different files concurrently.
+	 */
+	index = ctf_fs_gz_index_build(fp, path, log_level, self_comp);
+	if (!index) {
+		goto end;
+	}
+
+	g_mutex_lock(cache->lock);
+	existing_index = g_hash_table_lookup(cache->indexes, path);
+	if (existing_index) {
+		/* Another thread was faster */
+		ctf_fs_gz_index_destroy(index);
+		index = existing_index;
+	} else {
+		g_hash_table_insert(cache->indexes, g_strdup(path), index);
+	}
+
+	g_mutex_unlock(cache->lock);
+
+end:
+	return index;
+}
+
+BT_HIDDEN
+struct ctf_fs_gz_reader *ctf_fs_gz_reader_create(
+		const struct ctf_fs_gz_index *index, FILE *fp, const char *path,
+		bt_logging_level log_level, bt_self_component *self_comp)
+{
+	struct ctf_fs_gz_reader *reader = g_new0(struct ctf_fs_gz_reader, 1);
+	int zret;
+
+	if (!reader) {
+		BT_COMP_LOGE_STR("Failed to allocate a gzip reader.");
+		goto error;
+	}
+
+	reader->log_level = log_level;
+	reader->self_comp = self_comp;
+	reader->index = index;
+	reader->fp = fp;
+	reader->path = path;
+	zret = inflateInit2(&reader->zstrm, WINDOW_BITS_GZIP);
+	if (zret != Z_OK) {
+		BT_COMP_LOGE("Cannot initialize zlib stream: zlib-ret=%d",
+			zret);
+		goto error;
+	}
+
+	reader->zstrm_is_init = true;
+	goto end;
+
+error:
+	ctf_fs_gz_reader_destroy(reader);
+	reader = NULL;
+
+end:
+	return reader;
+}
+
+BT_HIDDEN
+void ctf_fs_gz_reader_destroy(struct ctf_fs_gz_reader *reader)
+{
+	if (!reader) {
+		return;
+	}
+
+	if (reader->zstrm_is_init) {
+		inflateEnd(&reader->zstrm);
+	}
+
+	g_free(reader);
+}
+
+/*
+ * Returns the index of the last access point of `index` of which the
+ * uncompressed offset is less than or equal to `out_offset`.
+ */
+static
+guint find_access_point_by_out_offset(const struct ctf_fs_gz_index *index,
+		uint64_t out_offset)
+{
+	guint low = 0;
+	guint high = index->access_points->len;
+
+	BT_ASSERT_DBG(high > 0);
+
+	while (high - low > 1) {
+		const guint mid = low + (high - low) / 2;
+
+		if (g_array_index(index->access_points, struct access_point,
+				mid).out_offset <= out_offset) {
+			low = mid;
+		} else {
+			high = mid;
+		}
+	}
+
+	return low;
+}
+
+/*
+ * Returns the index of the first gzip member beginning access point of
+ * `index` of which the compressed offset is greater than or equal to
+ * `in_offset`, or the number of access points if there's none.
+ */
+static
+guint find_next_member_access_point(const struct ctf_fs_gz_index *index,
+		uint64_t in_offset)
+{
+	guint low = 0;
+	guint high = index->access_points->len;
+
+	while (low < high) {
+		const guint mid = low + (high - low) / 2;
+
+		if (g_array_index(index->access_points, struct access_point,
+				mid).in_offset < in_offset) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+
+	while (low < index->access_points->len &&
+			g_array_index(index->access_points, struct access_point,
+				low).dict) {
+		low++;
+	}
+
+	return low;
+}
+
+/*
+ * Makes the decompression of `reader` restart at the access point
+ * `access_point`.
+ */
+static
+int restart_at_access_point(struct ctf_fs_gz_reader *reader,
+		const struct access_point *access_point)
+{
+	bt_self_component *self_comp = reader->self_comp;
+	bt_logging_level log_level = reader->log_level;
+	uint64_t seek_offset = access_point->in_offset;
+	int zret;
+	int ret = 0;
+
+	reader->is_positioned = false;
+	reader->is_at_member_end = false;
+
+	if (access_point->bits > 0) {
+		/* Part of the previous byte belongs to the next block */
+		seek_offset--;
+	}
+
+	if (fseeko(reader->fp, (off_t) seek_offset, SEEK_SET)) {
+		BT_COMP_LOGE_ERRNO("Cannot seek file", ": path=\"%s\", offset=%" PRIu64,
+			reader->path, seek_offset);
+		goto error;
+	}
+
+	reader->zstrm.avail_in = 0;
+	reader->zstrm.next_in = NULL;
+	zret = inflateReset2(&reader->zstrm,
+		access_point->dict ? WINDOW_BITS_RAW : WINDOW_BITS_GZIP);
+	if (zret != Z_OK) {
+		BT_COMP_LOGE("Cannot reset zlib stream: zlib-ret=%d", zret);
+		goto error;
+	}
+
+	if (access_point->bits > 0) {
+		const int byte = getc(reader->fp);
+
+		if (byte == EOF) {
+			BT_COMP_LOGE("Cannot read file: path=\"%s\"",
+				reader->path);
+			goto error;
+		}
+
+		zret = inflatePrime(&reader->zstrm, access_point->bits,
+			byte >> (8 - access_point->bits));
+		if (zret != Z_OK) {
+			BT_COMP_LOGE("Cannot prime zlib stream: zlib-ret=%d",
+				zret);
+			goto error;
+		}
+	}
+
+	if (access_point->dict) {
+		zret = inflateSetDictionary(&reader->zstrm, access_point->dict,
+			DICT_SIZE);
+		if (zret != Z_OK) {
+			BT_COMP_LOGE("Cannot set zlib stream dictionary: "
+				"zlib-ret=%d", zret);
+			goto error;
+		}
+	}
+
+	reader->out_offset = access_point->out_offset;
+	reader->in_offset = access_point->in_offset;
+	reader->is_positioned = true;
+	goto end;
+
+error:
+	ret = -1;
+
+end:
+	return ret;
+}
+
+/*
+ * Decompresses the next `len` bytes of the file of `reader` into
+ * `buf`.
+ */
+static
+int inflate_next(struct ctf_fs_gz_reader *reader, uint8_t *buf, size_t len)
+{
+	bt_self_component *self_comp = reader->self_comp;
+	bt_logging_level log_level = reader->log_level;
+	z_stream *zstrm = &reader->zstrm;
+	int ret = 0;
+
+	while (len > 0) {
+		size_t produced;
+		int zret;
+
+		if (reader->is_at_member_end) {
+			/* Continue with the next member */
+			const guint i = find_next_member_access_point(
+				reader->index, reader->in_offset);
+
+			if (i == reader->index->access_points->len) {
+				BT_COMP_LOGE("Unexpected end of gzip-compressed file: "
+					"path=\"%s\"", reader->path);
+				goto error;
+			}
+
+			if (restart_at_access_point(reader,
+					&g_array_index(reader->index->access_points,
+						struct access_point, i))) {
+				goto error;
+			}
+		}
+
+		if (zstrm->avail_in == 0) {
+			zstrm->avail_in = fread(reader->in_buf, 1,
+				IN_BUF_SIZE, reader->fp);
+			zstrm->next_in = reader->in_buf;
+
+			if (zstrm->avail_in == 0) {
+				BT_COMP_LOGE("Cannot read file: path=\"%s\"",
+					reader->path);
+				goto error;
+			}
+		}
+
+		zstrm->next_out = buf;
+		zstrm->avail_out = (uInt) MIN(len, (size_t) UINT_MAX);
+		reader->in_offset += zstrm->avail_in;
+		produced = zstrm->avail_out;
+		zret = inflate(zstrm, Z_NO_FLUSH);
+		reader->in_offset -= zstrm->avail_in;
+		produced -= zstrm->avail_out;
+		reader->out_offset += produced;
+		buf += produced;
+		len -= produced;
+
+		if (zret == Z_STREAM_END) {
+			reader->is_at_member_end = true;
+		} else if (zret != Z_OK) {
+			BT_COMP_LOGE("Cannot decompress gzip-compressed file: "
+				"path=\"%s\", offset=%" PRIu64 ", zlib-ret=%d, "
+				"msg=\"%s\"", reader->path, reader->in_offset,
+				zret, zstrm->msg ? zstrm->msg : "");
+			goto error;
+		}
+	}
+
+	goto end;
+
+error:
+	reader->is_positioned = false;
+	ret = -1;
+
+end:
+	return ret;
+}
+
+BT_HIDDEN
+int ctf_fs_gz_reader_read(struct ctf_fs_gz_reader *reader, uint64_t offset,
+		uint8_t *buf, size_t len)
+{
+	const struct access_point *access_point;
+	int ret = 0;
+
+	BT_ASSERT_DBG(reader);
+	BT_ASSERT_DBG(offset + len <= reader->index->size);
+
+	if (len == 0) {
+		goto end;
+	}
+
+	/*
+	 * Restart the decompression at the closest access point, unless
+	 * it's faster to continue from the current position.
+	 */
+	access_point = &g_array_index(reader->index->access_points,
+		struct access_point,
+		find_access_point_by_out_offset(reader->index, offset));
+	if (!reader->is_positioned || offset < reader->out_offset ||
+			access_point->out_offset > reader->out_offset) {
+		ret = restart_at_access_point(reader, access_point);
+		if (ret) {
+			goto end;
+		}
+	}
+
+	while (reader->out_offset < offset) {
+		ret = inflate_next(reader, reader->discard_buf,
+			MIN(offset - reader->out_offset, (uint64_t) DICT_SIZE));
+		if (ret) {
+			goto end;
+		}
+	}
+
+	ret = inflate_next(reader, buf, len);
+
+end:
+	return ret;
+}
+
+BT_HIDDEN
+FILE *ctf_fs_gz_decompress_to_tmp_file(FILE *fp, const char *path,
+		bt_logging_level log_level, bt_self_component *self_comp)
+{
+	struct ctf_fs_gz_index *index = NULL;
+	struct ctf_fs_gz_reader *reader = NULL;
+	FILE *tmp_fp = NULL;
+	uint8_t *buf = NULL;
+	uint64_t offset = 0;
+
+	index = ctf_fs_gz_index_build(fp, path, log_level, self_comp);
+	if (!index) {
+		goto error;
+	}
+
+	reader = ctf_fs_gz_reader_create(index, fp, path, log_level,
+		self_comp);
+	buf = g_malloc(IN_BUF_SIZE);
+	if (!reader || !buf) {
+		goto error;
+	}
+
+	tmp_fp = tmpfile();
+	if (!tmp_fp) {
+		BT_COMP_LOGE_ERRNO("Cannot create temporary file", ": path=\"%s\"",
+			path);
+		goto error;
+	}
+
+	while (offset < index->size) {
+		const size_t len = MIN(index->size - offset,
+			(uint64_t) IN_BUF_SIZE);
+
+		if (ctf_fs_gz_reader_read(reader, offset, buf, len)) {
+			goto error;
+		}
+
+		if (fwrite(buf, 1, len, tmp_fp) != len) {
+			BT_COMP_LOGE_ERRNO("Cannot write temporary file",
+				": path=\"%s\"", path);
+			goto error;
+		}
+
+		offset += len;
+	}
+
+	if (fseek(tmp_fp, 0, SEEK_SET)) {
+		BT_COMP_LOGE_ERRNO("Cannot seek temporary file", ": path=\"%s\"",
+			path);
+		goto error;
+	}
+
+	goto end;
+
+error:
+	if (tmp_fp) {
+		fclose(tmp_fp);
+		tmp_fp = NULL;
+	}
+
+end:
+	g_free(buf);
+	ctf_fs_gz_reader_destroy(reader);
+	ctf_fs_gz_index_destroy(index);
+	return tmp_fp;
+}
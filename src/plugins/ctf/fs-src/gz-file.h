@@ -0,0 +1,142 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (C) 2023 EfficiOS Inc.
+ */
+
+#ifndef CTF_FS_GZ_FILE_H
+#define CTF_FS_GZ_FILE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "common/macros.h"
+#include <babeltrace2/babeltrace.h>
+
+/* Suffix of the name of a gzip-compressed data stream or metadata file */
+#define CTF_FS_GZ_SUFFIX	".gz"
+
+/*
+ * Random access index of a gzip-compressed file.
+ *
+ * ctf_fs_gz_index_build() decompresses the whole file once to find its
+ * uncompressed size and to record access points:
+ *
+ * * The beginning of each gzip member.
+ *
+ * * Every few megabytes of uncompressed data, a deflate block boundary
+ *   along with the 32 KiB of uncompressed data which precede it (the
+ *   decompression dictionary).
+ *
+ * A gzip reader then restarts the decompression at the closest access
+ * point before any uncompressed offset instead of at the beginning of
+ * the file. Compressing each packet, or each group of packets, as its
+ * own gzip member makes such a restart as cheap as possible.
+ *
+ * An index is immutable once built: many readers, possibly on
+ * different threads, may share it.
+ */
+struct ctf_fs_gz_index;
+
+/*
+ * Thread-safe cache of gzip indexes, by file path.
+ */
+struct ctf_fs_gz_index_cache;
+
+/*
+ * Reads uncompressed data from a gzip-compressed file at arbitrary
+ * offsets, using an index of this file.
+ */
+struct ctf_fs_gz_reader;
+
+/*
+ * Returns whether or not `path` is the path of a gzip-compressed file,
+ * according to its suffix.
+ */
+BT_HIDDEN
+bool ctf_fs_gz_is_compressed_path(const char *path);
+
+/*
+ * Builds the index of the gzip-compressed file `fp` (of which the path
+ * is `path`).
+ *
+ * Returns `NULL` on error.
+ */
+BT_HIDDEN
+struct ctf_fs_gz_index *ctf_fs_gz_index_build(FILE *fp, const char *path,
+		bt_logging_level log_level, bt_self_component *self_comp);
+
+BT_HIDDEN
+void ctf_fs_gz_index_destroy(struct ctf_fs_gz_index *index);
+
+/*
+ * Returns the uncompressed size, in bytes, of the file which `index`
+ * indexes.
+ */
+BT_HIDDEN
+uint64_t ctf_fs_gz_index_get_size(const struct ctf_fs_gz_index *index);
+
+BT_HIDDEN
+struct ctf_fs_gz_index_cache *ctf_fs_gz_index_cache_create(void);
+
+BT_HIDDEN
+void ctf_fs_gz_index_cache_destroy(struct ctf_fs_gz_index_cache *cache);
+
+/*
+ * Borrows the index of the gzip-compressed file `fp` (of which the path
+ * is `path`) from `cache`, building it first if `cache` doesn't
+ * contain it.
+ *
+ * Returns `NULL` on error.
+ */
+BT_HIDDEN
+const struct ctf_fs_gz_index *ctf_fs_gz_index_cache_borrow_index(
+		struct ctf_fs_gz_index_cache *cache, FILE *fp, const char *path,
+		bt_logging_level log_level, bt_self_component *self_comp);
+
+/*
+ * Creates a reader of the gzip-compressed file `fp` (of which the path
+ * is `path`) which `index` indexes.
+ *
+ * `index`, `fp`, and `path` must exist as long as the returned reader
+ * exists.
+ *
+ * Returns `NULL` on memory error.
+ */
+BT_HIDDEN
+struct ctf_fs_gz_reader *ctf_fs_gz_reader_create(
+		const struct ctf_fs_gz_index *index, FILE *fp, const char *path,
+		bt_logging_level log_level, bt_self_component *self_comp);
+
+BT_HIDDEN
+void ctf_fs_gz_reader_destroy(struct ctf_fs_gz_reader *reader);
+
+/*
+ * Decompresses the `len` bytes at the uncompressed offset `offset` of
+ * the file of `reader` into `buf`.
+ *
+ * Reading right after the previous read only continues the
+ * decompression.
+ *
+ * `offset + len` must not exceed the uncompressed size of the file.
+ *
+ * Returns 0 on success, or -1 on error.
+ */
+BT_HIDDEN
+int ctf_fs_gz_reader_read(struct ctf_fs_gz_reader *reader, uint64_t offset,
+		uint8_t *buf, size_t len);
+
+/*
+ * Decompresses the whole gzip-compressed file `fp` (of which the path
+ * is `path`) into a new temporary file, returning it positioned at its
+ * beginning.
+ *
+ * The temporary file disappears when you close it.
+ *
+ * Returns `NULL` on error.
+ */
+BT_HIDDEN
+FILE *ctf_fs_gz_decompress_to_tmp_file(FILE *fp, const char *path,
+		bt_logging_level log_level, bt_self_component *self_comp);
+
+#endif /* CTF_FS_GZ_FILE_H */
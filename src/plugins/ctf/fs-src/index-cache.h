@@ -0,0 +1,65 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (C) 2023 EfficiOS Inc.
+ */
+
+#ifndef CTF_FS_INDEX_CACHE_H
+#define CTF_FS_INDEX_CACHE_H
+
+#include <stdint.h>
+
+/*
+ * Packet index cache file, which `src.ctf.fs` writes to the directory
+ * of its `index-cache-dir` parameter after indexing a data stream file
+ * which has no LTTng index file.
+ *
+ * The file contains a header, the path of the indexed data stream file
+ * (`path_len` bytes, no terminating null character), and then
+ * `entry_count` entries.
+ *
+ * The timestamps are raw clock values so that the clock class offset
+ * parameters don't invalidate the cache.
+ *
+ * All integer fields are stored in big endian.
+ */
+
+#define CTF_FS_INDEX_CACHE_MAGIC	0xB7C1DCC1
+#define CTF_FS_INDEX_CACHE_VERSION	2
+
+struct ctf_fs_index_cache_file_hdr {
+	uint32_t magic;
+	uint32_t version;
+
+	/* Size of `struct ctf_fs_index_cache_entry`, in bytes */
+	uint32_t entry_len;
+
+	/* Length of the data stream file path, in bytes */
+	uint32_t path_len;
+
+	/*
+	 * Size (bytes), modification time (seconds and nanoseconds since
+	 * the Unix epoch), device number, and inode number of the data
+	 * stream file when it was indexed.
+	 *
+	 * A file rewritten within the same second or replaced with
+	 * another one of the same size doesn't match.
+	 */
+	uint64_t file_size;
+	uint64_t file_mtime_sec;
+	uint64_t file_mtime_nsec;
+	uint64_t file_dev;
+	uint64_t file_ino;
+
+	uint64_t entry_count;
+} __attribute__((__packed__));
+
+struct ctf_fs_index_cache_entry {
+	uint64_t offset;		/* offset of the packet in the file, in bytes */
+	uint64_t packet_size;		/* packet size, in bytes */
+	uint64_t timestamp_begin;	/* -1 if not available */
+	uint64_t timestamp_end;		/* -1 if not available */
+	uint64_t packet_seq_num;	/* -1 if not available */
+} __attribute__((__packed__));
+
+#endif /* CTF_FS_INDEX_CACHE_H */
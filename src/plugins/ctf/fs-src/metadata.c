@@ -13,6 +13,7 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 #include "common/assert.h"
 #include <glib.h>
 #include "common/uuid.h"
@@ -21,14 +22,17 @@
 
 #include "fs.h"
 #include "file.h"
+#include "gz-file.h"
 #include "metadata.h"
 #include "../common/metadata/decoder.h"
 
 BT_HIDDEN
-FILE *ctf_fs_metadata_open_file(const char *trace_path)
+FILE *ctf_fs_metadata_open_file(const char *trace_path,
+		bt_logging_level log_level, bt_self_component *self_comp)
 {
 	GString *metadata_path;
 	FILE *fp = NULL;
+	FILE *gz_fp;
 
 	metadata_path = g_string_new(trace_path);
 	if (!metadata_path) {
@@ -37,37 +41,29 @@ FILE *ctf_fs_metadata_open_file(const char *trace_path)
 
 	g_string_append(metadata_path, G_DIR_SEPARATOR_S CTF_FS_METADATA_FILENAME);
 	fp = fopen(metadata_path->str, "rb");
-	g_string_free(metadata_path, TRUE);
-end:
-	return fp;
-}
-
-static struct ctf_fs_file *get_file(const char *trace_path,
-		bt_logging_level log_level, bt_self_component *self_comp)
-{
-	struct ctf_fs_file *file = ctf_fs_file_create(log_level, self_comp);
-
-	if (!file) {
-		goto error;
+	if (fp) {
+		goto end;
 	}
 
-	g_string_append(file->path, trace_path);
-	g_string_append(file->path, G_DIR_SEPARATOR_S CTF_FS_METADATA_FILENAME);
-
-	if (ctf_fs_file_open(file, "rb")) {
-		goto error;
+	/* Try the gzip-compressed metadata file */
+	g_string_append(metadata_path, CTF_FS_GZ_SUFFIX);
+	gz_fp = fopen(metadata_path->str, "rb");
+	if (!gz_fp) {
+		goto end;
 	}
 
-	goto end;
+	BT_COMP_LOGI("Decompressing metadata file: path=\"%s\"",
+		metadata_path->str);
+	fp = ctf_fs_gz_decompress_to_tmp_file(gz_fp, metadata_path->str,
+		log_level, self_comp);
+	fclose(gz_fp);
 
-error:
-	if (file) {
-		ctf_fs_file_destroy(file);
-		file = NULL;
+end:
+	if (metadata_path) {
+		g_string_free(metadata_path, TRUE);
 	}
 
-end:
-	return file;
+	return fp;
 }
 
 BT_HIDDEN
@@ -77,7 +73,7 @@ int ctf_fs_metadata_set_trace_class(
 		struct ctf_fs_metadata_config *config)
 {
 	int ret = 0;
-	struct ctf_fs_file *file = NULL;
+	FILE *fp = NULL;
 	struct ctf_metadata_decoder_config decoder_config = {
 		.log_level = ctf_fs_trace->log_level,
 		.self_comp = self_comp,
@@ -89,9 +85,25 @@ int ctf_fs_metadata_set_trace_class(
 	};
 	bt_logging_level log_level = ctf_fs_trace->log_level;
 
-	file = get_file(ctf_fs_trace->path->str, log_level, self_comp);
-	if (!file) {
-		BT_COMP_LOGE("Cannot create metadata file object.");
+	/*
+	 * Copying the packets verbatim (see `struct ctf_raw_packet`)
+	 * would drop the clock class adjustments, which only exist in
+	 * the trace IR, and would bring back the events which the
+	 * event class filter removes.
+	 */
+	const bool attach_raw_packets = self_comp &&
+		decoder_config.clock_class_offset_s == 0 &&
+		decoder_config.clock_class_offset_ns == 0 &&
+		!decoder_config.force_clock_class_origin_unix_epoch &&
+		!(config && config->filters_events);
+
+	decoder_config.keep_plain_text = attach_raw_packets;
+
+	fp = ctf_fs_metadata_open_file(ctf_fs_trace->path->str, log_level,
+		self_comp);
+	if (!fp) {
+		BT_COMP_LOGE("Cannot open metadata file: trace-path=\"%s\"",
+			ctf_fs_trace->path->str);
 		ret = -1;
 		goto end;
 	}
@@ -105,7 +117,7 @@ int ctf_fs_metadata_set_trace_class(
 	}
 
 	ret = ctf_metadata_decoder_append_content(
-		ctf_fs_trace->metadata->decoder, file->fp);
+		ctf_fs_trace->metadata->decoder, fp);
 	if (ret) {
 		BT_COMP_LOGE("Cannot update metadata decoder's content.");
 		goto end;
@@ -120,8 +132,24 @@ int ctf_fs_metadata_set_trace_class(
 			ctf_fs_trace->metadata->decoder);
 	BT_ASSERT(ctf_fs_trace->metadata->tc);
 
+	if (attach_raw_packets) {
+		const char *text = ctf_metadata_decoder_get_text(
+			ctf_fs_trace->metadata->decoder);
+
+		ctf_fs_trace->metadata->raw_packet_metadata =
+			ctf_raw_packet_metadata_create(text);
+		if (!ctf_fs_trace->metadata->raw_packet_metadata) {
+			BT_COMP_LOGE("Cannot create raw packet metadata.");
+			ret = -1;
+			goto end;
+		}
+	}
+
 end:
-	ctf_fs_file_destroy(file);
+	if (fp) {
+		fclose(fp);
+	}
+
 	return ret;
 }
 
@@ -137,6 +165,8 @@ void ctf_fs_metadata_fini(struct ctf_fs_metadata *metadata)
 {
 	free(metadata->text);
 
+	ctf_raw_packet_metadata_put_ref(metadata->raw_packet_metadata);
+
 	if (metadata->trace_class) {
 		BT_TRACE_CLASS_PUT_REF_AND_RESET(metadata->trace_class);
 	}
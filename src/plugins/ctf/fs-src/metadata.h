@@ -22,6 +22,12 @@ struct ctf_fs_metadata_config {
 	bool force_clock_class_origin_unix_epoch;
 	int64_t clock_class_offset_s;
 	int64_t clock_class_offset_ns;
+
+	/*
+	 * True if the component filters out some events (see
+	 * `struct ctf_msg_iter_event_class_filter`).
+	 */
+	bool filters_events;
 };
 
 BT_HIDDEN
@@ -35,8 +41,14 @@ int ctf_fs_metadata_set_trace_class(bt_self_component *self_comp,
 		struct ctf_fs_trace *ctf_fs_trace,
 		struct ctf_fs_metadata_config *config);
 
+/*
+ * Opens the metadata file of the trace located in `trace_path`,
+ * decompressing it first into a temporary file if it's
+ * gzip-compressed.
+ */
 BT_HIDDEN
-FILE *ctf_fs_metadata_open_file(const char *trace_path);
+FILE *ctf_fs_metadata_open_file(const char *trace_path,
+		bt_logging_level log_level, bt_self_component *self_comp);
 
 BT_HIDDEN
 bool ctf_metadata_is_packetized(FILE *fp, int *byte_order);
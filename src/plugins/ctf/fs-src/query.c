@@ -88,7 +88,7 @@ bt_component_class_query_method_status metadata_info_query(
 	path = bt_value_string_get(path_value);
 
 	BT_ASSERT(path);
-	metadata_fp = ctf_fs_metadata_open_file(path);
+	metadata_fp = ctf_fs_metadata_open_file(path, log_level, NULL);
 	if (!metadata_fp) {
 		BT_COMP_CLASS_LOGE_APPEND_CAUSE(self_comp_class,
 			"Cannot open trace metadata: path=\"%s\".", path);
@@ -409,7 +409,6 @@ bt_component_class_query_method_status support_info_query(
 	bt_component_class_query_method_status status;
 	bt_value_map_insert_entry_status insert_entry_status;
 	double weight = 0;
-	gchar *metadata_path = NULL;
 	bt_value *result = NULL;
 	struct ctf_metadata_decoder *metadata_decoder = NULL;
 	FILE *metadata_file = NULL;
@@ -432,13 +431,7 @@ bt_component_class_query_method_status support_info_query(
 	BT_ASSERT(bt_value_get_type(input_value) == BT_VALUE_TYPE_STRING);
 	input = bt_value_string_get(input_value);
 
-	metadata_path = g_build_filename(input, CTF_FS_METADATA_FILENAME, NULL);
-	if (!metadata_path) {
-		status = BT_COMPONENT_CLASS_QUERY_METHOD_STATUS_MEMORY_ERROR;
-		goto end;
-	}
-
-	metadata_file = g_fopen(metadata_path, "rb");
+	metadata_file = ctf_fs_metadata_open_file(input, log_level, NULL);
 	if (metadata_file) {
 		struct ctf_metadata_decoder_config metadata_decoder_config = { 0 };
 		enum ctf_metadata_decoder_status decoder_status;
@@ -504,7 +497,10 @@ create_result:
 	status = BT_COMPONENT_CLASS_QUERY_METHOD_STATUS_OK;
 
 end:
-	g_free(metadata_path);
+	if (metadata_file) {
+		fclose(metadata_file);
+	}
+
 	bt_value_put_ref(result);
 	ctf_metadata_decoder_destroy(metadata_decoder);
 
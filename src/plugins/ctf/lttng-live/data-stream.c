@@ -170,6 +170,12 @@ enum lttng_live_iterator_status lttng_live_lazy_msg_init(
 					"Failed to create CTF message iterator");
 				goto error;
 			}
+
+			if (ctf_msg_iter_set_event_class_filter(
+					stream_iter->msg_iter,
+					lttng_live->params.ec_filter)) {
+				goto error;
+			}
 		}
 	}
 
@@ -237,6 +243,11 @@ struct lttng_live_stream_iterator *lttng_live_stream_iterator_create(
 				"Failed to create CTF message iterator");
 			goto error;
 		}
+
+		if (ctf_msg_iter_set_event_class_filter(stream_iter->msg_iter,
+				lttng_live->params.ec_filter)) {
+			goto error;
+		}
 	}
 	stream_iter->buf = g_new0(uint8_t, lttng_live->max_query_size);
 	if (!stream_iter->buf) {
@@ -35,6 +35,8 @@
 #define URL_PARAM			    "url"
 #define INPUTS_PARAM			    "inputs"
 #define SESS_NOT_FOUND_ACTION_PARAM	    "session-not-found-action"
+#define EVENT_CLASS_NAMES_PARAM		    "event-class-names"
+#define EVENT_CLASS_IDS_PARAM		    "event-class-ids"
 #define SESS_NOT_FOUND_ACTION_CONTINUE_STR  "continue"
 #define SESS_NOT_FOUND_ACTION_FAIL_STR	    "fail"
 #define SESS_NOT_FOUND_ACTION_END_STR	    "end"
@@ -1740,6 +1742,17 @@ bt_message_iterator_class_initialize_method_status lttng_live_msg_iter_init(
 		goto error;
 	}
 
+#ifndef __MINGW32__
+	/*
+	 * Make bt_graph_run_and_wait() wake up as soon as the relay
+	 * daemon sends something on the control socket (or closes it)
+	 * after this iterator returned "try again", instead of waiting
+	 * for the whole retry duration.
+	 */
+	bt_self_message_iterator_set_wake_up_fd(self_msg_it,
+		lttng_live_msg_iter->viewer_connection->control_sock);
+#endif
+
 	viewer_status = lttng_live_create_viewer_session(lttng_live_msg_iter);
 	if (viewer_status != LTTNG_LIVE_VIEWER_STATUS_OK) {
 		if (viewer_status == LTTNG_LIVE_VIEWER_STATUS_ERROR) {
@@ -1994,6 +2007,7 @@ void lttng_live_component_destroy_data(struct lttng_live_component *lttng_live)
 	if (lttng_live->params.url) {
 		g_string_free(lttng_live->params.url, TRUE);
 	}
+	ctf_msg_iter_event_class_filter_destroy(lttng_live->params.ec_filter);
 	g_free(lttng_live);
 }
 
@@ -2038,6 +2052,14 @@ static const char *sess_not_found_action_choices[] = {
 	SESS_NOT_FOUND_ACTION_END_STR,
 };
 
+static struct bt_param_validation_value_descr event_class_names_elem_descr = {
+	.type = BT_VALUE_TYPE_STRING,
+};
+
+static struct bt_param_validation_value_descr event_class_ids_elem_descr = {
+	.type = BT_VALUE_TYPE_UNSIGNED_INTEGER,
+};
+
 static struct bt_param_validation_map_value_entry_descr params_descr[] = {
 	{ INPUTS_PARAM, BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_MANDATORY, { BT_VALUE_TYPE_ARRAY, .array = {
 		.min_length = 1,
@@ -2047,6 +2069,16 @@ static struct bt_param_validation_map_value_entry_descr params_descr[] = {
 	{ SESS_NOT_FOUND_ACTION_PARAM, BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { BT_VALUE_TYPE_STRING, .string = {
 		.choices = sess_not_found_action_choices,
 	} } },
+	{ EVENT_CLASS_NAMES_PARAM, BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { BT_VALUE_TYPE_ARRAY, .array = {
+		.min_length = 0,
+		.max_length = BT_PARAM_VALIDATION_INFINITE,
+		.element_type = &event_class_names_elem_descr,
+	} } },
+	{ EVENT_CLASS_IDS_PARAM, BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { BT_VALUE_TYPE_ARRAY, .array = {
+		.min_length = 0,
+		.max_length = BT_PARAM_VALIDATION_INFINITE,
+		.element_type = &event_class_ids_elem_descr,
+	} } },
 	BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_END
 };
 
@@ -2061,6 +2093,8 @@ bt_component_class_initialize_method_status lttng_live_component_create(
 	const bt_value *inputs_value;
 	const bt_value *url_value;
 	const bt_value *value;
+	const bt_value *event_class_names_value;
+	const bt_value *event_class_ids_value;
 	const char *url;
 	enum bt_param_validation_status validation_status;
 	gchar *validation_error = NULL;
@@ -2113,6 +2147,22 @@ bt_component_class_initialize_method_status lttng_live_component_create(
 			SESSION_NOT_FOUND_ACTION_CONTINUE;
 	}
 
+	event_class_names_value = bt_value_map_borrow_entry_value_const(params,
+		EVENT_CLASS_NAMES_PARAM);
+	event_class_ids_value = bt_value_map_borrow_entry_value_const(params,
+		EVENT_CLASS_IDS_PARAM);
+	if (event_class_names_value || event_class_ids_value) {
+		lttng_live->params.ec_filter =
+			ctf_msg_iter_event_class_filter_create(
+				event_class_names_value, event_class_ids_value);
+		if (!lttng_live->params.ec_filter) {
+			BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+				"Failed to create an event class filter.");
+			status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
+			goto error;
+		}
+	}
+
 	status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_OK;
 	goto end;
 
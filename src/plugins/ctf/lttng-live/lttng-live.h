@@ -206,6 +206,14 @@ struct lttng_live_component {
 	struct {
 		GString *url;
 		enum session_not_found_action sess_not_found_act;
+
+		/*
+		 * Event classes of which the message iterators emit
+		 * the event messages (`event-class-names` and
+		 * `event-class-ids` parameters), owned by this, or
+		 * `NULL` to emit all of them.
+		 */
+		struct ctf_msg_iter_event_class_filter *ec_filter;
 	} params;
 
 	size_t max_query_size;
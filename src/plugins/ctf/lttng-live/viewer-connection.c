@@ -94,6 +94,24 @@ enum ctf_msg_iter_medium_status viewer_status_to_ctf_msg_iter_medium_status(
 	}
 }
 
+/*
+ * Makes sure the message iterator of `viewer_connection`, if any, stops
+ * using its control socket as its wake-up file descriptor before
+ * closing it.
+ */
+static inline
+void viewer_connection_unset_wake_up_fd(
+		struct live_viewer_connection *viewer_connection)
+{
+#ifndef __MINGW32__
+	if (viewer_connection->lttng_live_msg_iter) {
+		bt_self_message_iterator_set_wake_up_fd(
+			viewer_connection->lttng_live_msg_iter->self_msg_iter,
+			-1);
+	}
+#endif
+}
+
 static inline
 void viewer_connection_close_socket(
 		struct live_viewer_connection *viewer_connection)
@@ -102,7 +120,10 @@ void viewer_connection_close_socket(
 		viewer_connection->self_comp_class;
 	bt_self_component *self_comp =
 		viewer_connection->self_comp;
-	int ret = bt_socket_close(viewer_connection->control_sock);
+	int ret;
+
+	viewer_connection_unset_wake_up_fd(viewer_connection);
+	ret = bt_socket_close(viewer_connection->control_sock);
 	if (ret == -1) {
 		BT_COMP_OR_COMP_CLASS_LOGW_ERRNO(
 			self_comp, self_comp_class,
@@ -490,6 +511,8 @@ void lttng_live_disconnect_viewer(
 	if (viewer_connection->control_sock == BT_INVALID_SOCKET) {
 		return;
 	}
+
+	viewer_connection_unset_wake_up_fd(viewer_connection);
 	if (bt_socket_close(viewer_connection->control_sock) == BT_SOCKET_ERROR) {
 		BT_COMP_OR_COMP_CLASS_LOGW(self_comp, self_comp_class,
 			"Error closing socket: %s", bt_socket_errormsg());
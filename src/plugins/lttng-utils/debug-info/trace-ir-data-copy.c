@@ -346,6 +346,7 @@ enum debug_info_trace_ir_mapping_status copy_field_content(
 		bt_field *out_element_field;
 		uint64_t i, array_len;
 		bt_field_array_dynamic_set_length_status set_len_status;
+		bt_field_class_type in_elem_fc_type;
 
 		array_len = bt_field_array_get_length(in_field);
 
@@ -364,21 +365,45 @@ enum debug_info_trace_ir_mapping_status copy_field_content(
 			}
 		}
 
-		for (i = 0; i < array_len; i++) {
-			in_element_field =
-				bt_field_array_borrow_element_field_by_index_const(
-					in_field, i);
-			out_element_field =
-				bt_field_array_borrow_element_field_by_index(
-					out_field, i);
-			status = copy_field_content(in_element_field,
-				out_element_field, log_level, self_comp);
-			if (status != DEBUG_INFO_TRACE_IR_MAPPING_STATUS_OK) {
-				BT_COMP_LOGE_APPEND_CAUSE(self_comp,
-					"Cannot copy element field: "
-					"out-arr-f-addr=%p, out-arr-elem-f-addr=%p",
-					out_field, out_element_field);
-				goto end;
+		in_elem_fc_type = bt_field_class_get_type(
+			bt_field_class_array_borrow_element_field_class_const(
+				bt_field_borrow_class_const(in_field)));
+
+		/* Copy numeric elements at once */
+		if (bt_field_class_type_is(in_elem_fc_type,
+				BT_FIELD_CLASS_TYPE_UNSIGNED_INTEGER)) {
+			bt_field_array_set_unsigned_integer_element_values(
+				out_field,
+				bt_field_array_borrow_unsigned_integer_element_values_const(
+					in_field));
+		} else if (bt_field_class_type_is(in_elem_fc_type,
+				BT_FIELD_CLASS_TYPE_SIGNED_INTEGER)) {
+			bt_field_array_set_signed_integer_element_values(
+				out_field,
+				bt_field_array_borrow_signed_integer_element_values_const(
+					in_field));
+		} else if (bt_field_class_type_is(in_elem_fc_type,
+				BT_FIELD_CLASS_TYPE_REAL)) {
+			bt_field_array_set_real_element_values(out_field,
+				bt_field_array_borrow_real_element_values_const(
+					in_field));
+		} else {
+			for (i = 0; i < array_len; i++) {
+				in_element_field =
+					bt_field_array_borrow_element_field_by_index_const(
+						in_field, i);
+				out_element_field =
+					bt_field_array_borrow_element_field_by_index(
+						out_field, i);
+				status = copy_field_content(in_element_field,
+					out_element_field, log_level, self_comp);
+				if (status != DEBUG_INFO_TRACE_IR_MAPPING_STATUS_OK) {
+					BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+						"Cannot copy element field: "
+						"out-arr-f-addr=%p, out-arr-elem-f-addr=%p",
+						out_field, out_element_field);
+					goto end;
+				}
 			}
 		}
 	} else if (bt_field_class_type_is(in_fc_type,
@@ -26,9 +26,22 @@ static
 const char * const in_port_name = "in";
 
 static
-void destroy_pretty_data(struct pretty_component *pretty)
+void destroy_enum_bit_flag_table(struct enum_bit_flag_table *table)
 {
 	uint64_t i;
+
+	for (i = 0; i < ENUMERATION_MAX_BITFLAGS_COUNT; i++) {
+		if (table->bit_labels[i]) {
+			g_ptr_array_free(table->bit_labels[i], TRUE);
+		}
+	}
+
+	g_free(table);
+}
+
+static
+void destroy_pretty_data(struct pretty_component *pretty)
+{
 	if (!pretty) {
 		goto end;
 	}
@@ -52,10 +65,8 @@ void destroy_pretty_data(struct pretty_component *pretty)
 		}
 	}
 
-	for (i = 0; i < ENUMERATION_MAX_BITFLAGS_COUNT; i++) {
-		if (pretty->enum_bit_labels[i]) {
-			g_ptr_array_free(pretty->enum_bit_labels[i], true);
-		}
+	if (pretty->enum_bit_flag_tables) {
+		g_hash_table_destroy(pretty->enum_bit_flag_tables);
 	}
 
 	g_free(pretty->options.output_path);
@@ -598,16 +609,18 @@ bt_component_class_initialize_method_status pretty_init(
 	set_use_colors(pretty);
 
 	if (pretty->options.print_enum_flags) {
-		uint64_t i;
-		/*
-		 * Allocate all label arrays during the initialization of the
-		 * component and reuse the same set of arrays for all
-		 * enumerations.
-		 */
-		for (i = 0; i < ENUMERATION_MAX_BITFLAGS_COUNT; i++) {
-			pretty->enum_bit_labels[i] = g_ptr_array_new();
+		pretty->enum_bit_flag_tables = g_hash_table_new_full(
+			g_direct_hash, g_direct_equal,
+			(GDestroyNotify) bt_field_class_put_ref,
+			(GDestroyNotify) destroy_enum_bit_flag_table);
+		if (!pretty->enum_bit_flag_tables) {
+			BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+				"Failed to allocate a GHashTable.");
+			status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
+			goto error;
 		}
 	}
+
 	bt_self_component_set_data(self_comp, pretty);
 
 	status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_OK;
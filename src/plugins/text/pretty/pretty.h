@@ -19,6 +19,19 @@
  */
 #define ENUMERATION_MAX_BITFLAGS_COUNT (sizeof(uint64_t) * 8)
 
+/*
+ * Labels of the bit flags of an enumeration field class.
+ */
+struct enum_bit_flag_table {
+	/*
+	 * For each bit of the integer backing the enumeration, labels
+	 * (`const char *`, owned by the field class) of the mappings
+	 * having a single-value range which is this bit's value, in
+	 * mapping order.
+	 */
+	GPtrArray *bit_labels[ENUMERATION_MAX_BITFLAGS_COUNT];
+};
+
 enum pretty_default {
 	PRETTY_DEFAULT_UNSET,
 	PRETTY_DEFAULT_SHOW,
@@ -80,16 +93,17 @@ struct pretty_component {
 	bool negative_timestamp_warning_done;
 
 	/*
-	 * For each bit of the integer backing the enumeration we have a list
-	 * (GPtrArray) of labels (char *) for that bit.
+	 * Bit flag label table of each enumeration field class which
+	 * the component tried to print as bit flags:
+	 * `const bt_field_class *` (owned reference) to
+	 * `struct enum_bit_flag_table *` (owned).
 	 *
-	 * Allocate all label arrays during the initialization of the component
-	 * and reuse the same set of arrays for all enumerations. This prevents
-	 * allocation and deallocation everytime the component encounters a
-	 * enumeration field. Allocating and deallocating that often could
-	 * severely impact performance.
+	 * The component builds the table of a given field class once,
+	 * when it first encounters one of its fields, so that finding
+	 * the labels of a bit afterwards is a single array access
+	 * instead of a scan of all the mappings.
 	 */
-	GPtrArray *enum_bit_labels[ENUMERATION_MAX_BITFLAGS_COUNT];
+	GHashTable *enum_bit_flag_tables;
 
 	bt_logging_level log_level;
 	bt_self_component *self_comp;
@@ -717,246 +717,274 @@ void print_enum_value_label_array(struct pretty_component *pretty,
 }
 
 /*
- * Print arrays of labels and counts are ORed bit flags.
+ * Print the labels of the bits set in `value` as ORed bit flags.
  */
 static
-void print_enum_value_bit_flag_label_arrays(struct pretty_component *pretty)
+void print_enum_value_bit_flag_label_arrays(struct pretty_component *pretty,
+		const struct enum_bit_flag_table *table, uint64_t value)
 {
 	uint64_t i;
 	bool first_label = true;
 
-	/* For each bit with a label count > 0, print the labels. */
+	/* For each bit set, print the labels. */
 	for (i = 0; i < ENUMERATION_MAX_BITFLAGS_COUNT; i++) {
-		uint64_t label_count = pretty->enum_bit_labels[i]->len;
+		const GPtrArray *labels = table->bit_labels[i];
 
-		if (label_count > 0) {
-			if (!first_label) {
-				bt_common_g_string_append(pretty->string, " | ");
-			}
-			print_enum_value_label_array(pretty, label_count,
-				(void *) pretty->enum_bit_labels[i]->pdata);
-			first_label = false;
+		if ((value & (UINT64_C(1) << i)) == 0) {
+			continue;
+		}
+
+		if (!first_label) {
+			bt_common_g_string_append(pretty->string, " | ");
 		}
+		print_enum_value_label_array(pretty, labels->len,
+			(void *) labels->pdata);
+		first_label = false;
 	}
 }
 
 /*
- * Get the labels mapping to an unsigned value.
- *
- * This function will set the count to the count of mapping labels that match
- * the value. If count == 0, the caller has nothing to do, if count > 0,
- * the label_array contains the labels to print and the caller is reponsible
- * to call g_free on it once the values have been used.
+ * Adds the label of `mapping` to the labels of the bit `bit_index` of
+ * `table`, unless another range of the same mapping already did.
  */
 static
-void print_enum_unsigned_get_mapping_labels_for_value(const bt_field_class *fc,
-		uint64_t value, GPtrArray *labels)
+void add_enum_bit_flag_label(struct enum_bit_flag_table *table,
+		uint64_t bit_index, const bt_field_class_enumeration_mapping *mapping)
 {
-	uint64_t mapping_count = bt_field_class_enumeration_get_mapping_count(fc);
-	uint64_t i;
+	GPtrArray *labels = table->bit_labels[bit_index];
+	const char *label = bt_field_class_enumeration_mapping_get_label(
+		mapping);
 
-	for (i = 0; i < mapping_count; i++) {
-		uint64_t range_i;
-		const struct bt_field_class_enumeration_unsigned_mapping *mapping =
-			bt_field_class_enumeration_unsigned_borrow_mapping_by_index_const(fc, i);
-		const bt_integer_range_set_unsigned *ranges =
-			bt_field_class_enumeration_unsigned_mapping_borrow_ranges_const(mapping);
-		uint64_t range_count = bt_integer_range_set_get_range_count(
-				bt_integer_range_set_unsigned_as_range_set_const(ranges));
-
-		for (range_i = 0; range_i < range_count; range_i++) {
-			const bt_integer_range_unsigned *range =
-				bt_integer_range_set_unsigned_borrow_range_by_index_const(ranges, range_i);
-			uint64_t lower = bt_integer_range_unsigned_get_lower(range);
-			uint64_t upper = bt_integer_range_unsigned_get_upper(range);
-
-			/*
-			 * Flag is active if this range represents a single value
-			 * (lower == upper) and the lower is the same as the bit
-			 * value to test against.
-			 */
-			if ((lower == upper) && (lower == value)) {
-				g_ptr_array_add(labels, (void *) bt_field_class_enumeration_mapping_get_label(
-					bt_field_class_enumeration_unsigned_mapping_as_mapping_const(mapping)));
-				break;
-			}
-		}
+	/* Mappings are visited in order: only check the last label */
+	if (labels->len > 0 && labels->pdata[labels->len - 1] == label) {
+		return;
 	}
+
+	g_ptr_array_add(labels, (void *) label);
 }
 
 /*
- * Splits an unsigned enum value into its bit and for each bit set,
- * try to find a corresponding label.
- *
- * If any bit set does not have a corresponding label, then it prints
- * an unknown value, otherwise, it prints the labels, separated by '|'
+ * Returns the index of the bit of which `value` is the value, or -1 if
+ * `value` isn't a power of two.
  */
 static
-void print_enum_unsigned_try_bit_flags(struct pretty_component *pretty,
-		const bt_field *field)
+int bit_flag_value_to_index(uint64_t value)
 {
-	uint64_t i;
-	uint64_t value = bt_field_integer_unsigned_get_value(field);
-	const bt_field_class *fc = bt_field_borrow_class_const(field);
+	int index = 0;
 
-	/* Value is 0, if there was a label for it, we would know by now. */
-	if (value == 0) {
-		print_enum_value_label_unknown(pretty);
-		goto end;
+	if (value == 0 || (value & (value - 1)) != 0) {
+		return -1;
 	}
 
-	for (i = 0; i < ENUMERATION_MAX_BITFLAGS_COUNT; i++) {
-		uint64_t bit_value = UINT64_C(1) << i;
-
-		if ((value & bit_value) != 0) {
-			print_enum_unsigned_get_mapping_labels_for_value(
-				fc, bit_value, pretty->enum_bit_labels[i]);
-
-			if (pretty->enum_bit_labels[i]->len == 0) {
-				/*
-				 * This bit has no matching label, so this
-				 * field is not a bit flag field, print
-				 * unknown and return.
-				 */
-				print_enum_value_label_unknown(pretty);
-				goto end;
-			}
-		}
+	while (value >>= 1) {
+		index++;
 	}
 
-	print_enum_value_bit_flag_label_arrays(pretty);
-
-end:
-	return;
+	return index;
 }
 
 /*
- * Get the labels mapping to a signed value
+ * Creates the bit flag label table of the enumeration field class `fc`.
  *
- * This function will set the count to the count of mapping labels that match
- * the value. If count == 0, the caller has nothing to do, if count > 0,
- * the label_array contains the labels to print and the caller is reponsible
- * to call g_free on it once the values have been used.
+ * A flag is active if a range of a mapping represents a single value
+ * (lower == upper) which is the value of the bit to test against.
  */
 static
-void print_enum_signed_get_mapping_labels_for_value(const bt_field_class *fc,
-		int64_t value, GPtrArray *labels)
+struct enum_bit_flag_table *create_enum_bit_flag_table(
+		const bt_field_class *fc)
 {
+	struct enum_bit_flag_table *table;
 	uint64_t mapping_count = bt_field_class_enumeration_get_mapping_count(fc);
+	bool is_signed = bt_field_class_get_type(fc) ==
+		BT_FIELD_CLASS_TYPE_SIGNED_ENUMERATION;
 	uint64_t i;
 
+	table = g_new0(struct enum_bit_flag_table, 1);
+	if (!table) {
+		goto error;
+	}
+
+	for (i = 0; i < ENUMERATION_MAX_BITFLAGS_COUNT; i++) {
+		table->bit_labels[i] = g_ptr_array_new();
+		if (!table->bit_labels[i]) {
+			goto error;
+		}
+	}
+
 	for (i = 0; i < mapping_count; i++) {
 		uint64_t range_i;
-		const struct bt_field_class_enumeration_signed_mapping *mapping =
-			bt_field_class_enumeration_signed_borrow_mapping_by_index_const(fc, i);
-		const bt_integer_range_set_signed *ranges =
-			bt_field_class_enumeration_signed_mapping_borrow_ranges_const(mapping);
-		uint64_t range_count = bt_integer_range_set_get_range_count(
+
+		if (is_signed) {
+			const bt_field_class_enumeration_signed_mapping *mapping =
+				bt_field_class_enumeration_signed_borrow_mapping_by_index_const(fc, i);
+			const bt_integer_range_set_signed *ranges =
+				bt_field_class_enumeration_signed_mapping_borrow_ranges_const(mapping);
+			uint64_t range_count = bt_integer_range_set_get_range_count(
 				bt_integer_range_set_signed_as_range_set_const(ranges));
 
-		for (range_i = 0; range_i < range_count; range_i++) {
-			const bt_integer_range_signed *range =
-				bt_integer_range_set_signed_borrow_range_by_index_const(ranges, range_i);
-			uint64_t lower = bt_integer_range_signed_get_lower(range);
-			uint64_t upper = bt_integer_range_signed_get_upper(range);
+			for (range_i = 0; range_i < range_count; range_i++) {
+				const bt_integer_range_signed *range =
+					bt_integer_range_set_signed_borrow_range_by_index_const(ranges, range_i);
+				int64_t lower = bt_integer_range_signed_get_lower(range);
+				int bit_index;
+
+				if (lower != bt_integer_range_signed_get_upper(range) ||
+						lower <= 0) {
+					continue;
+				}
+
+				bit_index = bit_flag_value_to_index((uint64_t) lower);
+				if (bit_index >= 0) {
+					add_enum_bit_flag_label(table, bit_index,
+						bt_field_class_enumeration_signed_mapping_as_mapping_const(mapping));
+				}
+			}
+		} else {
+			const bt_field_class_enumeration_unsigned_mapping *mapping =
+				bt_field_class_enumeration_unsigned_borrow_mapping_by_index_const(fc, i);
+			const bt_integer_range_set_unsigned *ranges =
+				bt_field_class_enumeration_unsigned_mapping_borrow_ranges_const(mapping);
+			uint64_t range_count = bt_integer_range_set_get_range_count(
+				bt_integer_range_set_unsigned_as_range_set_const(ranges));
 
-			/*
-			 * Flag is active if this range represents a single value
-			 * (lower == upper) and the lower is the same as the bit
-			 * value to test against.
-			 */
-			if ((lower == upper) && (lower == value)) {
-				g_ptr_array_add(labels, (void*) bt_field_class_enumeration_mapping_get_label(
-					bt_field_class_enumeration_signed_mapping_as_mapping_const(mapping)));
-				break;
+			for (range_i = 0; range_i < range_count; range_i++) {
+				const bt_integer_range_unsigned *range =
+					bt_integer_range_set_unsigned_borrow_range_by_index_const(ranges, range_i);
+				uint64_t lower = bt_integer_range_unsigned_get_lower(range);
+				int bit_index;
+
+				if (lower != bt_integer_range_unsigned_get_upper(range)) {
+					continue;
+				}
+
+				bit_index = bit_flag_value_to_index(lower);
+				if (bit_index >= 0) {
+					add_enum_bit_flag_label(table, bit_index,
+						bt_field_class_enumeration_unsigned_mapping_as_mapping_const(mapping));
+				}
 			}
 		}
 	}
+
+	goto end;
+
+error:
+	if (table) {
+		for (i = 0; i < ENUMERATION_MAX_BITFLAGS_COUNT; i++) {
+			if (table->bit_labels[i]) {
+				g_ptr_array_free(table->bit_labels[i], TRUE);
+			}
+		}
+
+		g_free(table);
+		table = NULL;
+	}
+
+end:
+	return table;
 }
 
 /*
- * Splits a signed enum value into its bit and for each bit set,
- * try to find a corresponding label.
- *
- * If any bit set does not have a corresponding label, then it prints
- * an unknown value, otherwise, it prints the labels, separated by '|'.
+ * Borrows the bit flag label table of the enumeration field class
+ * `fc`, creating it the first time.
  */
 static
-void print_enum_signed_try_bit_flags(struct pretty_component *pretty,
-		const bt_field *field)
+const struct enum_bit_flag_table *borrow_enum_bit_flag_table(
+		struct pretty_component *pretty, const bt_field_class *fc)
 {
-	uint64_t i;
-	int64_t value = bt_field_integer_signed_get_value(field);
-	const bt_field_class *fc = bt_field_borrow_class_const(field);
+	struct enum_bit_flag_table *table;
 
-	/*
-	 * Negative value, not a bit flag enum
-	 * For 0, if there was a value, we would know by now.
-	 */
-	if (value <= 0) {
-		print_enum_value_label_unknown(pretty);
+	table = g_hash_table_lookup(pretty->enum_bit_flag_tables, fc);
+	if (table) {
 		goto end;
 	}
 
-	for (i = 0; i < ENUMERATION_MAX_BITFLAGS_COUNT; i++) {
-		uint64_t bit_value = 1ULL << i;
-
-		if ((value & bit_value) != 0) {
-			print_enum_signed_get_mapping_labels_for_value(
-				fc, bit_value, pretty->enum_bit_labels[i]);
-
-			if (pretty->enum_bit_labels[i]->len == 0) {
-				/*
-				 * This bit has no matching label, so this
-				 * field is not a bit flag field, print
-				 * unknown and return.
-				 */
-				print_enum_value_label_unknown(pretty);
-				goto end;
-			}
-		}
+	table = create_enum_bit_flag_table(fc);
+	if (!table) {
+		goto end;
 	}
 
-	print_enum_value_bit_flag_label_arrays(pretty);
+	bt_field_class_get_ref(fc);
+	g_hash_table_insert(pretty->enum_bit_flag_tables, (gpointer) fc, table);
 
 end:
-	return;
+	return table;
 }
 
 /*
  * Main function to try to print the value of the enum field as a
- * bit flag. It calls the appropriate function depending on the
- * field type's signedness and prints the label for each bit set,
- * if it's a bit flag field.
+ * bit flag.
+ *
+ * Splits the enum value into its bits and, for each bit set, finds the
+ * corresponding labels.
+ *
+ * If any bit set does not have a corresponding label, or if the value
+ * is negative, then it prints an unknown value, otherwise, it prints
+ * the labels, separated by '|'.
  */
 static
-void print_enum_try_bit_flags(struct pretty_component *pretty,
+int print_enum_try_bit_flags(struct pretty_component *pretty,
 		const bt_field *field)
 {
+	int ret = 0;
 	const bt_field_class *fc = bt_field_borrow_class_const(field);
 	uint64_t int_range = bt_field_class_integer_get_field_value_range(fc);
-	int i;
+	const struct enum_bit_flag_table *table;
+	uint64_t value;
+	uint64_t i;
 
 	BT_ASSERT(int_range <= ENUMERATION_MAX_BITFLAGS_COUNT);
 
-	/*
-	 * Remove all labels from the previous enumeration field.
-	 */
-	for (i = 0; i < ENUMERATION_MAX_BITFLAGS_COUNT; i++) {
-		g_ptr_array_set_size(pretty->enum_bit_labels[i], 0);
-	}
-
-	/* Get the mapping labels for the bit value. */
 	switch (bt_field_class_get_type(fc)) {
 	case BT_FIELD_CLASS_TYPE_UNSIGNED_ENUMERATION:
-		print_enum_unsigned_try_bit_flags(pretty, field);
+		value = bt_field_integer_unsigned_get_value(field);
 		break;
 	case BT_FIELD_CLASS_TYPE_SIGNED_ENUMERATION:
-		print_enum_signed_try_bit_flags(pretty, field);
+	{
+		int64_t signed_value = bt_field_integer_signed_get_value(field);
+
+		/* Negative value, not a bit flag enum */
+		if (signed_value < 0) {
+			print_enum_value_label_unknown(pretty);
+			goto end;
+		}
+
+		value = (uint64_t) signed_value;
 		break;
+	}
 	default:
 		bt_common_abort();
 	}
+
+	/* Value is 0, if there was a label for it, we would know by now. */
+	if (value == 0) {
+		print_enum_value_label_unknown(pretty);
+		goto end;
+	}
+
+	table = borrow_enum_bit_flag_table(pretty, fc);
+	if (!table) {
+		ret = -1;
+		goto end;
+	}
+
+	for (i = 0; i < ENUMERATION_MAX_BITFLAGS_COUNT; i++) {
+		if ((value & (UINT64_C(1) << i)) != 0 &&
+				table->bit_labels[i]->len == 0) {
+			/*
+			 * This bit has no matching label, so this
+			 * field is not a bit flag field, print
+			 * unknown and return.
+			 */
+			print_enum_value_label_unknown(pretty);
+			goto end;
+		}
+	}
+
+	print_enum_value_bit_flag_label_arrays(pretty, table, value);
+
+end:
+	return ret;
 }
 
 static
@@ -996,7 +1024,10 @@ int print_enum(struct pretty_component *pretty,
 		 * decompose the value of the enum into bits and print it as a
 		 * bit flag enum.
 		 */
-		print_enum_try_bit_flags(pretty, field);
+		ret = print_enum_try_bit_flags(pretty, field);
+		if (ret) {
+			goto end;
+		}
 	} else {
 		print_enum_value_label_unknown(pretty);
 	}
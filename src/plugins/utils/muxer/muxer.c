@@ -20,6 +20,7 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "lib/prio-heap/prio-heap.h"
 #include "plugins/common/muxing/muxing.h"
 #include "plugins/common/param-validation/param-validation.h"
 
@@ -44,6 +45,16 @@ struct muxer_upstream_msg_iter {
 
 	/* Contains `const bt_message *`, owned by this */
 	GQueue *msgs;
+
+	/*
+	 * True if the time of the current message (head of `msgs`) is
+	 * known, in which case `cur_msg_ts_ns` is this time.
+	 *
+	 * Only valid while this upstream message iterator wrapper is
+	 * within one of the heaps of its muxer message iterator.
+	 */
+	bool cur_msg_has_ts;
+	int64_t cur_msg_ts_ns;
 };
 
 enum muxer_msg_iter_clock_class_expectation {
@@ -60,15 +71,39 @@ struct muxer_msg_iter {
 	/* Weak */
 	bt_self_message_iterator *self_msg_iter;
 
+	/* Array of struct muxer_upstream_msg_iter * (owned by this) */
+	GPtrArray *active_muxer_upstream_msg_iters;
+
 	/*
-	 * Array of struct muxer_upstream_msg_iter * (owned by this).
+	 * Array of struct muxer_upstream_msg_iter * (weak).
 	 *
-	 * NOTE: This array is searched in linearly to find the youngest
-	 * current message. Keep this until benchmarks confirm that
-	 * another data structure is faster than this for our typical
-	 * use cases.
+	 * Active upstream message iterator wrappers which are in none
+	 * of the heaps below because we need to get their next
+	 * messages and/or to compute the time of their current
+	 * message.
 	 */
-	GPtrArray *active_muxer_upstream_msg_iters;
+	GPtrArray *pending_muxer_upstream_msg_iters;
+
+	/*
+	 * Heap of struct muxer_upstream_msg_iter * (weak) of which the
+	 * current message has a known time, the youngest one being the
+	 * maximum.
+	 *
+	 * Two wrappers having the same time are ordered with
+	 * common_muxing_compare_messages().
+	 */
+	struct ptr_heap ts_heap;
+
+	/*
+	 * Heap of struct muxer_upstream_msg_iter * (weak) of which the
+	 * current message has no known time, ordered with
+	 * common_muxing_compare_messages().
+	 *
+	 * The time of such a message is the last returned time
+	 * (`last_returned_ts_ns`) at any moment, which is the same for
+	 * all the wrappers of this heap.
+	 */
+	struct ptr_heap no_ts_heap;
 
 	/*
 	 * Array of struct muxer_upstream_msg_iter * (owned by this).
@@ -165,6 +200,8 @@ int muxer_msg_iter_add_upstream_msg_iter(struct muxer_msg_iter *muxer_msg_iter,
 
 	g_ptr_array_add(muxer_msg_iter->active_muxer_upstream_msg_iters,
 		muxer_upstream_msg_iter);
+	g_ptr_array_add(muxer_msg_iter->pending_muxer_upstream_msg_iters,
+		muxer_upstream_msg_iter);
 	BT_COMP_LOGD("Added muxer's upstream message iterator wrapper: "
 		"addr=%p, muxer-msg-iter-addr=%p, msg-iter-addr=%p",
 		muxer_upstream_msg_iter, muxer_msg_iter,
@@ -460,11 +497,16 @@ bt_message_iterator_class_next_method_status muxer_upstream_msg_iter_next(
 	return status;
 }
 
+/*
+ * Sets `*ts_ns` to the time of `msg` and `*has_ts` to true, or sets
+ * `*has_ts` to false if `msg` has no time, in which case its time is
+ * the last returned time, whatever it is when the muxer message
+ * iterator considers `msg`.
+ */
 static
 int get_msg_ts_ns(struct muxer_comp *muxer_comp,
 		struct muxer_msg_iter *muxer_msg_iter,
-		const bt_message *msg, int64_t last_returned_ts_ns,
-		int64_t *ts_ns)
+		const bt_message *msg, int64_t *ts_ns, bool *has_ts)
 {
 	const bt_clock_snapshot *clock_snapshot = NULL;
 	int ret = 0;
@@ -473,14 +515,14 @@ int get_msg_ts_ns(struct muxer_comp *muxer_comp,
 
 	BT_ASSERT_DBG(msg);
 	BT_ASSERT_DBG(ts_ns);
+	BT_ASSERT_DBG(has_ts);
 	BT_COMP_LOGD("Getting message's timestamp: "
-		"muxer-msg-iter-addr=%p, msg-addr=%p, "
-		"last-returned-ts=%" PRId64,
-		muxer_msg_iter, msg, last_returned_ts_ns);
+		"muxer-msg-iter-addr=%p, msg-addr=%p",
+		muxer_msg_iter, msg);
+	*has_ts = false;
 
 	if (G_UNLIKELY(muxer_msg_iter->clock_class_expectation ==
 			MUXER_MSG_ITER_CLOCK_CLASS_EXPECTATION_NONE)) {
-		*ts_ns = last_returned_ts_ns;
 		goto end;
 	}
 
@@ -580,7 +622,6 @@ int get_msg_ts_ns(struct muxer_comp *muxer_comp,
 	default:
 		/* All the other messages have a higher priority */
 		BT_COMP_LOGD_STR("Message has no timestamp: using the last returned timestamp.");
-		*ts_ns = last_returned_ts_ns;
 		goto end;
 	}
 
@@ -592,24 +633,22 @@ int get_msg_ts_ns(struct muxer_comp *muxer_comp,
 		goto error;
 	}
 
+	*has_ts = true;
 	goto end;
 
 no_clock_snapshot:
 	BT_COMP_LOGD_STR("Message's default clock snapshot is missing: "
 		"using the last returned timestamp.");
-	*ts_ns = last_returned_ts_ns;
 	goto end;
 
 error:
 	ret = -1;
 
 end:
-	if (ret == 0) {
+	if (ret == 0 && *has_ts) {
 		BT_COMP_LOGD("Found message's timestamp: "
-			"muxer-msg-iter-addr=%p, msg-addr=%p, "
-			"last-returned-ts=%" PRId64 ", ts=%" PRId64,
-			muxer_msg_iter, msg, last_returned_ts_ns,
-			*ts_ns);
+			"muxer-msg-iter-addr=%p, msg-addr=%p, ts=%" PRId64,
+			muxer_msg_iter, msg, *ts_ns);
 	}
 
 	return ret;
@@ -781,6 +820,141 @@ end:
 	return ret;
 }
 
+/*
+ * Orders the current messages of two upstream message iterator
+ * wrappers which have the same time in an arbitrary but deterministic
+ * way.
+ *
+ * Returns a negative value if the current message of
+ * `muxer_upstream_msg_iter_a` goes first, a positive value if the
+ * current message of `muxer_upstream_msg_iter_b` goes first, or 0 if
+ * we cannot pick one.
+ */
+static
+int compare_muxer_upstream_msg_iters_cur_msgs(
+		struct muxer_upstream_msg_iter *muxer_upstream_msg_iter_a,
+		struct muxer_upstream_msg_iter *muxer_upstream_msg_iter_b)
+{
+	struct muxer_comp *muxer_comp = muxer_upstream_msg_iter_a->muxer_comp;
+	int ret;
+
+	ret = common_muxing_compare_messages(
+		g_queue_peek_head(muxer_upstream_msg_iter_a->msgs),
+		g_queue_peek_head(muxer_upstream_msg_iter_b->msgs));
+	if (ret == 0) {
+		/* Unable to pick which one should go first. */
+		BT_COMP_LOGW("Cannot deterministically pick next upstream message iterator because they have identical next messages: "
+			"muxer-upstream-msg-iter-wrap-a-addr=%p, "
+			"muxer-upstream-msg-iter-wrap-b-addr=%p",
+			muxer_upstream_msg_iter_a, muxer_upstream_msg_iter_b);
+	}
+
+	return ret;
+}
+
+/*
+ * Comparison function of the heaps of a muxer message iterator:
+ * returns whether or not the current message of `a` goes before the
+ * current message of `b`.
+ */
+static
+int muxer_upstream_msg_iter_gt(void *a, void *b)
+{
+	struct muxer_upstream_msg_iter *muxer_upstream_msg_iter_a = a;
+	struct muxer_upstream_msg_iter *muxer_upstream_msg_iter_b = b;
+
+	/* Both wrappers are within the same heap */
+	BT_ASSERT_DBG(muxer_upstream_msg_iter_a->cur_msg_has_ts ==
+		muxer_upstream_msg_iter_b->cur_msg_has_ts);
+
+	if (muxer_upstream_msg_iter_a->cur_msg_has_ts &&
+			muxer_upstream_msg_iter_a->cur_msg_ts_ns !=
+			muxer_upstream_msg_iter_b->cur_msg_ts_ns) {
+		return muxer_upstream_msg_iter_a->cur_msg_ts_ns <
+			muxer_upstream_msg_iter_b->cur_msg_ts_ns;
+	}
+
+	return compare_muxer_upstream_msg_iters_cur_msgs(
+		muxer_upstream_msg_iter_a, muxer_upstream_msg_iter_b) < 0;
+}
+
+/*
+ * Validates the current message of `muxer_upstream_msg_iter`, computes
+ * its time, and inserts `muxer_upstream_msg_iter` into the
+ * appropriate heap of `muxer_msg_iter`.
+ */
+static
+bt_message_iterator_class_next_method_status
+insert_muxer_upstream_msg_iter(struct muxer_msg_iter *muxer_msg_iter,
+		struct muxer_upstream_msg_iter *muxer_upstream_msg_iter)
+{
+	struct muxer_comp *muxer_comp = muxer_msg_iter->muxer_comp;
+	bt_message_iterator_class_next_method_status status;
+	const bt_message *msg;
+	struct ptr_heap *heap;
+	int ret;
+
+	BT_ASSERT_DBG(muxer_upstream_msg_iter->msgs->length > 0);
+	msg = g_queue_peek_head(muxer_upstream_msg_iter->msgs);
+	BT_ASSERT_DBG(msg);
+
+	if (G_UNLIKELY(bt_message_get_type(msg) ==
+			BT_MESSAGE_TYPE_STREAM_BEGINNING)) {
+		ret = validate_new_stream_clock_class(
+			muxer_msg_iter, muxer_comp,
+			bt_message_stream_beginning_borrow_stream_const(
+				msg));
+		if (ret) {
+			/*
+			 * validate_new_stream_clock_class() logs
+			 * errors.
+			 */
+			status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_ERROR;
+			goto end;
+		}
+	} else if (G_UNLIKELY(bt_message_get_type(msg) ==
+			BT_MESSAGE_TYPE_MESSAGE_ITERATOR_INACTIVITY)) {
+		const bt_clock_snapshot *cs;
+
+		cs = bt_message_message_iterator_inactivity_borrow_clock_snapshot_const(
+			msg);
+		ret = validate_clock_class(muxer_msg_iter, muxer_comp,
+			bt_clock_snapshot_borrow_clock_class_const(cs));
+		if (ret) {
+			/* validate_clock_class() logs errors */
+			status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_ERROR;
+			goto end;
+		}
+	}
+
+	ret = get_msg_ts_ns(muxer_comp, muxer_msg_iter, msg,
+		&muxer_upstream_msg_iter->cur_msg_ts_ns,
+		&muxer_upstream_msg_iter->cur_msg_has_ts);
+	if (ret) {
+		/* get_msg_ts_ns() logs errors */
+		status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_ERROR;
+		goto end;
+	}
+
+	heap = muxer_upstream_msg_iter->cur_msg_has_ts ?
+		&muxer_msg_iter->ts_heap : &muxer_msg_iter->no_ts_heap;
+	ret = bt_heap_insert(heap, muxer_upstream_msg_iter);
+	if (ret) {
+		BT_COMP_LOGE_APPEND_CAUSE(muxer_comp->self_comp,
+			"Failed to insert muxer's upstream message iterator wrapper into heap: "
+			"muxer-msg-iter-addr=%p, "
+			"muxer-upstream-msg-iter-wrap-addr=%p",
+			muxer_msg_iter, muxer_upstream_msg_iter);
+		status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_MEMORY_ERROR;
+		goto end;
+	}
+
+	status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK;
+
+end:
+	return status;
+}
+
 /*
  * This function finds the youngest available message amongst the
  * non-ended upstream message iterators and returns the upstream
@@ -788,10 +962,15 @@ end:
  * BT_MESSAGE_ITERATOR_STATUS_END if there's no available
  * message.
  *
+ * The youngest message is the current message of the maximum of one
+ * of the two heaps of `muxer_msg_iter`, so that this function only
+ * needs to compare those two candidates.
+ *
  * This function does NOT:
  *
  * * Update any upstream message iterator.
  * * Check the upstream message iterators to retry.
+ * * Remove the returned upstream message iterator from its heap.
  *
  * On sucess, this function sets *muxer_upstream_msg_iter to the
  * upstream message iterator of which the current message is
@@ -805,127 +984,53 @@ muxer_msg_iter_youngest_upstream_msg_iter(
 		struct muxer_upstream_msg_iter **muxer_upstream_msg_iter,
 		int64_t *ts_ns)
 {
-	size_t i;
-	int ret;
-	int64_t youngest_ts_ns = INT64_MAX;
+	struct muxer_upstream_msg_iter *ts_candidate;
+	struct muxer_upstream_msg_iter *no_ts_candidate;
 	bt_message_iterator_class_next_method_status status =
 		BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK;
 
 	BT_ASSERT_DBG(muxer_comp);
 	BT_ASSERT_DBG(muxer_msg_iter);
 	BT_ASSERT_DBG(muxer_upstream_msg_iter);
-	*muxer_upstream_msg_iter = NULL;
+	ts_candidate = bt_heap_maximum(&muxer_msg_iter->ts_heap);
+	no_ts_candidate = bt_heap_maximum(&muxer_msg_iter->no_ts_heap);
 
-	for (i = 0; i < muxer_msg_iter->active_muxer_upstream_msg_iters->len;
-			i++) {
-		const bt_message *msg;
-		struct muxer_upstream_msg_iter *cur_muxer_upstream_msg_iter =
-			g_ptr_array_index(
-				muxer_msg_iter->active_muxer_upstream_msg_iters,
-				i);
-		int64_t msg_ts_ns;
-
-		if (!cur_muxer_upstream_msg_iter->msg_iter) {
-			/* This upstream message iterator is ended */
-			BT_COMP_LOGT("Skipping ended upstream message iterator: "
-				"muxer-upstream-msg-iter-wrap-addr=%p",
-				cur_muxer_upstream_msg_iter);
-			continue;
-		}
-
-		BT_ASSERT_DBG(cur_muxer_upstream_msg_iter->msgs->length > 0);
-		msg = g_queue_peek_head(cur_muxer_upstream_msg_iter->msgs);
-		BT_ASSERT_DBG(msg);
-
-		if (G_UNLIKELY(bt_message_get_type(msg) ==
-				BT_MESSAGE_TYPE_STREAM_BEGINNING)) {
-			ret = validate_new_stream_clock_class(
-				muxer_msg_iter, muxer_comp,
-				bt_message_stream_beginning_borrow_stream_const(
-					msg));
-			if (ret) {
-				/*
-				 * validate_new_stream_clock_class() logs
-				 * errors.
-				 */
-				status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_ERROR;
-				goto end;
-			}
-		} else if (G_UNLIKELY(bt_message_get_type(msg) ==
-				BT_MESSAGE_TYPE_MESSAGE_ITERATOR_INACTIVITY)) {
-			const bt_clock_snapshot *cs;
-
-			cs = bt_message_message_iterator_inactivity_borrow_clock_snapshot_const(
-				msg);
-			ret = validate_clock_class(muxer_msg_iter, muxer_comp,
-				bt_clock_snapshot_borrow_clock_class_const(cs));
-			if (ret) {
-				/* validate_clock_class() logs errors */
-				status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_ERROR;
-				goto end;
-			}
-		}
-
-		ret = get_msg_ts_ns(muxer_comp, muxer_msg_iter, msg,
-			muxer_msg_iter->last_returned_ts_ns, &msg_ts_ns);
-		if (ret) {
-			/* get_msg_ts_ns() logs errors */
-			*muxer_upstream_msg_iter = NULL;
-			status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_ERROR;
-			goto end;
-		}
+	if (!ts_candidate && !no_ts_candidate) {
+		*muxer_upstream_msg_iter = NULL;
+		status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_END;
+		*ts_ns = INT64_MIN;
+		goto end;
+	}
 
+	if (!ts_candidate) {
+		*muxer_upstream_msg_iter = no_ts_candidate;
+	} else if (!no_ts_candidate) {
+		*muxer_upstream_msg_iter = ts_candidate;
+	} else if (ts_candidate->cur_msg_ts_ns !=
+			muxer_msg_iter->last_returned_ts_ns) {
 		/*
-		 * Update the current message iterator if it has not been set
-		 * yet, or if its current message has a timestamp smaller than
-		 * the previously selected youngest message.
+		 * The time of the current message of `no_ts_candidate`
+		 * is the last returned time.
 		 */
-		if (G_UNLIKELY(*muxer_upstream_msg_iter == NULL) ||
-				msg_ts_ns < youngest_ts_ns) {
-			*muxer_upstream_msg_iter =
-				cur_muxer_upstream_msg_iter;
-			youngest_ts_ns = msg_ts_ns;
-			*ts_ns = youngest_ts_ns;
-		} else if (msg_ts_ns == youngest_ts_ns) {
-			/*
-			 * The currently selected message to be sent downstream
-			 * next has the exact same timestamp that of the
-			 * current candidate message. We must break the tie
-			 * in a predictable manner.
-			 */
-			const bt_message *selected_msg = g_queue_peek_head(
-				(*muxer_upstream_msg_iter)->msgs);
-			BT_COMP_LOGD_STR("Two of the next message candidates have the same timestamps, pick one deterministically.");
-
-			/*
-			 * Order the messages in an arbitrary but determinitic
-			 * way.
-			 */
-			ret = common_muxing_compare_messages(msg, selected_msg);
-			if (ret < 0) {
-				/*
-				 * The `msg` should go first. Update the next
-				 * iterator and the current timestamp.
-				 */
-				*muxer_upstream_msg_iter =
-					cur_muxer_upstream_msg_iter;
-				youngest_ts_ns = msg_ts_ns;
-				*ts_ns = youngest_ts_ns;
-			} else if (ret == 0) {
-				/* Unable to pick which one should go first. */
-				BT_COMP_LOGW("Cannot deterministically pick next upstream message iterator because they have identical next messages: "
-					"muxer-upstream-msg-iter-wrap-addr=%p"
-					"cur-muxer-upstream-msg-iter-wrap-addr=%p",
-					*muxer_upstream_msg_iter,
-					cur_muxer_upstream_msg_iter);
-			}
-		}
+		*muxer_upstream_msg_iter =
+			ts_candidate->cur_msg_ts_ns <
+				muxer_msg_iter->last_returned_ts_ns ?
+			ts_candidate : no_ts_candidate;
+	} else {
+		/*
+		 * Both candidate messages have the same time. We must
+		 * break the tie in a predictable manner.
+		 */
+		BT_COMP_LOGD_STR("Two of the next message candidates have the same timestamps, pick one deterministically.");
+		*muxer_upstream_msg_iter =
+			compare_muxer_upstream_msg_iters_cur_msgs(
+				ts_candidate, no_ts_candidate) < 0 ?
+			ts_candidate : no_ts_candidate;
 	}
 
-	if (!*muxer_upstream_msg_iter) {
-		status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_END;
-		*ts_ns = INT64_MIN;
-	}
+	*ts_ns = (*muxer_upstream_msg_iter)->cur_msg_has_ts ?
+		(*muxer_upstream_msg_iter)->cur_msg_ts_ns :
+		muxer_msg_iter->last_returned_ts_ns;
 
 end:
 	return status;
@@ -968,19 +1073,23 @@ validate_muxer_upstream_msg_iters(
 		struct muxer_msg_iter *muxer_msg_iter)
 {
 	struct muxer_comp *muxer_comp = muxer_msg_iter->muxer_comp;
+	GPtrArray *pending_msg_iters =
+		muxer_msg_iter->pending_muxer_upstream_msg_iters;
 	bt_message_iterator_class_next_method_status status;
-	size_t i;
 
 	BT_COMP_LOGD("Validating muxer's upstream message iterator wrappers: "
 		"muxer-msg-iter-addr=%p", muxer_msg_iter);
 
-	for (i = 0; i < muxer_msg_iter->active_muxer_upstream_msg_iters->len;
-			i++) {
+	/*
+	 * Only the pending upstream message iterators need to be
+	 * validated: the others are within a heap, with a current
+	 * message.
+	 */
+	while (pending_msg_iters->len > 0) {
 		bool is_ended = false;
 		struct muxer_upstream_msg_iter *muxer_upstream_msg_iter =
-			g_ptr_array_index(
-				muxer_msg_iter->active_muxer_upstream_msg_iters,
-				i);
+			g_ptr_array_index(pending_msg_iters,
+				pending_msg_iters->len - 1);
 
 		status = validate_muxer_upstream_msg_iter(
 			muxer_upstream_msg_iter, &is_ended);
@@ -1008,24 +1117,47 @@ validate_muxer_upstream_msg_iters(
 		 * array of ended iterators if it's ended.
 		 */
 		if (G_UNLIKELY(is_ended)) {
+			GPtrArray *active_msg_iters =
+				muxer_msg_iter->active_muxer_upstream_msg_iters;
+			guint i;
+
 			BT_COMP_LOGD("Muxer's upstream message iterator wrapper: ended or canceled: "
 				"muxer-msg-iter-addr=%p, "
 				"muxer-upstream-msg-iter-wrap-addr=%p",
 				muxer_msg_iter, muxer_upstream_msg_iter);
+
+			for (i = 0; i < active_msg_iters->len; i++) {
+				if (active_msg_iters->pdata[i] ==
+						muxer_upstream_msg_iter) {
+					break;
+				}
+			}
+
+			BT_ASSERT_DBG(i < active_msg_iters->len);
 			g_ptr_array_add(
 				muxer_msg_iter->ended_muxer_upstream_msg_iters,
 				muxer_upstream_msg_iter);
-			muxer_msg_iter->active_muxer_upstream_msg_iters->pdata[i] = NULL;
+			active_msg_iters->pdata[i] = NULL;
 
 			/*
 			 * Use g_ptr_array_remove_fast() because the
 			 * order of those elements is not important.
 			 */
-			g_ptr_array_remove_index_fast(
-				muxer_msg_iter->active_muxer_upstream_msg_iters,
-				i);
-			i--;
+			g_ptr_array_remove_index_fast(active_msg_iters, i);
+		} else {
+			status = insert_muxer_upstream_msg_iter(muxer_msg_iter,
+				muxer_upstream_msg_iter);
+			if (status != BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK) {
+				/*
+				 * insert_muxer_upstream_msg_iter() logs
+				 * errors.
+				 */
+				goto end;
+			}
 		}
+
+		g_ptr_array_remove_index_fast(pending_msg_iters,
+			pending_msg_iters->len - 1);
 	}
 
 	status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK;
@@ -1042,6 +1174,8 @@ bt_message_iterator_class_next_method_status muxer_msg_iter_do_next_one(
 {
 	bt_message_iterator_class_next_method_status status;
 	struct muxer_upstream_msg_iter *muxer_upstream_msg_iter = NULL;
+	struct muxer_upstream_msg_iter *removed_muxer_upstream_msg_iter;
+	struct ptr_heap *heap;
 	/* Initialize to avoid -Wmaybe-uninitialized warning with gcc 4.8. */
 	int64_t next_return_ts = 0;
 
@@ -1053,8 +1187,8 @@ bt_message_iterator_class_next_method_status muxer_msg_iter_do_next_one(
 
 	/*
 	 * At this point we know that all the existing upstream
-	 * message iterators are valid. We can find the one,
-	 * amongst those, of which the current message is the
+	 * message iterators are valid and within a heap. We can find
+	 * the one, amongst those, of which the current message is the
 	 * youngest.
 	 */
 	status = muxer_msg_iter_youngest_upstream_msg_iter(muxer_comp,
@@ -1094,6 +1228,11 @@ bt_message_iterator_class_next_method_status muxer_msg_iter_do_next_one(
 	BT_ASSERT_DBG(status ==
 		BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK);
 	BT_ASSERT_DBG(muxer_upstream_msg_iter);
+	heap = muxer_upstream_msg_iter->cur_msg_has_ts ?
+		&muxer_msg_iter->ts_heap : &muxer_msg_iter->no_ts_heap;
+	removed_muxer_upstream_msg_iter = bt_heap_remove(heap);
+	BT_ASSERT_DBG(removed_muxer_upstream_msg_iter ==
+		muxer_upstream_msg_iter);
 
 	/*
 	 * Consume from the queue's head: other side
@@ -1103,6 +1242,13 @@ bt_message_iterator_class_next_method_status muxer_msg_iter_do_next_one(
 	BT_ASSERT_DBG(*msg);
 	muxer_msg_iter->last_returned_ts_ns = next_return_ts;
 
+	/*
+	 * The current message of this upstream message iterator
+	 * changed: validate it again on the next call.
+	 */
+	g_ptr_array_add(muxer_msg_iter->pending_muxer_upstream_msg_iters,
+		muxer_upstream_msg_iter);
+
 end:
 	return status;
 }
@@ -1194,6 +1340,13 @@ void destroy_muxer_msg_iter(struct muxer_msg_iter *muxer_msg_iter)
 			muxer_msg_iter->ended_muxer_upstream_msg_iters, TRUE);
 	}
 
+	if (muxer_msg_iter->pending_muxer_upstream_msg_iters) {
+		g_ptr_array_free(
+			muxer_msg_iter->pending_muxer_upstream_msg_iters, TRUE);
+	}
+
+	bt_heap_free(&muxer_msg_iter->ts_heap);
+	bt_heap_free(&muxer_msg_iter->no_ts_heap);
 	g_free(muxer_msg_iter);
 }
 
@@ -1338,6 +1491,22 @@ bt_message_iterator_class_initialize_method_status muxer_msg_iter_init(
 		goto error;
 	}
 
+	muxer_msg_iter->pending_muxer_upstream_msg_iters = g_ptr_array_new();
+	if (!muxer_msg_iter->pending_muxer_upstream_msg_iters) {
+		BT_COMP_LOGE_APPEND_CAUSE(muxer_comp->self_comp, "Failed to allocate a GPtrArray.");
+		status = BT_MESSAGE_ITERATOR_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
+		goto error;
+	}
+
+	if (bt_heap_init(&muxer_msg_iter->ts_heap, 0,
+			muxer_upstream_msg_iter_gt) ||
+			bt_heap_init(&muxer_msg_iter->no_ts_heap, 0,
+				muxer_upstream_msg_iter_gt)) {
+		BT_COMP_LOGE_APPEND_CAUSE(muxer_comp->self_comp, "Failed to allocate a heap.");
+		status = BT_MESSAGE_ITERATOR_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
+		goto error;
+	}
+
 	status = muxer_msg_iter_init_upstream_iterators(muxer_comp,
 		muxer_msg_iter, config);
 	if (status) {
@@ -1533,6 +1702,16 @@ bt_message_iterator_class_seek_beginning_method_status muxer_msg_iter_seek_begin
 	bt_message_iterator_seek_beginning_status seek_beg_status;
 	uint64_t i;
 
+	/*
+	 * The current messages of the upstream message iterators
+	 * are about to be discarded: empty the heaps (they don't own
+	 * their elements).
+	 */
+	bt_heap_clear(&muxer_msg_iter->ts_heap);
+	bt_heap_clear(&muxer_msg_iter->no_ts_heap);
+	g_ptr_array_set_size(muxer_msg_iter->pending_muxer_upstream_msg_iters,
+		0);
+
 	/* Seek all ended upstream iterators first */
 	for (i = 0; i < muxer_msg_iter->ended_muxer_upstream_msg_iters->len;
 			i++) {
@@ -1584,6 +1763,14 @@ bt_message_iterator_class_seek_beginning_method_status muxer_msg_iter_seek_begin
 		g_ptr_array_remove_range(muxer_msg_iter->ended_muxer_upstream_msg_iters,
 			0, muxer_msg_iter->ended_muxer_upstream_msg_iters->len);
 	}
+
+	/* They all need to be validated again */
+	for (i = 0; i < muxer_msg_iter->active_muxer_upstream_msg_iters->len;
+			i++) {
+		g_ptr_array_add(muxer_msg_iter->pending_muxer_upstream_msg_iters,
+			muxer_msg_iter->active_muxer_upstream_msg_iters->pdata[i]);
+	}
+
 	muxer_msg_iter->last_returned_ts_ns = INT64_MIN;
 	muxer_msg_iter->clock_class_expectation =
 		MUXER_MSG_ITER_CLOCK_CLASS_EXPECTATION_ANY;
@@ -0,0 +1,65 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (C) 2023 EfficiOS Inc.
+ *
+ * Allocation counter to preload (`LD_PRELOAD`) in a benchmarked
+ * process.
+ *
+ * Counts the calls to malloc(), calloc(), and realloc() and, when the
+ * process exits, appends this count, followed with a newline, to the
+ * file named by the `BT_BENCH_ALLOC_COUNT_FILE` environment variable.
+ *
+ * This relies on the glibc `__libc_*()` allocation functions. Also set
+ * `G_SLICE=always-malloc` so that glib's slice allocator doesn't hide
+ * allocations.
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t nmemb, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+
+static unsigned long long alloc_count;
+
+void *malloc(size_t size)
+{
+	__atomic_add_fetch(&alloc_count, 1, __ATOMIC_RELAXED);
+	return __libc_malloc(size);
+}
+
+void *calloc(size_t nmemb, size_t size)
+{
+	__atomic_add_fetch(&alloc_count, 1, __ATOMIC_RELAXED);
+	return __libc_calloc(nmemb, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+	__atomic_add_fetch(&alloc_count, 1, __ATOMIC_RELAXED);
+	return __libc_realloc(ptr, size);
+}
+
+static __attribute__((destructor))
+void write_alloc_count(void)
+{
+	const char *path = getenv("BT_BENCH_ALLOC_COUNT_FILE");
+	unsigned long long count =
+		__atomic_load_n(&alloc_count, __ATOMIC_RELAXED);
+	FILE *fp;
+
+	if (!path || !*path) {
+		return;
+	}
+
+	fp = fopen(path, "a");
+	if (!fp) {
+		return;
+	}
+
+	fprintf(fp, "%llu\n", count);
+	fclose(fp);
+}
@@ -0,0 +1,172 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (C) 2023 EfficiOS Inc.
+ *
+ * Runs a command once and prints one JSON object describing how it
+ * performed:
+ *
+ *     bench-run NAME EVENT-COUNT BYTE-COUNT COMMAND [ARG]...
+ *
+ * NAME is the name of the benchmark, EVENT-COUNT and BYTE-COUNT are the
+ * number of events and bytes which COMMAND processes.
+ *
+ * The printed object contains the wall clock time, the user and system
+ * CPU times, the events and bytes per second, the peak resident set
+ * size, and, if the `BT_BENCH_ALLOC_COUNT_FILE` environment variable
+ * names a file to which the allocation counter library (see
+ * `alloc-counter.c`) writes, the number of allocations per event.
+ *
+ * The standard output of COMMAND goes to `/dev/null`; its standard
+ * error is left as is.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+static
+double timespec_diff_s(const struct timespec *begin,
+		const struct timespec *end)
+{
+	return (double) (end->tv_sec - begin->tv_sec) +
+		(double) (end->tv_nsec - begin->tv_nsec) / 1e9;
+}
+
+static
+double timeval_s(const struct timeval *tv)
+{
+	return (double) tv->tv_sec + (double) tv->tv_usec / 1e6;
+}
+
+/*
+ * Reads the allocation count which the allocation counter library
+ * wrote to `path`, removing the file.
+ *
+ * Returns -1 if there's no such count.
+ */
+static
+int64_t read_alloc_count(const char *path)
+{
+	FILE *fp;
+	uint64_t count;
+	int64_t ret = -1;
+
+	if (!path || !*path) {
+		goto end;
+	}
+
+	fp = fopen(path, "r");
+	if (!fp) {
+		goto end;
+	}
+
+	/*
+	 * The command can be made of more than one process: keep the
+	 * largest count, which is the one of the babeltrace2 process.
+	 */
+	while (fscanf(fp, "%" SCNu64, &count) == 1) {
+		if ((int64_t) count > ret) {
+			ret = (int64_t) count;
+		}
+	}
+
+	fclose(fp);
+	unlink(path);
+
+end:
+	return ret;
+}
+
+int main(int argc, char **argv)
+{
+	const char *name;
+	uint64_t event_count;
+	uint64_t byte_count;
+	struct timespec begin, end;
+	struct rusage usage;
+	double wall_s;
+	int64_t alloc_count;
+	int status;
+	pid_t pid;
+
+	if (argc < 5) {
+		fprintf(stderr, "Usage: %s NAME EVENT-COUNT BYTE-COUNT COMMAND [ARG]...\n",
+			argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	name = argv[1];
+	event_count = strtoull(argv[2], NULL, 10);
+	byte_count = strtoull(argv[3], NULL, 10);
+
+	/* Start from a clean allocation count */
+	(void) read_alloc_count(getenv("BT_BENCH_ALLOC_COUNT_FILE"));
+
+	clock_gettime(CLOCK_MONOTONIC, &begin);
+	pid = fork();
+	if (pid < 0) {
+		perror("fork");
+		return EXIT_FAILURE;
+	}
+
+	if (pid == 0) {
+		int fd = open("/dev/null", O_WRONLY);
+
+		if (fd >= 0) {
+			dup2(fd, STDOUT_FILENO);
+			close(fd);
+		}
+
+		execvp(argv[4], &argv[4]);
+		fprintf(stderr, "Cannot execute `%s`: %s\n", argv[4],
+			strerror(errno));
+		_exit(127);
+	}
+
+	if (wait4(pid, &status, 0, &usage) < 0) {
+		perror("wait4");
+		return EXIT_FAILURE;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+		fprintf(stderr, "Benchmark `%s` failed: status=%d\n", name,
+			status);
+		return EXIT_FAILURE;
+	}
+
+	wall_s = timespec_diff_s(&begin, &end);
+	alloc_count = read_alloc_count(getenv("BT_BENCH_ALLOC_COUNT_FILE"));
+	printf("{\"name\": \"%s\", \"events\": %" PRIu64 ", \"bytes\": %" PRIu64
+		", \"wall_s\": %.6f, \"user_s\": %.6f, \"sys_s\": %.6f"
+		", \"events_per_s\": %.1f, \"bytes_per_s\": %.1f"
+		", \"peak_rss_kib\": %ld",
+		name, event_count, byte_count, wall_s,
+		timeval_s(&usage.ru_utime), timeval_s(&usage.ru_stime),
+		wall_s > 0 ? (double) event_count / wall_s : 0,
+		wall_s > 0 ? (double) byte_count / wall_s : 0,
+		usage.ru_maxrss);
+
+	if (alloc_count >= 0) {
+		printf(", \"allocs\": %" PRId64 ", \"allocs_per_event\": %.3f",
+			alloc_count, event_count > 0 ?
+				(double) alloc_count / (double) event_count : 0);
+	} else {
+		printf(", \"allocs\": null, \"allocs_per_event\": null");
+	}
+
+	printf("}\n");
+	return EXIT_SUCCESS;
+}
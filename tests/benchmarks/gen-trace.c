@@ -0,0 +1,490 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (C) 2023 EfficiOS Inc.
+ *
+ * Synthetic CTF trace generator for the benchmarks.
+ *
+ * Writes a CTF trace of which the shape is configurable: number of data
+ * streams, number of event classes, number of events per data stream,
+ * payload complexity, and number of events per packet.
+ *
+ * The events of all the data streams are interleaved in time so that
+ * the muxer has work to do.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+#include <babeltrace2-ctf-writer/writer.h>
+#include <babeltrace2-ctf-writer/clock.h>
+#include <babeltrace2-ctf-writer/clock-class.h>
+#include <babeltrace2-ctf-writer/stream.h>
+#include <babeltrace2-ctf-writer/event.h>
+#include <babeltrace2-ctf-writer/event-types.h>
+#include <babeltrace2-ctf-writer/event-fields.h>
+#include <babeltrace2-ctf-writer/stream-class.h>
+#include <babeltrace2-ctf-writer/trace.h>
+
+#include "common/assert.h"
+
+#define SEQ_MAX_LENGTH	16
+#define ARRAY_LENGTH	8
+
+enum payload_kind {
+	/* Single 32-bit unsigned integer */
+	PAYLOAD_KIND_SIMPLE,
+
+	/* A few integers and a string */
+	PAYLOAD_KIND_MEDIUM,
+
+	/*
+	 * Integers, string, enumeration, real, static array, dynamic
+	 * array, and nested structure.
+	 */
+	PAYLOAD_KIND_COMPLEX,
+};
+
+struct config {
+	/* Options */
+	gint stream_count;
+	gint event_class_count;
+	gint64 events_per_stream;
+	gint events_per_packet;
+	enum payload_kind payload_kind;
+	const char *path;
+
+	/* CTF writer objects */
+	struct bt_ctf_writer *writer;
+	struct bt_ctf_trace *trace;
+	struct bt_ctf_clock *clock;
+	struct bt_ctf_stream_class *sc;
+
+	/* Arrays of `struct bt_ctf_stream *` and `struct bt_ctf_event_class *` */
+	GPtrArray *streams;
+	GPtrArray *ecs;
+};
+
+static
+void fini_config(struct config *cfg)
+{
+	if (cfg->streams) {
+		g_ptr_array_free(cfg->streams, TRUE);
+	}
+
+	if (cfg->ecs) {
+		g_ptr_array_free(cfg->ecs, TRUE);
+	}
+
+	bt_ctf_object_put_ref(cfg->sc);
+	bt_ctf_object_put_ref(cfg->clock);
+	bt_ctf_object_put_ref(cfg->trace);
+	bt_ctf_object_put_ref(cfg->writer);
+}
+
+static
+void put_ref_notifier(gpointer obj)
+{
+	bt_ctf_object_put_ref(obj);
+}
+
+static
+struct bt_ctf_field_type *create_int_ft(unsigned int size, bt_ctf_bool is_signed)
+{
+	struct bt_ctf_field_type *ft;
+	int ret;
+
+	ft = bt_ctf_field_type_integer_create(size);
+	BT_ASSERT(ft);
+	ret = bt_ctf_field_type_integer_set_is_signed(ft, is_signed);
+	BT_ASSERT(ret == 0);
+	return ft;
+}
+
+static
+void add_field(struct bt_ctf_event_class *ec, struct bt_ctf_field_type *ft,
+		const char *name)
+{
+	int ret;
+
+	ret = bt_ctf_event_class_add_field(ec, ft, name);
+	BT_ASSERT(ret == 0);
+	bt_ctf_object_put_ref(ft);
+}
+
+static
+struct bt_ctf_event_class *create_event_class(struct config *cfg,
+		unsigned int index)
+{
+	struct bt_ctf_event_class *ec;
+	struct bt_ctf_field_type *ft;
+	struct bt_ctf_field_type *elem_ft;
+	gchar *name;
+	int ret;
+
+	name = g_strdup_printf("ev%u", index);
+	BT_ASSERT(name);
+	ec = bt_ctf_event_class_create(name);
+	BT_ASSERT(ec);
+	g_free(name);
+	add_field(ec, create_int_ft(32, BT_CTF_FALSE), "u32");
+
+	if (cfg->payload_kind == PAYLOAD_KIND_SIMPLE) {
+		goto end;
+	}
+
+	add_field(ec, create_int_ft(64, BT_CTF_TRUE), "s64");
+	add_field(ec, create_int_ft(8, BT_CTF_FALSE), "u8");
+	ft = bt_ctf_field_type_string_create();
+	BT_ASSERT(ft);
+	add_field(ec, ft, "str");
+
+	if (cfg->payload_kind == PAYLOAD_KIND_MEDIUM) {
+		goto end;
+	}
+
+	elem_ft = create_int_ft(8, BT_CTF_FALSE);
+	ft = bt_ctf_field_type_enumeration_create(elem_ft);
+	BT_ASSERT(ft);
+	bt_ctf_object_put_ref(elem_ft);
+	ret = bt_ctf_field_type_enumeration_unsigned_add_mapping(ft, "LOW",
+		0, 99);
+	BT_ASSERT(ret == 0);
+	ret = bt_ctf_field_type_enumeration_unsigned_add_mapping(ft, "HIGH",
+		100, 255);
+	BT_ASSERT(ret == 0);
+	add_field(ec, ft, "enum");
+	ft = bt_ctf_field_type_floating_point_create();
+	BT_ASSERT(ft);
+	add_field(ec, ft, "dbl");
+	elem_ft = create_int_ft(16, BT_CTF_FALSE);
+	ft = bt_ctf_field_type_array_create(elem_ft, ARRAY_LENGTH);
+	BT_ASSERT(ft);
+	bt_ctf_object_put_ref(elem_ft);
+	add_field(ec, ft, "array");
+	add_field(ec, create_int_ft(8, BT_CTF_FALSE), "seq_len");
+	elem_ft = create_int_ft(32, BT_CTF_TRUE);
+	ft = bt_ctf_field_type_sequence_create(elem_ft, "seq_len");
+	BT_ASSERT(ft);
+	bt_ctf_object_put_ref(elem_ft);
+	add_field(ec, ft, "seq");
+	ft = bt_ctf_field_type_structure_create();
+	BT_ASSERT(ft);
+	elem_ft = create_int_ft(32, BT_CTF_FALSE);
+	ret = bt_ctf_field_type_structure_add_field(ft, elem_ft, "a");
+	BT_ASSERT(ret == 0);
+	bt_ctf_object_put_ref(elem_ft);
+	elem_ft = bt_ctf_field_type_string_create();
+	BT_ASSERT(elem_ft);
+	ret = bt_ctf_field_type_structure_add_field(ft, elem_ft, "b");
+	BT_ASSERT(ret == 0);
+	bt_ctf_object_put_ref(elem_ft);
+	add_field(ec, ft, "nested");
+
+end:
+	return ec;
+}
+
+static
+void configure_writer(struct config *cfg)
+{
+	gint i;
+	int ret;
+
+	cfg->writer = bt_ctf_writer_create(cfg->path);
+	BT_ASSERT(cfg->writer);
+	cfg->trace = bt_ctf_writer_get_trace(cfg->writer);
+	BT_ASSERT(cfg->trace);
+	cfg->clock = bt_ctf_clock_create("default");
+	BT_ASSERT(cfg->clock);
+	ret = bt_ctf_writer_add_clock(cfg->writer, cfg->clock);
+	BT_ASSERT(ret == 0);
+	cfg->sc = bt_ctf_stream_class_create("bench");
+	BT_ASSERT(cfg->sc);
+	ret = bt_ctf_stream_class_set_clock(cfg->sc, cfg->clock);
+	BT_ASSERT(ret == 0);
+	cfg->ecs = g_ptr_array_new_with_free_func(put_ref_notifier);
+	BT_ASSERT(cfg->ecs);
+
+	for (i = 0; i < cfg->event_class_count; i++) {
+		struct bt_ctf_event_class *ec = create_event_class(cfg, i);
+
+		ret = bt_ctf_stream_class_add_event_class(cfg->sc, ec);
+		BT_ASSERT(ret == 0);
+		g_ptr_array_add(cfg->ecs, ec);
+	}
+
+	cfg->streams = g_ptr_array_new_with_free_func(put_ref_notifier);
+	BT_ASSERT(cfg->streams);
+
+	for (i = 0; i < cfg->stream_count; i++) {
+		struct bt_ctf_stream *stream =
+			bt_ctf_writer_create_stream(cfg->writer, cfg->sc);
+
+		BT_ASSERT(stream);
+		g_ptr_array_add(cfg->streams, stream);
+	}
+}
+
+static
+void set_uint_field(struct bt_ctf_field *parent, const char *name,
+		uint64_t value)
+{
+	struct bt_ctf_field *field =
+		bt_ctf_field_structure_get_field_by_name(parent, name);
+	int ret;
+
+	BT_ASSERT(field);
+	ret = bt_ctf_field_integer_unsigned_set_value(field, value);
+	BT_ASSERT(ret == 0);
+	bt_ctf_object_put_ref(field);
+}
+
+static
+void set_string_field(struct bt_ctf_field *parent, const char *name,
+		const char *value)
+{
+	struct bt_ctf_field *field =
+		bt_ctf_field_structure_get_field_by_name(parent, name);
+	int ret;
+
+	BT_ASSERT(field);
+	ret = bt_ctf_field_string_set_value(field, value);
+	BT_ASSERT(ret == 0);
+	bt_ctf_object_put_ref(field);
+}
+
+static
+void set_complex_fields(struct bt_ctf_event *ev, uint64_t seed)
+{
+	struct bt_ctf_field *payload = bt_ctf_event_get_payload_field(ev);
+	struct bt_ctf_field *field;
+	struct bt_ctf_field *sub_field;
+	struct bt_ctf_field *len_field;
+	uint64_t seq_len = seed % SEQ_MAX_LENGTH;
+	uint64_t i;
+	int ret;
+
+	BT_ASSERT(payload);
+	field = bt_ctf_field_structure_get_field_by_name(payload, "enum");
+	BT_ASSERT(field);
+	sub_field = bt_ctf_field_enumeration_get_container(field);
+	BT_ASSERT(sub_field);
+	ret = bt_ctf_field_integer_unsigned_set_value(sub_field, seed & 0xff);
+	BT_ASSERT(ret == 0);
+	bt_ctf_object_put_ref(sub_field);
+	bt_ctf_object_put_ref(field);
+	field = bt_ctf_field_structure_get_field_by_name(payload, "dbl");
+	BT_ASSERT(field);
+	ret = bt_ctf_field_floating_point_set_value(field, (double) seed / 3.0);
+	BT_ASSERT(ret == 0);
+	bt_ctf_object_put_ref(field);
+	field = bt_ctf_field_structure_get_field_by_name(payload, "array");
+	BT_ASSERT(field);
+
+	for (i = 0; i < ARRAY_LENGTH; i++) {
+		sub_field = bt_ctf_field_array_get_field(field, i);
+		BT_ASSERT(sub_field);
+		ret = bt_ctf_field_integer_unsigned_set_value(sub_field,
+			(seed + i) & 0xffff);
+		BT_ASSERT(ret == 0);
+		bt_ctf_object_put_ref(sub_field);
+	}
+
+	bt_ctf_object_put_ref(field);
+	set_uint_field(payload, "seq_len", seq_len);
+	len_field = bt_ctf_field_structure_get_field_by_name(payload,
+		"seq_len");
+	BT_ASSERT(len_field);
+	field = bt_ctf_field_structure_get_field_by_name(payload, "seq");
+	BT_ASSERT(field);
+	ret = bt_ctf_field_sequence_set_length(field, len_field);
+	BT_ASSERT(ret == 0);
+	bt_ctf_object_put_ref(len_field);
+
+	for (i = 0; i < seq_len; i++) {
+		sub_field = bt_ctf_field_sequence_get_field(field, i);
+		BT_ASSERT(sub_field);
+		ret = bt_ctf_field_integer_signed_set_value(sub_field,
+			(int64_t) i - 8);
+		BT_ASSERT(ret == 0);
+		bt_ctf_object_put_ref(sub_field);
+	}
+
+	bt_ctf_object_put_ref(field);
+	field = bt_ctf_field_structure_get_field_by_name(payload, "nested");
+	BT_ASSERT(field);
+	set_uint_field(field, "a", seed & 0xffffffff);
+	set_string_field(field, "b", "nested string");
+	bt_ctf_object_put_ref(field);
+	bt_ctf_object_put_ref(payload);
+}
+
+static
+void append_event(struct config *cfg, struct bt_ctf_stream *stream,
+		uint64_t seed)
+{
+	struct bt_ctf_event_class *ec =
+		g_ptr_array_index(cfg->ecs, seed % cfg->ecs->len);
+	struct bt_ctf_event *ev;
+	struct bt_ctf_field *payload;
+	int ret;
+
+	ev = bt_ctf_event_create(ec);
+	BT_ASSERT(ev);
+	payload = bt_ctf_event_get_payload_field(ev);
+	BT_ASSERT(payload);
+	set_uint_field(payload, "u32", seed & 0xffffffff);
+
+	if (cfg->payload_kind != PAYLOAD_KIND_SIMPLE) {
+		struct bt_ctf_field *field =
+			bt_ctf_field_structure_get_field_by_name(payload,
+				"s64");
+
+		BT_ASSERT(field);
+		ret = bt_ctf_field_integer_signed_set_value(field,
+			-(int64_t) seed);
+		BT_ASSERT(ret == 0);
+		bt_ctf_object_put_ref(field);
+		set_uint_field(payload, "u8", seed & 0xff);
+		set_string_field(payload, "str", "benchmark event payload");
+	}
+
+	if (cfg->payload_kind == PAYLOAD_KIND_COMPLEX) {
+		set_complex_fields(ev, seed);
+	}
+
+	bt_ctf_object_put_ref(payload);
+	ret = bt_ctf_stream_append_event(stream, ev);
+	BT_ASSERT(ret == 0);
+	bt_ctf_object_put_ref(ev);
+}
+
+static
+void write_streams(struct config *cfg)
+{
+	gint64 i;
+	guint s;
+	int ret;
+
+	for (i = 0; i < cfg->events_per_stream; i++) {
+		for (s = 0; s < cfg->streams->len; s++) {
+			struct bt_ctf_stream *stream =
+				g_ptr_array_index(cfg->streams, s);
+			uint64_t seed = (uint64_t) i * cfg->streams->len + s;
+
+			ret = bt_ctf_clock_set_time(cfg->clock,
+				1000 + (int64_t) seed * 10);
+			BT_ASSERT(ret == 0);
+			append_event(cfg, stream, seed);
+
+			if ((i + 1) % cfg->events_per_packet == 0) {
+				ret = bt_ctf_stream_flush(stream);
+				BT_ASSERT(ret == 0);
+			}
+		}
+	}
+
+	if (cfg->events_per_stream % cfg->events_per_packet != 0) {
+		for (s = 0; s < cfg->streams->len; s++) {
+			ret = bt_ctf_stream_flush(
+				g_ptr_array_index(cfg->streams, s));
+			BT_ASSERT(ret == 0);
+		}
+	}
+}
+
+static
+int parse_args(struct config *cfg, int argc, char **argv)
+{
+	int ret = 0;
+	gchar *payload = NULL;
+	GError *error = NULL;
+	GOptionContext *context;
+	GOptionEntry entries[] = {
+		{ "streams", 's', 0, G_OPTION_ARG_INT, &cfg->stream_count,
+			"Number of data streams (default: 4)", "N" },
+		{ "event-classes", 'c', 0, G_OPTION_ARG_INT,
+			&cfg->event_class_count,
+			"Number of event classes (default: 8)", "N" },
+		{ "events", 'e', 0, G_OPTION_ARG_INT64, &cfg->events_per_stream,
+			"Number of events per data stream (default: 100000)", "N" },
+		{ "packet-events", 'p', 0, G_OPTION_ARG_INT,
+			&cfg->events_per_packet,
+			"Number of events per packet (default: 1000)", "N" },
+		{ "payload", 'l', 0, G_OPTION_ARG_STRING, &payload,
+			"Payload complexity: simple, medium, or complex (default: medium)",
+			"KIND" },
+		{ NULL },
+	};
+
+	cfg->stream_count = 4;
+	cfg->event_class_count = 8;
+	cfg->events_per_stream = 100000;
+	cfg->events_per_packet = 1000;
+	cfg->payload_kind = PAYLOAD_KIND_MEDIUM;
+	context = g_option_context_new("OUTPUT-DIR");
+	BT_ASSERT(context);
+	g_option_context_set_summary(context,
+		"Write a synthetic CTF trace for the benchmarks to OUTPUT-DIR.");
+	g_option_context_add_main_entries(context, entries, NULL);
+
+	if (!g_option_context_parse(context, &argc, &argv, &error)) {
+		fprintf(stderr, "Invalid arguments: %s\n", error->message);
+		g_error_free(error);
+		goto error;
+	}
+
+	if (argc != 2) {
+		fprintf(stderr, "Expecting exactly one output directory.\n");
+		goto error;
+	}
+
+	cfg->path = argv[1];
+
+	if (cfg->stream_count <= 0 || cfg->event_class_count <= 0 ||
+			cfg->events_per_stream < 0 ||
+			cfg->events_per_packet <= 0) {
+		fprintf(stderr, "Invalid trace shape.\n");
+		goto error;
+	}
+
+	if (payload) {
+		if (strcmp(payload, "simple") == 0) {
+			cfg->payload_kind = PAYLOAD_KIND_SIMPLE;
+		} else if (strcmp(payload, "medium") == 0) {
+			cfg->payload_kind = PAYLOAD_KIND_MEDIUM;
+		} else if (strcmp(payload, "complex") == 0) {
+			cfg->payload_kind = PAYLOAD_KIND_COMPLEX;
+		} else {
+			fprintf(stderr, "Unknown payload kind `%s`.\n", payload);
+			goto error;
+		}
+	}
+
+	goto end;
+
+error:
+	ret = -1;
+
+end:
+	g_free(payload);
+	g_option_context_free(context);
+	return ret;
+}
+
+int main(int argc, char **argv)
+{
+	struct config cfg = {0};
+
+	if (parse_args(&cfg, argc, argv)) {
+		return EXIT_FAILURE;
+	}
+
+	configure_writer(&cfg);
+	write_streams(&cfg);
+	fini_config(&cfg);
+	return EXIT_SUCCESS;
+}
@@ -56,6 +56,21 @@ class GraphTestCase(unittest.TestCase):
         interrupter = self._graph.default_interrupter
         self.assertIs(type(interrupter), bt2.Interrupter)
 
+    def test_default_message_batch_size(self):
+        self.assertEqual(self._graph.message_batch_size, 15)
+
+    def test_set_message_batch_size(self):
+        self._graph.message_batch_size = 256
+        self.assertEqual(self._graph.message_batch_size, 256)
+
+    def test_set_message_batch_size_invalid_type(self):
+        with self.assertRaises(TypeError):
+            self._graph.message_batch_size = 'lel'
+
+    def test_set_message_batch_size_zero(self):
+        with self.assertRaisesRegex(ValueError, 'invalid message batch size'):
+            self._graph.message_batch_size = 0
+
     def test_add_component_user_cls(self):
         class MySink(bt2._UserSinkComponent):
             def _user_consume(self):
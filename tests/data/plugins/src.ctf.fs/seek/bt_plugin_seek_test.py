@@ -0,0 +1,39 @@
+# SPDX-License-Identifier: GPL-2.0-only
+#
+# Copyright (C) 2023 EfficiOS Inc.
+#
+
+import bt2
+
+
+# Forwards the messages of its upstream message iterator, but can only
+# seek its beginning: this makes the library seek a given time by seeking
+# the beginning and fast-forwarding, as it does for any message iterator
+# which doesn't seek nanoseconds from origin by itself.
+class TheIteratorOfNoSeeking(bt2._UserMessageIterator):
+    def __init__(self, config, port):
+        self._upstream_iter = self._create_message_iterator(
+            self._component._input_ports['in']
+        )
+        config.can_seek_forward = True
+
+    def _user_can_seek_beginning(self):
+        return self._upstream_iter.can_seek_beginning()
+
+    def _user_seek_beginning(self):
+        self._upstream_iter.seek_beginning()
+
+    def __next__(self):
+        return next(self._upstream_iter)
+
+
+@bt2.plugin_component_class
+class TheFilterOfNoSeeking(
+    bt2._UserFilterComponent, message_iterator_class=TheIteratorOfNoSeeking
+):
+    def __init__(self, config, params, obj):
+        self._add_input_port('in')
+        self._add_output_port('out')
+
+
+bt2.register_plugin(__name__, 'test-seek')
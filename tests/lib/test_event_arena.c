@@ -0,0 +1,439 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ * Copyright (C) 2023 EfficiOS Inc.
+ *
+ * Event field arena test: creates, recycles, and destroys events of
+ * which the field trees contain nested structure and dynamic array
+ * fields.
+ */
+
+#include <babeltrace2/babeltrace.h>
+#include "common/assert.h"
+#include <glib.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "tap/tap.h"
+#include "test-graph.h"
+
+#define NR_TESTS	5
+
+/* Number of event messages which the source emits */
+#define EVENT_COUNT	200
+
+/* Maximum number of messages per batch of the source */
+#define BATCH_SIZE	7
+
+/* Length of the static array field */
+#define STATIC_ARRAY_LEN	3
+
+struct src_iter_data {
+	/* Event class of which the payload field class has nested fields */
+	bt_event_class *ec;
+
+	bt_trace *trace;
+	bt_stream *stream;
+
+	/* Index of the next message to emit */
+	uint64_t index;
+};
+
+struct sink_data {
+	/* Number of received event messages */
+	uint64_t event_count;
+
+	/* Number of received events of which the payload is wrong */
+	uint64_t bad_payload_count;
+
+	/* Addresses of the received events */
+	GHashTable *events;
+
+	/* True if the sink received an event of which the address was seen */
+	bool event_was_recycled;
+};
+
+/*
+ * Length of the dynamic array fields of the event at index `i`: it
+ * grows and shrinks so that recycled events get longer and shorter
+ * dynamic array fields than their previous ones.
+ */
+static
+uint64_t dyn_array_len(uint64_t i)
+{
+	return (i * 7) % 23;
+}
+
+static
+bt_field_class *create_payload_fc(bt_trace_class *tc)
+{
+	bt_field_class *payload_fc;
+	bt_field_class *inner_fc;
+	bt_field_class *elem_fc;
+	bt_field_class *fc;
+	int ret;
+
+	payload_fc = bt_field_class_structure_create(tc);
+	BT_ASSERT(payload_fc);
+
+	/* `index`: unsigned integer */
+	fc = bt_field_class_integer_unsigned_create(tc);
+	BT_ASSERT(fc);
+	ret = bt_field_class_structure_append_member(payload_fc, "index", fc);
+	BT_ASSERT(ret == 0);
+	bt_field_class_put_ref(fc);
+
+	/* `inner`: structure { `name`: string, `value`: signed integer } */
+	inner_fc = bt_field_class_structure_create(tc);
+	BT_ASSERT(inner_fc);
+	fc = bt_field_class_string_create(tc);
+	BT_ASSERT(fc);
+	ret = bt_field_class_structure_append_member(inner_fc, "name", fc);
+	BT_ASSERT(ret == 0);
+	bt_field_class_put_ref(fc);
+	fc = bt_field_class_integer_signed_create(tc);
+	BT_ASSERT(fc);
+	ret = bt_field_class_structure_append_member(inner_fc, "value", fc);
+	BT_ASSERT(ret == 0);
+	bt_field_class_put_ref(fc);
+
+	/* `static-array`: static array of `inner` structures */
+	fc = bt_field_class_array_static_create(tc, inner_fc,
+		STATIC_ARRAY_LEN);
+	BT_ASSERT(fc);
+	ret = bt_field_class_structure_append_member(payload_fc,
+		"static-array", fc);
+	BT_ASSERT(ret == 0);
+	bt_field_class_put_ref(fc);
+	bt_field_class_put_ref(inner_fc);
+
+	/* `dyn-array`: dynamic array of unsigned integers */
+	elem_fc = bt_field_class_integer_unsigned_create(tc);
+	BT_ASSERT(elem_fc);
+	fc = bt_field_class_array_dynamic_create(tc, elem_fc, NULL);
+	BT_ASSERT(fc);
+	ret = bt_field_class_structure_append_member(payload_fc, "dyn-array",
+		fc);
+	BT_ASSERT(ret == 0);
+	bt_field_class_put_ref(fc);
+	bt_field_class_put_ref(elem_fc);
+
+	/* `dyn-struct-array`: dynamic array of structures { `value` } */
+	elem_fc = bt_field_class_structure_create(tc);
+	BT_ASSERT(elem_fc);
+	fc = bt_field_class_integer_unsigned_create(tc);
+	BT_ASSERT(fc);
+	ret = bt_field_class_structure_append_member(elem_fc, "value", fc);
+	BT_ASSERT(ret == 0);
+	bt_field_class_put_ref(fc);
+	fc = bt_field_class_array_dynamic_create(tc, elem_fc, NULL);
+	BT_ASSERT(fc);
+	ret = bt_field_class_structure_append_member(payload_fc,
+		"dyn-struct-array", fc);
+	BT_ASSERT(ret == 0);
+	bt_field_class_put_ref(fc);
+	bt_field_class_put_ref(elem_fc);
+	return payload_fc;
+}
+
+static
+void set_payload(bt_field *payload, uint64_t i)
+{
+	bt_field *field;
+	bt_field *static_array;
+	bt_field *dyn_array;
+	uint64_t len = dyn_array_len(i);
+	uint64_t j;
+	char name[32];
+	int ret;
+
+	field = bt_field_structure_borrow_member_field_by_name(payload,
+		"index");
+	bt_field_integer_unsigned_set_value(field, i);
+
+	static_array = bt_field_structure_borrow_member_field_by_name(payload,
+		"static-array");
+
+	for (j = 0; j < STATIC_ARRAY_LEN; j++) {
+		bt_field *inner = bt_field_array_borrow_element_field_by_index(
+			static_array, j);
+
+		snprintf(name, sizeof(name), "event-%" PRIu64 "-%" PRIu64,
+			i, j);
+		field = bt_field_structure_borrow_member_field_by_name(inner,
+			"name");
+		ret = bt_field_string_set_value(field, name);
+		BT_ASSERT(ret == 0);
+		field = bt_field_structure_borrow_member_field_by_name(inner,
+			"value");
+		bt_field_integer_signed_set_value(field, -(int64_t) (i + j));
+	}
+
+	dyn_array = bt_field_structure_borrow_member_field_by_name(payload,
+		"dyn-array");
+	ret = bt_field_array_dynamic_set_length(dyn_array, len);
+	BT_ASSERT(ret == 0);
+
+	for (j = 0; j < len; j++) {
+		bt_field_integer_unsigned_set_value(
+			bt_field_array_borrow_element_field_by_index(dyn_array,
+				j), i * 1000 + j);
+	}
+
+	dyn_array = bt_field_structure_borrow_member_field_by_name(payload,
+		"dyn-struct-array");
+	ret = bt_field_array_dynamic_set_length(dyn_array, len);
+	BT_ASSERT(ret == 0);
+
+	for (j = 0; j < len; j++) {
+		bt_field *elem = bt_field_array_borrow_element_field_by_index(
+			dyn_array, j);
+
+		field = bt_field_structure_borrow_member_field_by_name(elem,
+			"value");
+		bt_field_integer_unsigned_set_value(field, i + j);
+	}
+}
+
+static
+bool payload_is_valid(const bt_field *payload)
+{
+	const bt_field *field;
+	const bt_field *static_array;
+	const bt_field *dyn_array;
+	uint64_t i;
+	uint64_t len;
+	uint64_t j;
+	char name[32];
+
+	field = bt_field_structure_borrow_member_field_by_name_const(payload,
+		"index");
+	i = bt_field_integer_unsigned_get_value(field);
+	len = dyn_array_len(i);
+	static_array = bt_field_structure_borrow_member_field_by_name_const(
+		payload, "static-array");
+
+	for (j = 0; j < STATIC_ARRAY_LEN; j++) {
+		const bt_field *inner =
+			bt_field_array_borrow_element_field_by_index_const(
+				static_array, j);
+
+		snprintf(name, sizeof(name), "event-%" PRIu64 "-%" PRIu64,
+			i, j);
+		field = bt_field_structure_borrow_member_field_by_name_const(
+			inner, "name");
+		if (strcmp(bt_field_string_get_value(field), name) != 0) {
+			return false;
+		}
+
+		field = bt_field_structure_borrow_member_field_by_name_const(
+			inner, "value");
+		if (bt_field_integer_signed_get_value(field) !=
+				-(int64_t) (i + j)) {
+			return false;
+		}
+	}
+
+	dyn_array = bt_field_structure_borrow_member_field_by_name_const(
+		payload, "dyn-array");
+	if (bt_field_array_get_length(dyn_array) != len) {
+		return false;
+	}
+
+	for (j = 0; j < len; j++) {
+		field = bt_field_array_borrow_element_field_by_index_const(
+			dyn_array, j);
+		if (bt_field_integer_unsigned_get_value(field) !=
+				i * 1000 + j) {
+			return false;
+		}
+	}
+
+	dyn_array = bt_field_structure_borrow_member_field_by_name_const(
+		payload, "dyn-struct-array");
+	if (bt_field_array_get_length(dyn_array) != len) {
+		return false;
+	}
+
+	for (j = 0; j < len; j++) {
+		const bt_field *elem =
+			bt_field_array_borrow_element_field_by_index_const(
+				dyn_array, j);
+
+		field = bt_field_structure_borrow_member_field_by_name_const(
+			elem, "value");
+		if (bt_field_integer_unsigned_get_value(field) != i + j) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static
+bt_message_iterator_class_initialize_method_status src_iter_init(
+		bt_self_message_iterator *self_msg_iter,
+		bt_self_message_iterator_configuration *config,
+		bt_self_component_port_output *port)
+{
+	struct test_graph_src_data *data = bt_self_component_get_data(
+		bt_self_message_iterator_borrow_component(self_msg_iter));
+	struct src_iter_data *iter_data = g_new0(struct src_iter_data, 1);
+	bt_field_class *payload_fc;
+	int ret;
+
+	BT_ASSERT(iter_data);
+	iter_data->ec = bt_event_class_create(data->sc);
+	BT_ASSERT(iter_data->ec);
+	payload_fc = create_payload_fc(data->tc);
+	ret = bt_event_class_set_payload_field_class(iter_data->ec,
+		payload_fc);
+	BT_ASSERT(ret == 0);
+	bt_field_class_put_ref(payload_fc);
+	iter_data->trace = bt_trace_create(data->tc);
+	BT_ASSERT(iter_data->trace);
+	iter_data->stream = bt_stream_create(data->sc, iter_data->trace);
+	BT_ASSERT(iter_data->stream);
+	bt_self_message_iterator_set_data(self_msg_iter, iter_data);
+	return BT_MESSAGE_ITERATOR_CLASS_INITIALIZE_METHOD_STATUS_OK;
+}
+
+static
+void src_iter_finalize(bt_self_message_iterator *self_msg_iter)
+{
+	struct src_iter_data *iter_data =
+		bt_self_message_iterator_get_data(self_msg_iter);
+
+	bt_stream_put_ref(iter_data->stream);
+	bt_trace_put_ref(iter_data->trace);
+	bt_event_class_put_ref(iter_data->ec);
+	g_free(iter_data);
+}
+
+static
+bt_message_iterator_class_next_method_status src_iter_next(
+		bt_self_message_iterator *self_msg_iter,
+		bt_message_array_const msgs, uint64_t capacity,
+		uint64_t *count)
+{
+	struct src_iter_data *iter_data =
+		bt_self_message_iterator_get_data(self_msg_iter);
+	uint64_t i = 0;
+
+	/* Stream beginning, events, and stream end */
+	if (iter_data->index == EVENT_COUNT + 2) {
+		return BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_END;
+	}
+
+	while (i < MIN(capacity, BATCH_SIZE) &&
+			iter_data->index < EVENT_COUNT + 2) {
+		bt_message *msg;
+
+		if (iter_data->index == 0) {
+			msg = bt_message_stream_beginning_create(self_msg_iter,
+				iter_data->stream);
+		} else if (iter_data->index == EVENT_COUNT + 1) {
+			msg = bt_message_stream_end_create(self_msg_iter,
+				iter_data->stream);
+		} else {
+			msg = bt_message_event_create(self_msg_iter,
+				iter_data->ec,
+				iter_data->stream);
+			BT_ASSERT(msg);
+			set_payload(bt_event_borrow_payload_field(
+				bt_message_event_borrow_event(msg)),
+				iter_data->index - 1);
+		}
+
+		BT_ASSERT(msg);
+		msgs[i] = msg;
+		i++;
+		iter_data->index++;
+	}
+
+	*count = i;
+	return BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK;
+}
+
+static
+bt_graph_simple_sink_component_consume_func_status sink_consume(
+		bt_message_iterator *msg_iter, void *user_data)
+{
+	struct sink_data *data = user_data;
+	bt_message_array_const msgs;
+	bt_graph_simple_sink_component_consume_func_status status;
+	uint64_t count;
+	uint64_t i;
+
+	status = test_graph_sink_next(msg_iter, &msgs, &count);
+	if (status != BT_GRAPH_SIMPLE_SINK_COMPONENT_CONSUME_FUNC_STATUS_OK) {
+		return status;
+	}
+
+	for (i = 0; i < count; i++) {
+		if (bt_message_get_type(msgs[i]) == BT_MESSAGE_TYPE_EVENT) {
+			const bt_event *event =
+				bt_message_event_borrow_event_const(msgs[i]);
+
+			data->event_count++;
+
+			if (!payload_is_valid(
+					bt_event_borrow_payload_field_const(
+						event))) {
+				data->bad_payload_count++;
+			}
+
+			if (g_hash_table_lookup(data->events, event)) {
+				data->event_was_recycled = true;
+			} else {
+				g_hash_table_insert(data->events,
+					(gpointer) event, (gpointer) event);
+			}
+		}
+
+		/* Release the event so that the next ones reuse it */
+		bt_message_put_ref(msgs[i]);
+	}
+
+	return BT_GRAPH_SIMPLE_SINK_COMPONENT_CONSUME_FUNC_STATUS_OK;
+}
+
+static const struct test_graph_src_methods src_methods = {
+	.next = src_iter_next,
+	.init = src_iter_init,
+	.finalize = src_iter_finalize,
+};
+
+static
+void test_event_arena(void)
+{
+	bt_graph *graph;
+	bt_graph_run_status run_status;
+	struct sink_data sink_data = { 0 };
+
+	sink_data.events = g_hash_table_new(g_direct_hash, g_direct_equal);
+	BT_ASSERT(sink_data.events);
+	graph = test_graph_create(&src_methods, NULL, sink_consume,
+		&sink_data, NULL);
+	run_status = test_graph_run(graph);
+	ok(run_status == BT_GRAPH_RUN_STATUS_OK, "Graph runs successfully");
+	ok(sink_data.event_count == EVENT_COUNT,
+		"Sink receives all the events");
+	ok(sink_data.bad_payload_count == 0,
+		"Events have the expected payload fields");
+	ok(sink_data.event_was_recycled,
+		"Events are recycled");
+
+	/* Destroys the pooled events and their field trees */
+	bt_graph_put_ref(graph);
+	ok(true, "Graph with pooled events is destroyed");
+	g_hash_table_destroy(sink_data.events);
+}
+
+int main(void)
+{
+	plan_tests(NR_TESTS);
+	test_event_arena();
+	return exit_status();
+}
@@ -0,0 +1,182 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ * Copyright (C) 2023 EfficiOS Inc.
+ *
+ * Deferred event payload field filling test
+ */
+
+#include <babeltrace2/babeltrace.h>
+#include "common/assert.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include "tap/tap.h"
+#include "test-graph.h"
+
+#define NR_TESTS 7
+
+/* Value which materialize() sets */
+#define PAYLOAD_VALUE	42
+
+struct materialize_state {
+	unsigned int call_count;
+	unsigned int destroy_count;
+};
+
+static
+bt_event_payload_field_materialize_func_status materialize(
+		bt_field *payload_field, void *user_data)
+{
+	struct materialize_state *state = user_data;
+
+	state->call_count++;
+	bt_field_integer_unsigned_set_value(
+		bt_field_structure_borrow_member_field_by_index(payload_field,
+			0), PAYLOAD_VALUE);
+	return BT_EVENT_PAYLOAD_FIELD_MATERIALIZE_FUNC_STATUS_OK;
+}
+
+static
+void destroy_materialize_data(void *user_data)
+{
+	struct materialize_state *state = user_data;
+
+	state->destroy_count++;
+}
+
+static
+uint64_t get_payload_value(const bt_event *event)
+{
+	return bt_field_integer_unsigned_get_value(
+		bt_field_structure_borrow_member_field_by_index_const(
+			bt_event_borrow_payload_field_const(event), 0));
+}
+
+static
+void test_materialize(bt_self_message_iterator *self_msg_iter,
+		bt_event_class *ec, bt_stream *stream)
+{
+	struct materialize_state state = { 0 };
+	bt_message *msg;
+	bt_event *event;
+
+	/* Materialized on first access */
+	msg = bt_message_event_create(self_msg_iter, ec, stream);
+	BT_ASSERT(msg);
+	event = bt_message_event_borrow_event(msg);
+	bt_event_set_payload_field_materialize_func(event, materialize,
+		destroy_materialize_data, &state);
+	ok(state.call_count == 0,
+		"Library doesn't fill a deferred payload field before it's borrowed");
+	ok(get_payload_value(event) == PAYLOAD_VALUE && state.call_count == 1,
+		"Borrowing a deferred payload field fills it");
+	ok(state.destroy_count == 1,
+		"Library destroys the user data once the payload field is filled");
+	ok(get_payload_value(event) == PAYLOAD_VALUE && state.call_count == 1,
+		"Library fills a deferred payload field only once");
+	bt_message_put_ref(msg);
+
+	/* Never accessed */
+	msg = bt_message_event_create(self_msg_iter, ec, stream);
+	BT_ASSERT(msg);
+	event = bt_message_event_borrow_event(msg);
+	bt_event_set_payload_field_materialize_func(event, materialize,
+		destroy_materialize_data, &state);
+	bt_message_put_ref(msg);
+	ok(state.call_count == 1 && state.destroy_count == 2,
+		"Library destroys the user data of an event which is never accessed");
+
+	/* Recycled event */
+	msg = bt_message_event_create(self_msg_iter, ec, stream);
+	BT_ASSERT(msg);
+	event = bt_message_event_borrow_event(msg);
+	bt_event_borrow_payload_field(event);
+	ok(state.call_count == 1,
+		"Library doesn't fill the payload field of a recycled event");
+	bt_message_put_ref(msg);
+
+	/* Mutable access */
+	msg = bt_message_event_create(self_msg_iter, ec, stream);
+	BT_ASSERT(msg);
+	event = bt_message_event_borrow_event(msg);
+	bt_event_set_payload_field_materialize_func(event, materialize,
+		destroy_materialize_data, &state);
+	bt_event_borrow_payload_field(event);
+	ok(state.call_count == 2 && state.destroy_count == 3,
+		"Borrowing a deferred payload field (non-const) fills it");
+	bt_message_put_ref(msg);
+}
+
+static
+bt_message_iterator_class_initialize_method_status src_iter_init(
+		bt_self_message_iterator *self_msg_iter,
+		bt_self_message_iterator_configuration *config,
+		bt_self_component_port_output *port)
+{
+	bt_self_component *self_comp =
+		bt_self_message_iterator_borrow_component(self_msg_iter);
+	bt_trace_class *tc;
+	bt_stream_class *sc;
+	bt_event_class *ec;
+	bt_field_class *payload_fc;
+	bt_field_class *member_fc;
+	bt_trace *trace;
+	bt_stream *stream;
+	int ret;
+
+	tc = bt_trace_class_create(self_comp);
+	BT_ASSERT(tc);
+	sc = bt_stream_class_create(tc);
+	BT_ASSERT(sc);
+	payload_fc = bt_field_class_structure_create(tc);
+	BT_ASSERT(payload_fc);
+	member_fc = bt_field_class_integer_unsigned_create(tc);
+	BT_ASSERT(member_fc);
+	ret = bt_field_class_structure_append_member(payload_fc, "value",
+		member_fc);
+	BT_ASSERT(ret == 0);
+	ec = bt_event_class_create(sc);
+	BT_ASSERT(ec);
+	ret = bt_event_class_set_payload_field_class(ec, payload_fc);
+	BT_ASSERT(ret == 0);
+	trace = bt_trace_create(tc);
+	BT_ASSERT(trace);
+	stream = bt_stream_create(sc, trace);
+	BT_ASSERT(stream);
+	test_materialize(self_msg_iter, ec, stream);
+	bt_stream_put_ref(stream);
+	bt_trace_put_ref(trace);
+	bt_event_class_put_ref(ec);
+	bt_field_class_put_ref(member_fc);
+	bt_field_class_put_ref(payload_fc);
+	bt_stream_class_put_ref(sc);
+	bt_trace_class_put_ref(tc);
+	return BT_MESSAGE_ITERATOR_CLASS_INITIALIZE_METHOD_STATUS_OK;
+}
+
+static const struct test_graph_src_methods src_methods = {
+	.init = src_iter_init,
+};
+
+/*
+ * Runs a graph of which the source component's message iterator runs
+ * the tests when it's initialized.
+ */
+static
+void run_graph(void)
+{
+	bt_graph *graph;
+	bt_graph_run_status run_status;
+
+	graph = test_graph_create(&src_methods, NULL, NULL, NULL, NULL);
+	run_status = bt_graph_run(graph);
+	BT_ASSERT(run_status == BT_GRAPH_RUN_STATUS_OK);
+	bt_graph_put_ref(graph);
+}
+
+int main(void)
+{
+	plan_tests(NR_TESTS);
+	run_graph();
+	return exit_status();
+}
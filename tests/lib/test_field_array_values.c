@@ -0,0 +1,319 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ * Copyright (C) 2023 EfficiOS Inc.
+ *
+ * Array field element values test
+ */
+
+#include <babeltrace2/babeltrace.h>
+#include "common/assert.h"
+#include <glib.h>
+#include <string.h>
+#include "tap/tap.h"
+
+#define NR_TESTS 20
+
+struct fields {
+	bt_field *uint8_array;
+	bt_field *sint32_seq;
+	bt_field *float_array;
+	bt_field *double_seq;
+};
+
+static
+bt_field_class *create_packet_context_fc(bt_trace_class *tc)
+{
+	bt_field_class *struct_fc;
+	bt_field_class *elem_fc;
+	bt_field_class *array_fc;
+	int ret;
+
+	struct_fc = bt_field_class_structure_create(tc);
+	BT_ASSERT(struct_fc);
+
+	elem_fc = bt_field_class_integer_unsigned_create(tc);
+	BT_ASSERT(elem_fc);
+	bt_field_class_integer_set_field_value_range(elem_fc, 8);
+	array_fc = bt_field_class_array_static_create(tc, elem_fc, 4);
+	BT_ASSERT(array_fc);
+	ret = bt_field_class_structure_append_member(struct_fc, "uint8-array",
+		array_fc);
+	BT_ASSERT(ret == 0);
+	bt_field_class_put_ref(elem_fc);
+	bt_field_class_put_ref(array_fc);
+
+	elem_fc = bt_field_class_integer_signed_create(tc);
+	BT_ASSERT(elem_fc);
+	bt_field_class_integer_set_field_value_range(elem_fc, 32);
+	array_fc = bt_field_class_array_dynamic_create(tc, elem_fc, NULL);
+	BT_ASSERT(array_fc);
+	ret = bt_field_class_structure_append_member(struct_fc, "sint32-seq",
+		array_fc);
+	BT_ASSERT(ret == 0);
+	bt_field_class_put_ref(elem_fc);
+	bt_field_class_put_ref(array_fc);
+
+	elem_fc = bt_field_class_real_single_precision_create(tc);
+	BT_ASSERT(elem_fc);
+	array_fc = bt_field_class_array_static_create(tc, elem_fc, 2);
+	BT_ASSERT(array_fc);
+	ret = bt_field_class_structure_append_member(struct_fc, "float-array",
+		array_fc);
+	BT_ASSERT(ret == 0);
+	bt_field_class_put_ref(elem_fc);
+	bt_field_class_put_ref(array_fc);
+
+	elem_fc = bt_field_class_real_double_precision_create(tc);
+	BT_ASSERT(elem_fc);
+	array_fc = bt_field_class_array_dynamic_create(tc, elem_fc, NULL);
+	BT_ASSERT(array_fc);
+	ret = bt_field_class_structure_append_member(struct_fc, "double-seq",
+		array_fc);
+	BT_ASSERT(ret == 0);
+	bt_field_class_put_ref(elem_fc);
+	bt_field_class_put_ref(array_fc);
+	return struct_fc;
+}
+
+static
+void test_unsigned_integer_elements(struct fields *fields)
+{
+	static const uint64_t values[] = { 1, 2, 3, 255 };
+	const uint64_t *borrowed_values;
+	bt_field *elem_field;
+
+	bt_field_array_set_unsigned_integer_element_values(
+		fields->uint8_array, values);
+	borrowed_values =
+		bt_field_array_borrow_unsigned_integer_element_values_const(
+			fields->uint8_array);
+	ok(memcmp(borrowed_values, values, sizeof(values)) == 0,
+		"Borrowed unsigned integer element values are the set ones");
+
+	elem_field = bt_field_array_borrow_element_field_by_index(
+		fields->uint8_array, 3);
+	ok(bt_field_integer_unsigned_get_value(elem_field) == 255,
+		"Unsigned integer element field has the set value");
+
+	bt_field_integer_unsigned_set_value(elem_field, 42);
+	borrowed_values =
+		bt_field_array_borrow_unsigned_integer_element_values_const(
+			fields->uint8_array);
+	ok(borrowed_values[3] == 42 && borrowed_values[0] == 1,
+		"Borrowed unsigned integer element values reflect an element field's new value");
+
+	bt_field_array_set_unsigned_integer_element_values(
+		fields->uint8_array, values);
+	elem_field = bt_field_array_borrow_element_field_by_index(
+		fields->uint8_array, 3);
+	ok(bt_field_integer_unsigned_get_value(elem_field) == 255,
+		"Element field reflects the new element values");
+}
+
+static
+void test_signed_integer_elements(struct fields *fields)
+{
+	static const int64_t values[] = { -1, 0, INT32_MAX, INT32_MIN, 7 };
+	const int64_t *borrowed_values;
+	const bt_field *elem_field;
+	bt_field_array_dynamic_set_length_status status;
+
+	status = bt_field_array_dynamic_set_length(fields->sint32_seq, 3);
+	ok(status == BT_FIELD_DYNAMIC_ARRAY_SET_LENGTH_STATUS_OK,
+		"Set the length of a signed integer dynamic array field");
+	bt_field_array_set_signed_integer_element_values(fields->sint32_seq,
+		values);
+	elem_field = bt_field_array_borrow_element_field_by_index_const(
+		fields->sint32_seq, 0);
+	ok(bt_field_integer_signed_get_value(elem_field) == -1,
+		"Signed integer element field has the set value");
+
+	status = bt_field_array_dynamic_set_length(fields->sint32_seq, 5);
+	ok(status == BT_FIELD_DYNAMIC_ARRAY_SET_LENGTH_STATUS_OK,
+		"Increase the length of a signed integer dynamic array field");
+	bt_field_array_set_signed_integer_element_values(fields->sint32_seq,
+		values);
+	borrowed_values =
+		bt_field_array_borrow_signed_integer_element_values_const(
+			fields->sint32_seq);
+	ok(memcmp(borrowed_values, values, sizeof(values)) == 0,
+		"Borrowed signed integer element values are the set ones");
+	elem_field = bt_field_array_borrow_element_field_by_index_const(
+		fields->sint32_seq, 4);
+	ok(bt_field_integer_signed_get_value(elem_field) == 7,
+		"Element field created after a length increase has the set value");
+	ok(bt_field_array_get_length(fields->sint32_seq) == 5,
+		"Dynamic array field has the new length");
+}
+
+static
+void test_real_elements(struct fields *fields)
+{
+	static const double float_values[] = { 0.1, -2.5 };
+	static const double double_values[] = { 0.1, 1e300, -3.25 };
+	const double *borrowed_values;
+	const bt_field *elem_field;
+	bt_field_array_dynamic_set_length_status status;
+
+	bt_field_array_set_real_element_values(fields->float_array,
+		float_values);
+	borrowed_values = bt_field_array_borrow_real_element_values_const(
+		fields->float_array);
+	ok(borrowed_values[0] == (double) (float) 0.1 &&
+		borrowed_values[1] == -2.5,
+		"Single-precision real element values are converted to float");
+	elem_field = bt_field_array_borrow_element_field_by_index_const(
+		fields->float_array, 0);
+	ok(bt_field_real_single_precision_get_value(elem_field) == (float) 0.1,
+		"Single-precision real element field has the set value");
+
+	status = bt_field_array_dynamic_set_length(fields->double_seq, 0);
+	ok(status == BT_FIELD_DYNAMIC_ARRAY_SET_LENGTH_STATUS_OK,
+		"Set the length of a real dynamic array field to 0");
+	bt_field_array_set_real_element_values(fields->double_seq, NULL);
+	ok(bt_field_array_get_length(fields->double_seq) == 0,
+		"Set the element values of an empty real dynamic array field");
+
+	status = bt_field_array_dynamic_set_length(fields->double_seq, 3);
+	ok(status == BT_FIELD_DYNAMIC_ARRAY_SET_LENGTH_STATUS_OK,
+		"Set the length of a real dynamic array field");
+	bt_field_array_set_real_element_values(fields->double_seq,
+		double_values);
+	borrowed_values = bt_field_array_borrow_real_element_values_const(
+		fields->double_seq);
+	ok(memcmp(borrowed_values, double_values,
+		sizeof(double_values)) == 0,
+		"Borrowed double-precision real element values are the set ones");
+	elem_field = bt_field_array_borrow_element_field_by_index_const(
+		fields->double_seq, 1);
+	ok(bt_field_real_double_precision_get_value(elem_field) == 1e300,
+		"Double-precision real element field has the set value");
+
+	/* Grow the array once its element fields are the current ones */
+	status = bt_field_array_dynamic_set_length(fields->double_seq,
+		G_N_ELEMENTS(double_values) + 2);
+	ok(status == BT_FIELD_DYNAMIC_ARRAY_SET_LENGTH_STATUS_OK,
+		"Increase the length of a real dynamic array field with current element fields");
+	bt_field_real_double_precision_set_value(
+		bt_field_array_borrow_element_field_by_index(fields->double_seq,
+			G_N_ELEMENTS(double_values)), 3.5);
+	bt_field_real_double_precision_set_value(
+		bt_field_array_borrow_element_field_by_index(fields->double_seq,
+			G_N_ELEMENTS(double_values) + 1), -4.25);
+	borrowed_values = bt_field_array_borrow_real_element_values_const(
+		fields->double_seq);
+	ok(memcmp(borrowed_values, double_values,
+			sizeof(double_values)) == 0 &&
+		borrowed_values[G_N_ELEMENTS(double_values)] == 3.5 &&
+		borrowed_values[G_N_ELEMENTS(double_values) + 1] == -4.25,
+		"Borrowed real element values include the element fields added by a length increase");
+}
+
+static
+void test_array_field_values(bt_self_component_source *self_comp)
+{
+	bt_trace_class *tc;
+	bt_stream_class *sc;
+	bt_field_class *pc_fc;
+	bt_trace *trace;
+	bt_stream *stream;
+	bt_packet *packet;
+	bt_field *pc_field;
+	struct fields fields;
+	int ret;
+
+	tc = bt_trace_class_create(
+		bt_self_component_source_as_self_component(self_comp));
+	BT_ASSERT(tc);
+	sc = bt_stream_class_create(tc);
+	BT_ASSERT(sc);
+	bt_stream_class_set_supports_packets(sc, BT_TRUE, BT_FALSE, BT_FALSE);
+	pc_fc = create_packet_context_fc(tc);
+	ret = bt_stream_class_set_packet_context_field_class(sc, pc_fc);
+	BT_ASSERT(ret == 0);
+	trace = bt_trace_create(tc);
+	BT_ASSERT(trace);
+	stream = bt_stream_create(sc, trace);
+	BT_ASSERT(stream);
+	packet = bt_packet_create(stream);
+	BT_ASSERT(packet);
+	pc_field = bt_packet_borrow_context_field(packet);
+	BT_ASSERT(pc_field);
+
+	fields.uint8_array = bt_field_structure_borrow_member_field_by_name(
+		pc_field, "uint8-array");
+	fields.sint32_seq = bt_field_structure_borrow_member_field_by_name(
+		pc_field, "sint32-seq");
+	fields.float_array = bt_field_structure_borrow_member_field_by_name(
+		pc_field, "float-array");
+	fields.double_seq = bt_field_structure_borrow_member_field_by_name(
+		pc_field, "double-seq");
+	BT_ASSERT(fields.uint8_array && fields.sint32_seq &&
+		fields.float_array && fields.double_seq);
+
+	test_unsigned_integer_elements(&fields);
+	test_signed_integer_elements(&fields);
+	test_real_elements(&fields);
+
+	ok(bt_field_array_get_length(fields.uint8_array) == 4,
+		"Static array field keeps its length");
+
+	bt_packet_put_ref(packet);
+	bt_stream_put_ref(stream);
+	bt_trace_put_ref(trace);
+	bt_field_class_put_ref(pc_fc);
+	bt_stream_class_put_ref(sc);
+	bt_trace_class_put_ref(tc);
+}
+
+static
+bt_component_class_initialize_method_status src_init(
+	bt_self_component_source *self_comp,
+	bt_self_component_source_configuration *config,
+	const bt_value *params, void *init_method_data)
+{
+	test_array_field_values(self_comp);
+	return BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_OK;
+}
+
+static
+bt_message_iterator_class_next_method_status src_iter_next(
+		bt_self_message_iterator *self_iterator,
+		bt_message_array_const msgs, uint64_t capacity,
+		uint64_t *count)
+{
+	return BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_ERROR;
+}
+
+static
+void test_array_field_values_in_graph(void)
+{
+	bt_message_iterator_class *msg_iter_cls;
+	bt_component_class_source *comp_cls;
+	bt_graph *graph;
+	int ret;
+
+	msg_iter_cls = bt_message_iterator_class_create(src_iter_next);
+	BT_ASSERT(msg_iter_cls);
+	comp_cls = bt_component_class_source_create("src", msg_iter_cls);
+	BT_ASSERT(comp_cls);
+	ret = bt_component_class_source_set_initialize_method(comp_cls,
+		src_init);
+	BT_ASSERT(ret == 0);
+	graph = bt_graph_create(0);
+	BT_ASSERT(graph);
+	ret = bt_graph_add_source_component(graph, comp_cls, "src-comp",
+		NULL, BT_LOGGING_LEVEL_NONE, NULL);
+	BT_ASSERT(ret == 0);
+	bt_graph_put_ref(graph);
+	bt_component_class_source_put_ref(comp_cls);
+	bt_message_iterator_class_put_ref(msg_iter_cls);
+}
+
+int main(void)
+{
+	plan_tests(NR_TESTS);
+	test_array_field_values_in_graph();
+	return exit_status();
+}
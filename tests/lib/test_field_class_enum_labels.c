@@ -0,0 +1,268 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ * Copyright (C) 2023 EfficiOS Inc.
+ *
+ * Enumeration field class mapping label lookup test
+ */
+
+#include <babeltrace2/babeltrace.h>
+#include "common/assert.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "tap/tap.h"
+
+#define NR_TESTS 26
+
+/*
+ * Returns whether or not the labels of the mappings of `fc` which
+ * contain `value` are exactly the `NULL`-terminated labels `expected`,
+ * in this order.
+ */
+static
+bool labels_are(const bt_field_class *fc, uint64_t value,
+		const char * const *expected)
+{
+	bt_field_class_enumeration_get_mapping_labels_for_value_status status;
+	bt_field_class_enumeration_mapping_label_array labels;
+	uint64_t count;
+	uint64_t i;
+
+	if (bt_field_class_get_type(fc) ==
+			BT_FIELD_CLASS_TYPE_SIGNED_ENUMERATION) {
+		status = bt_field_class_enumeration_signed_get_mapping_labels_for_value(
+			fc, (int64_t) value, &labels, &count);
+	} else {
+		status = bt_field_class_enumeration_unsigned_get_mapping_labels_for_value(
+			fc, value, &labels, &count);
+	}
+
+	BT_ASSERT(status ==
+		BT_FIELD_CLASS_ENUMERATION_GET_MAPPING_LABELS_BY_VALUE_STATUS_OK);
+
+	for (i = 0; i < count; i++) {
+		if (!expected[i] || strcmp(labels[i], expected[i]) != 0) {
+			return false;
+		}
+	}
+
+	return !expected[count];
+}
+
+static
+void add_unsigned_mapping(bt_field_class *fc, const char *label,
+		const uint64_t *bounds, uint64_t range_count)
+{
+	bt_integer_range_set_unsigned *ranges;
+	uint64_t i;
+	int ret;
+
+	ranges = bt_integer_range_set_unsigned_create();
+	BT_ASSERT(ranges);
+
+	for (i = 0; i < range_count; i++) {
+		ret = bt_integer_range_set_unsigned_add_range(ranges,
+			bounds[i * 2], bounds[i * 2 + 1]);
+		BT_ASSERT(ret == 0);
+	}
+
+	ret = bt_field_class_enumeration_unsigned_add_mapping(fc, label,
+		ranges);
+	BT_ASSERT(ret == 0);
+	bt_integer_range_set_unsigned_put_ref(ranges);
+}
+
+static
+void add_signed_mapping(bt_field_class *fc, const char *label,
+		int64_t lower, int64_t upper)
+{
+	bt_integer_range_set_signed *ranges;
+	int ret;
+
+	ranges = bt_integer_range_set_signed_create();
+	BT_ASSERT(ranges);
+	ret = bt_integer_range_set_signed_add_range(ranges, lower, upper);
+	BT_ASSERT(ret == 0);
+	ret = bt_field_class_enumeration_signed_add_mapping(fc, label,
+		ranges);
+	BT_ASSERT(ret == 0);
+	bt_integer_range_set_signed_put_ref(ranges);
+}
+
+/*
+ * Makes `fc` part of the trace class `tc` as the only member of the
+ * payload field class of a new event class, which indexes its
+ * mappings.
+ */
+static
+void make_part_of_trace_class(bt_trace_class *tc, bt_field_class *fc)
+{
+	bt_stream_class *sc;
+	bt_event_class *ec;
+	bt_field_class *payload_fc;
+	int ret;
+
+	sc = bt_stream_class_create(tc);
+	BT_ASSERT(sc);
+	ec = bt_event_class_create(sc);
+	BT_ASSERT(ec);
+	payload_fc = bt_field_class_structure_create(tc);
+	BT_ASSERT(payload_fc);
+	ret = bt_field_class_structure_append_member(payload_fc, "enum", fc);
+	BT_ASSERT(ret == 0);
+	ret = bt_event_class_set_payload_field_class(ec, payload_fc);
+	BT_ASSERT(ret == 0);
+	bt_field_class_put_ref(payload_fc);
+	bt_event_class_put_ref(ec);
+	bt_stream_class_put_ref(sc);
+}
+
+static
+void check_unsigned_lookups(const bt_field_class *fc, const char *mode)
+{
+	ok(labels_are(fc, 0, (const char *[]) { "A", NULL }),
+		"Unsigned lookup finds the mapping at a lower bound (%s)",
+		mode);
+	ok(labels_are(fc, 5, (const char *[]) { "A", "B", NULL }),
+		"Unsigned lookup finds overlapping mappings (%s)", mode);
+	ok(labels_are(fc, 8, (const char *[]) { "A", "B", "D", NULL }),
+		"Unsigned lookup returns the labels in mapping order (%s)",
+		mode);
+	ok(labels_are(fc, 15, (const char *[]) { "B", "E", NULL }),
+		"Unsigned lookup finds a mapping by its second range (%s)",
+		mode);
+	ok(labels_are(fc, 50, (const char *[]) { NULL }),
+		"Unsigned lookup finds no mapping between ranges (%s)", mode);
+	ok(labels_are(fc, UINT64_MAX, (const char *[]) { "C", NULL }),
+		"Unsigned lookup finds the mapping of the maximum value (%s)",
+		mode);
+}
+
+static
+void test_unsigned(bt_trace_class *tc)
+{
+	bt_field_class *fc;
+	const uint64_t a_bounds[] = { 0, 10 };
+	const uint64_t b_bounds[] = { 5, 5, 8, 20 };
+	const uint64_t c_bounds[] = { 100, UINT64_MAX };
+	const uint64_t d_bounds[] = { 7, 9 };
+	const uint64_t e_bounds[] = { 15, 15 };
+
+	fc = bt_field_class_enumeration_unsigned_create(tc);
+	BT_ASSERT(fc);
+	ok(labels_are(fc, 0, (const char *[]) { NULL }),
+		"Unsigned enumeration field class without mappings has no labels");
+	add_unsigned_mapping(fc, "A", a_bounds, 1);
+	add_unsigned_mapping(fc, "B", b_bounds, 2);
+	add_unsigned_mapping(fc, "C", c_bounds, 1);
+	add_unsigned_mapping(fc, "D", d_bounds, 1);
+	ok(labels_are(fc, 15, (const char *[]) { "B", NULL }),
+		"Unsigned lookup finds a mapping before adding another one");
+
+	/* Adding a mapping after a lookup must update the next lookups */
+	add_unsigned_mapping(fc, "E", e_bounds, 1);
+	check_unsigned_lookups(fc, "scan");
+	make_part_of_trace_class(tc, fc);
+	check_unsigned_lookups(fc, "index");
+	bt_field_class_put_ref(fc);
+}
+
+static
+void check_signed_lookups(const bt_field_class *fc, const char *mode)
+{
+	ok(labels_are(fc, (uint64_t) INT64_MIN,
+		(const char *[]) { "NEG", NULL }),
+		"Signed lookup finds the mapping of the minimum value (%s)",
+		mode);
+	ok(labels_are(fc, (uint64_t) INT64_C(-3),
+		(const char *[]) { "NEG", "SMALL", NULL }),
+		"Signed lookup finds overlapping mappings of a negative value (%s)",
+		mode);
+	ok(labels_are(fc, 0, (const char *[]) { "ZERO", "SMALL", NULL }),
+		"Signed lookup returns the labels in mapping order (%s)",
+		mode);
+	ok(labels_are(fc, 5, (const char *[]) { "SMALL", NULL }),
+		"Signed lookup finds the mapping at an upper bound (%s)",
+		mode);
+	ok(labels_are(fc, 6, (const char *[]) { NULL }),
+		"Signed lookup finds no mapping after the last range (%s)",
+		mode);
+	ok(labels_are(fc, (uint64_t) INT64_MAX, (const char *[]) { NULL }),
+		"Signed lookup finds no mapping for the maximum value (%s)",
+		mode);
+}
+
+static
+void test_signed(bt_trace_class *tc)
+{
+	bt_field_class *fc;
+
+	fc = bt_field_class_enumeration_signed_create(tc);
+	BT_ASSERT(fc);
+	add_signed_mapping(fc, "NEG", INT64_MIN, -1);
+	add_signed_mapping(fc, "ZERO", 0, 0);
+	add_signed_mapping(fc, "SMALL", -5, 5);
+	check_signed_lookups(fc, "scan");
+	make_part_of_trace_class(tc, fc);
+	check_signed_lookups(fc, "index");
+	bt_field_class_put_ref(fc);
+}
+
+static
+bt_component_class_initialize_method_status src_init(
+	bt_self_component_source *self_comp,
+	bt_self_component_source_configuration *config,
+	const bt_value *params, void *init_method_data)
+{
+	bt_trace_class *tc;
+
+	tc = bt_trace_class_create(
+		bt_self_component_source_as_self_component(self_comp));
+	BT_ASSERT(tc);
+	test_unsigned(tc);
+	test_signed(tc);
+	bt_trace_class_put_ref(tc);
+	return BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_OK;
+}
+
+static
+bt_message_iterator_class_next_method_status src_iter_next(
+		bt_self_message_iterator *self_iterator,
+		bt_message_array_const msgs, uint64_t capacity,
+		uint64_t *count)
+{
+	return BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_ERROR;
+}
+
+static
+void test_enum_labels_in_graph(void)
+{
+	bt_message_iterator_class *msg_iter_cls;
+	bt_component_class_source *comp_cls;
+	bt_graph *graph;
+	int ret;
+
+	msg_iter_cls = bt_message_iterator_class_create(src_iter_next);
+	BT_ASSERT(msg_iter_cls);
+	comp_cls = bt_component_class_source_create("src", msg_iter_cls);
+	BT_ASSERT(comp_cls);
+	ret = bt_component_class_source_set_initialize_method(comp_cls,
+		src_init);
+	BT_ASSERT(ret == 0);
+	graph = bt_graph_create(0);
+	BT_ASSERT(graph);
+	ret = bt_graph_add_source_component(graph, comp_cls, "src-comp",
+		NULL, BT_LOGGING_LEVEL_NONE, NULL);
+	BT_ASSERT(ret == 0);
+	bt_graph_put_ref(graph);
+	bt_component_class_source_put_ref(comp_cls);
+	bt_message_iterator_class_put_ref(msg_iter_cls);
+}
+
+int main(void)
+{
+	plan_tests(NR_TESTS);
+	test_enum_labels_in_graph();
+	return exit_status();
+}
@@ -0,0 +1,219 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ * Copyright (C) 2023 EfficiOS Inc.
+ *
+ * Graph message pool memory budget test
+ */
+
+#include <babeltrace2/babeltrace.h>
+#include "common/assert.h"
+#include <glib.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include "tap/tap.h"
+#include "test-graph.h"
+
+#define NR_TESTS	11
+
+/* Number of event messages which the source emits */
+#define EVENT_MSG_COUNT	1000
+
+struct src_iter_data {
+	bt_trace *trace;
+	bt_stream *stream;
+
+	/*
+	 * Number of emitted messages, including the stream beginning
+	 * and end messages
+	 */
+	uint64_t msg_count;
+};
+
+struct pool_stats {
+	uint64_t allocation_count;
+	uint64_t reuse_count;
+	uint64_t discard_count;
+	uint64_t mem_size;
+};
+
+static
+bt_message_iterator_class_initialize_method_status src_iter_init(
+		bt_self_message_iterator *self_msg_iter,
+		bt_self_message_iterator_configuration *config,
+		bt_self_component_port_output *port)
+{
+	struct test_graph_src_data *data = bt_self_component_get_data(
+		bt_self_message_iterator_borrow_component(self_msg_iter));
+	struct src_iter_data *iter_data = g_new0(struct src_iter_data, 1);
+
+	BT_ASSERT(iter_data);
+	iter_data->trace = bt_trace_create(data->tc);
+	BT_ASSERT(iter_data->trace);
+	iter_data->stream = bt_stream_create(data->sc, iter_data->trace);
+	BT_ASSERT(iter_data->stream);
+	bt_self_message_iterator_set_data(self_msg_iter, iter_data);
+	return BT_MESSAGE_ITERATOR_CLASS_INITIALIZE_METHOD_STATUS_OK;
+}
+
+static
+void src_iter_finalize(bt_self_message_iterator *self_msg_iter)
+{
+	struct src_iter_data *iter_data =
+		bt_self_message_iterator_get_data(self_msg_iter);
+
+	bt_stream_put_ref(iter_data->stream);
+	bt_trace_put_ref(iter_data->trace);
+	g_free(iter_data);
+}
+
+static
+bt_message_iterator_class_next_method_status src_iter_next(
+		bt_self_message_iterator *self_msg_iter,
+		bt_message_array_const msgs, uint64_t capacity,
+		uint64_t *count)
+{
+	struct src_iter_data *iter_data =
+		bt_self_message_iterator_get_data(self_msg_iter);
+	struct test_graph_src_data *data = bt_self_component_get_data(
+		bt_self_message_iterator_borrow_component(self_msg_iter));
+
+	if (iter_data->msg_count == EVENT_MSG_COUNT + 2) {
+		return BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_END;
+	}
+
+	*count = 0;
+
+	while (*count < capacity && iter_data->msg_count < EVENT_MSG_COUNT + 2) {
+		if (iter_data->msg_count == 0) {
+			msgs[*count] = bt_message_stream_beginning_create(
+				self_msg_iter, iter_data->stream);
+		} else if (iter_data->msg_count == EVENT_MSG_COUNT + 1) {
+			msgs[*count] = bt_message_stream_end_create(
+				self_msg_iter, iter_data->stream);
+		} else {
+			msgs[*count] = bt_message_event_create(self_msg_iter,
+				data->ec, iter_data->stream);
+		}
+
+		BT_ASSERT(msgs[*count]);
+		(*count)++;
+		iter_data->msg_count++;
+	}
+
+	return BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK;
+}
+
+static const struct test_graph_src_methods src_methods = {
+	.next = src_iter_next,
+	.init = src_iter_init,
+	.finalize = src_iter_finalize,
+};
+
+/*
+ * Runs a graph of which the message pool memory budget is `budget`
+ * (`UINT64_MAX` means the default budget) and sets `*stats` to its
+ * message pool statistics at the end of the run.
+ *
+ * The simple sink puts the messages, which recycles the event
+ * messages.
+ */
+static
+bt_graph_run_status run_graph(uint64_t budget, struct pool_stats *stats)
+{
+	bt_graph *graph;
+	bt_graph_run_status run_status;
+
+	graph = test_graph_create(&src_methods, NULL, NULL, NULL, NULL);
+
+	if (budget != UINT64_MAX) {
+		bt_graph_set_message_pool_memory_budget(graph, budget);
+	}
+
+	run_status = test_graph_run(graph);
+	bt_graph_get_message_pool_statistics(graph, &stats->allocation_count,
+		&stats->reuse_count, &stats->discard_count);
+	stats->mem_size = bt_graph_get_message_pool_memory_size(graph);
+	bt_graph_put_ref(graph);
+	return run_status;
+}
+
+static
+void test_budget_accessors(void)
+{
+	bt_graph *graph = bt_graph_create(0);
+
+	BT_ASSERT(graph);
+	bt_graph_set_message_pool_memory_budget(graph, 4096);
+	ok(bt_graph_get_message_pool_memory_budget(graph) == 4096,
+		"bt_graph_get_message_pool_memory_budget() returns the set budget");
+	bt_graph_put_ref(graph);
+}
+
+/*
+ * Runs a graph with the default budget and returns the resulting
+ * message pool memory size.
+ */
+static
+uint64_t test_no_budget(void)
+{
+	struct pool_stats stats;
+	bt_graph_run_status run_status;
+
+	run_status = run_graph(UINT64_MAX, &stats);
+	ok(run_status == BT_GRAPH_RUN_STATUS_OK,
+		"Graph runs to the end without a message pool memory budget");
+	ok(stats.allocation_count + stats.reuse_count == EVENT_MSG_COUNT &&
+		stats.reuse_count > 0,
+		"Graph reuses pooled event messages without a budget");
+	ok(stats.discard_count == 0,
+		"Graph discards no message without a budget");
+	ok(stats.mem_size > 0,
+		"Message pools keep the recycled messages without a budget");
+	return stats.mem_size;
+}
+
+static
+void test_zero_budget(void)
+{
+	struct pool_stats stats;
+	bt_graph_run_status run_status;
+
+	run_status = run_graph(0, &stats);
+	ok(run_status == BT_GRAPH_RUN_STATUS_OK,
+		"Graph runs to the end with a message pool memory budget of 0");
+	ok(stats.allocation_count == EVENT_MSG_COUNT &&
+		stats.reuse_count == 0,
+		"Graph allocates all the event messages with a budget of 0");
+	ok(stats.discard_count == EVENT_MSG_COUNT && stats.mem_size == 0,
+		"Graph discards all the event messages with a budget of 0");
+}
+
+static
+void test_partial_budget(uint64_t budget)
+{
+	struct pool_stats stats;
+	bt_graph_run_status run_status;
+
+	run_status = run_graph(budget, &stats);
+	ok(run_status == BT_GRAPH_RUN_STATUS_OK,
+		"Graph runs to the end with a partial message pool memory budget");
+	ok(stats.reuse_count > 0 && stats.discard_count > 0,
+		"Graph reuses some messages and discards others with a partial budget");
+	ok(stats.mem_size > 0 && stats.mem_size <= budget,
+		"Message pool memory size is within the budget");
+}
+
+int main(void)
+{
+	uint64_t mem_size;
+
+	plan_tests(NR_TESTS);
+	test_budget_accessors();
+	mem_size = test_no_budget();
+	test_zero_budget();
+
+	/* Only keep about half of the peak number of pooled messages */
+	test_partial_budget(mem_size / 2);
+	return exit_status();
+}
@@ -0,0 +1,237 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ * Copyright (C) 2023 EfficiOS Inc.
+ *
+ * Graph performance statistics test
+ */
+
+#include <babeltrace2/babeltrace.h>
+#include "common/assert.h"
+#include <glib.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <string.h>
+#include "tap/tap.h"
+#include "test-graph.h"
+
+#define NR_TESTS 12
+
+/* Number of messages which the source emits */
+#define MSG_COUNT	1000
+
+/* Message batch size of the graph */
+#define MSG_BATCH_SIZE	16
+
+struct src_iter_data {
+	uint64_t next_value;
+	bool returned_again;
+};
+
+static
+bt_message_iterator_class_initialize_method_status src_iter_init(
+		bt_self_message_iterator *self_msg_iter,
+		bt_self_message_iterator_configuration *config,
+		bt_self_component_port_output *port)
+{
+	struct src_iter_data *data = g_new0(struct src_iter_data, 1);
+
+	BT_ASSERT(data);
+	bt_self_message_iterator_set_data(self_msg_iter, data);
+	return BT_MESSAGE_ITERATOR_CLASS_INITIALIZE_METHOD_STATUS_OK;
+}
+
+static
+void src_iter_finalize(bt_self_message_iterator *self_msg_iter)
+{
+	g_free(bt_self_message_iterator_get_data(self_msg_iter));
+}
+
+/*
+ * Returns "try again" once before the first batch, and then returns
+ * `MSG_COUNT` messages in batches of half the capacity.
+ */
+static
+bt_message_iterator_class_next_method_status src_iter_next(
+		bt_self_message_iterator *self_msg_iter,
+		bt_message_array_const msgs, uint64_t capacity,
+		uint64_t *count)
+{
+	struct src_iter_data *iter_data =
+		bt_self_message_iterator_get_data(self_msg_iter);
+	struct test_graph_src_data *data = bt_self_component_get_data(
+		bt_self_message_iterator_borrow_component(self_msg_iter));
+
+	if (!iter_data->returned_again) {
+		iter_data->returned_again = true;
+		return BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_AGAIN;
+	}
+
+	if (iter_data->next_value == MSG_COUNT) {
+		return BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_END;
+	}
+
+	*count = 0;
+
+	while (*count < capacity / 2 && iter_data->next_value < MSG_COUNT) {
+		msgs[*count] = bt_message_message_iterator_inactivity_create(
+			self_msg_iter, data->cc, iter_data->next_value);
+		BT_ASSERT(msgs[*count]);
+		(*count)++;
+		iter_data->next_value++;
+	}
+
+	return BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK;
+}
+
+static const struct test_graph_src_methods src_methods = {
+	.next = src_iter_next,
+	.init = src_iter_init,
+	.finalize = src_iter_finalize,
+};
+
+/*
+ * Runs a graph of which the source is connected to a simple sink, with
+ * or without performance statistics, and returns its performance
+ * statistics.
+ */
+static
+bt_value *run_graph(bool enable_stats)
+{
+	bt_graph *graph;
+	bt_graph_run_status run_status;
+	bt_graph_get_performance_statistics_status stats_status;
+	bt_value *stats;
+
+	graph = test_graph_create(&src_methods, NULL, NULL, NULL, NULL);
+	bt_graph_set_message_batch_size(graph, MSG_BATCH_SIZE);
+
+	if (enable_stats) {
+		bt_graph_enable_performance_statistics(graph);
+	}
+
+	run_status = test_graph_run(graph);
+	BT_ASSERT(run_status == BT_GRAPH_RUN_STATUS_OK);
+	stats_status = bt_graph_get_performance_statistics(graph, &stats);
+	BT_ASSERT(stats_status == BT_GRAPH_GET_PERFORMANCE_STATISTICS_STATUS_OK);
+	bt_graph_put_ref(graph);
+	return stats;
+}
+
+static
+uint64_t get_counter(const bt_value *stats, const char *key)
+{
+	const bt_value *value = bt_value_map_borrow_entry_value_const(stats,
+		key);
+
+	BT_ASSERT(value);
+	return bt_value_integer_unsigned_get(value);
+}
+
+/*
+ * Borrows the map value of the component named `name` from the
+ * performance statistics `stats`.
+ */
+static
+const bt_value *borrow_comp_stats(const bt_value *stats, const char *name)
+{
+	const bt_value *comps = bt_value_map_borrow_entry_value_const(stats,
+		"components");
+	uint64_t i;
+
+	BT_ASSERT(comps);
+
+	for (i = 0; i < bt_value_array_get_length(comps); i++) {
+		const bt_value *comp =
+			bt_value_array_borrow_element_by_index_const(comps, i);
+
+		if (strcmp(bt_value_string_get(
+				bt_value_map_borrow_entry_value_const(comp,
+					"name")), name) == 0) {
+			return comp;
+		}
+	}
+
+	return NULL;
+}
+
+static
+void test_enabled(void)
+{
+	bt_value *stats = run_graph(true);
+	const bt_value *src_stats = borrow_comp_stats(stats, "src-comp");
+	const bt_value *sink_stats = borrow_comp_stats(stats, "sink-comp");
+	const bt_value *ports;
+	const bt_value *next_stats;
+	const bt_value *consume_stats;
+
+	ok(src_stats && sink_stats,
+		"Performance statistics contain all the components");
+	BT_ASSERT(src_stats && sink_stats);
+	ok(!bt_value_map_has_entry(src_stats, "consume") &&
+		bt_value_map_has_entry(sink_stats, "consume"),
+		"Only the sink component has \"consume\" method statistics");
+	ports = bt_value_map_borrow_entry_value_const(src_stats,
+		"output-ports");
+	BT_ASSERT(ports);
+	ok(bt_value_array_get_length(ports) == 1 &&
+		strcmp(bt_value_string_get(
+			bt_value_map_borrow_entry_value_const(
+				bt_value_array_borrow_element_by_index_const(
+					ports, 0), "name")), "out") == 0,
+		"Performance statistics contain the source's output port");
+	next_stats = bt_value_map_borrow_entry_value_const(
+		bt_value_array_borrow_element_by_index_const(ports, 0), "next");
+	BT_ASSERT(next_stats);
+	ok(get_counter(next_stats, "message-count") == MSG_COUNT,
+		"\"next\" method statistics count all the messages");
+	ok(get_counter(next_stats, "again-count") == 1,
+		"\"next\" method statistics count the \"try again\" status");
+
+	/* Message batches, one "try again", and the end */
+	ok(get_counter(next_stats, "call-count") ==
+		(MSG_COUNT + MSG_BATCH_SIZE / 2 - 1) / (MSG_BATCH_SIZE / 2) + 2,
+		"\"next\" method statistics count all the calls");
+	ok(get_counter(next_stats, "capacity") ==
+		get_counter(next_stats, "message-count") * 2,
+		"\"next\" method statistics give a batch fill ratio of 50 %%");
+	ok(get_counter(next_stats, "exclusive-time-ns") <=
+		get_counter(next_stats, "inclusive-time-ns") &&
+		get_counter(next_stats, "inclusive-time-ns") > 0,
+		"\"next\" method exclusive time is within its inclusive time");
+	consume_stats = bt_value_map_borrow_entry_value_const(sink_stats,
+		"consume");
+	ok(get_counter(consume_stats, "call-count") >=
+		get_counter(next_stats, "call-count") &&
+		get_counter(consume_stats, "again-count") == 1,
+		"\"consume\" method statistics count all the calls");
+	ok(get_counter(consume_stats, "inclusive-time-ns") >=
+		get_counter(next_stats, "inclusive-time-ns"),
+		"\"consume\" method inclusive time includes the upstream \"next\" method time");
+	ok(get_counter(consume_stats, "exclusive-time-ns") <=
+		get_counter(consume_stats, "inclusive-time-ns") -
+			get_counter(next_stats, "inclusive-time-ns"),
+		"\"consume\" method exclusive time excludes the upstream \"next\" method time");
+	bt_value_put_ref(stats);
+}
+
+static
+void test_disabled(void)
+{
+	bt_value *stats = run_graph(false);
+	const bt_value *sink_stats = borrow_comp_stats(stats, "sink-comp");
+
+	BT_ASSERT(sink_stats);
+	ok(get_counter(bt_value_map_borrow_entry_value_const(sink_stats,
+		"consume"), "call-count") == 0,
+		"Graph doesn't collect performance statistics by default");
+	bt_value_put_ref(stats);
+}
+
+int main(void)
+{
+	plan_tests(NR_TESTS);
+	test_enabled();
+	test_disabled();
+	return exit_status();
+}
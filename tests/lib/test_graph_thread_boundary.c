@@ -0,0 +1,371 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ * Copyright (C) 2023 EfficiOS Inc.
+ *
+ * Thread boundary connection test
+ */
+
+#include <babeltrace2/babeltrace.h>
+#include "common/assert.h"
+#include <glib.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <string.h>
+#include "tap/tap.h"
+#include "test-graph.h"
+
+#define NR_TESTS 17
+
+/* Behaviour of the source component */
+struct src_config {
+	/* Number of messages to emit before ending */
+	uint64_t msg_count;
+
+	/* Index of the message at which to fail, or `UINT64_MAX` */
+	uint64_t error_at;
+
+	/* Return "again" before each batch */
+	bool again;
+};
+
+struct src_iter_data {
+	uint64_t next_value;
+	bool returned_again;
+};
+
+struct sink_data {
+	/* Graph which the sink interrupts */
+	bt_graph *graph;
+
+	/*
+	 * Number of messages after which to make the message iterator
+	 * seek its beginning, or to interrupt the graph, once (0 means
+	 * never).
+	 */
+	uint64_t seek_after;
+	uint64_t interrupt_after;
+
+	uint64_t msg_count;
+
+	/* Expected clock snapshot value of the next message */
+	uint64_t next_value;
+
+	bool in_order;
+
+	/* Number of messages when seeking */
+	uint64_t seek_msg_count;
+
+	bool can_seek;
+	bool seek_ok;
+};
+
+/* Threads on which the source's seeking methods last ran */
+static GThread *src_seek_thread;
+static GThread *src_can_seek_thread;
+
+static
+bt_message_iterator_class_initialize_method_status src_iter_init(
+		bt_self_message_iterator *self_msg_iter,
+		bt_self_message_iterator_configuration *config,
+		bt_self_component_port_output *port)
+{
+	struct src_iter_data *data = g_new0(struct src_iter_data, 1);
+
+	BT_ASSERT(data);
+	bt_self_message_iterator_set_data(self_msg_iter, data);
+	return BT_MESSAGE_ITERATOR_CLASS_INITIALIZE_METHOD_STATUS_OK;
+}
+
+static
+void src_iter_finalize(bt_self_message_iterator *self_msg_iter)
+{
+	g_free(bt_self_message_iterator_get_data(self_msg_iter));
+}
+
+static
+bt_message_iterator_class_seek_beginning_method_status src_iter_seek_beginning(
+		bt_self_message_iterator *self_msg_iter)
+{
+	struct src_iter_data *iter_data =
+		bt_self_message_iterator_get_data(self_msg_iter);
+
+	src_seek_thread = g_thread_self();
+	iter_data->next_value = 0;
+	iter_data->returned_again = false;
+	return BT_MESSAGE_ITERATOR_CLASS_SEEK_BEGINNING_METHOD_STATUS_OK;
+}
+
+static
+bt_message_iterator_class_can_seek_beginning_method_status
+src_iter_can_seek_beginning(bt_self_message_iterator *self_msg_iter,
+		bt_bool *can_seek)
+{
+	src_can_seek_thread = g_thread_self();
+	*can_seek = BT_TRUE;
+	return BT_MESSAGE_ITERATOR_CLASS_CAN_SEEK_BEGINNING_METHOD_STATUS_OK;
+}
+
+static
+bt_message_iterator_class_next_method_status src_iter_next(
+		bt_self_message_iterator *self_msg_iter,
+		bt_message_array_const msgs, uint64_t capacity,
+		uint64_t *count)
+{
+	struct src_iter_data *iter_data =
+		bt_self_message_iterator_get_data(self_msg_iter);
+	struct test_graph_src_data *data = bt_self_component_get_data(
+		bt_self_message_iterator_borrow_component(self_msg_iter));
+	const struct src_config *config = data->config;
+
+	if (config->again && !iter_data->returned_again) {
+		iter_data->returned_again = true;
+		return BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_AGAIN;
+	}
+
+	iter_data->returned_again = false;
+
+	if (iter_data->next_value == config->error_at) {
+		BT_CURRENT_THREAD_ERROR_APPEND_CAUSE_FROM_MESSAGE_ITERATOR(
+			self_msg_iter, "Source failed at message %" PRIu64,
+			iter_data->next_value);
+		return BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_ERROR;
+	}
+
+	if (iter_data->next_value == config->msg_count) {
+		return BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_END;
+	}
+
+	*count = 0;
+
+	while (*count < capacity &&
+			iter_data->next_value < config->msg_count &&
+			iter_data->next_value != config->error_at) {
+		msgs[*count] = bt_message_message_iterator_inactivity_create(
+			self_msg_iter, data->cc, iter_data->next_value);
+		BT_ASSERT(msgs[*count]);
+		(*count)++;
+		iter_data->next_value++;
+	}
+
+	return BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK;
+}
+
+static
+bt_graph_simple_sink_component_consume_func_status sink_consume(
+		bt_message_iterator *msg_iter, void *user_data)
+{
+	struct sink_data *data = user_data;
+	bt_graph_simple_sink_component_consume_func_status status;
+	bt_message_array_const msgs;
+	uint64_t count;
+	uint64_t i;
+
+	status = test_graph_sink_next(msg_iter, &msgs, &count);
+	if (status != BT_GRAPH_SIMPLE_SINK_COMPONENT_CONSUME_FUNC_STATUS_OK) {
+		return status;
+	}
+
+	for (i = 0; i < count; i++) {
+		const bt_clock_snapshot *cs =
+			bt_message_message_iterator_inactivity_borrow_clock_snapshot_const(
+				msgs[i]);
+
+		if (bt_clock_snapshot_get_value(cs) != data->next_value) {
+			data->in_order = false;
+		}
+
+		data->msg_count++;
+		data->next_value++;
+		bt_message_put_ref(msgs[i]);
+	}
+
+	if (data->seek_after > 0 && data->msg_count >= data->seek_after) {
+		bt_bool can_seek = BT_FALSE;
+
+		data->seek_after = 0;
+		data->seek_msg_count = data->msg_count;
+		data->can_seek = bt_message_iterator_can_seek_beginning(
+			msg_iter, &can_seek) ==
+				BT_MESSAGE_ITERATOR_CAN_SEEK_BEGINNING_STATUS_OK &&
+			can_seek;
+		data->seek_ok = bt_message_iterator_seek_beginning(msg_iter) ==
+			BT_MESSAGE_ITERATOR_SEEK_BEGINNING_STATUS_OK;
+		data->next_value = 0;
+	}
+
+	if (data->interrupt_after > 0 &&
+			data->msg_count >= data->interrupt_after) {
+		data->interrupt_after = 0;
+		bt_interrupter_set(
+			bt_graph_borrow_default_interrupter(data->graph));
+	}
+
+	return BT_GRAPH_SIMPLE_SINK_COMPONENT_CONSUME_FUNC_STATUS_OK;
+}
+
+static const struct test_graph_src_methods src_methods = {
+	.next = src_iter_next,
+	.init = src_iter_init,
+	.finalize = src_iter_finalize,
+	.seek_beginning = src_iter_seek_beginning,
+	.can_seek_beginning = src_iter_can_seek_beginning,
+};
+
+/*
+ * Creates a graph of which the only connection, from the source to a
+ * simple sink, is a thread boundary with a queue capacity of
+ * `queue_capacity` messages.
+ */
+static
+bt_graph *create_graph(const struct src_config *src_config,
+		uint64_t queue_capacity, struct sink_data *sink_data)
+{
+	const bt_connection *conn;
+	bt_graph *graph;
+
+	graph = test_graph_create(&src_methods, src_config, sink_consume,
+		sink_data, &conn);
+
+	/* Make the source return smaller batches than the queue */
+	bt_graph_set_message_batch_size(graph, 4);
+	bt_graph_make_connection_thread_boundary(graph, conn, queue_capacity);
+	sink_data->graph = graph;
+	sink_data->in_order = true;
+	return graph;
+}
+
+static
+bt_graph_run_status run_graph(const struct src_config *src_config,
+		uint64_t queue_capacity, struct sink_data *sink_data)
+{
+	bt_graph *graph = create_graph(src_config, queue_capacity, sink_data);
+	bt_graph_run_status run_status;
+
+	run_status = test_graph_run(graph);
+	bt_graph_put_ref(graph);
+	return run_status;
+}
+
+static
+void test_messages(uint64_t queue_capacity, bool again)
+{
+	const struct src_config src_config = {
+		.msg_count = 1000,
+		.error_at = UINT64_MAX,
+		.again = again,
+	};
+	struct sink_data sink_data = { 0 };
+	bt_graph_run_status run_status;
+
+	run_status = run_graph(&src_config, queue_capacity, &sink_data);
+	ok(run_status == BT_GRAPH_RUN_STATUS_OK,
+		"Graph runs to the end through a thread boundary (queue capacity %" PRIu64 ", again: %d)",
+		queue_capacity, again);
+	ok(sink_data.msg_count == src_config.msg_count,
+		"Sink gets all the messages (queue capacity %" PRIu64 ", again: %d)",
+		queue_capacity, again);
+	ok(sink_data.in_order,
+		"Sink gets the messages in order (queue capacity %" PRIu64 ", again: %d)",
+		queue_capacity, again);
+}
+
+static
+void test_error(void)
+{
+	const struct src_config src_config = {
+		.msg_count = 1000,
+		.error_at = 250,
+		.again = false,
+	};
+	struct sink_data sink_data = { 0 };
+	bt_graph_run_status run_status;
+	const bt_error *error;
+	bool found_cause = false;
+	uint64_t i;
+
+	run_status = run_graph(&src_config, 16, &sink_data);
+	ok(run_status == BT_GRAPH_RUN_STATUS_ERROR,
+		"Graph fails when the source fails beyond a thread boundary");
+	ok(sink_data.msg_count == src_config.error_at && sink_data.in_order,
+		"Sink gets all the messages preceding the error, in order");
+	error = bt_current_thread_take_error();
+	BT_ASSERT(error);
+
+	for (i = 0; i < bt_error_get_cause_count(error); i++) {
+		const bt_error_cause *cause =
+			bt_error_borrow_cause_by_index(error, i);
+
+		if (strstr(bt_error_cause_get_message(cause),
+				"Source failed at message 250")) {
+			found_cause = true;
+		}
+	}
+
+	ok(found_cause,
+		"Source's error cause reaches the sink's thread");
+	bt_error_release(error);
+}
+
+static
+void test_seek(void)
+{
+	const struct src_config src_config = {
+		.msg_count = 1000,
+		.error_at = UINT64_MAX,
+		.again = false,
+	};
+	struct sink_data sink_data = { 0 };
+	bt_graph_run_status run_status;
+
+	sink_data.seek_after = 100;
+	run_status = run_graph(&src_config, 64, &sink_data);
+	ok(run_status == BT_GRAPH_RUN_STATUS_OK && sink_data.can_seek,
+		"Sink can seek the beginning of a thread boundary message iterator");
+	ok(sink_data.seek_ok && sink_data.in_order &&
+		sink_data.msg_count ==
+			sink_data.seek_msg_count + src_config.msg_count,
+		"Sink gets all the messages again, in order, after seeking the beginning");
+	ok(src_can_seek_thread == g_thread_self() &&
+		src_seek_thread == g_thread_self(),
+		"Source's seeking methods run on the sink's thread");
+}
+
+static
+void test_interrupt(void)
+{
+	const struct src_config src_config = {
+		.msg_count = 1000,
+		.error_at = UINT64_MAX,
+		.again = false,
+	};
+	struct sink_data sink_data = { 0 };
+	bt_graph_run_status run_status;
+	bt_graph *graph;
+
+	sink_data.interrupt_after = 100;
+	graph = create_graph(&src_config, 64, &sink_data);
+	run_status = bt_graph_run(graph);
+	ok(run_status == BT_GRAPH_RUN_STATUS_AGAIN &&
+		sink_data.msg_count < src_config.msg_count,
+		"Graph stops when the sink interrupts it");
+	bt_interrupter_reset(bt_graph_borrow_default_interrupter(graph));
+	run_status = test_graph_run(graph);
+	ok(run_status == BT_GRAPH_RUN_STATUS_OK &&
+		sink_data.msg_count == src_config.msg_count &&
+		sink_data.in_order,
+		"Interrupted graph resumes without losing messages");
+	bt_graph_put_ref(graph);
+}
+
+int main(void)
+{
+	plan_tests(NR_TESTS);
+	test_messages(1, false);
+	test_messages(64, true);
+	test_messages(1024, false);
+	test_error();
+	test_seek();
+	test_interrupt();
+	return exit_status();
+}
@@ -0,0 +1,337 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ * Copyright (C) 2023 EfficiOS Inc.
+ *
+ * Message iterator wake-up file descriptor test
+ */
+
+#include <babeltrace2/babeltrace.h>
+#include "common/assert.h"
+#include "compat/glib.h"
+#include <glib.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include "tap/tap.h"
+#include "test-graph.h"
+
+#ifndef __MINGW32__
+# include <fcntl.h>
+# include <unistd.h>
+#endif
+
+#define NR_TESTS 11
+
+/* Number of inactivity messages which the source emits once ready */
+#define MSG_COUNT	10
+
+/* Long enough for a wait to be noticeable */
+#define SHORT_WAIT_US	200000	/* 200 ms */
+
+/* Way longer than any test wait */
+#define LONG_WAIT_US	30000000	/* 30 s */
+
+#ifndef __MINGW32__
+
+/* Behaviour of the source component */
+struct src_config {
+	/*
+	 * File descriptor from which the source reads one byte before
+	 * emitting its messages (its wake-up file descriptor)
+	 */
+	int fd;
+
+	/* True to set `fd` as the wake-up file descriptor */
+	bool set_wake_up_fd;
+};
+
+struct src_iter_data {
+	uint64_t next_value;
+	bool ready;
+};
+
+static
+bt_message_iterator_class_initialize_method_status src_iter_init(
+		bt_self_message_iterator *self_msg_iter,
+		bt_self_message_iterator_configuration *config,
+		bt_self_component_port_output *port)
+{
+	struct test_graph_src_data *data = bt_self_component_get_data(
+		bt_self_message_iterator_borrow_component(self_msg_iter));
+	struct src_iter_data *iter_data = g_new0(struct src_iter_data, 1);
+
+	const struct src_config *src_config = data->config;
+
+	BT_ASSERT(iter_data);
+
+	if (src_config->set_wake_up_fd) {
+		bt_self_message_iterator_set_wake_up_fd(self_msg_iter,
+			src_config->fd);
+	}
+
+	bt_self_message_iterator_set_data(self_msg_iter, iter_data);
+	return BT_MESSAGE_ITERATOR_CLASS_INITIALIZE_METHOD_STATUS_OK;
+}
+
+static
+void src_iter_finalize(bt_self_message_iterator *self_msg_iter)
+{
+	g_free(bt_self_message_iterator_get_data(self_msg_iter));
+}
+
+static
+bt_message_iterator_class_next_method_status src_iter_next(
+		bt_self_message_iterator *self_msg_iter,
+		bt_message_array_const msgs, uint64_t capacity,
+		uint64_t *count)
+{
+	struct src_iter_data *iter_data =
+		bt_self_message_iterator_get_data(self_msg_iter);
+	struct test_graph_src_data *data = bt_self_component_get_data(
+		bt_self_message_iterator_borrow_component(self_msg_iter));
+	const struct src_config *src_config = data->config;
+
+	if (!iter_data->ready) {
+		char byte;
+
+		/* Nonblocking file descriptor */
+		if (read(src_config->fd, &byte, 1) != 1) {
+			return BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_AGAIN;
+		}
+
+		iter_data->ready = true;
+	}
+
+	if (iter_data->next_value == MSG_COUNT) {
+		return BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_END;
+	}
+
+	*count = 0;
+
+	while (*count < capacity && iter_data->next_value < MSG_COUNT) {
+		msgs[*count] = bt_message_message_iterator_inactivity_create(
+			self_msg_iter, data->cc, iter_data->next_value);
+		BT_ASSERT(msgs[*count]);
+		(*count)++;
+		iter_data->next_value++;
+	}
+
+	return BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK;
+}
+
+static const struct test_graph_src_methods src_methods = {
+	.next = src_iter_next,
+	.init = src_iter_init,
+	.finalize = src_iter_finalize,
+};
+
+/*
+ * Creates a graph of which the source component, configured with
+ * `src_config`, is connected to a simple sink which adds the number of
+ * messages it consumes to `*msg_count`.
+ */
+static
+bt_graph *create_graph(const struct src_config *src_config,
+		uint64_t *msg_count)
+{
+	return test_graph_create(&src_methods, src_config, NULL, msg_count,
+		NULL);
+}
+
+static
+gpointer write_byte_later(gpointer data)
+{
+	int fd = GPOINTER_TO_INT(data);
+	int ret;
+
+	g_usleep(SHORT_WAIT_US / 2);
+	ret = write(fd, "x", 1);
+	BT_ASSERT(ret == 1);
+	return NULL;
+}
+
+/*
+ * Calls bt_graph_run_and_wait() with `graph` and `max_wait_us`, setting
+ * `*elapsed_us` to the duration of the call.
+ */
+static
+bt_graph_run_status run_and_wait(bt_graph *graph, uint64_t max_wait_us,
+		gint64 *elapsed_us)
+{
+	gint64 begin = g_get_monotonic_time();
+	bt_graph_run_status status;
+
+	status = bt_graph_run_and_wait(graph, max_wait_us);
+	*elapsed_us = g_get_monotonic_time() - begin;
+	return status;
+}
+
+/*
+ * Calls bt_graph_run_once_and_wait() with `graph` and `max_wait_us`,
+ * setting `*elapsed_us` to the duration of the call.
+ */
+static
+bt_graph_run_once_status run_once_and_wait(bt_graph *graph,
+		uint64_t max_wait_us, gint64 *elapsed_us)
+{
+	gint64 begin = g_get_monotonic_time();
+	bt_graph_run_once_status status;
+
+	status = bt_graph_run_once_and_wait(graph, max_wait_us);
+	*elapsed_us = g_get_monotonic_time() - begin;
+	return status;
+}
+
+static
+void test_wake_up(void)
+{
+	struct src_config src_config;
+	uint64_t msg_count = 0;
+	bt_graph *graph;
+	bt_graph_run_status status;
+	GThread *thread;
+	gint64 elapsed_us;
+	int fds[2];
+	int ret;
+
+	ret = pipe(fds);
+	BT_ASSERT(ret == 0);
+	ret = fcntl(fds[0], F_SETFL, O_NONBLOCK);
+	BT_ASSERT(ret == 0);
+	src_config.fd = fds[0];
+	src_config.set_wake_up_fd = true;
+	graph = create_graph(&src_config, &msg_count);
+
+	status = run_and_wait(graph, 0, &elapsed_us);
+	ok(status == BT_GRAPH_RUN_STATUS_AGAIN && elapsed_us < SHORT_WAIT_US,
+		"bt_graph_run_and_wait() doesn't wait with a maximum wait of 0");
+
+	status = run_and_wait(graph, SHORT_WAIT_US, &elapsed_us);
+	ok(status == BT_GRAPH_RUN_STATUS_AGAIN &&
+		elapsed_us >= SHORT_WAIT_US * 9 / 10,
+		"bt_graph_run_and_wait() waits for the maximum duration when no message iterator is ready");
+
+	thread = bt_g_thread_new("writer", write_byte_later,
+		GINT_TO_POINTER(fds[1]));
+	BT_ASSERT(thread);
+	status = run_and_wait(graph, LONG_WAIT_US, &elapsed_us);
+	g_thread_join(thread);
+	ok(status == BT_GRAPH_RUN_STATUS_AGAIN,
+		"bt_graph_run_and_wait() returns \"try again\" when the source isn't ready");
+	ok(elapsed_us < LONG_WAIT_US / 2,
+		"bt_graph_run_and_wait() returns as soon as the wake-up file descriptor is readable");
+
+	do {
+		status = bt_graph_run_and_wait(graph, LONG_WAIT_US);
+	} while (status == BT_GRAPH_RUN_STATUS_AGAIN);
+
+	ok(status == BT_GRAPH_RUN_STATUS_OK && msg_count == MSG_COUNT,
+		"Graph runs to the end once the source is ready");
+	bt_graph_put_ref(graph);
+	close(fds[0]);
+	close(fds[1]);
+}
+
+static
+void test_run_once_wake_up(void)
+{
+	struct src_config src_config;
+	uint64_t msg_count = 0;
+	bt_graph *graph;
+	bt_graph_run_once_status status;
+	GThread *thread;
+	gint64 elapsed_us;
+	int fds[2];
+	int ret;
+
+	ret = pipe(fds);
+	BT_ASSERT(ret == 0);
+	ret = fcntl(fds[0], F_SETFL, O_NONBLOCK);
+	BT_ASSERT(ret == 0);
+	src_config.fd = fds[0];
+	src_config.set_wake_up_fd = true;
+	graph = create_graph(&src_config, &msg_count);
+
+	status = run_once_and_wait(graph, SHORT_WAIT_US, &elapsed_us);
+	ok(status == BT_GRAPH_RUN_ONCE_STATUS_AGAIN &&
+		elapsed_us >= SHORT_WAIT_US * 9 / 10,
+		"bt_graph_run_once_and_wait() waits for the maximum duration when no message iterator is ready");
+
+	thread = bt_g_thread_new("writer", write_byte_later,
+		GINT_TO_POINTER(fds[1]));
+	BT_ASSERT(thread);
+	status = run_once_and_wait(graph, LONG_WAIT_US, &elapsed_us);
+	g_thread_join(thread);
+	ok(status == BT_GRAPH_RUN_ONCE_STATUS_AGAIN &&
+		elapsed_us < LONG_WAIT_US / 2,
+		"bt_graph_run_once_and_wait() returns as soon as the wake-up file descriptor is readable");
+
+	do {
+		status = bt_graph_run_once_and_wait(graph, LONG_WAIT_US);
+	} while (status == BT_GRAPH_RUN_ONCE_STATUS_OK ||
+		status == BT_GRAPH_RUN_ONCE_STATUS_AGAIN);
+
+	ok(status == BT_GRAPH_RUN_ONCE_STATUS_END && msg_count == MSG_COUNT,
+		"Graph runs once at a time to the end once the source is ready");
+	bt_graph_put_ref(graph);
+	close(fds[0]);
+	close(fds[1]);
+}
+
+static
+void test_no_wake_up_fd(void)
+{
+	struct src_config src_config;
+	uint64_t msg_count = 0;
+	bt_graph *graph;
+	bt_graph_run_status status;
+	gint64 elapsed_us;
+	int fds[2];
+	int ret;
+
+	ret = pipe(fds);
+	BT_ASSERT(ret == 0);
+	ret = fcntl(fds[0], F_SETFL, O_NONBLOCK);
+	BT_ASSERT(ret == 0);
+	src_config.fd = fds[0];
+	src_config.set_wake_up_fd = false;
+	graph = create_graph(&src_config, &msg_count);
+
+	/* Ready, but without a wake-up file descriptor */
+	ret = write(fds[1], "x", 1);
+	BT_ASSERT(ret == 1);
+	status = run_and_wait(graph, SHORT_WAIT_US, &elapsed_us);
+	ok(status == BT_GRAPH_RUN_STATUS_OK && msg_count == MSG_COUNT,
+		"Graph runs to the end without a wake-up file descriptor");
+	bt_graph_put_ref(graph);
+
+	msg_count = 0;
+	graph = create_graph(&src_config, &msg_count);
+	status = run_and_wait(graph, SHORT_WAIT_US, &elapsed_us);
+	ok(status == BT_GRAPH_RUN_STATUS_AGAIN,
+		"bt_graph_run_and_wait() returns \"try again\" without a wake-up file descriptor");
+	ok(elapsed_us >= SHORT_WAIT_US * 9 / 10,
+		"bt_graph_run_and_wait() sleeps for the maximum duration without a wake-up file descriptor");
+	bt_graph_put_ref(graph);
+	close(fds[0]);
+	close(fds[1]);
+}
+
+int main(void)
+{
+	plan_tests(NR_TESTS);
+	test_wake_up();
+	test_run_once_wake_up();
+	test_no_wake_up_fd();
+	return exit_status();
+}
+
+#else /* __MINGW32__ */
+
+int main(void)
+{
+	plan_skip_all("Wake-up file descriptors aren't supported on Windows");
+	return exit_status();
+}
+
+#endif /* __MINGW32__ */
@@ -0,0 +1,118 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ * Copyright (C) 2023 EfficiOS Inc.
+ *
+ * Packet raw data test
+ */
+
+#include <babeltrace2/babeltrace.h>
+#include "common/assert.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include "tap/tap.h"
+#include "test-graph.h"
+
+#define NR_TESTS 6
+
+#define RAW_DATA_FORMAT		"test-format"
+#define OTHER_RAW_DATA_FORMAT	"other-test-format"
+
+struct raw_data {
+	unsigned int destroy_count;
+};
+
+static
+void destroy_raw_data(void *data)
+{
+	struct raw_data *raw_data = data;
+
+	raw_data->destroy_count++;
+}
+
+static
+void test_raw_data(bt_stream *stream)
+{
+	struct raw_data raw_data = { 0 };
+	bt_packet *packet;
+
+	packet = bt_packet_create(stream);
+	BT_ASSERT(packet);
+	ok(!bt_packet_borrow_raw_data_const(packet, RAW_DATA_FORMAT),
+		"A new packet has no raw data");
+	bt_packet_set_raw_data(packet, RAW_DATA_FORMAT, &raw_data,
+		destroy_raw_data);
+	ok(bt_packet_borrow_raw_data_const(packet, RAW_DATA_FORMAT) ==
+		&raw_data, "Borrowing the raw data of a packet with its format");
+	ok(!bt_packet_borrow_raw_data_const(packet, OTHER_RAW_DATA_FORMAT),
+		"Borrowing the raw data of a packet with another format returns NULL");
+	ok(raw_data.destroy_count == 0,
+		"Library doesn't destroy the raw data of an existing packet");
+	bt_packet_put_ref(packet);
+	ok(raw_data.destroy_count == 1,
+		"Library destroys the raw data of a packet once");
+
+	/* Recycled packet */
+	packet = bt_packet_create(stream);
+	BT_ASSERT(packet);
+	ok(!bt_packet_borrow_raw_data_const(packet, RAW_DATA_FORMAT),
+		"A recycled packet has no raw data");
+	bt_packet_put_ref(packet);
+}
+
+static
+bt_message_iterator_class_initialize_method_status src_iter_init(
+		bt_self_message_iterator *self_msg_iter,
+		bt_self_message_iterator_configuration *config,
+		bt_self_component_port_output *port)
+{
+	bt_self_component *self_comp =
+		bt_self_message_iterator_borrow_component(self_msg_iter);
+	bt_trace_class *tc;
+	bt_stream_class *sc;
+	bt_trace *trace;
+	bt_stream *stream;
+
+	tc = bt_trace_class_create(self_comp);
+	BT_ASSERT(tc);
+	sc = bt_stream_class_create(tc);
+	BT_ASSERT(sc);
+	bt_stream_class_set_supports_packets(sc, BT_TRUE, BT_FALSE, BT_FALSE);
+	trace = bt_trace_create(tc);
+	BT_ASSERT(trace);
+	stream = bt_stream_create(sc, trace);
+	BT_ASSERT(stream);
+	test_raw_data(stream);
+	bt_stream_put_ref(stream);
+	bt_trace_put_ref(trace);
+	bt_stream_class_put_ref(sc);
+	bt_trace_class_put_ref(tc);
+	return BT_MESSAGE_ITERATOR_CLASS_INITIALIZE_METHOD_STATUS_OK;
+}
+
+static const struct test_graph_src_methods src_methods = {
+	.init = src_iter_init,
+};
+
+/*
+ * Runs a graph of which the source component's message iterator runs
+ * the tests when it's initialized.
+ */
+static
+void run_graph(void)
+{
+	bt_graph *graph;
+	bt_graph_run_status run_status;
+
+	graph = test_graph_create(&src_methods, NULL, NULL, NULL, NULL);
+	run_status = bt_graph_run(graph);
+	BT_ASSERT(run_status == BT_GRAPH_RUN_STATUS_OK);
+	bt_graph_put_ref(graph);
+}
+
+int main(void)
+{
+	plan_tests(NR_TESTS);
+	run_graph();
+	return exit_status();
+}
@@ -0,0 +1,273 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (C) 2023 EfficiOS Inc.
+ */
+
+/*
+ * Generates a trace of which the event payload has static and dynamic
+ * arrays of byte-aligned 16-bit and 32-bit signed integers and of
+ * 32-bit and 64-bit floating point numbers.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <babeltrace2-ctf-writer/writer.h>
+#include <babeltrace2-ctf-writer/clock.h>
+#include <babeltrace2-ctf-writer/clock-class.h>
+#include <babeltrace2-ctf-writer/stream.h>
+#include <babeltrace2-ctf-writer/event.h>
+#include <babeltrace2-ctf-writer/event-types.h>
+#include <babeltrace2-ctf-writer/event-fields.h>
+#include <babeltrace2-ctf-writer/stream-class.h>
+#include <babeltrace2-ctf-writer/trace.h>
+
+#include "common/assert.h"
+
+/* Length of the static array payload fields */
+#define ARRAY_LEN	5
+
+struct config {
+	struct bt_ctf_writer *writer;
+	struct bt_ctf_trace *trace;
+	struct bt_ctf_clock *clock;
+	struct bt_ctf_stream_class *sc;
+	struct bt_ctf_stream *stream;
+	struct bt_ctf_event_class *ec;
+};
+
+static
+void fini_config(struct config *cfg)
+{
+	bt_ctf_object_put_ref(cfg->stream);
+	bt_ctf_object_put_ref(cfg->sc);
+	bt_ctf_object_put_ref(cfg->ec);
+	bt_ctf_object_put_ref(cfg->clock);
+	bt_ctf_object_put_ref(cfg->trace);
+	bt_ctf_object_put_ref(cfg->writer);
+}
+
+static
+struct bt_ctf_field_type *create_int_ft(unsigned int size, bool is_signed,
+		unsigned int alignment)
+{
+	struct bt_ctf_field_type *ft;
+	int ret;
+
+	ft = bt_ctf_field_type_integer_create(size);
+	BT_ASSERT(ft);
+	ret = bt_ctf_field_type_integer_set_signed(ft, is_signed);
+	BT_ASSERT(ret == 0);
+	ret = bt_ctf_field_type_set_alignment(ft, alignment);
+	BT_ASSERT(ret == 0);
+	return ft;
+}
+
+static
+struct bt_ctf_field_type *create_float_ft(unsigned int size,
+		unsigned int alignment)
+{
+	struct bt_ctf_field_type *ft;
+	int ret;
+
+	ft = bt_ctf_field_type_floating_point_create();
+	BT_ASSERT(ft);
+	ret = bt_ctf_field_type_floating_point_set_exponent_digits(ft,
+		size == 32 ? 8 : 11);
+	BT_ASSERT(ret == 0);
+	ret = bt_ctf_field_type_floating_point_set_mantissa_digits(ft,
+		size == 32 ? 24 : 53);
+	BT_ASSERT(ret == 0);
+	ret = bt_ctf_field_type_set_alignment(ft, alignment);
+	BT_ASSERT(ret == 0);
+	return ft;
+}
+
+static
+void add_field(struct bt_ctf_event_class *ec, struct bt_ctf_field_type *ft,
+		const char *name)
+{
+	int ret;
+
+	BT_ASSERT(ft);
+	ret = bt_ctf_event_class_add_field(ec, ft, name);
+	BT_ASSERT(ret == 0);
+	bt_ctf_object_put_ref(ft);
+}
+
+static
+void add_array_field(struct bt_ctf_event_class *ec,
+		struct bt_ctf_field_type *elem_ft, const char *name)
+{
+	BT_ASSERT(elem_ft);
+	add_field(ec, bt_ctf_field_type_array_create(elem_ft, ARRAY_LEN),
+		name);
+	bt_ctf_object_put_ref(elem_ft);
+}
+
+static
+void add_fields(struct bt_ctf_event_class *ec)
+{
+	struct bt_ctf_field_type *elem_ft;
+
+	add_field(ec, create_int_ft(8, false, 8), "u8");
+	add_array_field(ec, create_int_ft(16, true, 8), "s16_array");
+	add_array_field(ec, create_int_ft(32, true, 8), "s32_array");
+	add_array_field(ec, create_float_ft(32, 8), "flt_array");
+	add_array_field(ec, create_float_ft(64, 8), "dbl_array");
+	add_field(ec, create_int_ft(8, false, 8), "seq_len");
+	elem_ft = create_int_ft(32, true, 8);
+	add_field(ec, bt_ctf_field_type_sequence_create(elem_ft, "seq_len"),
+		"s32_seq");
+	bt_ctf_object_put_ref(elem_ft);
+}
+
+static
+void configure_writer(struct config *cfg, const char *path)
+{
+	int ret;
+
+	cfg->writer = bt_ctf_writer_create(path);
+	BT_ASSERT(cfg->writer);
+	cfg->trace = bt_ctf_writer_get_trace(cfg->writer);
+	BT_ASSERT(cfg->trace);
+	cfg->clock = bt_ctf_clock_create("default");
+	BT_ASSERT(cfg->clock);
+	ret = bt_ctf_writer_add_clock(cfg->writer, cfg->clock);
+	BT_ASSERT(ret == 0);
+	ret = bt_ctf_writer_set_byte_order(cfg->writer,
+		BT_CTF_BYTE_ORDER_LITTLE_ENDIAN);
+	BT_ASSERT(ret == 0);
+	cfg->sc = bt_ctf_stream_class_create("hello");
+	BT_ASSERT(cfg->sc);
+	ret = bt_ctf_stream_class_set_clock(cfg->sc, cfg->clock);
+	BT_ASSERT(ret == 0);
+	cfg->ec = bt_ctf_event_class_create("ev");
+	BT_ASSERT(cfg->ec);
+	add_fields(cfg->ec);
+	ret = bt_ctf_stream_class_add_event_class(cfg->sc, cfg->ec);
+	BT_ASSERT(ret == 0);
+	cfg->stream = bt_ctf_writer_create_stream(cfg->writer, cfg->sc);
+	BT_ASSERT(cfg->stream);
+}
+
+static
+void set_int_field(struct bt_ctf_field *field, bool is_signed, int64_t value)
+{
+	int ret;
+
+	BT_ASSERT(field);
+
+	if (is_signed) {
+		ret = bt_ctf_field_integer_signed_set_value(field, value);
+	} else {
+		ret = bt_ctf_field_integer_unsigned_set_value(field,
+			(uint64_t) value);
+	}
+
+	BT_ASSERT(ret == 0);
+	bt_ctf_object_put_ref(field);
+}
+
+static
+void set_float_field(struct bt_ctf_field *field, double value)
+{
+	int ret;
+
+	BT_ASSERT(field);
+	ret = bt_ctf_field_floating_point_set_value(field, value);
+	BT_ASSERT(ret == 0);
+	bt_ctf_object_put_ref(field);
+}
+
+static
+void write_stream(struct config *cfg)
+{
+	int64_t i;
+	int ret;
+
+	for (i = 0; i < 10; i++) {
+		struct bt_ctf_event *ev = bt_ctf_event_create(cfg->ec);
+		struct bt_ctf_field *array_field;
+		struct bt_ctf_field *len_field;
+		uint64_t j;
+
+		BT_ASSERT(ev);
+		set_int_field(bt_ctf_event_get_payload(ev, "u8"), false, i);
+
+		array_field = bt_ctf_event_get_payload(ev, "s16_array");
+		BT_ASSERT(array_field);
+
+		for (j = 0; j < ARRAY_LEN; j++) {
+			set_int_field(bt_ctf_field_array_get_field(array_field, j),
+				true, INT16_MIN + (int64_t) (i * 1000 + j));
+		}
+
+		bt_ctf_object_put_ref(array_field);
+		array_field = bt_ctf_event_get_payload(ev, "s32_array");
+		BT_ASSERT(array_field);
+
+		for (j = 0; j < ARRAY_LEN; j++) {
+			set_int_field(bt_ctf_field_array_get_field(array_field, j),
+				true, -70000 * (i + 1) + (int64_t) j);
+		}
+
+		bt_ctf_object_put_ref(array_field);
+		array_field = bt_ctf_event_get_payload(ev, "flt_array");
+		BT_ASSERT(array_field);
+
+		for (j = 0; j < ARRAY_LEN; j++) {
+			set_float_field(bt_ctf_field_array_get_field(array_field, j),
+				-1.5 * (double) i + 0.25 * (double) j);
+		}
+
+		bt_ctf_object_put_ref(array_field);
+		array_field = bt_ctf_event_get_payload(ev, "dbl_array");
+		BT_ASSERT(array_field);
+
+		for (j = 0; j < ARRAY_LEN; j++) {
+			set_float_field(bt_ctf_field_array_get_field(array_field, j),
+				3.141592653589793 * (double) (i - (int64_t) j));
+		}
+
+		bt_ctf_object_put_ref(array_field);
+
+		/* Sequence of `i` elements */
+		len_field = bt_ctf_event_get_payload(ev, "seq_len");
+		BT_ASSERT(len_field);
+		ret = bt_ctf_field_integer_unsigned_set_value(len_field,
+			(uint64_t) i);
+		BT_ASSERT(ret == 0);
+		array_field = bt_ctf_event_get_payload(ev, "s32_seq");
+		BT_ASSERT(array_field);
+		ret = bt_ctf_field_sequence_set_length(array_field, len_field);
+		BT_ASSERT(ret == 0);
+		bt_ctf_object_put_ref(len_field);
+
+		for (j = 0; j < (uint64_t) i; j++) {
+			set_int_field(bt_ctf_field_sequence_get_field(array_field, j),
+				true, INT32_MIN + (int64_t) j);
+		}
+
+		bt_ctf_object_put_ref(array_field);
+		ret = bt_ctf_clock_set_time(cfg->clock, i);
+		BT_ASSERT(ret == 0);
+		ret = bt_ctf_stream_append_event(cfg->stream, ev);
+		BT_ASSERT(ret == 0);
+		bt_ctf_object_put_ref(ev);
+	}
+
+	ret = bt_ctf_stream_flush(cfg->stream);
+	BT_ASSERT(ret == 0);
+}
+
+int main(int argc, char **argv)
+{
+	struct config cfg = {0};
+
+	BT_ASSERT(argc >= 2);
+	configure_writer(&cfg, argv[1]);
+	write_stream(&cfg);
+	fini_config(&cfg);
+	return 0;
+}
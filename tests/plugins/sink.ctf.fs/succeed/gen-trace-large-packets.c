@@ -0,0 +1,158 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (C) 2023 EfficiOS Inc.
+ */
+
+/*
+ * Generates a trace of which some packets are larger than the initial
+ * 1 MiB memory map of the CTF serializer, with a small packet after
+ * each of them, so that converting it maps the stream file again while
+ * writing a packet and then reuses the larger map.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <babeltrace2-ctf-writer/writer.h>
+#include <babeltrace2-ctf-writer/clock.h>
+#include <babeltrace2-ctf-writer/clock-class.h>
+#include <babeltrace2-ctf-writer/stream.h>
+#include <babeltrace2-ctf-writer/event.h>
+#include <babeltrace2-ctf-writer/event-types.h>
+#include <babeltrace2-ctf-writer/event-fields.h>
+#include <babeltrace2-ctf-writer/stream-class.h>
+#include <babeltrace2-ctf-writer/trace.h>
+
+#include "common/assert.h"
+
+/* Length of the string payload field of each event */
+#define STR_LEN		4000
+
+struct config {
+	struct bt_ctf_writer *writer;
+	struct bt_ctf_trace *trace;
+	struct bt_ctf_clock *clock;
+	struct bt_ctf_stream_class *sc;
+	struct bt_ctf_stream *stream;
+	struct bt_ctf_event_class *ec;
+};
+
+static
+void fini_config(struct config *cfg)
+{
+	bt_ctf_object_put_ref(cfg->stream);
+	bt_ctf_object_put_ref(cfg->sc);
+	bt_ctf_object_put_ref(cfg->ec);
+	bt_ctf_object_put_ref(cfg->clock);
+	bt_ctf_object_put_ref(cfg->trace);
+	bt_ctf_object_put_ref(cfg->writer);
+}
+
+static
+void configure_writer(struct config *cfg, const char *path)
+{
+	struct bt_ctf_field_type *ft;
+	int ret;
+
+	cfg->writer = bt_ctf_writer_create(path);
+	BT_ASSERT(cfg->writer);
+	cfg->trace = bt_ctf_writer_get_trace(cfg->writer);
+	BT_ASSERT(cfg->trace);
+	cfg->clock = bt_ctf_clock_create("default");
+	BT_ASSERT(cfg->clock);
+	ret = bt_ctf_writer_add_clock(cfg->writer, cfg->clock);
+	BT_ASSERT(ret == 0);
+	ret = bt_ctf_writer_set_byte_order(cfg->writer,
+		BT_CTF_BYTE_ORDER_LITTLE_ENDIAN);
+	BT_ASSERT(ret == 0);
+	cfg->sc = bt_ctf_stream_class_create("hello");
+	BT_ASSERT(cfg->sc);
+	ret = bt_ctf_stream_class_set_clock(cfg->sc, cfg->clock);
+	BT_ASSERT(ret == 0);
+	cfg->ec = bt_ctf_event_class_create("ev");
+	BT_ASSERT(cfg->ec);
+	ft = bt_ctf_field_type_integer_create(64);
+	BT_ASSERT(ft);
+	ret = bt_ctf_event_class_add_field(cfg->ec, ft, "index");
+	BT_ASSERT(ret == 0);
+	bt_ctf_object_put_ref(ft);
+	ft = bt_ctf_field_type_string_create();
+	BT_ASSERT(ft);
+	ret = bt_ctf_event_class_add_field(cfg->ec, ft, "str");
+	BT_ASSERT(ret == 0);
+	bt_ctf_object_put_ref(ft);
+	ret = bt_ctf_stream_class_add_event_class(cfg->sc, cfg->ec);
+	BT_ASSERT(ret == 0);
+	cfg->stream = bt_ctf_writer_create_stream(cfg->writer, cfg->sc);
+	BT_ASSERT(cfg->stream);
+}
+
+static
+void write_packet(struct config *cfg, uint64_t event_count,
+		uint64_t *index)
+{
+	char str[STR_LEN + 1];
+	uint64_t i;
+	int ret;
+
+	for (i = 0; i < event_count; i++) {
+		struct bt_ctf_event *ev;
+		struct bt_ctf_field *field;
+
+		/* Create event and fill fields */
+		ev = bt_ctf_event_create(cfg->ec);
+		BT_ASSERT(ev);
+		field = bt_ctf_event_get_payload(ev, "index");
+		BT_ASSERT(field);
+		ret = bt_ctf_field_integer_unsigned_set_value(field, *index);
+		BT_ASSERT(ret == 0);
+		bt_ctf_object_put_ref(field);
+		memset(str, 'a' + (int) (*index % 26), STR_LEN);
+		str[STR_LEN] = '\0';
+		field = bt_ctf_event_get_payload(ev, "str");
+		BT_ASSERT(field);
+		ret = bt_ctf_field_string_set_value(field, str);
+		BT_ASSERT(ret == 0);
+		bt_ctf_object_put_ref(field);
+		ret = bt_ctf_clock_set_time(cfg->clock, *index);
+		BT_ASSERT(ret == 0);
+
+		/* Append event */
+		ret = bt_ctf_stream_append_event(cfg->stream, ev);
+		BT_ASSERT(ret == 0);
+		bt_ctf_object_put_ref(ev);
+		(*index)++;
+	}
+
+	/* Create packet */
+	ret = bt_ctf_stream_flush(cfg->stream);
+	BT_ASSERT(ret == 0);
+}
+
+static
+void write_stream(struct config *cfg)
+{
+	/*
+	 * About 1.2 MiB, 4 kiB, 2.4 MiB, and 4 kiB packets (number of
+	 * events times `STR_LEN`).
+	 */
+	static const uint64_t packet_event_counts[] = { 300, 1, 600, 1 };
+	uint64_t index = 0;
+	size_t i;
+
+	for (i = 0; i < sizeof(packet_event_counts) /
+			sizeof(packet_event_counts[0]); i++) {
+		write_packet(cfg, packet_event_counts[i], &index);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	struct config cfg = {0};
+
+	BT_ASSERT(argc >= 2);
+	configure_writer(&cfg, argv[1]);
+	write_stream(&cfg);
+	fini_config(&cfg);
+	return 0;
+}
@@ -0,0 +1,213 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (C) 2023 EfficiOS Inc.
+ */
+
+/*
+ * Generates a trace of which the event payload has members with mixed
+ * alignments (8-bit members followed by 32-bit and 64-bit aligned ones,
+ * and a 5-bit member which leaves the next one at a bit offset which
+ * isn't a multiple of 8).
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <babeltrace2-ctf-writer/writer.h>
+#include <babeltrace2-ctf-writer/clock.h>
+#include <babeltrace2-ctf-writer/clock-class.h>
+#include <babeltrace2-ctf-writer/stream.h>
+#include <babeltrace2-ctf-writer/event.h>
+#include <babeltrace2-ctf-writer/event-types.h>
+#include <babeltrace2-ctf-writer/event-fields.h>
+#include <babeltrace2-ctf-writer/stream-class.h>
+#include <babeltrace2-ctf-writer/trace.h>
+
+#include "common/assert.h"
+
+struct config {
+	struct bt_ctf_writer *writer;
+	struct bt_ctf_trace *trace;
+	struct bt_ctf_clock *clock;
+	struct bt_ctf_stream_class *sc;
+	struct bt_ctf_stream *stream;
+	struct bt_ctf_event_class *ec;
+};
+
+static
+void fini_config(struct config *cfg)
+{
+	bt_ctf_object_put_ref(cfg->stream);
+	bt_ctf_object_put_ref(cfg->sc);
+	bt_ctf_object_put_ref(cfg->ec);
+	bt_ctf_object_put_ref(cfg->clock);
+	bt_ctf_object_put_ref(cfg->trace);
+	bt_ctf_object_put_ref(cfg->writer);
+}
+
+static
+struct bt_ctf_field_type *create_int_ft(unsigned int size, bool is_signed,
+		unsigned int alignment)
+{
+	struct bt_ctf_field_type *ft;
+	int ret;
+
+	ft = bt_ctf_field_type_integer_create(size);
+	BT_ASSERT(ft);
+	ret = bt_ctf_field_type_integer_set_signed(ft, is_signed);
+	BT_ASSERT(ret == 0);
+	ret = bt_ctf_field_type_set_alignment(ft, alignment);
+	BT_ASSERT(ret == 0);
+	return ft;
+}
+
+static
+struct bt_ctf_field_type *create_float_ft(unsigned int size,
+		unsigned int alignment)
+{
+	struct bt_ctf_field_type *ft;
+	int ret;
+
+	ft = bt_ctf_field_type_floating_point_create();
+	BT_ASSERT(ft);
+	ret = bt_ctf_field_type_floating_point_set_exponent_digits(ft,
+		size == 32 ? 8 : 11);
+	BT_ASSERT(ret == 0);
+	ret = bt_ctf_field_type_floating_point_set_mantissa_digits(ft,
+		size == 32 ? 24 : 53);
+	BT_ASSERT(ret == 0);
+	ret = bt_ctf_field_type_set_alignment(ft, alignment);
+	BT_ASSERT(ret == 0);
+	return ft;
+}
+
+static
+void add_field(struct bt_ctf_event_class *ec, struct bt_ctf_field_type *ft,
+		const char *name)
+{
+	int ret;
+
+	BT_ASSERT(ft);
+	ret = bt_ctf_event_class_add_field(ec, ft, name);
+	BT_ASSERT(ret == 0);
+	bt_ctf_object_put_ref(ft);
+}
+
+static
+void add_fields(struct bt_ctf_event_class *ec)
+{
+	add_field(ec, create_int_ft(8, false, 8), "u8");
+	add_field(ec, create_int_ft(64, false, 64), "u64_align64");
+	add_field(ec, create_int_ft(5, false, 1), "u5");
+	add_field(ec, create_int_ft(8, true, 8), "s8");
+	add_field(ec, create_int_ft(32, true, 32), "s32_align32");
+	add_field(ec, create_int_ft(16, false, 8), "u16");
+	add_field(ec, create_float_ft(64, 64), "dbl_align64");
+	add_field(ec, create_int_ft(8, false, 8), "u8_last");
+}
+
+static
+void configure_writer(struct config *cfg, const char *path)
+{
+	int ret;
+
+	cfg->writer = bt_ctf_writer_create(path);
+	BT_ASSERT(cfg->writer);
+	cfg->trace = bt_ctf_writer_get_trace(cfg->writer);
+	BT_ASSERT(cfg->trace);
+	cfg->clock = bt_ctf_clock_create("default");
+	BT_ASSERT(cfg->clock);
+	ret = bt_ctf_writer_add_clock(cfg->writer, cfg->clock);
+	BT_ASSERT(ret == 0);
+	ret = bt_ctf_writer_set_byte_order(cfg->writer,
+		BT_CTF_BYTE_ORDER_LITTLE_ENDIAN);
+	BT_ASSERT(ret == 0);
+	cfg->sc = bt_ctf_stream_class_create("hello");
+	BT_ASSERT(cfg->sc);
+	ret = bt_ctf_stream_class_set_clock(cfg->sc, cfg->clock);
+	BT_ASSERT(ret == 0);
+	cfg->ec = bt_ctf_event_class_create("ev");
+	BT_ASSERT(cfg->ec);
+	add_fields(cfg->ec);
+	ret = bt_ctf_stream_class_add_event_class(cfg->sc, cfg->ec);
+	BT_ASSERT(ret == 0);
+	cfg->stream = bt_ctf_writer_create_stream(cfg->writer, cfg->sc);
+	BT_ASSERT(cfg->stream);
+}
+
+static
+void set_int_field(struct bt_ctf_field *field, bool is_signed, int64_t value)
+{
+	int ret;
+
+	BT_ASSERT(field);
+
+	if (is_signed) {
+		ret = bt_ctf_field_integer_signed_set_value(field, value);
+	} else {
+		ret = bt_ctf_field_integer_unsigned_set_value(field,
+			(uint64_t) value);
+	}
+
+	BT_ASSERT(ret == 0);
+	bt_ctf_object_put_ref(field);
+}
+
+static
+void set_float_field(struct bt_ctf_field *field, double value)
+{
+	int ret;
+
+	BT_ASSERT(field);
+	ret = bt_ctf_field_floating_point_set_value(field, value);
+	BT_ASSERT(ret == 0);
+	bt_ctf_object_put_ref(field);
+}
+
+static
+void write_stream(struct config *cfg)
+{
+	int64_t i;
+	int ret;
+
+	for (i = 0; i < 10; i++) {
+		struct bt_ctf_event *ev = bt_ctf_event_create(cfg->ec);
+
+		BT_ASSERT(ev);
+		set_int_field(bt_ctf_event_get_payload(ev, "u8"), false,
+			0xa0 + i);
+		set_int_field(bt_ctf_event_get_payload(ev, "u64_align64"),
+			false, (int64_t) (UINT64_C(0x0123456789abcdef) * (i + 1)));
+		set_int_field(bt_ctf_event_get_payload(ev, "u5"), false,
+			(i * 7) % 32);
+		set_int_field(bt_ctf_event_get_payload(ev, "s8"), true,
+			-100 + i);
+		set_int_field(bt_ctf_event_get_payload(ev, "s32_align32"), true,
+			-1000000 * (i + 1));
+		set_int_field(bt_ctf_event_get_payload(ev, "u16"), false,
+			0xfedc - i);
+		set_float_field(bt_ctf_event_get_payload(ev, "dbl_align64"),
+			-2.5 * (double) i);
+		set_int_field(bt_ctf_event_get_payload(ev, "u8_last"), false,
+			0xff - i);
+		ret = bt_ctf_clock_set_time(cfg->clock, i);
+		BT_ASSERT(ret == 0);
+		ret = bt_ctf_stream_append_event(cfg->stream, ev);
+		BT_ASSERT(ret == 0);
+		bt_ctf_object_put_ref(ev);
+	}
+
+	ret = bt_ctf_stream_flush(cfg->stream);
+	BT_ASSERT(ret == 0);
+}
+
+int main(int argc, char **argv)
+{
+	struct config cfg = {0};
+
+	BT_ASSERT(argc >= 2);
+	configure_writer(&cfg, argv[1]);
+	write_stream(&cfg);
+	fini_config(&cfg);
+	return 0;
+}
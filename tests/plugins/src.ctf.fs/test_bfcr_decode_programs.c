@@ -0,0 +1,435 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (C) 2023 EfficiOS Inc.
+ *
+ * Tests that the binary field class reader (BFCR) calls the same user
+ * functions, with the same values, whether it runs the decode programs
+ * of the structure field classes or decodes their members one by one.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <glib.h>
+#include <babeltrace2/babeltrace.h>
+
+#include "common/assert.h"
+#include "compat/memstream.h"
+#include "ctf/common/bfcr/bfcr.h"
+#include "ctf/common/metadata/ctf-meta.h"
+#include "ctf/common/metadata/decoder.h"
+#include "tap/tap.h"
+
+#define DISABLE_ENV_VAR		"BABELTRACE_CTF_DISABLE_DECODE_PROGRAMS"
+#define BUF_SIZE		256
+
+/* Number of buffer chunk sizes of check_decoding() */
+#define CHUNK_SIZE_COUNT	3
+
+struct layout {
+	/* Event class ID within `metadata` */
+	uint64_t id;
+
+	/* Description */
+	const char *name;
+
+	/* Expected member count of the payload's decode program */
+	uint64_t program_member_count;
+};
+
+static const char metadata[] =
+	"/* CTF 1.8 */\n"
+	"typealias integer { size = 8; align = 8; signed = false; } := uint8_t;\n"
+	"typealias integer { size = 8; align = 8; signed = true; } := int8_t;\n"
+	"typealias integer { size = 16; align = 16; signed = false; } := uint16_t;\n"
+	"typealias integer { size = 16; align = 16; signed = true; } := int16_t;\n"
+	"typealias integer { size = 32; align = 32; signed = false; } := uint32_t;\n"
+	"typealias integer { size = 64; align = 64; signed = true; } := int64_t;\n"
+	"typealias integer { size = 16; align = 8; signed = true; byte_order = le; } := le_int16_t;\n"
+	"typealias integer { size = 32; align = 8; signed = true; byte_order = be; } := be_int32_t;\n"
+	"typealias integer { size = 64; align = 8; signed = false; byte_order = be; } := be_uint64_t;\n"
+	"typealias integer { size = 3; align = 1; signed = false; } := uint3_t;\n"
+	"typealias integer { size = 5; align = 1; signed = false; } := uint5_t;\n"
+	"typealias integer { size = 13; align = 1; signed = true; } := int13_t;\n"
+	"typealias integer { size = 16; align = 1; signed = false; } := unaligned_uint16_t;\n"
+	"typealias floating_point { exp_dig = 8; mant_dig = 24; align = 32; } := float;\n"
+	"typealias floating_point { exp_dig = 11; mant_dig = 53; align = 64; } := double;\n"
+	"typealias floating_point { exp_dig = 8; mant_dig = 24; align = 8; byte_order = be; } := be_float;\n"
+	"typealias floating_point { exp_dig = 11; mant_dig = 53; align = 8; byte_order = le; } := le_double;\n"
+	"trace {\n"
+	"	major = 1;\n"
+	"	minor = 8;\n"
+	"	byte_order = le;\n"
+	"};\n"
+	"stream {\n"
+	"	event.header := struct { uint8_t id; };\n"
+	"};\n"
+	"event {\n"
+	"	name = \"aligned\";\n"
+	"	id = 0;\n"
+	"	fields := struct {\n"
+	"		uint8_t a;\n"
+	"		int64_t b;\n"
+	"		int16_t c;\n"
+	"		float d;\n"
+	"		double e;\n"
+	"		uint32_t f[3];\n"
+	"		struct { int8_t x; uint16_t y; } g;\n"
+	"		enum : uint8_t { A = 0, B = 1 } h;\n"
+	"	};\n"
+	"};\n"
+	"event {\n"
+	"	name = \"byte_orders\";\n"
+	"	id = 1;\n"
+	"	fields := struct {\n"
+	"		be_int32_t a;\n"
+	"		le_int16_t b;\n"
+	"		be_uint64_t c;\n"
+	"		le_double d;\n"
+	"		be_float e;\n"
+	"		int8_t f;\n"
+	"		be_int32_t g[2];\n"
+	"	};\n"
+	"};\n"
+	"event {\n"
+	"	name = \"sub_byte\";\n"
+	"	id = 2;\n"
+	"	fields := struct {\n"
+	"		uint8_t a;\n"
+	"		uint3_t b;\n"
+	"		uint5_t c;\n"
+	"		unaligned_uint16_t d;\n"
+	"		uint3_t e;\n"
+	"		int13_t f;\n"
+	"		uint8_t g;\n"
+	"		uint32_t h;\n"
+	"	};\n"
+	"};\n"
+	"event {\n"
+	"	name = \"unaligned\";\n"
+	"	id = 3;\n"
+	"	fields := struct {\n"
+	"		uint3_t a;\n"
+	"		struct { uint16_t x; be_int32_t y; uint8_t z[2]; } b;\n"
+	"		uint5_t c;\n"
+	"		unaligned_uint16_t d;\n"
+	"		struct { le_int16_t x; be_float y; } e;\n"
+	"	};\n"
+	"};\n"
+	"event {\n"
+	"	name = \"dynamic\";\n"
+	"	id = 4;\n"
+	"	fields := struct {\n"
+	"		uint8_t a;\n"
+	"		uint32_t len;\n"
+	"		string s;\n"
+	"		uint16_t seq[len];\n"
+	"		double b;\n"
+	"	};\n"
+	"};\n";
+
+static const struct layout layouts[] = {
+	{ 0, "aligned members", 8 },
+	{ 1, "mixed byte order members", 7 },
+	{ 2, "sub-byte members", 1 },
+	{ 3, "unaligned members", 0 },
+	{ 4, "dynamic members", 2 },
+};
+
+/* Recorded user function calls, in order */
+struct recorder {
+	GString *calls;
+	uint64_t last_unsigned;
+};
+
+static
+enum bt_bfcr_status record_unsigned_int(uint64_t value,
+		struct ctf_field_class *fc, void *data)
+{
+	struct recorder *recorder = data;
+
+	g_string_append_printf(recorder->calls, "u(%p)=%" PRIu64 "\n",
+		fc, value);
+	recorder->last_unsigned = value;
+	return BT_BFCR_STATUS_OK;
+}
+
+static
+enum bt_bfcr_status record_signed_int(int64_t value,
+		struct ctf_field_class *fc, void *data)
+{
+	struct recorder *recorder = data;
+
+	g_string_append_printf(recorder->calls, "s(%p)=%" PRId64 "\n",
+		fc, value);
+	return BT_BFCR_STATUS_OK;
+}
+
+static
+enum bt_bfcr_status record_floating_point(double value,
+		struct ctf_field_class *fc, void *data)
+{
+	struct recorder *recorder = data;
+	uint64_t bits;
+
+	/* Compare the bits: NaN != NaN */
+	memcpy(&bits, &value, sizeof(bits));
+	g_string_append_printf(recorder->calls, "f(%p)=%" PRIx64 "\n",
+		fc, bits);
+	return BT_BFCR_STATUS_OK;
+}
+
+static
+enum bt_bfcr_status record_string_begin(struct ctf_field_class *fc,
+		void *data)
+{
+	struct recorder *recorder = data;
+
+	g_string_append_printf(recorder->calls, "string-begin(%p)\n", fc);
+	return BT_BFCR_STATUS_OK;
+}
+
+static
+enum bt_bfcr_status record_string(const char *value, size_t len,
+		struct ctf_field_class *fc, void *data)
+{
+	struct recorder *recorder = data;
+
+	/* The substrings depend on the buffer: only keep the characters */
+	g_string_append_len(recorder->calls, value, len);
+	return BT_BFCR_STATUS_OK;
+}
+
+static
+enum bt_bfcr_status record_string_end(struct ctf_field_class *fc,
+		void *data)
+{
+	struct recorder *recorder = data;
+
+	g_string_append_printf(recorder->calls, "\nstring-end(%p)\n", fc);
+	return BT_BFCR_STATUS_OK;
+}
+
+static
+enum bt_bfcr_status record_compound_begin(struct ctf_field_class *fc,
+		void *data)
+{
+	struct recorder *recorder = data;
+
+	g_string_append_printf(recorder->calls, "compound-begin(%p)\n", fc);
+	return BT_BFCR_STATUS_OK;
+}
+
+static
+enum bt_bfcr_status record_compound_end(struct ctf_field_class *fc,
+		void *data)
+{
+	struct recorder *recorder = data;
+
+	g_string_append_printf(recorder->calls, "compound-end(%p)\n", fc);
+	return BT_BFCR_STATUS_OK;
+}
+
+static
+int64_t get_sequence_length(struct ctf_field_class *fc, void *data)
+{
+	struct recorder *recorder = data;
+
+	/* The length field is the last unsigned integer before */
+	return (int64_t) recorder->last_unsigned;
+}
+
+/*
+ * Decodes the field of class `fc` from `buf`, giving the BFCR
+ * `chunk_size` bytes at a time, and records the user function calls
+ * to `calls`.
+ *
+ * Returns the number of decoded bits, or -1 on error.
+ */
+static
+int64_t decode(struct ctf_field_class *fc, const uint8_t *buf,
+		size_t buf_size, size_t chunk_size, bool use_programs,
+		GString *calls)
+{
+	struct recorder recorder = {
+		.calls = calls,
+		.last_unsigned = 0,
+	};
+	struct bt_bfcr_cbs cbs = {
+		.classes = {
+			.signed_int = record_signed_int,
+			.unsigned_int = record_unsigned_int,
+			.floating_point = record_floating_point,
+			.string_begin = record_string_begin,
+			.string = record_string,
+			.string_end = record_string_end,
+			.compound_begin = record_compound_begin,
+			.compound_end = record_compound_end,
+		},
+		.query = {
+			.get_sequence_length = get_sequence_length,
+		},
+	};
+	struct bt_bfcr *bfcr;
+	enum bt_bfcr_status status;
+	size_t pos = 0;
+	int64_t bits = -1;
+
+	/* The BFCR reads this environment variable when created */
+	if (use_programs) {
+		g_unsetenv(DISABLE_ENV_VAR);
+	} else {
+		g_setenv(DISABLE_ENV_VAR, "1", TRUE);
+	}
+
+	bfcr = bt_bfcr_create(cbs, &recorder, BT_LOGGING_LEVEL_NONE, NULL);
+	g_unsetenv(DISABLE_ENV_VAR);
+	if (!bfcr) {
+		diag("Cannot create a BFCR");
+		goto end;
+	}
+
+	bits = bt_bfcr_start(bfcr, fc, buf, 0, 0, MIN(chunk_size, buf_size),
+		&status);
+
+	while (status == BT_BFCR_STATUS_EOF) {
+		pos += chunk_size;
+		if (pos >= buf_size) {
+			break;
+		}
+
+		bits += bt_bfcr_continue(bfcr, &buf[pos],
+			MIN(chunk_size, buf_size - pos), &status);
+	}
+
+	if (status != BT_BFCR_STATUS_OK) {
+		diag("Cannot decode field: status=%s",
+			bt_bfcr_status_string(status));
+		bits = -1;
+	}
+
+	bt_bfcr_destroy(bfcr);
+
+end:
+	return bits;
+}
+
+/*
+ * Checks that decoding the field of class `fc` from `buf` with the
+ * decode programs gives the same calls as without them, whatever the
+ * size of the buffer chunks.
+ */
+static
+void check_decoding(struct ctf_field_class *fc, const uint8_t *buf,
+		size_t buf_size, const char *name)
+{
+	static const size_t chunk_sizes[CHUNK_SIZE_COUNT] = { BUF_SIZE, 3, 1 };
+	GString *expected_calls = g_string_new(NULL);
+	GString *calls = g_string_new(NULL);
+	int64_t expected_bits;
+	size_t i;
+
+	BT_ASSERT(expected_calls);
+	BT_ASSERT(calls);
+	expected_bits = decode(fc, buf, buf_size, BUF_SIZE, false,
+		expected_calls);
+
+	for (i = 0; i < CHUNK_SIZE_COUNT; i++) {
+		int64_t bits;
+
+		g_string_truncate(calls, 0);
+		bits = decode(fc, buf, buf_size, chunk_sizes[i], true, calls);
+		ok(expected_bits > 0 && bits == expected_bits &&
+			strcmp(calls->str, expected_calls->str) == 0,
+			"Decoding %s with decode programs gives the same fields (%zu-byte chunks)",
+			name, chunk_sizes[i]);
+
+		if (bits != expected_bits) {
+			diag("Decoded bits: expected %" PRId64 ", got %" PRId64,
+				expected_bits, bits);
+		}
+	}
+
+	g_string_free(calls, TRUE);
+	g_string_free(expected_calls, TRUE);
+}
+
+static
+void fill_buf(uint8_t *buf, uint64_t id)
+{
+	size_t i;
+
+	for (i = 0; i < BUF_SIZE; i++) {
+		buf[i] = (uint8_t) (i * 37 + id * 101 + 11);
+	}
+
+	if (id == 4) {
+		/* `len` (at offset 4) and `s` (at offset 8) */
+		const uint32_t len = 5;
+
+		buf[4] = len & 0xff;
+		buf[5] = 0;
+		buf[6] = 0;
+		buf[7] = 0;
+		strcpy((char *) &buf[8], "decode programs");
+	}
+}
+
+static
+void test_layout(struct ctf_trace_class *tc, const struct layout *layout)
+{
+	struct ctf_stream_class *sc = tc->stream_classes->pdata[0];
+	struct ctf_event_class *ec;
+	struct ctf_field_class_struct *payload_fc;
+	uint8_t buf[BUF_SIZE];
+	uint64_t member_count = 0;
+
+	ec = ctf_stream_class_borrow_event_class_by_id(sc, layout->id);
+	BT_ASSERT(ec);
+	payload_fc = (void *) ec->payload_fc;
+	BT_ASSERT(payload_fc);
+
+	if (payload_fc->decode_program) {
+		member_count = payload_fc->decode_program->member_count;
+	}
+
+	ok(member_count == layout->program_member_count,
+		"Decode program of %s has the expected member count",
+		layout->name);
+	fill_buf(buf, layout->id);
+	check_decoding(ec->payload_fc, buf, BUF_SIZE, layout->name);
+}
+
+int main(void)
+{
+	struct ctf_metadata_decoder_config config = {
+		.log_level = BT_LOGGING_LEVEL_NONE,
+	};
+	struct ctf_metadata_decoder *decoder;
+	struct ctf_trace_class *tc;
+	FILE *fp;
+	size_t i;
+
+	plan_tests(1 + G_N_ELEMENTS(layouts) * (1 + CHUNK_SIZE_COUNT));
+
+	decoder = ctf_metadata_decoder_create(&config);
+	BT_ASSERT(decoder);
+	fp = bt_fmemopen((void *) metadata, strlen(metadata), "rb");
+	BT_ASSERT(fp);
+	ok(ctf_metadata_decoder_append_content(decoder, fp) ==
+		CTF_METADATA_DECODER_STATUS_OK, "Decode metadata");
+	fclose(fp);
+	tc = ctf_metadata_decoder_borrow_ctf_trace_class(decoder);
+	BT_ASSERT(tc);
+	BT_ASSERT(tc->stream_classes->len == 1);
+
+	for (i = 0; i < G_N_ELEMENTS(layouts); i++) {
+		test_layout(tc, &layouts[i]);
+	}
+
+	ctf_metadata_decoder_destroy(decoder);
+	return exit_status();
+}
@@ -0,0 +1,182 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ * Copyright (C) 2023 EfficiOS Inc.
+ *
+ * Source to simple sink graph for library tests
+ */
+
+#include "test-graph.h"
+
+#include <glib.h>
+#include <stddef.h>
+#include "common/assert.h"
+
+static
+bt_component_class_initialize_method_status src_init(
+		bt_self_component_source *self_comp,
+		bt_self_component_source_configuration *config,
+		const bt_value *params, void *init_method_data)
+{
+	bt_self_component *comp =
+		bt_self_component_source_as_self_component(self_comp);
+	struct test_graph_src_data *data =
+		g_new0(struct test_graph_src_data, 1);
+	int ret;
+
+	BT_ASSERT(data);
+	data->config = init_method_data;
+	data->tc = bt_trace_class_create(comp);
+	BT_ASSERT(data->tc);
+	data->cc = bt_clock_class_create(comp);
+	BT_ASSERT(data->cc);
+	data->sc = bt_stream_class_create(data->tc);
+	BT_ASSERT(data->sc);
+	data->ec = bt_event_class_create(data->sc);
+	BT_ASSERT(data->ec);
+	ret = bt_self_component_source_add_output_port(self_comp, "out", NULL,
+		NULL);
+	BT_ASSERT(ret == 0);
+	bt_self_component_set_data(comp, data);
+	return BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_OK;
+}
+
+static
+void src_finalize(bt_self_component_source *self_comp)
+{
+	struct test_graph_src_data *data = bt_self_component_get_data(
+		bt_self_component_source_as_self_component(self_comp));
+
+	bt_event_class_put_ref(data->ec);
+	bt_stream_class_put_ref(data->sc);
+	bt_clock_class_put_ref(data->cc);
+	bt_trace_class_put_ref(data->tc);
+	g_free(data);
+}
+
+static
+bt_message_iterator_class_next_method_status src_iter_next_end(
+		bt_self_message_iterator *self_msg_iter,
+		bt_message_array_const msgs, uint64_t capacity,
+		uint64_t *count)
+{
+	return BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_END;
+}
+
+bt_graph *test_graph_create(const struct test_graph_src_methods *src_methods,
+		const void *src_config,
+		bt_graph_simple_sink_component_consume_func sink_consume,
+		void *sink_data, const bt_connection **conn)
+{
+	bt_message_iterator_class *msg_iter_cls;
+	bt_component_class_source *comp_cls;
+	const bt_component_source *src_comp;
+	const bt_component_sink *sink_comp;
+	bt_graph *graph;
+	int ret;
+
+	msg_iter_cls = bt_message_iterator_class_create(
+		src_methods->next ? src_methods->next : src_iter_next_end);
+	BT_ASSERT(msg_iter_cls);
+
+	if (src_methods->init) {
+		ret = bt_message_iterator_class_set_initialize_method(
+			msg_iter_cls, src_methods->init);
+		BT_ASSERT(ret == 0);
+	}
+
+	if (src_methods->finalize) {
+		ret = bt_message_iterator_class_set_finalize_method(
+			msg_iter_cls, src_methods->finalize);
+		BT_ASSERT(ret == 0);
+	}
+
+	if (src_methods->seek_beginning) {
+		ret = bt_message_iterator_class_set_seek_beginning_methods(
+			msg_iter_cls, src_methods->seek_beginning,
+			src_methods->can_seek_beginning);
+		BT_ASSERT(ret == 0);
+	}
+
+	comp_cls = bt_component_class_source_create("src", msg_iter_cls);
+	BT_ASSERT(comp_cls);
+	ret = bt_component_class_source_set_initialize_method(comp_cls,
+		src_init);
+	BT_ASSERT(ret == 0);
+	ret = bt_component_class_source_set_finalize_method(comp_cls,
+		src_finalize);
+	BT_ASSERT(ret == 0);
+	graph = bt_graph_create(0);
+	BT_ASSERT(graph);
+	ret = bt_graph_add_source_component_with_initialize_method_data(graph,
+		comp_cls, "src-comp", NULL, (void *) src_config,
+		BT_LOGGING_LEVEL_NONE, &src_comp);
+	BT_ASSERT(ret == 0);
+	ret = bt_graph_add_simple_sink_component(graph, "sink-comp", NULL,
+		sink_consume ? sink_consume : test_graph_sink_consume, NULL,
+		sink_data, &sink_comp);
+	BT_ASSERT(ret == 0);
+	ret = bt_graph_connect_ports(graph,
+		bt_component_source_borrow_output_port_by_index_const(
+			src_comp, 0),
+		bt_component_sink_borrow_input_port_by_index_const(
+			sink_comp, 0),
+		conn);
+	BT_ASSERT(ret == 0);
+	bt_component_class_source_put_ref(comp_cls);
+	bt_message_iterator_class_put_ref(msg_iter_cls);
+	return graph;
+}
+
+bt_graph_run_status test_graph_run(bt_graph *graph)
+{
+	bt_graph_run_status run_status;
+
+	do {
+		run_status = bt_graph_run(graph);
+	} while (run_status == BT_GRAPH_RUN_STATUS_AGAIN);
+
+	return run_status;
+}
+
+bt_graph_simple_sink_component_consume_func_status test_graph_sink_next(
+		bt_message_iterator *msg_iter, bt_message_array_const *msgs,
+		uint64_t *count)
+{
+	switch (bt_message_iterator_next(msg_iter, msgs, count)) {
+	case BT_MESSAGE_ITERATOR_NEXT_STATUS_OK:
+		return BT_GRAPH_SIMPLE_SINK_COMPONENT_CONSUME_FUNC_STATUS_OK;
+	case BT_MESSAGE_ITERATOR_NEXT_STATUS_END:
+		return BT_GRAPH_SIMPLE_SINK_COMPONENT_CONSUME_FUNC_STATUS_END;
+	case BT_MESSAGE_ITERATOR_NEXT_STATUS_AGAIN:
+		return BT_GRAPH_SIMPLE_SINK_COMPONENT_CONSUME_FUNC_STATUS_AGAIN;
+	default:
+		return BT_GRAPH_SIMPLE_SINK_COMPONENT_CONSUME_FUNC_STATUS_ERROR;
+	}
+}
+
+bt_graph_simple_sink_component_consume_func_status test_graph_sink_consume(
+		bt_message_iterator *msg_iter, void *user_data)
+{
+	uint64_t *msg_count = user_data;
+	bt_graph_simple_sink_component_consume_func_status status;
+	bt_message_array_const msgs;
+	uint64_t count;
+	uint64_t i;
+
+	status = test_graph_sink_next(msg_iter, &msgs, &count);
+	if (status != BT_GRAPH_SIMPLE_SINK_COMPONENT_CONSUME_FUNC_STATUS_OK) {
+		goto end;
+	}
+
+	for (i = 0; i < count; i++) {
+		bt_message_put_ref(msgs[i]);
+	}
+
+	if (msg_count) {
+		*msg_count += count;
+	}
+
+end:
+	return status;
+}
@@ -0,0 +1,97 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ * Copyright (C) 2023 EfficiOS Inc.
+ *
+ * Source to simple sink graph for library tests
+ */
+
+#ifndef _TESTS_TEST_GRAPH_H
+#define _TESTS_TEST_GRAPH_H
+
+#include <babeltrace2/babeltrace.h>
+#include <stdint.h>
+
+/*
+ * Data of the source component of a test graph, which its message
+ * iterators borrow with bt_self_component_get_data().
+ */
+struct test_graph_src_data {
+	/* Source configuration passed to test_graph_create() */
+	const void *config;
+
+	bt_trace_class *tc;
+
+	/* Clock class of message iterator inactivity messages */
+	bt_clock_class *cc;
+
+	/*
+	 * Stream class without a default clock class, and its only
+	 * event class, which has no payload field class.
+	 */
+	bt_stream_class *sc;
+	bt_event_class *ec;
+};
+
+/* Message iterator methods of the source component of a test graph */
+struct test_graph_src_methods {
+	/* `NULL` means the message iterators end immediately */
+	bt_message_iterator_class_next_method next;
+
+	/* Optional */
+	bt_message_iterator_class_initialize_method init;
+	bt_message_iterator_class_finalize_method finalize;
+
+	/* Optional, but both or none */
+	bt_message_iterator_class_seek_beginning_method seek_beginning;
+	bt_message_iterator_class_can_seek_beginning_method can_seek_beginning;
+};
+
+/*
+ * Creates a graph of which the source component, named `src-comp`,
+ * has a single output port connected to a simple sink component
+ * named `sink-comp`.
+ *
+ * `src_config` becomes the `config` member of the source component's
+ * data.
+ *
+ * `sink_consume` is the simple sink's consuming function, which gets
+ * `sink_data`: `NULL` means test_graph_sink_consume().
+ *
+ * If `conn` isn't `NULL`, sets `*conn` to the connection between the
+ * source and the sink.
+ *
+ * The graph is still configuring: the caller can configure it further
+ * before running it.
+ */
+bt_graph *test_graph_create(const struct test_graph_src_methods *src_methods,
+		const void *src_config,
+		bt_graph_simple_sink_component_consume_func sink_consume,
+		void *sink_data, const bt_connection **conn);
+
+/*
+ * Runs `graph` until it doesn't need to try again anymore.
+ */
+bt_graph_run_status test_graph_run(bt_graph *graph);
+
+/*
+ * Gets the next messages of `msg_iter` for a simple sink's consuming
+ * function.
+ *
+ * Returns `BT_GRAPH_SIMPLE_SINK_COMPONENT_CONSUME_FUNC_STATUS_OK` when
+ * there are `*count` messages in `*msgs`, which the caller must put,
+ * or the status which the consuming function must return otherwise.
+ */
+bt_graph_simple_sink_component_consume_func_status test_graph_sink_next(
+		bt_message_iterator *msg_iter, bt_message_array_const *msgs,
+		uint64_t *count);
+
+/*
+ * Default consuming function of the sink of a test graph: puts the
+ * messages and, if `user_data` isn't `NULL`, adds their number to the
+ * `uint64_t` which it points to.
+ */
+bt_graph_simple_sink_component_consume_func_status test_graph_sink_consume(
+		bt_message_iterator *msg_iter, void *user_data);
+
+#endif /* _TESTS_TEST_GRAPH_H */